@@ -0,0 +1,6 @@
+#
+# Component Makefile
+#
+# hx-https-mbedtls和hx-tmall共用的TLS配置档以及堆占用统计
+#
+COMPONENT_ADD_INCLUDEDIRS := include
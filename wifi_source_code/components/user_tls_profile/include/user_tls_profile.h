@@ -0,0 +1,147 @@
+/**
+* @file         user_tls_profile.h
+* @brief        TLS连接的配置档以及堆占用统计的相关声明
+* @details      LOW_MEM档协商max fragment length,只用secp256r1和AES-128-GCM,压低握手峰值;
+*               THROUGHPUT档把ESP32硬件AES能加速的密码套件排在前面,不协商分片长度;
+*               mbedtls的calloc/free换成带计数的版本后,可以按连接统计握手期间和稳定收发期间的堆峰值
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 移到wifi_source_code/components,hx-https-mbedtls和hx-tmall共用一份\n
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 计数的calloc/free转交原来的分配器,在app_main中挂钩\n
+*               Ver0.0.4:
+                     Helon_Chan, 2026/10/17, LOW_MEM档的工程在sdkconfig中减小发送缓存\n
+*/
+#ifndef USER_TLS_PROFILE_H_
+#define USER_TLS_PROFILE_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include "mbedtls/ssl.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+/* 收发缓存的大小在编译时由sdkconfig决定,运行时无法按连接改变;
+   使用LOW_MEM档的工程在sdkconfig中打开了CONFIG_MBEDTLS_ASYMMETRIC_CONTENT_LEN,
+   发送缓存CONFIG_MBEDTLS_SSL_OUT_CONTENT_LEN取2048,放得下请求报文和云平台的帧,
+   每个连接的收发缓存由约33KB降到约19KB;
+   接收缓存CONFIG_MBEDTLS_SSL_IN_CONTENT_LEN仍为16384,服务器不接受max fragment length时
+   证书等握手记录仍可能有16KB,确认服务器接受后才能降到TLS_PROFILE_FRAG_LEN;
+   IDF没有这几个选项时收发缓存各为CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN,LOW_MEM档只省握手内存 */
+#define TLS_PROFILE_FRAG              MBEDTLS_SSL_MAX_FRAG_LEN_4096 ///<LOW_MEM档协商的最大分片
+#define TLS_PROFILE_FRAG_LEN          4096                  ///<TLS_PROFILE_FRAG对应的字节数
+#define TLS_HEAP_SLOTS                4                     ///<同时统计堆占用的任务数
+
+/*
+===========================
+枚举变量
+===========================
+*/
+/* TLS配置档 */
+enum
+{
+  TLS_PROFILE_DEFAULT,                                  ///<mbedtls默认配置,不做改动
+  TLS_PROFILE_LOW_MEM,                                  ///<内存受限,小分片、单一曲线、少量套件
+  TLS_PROFILE_THROUGHPUT,                               ///<吞吐优先,硬件AES友好的套件在前
+};
+
+/* 堆占用统计所处的阶段 */
+enum
+{
+  TLS_HEAP_HANDSHAKE,                                   ///<建立上下文以及握手期间
+  TLS_HEAP_STEADY,                                      ///<握手完成后的收发期间
+};
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 一个连接由mbedtls申请的堆,不含每块内存的计数头 */
+typedef struct
+{
+  uint8_t                   phase;                      ///<TLS_HEAP_HANDSHAKE或者TLS_HEAP_STEADY
+  uint32_t                  current;                    ///<当前占用
+  uint32_t                  handshake_peak;             ///<握手期间的峰值
+  uint32_t                  steady_peak;                ///<握手完成后的峰值
+} tls_heap_stats_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 按配置档调整TLS配置,在mbedtls_ssl_config_defaults之后、mbedtls_ssl_setup之前调用
+ * @param[in]   conf    :TLS配置
+ * @param[in]   profile :TLS_PROFILE_xxx
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int tls_profile_apply(mbedtls_ssl_config *conf, uint8_t profile);
+
+/**
+ * 把mbedtls的calloc/free换成带计数的版本,实际的申请和释放仍交给原来的分配器
+ * 挂钩之前申请的内存没有计数头,不能在挂钩之后释放,所以必须在app_main中、
+ * 任何mbedtls上下文(包括wifi的加密)申请内存之前调用;重复调用直接返回0
+ * @param[in]   null
+ * @retval
+ *              0:成功
+ *              -1:mbedtls没有打开MBEDTLS_PLATFORM_MEMORY,不能统计
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 保存并转交原来的分配器,重复调用不再挂两层\n
+ */
+int tls_heap_hook_install(void);
+
+/**
+ * 当前任务之后由mbedtls申请的内存记到stats上,并从握手阶段开始统计
+ * 同一个任务再次调用时换成新的stats,stats原来记着的内存仍记在它上面
+ * @param[in]   stats   :统计,在连接释放之前必须一直有效
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void tls_heap_begin(tls_heap_stats_t *stats);
+
+/**
+ * 握手完成,之后的峰值记到steady_peak
+ * @param[in]   stats   :统计
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void tls_heap_steady(tls_heap_stats_t *stats);
+
+/**
+ * 当前任务之后申请的内存不再记到任何stats上
+ * @param[in]   null
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void tls_heap_end(void);
+
+#endif/* USER_TLS_PROFILE_H_ */
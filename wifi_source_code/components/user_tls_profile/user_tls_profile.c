@@ -0,0 +1,346 @@
+/**
+* @file         user_tls_profile.c
+* @brief        TLS连接的配置档以及堆占用统计的相关函数定义
+* @details      统计用的calloc在每块内存前面放一个计数头,记下大小和所属的统计,
+*               free时按计数头扣回,内存在哪个任务里释放都能扣到申请它的连接上;
+*               实际的申请和释放仍交给挂钩之前mbedtls所用的分配器,保留IDF的内存分配策略
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 移到wifi_source_code/components,hx-https-mbedtls和hx-tmall共用一份\n
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 计数的calloc/free转交原来的分配器,不再直接用calloc/free\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "mbedtls/platform.h"
+#include "mbedtls/ssl_ciphersuites.h"
+#include "user_tls_profile.h"
+#include <freertos/FreeRTOS.h>
+#include "freertos/task.h"
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 每块内存前面的计数头,两个字长,不改变calloc返回地址的对齐 */
+typedef struct
+{
+  tls_heap_stats_t          *stats;                     ///<申请时所属的统计,NULL表示不统计
+  size_t                    size;                       ///<申请的字节数
+} tls_heap_hdr_t;
+
+/* 一个任务和它当前的统计 */
+typedef struct
+{
+  TaskHandle_t              task;
+  tls_heap_stats_t          *stats;
+} tls_heap_slot_t;
+
+/*
+===========================
+全局变量定义
+===========================
+*/
+/* 只用AES-128-GCM:一份GCM上下文,不需要HMAC,握手时少算一种摘要 */
+static const int tls_profile_low_mem_suites[] =
+{
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_RSA_WITH_AES_128_GCM_SHA256,
+  0
+};
+
+/* AES由硬件加速,排在前面;Camellia、3DES等纯软件实现的套件不提供 */
+static const int tls_profile_throughput_suites[] =
+{
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384,
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256,
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256,
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA,
+  MBEDTLS_TLS_RSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA256,
+  MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA,
+  0
+};
+
+#if defined(MBEDTLS_ECP_C)
+/* 只留secp256r1,服务器选不到更大的曲线,ECDHE的临时内存最小 */
+static const mbedtls_ecp_group_id tls_profile_low_mem_curves[] =
+{
+  MBEDTLS_ECP_DP_SECP256R1,
+  MBEDTLS_ECP_DP_NONE
+};
+#endif
+
+#if defined(MBEDTLS_PLATFORM_MEMORY) && !defined(MBEDTLS_PLATFORM_CALLOC_MACRO)
+/* 挂钩之前mbedtls所用的分配器,IDF中为esp_mbedtls_mem_calloc/free,NULL表示还没挂钩 */
+static void *(*tls_heap_orig_calloc)(size_t n, size_t size) = NULL;
+static void (*tls_heap_orig_free)(void *ptr) = NULL;
+#endif
+
+static tls_heap_slot_t tls_heap_slot[TLS_HEAP_SLOTS];
+/* 多个连接任务可能在不同核上同时申请内存 */
+static portMUX_TYPE tls_heap_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 按配置档调整TLS配置,在mbedtls_ssl_config_defaults之后、mbedtls_ssl_setup之前调用
+ * @param[in]   conf    :TLS配置
+ * @param[in]   profile :TLS_PROFILE_xxx
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int tls_profile_apply(mbedtls_ssl_config *conf, uint8_t profile)
+{
+  int ret = 0;
+  switch (profile)
+  {
+  case TLS_PROFILE_LOW_MEM:
+    /* 没编译进来的套件在ClientHello中会被跳过 */
+    mbedtls_ssl_conf_ciphersuites(conf, tls_profile_low_mem_suites);
+#if defined(MBEDTLS_ECP_C)
+    mbedtls_ssl_conf_curves(conf, tls_profile_low_mem_curves);
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    /* 服务器接受后每条记录不超过TLS_PROFILE_FRAG_LEN,不接受时仍按16KB收 */
+    ret = mbedtls_ssl_conf_max_frag_len(conf, TLS_PROFILE_FRAG);
+#endif
+    break;
+  case TLS_PROFILE_THROUGHPUT:
+    mbedtls_ssl_conf_ciphersuites(conf, tls_profile_throughput_suites);
+    break;
+  default:
+    break;
+  }
+  return ret;
+}
+
+#if defined(MBEDTLS_PLATFORM_MEMORY) && !defined(MBEDTLS_PLATFORM_CALLOC_MACRO)
+/**
+ * 查找当前任务的统计,调用时已持有tls_heap_mux
+ * @param[in]   null
+ * @retval      当前任务的统计槽,没有时为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static tls_heap_slot_t *tls_heap_lookup(void)
+{
+  uint8_t i;
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  for (i = 0; i < TLS_HEAP_SLOTS; i++)
+  {
+    if (tls_heap_slot[i].task == task)
+    {
+      return &tls_heap_slot[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * 带计数的calloc,内存记到当前任务的统计上,连同计数头一起向原来的分配器申请
+ * @param[in]   n     :个数
+ * @param[in]   size  :每个的大小
+ * @retval      申请到的内存,失败为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 转交原来的分配器\n
+ */
+static void *tls_heap_calloc(size_t n, size_t size)
+{
+  tls_heap_hdr_t *hdr;
+  tls_heap_slot_t *slot;
+  tls_heap_stats_t *stats;
+  if (size != 0 && n > (SIZE_MAX - sizeof(tls_heap_hdr_t)) / size)
+  {
+    return NULL;
+  }
+  size *= n;
+  hdr = (tls_heap_hdr_t *)tls_heap_orig_calloc(1, sizeof(tls_heap_hdr_t) + size);
+  if (hdr == NULL)
+  {
+    return NULL;
+  }
+  portENTER_CRITICAL(&tls_heap_mux);
+  slot = tls_heap_lookup();
+  stats = slot != NULL ? slot->stats : NULL;
+  hdr->stats = stats;
+  hdr->size = size;
+  if (stats != NULL)
+  {
+    stats->current += size;
+    if (stats->phase == TLS_HEAP_HANDSHAKE && stats->current > stats->handshake_peak)
+    {
+      stats->handshake_peak = stats->current;
+    }
+    else if (stats->phase == TLS_HEAP_STEADY && stats->current > stats->steady_peak)
+    {
+      stats->steady_peak = stats->current;
+    }
+  }
+  portEXIT_CRITICAL(&tls_heap_mux);
+  return hdr + 1;
+}
+
+/**
+ * 带计数的free,按计数头扣回申请时的统计,再交还原来的分配器
+ * @param[in]   ptr   :tls_heap_calloc申请的内存,可以为NULL
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 转交原来的分配器\n
+ */
+static void tls_heap_free(void *ptr)
+{
+  tls_heap_hdr_t *hdr;
+  if (ptr == NULL)
+  {
+    return;
+  }
+  hdr = (tls_heap_hdr_t *)ptr - 1;
+  if (hdr->stats != NULL)
+  {
+    portENTER_CRITICAL(&tls_heap_mux);
+    hdr->stats->current -= hdr->size;
+    portEXIT_CRITICAL(&tls_heap_mux);
+  }
+  tls_heap_orig_free(hdr);
+}
+#endif
+
+/**
+ * 把mbedtls的calloc/free换成带计数的版本,实际的申请和释放仍交给原来的分配器
+ * 挂钩之前申请的内存没有计数头,不能在挂钩之后释放,所以必须在app_main中、
+ * 任何mbedtls上下文(包括wifi的加密)申请内存之前调用;重复调用直接返回0
+ * @param[in]   null
+ * @retval
+ *              0:成功
+ *              -1:mbedtls没有打开MBEDTLS_PLATFORM_MEMORY,不能统计
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 保存并转交原来的分配器,重复调用不再挂两层\n
+ */
+int tls_heap_hook_install(void)
+{
+#if defined(MBEDTLS_PLATFORM_MEMORY) && !defined(MBEDTLS_PLATFORM_CALLOC_MACRO)
+  if (tls_heap_orig_calloc != NULL)
+  {
+    return 0;
+  }
+  tls_heap_orig_calloc = mbedtls_calloc;
+  tls_heap_orig_free = mbedtls_free;
+  return mbedtls_platform_set_calloc_free(tls_heap_calloc, tls_heap_free);
+#else
+  return -1;
+#endif
+}
+
+/**
+ * 当前任务之后由mbedtls申请的内存记到stats上,并从握手阶段开始统计
+ * 同一个任务再次调用时换成新的stats,stats原来记着的内存仍记在它上面
+ * @param[in]   stats   :统计,在连接释放之前必须一直有效
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void tls_heap_begin(tls_heap_stats_t *stats)
+{
+  uint8_t i;
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  tls_heap_slot_t *slot = NULL;
+  portENTER_CRITICAL(&tls_heap_mux);
+  for (i = 0; i < TLS_HEAP_SLOTS; i++)
+  {
+    if (tls_heap_slot[i].task == task)
+    {
+      slot = &tls_heap_slot[i];
+      break;
+    }
+    if (slot == NULL && tls_heap_slot[i].task == NULL)
+    {
+      slot = &tls_heap_slot[i];
+    }
+  }
+  /* 槽位用完时这个任务不统计 */
+  if (slot != NULL)
+  {
+    slot->task = task;
+    slot->stats = stats;
+  }
+  /* 握手峰值从已经占着的内存算起,如复用连接时保留的收发缓存 */
+  stats->phase = TLS_HEAP_HANDSHAKE;
+  stats->handshake_peak = stats->current;
+  portEXIT_CRITICAL(&tls_heap_mux);
+}
+
+/**
+ * 握手完成,之后的峰值记到steady_peak
+ * @param[in]   stats   :统计
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void tls_heap_steady(tls_heap_stats_t *stats)
+{
+  portENTER_CRITICAL(&tls_heap_mux);
+  stats->phase = TLS_HEAP_STEADY;
+  stats->steady_peak = stats->current;
+  portEXIT_CRITICAL(&tls_heap_mux);
+}
+
+/**
+ * 当前任务之后申请的内存不再记到任何stats上
+ * @param[in]   null
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void tls_heap_end(void)
+{
+  uint8_t i;
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&tls_heap_mux);
+  for (i = 0; i < TLS_HEAP_SLOTS; i++)
+  {
+    if (tls_heap_slot[i].task == task)
+    {
+      tls_heap_slot[i].task = NULL;
+      tls_heap_slot[i].stats = NULL;
+    }
+  }
+  portEXIT_CRITICAL(&tls_heap_mux);
+}
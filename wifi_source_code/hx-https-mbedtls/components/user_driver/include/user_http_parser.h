@@ -0,0 +1,119 @@
+/**
+* @file         user_http_parser.h
+* @brief        流式HTTP/1.1响应解析相关声明
+* @details      数据按收到的任意分段喂入,逐字节解析状态行、响应头、Content-Length以及chunked编码,
+*               只占用一行的缓存,响应体不缓存,直接通过回调交给调用者
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef USER_HTTP_PARSER_H_
+#define USER_HTTP_PARSER_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define HTTP_PARSER_LINE_LEN          128                   ///<状态行/响应头一行的缓存,超出部分截断,只影响回调看到的值
+
+#define HTTP_PARSER_ERR_FORMAT        -0x0F11               ///<响应格式错误
+#define HTTP_PARSER_ERR_CALLBACK      -0x0F12               ///<回调要求停止解析
+#define HTTP_PARSER_ERR_EOF           -0x0F13               ///<响应还没结束连接就关闭了
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 解析回调,返回非0时停止解析 */
+typedef struct
+{
+  int (*on_header)(void *arg, const char *name, const char *value);      ///<每个响应头一次,可以为NULL
+  int (*on_body)(void *arg, const uint8_t *data, size_t len);           ///<每段响应体一次,可以为NULL
+} http_parser_cb_t;
+
+/* 响应解析器,一个响应用一次,http_resp_parser_init后可以复用 */
+typedef struct
+{
+  uint8_t                   state;                      ///<解析状态,见user_http_parser.c
+  uint8_t                   chunked;                    ///<Transfer-Encoding: chunked
+  uint8_t                   keep_alive;                 ///<响应结束后连接可以复用
+  uint8_t                   no_body;                    ///<HEAD请求的响应,忽略Content-Length
+  int                       status;                     ///<HTTP状态码
+  int32_t                   content_length;             ///<Content-Length,-1表示没有
+  uint32_t                  left;                       ///<响应体或者当前块剩余的字节
+  uint32_t                  body_len;                   ///<已交给on_body的字节数
+  uint16_t                  line_len;                   ///<line中的字节数
+  uint16_t                  line_total;                 ///<当前行的实际长度,用于判断空行
+  const http_parser_cb_t    *cb;
+  void                      *arg;
+  char                      line[HTTP_PARSER_LINE_LEN]; ///<当前行
+} http_resp_parser_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 初始化响应解析器,准备解析一个新的响应
+ * @param[in]   p     :解析器
+ * @param[in]   cb    :回调,可以为NULL
+ * @param[in]   arg   :回调参数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void http_resp_parser_init(http_resp_parser_t *p, const http_parser_cb_t *cb, void *arg);
+
+/**
+ * 喂入一段响应数据,响应结束时停止消费,后面的数据属于下一个响应
+ * @param[in]   p     :解析器
+ * @param[in]   data  :数据
+ * @param[in]   len   :长度
+ * @retval
+ *              >=0:消费的字节数,小于len说明响应已结束
+ *              HTTP_PARSER_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int http_resp_parser_feed(http_resp_parser_t *p, const uint8_t *data, size_t len);
+
+/**
+ * 连接已关闭,没有Content-Length也不是chunked的响应到此结束
+ * @param[in]   p     :解析器
+ * @retval
+ *              0:响应完整
+ *              HTTP_PARSER_ERR_EOF:响应不完整
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int http_resp_parser_finish(http_resp_parser_t *p);
+
+/**
+ * 响应是否已经完整解析
+ * @param[in]   p     :解析器
+ * @retval      1:完整 0:还需要数据
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int http_resp_parser_done(const http_resp_parser_t *p);
+
+#endif/* USER_HTTP_PARSER_H_ */
@@ -8,10 +8,24 @@
 * @par History:          
 *               Ver0.0.1:
                      Helon_Chan, 2018/06/27, 初始化版本\n 
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加https_request_init\n 
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 响应体改为流式解析,去掉HTTPS_BODY_MAX_LEN\n 
+*               Ver0.0.4:
+                     Helon_Chan, 2026/10/17, 增加并发请求接口https_request_by_GET_all\n 
+*               Ver0.0.5:
+                     Helon_Chan, 2026/10/17, GET、POST报文的路径按长度截取\n 
 */
 #ifndef USER_HTTP_S_
 #define USER_HTTP_S_
 
+/*
+===========================
+头文件包含
+=========================== 
+*/
+#include <stdint.h>
 
 /*
 ===========================
@@ -27,9 +41,9 @@
 #define HTTPS_URL_GZ            "https://api.seniverse.com/v3/weather/daily.json?key=4nik0ivxfmxfjzz1&location=guangzhou&language=zh-Hans&unit=c&start=0&days=5"
 #define HTTPS_URL_SZ            "https://api.seniverse.com/v3/weather/daily.json?key=4nik0ivxfmxfjzz1&location=shenzhen&language=zh-Hans&unit=c&start=0&days=5"
 /* GET请求 */
-#define GET                     "GET /%s HTTP/1.1\r\nAccept:*/*\r\nHost:%s\r\n\r\n"
+#define GET                     "GET /%.*s HTTP/1.1\r\nAccept:*/*\r\nHost:%s\r\n\r\n"
 /* POST请求,此章节暂时不讲 */
-#define POST                    "POST /%s HTTP/1.1\r\nAccept: */*\r\nContent-Length: %d\r\nContent-Type: application/x-www-form-urlencoded; charset=utf-8\r\nHost: %s\r\nConnection: Keep-Alive\r\n\r\n%s"
+#define POST                    "POST /%.*s HTTP/1.1\r\nAccept: */*\r\nContent-Length: %d\r\nContent-Type: application/x-www-form-urlencoded; charset=utf-8\r\nHost: %s\r\nConnection: Keep-Alive\r\n\r\n%s"
 /* 这里的内容由用户自己填充,具体内容用户自己填充 */
 #define POST_CONTENT            "example_content"
 
@@ -42,6 +56,19 @@
 =========================== 
 */
 
+/** 
+ * 初始化发起HTTPS请求所用的客户端,TLS配置和随机数发生器只建立一次
+ * 获取到IP后在普通任务中调用,系统事件任务的栈放不下TLS初始化,重复调用直接返回
+ * @param[in]   null
+ * @retval      
+ *              0:成功
+ *              其他:失败
+ * @par         修改日志 
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n 
+ */
+int https_request_init(void);
+
 /** 
  * 发起HTTPS的GET请求
  * @param[in]   URL:HTTP的地址
@@ -54,4 +81,19 @@
                      Helon_Chan, 2018/06/27, 初始化版本\n 
  */
 int https_request_by_GET(char *URL);
+
+/** 
+ * 并发发起多个HTTPS的GET请求,全部完成后返回
+ * 同一主机的请求复用连接池中的连接并流水线发送,不同主机的请求在不同连接上同时进行
+ * @param[in]   URL   :HTTP的地址
+ * @param[in]   count :地址个数
+ * @retval      0:全部成功
+ *              -1:失败
+ *              -2:URL解析失败
+ *              -其他的值表示请求失败的错误码
+ * @par         修改日志 
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n 
+ */
+int https_request_by_GET_all(char *const *URL, uint8_t count);
 #endif/* __USER_HTTPS_H__ */
@@ -0,0 +1,207 @@
+/**
+* @file         user_https_client.h
+* @brief        可复用的HTTPS客户端相关声明
+* @details      TLS配置和随机数发生器只初始化一次,同一主机的请求复用keep-alive连接,
+*               连接断开后用session ticket或session id恢复会话,省去完整握手
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加回调方式的请求接口https_client_request_cb\n
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 增加流水线请求接口https_client_pipeline\n
+*               Ver0.0.4:
+                     Helon_Chan, 2026/10/17, 初始化时选择TLS配置档,统计每个连接的堆峰值\n
+*               Ver0.0.5:
+                     Helon_Chan, 2026/10/17, 流水线请求的路径带长度,可以直接指向URL的一部分\n
+*/
+#ifndef USER_HTTPS_CLIENT_H_
+#define USER_HTTPS_CLIENT_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include "mbedtls/net.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include <freertos/FreeRTOS.h>
+#include "user_http_parser.h"
+#include "user_tls_profile.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define HTTPS_CLIENT_HOST_LEN         64                    ///<主机名最大长度(含结束符)
+#define HTTPS_CLIENT_BUF_LEN          1024                  ///<请求报文以及接收缓存大小
+#define HTTPS_CLIENT_TIMEOUT_MS       10000                 ///<握手和读响应的超时时间
+#define HTTPS_CLIENT_IDLE_MS          30000                 ///<连接空闲超过此时间不再复用,直接断开后走会话恢复
+
+#define HTTPS_CLIENT_ERR_ARG          -0x0F01               ///<参数错误,主机名过长或者请求报文放不下
+#define HTTPS_CLIENT_ERR_TOO_LONG     -0x0F02               ///<响应体超过调用者给的缓存,已读完丢弃
+#define HTTPS_CLIENT_ERR_CLOSED       -0x0F03               ///<收到任何响应之前连接就被对方关闭
+
+/*
+===========================
+类型定义
+===========================
+*/
+enum
+{
+  GET_REQ,
+  POST_REQ,
+};
+
+/* 客户端统计,resumed_handshakes / (full_handshakes + resumed_handshakes)即会话恢复命中率 */
+typedef struct
+{
+  uint32_t requests;                                    ///<发出的请求数
+  uint32_t keepalive_reuses;                            ///<直接复用已有连接的请求数
+  uint32_t full_handshakes;                             ///<完整握手次数
+  uint32_t resumed_handshakes;                          ///<会话恢复握手次数
+  uint32_t retries;                                     ///<复用的连接已失效,重连后重发的次数
+  uint32_t pipelined;                                   ///<跟在未完成的请求后面发出的请求数
+  int64_t  last_handshake_us;                           ///<最近一次握手(含TCP连接)耗时
+} https_client_stats_t;
+
+/* 流水线中的一个GET请求 */
+typedef struct
+{
+  const char                *path;                      ///<主机名后面的路径,不含开头的'/',不需要以'\0'结尾
+  size_t                    path_len;                   ///<路径的长度
+  const http_parser_cb_t    *cb;                        ///<响应回调,可以为NULL
+  void                      *arg;                       ///<回调参数
+  int                       status;                     ///<HTTP状态码
+  int                       ret;                        ///<0:响应已完整收到 其他:错误码
+} https_client_req_t;
+
+/* 长期存在的HTTPS客户端,非线程安全,多个任务共用时由调用者加锁 */
+typedef struct
+{
+  mbedtls_net_context       net_ctx;
+  mbedtls_ssl_context       ssl_ctx;
+  mbedtls_ssl_config        ssl_conf;
+  mbedtls_entropy_context   entropy;
+  mbedtls_ctr_drbg_context  ctr_drbg;
+  mbedtls_ssl_session       session;                    ///<最近一次握手得到的会话,用于下次恢复
+  uint8_t                   session_valid;              ///<session可用于恢复
+  uint8_t                   connected;                  ///<net_ctx上有已握手的连接
+  char                      host[HTTPS_CLIENT_HOST_LEN];///<当前连接或会话对应的主机
+  char                      port[8];                    ///<当前连接或会话对应的端口
+  TickType_t                last_used;                  ///<连接最近一次完成请求的时刻
+  int                       status;                     ///<最近一次响应的HTTP状态码
+  https_client_stats_t      stats;
+  tls_heap_stats_t          heap;                       ///<mbedtls为这个客户端申请的堆
+  uint8_t                   buf[HTTPS_CLIENT_BUF_LEN];  ///<请求报文以及接收缓存
+} https_client_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 初始化HTTPS客户端,播种随机数发生器并建立TLS配置,只需调用一次
+ * @param[in]   client  :客户端
+ * @param[in]   profile :TLS配置档,TLS_PROFILE_xxx
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加TLS配置档参数\n
+ */
+int https_client_init(https_client_t *client, uint8_t profile);
+
+/**
+ * 关闭连接并释放HTTPS客户端的所有资源
+ * @param[in]   client  :客户端
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void https_client_deinit(https_client_t *client);
+
+/**
+ * 发起一次HTTPS请求,响应头和响应体边收边通过回调交出,连接可复用时保持连接
+ * 复用的连接已被服务器关闭时,自动用保存的会话重连,GET请求重发一次,POST请求不重发
+ * @param[in]   client    :客户端
+ * @param[in]   method    :GET_REQ或者POST_REQ
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   path      :主机名后面的路径,不含开头的'/'
+ * @param[in]   cb        :响应回调,可以为NULL
+ * @param[in]   arg       :回调参数
+ * @retval
+ *              0:成功,HTTP状态码见client->status
+ *              HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_client_request_cb(https_client_t *client, uint8_t method, const char *host, const char *port,
+                            const char *path, const http_parser_cb_t *cb, void *arg);
+
+/**
+ * 发起一次HTTPS请求并读完响应,连接可复用时保持连接
+ * 复用的连接已被服务器关闭时,自动用保存的会话重连,GET请求重发一次,POST请求不重发
+ * @param[in]   client    :客户端
+ * @param[in]   method    :GET_REQ或者POST_REQ
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   path      :主机名后面的路径,不含开头的'/'
+ * @param[out]  body      :存放响应体,以'\0'结尾
+ * @param[in]   body_size :body的大小
+ * @retval
+ *              >=0:响应体长度,HTTP状态码见client->status
+ *              HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 基于https_client_request_cb实现\n
+ */
+int https_client_request(https_client_t *client, uint8_t method, const char *host, const char *port,
+                         const char *path, char *body, size_t body_size);
+
+/**
+ * 在同一个连接上连续发出多个GET请求,再依次读回各自的响应,省去每个请求一次往返的等待
+ * 请求报文放不下client->buf时分批发送;服务器中途关闭连接时,还没收到响应的请求重连后重发
+ * @param[in]   client    :客户端
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   reqs      :请求,结果写回每一项的status和ret
+ * @param[in]   count     :请求数
+ * @retval
+ *              0:全部成功
+ *              HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码:第一个失败请求的错误码,
+ *              它后面的请求也以此失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_client_pipeline(https_client_t *client, const char *host, const char *port,
+                          https_client_req_t *reqs, uint8_t count);
+
+/**
+ * 关闭当前连接,保留会话用于下次恢复
+ * @param[in]   client  :客户端
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void https_client_close(https_client_t *client);
+
+#endif/* USER_HTTPS_CLIENT_H_ */
@@ -0,0 +1,152 @@
+/**
+* @file         user_https_sched.h
+* @brief        多个HTTPS请求并发调度的相关声明
+* @details      固定数量的常驻TLS连接组成连接池,每个连接一个工作任务;
+*               排队的GET请求优先交给已连上同一主机的连接,同一主机的多个请求在一个连接上流水线发送,
+*               同一主机同时在用的连接数有上限,每个请求完成后回调
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加连接池的TLS配置档HTTPS_SCHED_TLS_PROFILE\n
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 增加按url_parse结果提交请求的https_sched_get_url\n
+*/
+#ifndef USER_HTTPS_SCHED_H_
+#define USER_HTTPS_SCHED_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <freertos/FreeRTOS.h>
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "user_https_client.h"
+#include "user_url.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define HTTPS_SCHED_CONNS             2                     ///<连接池的连接数,每个TLS连接的收发缓存约需19KB堆
+#define HTTPS_SCHED_HOST_CONNS        2                     ///<同一主机同时在用的连接数上限
+#define HTTPS_SCHED_PIPELINE          4                     ///<一个连接上一次最多流水线发出的请求数
+#define HTTPS_SCHED_MAX_JOBS          8                     ///<排队中和进行中的请求数上限
+#define HTTPS_SCHED_STACK             (1024 * 8)            ///<工作任务的栈,握手和响应回调都在其中执行
+#define HTTPS_SCHED_PRIO              3                     ///<工作任务的优先级
+#define HTTPS_SCHED_TLS_PROFILE       TLS_PROFILE_LOW_MEM   ///<连接池的TLS配置档,响应都很小,省内存优先
+
+#define HTTPS_SCHED_ERR_FULL          -0x0F31               ///<排队的请求已满
+
+/*
+===========================
+类型定义
+===========================
+*/
+/**
+ * 请求完成回调,在工作任务中执行
+ * @param[in]   arg     :https_sched_get传入的回调参数
+ * @param[in]   ret     :0:响应已完整收到 其他:HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码
+ * @param[in]   status  :HTTP状态码
+ */
+typedef void (*https_sched_done_t)(void *arg, int ret, int status);
+
+/* 一个GET请求 */
+typedef struct
+{
+  uint8_t                   state;                      ///<空闲、排队或者进行中
+  uint32_t                  seq;                        ///<提交顺序,先提交的先调度
+  char                      host[HTTPS_CLIENT_HOST_LEN];
+  char                      port[8];
+  const char                *path;                      ///<提交后到完成回调之前必须一直有效
+  size_t                    path_len;
+  const http_parser_cb_t    *cb;
+  void                      *arg;
+  https_sched_done_t        done;
+} https_sched_job_t;
+
+struct https_sched;
+
+/* 连接池中的一个连接及其工作任务 */
+typedef struct
+{
+  struct https_sched        *sched;
+  TaskHandle_t              task;
+  const https_sched_job_t   *job;                       ///<正在处理的第一个请求,NULL表示空闲
+  https_client_t            client;
+} https_sched_conn_t;
+
+/* 调度器,jobs和每个连接的job都由lock保护 */
+typedef struct https_sched
+{
+  SemaphoreHandle_t         lock;
+  uint32_t                  seq;
+  https_sched_job_t         jobs[HTTPS_SCHED_MAX_JOBS];
+  https_sched_conn_t        conns[HTTPS_SCHED_CONNS];
+} https_sched_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 初始化调度器,建立连接池的客户端并创建工作任务,只需调用一次
+ * 失败时已建立的任务和客户端全部释放,可以再次调用
+ * @param[in]   sched   :调度器,必须一直有效
+ * @retval
+ *              0:成功
+ *              其他:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_sched_init(https_sched_t *sched);
+
+/**
+ * 提交一个GET请求,立即返回,响应通过cb边收边交出,结束后调用done
+ * @param[in]   sched   :调度器
+ * @param[in]   host    :主机名
+ * @param[in]   port    :端口
+ * @param[in]   path    :主机名后面的路径,不含开头的'/',在done之前必须一直有效
+ * @param[in]   cb      :响应回调,可以为NULL
+ * @param[in]   arg     :cb和done的回调参数
+ * @param[in]   done    :完成回调,可以为NULL
+ * @retval
+ *              0:成功
+ *              HTTPS_CLIENT_ERR_ARG:主机名或端口过长
+ *              HTTPS_SCHED_ERR_FULL:排队的请求已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_sched_get(https_sched_t *sched, const char *host, const char *port, const char *path,
+                    const http_parser_cb_t *cb, void *arg, https_sched_done_t done);
+
+/**
+ * 按url_parse的解析结果提交一个GET请求,路径直接指向URL,不拷贝
+ * @param[in]   sched   :调度器
+ * @param[in]   url     :URL,在done之前必须一直有效
+ * @param[in]   u       :url的解析结果
+ * @param[in]   cb      :响应回调,可以为NULL
+ * @param[in]   arg     :cb和done的回调参数
+ * @param[in]   done    :完成回调,可以为NULL
+ * @retval
+ *              0:成功
+ *              HTTPS_CLIENT_ERR_ARG:主机名过长或者端口未知
+ *              HTTPS_SCHED_ERR_FULL:排队的请求已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_sched_get_url(https_sched_t *sched, const char *url, const url_t *u,
+                        const http_parser_cb_t *cb, void *arg, https_sched_done_t done);
+
+#endif/* USER_HTTPS_SCHED_H_ */
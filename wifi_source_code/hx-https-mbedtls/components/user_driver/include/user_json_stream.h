@@ -0,0 +1,156 @@
+/**
+* @file         user_json_stream.h
+* @brief        流式按路径提取json值的相关声明
+* @details      json文本按收到的任意分段喂入,不建立cJSON树,只把匹配路径的值(原样的json文本)
+*               通过回调交出,内存占用固定为json_stream_t的大小
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加标量的词法子状态,数字和true/false/null按语法检查\n
+*/
+#ifndef USER_JSON_STREAM_H_
+#define USER_JSON_STREAM_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define JSON_STREAM_DEPTH             8                     ///<记录键名/下标的嵌套层数,路径不能比这更深
+#define JSON_STREAM_MAX_NESTING       32                    ///<允许的最大嵌套层数,超过视为错误
+#define JSON_STREAM_KEY_LEN           24                    ///<键名缓存,更长的键不会被匹配
+#define JSON_STREAM_VALUE_LEN         384                   ///<匹配值的缓存,更长的值截断后交出
+#define JSON_STREAM_MAX_PATHS         4                     ///<最多同时提取的路径数
+#define JSON_STREAM_MAX_SEGS          JSON_STREAM_DEPTH     ///<一条路径最多的段数
+
+#define JSON_STREAM_ERR_PATH          -0x0F21               ///<路径格式错误或者太多
+#define JSON_STREAM_ERR_SYNTAX        -0x0F22               ///<json格式错误
+#define JSON_STREAM_ERR_DEPTH         -0x0F23               ///<嵌套超过JSON_STREAM_MAX_NESTING
+#define JSON_STREAM_ERR_CALLBACK      -0x0F24               ///<回调要求停止
+#define JSON_STREAM_ERR_EOF           -0x0F25               ///<json不完整
+
+/*
+===========================
+类型定义
+===========================
+*/
+/**
+ * 匹配值回调,返回非0时停止解析
+ * @param[in]   arg       :回调参数
+ * @param[in]   path      :匹配的路径序号,即json_stream_add_path的返回值
+ * @param[in]   value     :值的json文本,字符串带引号,以'\0'结尾
+ * @param[in]   len       :文本长度
+ * @param[in]   truncated :值超过JSON_STREAM_VALUE_LEN被截断
+ */
+typedef int (*json_stream_cb_t)(void *arg, uint8_t path, const char *value, size_t len, uint8_t truncated);
+
+/* 路径中的一段 */
+typedef struct
+{
+  uint8_t                   type;                       ///<键名、下标、任意键名或任意下标
+  uint8_t                   key_len;
+  uint16_t                  index;
+  const char                *key;                       ///<指向路径字符串内部,不拷贝
+} json_stream_seg_t;
+
+/* 嵌套的一层对象或数组 */
+typedef struct
+{
+  uint16_t                  index;                      ///<数组当前元素的下标
+  uint8_t                   key_len;                    ///<对象当前键名长度,0xff表示过长
+  char                      key[JSON_STREAM_KEY_LEN];   ///<对象当前键名,原样未转义
+} json_stream_frame_t;
+
+/* 流式提取器 */
+typedef struct
+{
+  uint8_t                   state;                      ///<词法状态,见user_json_stream.c
+  uint8_t                   scalar;                     ///<标量的子状态:数字的词法状态,或者字面量已匹配的字符数
+  uint8_t                   literal;                    ///<正在匹配的字面量,0表示数字
+  uint8_t                   depth;                      ///<当前嵌套层数
+  uint8_t                   capturing;                  ///<正在拷贝匹配的值
+  uint8_t                   cap_depth;                  ///<匹配值所在的层数
+  uint8_t                   cap_path;                   ///<匹配的路径序号
+  uint8_t                   paths;                      ///<路径数
+  uint8_t                   seg_count[JSON_STREAM_MAX_PATHS];
+  uint32_t                  is_array;                   ///<每层是否为数组,按位
+  uint16_t                  value_len;
+  uint8_t                   truncated;
+  json_stream_cb_t          cb;
+  void                      *arg;
+  json_stream_seg_t         seg[JSON_STREAM_MAX_PATHS][JSON_STREAM_MAX_SEGS];
+  json_stream_frame_t       frame[JSON_STREAM_DEPTH];
+  char                      value[JSON_STREAM_VALUE_LEN + 1];
+} json_stream_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 初始化提取器
+ * @param[in]   js    :提取器
+ * @param[in]   cb    :匹配值回调
+ * @param[in]   arg   :回调参数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void json_stream_init(json_stream_t *js, json_stream_cb_t cb, void *arg);
+
+/**
+ * 增加一条要提取的路径,如"results[0].daily[*]"、"results[0].location.name"
+ * 键名用'.'分隔,"[n]"为数组下标,"[*]"为任意下标,"*"为任意键名,空路径匹配整个json
+ * @param[in]   js    :提取器
+ * @param[in]   path  :路径,解析期间必须一直有效
+ * @retval
+ *              >=0:路径序号,回调时传回
+ *              JSON_STREAM_ERR_PATH:路径格式错误或者路径太多
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int json_stream_add_path(json_stream_t *js, const char *path);
+
+/**
+ * 喂入一段json文本,匹配的值完整后立即回调
+ * @param[in]   js    :提取器
+ * @param[in]   data  :数据
+ * @param[in]   len   :长度
+ * @retval
+ *              0:成功
+ *              JSON_STREAM_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int json_stream_feed(json_stream_t *js, const uint8_t *data, size_t len);
+
+/**
+ * 输入结束,检查json是否完整
+ * @param[in]   js    :提取器
+ * @retval
+ *              0:完整
+ *              JSON_STREAM_ERR_EOF:不完整
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int json_stream_finish(json_stream_t *js);
+
+#endif/* USER_JSON_STREAM_H_ */
@@ -0,0 +1,85 @@
+/**
+* @file         user_url.h
+* @brief        URL解析的相关声明
+* @details      一次扫描把URL切成scheme、主机、端口、路径、查询串和片段,
+*               结果都是指向原URL的偏移和长度,不拷贝,也不需要存放结果的缓存
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef USER_URL_H_
+#define USER_URL_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define URL_MAX_LEN                   0xFFFF                ///<偏移和长度都用16位保存
+#define URL_HOST_MAX_LEN              253                   ///<DNS主机名的最大长度
+
+#define URL_ERR_ARG                   -0x0F41               ///<URL为NULL
+#define URL_ERR_SCHEME                -0x0F42               ///<没有scheme,或者scheme后面不是"://"
+#define URL_ERR_HOST                  -0x0F43               ///<主机名为空、过长或者含有非法字符
+#define URL_ERR_PORT                  -0x0F44               ///<端口不是1~65535的数字
+#define URL_ERR_CHAR                  -0x0F45               ///<路径、查询串或片段中有空格或控制字符
+#define URL_ERR_TOO_LONG              -0x0F46               ///<URL超过URL_MAX_LEN
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 原URL中的一段,len为0表示没有这一段 */
+typedef struct
+{
+  uint16_t                  off;
+  uint16_t                  len;
+} url_view_t;
+
+/* 解析结果,各段都不含分隔符 */
+typedef struct
+{
+  url_view_t                scheme;                     ///<"https"
+  url_view_t                host;                       ///<主机名,IPv6地址不含方括号
+  url_view_t                port;                       ///<URL中写明的端口
+  url_view_t                path;                       ///<以'/'开头的路径
+  url_view_t                query;                      ///<'?'后面的查询串
+  url_view_t                fragment;                   ///<'#'后面的片段
+  url_view_t                target;                     ///<请求行中'/'后面的部分:路径和查询串,不含片段
+  uint16_t                  port_num;                   ///<端口号,没写明时按scheme取默认值,未知scheme为0
+} url_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 解析URL,只扫描一遍,不修改也不拷贝URL
+ * 支持"scheme://host[:port][/path][?query][#fragment]",host可以是"[IPv6地址]";
+ * 路径中的非ASCII字节原样保留,空格和控制字符视为错误,避免拼进请求行后改变报文
+ * @param[in]   url   :以'\0'结尾的URL,使用解析结果期间必须一直有效
+ * @param[out]  u     :解析结果
+ * @retval
+ *              0:成功
+ *              URL_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int url_parse(const char *url, url_t *u);
+
+#endif/* USER_URL_H_ */
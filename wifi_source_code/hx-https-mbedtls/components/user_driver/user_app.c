@@ -8,6 +8,12 @@
 * @par History:          
 *               Ver0.0.1:
                      Helon_Chan, 2018/06/19, 初始化版本\n 
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 获取IP后在单独的任务中初始化https客户端\n 
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 双击按键并发获取北上广深的天气预报\n 
+*               Ver0.0.4:
+                     Helon_Chan, 2026/10/17, 上电时挂上mbedtls的堆统计\n 
 */
 
 /*
@@ -20,6 +26,7 @@
 #include "user_app.h"
 #include <freertos/FreeRTOS.h>
 #include "freertos/task.h"
+#include "freertos/event_groups.h"
 #include "esp_system.h"
 #include "esp_spi_flash.h"
 #include "esp_wifi.h"
@@ -28,11 +35,21 @@
 #include "esp_err.h"
 #include "nvs_flash.h"
 #include "user_http_s.h"
+/*
+===========================
+宏定义
+=========================== 
+*/
+/* 获取到IP的事件位 */
+#define WIFI_GOT_IP_BIT     BIT0
+
 /*
 ===========================
 全局变量
 =========================== 
 */
+/* 事件回调只置位,https客户端在https_init_task中初始化 */
+static EventGroupHandle_t gs_wifi_event_group;
 /* 填充需要配置的按键个数以及对应的相关参数 */
 static key_config_t gs_m_key_config[BOARD_BUTTON_COUNT] =
     {
@@ -94,6 +111,21 @@ static void https_request_by_get_task(void *pvParameters)
   vTaskDelete(NULL);
 }
 
+/** 
+ * https的get请求任务，并发获取北上广深四个城市的天气预报
+ * @param[in]   pvParameters     :未使用
+ * @retval      null            
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2026/10/17, 初始化版本\n 
+ */
+static void https_request_all_by_get_task(void *pvParameters)
+{
+  static char *const s_city_urls[] = {HTTPS_URL_BJ, HTTPS_URL_SH, HTTPS_URL_GZ, HTTPS_URL_SZ};
+  https_request_by_GET_all(s_city_urls, sizeof(s_city_urls) / sizeof(s_city_urls[0]));
+  vTaskDelete(NULL);
+}
+
 /** 
  * 用户的短按处理函数
  * @param[in]   key_num                 :短按按键对应GPIO口
@@ -102,11 +134,14 @@ static void https_request_by_get_task(void *pvParameters)
  * @par         修改日志 
  *               Ver0.0.1:
                      Helon_Chan, 2018/06/16, 初始化版本\n 
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 双击时创建并发获取天气预报的任务\n 
  */
 static void short_pressed_cb(uint8_t key_num, uint8_t *short_pressed_counts)
 {
   static uint8_t s_sigle_click_num = 0;
   static uint8_t s_city_select = 0;
+  int err_code;
   switch (key_num)
   {
   case BOARD_BUTTON:
@@ -142,12 +177,12 @@ static void short_pressed_cb(uint8_t key_num, uint8_t *short_pressed_counts)
         s_city_select = 1;
       }
       /* 创建https的get请求的任务，用于处理接收到的天气预报json数据 */
-      int err_code = xTaskCreate(https_request_by_get_task,
-                                 "https_request_by_get_task",
-                                 1024 * 8,
-                                 &s_city_select,
-                                 3,
-                                 NULL);
+      err_code = xTaskCreate(https_request_by_get_task,
+                             "https_request_by_get_task",
+                             1024 * 8,
+                             &s_city_select,
+                             3,
+                             NULL);
       if (err_code != pdPASS)
       {
         ESP_LOGI("event_handler", "https_request_by_get_task create failure,reason is %d\n", err_code);
@@ -155,6 +190,17 @@ static void short_pressed_cb(uint8_t key_num, uint8_t *short_pressed_counts)
       break;
     case 2:
       ESP_LOGI("short_pressed_cb", "double press!!!\n");
+      /* 双击时并发获取四个城市的天气预报 */
+      err_code = xTaskCreate(https_request_all_by_get_task,
+                             "https_request_all_by_get_task",
+                             1024 * 4,
+                             NULL,
+                             3,
+                             NULL);
+      if (err_code != pdPASS)
+      {
+        ESP_LOGI("event_handler", "https_request_all_by_get_task create failure,reason is %d\n", err_code);
+      }
       break;
     case 3:
       ESP_LOGI("short_pressed_cb", "trible press!!!\n");
@@ -226,6 +272,29 @@ static void user_app_rgb_init(void)
   // ESP_LOGI("user_app_rgb_init", "r_fade_start is %d\n", r_fade_start());
 }
 
+/** 
+ * https客户端初始化任务,等到获取IP后初始化连接池
+ * 事件任务的栈只有CONFIG_SYSTEM_EVENT_TASK_STACK_SIZE,播种随机数和建立TLS配置都放在这里做
+ * 初始化失败时等下一次获取到IP再试
+ * @param[in]   pvParameters     :未使用
+ * @retval      null            
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2026/10/17, 初始化版本\n 
+ */
+static void https_init_task(void *pvParameters)
+{
+  while (1)
+  {
+    xEventGroupWaitBits(gs_wifi_event_group, WIFI_GOT_IP_BIT, pdTRUE, pdFALSE, portMAX_DELAY);
+    if (https_request_init() == 0)
+    {
+      break;
+    }
+  }
+  vTaskDelete(NULL);
+}
+
 /** 
  * wifi事件处理函数
  * @param[in]   ctx     :表示传入的事件类型对应所携带的参数
@@ -236,6 +305,8 @@ static void user_app_rgb_init(void)
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/06/04, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 获取IP后只置位,由https_init_task初始化https客户端\n 
  */
 static esp_err_t event_handler(void *ctx, system_event_t *event)
 {
@@ -246,6 +317,7 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
     /* 1.连接上AP并获取得到IP地址
        2.初始化按键防止还没有获取得到IP地址
        3.此时还可以按下按键获取北上广深的天气预报 */
+    xEventGroupSetBits(gs_wifi_event_group, WIFI_GOT_IP_BIT);
     user_app_key_init();
     break;
   case SYSTEM_EVENT_STA_CONNECTED:
@@ -264,10 +336,24 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/06/04, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 启动事件回调之前创建事件组和https客户端初始化任务\n 
  */
 static void user_wifi_init(void)
 {
+  int err_code;
   ESP_ERROR_CHECK(nvs_flash_init());
+  gs_wifi_event_group = xEventGroupCreate();
+  err_code = xTaskCreate(https_init_task,
+                         "https_init_task",
+                         1024 * 4,
+                         NULL,
+                         3,
+                         NULL);
+  if (err_code != pdPASS)
+  {
+    ESP_LOGI("user_wifi_init", "https_init_task create failure,reason is %d\n", err_code);
+  }
   tcpip_adapter_init();
   ESP_ERROR_CHECK(esp_event_loop_init(event_handler, NULL));
   wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
@@ -291,6 +377,10 @@ static void user_wifi_init(void)
  * @par         修改日志 
  *               Ver0.0.1:
                      Helon_Chan, 2018/06/26, 初始化版本\n 
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 在wifi和https之前挂上mbedtls的堆统计\n 
+ *               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 堆统计改在app_main中挂上\n 
  */
 void startup_initialization_task(void *pvParameters)
 {
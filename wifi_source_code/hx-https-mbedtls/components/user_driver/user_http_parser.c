@@ -0,0 +1,457 @@
+/**
+* @file         user_http_parser.c
+* @brief        流式HTTP/1.1响应解析相关函数定义
+* @details      状态行和响应头逐字节拼成一行后处理,响应体按Content-Length、chunked编码或者
+*               读到连接关闭为止切出,每段直接交给on_body回调,不需要把整个响应读进内存
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include <strings.h>
+#include "user_http_parser.h"
+
+/*
+===========================
+枚举变量
+===========================
+*/
+/* 解析状态 */
+enum
+{
+  HP_STATUS,                                            ///<状态行
+  HP_HEADER,                                            ///<响应头
+  HP_BODY,                                              ///<Content-Length指定长度的响应体
+  HP_BODY_CLOSE,                                        ///<读到连接关闭为止的响应体
+  HP_CHUNK_SIZE,                                        ///<块长度
+  HP_CHUNK_EXT,                                         ///<块长度后面的扩展,直到行尾
+  HP_CHUNK_DATA,                                        ///<块数据
+  HP_CHUNK_CR,                                          ///<块数据后的\r
+  HP_CHUNK_LF,                                          ///<块数据后的\n
+  HP_TRAILER,                                           ///<最后一块后的trailer行
+  HP_DONE,                                              ///<响应结束
+  HP_ERROR,                                             ///<出错,不再接收数据
+};
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 判断逗号分隔的值中是否含有某个词,不区分大小写
+ * @param[in]   value :响应头的值
+ * @param[in]   token :要找的词
+ * @retval      1:含有 0:不含
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t http_value_has(const char *value, const char *token)
+{
+  size_t len = strlen(token);
+  while (*value)
+  {
+    while (*value == ' ' || *value == '\t' || *value == ',')
+    {
+      value++;
+    }
+    if (strncasecmp(value, token, len) == 0 &&
+        (value[len] == 0 || value[len] == ',' || value[len] == ' ' || value[len] == ';'))
+    {
+      return 1;
+    }
+    while (*value && *value != ',')
+    {
+      value++;
+    }
+  }
+  return 0;
+}
+
+/**
+ * 处理状态行,"HTTP/1.x SSS 原因"
+ * @param[in]   p     :解析器
+ * @retval      0:成功 HTTP_PARSER_ERR_FORMAT:格式错误
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int http_status_line(http_resp_parser_t *p)
+{
+  const char *s = p->line;
+  if (p->line_len < 12 || strncmp(s, "HTTP/1.", 7) || s[8] != ' ' ||
+      s[9] < '1' || s[9] > '5' || s[10] < '0' || s[10] > '9' || s[11] < '0' || s[11] > '9')
+  {
+    return HTTP_PARSER_ERR_FORMAT;
+  }
+  p->status = (s[9] - '0') * 100 + (s[10] - '0') * 10 + (s[11] - '0');
+  /* HTTP/1.1默认keep-alive,HTTP/1.0默认关闭 */
+  p->keep_alive = s[7] != '0';
+  return 0;
+}
+
+/**
+ * 响应头结束,决定响应体的结束方式
+ * @param[in]   p     :解析器
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void http_head_done(http_resp_parser_t *p)
+{
+  /* 100 Continue之类的临时响应,后面还有真正的响应 */
+  if (p->status / 100 == 1)
+  {
+    p->state = HP_STATUS;
+    p->content_length = -1;
+    p->chunked = 0;
+  }
+  else if (p->no_body || p->status == 204 || p->status == 304)
+  {
+    p->state = HP_DONE;
+  }
+  else if (p->chunked)
+  {
+    p->state = HP_CHUNK_SIZE;
+    p->left = 0;
+  }
+  else if (p->content_length >= 0)
+  {
+    p->left = p->content_length;
+    p->state = p->left ? HP_BODY : HP_DONE;
+  }
+  else
+  {
+    p->state = HP_BODY_CLOSE;
+    p->keep_alive = 0;
+  }
+}
+
+/**
+ * 处理一行响应头,空行表示响应头结束
+ * @param[in]   p     :解析器
+ * @retval      0:成功 HTTP_PARSER_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int http_header_line(http_resp_parser_t *p)
+{
+  char *name = p->line;
+  char *value;
+  char *end;
+  const char *digit;
+  uint32_t length = 0;
+  if (p->line_total == 0)
+  {
+    http_head_done(p);
+    return 0;
+  }
+  value = strchr(name, ':');
+  if (value == NULL || value == name)
+  {
+    return HTTP_PARSER_ERR_FORMAT;
+  }
+  *value++ = 0;
+  while (*value == ' ' || *value == '\t')
+  {
+    value++;
+  }
+  end = p->line + p->line_len;
+  while (end > value && (end[-1] == ' ' || end[-1] == '\t'))
+  {
+    *--end = 0;
+  }
+  if (strcasecmp(name, "Content-Length") == 0)
+  {
+    if (*value == 0)
+    {
+      return HTTP_PARSER_ERR_FORMAT;
+    }
+    for (digit = value; *digit; digit++)
+    {
+      if (*digit < '0' || *digit > '9' || length > 0x7ffffff)
+      {
+        return HTTP_PARSER_ERR_FORMAT;
+      }
+      length = length * 10 + (*digit - '0');
+    }
+    /* 多个不一致的Content-Length是响应走私的典型手法 */
+    if (p->content_length >= 0 && p->content_length != (int32_t)length)
+    {
+      return HTTP_PARSER_ERR_FORMAT;
+    }
+    p->content_length = length;
+  }
+  else if (strcasecmp(name, "Transfer-Encoding") == 0)
+  {
+    p->chunked = http_value_has(value, "chunked");
+  }
+  else if (strcasecmp(name, "Connection") == 0)
+  {
+    if (http_value_has(value, "close"))
+    {
+      p->keep_alive = 0;
+    }
+    else if (http_value_has(value, "keep-alive"))
+    {
+      p->keep_alive = 1;
+    }
+  }
+  if (p->cb != NULL && p->cb->on_header != NULL && p->cb->on_header(p->arg, name, value))
+  {
+    return HTTP_PARSER_ERR_CALLBACK;
+  }
+  return 0;
+}
+
+/**
+ * 交出一段响应体
+ * @param[in]   p     :解析器
+ * @param[in]   data  :数据
+ * @param[in]   len   :长度
+ * @retval      0:成功 HTTP_PARSER_ERR_CALLBACK:回调要求停止
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int http_body(http_resp_parser_t *p, const uint8_t *data, size_t len)
+{
+  p->body_len += len;
+  if (p->cb != NULL && p->cb->on_body != NULL && p->cb->on_body(p->arg, data, len))
+  {
+    return HTTP_PARSER_ERR_CALLBACK;
+  }
+  return 0;
+}
+
+/**
+ * 初始化响应解析器,准备解析一个新的响应
+ * @param[in]   p     :解析器
+ * @param[in]   cb    :回调,可以为NULL
+ * @param[in]   arg   :回调参数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void http_resp_parser_init(http_resp_parser_t *p, const http_parser_cb_t *cb, void *arg)
+{
+  memset(p, 0, sizeof(*p));
+  p->state = HP_STATUS;
+  p->content_length = -1;
+  p->cb = cb;
+  p->arg = arg;
+}
+
+/**
+ * 喂入一段响应数据,响应结束时停止消费,后面的数据属于下一个响应
+ * @param[in]   p     :解析器
+ * @param[in]   data  :数据
+ * @param[in]   len   :长度
+ * @retval
+ *              >=0:消费的字节数,小于len说明响应已结束
+ *              HTTP_PARSER_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int http_resp_parser_feed(http_resp_parser_t *p, const uint8_t *data, size_t len)
+{
+  size_t i = 0;
+  size_t n;
+  int ret = 0;
+  uint8_t c;
+  while (i < len && p->state != HP_DONE)
+  {
+    c = data[i];
+    switch (p->state)
+    {
+    case HP_STATUS:
+    case HP_HEADER:
+    case HP_TRAILER:
+      if (c != '\n')
+      {
+        /* \r留到行尾再去掉,超出缓存的部分丢弃 */
+        if (p->line_len < HTTP_PARSER_LINE_LEN - 1)
+        {
+          p->line[p->line_len++] = c;
+        }
+        if (p->line_total < 0xffff)
+        {
+          p->line_total++;
+        }
+        break;
+      }
+      if (p->line_len && p->line[p->line_len - 1] == '\r')
+      {
+        p->line_len--;
+        p->line_total--;
+      }
+      p->line[p->line_len] = 0;
+      if (p->state == HP_STATUS)
+      {
+        ret = http_status_line(p);
+        p->state = HP_HEADER;
+      }
+      else if (p->state == HP_HEADER)
+      {
+        ret = http_header_line(p);
+      }
+      else if (p->line_total == 0)
+      {
+        /* trailer以空行结束,其余行直接忽略 */
+        p->state = HP_DONE;
+      }
+      p->line_len = 0;
+      p->line_total = 0;
+      break;
+    case HP_BODY:
+      n = len - i < p->left ? len - i : p->left;
+      ret = http_body(p, data + i, n);
+      p->left -= n;
+      i += n;
+      if (p->left == 0)
+      {
+        p->state = HP_DONE;
+      }
+      if (ret)
+      {
+        goto error;
+      }
+      continue;
+    case HP_BODY_CLOSE:
+      ret = http_body(p, data + i, len - i);
+      i = len;
+      if (ret)
+      {
+        goto error;
+      }
+      continue;
+    case HP_CHUNK_SIZE:
+      if (c >= '0' && c <= '9')
+      {
+        c -= '0';
+      }
+      else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+      {
+        c = (c | 0x20) - 'a' + 10;
+      }
+      else if (p->line_total && (c == ';' || c == ' ' || c == '\t' || c == '\r'))
+      {
+        p->state = HP_CHUNK_EXT;
+        break;
+      }
+      else if (p->line_total && c == '\n')
+      {
+        p->state = p->left ? HP_CHUNK_DATA : HP_TRAILER;
+        p->line_total = 0;
+        break;
+      }
+      else
+      {
+        ret = HTTP_PARSER_ERR_FORMAT;
+        break;
+      }
+      /* 块长度超过28位时必然是错误数据 */
+      if (p->left >> 28)
+      {
+        ret = HTTP_PARSER_ERR_FORMAT;
+        break;
+      }
+      p->left = (p->left << 4) | c;
+      p->line_total++;
+      break;
+    case HP_CHUNK_EXT:
+      if (c == '\n')
+      {
+        p->state = p->left ? HP_CHUNK_DATA : HP_TRAILER;
+        p->line_total = 0;
+      }
+      break;
+    case HP_CHUNK_DATA:
+      n = len - i < p->left ? len - i : p->left;
+      ret = http_body(p, data + i, n);
+      p->left -= n;
+      i += n;
+      if (p->left == 0)
+      {
+        p->state = HP_CHUNK_CR;
+      }
+      if (ret)
+      {
+        goto error;
+      }
+      continue;
+    case HP_CHUNK_CR:
+      if (c != '\r')
+      {
+        ret = HTTP_PARSER_ERR_FORMAT;
+      }
+      p->state = HP_CHUNK_LF;
+      break;
+    case HP_CHUNK_LF:
+      if (c != '\n')
+      {
+        ret = HTTP_PARSER_ERR_FORMAT;
+      }
+      p->state = HP_CHUNK_SIZE;
+      break;
+    default:
+      return HTTP_PARSER_ERR_FORMAT;
+    }
+    if (ret)
+    {
+      goto error;
+    }
+    i++;
+  }
+  return i;
+error:
+  p->state = HP_ERROR;
+  return ret;
+}
+
+/**
+ * 连接已关闭,没有Content-Length也不是chunked的响应到此结束
+ * @param[in]   p     :解析器
+ * @retval
+ *              0:响应完整
+ *              HTTP_PARSER_ERR_EOF:响应不完整
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int http_resp_parser_finish(http_resp_parser_t *p)
+{
+  if (p->state == HP_BODY_CLOSE)
+  {
+    p->state = HP_DONE;
+  }
+  return p->state == HP_DONE ? 0 : HTTP_PARSER_ERR_EOF;
+}
+
+/**
+ * 响应是否已经完整解析
+ * @param[in]   p     :解析器
+ * @retval      1:完整 0:还需要数据
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int http_resp_parser_done(const http_resp_parser_t *p)
+{
+  return p->state == HP_DONE;
+}
@@ -0,0 +1,650 @@
+/**
+* @file         user_https_client.c
+* @brief        可复用的HTTPS客户端相关函数定义
+* @details      mbedtls的上下文、TLS配置和CTR-DRBG在初始化时建立一次,之后一直复用;
+*               同一主机的请求复用HTTP/1.1 keep-alive连接,连接断开后带上保存的会话重连,
+*               服务器支持session ticket或session id时只需一次简短握手
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 响应改由user_http_parser流式解析,增加回调方式的请求接口\n
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 支持HTTP/1.1流水线,同一连接上连续发出多个GET请求\n
+*               Ver0.0.4:
+                     Helon_Chan, 2026/10/17, 初始化时选择TLS配置档,统计每个连接握手和收发期间的堆峰值\n
+*               Ver0.0.5:
+                     Helon_Chan, 2026/10/17, 请求报文按路径长度生成\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include <stdio.h>
+#include "mbedtls/platform.h"
+#include "mbedtls/error.h"
+#include "user_https_client.h"
+#include "user_http_parser.h"
+#include "user_http_s.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define HTTPS_CLIENT_TAG              "https_client"
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* https_client_request把响应体拷进调用者缓存时的状态 */
+typedef struct
+{
+  char     *body;
+  size_t   body_size;
+  size_t   body_len;
+  size_t   dropped;                                     ///<放不下而丢弃的字节
+} https_body_t;
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 响应体回调,保存到调用者的缓存,放不下的部分丢弃并计数
+ * @param[in]   arg   :https_body_t
+ * @param[in]   data  :数据
+ * @param[in]   len   :长度
+ * @retval      0:继续解析
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int https_body_put(void *arg, const uint8_t *data, size_t len)
+{
+  https_body_t *b = (https_body_t *)arg;
+  size_t room = b->body_size - 1 - b->body_len;
+  if (len > room)
+  {
+    b->dropped += len - room;
+    len = room;
+  }
+  memcpy(b->body + b->body_len, data, len);
+  b->body_len += len;
+  return 0;
+}
+
+/**
+ * 读一次TLS数据,屏蔽WANT_READ/WANT_WRITE
+ * @param[in]   client  :客户端
+ * @param[out]  buf     :存放数据
+ * @param[in]   len     :buf大小
+ * @retval
+ *              >0:读到的字节数
+ *              0:对方关闭了连接
+ *              <0:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int https_client_read(https_client_t *client, uint8_t *buf, size_t len)
+{
+  int ret;
+  do
+  {
+    ret = mbedtls_ssl_read(&client->ssl_ctx, buf, len);
+  } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+  if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY)
+  {
+    ret = 0;
+  }
+  return ret;
+}
+
+/**
+ * 关闭当前连接,保留会话用于下次恢复
+ * @param[in]   client  :客户端
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void https_client_close(https_client_t *client)
+{
+  if (client->connected)
+  {
+    mbedtls_ssl_close_notify(&client->ssl_ctx);
+    client->connected = 0;
+  }
+  mbedtls_net_free(&client->net_ctx);
+}
+
+/**
+ * 建立TCP连接并握手,有保存的会话时尝试恢复
+ * @param[in]   client  :客户端,host和port已经填好
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 统计握手期间的堆峰值\n
+ */
+static int https_client_connect(https_client_t *client)
+{
+  int ret;
+  int nodelay = 1;
+  uint8_t resumed;
+  int64_t start = esp_timer_get_time();
+  /* 连接总在同一个任务里建立和收发,之后mbedtls申请的内存都记到这个客户端上 */
+  tls_heap_begin(&client->heap);
+  /* 复位ssl上下文,收发缓存保留不重新申请 */
+  if ((ret = mbedtls_ssl_session_reset(&client->ssl_ctx)) != 0)
+  {
+    return ret;
+  }
+  if ((ret = mbedtls_ssl_set_hostname(&client->ssl_ctx, client->host)) != 0)
+  {
+    return ret;
+  }
+  if ((ret = mbedtls_net_connect(&client->net_ctx, client->host, client->port, MBEDTLS_NET_PROTO_TCP)) != 0)
+  {
+    ESP_LOGI(HTTPS_CLIENT_TAG, "mbedtls_net_connect returned -0x%x\n", -ret);
+    return ret;
+  }
+  /* 简短握手最后由客户端发Finished,紧接着就是请求,服务器在这中间不回数据,
+     不关Nagle的话请求要等到服务器的延迟ACK才发出 */
+  setsockopt(client->net_ctx.fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+  mbedtls_ssl_set_bio(&client->ssl_ctx, &client->net_ctx, mbedtls_net_send, NULL, mbedtls_net_recv_timeout);
+  /* 带上之前的会话,服务器接受时走简短握手,不接受时自动退回完整握手 */
+  if (client->session_valid && mbedtls_ssl_set_session(&client->ssl_ctx, &client->session) != 0)
+  {
+    client->session_valid = 0;
+  }
+  while ((ret = mbedtls_ssl_handshake(&client->ssl_ctx)) != 0)
+  {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      ESP_LOGI(HTTPS_CLIENT_TAG, "mbedtls_ssl_handshake returned -0x%x\n", -ret);
+      mbedtls_net_free(&client->net_ctx);
+      /* 会话可能已被服务器拒绝,下次从完整握手开始 */
+      client->session_valid = 0;
+      return ret;
+    }
+  }
+  client->connected = 1;
+  tls_heap_steady(&client->heap);
+  client->stats.last_handshake_us = esp_timer_get_time() - start;
+  /* 恢复的会话沿用原来的主密钥,完整握手会协商出新的主密钥 */
+  resumed = client->session_valid &&
+            memcmp(client->ssl_ctx.session->master, client->session.master, sizeof(client->session.master)) == 0;
+  if (resumed)
+  {
+    client->stats.resumed_handshakes++;
+  }
+  else
+  {
+    client->stats.full_handshakes++;
+  }
+  /* 保存本次会话,服务器可能在握手中下发了新的ticket */
+  mbedtls_ssl_session_free(&client->session);
+  mbedtls_ssl_session_init(&client->session);
+  client->session_valid = mbedtls_ssl_get_session(&client->ssl_ctx, &client->session) == 0;
+  ESP_LOGI(HTTPS_CLIENT_TAG, "%s handshake with %s in %d ms, heap peak %u, now %u\n", resumed ? "resumed" : "full",
+           client->host, (int)(client->stats.last_handshake_us / 1000),
+           client->heap.handshake_peak, client->heap.current);
+  return 0;
+}
+
+/**
+ * 在已建立的连接上发送请求,并把响应边读边交给解析器
+ * 流水线的多个响应可能在同一次读到的数据里,按解析器消费的字节数切分
+ * 连接不能再复用时在这里关闭
+ * @param[in]   client    :客户端
+ * @param[in]   len       :client->buf中请求报文的长度
+ * @param[in]   reqs      :请求报文对应的请求,结果写回status
+ * @param[in]   count     :请求数
+ * @param[out]  done      :完整收到响应的请求数
+ * @param[out]  rx_bytes  :第一个未完成请求收到的响应字节数,用于判断失效连接能否安全重发
+ * @retval
+ *              0:成功,done小于count时是服务器要求关闭连接,其余请求需重连后重发
+ *              其他:HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 改用流式响应解析器,响应头不再整块缓存\n
+ *               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 支持流水线的多个响应\n
+ */
+static int https_client_exchange(https_client_t *client, size_t len, https_client_req_t *reqs, uint8_t count,
+                                 uint8_t *done, size_t *rx_bytes)
+{
+  int ret;
+  int used;
+  size_t sent = 0;
+  size_t off = 0;
+  size_t end = 0;
+  http_resp_parser_t parser;
+  *done = 0;
+  *rx_bytes = 0;
+  /* mbedtls_ssl_write可能只写出一部分 */
+  while (sent < len)
+  {
+    ret = mbedtls_ssl_write(&client->ssl_ctx, client->buf + sent, len - sent);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      continue;
+    }
+    if (ret <= 0)
+    {
+      https_client_close(client);
+      return ret ? ret : HTTPS_CLIENT_ERR_CLOSED;
+    }
+    sent += ret;
+  }
+  http_resp_parser_init(&parser, reqs[0].cb, reqs[0].arg);
+  while (*done < count)
+  {
+    if (off == end)
+    {
+      ret = https_client_read(client, client->buf, sizeof(client->buf));
+      if (ret <= 0)
+      {
+        /* 没有长度的响应体以连接关闭结束 */
+        if (ret == 0)
+        {
+          ret = *rx_bytes ? http_resp_parser_finish(&parser) : HTTPS_CLIENT_ERR_CLOSED;
+        }
+        reqs[*done].status = parser.status;
+        if (ret == 0)
+        {
+          (*done)++;
+          *rx_bytes = 0;
+        }
+        https_client_close(client);
+        return ret;
+      }
+      off = 0;
+      end = ret;
+    }
+    used = http_resp_parser_feed(&parser, client->buf + off, end - off);
+    if (used < 0)
+    {
+      reqs[*done].status = parser.status;
+      https_client_close(client);
+      return used;
+    }
+    off += used;
+    *rx_bytes += used;
+    if (http_resp_parser_done(&parser))
+    {
+      reqs[(*done)++].status = parser.status;
+      *rx_bytes = 0;
+      if (!parser.keep_alive)
+      {
+        https_client_close(client);
+        return 0;
+      }
+      if (*done < count)
+      {
+        http_resp_parser_init(&parser, reqs[*done].cb, reqs[*done].arg);
+      }
+    }
+  }
+  /* 发出的请求都已收到响应,后面不应该还有数据,连接已不同步 */
+  if (off < end)
+  {
+    https_client_close(client);
+  }
+  return 0;
+}
+
+/**
+ * 生成Host请求头的值:IPv6地址加上方括号,端口不是默认的443时带上端口
+ * @param[in]   client    :客户端
+ * @param[out]  hdr       :Host请求头的值
+ * @param[in]   size      :hdr的大小
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void https_client_host_header(const https_client_t *client, char *hdr, size_t size)
+{
+  int len = snprintf(hdr, size, strchr(client->host, ':') != NULL ? "[%s]" : "%s", client->host);
+  if (strcmp(client->port, REMOTE_PORT) != 0 && len >= 0 && (size_t)len < size)
+  {
+    snprintf(hdr + len, size - len, ":%s", client->port);
+  }
+}
+
+/**
+ * 把尽可能多的请求报文依次写进client->buf,POST请求每次只发一个
+ * @param[in]   client    :客户端
+ * @param[in]   method    :GET_REQ或者POST_REQ
+ * @param[in]   reqs      :请求
+ * @param[in]   count     :请求数
+ * @param[out]  n         :写进去的请求数,0表示第一个请求就放不下
+ * @retval      请求报文的总长度
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 路径按path_len截取,不再要求以'\0'结尾\n
+ */
+static size_t https_client_build(https_client_t *client, uint8_t method, const https_client_req_t *reqs,
+                                 uint8_t count, uint8_t *n)
+{
+  int len;
+  size_t total = 0;
+  char *buf = (char *)client->buf;
+  size_t size = sizeof(client->buf);
+  char host[HTTPS_CLIENT_HOST_LEN + sizeof(client->port) + 2];
+  https_client_host_header(client, host, sizeof(host));
+  for (*n = 0; *n < count; (*n)++)
+  {
+    /* 路径比请求缓存还长时snprintf的精度会溢出,直接当作放不下 */
+    if (reqs[*n].path_len >= size)
+    {
+      break;
+    }
+    if (method == GET_REQ)
+    {
+      len = snprintf(buf + total, size - total, GET, (int)reqs[*n].path_len, reqs[*n].path, host);
+    }
+    else if (*n == 0)
+    {
+      len = snprintf(buf + total, size - total, POST, (int)reqs[*n].path_len, reqs[*n].path,
+                     (int)strlen(POST_CONTENT), host, POST_CONTENT);
+    }
+    else
+    {
+      break;
+    }
+    if (len < 0 || (size_t)len >= size - total)
+    {
+      break;
+    }
+    total += len;
+  }
+  return total;
+}
+
+/**
+ * 依次完成一组请求,GET请求在同一连接上流水线发送
+ * 复用的连接在下一个响应的第一个字节之前就断了,说明服务器已经关闭了它,GET请求重连后从这个请求开始重发
+ * @param[in]   client    :客户端
+ * @param[in]   method    :GET_REQ或者POST_REQ
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   reqs      :请求,结果写回每一项的status和ret
+ * @param[in]   count     :请求数
+ * @retval
+ *              0:全部成功
+ *              其他:第一个失败请求的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本,由https_client_request_cb拆出\n
+ */
+static int https_client_run(https_client_t *client, uint8_t method, const char *host, const char *port,
+                            https_client_req_t *reqs, uint8_t count)
+{
+  int ret = 0;
+  uint8_t reused, n, got, done = 0;
+  size_t len, rx_bytes;
+  if (strlen(host) >= sizeof(client->host) || strlen(port) >= sizeof(client->port))
+  {
+    ret = HTTPS_CLIENT_ERR_ARG;
+    count = 0;
+  }
+  /* 换了主机,原来的连接和会话都不能再用 */
+  else if (strcmp(host, client->host) || strcmp(port, client->port))
+  {
+    https_client_close(client);
+    client->session_valid = 0;
+    strcpy(client->host, host);
+    strcpy(client->port, port);
+  }
+  client->stats.requests += count;
+  while (done < count)
+  {
+    /* 空闲太久的连接多半已被服务器关掉,直接重连恢复会话,省去一次注定失败的发送 */
+    if (client->connected &&
+        xTaskGetTickCount() - client->last_used > pdMS_TO_TICKS(HTTPS_CLIENT_IDLE_MS))
+    {
+      https_client_close(client);
+    }
+    reused = client->connected;
+    if (!reused && (ret = https_client_connect(client)) != 0)
+    {
+      break;
+    }
+    /* 读响应时会覆盖buf,重发时需要重新生成请求报文 */
+    len = https_client_build(client, method, reqs + done, count - done, &n);
+    if (n == 0)
+    {
+      ret = HTTPS_CLIENT_ERR_ARG;
+      break;
+    }
+    client->stats.keepalive_reuses += reused ? n : n - 1;
+    client->stats.pipelined += n - 1;
+    ret = https_client_exchange(client, len, reqs + done, n, &got, &rx_bytes);
+    /* POST不是幂等的,服务器可能已经处理过,不自动重发 */
+    if (ret != 0 && rx_bytes == 0 && (reused || got > 0) && method == GET_REQ)
+    {
+      client->stats.retries++;
+      ret = 0;
+    }
+    done += got;
+    if (ret != 0)
+    {
+      break;
+    }
+    if (client->connected)
+    {
+      client->last_used = xTaskGetTickCount();
+    }
+  }
+  for (n = 0; n < count; n++)
+  {
+    reqs[n].ret = n < done ? 0 : ret;
+  }
+  return ret;
+}
+
+/**
+ * 初始化HTTPS客户端,播种随机数发生器并建立TLS配置,只需调用一次
+ * @param[in]   client  :客户端
+ * @param[in]   profile :TLS配置档,TLS_PROFILE_xxx
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加TLS配置档参数,收发缓存记到客户端的堆统计上\n
+ */
+int https_client_init(https_client_t *client, uint8_t profile)
+{
+  int ret;
+  memset(client, 0, sizeof(*client));
+  tls_heap_begin(&client->heap);
+  mbedtls_net_init(&client->net_ctx);
+  mbedtls_ssl_init(&client->ssl_ctx);
+  mbedtls_ssl_config_init(&client->ssl_conf);
+  mbedtls_ctr_drbg_init(&client->ctr_drbg);
+  mbedtls_entropy_init(&client->entropy);
+  mbedtls_ssl_session_init(&client->session);
+  if ((ret = mbedtls_ctr_drbg_seed(&client->ctr_drbg, mbedtls_entropy_func, &client->entropy, NULL, 0)) != 0)
+  {
+    ESP_LOGI(HTTPS_CLIENT_TAG, "mbedtls_ctr_drbg_seed returned %d\n", ret);
+    goto exit;
+  }
+  if ((ret = mbedtls_ssl_config_defaults(&client->ssl_conf,
+                                         MBEDTLS_SSL_IS_CLIENT,
+                                         MBEDTLS_SSL_TRANSPORT_STREAM,
+                                         MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+  {
+    ESP_LOGI(HTTPS_CLIENT_TAG, "mbedtls_ssl_config_defaults returned %d\n", ret);
+    goto exit;
+  }
+  /* 由于证书会过期,所以这些不进行证书认证 */
+  mbedtls_ssl_conf_authmode(&client->ssl_conf, MBEDTLS_SSL_VERIFY_NONE);
+  mbedtls_ssl_conf_rng(&client->ssl_conf, mbedtls_ctr_drbg_random, &client->ctr_drbg);
+  mbedtls_ssl_conf_dbg(&client->ssl_conf, NULL, NULL);
+  mbedtls_ssl_conf_read_timeout(&client->ssl_conf, HTTPS_CLIENT_TIMEOUT_MS);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  /* 服务器支持时优先用ticket恢复,服务器不用保存会话缓存 */
+  mbedtls_ssl_conf_session_tickets(&client->ssl_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+  if ((ret = tls_profile_apply(&client->ssl_conf, profile)) != 0)
+  {
+    ESP_LOGI(HTTPS_CLIENT_TAG, "tls_profile_apply returned -0x%x\n", -ret);
+    goto exit;
+  }
+  if ((ret = mbedtls_ssl_setup(&client->ssl_ctx, &client->ssl_conf)) != 0)
+  {
+    ESP_LOGI(HTTPS_CLIENT_TAG, "mbedtls_ssl_setup returned %d\n", ret);
+    goto exit;
+  }
+  tls_heap_end();
+  return 0;
+exit:
+  tls_heap_end();
+  https_client_deinit(client);
+  return ret;
+}
+
+/**
+ * 关闭连接并释放HTTPS客户端的所有资源
+ * @param[in]   client  :客户端
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void https_client_deinit(https_client_t *client)
+{
+  https_client_close(client);
+  mbedtls_ssl_session_free(&client->session);
+  mbedtls_ssl_free(&client->ssl_ctx);
+  mbedtls_ssl_config_free(&client->ssl_conf);
+  mbedtls_ctr_drbg_free(&client->ctr_drbg);
+  mbedtls_entropy_free(&client->entropy);
+  client->session_valid = 0;
+}
+
+/**
+ * 发起一次HTTPS请求,响应头和响应体边收边通过回调交出,连接可复用时保持连接
+ * 复用的连接已被服务器关闭时,自动用保存的会话重连,GET请求重发一次,POST请求不重发
+ * @param[in]   client    :客户端
+ * @param[in]   method    :GET_REQ或者POST_REQ
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   path      :主机名后面的路径,不含开头的'/'
+ * @param[in]   cb        :响应回调,可以为NULL
+ * @param[in]   arg       :回调参数
+ * @retval
+ *              0:成功,HTTP状态码见client->status
+ *              HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 连接和重发的处理移到https_client_run\n
+ *               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 请求带上路径长度\n
+ */
+int https_client_request_cb(https_client_t *client, uint8_t method, const char *host, const char *port,
+                            const char *path, const http_parser_cb_t *cb, void *arg)
+{
+  int ret;
+  https_client_req_t req = {path, strlen(path), cb, arg, 0, 0};
+  ret = https_client_run(client, method, host, port, &req, 1);
+  client->status = req.status;
+  return ret;
+}
+
+/**
+ * 在同一个连接上连续发出多个GET请求,再依次读回各自的响应,省去每个请求一次往返的等待
+ * 请求报文放不下client->buf时分批发送;服务器中途关闭连接时,还没收到响应的请求重连后重发
+ * @param[in]   client    :客户端
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   reqs      :请求,结果写回每一项的status和ret
+ * @param[in]   count     :请求数
+ * @retval
+ *              0:全部成功
+ *              HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码:第一个失败请求的错误码,
+ *              它后面的请求也以此失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_client_pipeline(https_client_t *client, const char *host, const char *port,
+                          https_client_req_t *reqs, uint8_t count)
+{
+  return https_client_run(client, GET_REQ, host, port, reqs, count);
+}
+
+/**
+ * 发起一次HTTPS请求并读完响应,连接可复用时保持连接
+ * 复用的连接已被服务器关闭时,自动用保存的会话重连,GET请求重发一次,POST请求不重发
+ * @param[in]   client    :客户端
+ * @param[in]   method    :GET_REQ或者POST_REQ
+ * @param[in]   host      :主机名
+ * @param[in]   port      :端口
+ * @param[in]   path      :主机名后面的路径,不含开头的'/'
+ * @param[out]  body      :存放响应体,以'\0'结尾
+ * @param[in]   body_size :body的大小
+ * @retval
+ *              >=0:响应体长度,HTTP状态码见client->status
+ *              HTTPS_CLIENT_ERR_xxx、HTTP_PARSER_ERR_xxx或者mbedtls的错误码:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 基于https_client_request_cb实现\n
+ */
+int https_client_request(https_client_t *client, uint8_t method, const char *host, const char *port,
+                         const char *path, char *body, size_t body_size)
+{
+  static const http_parser_cb_t cb = {NULL, https_body_put};
+  https_body_t b;
+  int ret;
+  if (body == NULL || body_size == 0)
+  {
+    return HTTPS_CLIENT_ERR_ARG;
+  }
+  memset(&b, 0, sizeof(b));
+  b.body = body;
+  b.body_size = body_size;
+  ret = https_client_request_cb(client, method, host, port, path, &cb, &b);
+  body[b.body_len] = 0;
+  if (ret != 0)
+  {
+    return ret;
+  }
+  if (b.dropped)
+  {
+    return HTTPS_CLIENT_ERR_TOO_LONG;
+  }
+  return b.body_len;
+}
@@ -0,0 +1,462 @@
+/**
+* @file         user_https_sched.c
+* @brief        多个HTTPS请求并发调度的相关函数定义
+* @details      每个工作任务独占连接池中的一个https_client,空闲时从请求表中挑选请求:
+*               先挑自己已连上的主机的请求,保持keep-alive;
+*               再挑没有其他空闲连接连着、且在用连接数未到上限的主机的请求,
+*               同一主机排队的请求一次最多取HTTPS_SCHED_PIPELINE个流水线发出
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 连接池按HTTPS_SCHED_TLS_PROFILE建立TLS配置\n
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 请求的路径带长度,可以直接指向URL\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include <stdio.h>
+#include "user_https_sched.h"
+#include "esp_log.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define HTTPS_SCHED_TAG               "https_sched"
+
+/*
+===========================
+枚举变量
+===========================
+*/
+/* 请求的状态 */
+enum
+{
+  JOB_FREE,
+  JOB_QUEUED,
+  JOB_RUNNING,
+};
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 判断请求是否发往指定的主机和端口
+ * @param[in]   job   :请求
+ * @param[in]   host  :主机名
+ * @param[in]   port  :端口
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t https_sched_same_host(const https_sched_job_t *job, const char *host, const char *port)
+{
+  return strcmp(job->host, host) == 0 && strcmp(job->port, port) == 0;
+}
+
+/**
+ * 判断连接能否处理这个请求,调用时已持有lock
+ * @param[in]   sched :调度器
+ * @param[in]   conn  :挑选请求的连接,空闲
+ * @param[in]   job   :排队中的请求
+ * @retval      1:能 0:不能
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t https_sched_eligible(const https_sched_t *sched, const https_sched_conn_t *conn,
+                                    const https_sched_job_t *job)
+{
+  uint8_t i, in_use = 0;
+  const https_sched_conn_t *other;
+  for (i = 0; i < HTTPS_SCHED_CONNS; i++)
+  {
+    other = &sched->conns[i];
+    if (other == conn)
+    {
+      continue;
+    }
+    if (other->job != NULL)
+    {
+      in_use += https_sched_same_host(job, other->job->host, other->job->port);
+    }
+    /* 另一个空闲连接已连着这个主机,留给它复用 */
+    else if (other->client.connected && https_sched_same_host(job, other->client.host, other->client.port))
+    {
+      return 0;
+    }
+  }
+  return in_use < HTTPS_SCHED_HOST_CONNS;
+}
+
+/**
+ * 为空闲的连接挑选一批发往同一主机的请求,调用时已持有lock
+ * @param[in]   sched :调度器
+ * @param[in]   conn  :空闲的连接
+ * @param[out]  batch :挑出的请求,按提交顺序
+ * @retval      挑出的请求数,0表示没有可处理的请求
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t https_sched_pick(https_sched_t *sched, https_sched_conn_t *conn, https_sched_job_t **batch)
+{
+  uint8_t i, n;
+  https_sched_job_t *job;
+  https_sched_job_t *first = NULL;
+  https_sched_job_t *own = NULL;
+  for (i = 0; i < HTTPS_SCHED_MAX_JOBS; i++)
+  {
+    job = &sched->jobs[i];
+    if (job->state != JOB_QUEUED)
+    {
+      continue;
+    }
+    /* seq回绕时用差值比较先后 */
+    if (conn->client.connected && https_sched_same_host(job, conn->client.host, conn->client.port))
+    {
+      if (own == NULL || (int32_t)(job->seq - own->seq) < 0)
+      {
+        own = job;
+      }
+    }
+    else if ((first == NULL || (int32_t)(job->seq - first->seq) < 0) && https_sched_eligible(sched, conn, job))
+    {
+      first = job;
+    }
+  }
+  if (own != NULL)
+  {
+    first = own;
+  }
+  if (first == NULL)
+  {
+    return 0;
+  }
+  /* 同一主机的请求按提交顺序取,直到取满一批 */
+  batch[0] = first;
+  first->state = JOB_RUNNING;
+  for (n = 1; n < HTTPS_SCHED_PIPELINE; n++)
+  {
+    batch[n] = NULL;
+    for (i = 0; i < HTTPS_SCHED_MAX_JOBS; i++)
+    {
+      job = &sched->jobs[i];
+      if (job->state == JOB_QUEUED && https_sched_same_host(job, first->host, first->port) &&
+          (batch[n] == NULL || (int32_t)(job->seq - batch[n]->seq) < 0))
+      {
+        batch[n] = job;
+      }
+    }
+    if (batch[n] == NULL)
+    {
+      break;
+    }
+    batch[n]->state = JOB_RUNNING;
+  }
+  conn->job = first;
+  return n;
+}
+
+/**
+ * 唤醒所有工作任务重新挑选请求
+ * @param[in]   sched :调度器
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void https_sched_wake(https_sched_t *sched)
+{
+  uint8_t i;
+  for (i = 0; i < HTTPS_SCHED_CONNS; i++)
+  {
+    xTaskNotifyGive(sched->conns[i].task);
+  }
+}
+
+/**
+ * 工作任务,反复挑选一批请求,在自己的连接上流水线发出,逐个回调结果
+ * @param[in]   pvParameters  :https_sched_conn_t
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 交给客户端的请求带上路径长度\n
+ */
+static void https_sched_task(void *pvParameters)
+{
+  uint8_t i, n;
+  https_sched_conn_t *conn = (https_sched_conn_t *)pvParameters;
+  https_sched_t *sched = conn->sched;
+  https_sched_job_t *batch[HTTPS_SCHED_PIPELINE];
+  https_sched_done_t done[HTTPS_SCHED_PIPELINE];
+  https_client_req_t reqs[HTTPS_SCHED_PIPELINE];
+  while (1)
+  {
+    xSemaphoreTake(sched->lock, portMAX_DELAY);
+    n = https_sched_pick(sched, conn, batch);
+    xSemaphoreGive(sched->lock);
+    if (n == 0)
+    {
+      /* 提交请求或者其他连接空出来时会被唤醒,之前的唤醒不会丢失 */
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    for (i = 0; i < n; i++)
+    {
+      reqs[i].path = batch[i]->path;
+      reqs[i].path_len = batch[i]->path_len;
+      reqs[i].cb = batch[i]->cb;
+      reqs[i].arg = batch[i]->arg;
+      reqs[i].status = 0;
+      done[i] = batch[i]->done;
+    }
+    https_client_pipeline(&conn->client, batch[0]->host, batch[0]->port, reqs, n);
+    /* 先归还请求表项再回调,回调中可以马上提交新的请求 */
+    xSemaphoreTake(sched->lock, portMAX_DELAY);
+    for (i = 0; i < n; i++)
+    {
+      batch[i]->state = JOB_FREE;
+    }
+    conn->job = NULL;
+    xSemaphoreGive(sched->lock);
+    https_sched_wake(sched);
+    for (i = 0; i < n; i++)
+    {
+      if (done[i] != NULL)
+      {
+        done[i](reqs[i].arg, reqs[i].ret, reqs[i].status);
+      }
+    }
+  }
+}
+
+/**
+ * 释放调度器已建立的工作任务、客户端和锁,调用时已持有lock
+ * 工作任务只会阻塞在lock上,不会持有它,可以直接删除
+ * @param[in]   sched   :调度器
+ * @param[in]   inited  :已经初始化了客户端的连接数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void https_sched_unwind(https_sched_t *sched, uint8_t inited)
+{
+  uint8_t i;
+  for (i = 0; i < inited; i++)
+  {
+    if (sched->conns[i].task != NULL)
+    {
+      vTaskDelete(sched->conns[i].task);
+      sched->conns[i].task = NULL;
+    }
+    https_client_deinit(&sched->conns[i].client);
+  }
+  xSemaphoreGive(sched->lock);
+  vSemaphoreDelete(sched->lock);
+  sched->lock = NULL;
+}
+
+/**
+ * 初始化调度器,建立连接池的客户端并创建工作任务,只需调用一次
+ * 失败时已建立的任务和客户端全部释放,可以再次调用
+ * @param[in]   sched   :调度器,必须一直有效
+ * @retval
+ *              0:成功
+ *              其他:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 按HTTPS_SCHED_TLS_PROFILE初始化客户端\n
+ */
+int https_sched_init(https_sched_t *sched)
+{
+  int ret;
+  uint8_t i;
+  memset(sched, 0, sizeof(*sched));
+  sched->lock = xSemaphoreCreateMutex();
+  if (sched->lock == NULL)
+  {
+    return -1;
+  }
+  /* 全部建好之前持有lock,已创建的工作任务停在lock上,失败时可以安全删除 */
+  xSemaphoreTake(sched->lock, portMAX_DELAY);
+  for (i = 0; i < HTTPS_SCHED_CONNS; i++)
+  {
+    sched->conns[i].sched = sched;
+    if ((ret = https_client_init(&sched->conns[i].client, HTTPS_SCHED_TLS_PROFILE)) != 0)
+    {
+      ESP_LOGI(HTTPS_SCHED_TAG, "https_client_init failed,reason is -0x%x\n", -ret);
+      /* https_client_init失败时已自行释放 */
+      https_sched_unwind(sched, i);
+      return ret;
+    }
+    ret = xTaskCreate(https_sched_task,
+                      "https_sched_task",
+                      HTTPS_SCHED_STACK,
+                      &sched->conns[i],
+                      HTTPS_SCHED_PRIO,
+                      &sched->conns[i].task);
+    if (ret != pdPASS)
+    {
+      ESP_LOGI(HTTPS_SCHED_TAG, "https_sched_task create failure,reason is %d\n", ret);
+      sched->conns[i].task = NULL;
+      https_sched_unwind(sched, i + 1);
+      return -1;
+    }
+  }
+  xSemaphoreGive(sched->lock);
+  return 0;
+}
+
+/**
+ * 占用一个空闲的请求表项并填好主机和端口,返回时仍持有lock
+ * @param[in]   sched     :调度器
+ * @param[in]   host      :主机名,不需要以'\0'结尾
+ * @param[in]   host_len  :主机名长度
+ * @param[in]   port      :端口
+ * @param[out]  job       :占用的请求表项
+ * @retval
+ *              0:成功,调用者填完其余字段后置为JOB_QUEUED再释放lock
+ *              HTTPS_CLIENT_ERR_ARG:主机名或端口过长,未持有lock
+ *              HTTPS_SCHED_ERR_FULL:排队的请求已满,未持有lock
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本,由https_sched_get拆出\n
+ */
+static int https_sched_alloc(https_sched_t *sched, const char *host, size_t host_len, const char *port,
+                             https_sched_job_t **job)
+{
+  uint8_t i;
+  if (host_len >= sizeof((*job)->host) || strlen(port) >= sizeof((*job)->port))
+  {
+    return HTTPS_CLIENT_ERR_ARG;
+  }
+  xSemaphoreTake(sched->lock, portMAX_DELAY);
+  for (i = 0; i < HTTPS_SCHED_MAX_JOBS; i++)
+  {
+    if (sched->jobs[i].state == JOB_FREE)
+    {
+      *job = &sched->jobs[i];
+      memcpy((*job)->host, host, host_len);
+      (*job)->host[host_len] = '\0';
+      strcpy((*job)->port, port);
+      return 0;
+    }
+  }
+  xSemaphoreGive(sched->lock);
+  return HTTPS_SCHED_ERR_FULL;
+}
+
+/**
+ * 填好请求的其余字段并排队,唤醒工作任务,调用时已持有lock,返回时释放
+ * @param[in]   sched     :调度器
+ * @param[in]   job       :https_sched_alloc占用的请求表项
+ * @param[in]   path      :路径
+ * @param[in]   path_len  :路径长度
+ * @param[in]   cb        :响应回调
+ * @param[in]   arg       :cb和done的回调参数
+ * @param[in]   done      :完成回调
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本,由https_sched_get拆出\n
+ */
+static void https_sched_queue(https_sched_t *sched, https_sched_job_t *job, const char *path, size_t path_len,
+                              const http_parser_cb_t *cb, void *arg, https_sched_done_t done)
+{
+  job->path = path;
+  job->path_len = path_len;
+  job->cb = cb;
+  job->arg = arg;
+  job->done = done;
+  job->seq = sched->seq++;
+  job->state = JOB_QUEUED;
+  xSemaphoreGive(sched->lock);
+  https_sched_wake(sched);
+}
+
+/**
+ * 提交一个GET请求,立即返回,响应通过cb边收边交出,结束后调用done
+ * @param[in]   sched   :调度器
+ * @param[in]   host    :主机名
+ * @param[in]   port    :端口
+ * @param[in]   path    :主机名后面的路径,不含开头的'/',在done之前必须一直有效
+ * @param[in]   cb      :响应回调,可以为NULL
+ * @param[in]   arg     :cb和done的回调参数
+ * @param[in]   done    :完成回调,可以为NULL
+ * @retval
+ *              0:成功
+ *              HTTPS_CLIENT_ERR_ARG:主机名或端口过长
+ *              HTTPS_SCHED_ERR_FULL:排队的请求已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 占用表项和排队拆成https_sched_alloc和https_sched_queue\n
+ */
+int https_sched_get(https_sched_t *sched, const char *host, const char *port, const char *path,
+                    const http_parser_cb_t *cb, void *arg, https_sched_done_t done)
+{
+  int ret;
+  https_sched_job_t *job;
+  if ((ret = https_sched_alloc(sched, host, strlen(host), port, &job)) != 0)
+  {
+    return ret;
+  }
+  https_sched_queue(sched, job, path, strlen(path), cb, arg, done);
+  return 0;
+}
+
+/**
+ * 按url_parse的解析结果提交一个GET请求,路径直接指向URL,不拷贝
+ * @param[in]   sched   :调度器
+ * @param[in]   url     :URL,在done之前必须一直有效
+ * @param[in]   u       :url的解析结果
+ * @param[in]   cb      :响应回调,可以为NULL
+ * @param[in]   arg     :cb和done的回调参数
+ * @param[in]   done    :完成回调,可以为NULL
+ * @retval
+ *              0:成功
+ *              HTTPS_CLIENT_ERR_ARG:主机名过长或者端口未知
+ *              HTTPS_SCHED_ERR_FULL:排队的请求已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int https_sched_get_url(https_sched_t *sched, const char *url, const url_t *u,
+                        const http_parser_cb_t *cb, void *arg, https_sched_done_t done)
+{
+  int ret;
+  char port[8];
+  https_sched_job_t *job;
+  if (u->port_num == 0)
+  {
+    return HTTPS_CLIENT_ERR_ARG;
+  }
+  snprintf(port, sizeof(port), "%u", u->port_num);
+  if ((ret = https_sched_alloc(sched, url + u->host.off, u->host.len, port, &job)) != 0)
+  {
+    return ret;
+  }
+  https_sched_queue(sched, job, url + u->target.off, u->target.len, cb, arg, done);
+  return 0;
+}
@@ -0,0 +1,727 @@
+/**
+* @file         user_json_stream.c
+* @brief        流式按路径提取json值的相关函数定义
+* @details      逐字节的json词法状态机,只记录每层当前的键名或下标;值开始时与路径比较,
+*               匹配则把该值的原始文本拷进固定大小的缓存,值结束时回调
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 标量按语法检查,只接受完整的true/false/null和合法的数字\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include "user_json_stream.h"
+
+/*
+===========================
+枚举变量
+===========================
+*/
+/* 路径段类型 */
+enum
+{
+  SEG_KEY,                                              ///<键名
+  SEG_INDEX,                                            ///<数组下标
+  SEG_ANY_KEY,                                          ///<"*"
+  SEG_ANY_INDEX,                                        ///<"[*]"
+};
+
+/* 词法状态 */
+enum
+{
+  JS_VALUE,                                             ///<等待一个值
+  JS_ARRAY_FIRST,                                       ///<'['之后,可以是']'或者第一个值
+  JS_STRING,                                            ///<字符串值
+  JS_STRING_ESC,                                        ///<字符串值中'\'之后
+  JS_SCALAR,                                            ///<数字、true、false、null
+  JS_AFTER_VALUE,                                       ///<值之后,等待','或者结束符
+  JS_OBJECT_FIRST,                                      ///<'{'之后,可以是'}'或者第一个键
+  JS_KEY_START,                                         ///<','之后,等待键
+  JS_KEY,                                               ///<键名
+  JS_KEY_ESC,                                           ///<键名中'\'之后
+  JS_COLON,                                             ///<键名之后,等待':'
+  JS_DONE,                                              ///<顶层值已结束
+  JS_ERROR,
+};
+
+/* 数字的词法子状态 */
+enum
+{
+  NUM_SIGN,                                             ///<'-'之后,等待整数部分
+  NUM_ZERO,                                             ///<整数部分为0,后面不能再有数字
+  NUM_INT,                                              ///<整数部分
+  NUM_DOT,                                              ///<'.'之后,至少要一位小数
+  NUM_FRAC,                                             ///<小数部分
+  NUM_EXP,                                              ///<'e'之后,可以有符号
+  NUM_EXP_SIGN,                                         ///<指数符号之后,至少要一位数字
+  NUM_EXP_INT,                                          ///<指数部分
+};
+
+/* json的字面量,json_stream_t.literal为下标+1 */
+static const char *const gs_json_literal[] = { "true", "false", "null" };
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 判断是否为空白字符
+ * @param[in]   c :字符
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t json_is_space(uint8_t c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * 判断'\'后面的字符是否为合法的转义,\u后面的4位十六进制不检查
+ * @param[in]   c :字符
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t json_is_escape(uint8_t c)
+{
+  return c != 0 && strchr("\"\\/bfnrtu", c) != NULL;
+}
+
+/**
+ * 标量的第一个字符,决定是数字还是哪个字面量
+ * @param[in]   js  :提取器
+ * @param[in]   c   :字符
+ * @retval      0:成功 JSON_STREAM_ERR_SYNTAX:不能作为值的开头
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int json_scalar_begin(json_stream_t *js, uint8_t c)
+{
+  uint8_t i;
+  js->literal = 0;
+  if (c == '-')
+  {
+    js->scalar = NUM_SIGN;
+    return 0;
+  }
+  if (c >= '0' && c <= '9')
+  {
+    js->scalar = c == '0' ? NUM_ZERO : NUM_INT;
+    return 0;
+  }
+  for (i = 0; i < sizeof(gs_json_literal) / sizeof(gs_json_literal[0]); i++)
+  {
+    if (c == (uint8_t)gs_json_literal[i][0])
+    {
+      js->literal = i + 1;
+      js->scalar = 1;
+      return 0;
+    }
+  }
+  return JSON_STREAM_ERR_SYNTAX;
+}
+
+/**
+ * 标量的后续字符,按数字的语法或者字面量逐字符检查
+ * @param[in]   js  :提取器
+ * @param[in]   c   :字符
+ * @retval      1:属于这个标量 0:不属于,标量到此结束
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t json_scalar_step(json_stream_t *js, uint8_t c)
+{
+  const char *lit;
+  uint8_t digit = c >= '0' && c <= '9';
+  if (js->literal)
+  {
+    lit = gs_json_literal[js->literal - 1];
+    if (lit[js->scalar] == 0 || c != (uint8_t)lit[js->scalar])
+    {
+      return 0;
+    }
+    js->scalar++;
+    return 1;
+  }
+  switch (js->scalar)
+  {
+  case NUM_SIGN:
+    if (!digit)
+    {
+      return 0;
+    }
+    js->scalar = c == '0' ? NUM_ZERO : NUM_INT;
+    return 1;
+  case NUM_INT:
+    if (digit)
+    {
+      return 1;
+    }
+    /* fall through */
+  case NUM_ZERO:
+    if (c == '.')
+    {
+      js->scalar = NUM_DOT;
+      return 1;
+    }
+    break;
+  case NUM_DOT:
+  case NUM_FRAC:
+    if (digit)
+    {
+      js->scalar = NUM_FRAC;
+      return 1;
+    }
+    if (js->scalar == NUM_DOT)
+    {
+      return 0;
+    }
+    break;
+  case NUM_EXP:
+    if (c == '+' || c == '-')
+    {
+      js->scalar = NUM_EXP_SIGN;
+      return 1;
+    }
+    /* fall through */
+  case NUM_EXP_SIGN:
+  case NUM_EXP_INT:
+    if (digit)
+    {
+      js->scalar = NUM_EXP_INT;
+    }
+    return digit;
+  default:
+    return 0;
+  }
+  /* 整数或小数之后可以有指数 */
+  if (c == 'e' || c == 'E')
+  {
+    js->scalar = NUM_EXP;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * 标量在当前位置结束是否完整:字面量全部匹配,或者数字停在可以结束的状态
+ * @param[in]   js  :提取器
+ * @retval      1:完整 0:不完整
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t json_scalar_complete(const json_stream_t *js)
+{
+  if (js->literal)
+  {
+    return gs_json_literal[js->literal - 1][js->scalar] == 0;
+  }
+  return js->scalar == NUM_ZERO || js->scalar == NUM_INT || js->scalar == NUM_FRAC || js->scalar == NUM_EXP_INT;
+}
+
+/**
+ * 拷贝匹配值的一个字符,超出缓存时只记截断
+ * @param[in]   js  :提取器
+ * @param[in]   c   :字符
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void json_put(json_stream_t *js, uint8_t c)
+{
+  if (js->value_len < JSON_STREAM_VALUE_LEN)
+  {
+    js->value[js->value_len++] = c;
+  }
+  else
+  {
+    js->truncated = 1;
+  }
+}
+
+/**
+ * 一个值开始,当前路径与各条路径比较,匹配则开始拷贝
+ * @param[in]   js  :提取器
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void json_value_begin(json_stream_t *js)
+{
+  uint8_t p, i;
+  const json_stream_seg_t *seg;
+  const json_stream_frame_t *f;
+  uint8_t is_array;
+  if (js->capturing || js->depth > JSON_STREAM_DEPTH)
+  {
+    return;
+  }
+  for (p = 0; p < js->paths; p++)
+  {
+    if (js->seg_count[p] != js->depth)
+    {
+      continue;
+    }
+    for (i = 0; i < js->depth; i++)
+    {
+      seg = &js->seg[p][i];
+      f = &js->frame[i];
+      is_array = (js->is_array >> i) & 1;
+      if (seg->type == SEG_KEY)
+      {
+        if (is_array || seg->key_len != f->key_len || memcmp(seg->key, f->key, f->key_len))
+        {
+          break;
+        }
+      }
+      else if (seg->type == SEG_INDEX)
+      {
+        if (!is_array || seg->index != f->index)
+        {
+          break;
+        }
+      }
+      else if (is_array != (seg->type == SEG_ANY_INDEX))
+      {
+        break;
+      }
+    }
+    if (i == js->depth)
+    {
+      js->capturing = 1;
+      js->cap_depth = js->depth;
+      js->cap_path = p;
+      js->value_len = 0;
+      js->truncated = 0;
+      return;
+    }
+  }
+}
+
+/**
+ * 一个值结束,是正在拷贝的值则回调
+ * @param[in]   js  :提取器
+ * @retval      0:成功 JSON_STREAM_ERR_CALLBACK:回调要求停止
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int json_value_end(json_stream_t *js)
+{
+  js->state = js->depth ? JS_AFTER_VALUE : JS_DONE;
+  if (!js->capturing || js->depth != js->cap_depth)
+  {
+    return 0;
+  }
+  js->capturing = 0;
+  js->value[js->value_len] = 0;
+  if (js->cb != NULL && js->cb(js->arg, js->cap_path, js->value, js->value_len, js->truncated))
+  {
+    return JSON_STREAM_ERR_CALLBACK;
+  }
+  return 0;
+}
+
+/**
+ * 进入一层对象或数组
+ * @param[in]   js        :提取器
+ * @param[in]   is_array  :1数组 0对象
+ * @retval      0:成功 JSON_STREAM_ERR_DEPTH:嵌套太深
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int json_push(json_stream_t *js, uint8_t is_array)
+{
+  if (js->depth >= JSON_STREAM_MAX_NESTING)
+  {
+    return JSON_STREAM_ERR_DEPTH;
+  }
+  if (is_array)
+  {
+    js->is_array |= 1UL << js->depth;
+  }
+  else
+  {
+    js->is_array &= ~(1UL << js->depth);
+  }
+  if (js->depth < JSON_STREAM_DEPTH)
+  {
+    js->frame[js->depth].index = 0;
+    js->frame[js->depth].key_len = 0;
+  }
+  js->depth++;
+  js->state = is_array ? JS_ARRAY_FIRST : JS_OBJECT_FIRST;
+  return 0;
+}
+
+/**
+ * 退出一层对象或数组,结束符要和开始符对应
+ * @param[in]   js        :提取器
+ * @param[in]   is_array  :1遇到']' 0遇到'}'
+ * @retval      0:成功 JSON_STREAM_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int json_pop(json_stream_t *js, uint8_t is_array)
+{
+  if (((js->is_array >> (js->depth - 1)) & 1) != is_array)
+  {
+    return JSON_STREAM_ERR_SYNTAX;
+  }
+  js->depth--;
+  return json_value_end(js);
+}
+
+/**
+ * 初始化提取器
+ * @param[in]   js    :提取器
+ * @param[in]   cb    :匹配值回调
+ * @param[in]   arg   :回调参数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void json_stream_init(json_stream_t *js, json_stream_cb_t cb, void *arg)
+{
+  memset(js, 0, sizeof(*js));
+  js->state = JS_VALUE;
+  js->cb = cb;
+  js->arg = arg;
+}
+
+/**
+ * 增加一条要提取的路径,如"results[0].daily[*]"、"results[0].location.name"
+ * 键名用'.'分隔,"[n]"为数组下标,"[*]"为任意下标,"*"为任意键名,空路径匹配整个json
+ * @param[in]   js    :提取器
+ * @param[in]   path  :路径,解析期间必须一直有效
+ * @retval
+ *              >=0:路径序号,回调时传回
+ *              JSON_STREAM_ERR_PATH:路径格式错误或者路径太多
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int json_stream_add_path(json_stream_t *js, const char *path)
+{
+  json_stream_seg_t *seg;
+  uint8_t n = 0;
+  uint32_t index;
+  size_t len;
+  if (js->paths >= JSON_STREAM_MAX_PATHS)
+  {
+    return JSON_STREAM_ERR_PATH;
+  }
+  while (*path)
+  {
+    if (n >= JSON_STREAM_MAX_SEGS)
+    {
+      return JSON_STREAM_ERR_PATH;
+    }
+    seg = &js->seg[js->paths][n];
+    if (*path == '[')
+    {
+      path++;
+      if (path[0] == '*' && path[1] == ']')
+      {
+        seg->type = SEG_ANY_INDEX;
+        path += 2;
+      }
+      else
+      {
+        for (index = 0, len = 0; *path >= '0' && *path <= '9' && index < 0xffff; path++, len++)
+        {
+          index = index * 10 + (*path - '0');
+        }
+        if (len == 0 || index > 0xffff || *path != ']')
+        {
+          return JSON_STREAM_ERR_PATH;
+        }
+        seg->type = SEG_INDEX;
+        seg->index = index;
+        path++;
+      }
+    }
+    else
+    {
+      /* 第一段之外,键名前必须有'.' */
+      if (n && *path++ != '.')
+      {
+        return JSON_STREAM_ERR_PATH;
+      }
+      len = strcspn(path, ".[");
+      if (len == 0 || len >= JSON_STREAM_KEY_LEN)
+      {
+        return JSON_STREAM_ERR_PATH;
+      }
+      seg->type = (len == 1 && *path == '*') ? SEG_ANY_KEY : SEG_KEY;
+      seg->key = path;
+      seg->key_len = len;
+      path += len;
+    }
+    n++;
+  }
+  js->seg_count[js->paths] = n;
+  return js->paths++;
+}
+
+/**
+ * 喂入一段json文本,匹配的值完整后立即回调
+ * @param[in]   js    :提取器
+ * @param[in]   data  :数据
+ * @param[in]   len   :长度
+ * @retval
+ *              0:成功
+ *              JSON_STREAM_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int json_stream_feed(json_stream_t *js, const uint8_t *data, size_t len)
+{
+  size_t i;
+  uint8_t c;
+  int ret = 0;
+  json_stream_frame_t *f;
+  for (i = 0; i < len; i++)
+  {
+    c = data[i];
+    /* 数字等标量没有结束符,由下一个字符结束,这个字符不属于该值 */
+    if (js->capturing && js->state != JS_SCALAR)
+    {
+      json_put(js, c);
+    }
+again:
+    switch (js->state)
+    {
+    case JS_ARRAY_FIRST:
+      if (c == ']')
+      {
+        ret = json_pop(js, 1);
+        break;
+      }
+      /* fall through */
+    case JS_VALUE:
+      if (json_is_space(c))
+      {
+        break;
+      }
+      if (!js->capturing)
+      {
+        json_value_begin(js);
+        if (js->capturing)
+        {
+          json_put(js, c);
+        }
+      }
+      if (c == '{' || c == '[')
+      {
+        ret = json_push(js, c == '[');
+      }
+      else if (c == '"')
+      {
+        js->state = JS_STRING;
+      }
+      else if ((ret = json_scalar_begin(js, c)) == 0)
+      {
+        js->state = JS_SCALAR;
+      }
+      break;
+    case JS_STRING:
+      if (c == '\\')
+      {
+        js->state = JS_STRING_ESC;
+      }
+      else if (c == '"')
+      {
+        ret = json_value_end(js);
+      }
+      else if (c < 0x20)
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+      }
+      break;
+    case JS_STRING_ESC:
+      js->state = JS_STRING;
+      if (!json_is_escape(c))
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+      }
+      break;
+    case JS_SCALAR:
+      if (json_scalar_step(js, c))
+      {
+        if (js->capturing)
+        {
+          json_put(js, c);
+        }
+        break;
+      }
+      /* "tru"、"1."、"-"之类没写完的标量 */
+      if (!json_scalar_complete(js))
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+        break;
+      }
+      ret = json_value_end(js);
+      if (ret)
+      {
+        break;
+      }
+      if (js->capturing)
+      {
+        json_put(js, c);
+      }
+      goto again;
+    case JS_AFTER_VALUE:
+      if (json_is_space(c))
+      {
+        break;
+      }
+      if (c == ',')
+      {
+        if ((js->is_array >> (js->depth - 1)) & 1)
+        {
+          if (js->depth <= JSON_STREAM_DEPTH)
+          {
+            js->frame[js->depth - 1].index++;
+          }
+          js->state = JS_VALUE;
+        }
+        else
+        {
+          js->state = JS_KEY_START;
+        }
+      }
+      else if (c == ']' || c == '}')
+      {
+        ret = json_pop(js, c == ']');
+      }
+      else
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+      }
+      break;
+    case JS_OBJECT_FIRST:
+      if (c == '}')
+      {
+        ret = json_pop(js, 0);
+        break;
+      }
+      /* fall through */
+    case JS_KEY_START:
+      if (json_is_space(c))
+      {
+        break;
+      }
+      if (c != '"')
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+        break;
+      }
+      if (js->depth <= JSON_STREAM_DEPTH)
+      {
+        js->frame[js->depth - 1].key_len = 0;
+      }
+      js->state = JS_KEY;
+      break;
+    case JS_KEY:
+    case JS_KEY_ESC:
+      if (js->state == JS_KEY && c == '"')
+      {
+        js->state = JS_COLON;
+        break;
+      }
+      if (c < 0x20 || (js->state == JS_KEY_ESC && !json_is_escape(c)))
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+        break;
+      }
+      js->state = (js->state == JS_KEY && c == '\\') ? JS_KEY_ESC : JS_KEY;
+      /* 键名按原样保存,过长的键标记为0xff,不会与任何路径匹配 */
+      if (js->depth <= JSON_STREAM_DEPTH)
+      {
+        f = &js->frame[js->depth - 1];
+        if (f->key_len < JSON_STREAM_KEY_LEN)
+        {
+          f->key[f->key_len++] = c;
+        }
+        else
+        {
+          f->key_len = 0xff;
+        }
+      }
+      break;
+    case JS_COLON:
+      if (json_is_space(c))
+      {
+        break;
+      }
+      if (c != ':')
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+        break;
+      }
+      js->state = JS_VALUE;
+      break;
+    case JS_DONE:
+      if (!json_is_space(c))
+      {
+        ret = JSON_STREAM_ERR_SYNTAX;
+      }
+      break;
+    default:
+      ret = JSON_STREAM_ERR_SYNTAX;
+      break;
+    }
+    if (ret)
+    {
+      js->state = JS_ERROR;
+      return ret;
+    }
+  }
+  return 0;
+}
+
+/**
+ * 输入结束,检查json是否完整
+ * @param[in]   js    :提取器
+ * @retval
+ *              0:完整
+ *              JSON_STREAM_ERR_EOF:不完整
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 顶层标量不完整时返回JSON_STREAM_ERR_EOF\n
+ */
+int json_stream_finish(json_stream_t *js)
+{
+  /* 顶层是一个数字时由输入结束来结束,没写完的标量算不完整 */
+  if (js->state == JS_SCALAR && js->depth == 0)
+  {
+    return json_scalar_complete(js) ? json_value_end(js) : JSON_STREAM_ERR_EOF;
+  }
+  return js->state == JS_DONE ? 0 : JSON_STREAM_ERR_EOF;
+}
@@ -0,0 +1,288 @@
+/**
+* @file         user_url.c
+* @brief        URL解析的相关函数定义
+* @details      下标只向前移动,每个字节只查一次字符类表;各段先记成size_t的下标,
+*               整个URL扫描完确认不超过URL_MAX_LEN后才写进16位的结果
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include "user_url.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define URL_C_HOST                    0x01                  ///<主机名:unreserved、sub-delims和'%'
+#define URL_C_PATH                    0x02                  ///<路径:空格、控制字符、DEL、'?'和'#'以外
+#define URL_C_QUERY                   0x04                  ///<查询串:空格、控制字符、DEL和'#'以外
+#define URL_C_FRAG                    0x08                  ///<片段:空格、控制字符和DEL以外
+#define URL_C_SCHEME                  0x10                  ///<scheme首字母以外:字母、数字、'+'、'-'、'.'
+
+/*
+===========================
+全局变量定义
+===========================
+*/
+/* 每个字节所属的字符类,扫描每段时一次查表,'\0'不属于任何一类,各段都会停在结尾 */
+static const uint8_t url_class[256] =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x0f, 0x0e, 0x08, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x1f, 0x0f, 0x1f, 0x1f, 0x0e,
+  0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x0e, 0x0f, 0x0e, 0x0f, 0x0e, 0x0c,
+  0x0e, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f,
+  0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x0e, 0x0e, 0x0e, 0x0e, 0x0f,
+  0x0e, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f,
+  0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x0e, 0x0e, 0x0e, 0x0f, 0x00,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+  0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e,
+};
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 是否为字母
+ * @param[in]   c     :字符
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static inline uint8_t url_is_alpha(uint8_t c)
+{
+  return (uint8_t)((c | 0x20) - 'a') < 26;
+}
+
+/**
+ * 是否为十进制数字
+ * @param[in]   c     :字符
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static inline uint8_t url_is_digit(uint8_t c)
+{
+  return (uint8_t)(c - '0') < 10;
+}
+
+/**
+ * 是否为十六进制数字
+ * @param[in]   c     :字符
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static inline uint8_t url_is_hex(uint8_t c)
+{
+  return url_is_digit(c) || (uint8_t)((c | 0x20) - 'a') < 6;
+}
+
+/**
+ * scheme是否为指定的名字,不区分大小写
+ * @param[in]   s     :scheme的起始
+ * @param[in]   len   :scheme的长度
+ * @param[in]   name  :小写的名字
+ * @retval      1:是 0:否
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t url_scheme_is(const uint8_t *s, size_t len, const char *name)
+{
+  size_t i;
+  for (i = 0; i < len; i++)
+  {
+    if ((s[i] | 0x20) != (uint8_t)name[i])
+    {
+      return 0;
+    }
+  }
+  return name[len] == '\0';
+}
+
+/**
+ * 解析URL,只扫描一遍,不修改也不拷贝URL
+ * 支持"scheme://host[:port][/path][?query][#fragment]",host可以是"[IPv6地址]";
+ * 路径中的非ASCII字节原样保留,空格和控制字符视为错误,避免拼进请求行后改变报文
+ * @param[in]   url   :以'\0'结尾的URL,使用解析结果期间必须一直有效
+ * @param[out]  u     :解析结果
+ * @retval
+ *              0:成功
+ *              URL_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int url_parse(const char *url, url_t *u)
+{
+  const uint8_t *p = (const uint8_t *)url;
+  size_t i;
+  size_t scheme_end, host_off, host_end;
+  size_t port_off = 0, port_end = 0;
+  size_t path_off = 0, path_end = 0;
+  size_t query_off = 0, query_end = 0;
+  size_t frag_off = 0;
+  size_t target_off, target_end;
+  uint32_t port = 0;
+  if (url == NULL || u == NULL)
+  {
+    return URL_ERR_ARG;
+  }
+  memset(u, 0, sizeof(*u));
+  /* scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ) */
+  if (!url_is_alpha(p[0]))
+  {
+    return URL_ERR_SCHEME;
+  }
+  for (i = 1; url_class[p[i]] & URL_C_SCHEME; i++)
+  {
+  }
+  /* 前一个字节不是'\0'时才会读下一个字节,不会越过结尾 */
+  if (p[i] != ':' || p[i + 1] != '/' || p[i + 2] != '/')
+  {
+    return URL_ERR_SCHEME;
+  }
+  scheme_end = i;
+  i += 3;
+  /* 主机名,IPv6地址写在方括号里 */
+  if (p[i] == '[')
+  {
+    host_off = ++i;
+    while (url_is_hex(p[i]) || p[i] == ':' || p[i] == '.')
+    {
+      i++;
+    }
+    if (p[i] != ']')
+    {
+      return URL_ERR_HOST;
+    }
+    host_end = i++;
+  }
+  else
+  {
+    host_off = i;
+    while (url_class[p[i]] & URL_C_HOST)
+    {
+      i++;
+    }
+    host_end = i;
+  }
+  if (host_end == host_off || host_end - host_off > URL_HOST_MAX_LEN)
+  {
+    return URL_ERR_HOST;
+  }
+  /* 端口可以为空,此时按scheme取默认值 */
+  if (p[i] == ':')
+  {
+    port_off = ++i;
+    while (url_is_digit(p[i]))
+    {
+      port = port * 10 + (p[i++] - '0');
+      if (port > 0xFFFF)
+      {
+        return URL_ERR_PORT;
+      }
+    }
+    port_end = i;
+    if (port_end > port_off && port == 0)
+    {
+      return URL_ERR_PORT;
+    }
+  }
+  /* 主机名或端口后面只能是路径、查询串、片段或者结尾,'@'等也在这里被拒绝 */
+  if (p[i] != '/' && p[i] != '?' && p[i] != '#' && p[i] != '\0')
+  {
+    return port_off ? URL_ERR_PORT : URL_ERR_HOST;
+  }
+  target_off = i;
+  if (p[i] == '/')
+  {
+    path_off = i;
+    while (url_class[p[i]] & URL_C_PATH)
+    {
+      i++;
+    }
+    path_end = i;
+    target_off = path_off + 1;
+  }
+  if (p[i] == '?')
+  {
+    query_off = ++i;
+    while (url_class[p[i]] & URL_C_QUERY)
+    {
+      i++;
+    }
+    query_end = i;
+  }
+  target_end = i;
+  if (p[i] == '#')
+  {
+    frag_off = ++i;
+    while (url_class[p[i]] & URL_C_FRAG)
+    {
+      i++;
+    }
+  }
+  /* 上面各段都停在了非法字符上 */
+  if (p[i] != '\0')
+  {
+    return URL_ERR_CHAR;
+  }
+  if (i > URL_MAX_LEN)
+  {
+    return URL_ERR_TOO_LONG;
+  }
+  u->scheme.len = scheme_end;
+  u->host.off = host_off;
+  u->host.len = host_end - host_off;
+  u->port.off = port_off;
+  u->port.len = port_end - port_off;
+  u->path.off = path_off;
+  u->path.len = path_end - path_off;
+  u->query.off = query_off;
+  u->query.len = query_end - query_off;
+  if (frag_off)
+  {
+    u->fragment.off = frag_off;
+    u->fragment.len = i - frag_off;
+  }
+  u->target.off = target_off;
+  u->target.len = target_end - target_off;
+  if (u->port.len)
+  {
+    u->port_num = port;
+  }
+  else if (url_scheme_is(p, scheme_end, "https") || url_scheme_is(p, scheme_end, "wss"))
+  {
+    u->port_num = 443;
+  }
+  else if (url_scheme_is(p, scheme_end, "http") || url_scheme_is(p, scheme_end, "ws"))
+  {
+    u->port_num = 80;
+  }
+  return 0;
+}
@@ -1,7 +1,5 @@
 
 #include <string.h>
-#include <sys/socket.h>
-#include <netdb.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -16,25 +14,24 @@
 #include "nvs.h"
 #include "nvs_flash.h"
 
+#include "ota_resume.h"
+
 //配置信息
 #define EXAMPLE_WIFI_SSID  "stop"
 #define EXAMPLE_WIFI_PASS  "11111111111"
 #define EXAMPLE_SERVER_IP   "192.168.2.103"
 #define EXAMPLE_SERVER_PORT "8070"
 #define EXAMPLE_FILENAME "/hello-world.bin"
-//数据包长度
-#define BUFFSIZE 1024
-#define TEXT_BUFFSIZE 1024
 
 static const char *TAG = "ota";
-//OTA数据
-static char ota_write_data[BUFFSIZE + 1] = { 0 };
-//接收数据
-static char text[BUFFSIZE + 1] = { 0 };
-//镜像大小
-static int binary_file_length = 0;
-//socket句柄
-static int socket_id = -1;
+//下载状态，含一个扇区大小的缓存
+static ota_resume_t ota_resume;
+//http服务器
+static const ota_resume_server_t ota_server = {
+    .ip = EXAMPLE_SERVER_IP,
+    .port = EXAMPLE_SERVER_PORT,
+    .path = EXAMPLE_FILENAME,
+};
 
 //wifi连接ok事件
 static EventGroupHandle_t wifi_event_group;
@@ -81,84 +78,10 @@ static void initialise_wifi(void)
     ESP_ERROR_CHECK( esp_wifi_start() );
 }
 
-/*read buffer by byte still delim ,return read bytes counts*/
-static int read_until(char *buffer, char delim, int len)
-{
-    int i = 0;
-    while (buffer[i] != delim && i < len) {
-        ++i;
-    }
-    return i + 1;
-}
-
-/* resolve a packet from http socket
- * return true if packet including \r\n\r\n that means http packet header finished,start to receive packet body
- * otherwise return false
- * */
-static bool read_past_http_header(char text[], int total_len, esp_ota_handle_t update_handle)
-{
-    /* i means current position */
-    int i = 0, i_read_len = 0;
-    while (text[i] != 0 && i < total_len) {
-        i_read_len = read_until(&text[i], '\n', total_len);
-        // if we resolve \r\n line,we think packet header is finished
-        if (i_read_len == 2) {
-            int i_write_len = total_len - (i + 2);
-            memset(ota_write_data, 0, BUFFSIZE);
-            /*copy first http packet body to write buffer*/
-            memcpy(ota_write_data, &(text[i + 2]), i_write_len);
-
-            esp_err_t err = esp_ota_write( update_handle, (const void *)ota_write_data, i_write_len);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%x", err);
-                return false;
-            } else {
-                ESP_LOGI(TAG, "esp_ota_write header OK");
-                binary_file_length += i_write_len;
-            }
-            return true;
-        }
-        i += i_read_len;
-    }
-    return false;
-}
-
-static bool connect_to_http_server()
-{
-    ESP_LOGI(TAG, "Server IP: %s Server Port:%s", EXAMPLE_SERVER_IP, EXAMPLE_SERVER_PORT);
-
-    int  http_connect_flag = -1;
-    struct sockaddr_in sock_info;
-    //新建socket
-    socket_id = socket(AF_INET, SOCK_STREAM, 0);
-    if (socket_id == -1) {
-        ESP_LOGE(TAG, "Create socket failed!");
-        return false;
-    }
-
-    //设置连接参数
-    memset(&sock_info, 0, sizeof(struct sockaddr_in));
-    sock_info.sin_family = AF_INET;
-    sock_info.sin_addr.s_addr = inet_addr(EXAMPLE_SERVER_IP);
-    sock_info.sin_port = htons(atoi(EXAMPLE_SERVER_PORT));
-
-    //连http服务器
-    http_connect_flag = connect(socket_id, (struct sockaddr *)&sock_info, sizeof(sock_info));
-    if (http_connect_flag == -1) {
-        ESP_LOGE(TAG, "Connect to server failed! errno=%d", errno);
-        close(socket_id);
-        return false;
-    } else {
-        ESP_LOGI(TAG, "Connected to server");
-        return true;
-    }
-    return false;
-}
 //异常处理，连接http服务器失败等异常
 static void __attribute__((noreturn)) task_fatal_error()
 {
     ESP_LOGE(TAG, "Exiting task due to fatal error...");
-    close(socket_id);
     (void)vTaskDelete(NULL);
 
     while (1) {
@@ -192,35 +115,6 @@ static void ota_example_task(void *pvParameter)
                         false, true, portMAX_DELAY);
     ESP_LOGI(TAG, "Connect to Wifi ! Start to Connect to Server....");
 
-    //连http服务器
-    if (connect_to_http_server()) {
-        ESP_LOGI(TAG, "Connected to http server");
-    } else {
-        ESP_LOGE(TAG, "Connect to http server failed!");
-        task_fatal_error();
-    }
-
-    //组http包发送
-    const char *GET_FORMAT =
-        "GET %s HTTP/1.0\r\n"
-        "Host: %s:%s\r\n"
-        "User-Agent: esp-idf/1.0 esp32\r\n\r\n";
-
-    char *http_request = NULL;
-    int get_len = asprintf(&http_request, GET_FORMAT, EXAMPLE_FILENAME, EXAMPLE_SERVER_IP, EXAMPLE_SERVER_PORT);
-    if (get_len < 0) {
-        ESP_LOGE(TAG, "Failed to allocate memory for GET request buffer");
-        task_fatal_error();
-    }
-    int res = send(socket_id, http_request, get_len, 0);
-    free(http_request);
-    if (res < 0) {
-        ESP_LOGE(TAG, "Send GET request to server failed");
-        task_fatal_error();
-    } else {
-        ESP_LOGI(TAG, "Send GET request to server succeeded");
-    }
-
     //获取当前系统下一个（紧邻当前使用的OTA_X分区）可用于烧录升级固件的Flash分区
     update_partition = esp_ota_get_next_update_partition(NULL);
     ESP_LOGI(TAG, "Writing to partition subtype %d at offset 0x%x",
@@ -234,39 +128,14 @@ static void ota_example_task(void *pvParameter)
     }
     ESP_LOGI(TAG, "esp_ota_begin succeeded");
 
-    bool resp_body_start = false, flag = true;
-    //接收完成
-    while (flag) {
-        memset(text, 0, TEXT_BUFFSIZE);
-        memset(ota_write_data, 0, BUFFSIZE);
-        //接收http包
-        int buff_len = recv(socket_id, text, TEXT_BUFFSIZE, 0);
-        if (buff_len < 0) { //包异常
-            ESP_LOGE(TAG, "Error: receive data error! errno=%d", errno);
-            task_fatal_error();
-        } else if (buff_len > 0 && !resp_body_start) { //包头
-            memcpy(ota_write_data, text, buff_len);
-            resp_body_start = read_past_http_header(text, buff_len, update_handle);
-        } else if (buff_len > 0 && resp_body_start) { //数据段包
-            memcpy(ota_write_data, text, buff_len);
-            //写flash
-            err = esp_ota_write( update_handle, (const void *)ota_write_data, buff_len);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%x", err);
-                task_fatal_error();
-            }
-            binary_file_length += buff_len;
-            ESP_LOGI(TAG, "Have written image length %d", binary_file_length);
-        } else if (buff_len == 0) {  //结束包
-            flag = false;
-            ESP_LOGI(TAG, "Connection closed, all packets received");
-            close(socket_id);
-        } else {//未知错误
-            ESP_LOGE(TAG, "Unexpected recv result");
-        }
+    //下载镜像写入分区，断线后从已写入的位置续传
+    err = ota_resume_download(&ota_resume, &ota_server, update_partition, update_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA download failed! err=0x%x", err);
+        task_fatal_error();
     }
 
-    ESP_LOGI(TAG, "Total Write binary data length : %d", binary_file_length);
+    ESP_LOGI(TAG, "Total Write binary data length : %d", ota_resume.written);
     //OTA写结束
     if (esp_ota_end(update_handle) != ESP_OK) {
         ESP_LOGE(TAG, "esp_ota_end failed!");
@@ -0,0 +1,380 @@
+/*
+* @file         ota_resume.c
+* @brief        可断点续传的OTA下载
+* @details      written之前的数据已经在flash中校验过，chunk中还有staged字节没写；
+*               断线后从written+staged处用Range续传，服务器不支持Range时重新收一遍，把已有的部分丢掉
+* @author       红旭无线团队
+* @par History:
+*               Ver0.0.1:
+                     红旭无线团队, 2026/10/17, 初始化版本\n
+*/
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "ota_resume.h"
+
+#define OTA_RESUME_AGAIN            (-2)        //连接断了或者服务器暂时出错，可以重连续传
+#define OTA_RESUME_ADLER_MOD        65521       //Adler-32的模数
+#define OTA_RESUME_ADLER_NMAX       5552        //累加这么多字节内s2不会溢出，之后才需要取模
+#define OTA_RESUME_VERIFY_LEN       256         //读回校验时每次读flash的长度
+
+static const char *TAG = "ota_resume";
+
+/* Adler-32，可以分段累加，第一段的adler传1 */
+static uint32_t ota_resume_adler32(uint32_t adler, const uint8_t *p, int len)
+{
+    uint32_t s1 = adler & 0xFFFF, s2 = adler >> 16;
+    int n;
+    while (len > 0) {
+        n = len < OTA_RESUME_ADLER_NMAX ? len : OTA_RESUME_ADLER_NMAX;
+        len -= n;
+        while (n--) {
+            s1 += *p++;
+            s2 += s1;
+        }
+        s1 %= OTA_RESUME_ADLER_MOD;
+        s2 %= OTA_RESUME_ADLER_MOD;
+    }
+    return (s2 << 16) | s1;
+}
+
+/* 从flash读回刚写入的len字节，和接收时算的校验比较 */
+static esp_err_t ota_resume_verify(ota_resume_t *ota, int len, uint32_t expect)
+{
+    uint8_t buf[OTA_RESUME_VERIFY_LEN];
+    uint32_t adler = 1;
+    esp_err_t err;
+    int off, n;
+    for (off = 0; off < len; off += n) {
+        n = len - off < OTA_RESUME_VERIFY_LEN ? len - off : OTA_RESUME_VERIFY_LEN;
+        err = esp_partition_read(ota->partition, ota->written + off, buf, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        adler = ota_resume_adler32(adler, buf, n);
+    }
+    return adler == expect ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+/* 把chunk写入flash并读回校验，不一致时擦掉这个扇区重写 */
+static esp_err_t ota_resume_flush(ota_resume_t *ota)
+{
+    int len = ota->staged, i;
+    uint32_t expect = ota->adler;
+    esp_err_t err;
+    if (len == 0) {
+        return ESP_OK;
+    }
+    err = esp_ota_write(ota->handle, (const void *)ota->chunk, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%x", err);
+        return err;
+    }
+    //加密的分区esp_ota_write把不满16字节的尾巴留到esp_ota_end才写，这部分先不校验
+    if (ota->partition->encrypted && (len & 15) != 0) {
+        len &= ~15;
+        expect = ota_resume_adler32(1, ota->chunk, len);
+    }
+    for (i = 0; (err = ota_resume_verify(ota, len, expect)) == ESP_ERR_INVALID_CRC && i < OTA_RESUME_REWRITE_MAX; i++) {
+        ESP_LOGW(TAG, "Chunk at 0x%x read back wrong, rewrite it", ota->written);
+        ota->repairs++;
+        err = esp_partition_erase_range(ota->partition, ota->written, OTA_RESUME_CHUNK);
+        if (err == ESP_OK) {
+            err = esp_partition_write(ota->partition, ota->written, ota->chunk, len);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Rewrite chunk at 0x%x failed! err=0x%x", ota->written, err);
+            return err;
+        }
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Verify chunk at 0x%x failed! err=0x%x", ota->written, err);
+        return err;
+    }
+    ota->written += ota->staged;
+    ota->staged = 0;
+    ota->adler = 1;
+    ESP_LOGI(TAG, "Have written image length %d", ota->written);
+    return ESP_OK;
+}
+
+/* chunk+staged处新收到len字节，先丢掉要跳过的部分，再累加校验，满一块就写入flash */
+static esp_err_t ota_resume_accept(ota_resume_t *ota, int len)
+{
+    uint8_t *p = ota->chunk + ota->staged;
+    int n;
+    if (ota->skip > 0) {
+        n = len < ota->skip ? len : ota->skip;
+        ota->skip -= n;
+        len -= n;
+        memmove(p, p + n, len);
+    }
+    ota->adler = ota_resume_adler32(ota->adler, p, len);
+    ota->staged += len;
+    if (ota->staged == OTA_RESUME_CHUNK) {
+        return ota_resume_flush(ota);
+    }
+    return ESP_OK;
+}
+
+/* 和响应头在一次recv中收到的数据，拷进chunk */
+static esp_err_t ota_resume_feed(ota_resume_t *ota, const char *data, int len)
+{
+    esp_err_t err;
+    int n;
+    while (len > 0) {
+        n = OTA_RESUME_CHUNK - ota->staged;
+        n = len < n ? len : n;
+        memcpy(ota->chunk + ota->staged, data, n);
+        data += n;
+        len -= n;
+        err = ota_resume_accept(ota, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+/* 解析响应头，确认服务器是从offset处发的同一个镜像 */
+static esp_err_t ota_resume_parse_header(ota_resume_t *ota, int offset)
+{
+    char etag[OTA_RESUME_ETAG_MAX + 1] = { 0 };
+    char *line = ota->hdr, *value;
+    int status, length = -1, start = -1, total = -1, n;
+
+    if (sscanf(line, "HTTP/%*d.%*d %d", &status) != 1) {
+        ESP_LOGE(TAG, "Bad status line");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    while ((line = strstr(line, "\r\n")) != NULL && strncmp(line, "\r\n\r\n", 4) != 0) {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            length = atoi(line + 15);
+        } else if (strncasecmp(line, "Content-Range:", 14) == 0) {
+            //bytes start-end/total，total为*时不知道总长度
+            sscanf(line + 14, " bytes %d-%*d/%d", &start, &total);
+        } else if (strncasecmp(line, "ETag:", 5) == 0) {
+            value = line + 5 + strspn(line + 5, " \t");
+            n = strcspn(value, "\r");
+            if (n <= OTA_RESUME_ETAG_MAX) {
+                memcpy(etag, value, n);
+                etag[n] = '\0';
+            }
+        }
+    }
+
+    if (status >= 500) {
+        ESP_LOGW(TAG, "Server busy, status %d", status);
+        return OTA_RESUME_AGAIN;
+    }
+    if (status == 206) {
+        if (start != offset || total <= 0) {
+            ESP_LOGE(TAG, "Range starts at %d, expected %d", start, offset);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        ota->skip = 0;
+    } else if (status == 200) {
+        //服务器不支持Range，整个镜像重新发，已经收到的部分丢掉
+        if (offset > 0) {
+            ESP_LOGW(TAG, "Server ignored Range, skip %d bytes", offset);
+        }
+        total = length;
+        ota->skip = offset;
+    } else {
+        ESP_LOGE(TAG, "Unexpected http status %d", status);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    if (offset == 0) {
+        ota->total = total;
+        strcpy(ota->etag, etag);
+        ESP_LOGI(TAG, "Image length %d", total);
+    } else if (total != ota->total || (ota->etag[0] != '\0' && etag[0] != '\0' && strcmp(etag, ota->etag) != 0)) {
+        ESP_LOGE(TAG, "Image changed on server during download");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
+
+/* 连http服务器，设置接收超时，链路卡住时也能断开重连 */
+static int ota_resume_connect(const ota_resume_server_t *server)
+{
+    struct sockaddr_in sock_info;
+    struct timeval timeout = { .tv_sec = OTA_RESUME_RECV_TIMEOUT_S, .tv_usec = 0 };
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == -1) {
+        ESP_LOGE(TAG, "Create socket failed!");
+        return -1;
+    }
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    memset(&sock_info, 0, sizeof(struct sockaddr_in));
+    sock_info.sin_family = AF_INET;
+    sock_info.sin_addr.s_addr = inet_addr(server->ip);
+    sock_info.sin_port = htons(atoi(server->port));
+    if (connect(sock, (struct sockaddr *)&sock_info, sizeof(sock_info)) == -1) {
+        ESP_LOGW(TAG, "Connect to server failed! errno=%d", errno);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/* 发GET请求，offset不为0时带上Range，请求拼在hdr中 */
+static esp_err_t ota_resume_request(ota_resume_t *ota, int sock, const ota_resume_server_t *server, int offset)
+{
+    int len = snprintf(ota->hdr, sizeof(ota->hdr),
+                       "GET %s HTTP/1.0\r\n"
+                       "Host: %s:%s\r\n"
+                       "User-Agent: esp-idf/1.0 esp32\r\n",
+                       server->path, server->ip, server->port);
+    if (offset > 0) {
+        len += snprintf(ota->hdr + len, sizeof(ota->hdr) - len, "Range: bytes=%d-\r\n", offset);
+    }
+    len += snprintf(ota->hdr + len, sizeof(ota->hdr) - len, "\r\n");
+    if (len >= (int)sizeof(ota->hdr)) {
+        ESP_LOGE(TAG, "GET request too long");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (send(sock, ota->hdr, len, 0) < 0) {
+        ESP_LOGW(TAG, "Send GET request to server failed");
+        return OTA_RESUME_AGAIN;
+    }
+    return ESP_OK;
+}
+
+/* 一次连接，从written+staged处收到断线或者收完 */
+static esp_err_t ota_resume_session(ota_resume_t *ota, const ota_resume_server_t *server)
+{
+    int offset = ota->written + ota->staged;
+    int sock, len, want;
+    bool body = false;
+    char *end;
+    esp_err_t err;
+
+    sock = ota_resume_connect(server);
+    if (sock < 0) {
+        return OTA_RESUME_AGAIN;
+    }
+    ota->connects++;
+    err = ota_resume_request(ota, sock, server, offset);
+    ota->hdr_len = 0;
+    ota->skip = 0;
+
+    while (err == ESP_OK) {
+        if (!body) {
+            len = recv(sock, ota->hdr + ota->hdr_len, OTA_RESUME_HDR_MAX - ota->hdr_len, 0);
+        } else {
+            //总长度已知时不多收，避免把服务器多发的数据写进分区
+            want = OTA_RESUME_CHUNK - ota->staged;
+            if (ota->total >= 0 && want > ota->total + ota->skip - ota->written - ota->staged) {
+                want = ota->total + ota->skip - ota->written - ota->staged;
+            }
+            len = recv(sock, ota->chunk + ota->staged, want, 0);
+        }
+        if (len < 0) {
+            ESP_LOGW(TAG, "Error: receive data error! errno=%d", errno);
+            err = OTA_RESUME_AGAIN;
+            break;
+        }
+        if (len == 0) {
+            //不知道总长度时只能把连接关闭当作收完
+            if (body && ota->total < 0) {
+                ESP_LOGI(TAG, "Connection closed, all packets received");
+                err = ota_resume_flush(ota);
+            } else {
+                ESP_LOGW(TAG, "Connection closed early");
+                err = OTA_RESUME_AGAIN;
+            }
+            break;
+        }
+        if (!body) {
+            ota->hdr_len += len;
+            ota->hdr[ota->hdr_len] = '\0';
+            end = strstr(ota->hdr, "\r\n\r\n");
+            if (end == NULL) {
+                if (ota->hdr_len == OTA_RESUME_HDR_MAX) {
+                    ESP_LOGE(TAG, "Http header too long");
+                    err = ESP_ERR_INVALID_RESPONSE;
+                }
+                continue;
+            }
+            err = ota_resume_parse_header(ota, offset);
+            if (err == ESP_OK) {
+                body = true;
+                end += 4;
+                err = ota_resume_feed(ota, end, ota->hdr_len - (end - ota->hdr));
+            }
+        } else {
+            err = ota_resume_accept(ota, len);
+        }
+        if (err == ESP_OK && body && ota->total >= 0 && ota->written + ota->staged == ota->total) {
+            err = ota_resume_flush(ota);
+            break;
+        }
+    }
+    close(sock);
+    return err;
+}
+
+/*
+ * 下载整个镜像写入update分区，断线或超时后从断开的位置续传
+ * handle由调用者esp_ota_begin()得到，返回ESP_OK后由调用者esp_ota_end()
+ * 返回值：ESP_OK 下载完成；ESP_ERR_TIMEOUT 连续多次重连都没有进展；
+ *        ESP_ERR_INVALID_RESPONSE 服务器的响应不对或者镜像在下载过程中变了；
+ *        ESP_ERR_INVALID_CRC 重写后读回的数据仍然不对；其他 esp_ota_write等flash操作的错误
+ */
+esp_err_t ota_resume_download(ota_resume_t *ota, const ota_resume_server_t *server,
+                              const esp_partition_t *partition, esp_ota_handle_t handle)
+{
+    int fails = 0, backoff = OTA_RESUME_BACKOFF_MIN_MS, before;
+    esp_err_t err;
+
+    ota->partition = partition;
+    ota->handle = handle;
+    ota->total = -1;
+    ota->written = 0;
+    ota->staged = 0;
+    ota->adler = 1;
+    ota->etag[0] = '\0';
+    ota->connects = 0;
+    ota->repairs = 0;
+
+    ESP_LOGI(TAG, "Server IP: %s Server Port:%s", server->ip, server->port);
+    while (1) {
+        before = ota->written + ota->staged;
+        err = ota_resume_session(ota, server);
+        if (err != OTA_RESUME_AGAIN) {
+            break;
+        }
+        //这次连接收到了新数据就从最短的等待重新开始，否则等待加倍
+        if (ota->written + ota->staged > before) {
+            fails = 0;
+            backoff = OTA_RESUME_BACKOFF_MIN_MS;
+        } else if (++fails >= OTA_RESUME_RETRY_MAX) {
+            ESP_LOGE(TAG, "No progress after %d retries", fails);
+            err = ESP_ERR_TIMEOUT;
+            break;
+        }
+        ESP_LOGW(TAG, "Download stopped at %d/%d, reconnect in %d ms",
+                 ota->written + ota->staged, ota->total, backoff);
+        vTaskDelay(backoff / portTICK_PERIOD_MS);
+        if (fails > 0) {
+            backoff = backoff * 2 < OTA_RESUME_BACKOFF_MAX_MS ? backoff * 2 : OTA_RESUME_BACKOFF_MAX_MS;
+        }
+    }
+    ESP_LOGI(TAG, "Written %d bytes in %d connections, %d chunks rewritten",
+             ota->written, ota->connects, ota->repairs);
+    return err;
+}
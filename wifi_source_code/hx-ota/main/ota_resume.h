@@ -0,0 +1,64 @@
+/*
+* @file         ota_resume.h
+* @brief        可断点续传的OTA下载
+* @details      断线后用Range请求从已写入的位置继续下载，不用从头再来；
+*               数据按flash扇区大小分块写入，每块写完读回来和接收时的滚动校验比较，不一致就擦掉这个扇区重写
+* @author       红旭无线团队
+* @par History:
+*               Ver0.0.1:
+                     红旭无线团队, 2026/10/17, 初始化版本\n
+*/
+#ifndef _OTA_RESUME_H_
+#define _OTA_RESUME_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+
+#define OTA_RESUME_CHUNK            4096        //每块的大小，和flash扇区一样大，校验失败时按扇区擦除重写
+#define OTA_RESUME_HDR_MAX          1024        //http响应头的最大长度
+#define OTA_RESUME_ETAG_MAX         64          //记下的ETag最大长度，更长的不比较
+#define OTA_RESUME_RETRY_MAX        8           //连续多少次连接都没有收到新数据就放弃
+#define OTA_RESUME_BACKOFF_MIN_MS   1000        //重连前的最短等待
+#define OTA_RESUME_BACKOFF_MAX_MS   16000       //重连前的最长等待，没有进展时每次翻倍
+#ifndef OTA_RESUME_RECV_TIMEOUT_S
+#define OTA_RESUME_RECV_TIMEOUT_S   10          //多久收不到数据就当作断线
+#endif
+#define OTA_RESUME_REWRITE_MAX      2           //一块校验失败后最多重写几次
+
+//http服务器和镜像路径
+typedef struct {
+    const char *ip;
+    const char *port;
+    const char *path;
+} ota_resume_server_t;
+
+//下载状态，chunk较大，应放在全局变量中而不是任务栈上
+typedef struct {
+    const esp_partition_t *partition;
+    esp_ota_handle_t handle;
+    int total;                                  //镜像总长度，-1表示服务器没有给出
+    int written;                                //已写入flash并校验通过的长度
+    int staged;                                 //chunk中已收到还没写入flash的长度
+    int skip;                                   //服务器不支持Range时，要丢掉的已经收到过的数据长度
+    uint32_t adler;                             //chunk中数据的滚动校验(Adler-32)
+    int hdr_len;                                //hdr中已收到的响应头长度
+    char etag[OTA_RESUME_ETAG_MAX + 1];         //第一次响应的ETag，续传时用来确认镜像没有变
+    int connects;                               //连接次数
+    int repairs;                                //校验失败重写的次数
+    char hdr[OTA_RESUME_HDR_MAX + 1];
+    uint8_t chunk[OTA_RESUME_CHUNK];
+} ota_resume_t;
+
+/*
+ * 下载整个镜像写入update分区，断线或超时后从断开的位置续传
+ * handle由调用者esp_ota_begin()得到，返回ESP_OK后由调用者esp_ota_end()
+ * 返回值：ESP_OK 下载完成；ESP_ERR_TIMEOUT 连续多次重连都没有进展；
+ *        ESP_ERR_INVALID_RESPONSE 服务器的响应不对或者镜像在下载过程中变了；
+ *        ESP_ERR_INVALID_CRC 重写后读回的数据仍然不对；其他 esp_ota_write等flash操作的错误
+ */
+esp_err_t ota_resume_download(ota_resume_t *ota, const ota_resume_server_t *server,
+                              const esp_partition_t *partition, esp_ota_handle_t handle);
+
+#endif /* _OTA_RESUME_H_ */
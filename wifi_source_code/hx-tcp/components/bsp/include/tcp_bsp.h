@@ -2,6 +2,7 @@
 #ifndef __TCP_BSP_H__
 #define __TCP_BSP_H__
 
+#include <sys/socket.h>
 
 
 #ifdef __cplusplus
@@ -19,6 +20,9 @@ extern "C" {
 
 #define TCP_SERVER_CLIENT_OPTION FALSE              //esp32作为client
 //#define TCP_SERVER_CLIENT_OPTION TRUE              //esp32作为server
+#define TCP_SERVER_MUX_OPTION    TRUE               //作为server时，单任务select服务多个client
+#define TCP_FRAME_OPTION         FALSE              //收发数据按长度前缀分帧，见tcp_frame.h
+#define TCP_FRAME_TYPE           TCP_FRAME_VARINT   //长度头格式：TCP_FRAME_VARINT或TCP_FRAME_U16
 
 #define TAG                     "HX-TCP"            //打印的tag
 
@@ -26,7 +30,7 @@ extern "C" {
 //AP热点模式的配置信息
 #define SOFT_AP_SSID            "HX-TCP-SERVER"     //账号
 #define SOFT_AP_PAS             ""          //密码，可以为空
-#define SOFT_AP_MAX_CONNECT     1                   //最多的连接点
+#define SOFT_AP_MAX_CONNECT     4                   //最多的连接点
 
 //client
 //STA模式配置信息,即要连上的路由器的账号密码
@@ -53,6 +57,11 @@ esp_err_t create_tcp_server(bool isCreatServer);
 //create a tcp client socket. return ESP_OK:success ESP_FAIL:error
 esp_err_t create_tcp_client();
 
+//send all bytes, retry on partial send. return: bytes sent, <0:error
+int tcp_send_all(int socket, const void *data, size_t len);
+//scatter/gather send with sendmsg, iov is consumed. return: bytes sent, <0:error
+int tcp_sendv(int socket, struct iovec *iov, int iovcnt);
+
 // //send data task
 // void send_data(void *pvParameters);
 //receive data task
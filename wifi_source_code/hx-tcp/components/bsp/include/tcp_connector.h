@@ -0,0 +1,78 @@
+#ifndef __TCP_CONNECTOR_H__
+#define __TCP_CONNECTOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define TCP_CONNECT_TIMEOUT_MS      5000            //单次连接超时，不再等lwip默认的重传超时
+#define TCP_BACKOFF_BASE_MS         1000            //首次失败后的退避上限
+#define TCP_BACKOFF_MAX_MS          60000           //退避上限的最大值
+#define TCP_BACKOFF_STABLE_MS       10000           //连上后保持这么久再断开，退避上限才回到初值
+
+
+//连接状态
+typedef enum
+{
+    TCP_CONNECTOR_IDLE = 0,                         //未连接，可以发起连接
+    TCP_CONNECTOR_CONNECTING,                       //非阻塞connect进行中
+    TCP_CONNECTOR_CONNECTED,                        //已连接
+    TCP_CONNECTOR_BACKOFF,                          //失败后退避等待
+} tcp_connector_state_t;
+
+//连接统计
+typedef struct
+{
+    uint32_t    attempts;                           //发起连接次数
+    uint32_t    successes;                          //连接成功次数
+    uint32_t    refused;                            //被拒绝/复位次数
+    uint32_t    timeouts;                           //连接超时次数
+    uint32_t    errors;                             //其他错误次数
+    uint32_t    drops;                              //连上后断开次数
+    uint32_t    last_connect_ms;                    //最近一次连接耗时
+    uint32_t    last_backoff_ms;                    //最近一次退避时间
+} tcp_connector_stats_t;
+
+//连接状态机
+typedef struct
+{
+    struct sockaddr_in      addr;                   //服务器地址
+    uint32_t                timeout_ms;             //连接超时
+    uint32_t                backoff_base_ms;        //退避上限初值
+    uint32_t                backoff_max_ms;         //退避上限最大值
+    uint32_t                backoff_ms;             //当前退避上限，每次失败翻倍
+    tcp_connector_state_t   state;                  //当前状态
+    int                     sock;                   //连接socket
+    TickType_t              start;                  //本次连接开始时刻
+    TickType_t              deadline;               //连接超时或退避结束时刻
+    TickType_t              connected;              //连接成功时刻
+    tcp_connector_stats_t   stats;                  //统计
+} tcp_connector_t;
+
+
+//init connector with server address, timeout and backoff in ms
+void tcp_connector_init(tcp_connector_t *c, const char *ip, uint16_t port,
+                        uint32_t timeout_ms, uint32_t backoff_base_ms, uint32_t backoff_max_ms);
+
+//run the state machine, block at most wait_ms. return: current state
+tcp_connector_state_t tcp_connector_poll(tcp_connector_t *c, uint32_t wait_ms);
+
+//connection lost, socket already closed by user. enter backoff
+void tcp_connector_lost(tcp_connector_t *c);
+
+//log connection stats
+void tcp_connector_show_stats(const tcp_connector_t *c);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /*#ifndef __TCP_CONNECTOR_H__*/
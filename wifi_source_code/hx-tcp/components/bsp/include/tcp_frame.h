@@ -0,0 +1,79 @@
+#ifndef __TCP_FRAME_H__
+#define __TCP_FRAME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define TCP_FRAME_MAX_LEN       1024                //单帧最大长度，超过时认为数据流出错
+#define TCP_FRAME_HDR_MAX       3                   //长度头最多字节数，varint 3字节可表示21位长度
+#define TCP_FRAME_BATCH_LEN     1460                //合并发送缓存，按一个TCP MSS大小
+
+
+//长度头格式
+typedef enum
+{
+    TCP_FRAME_VARINT = 0,                           //LEB128 varint长度头，1~3字节
+    TCP_FRAME_U16,                                  //2字节大端长度头
+} tcp_frame_type_t;
+
+//收到完整帧的回调，frame只在回调内有效
+typedef void (*tcp_frame_cb_t)(void *arg, const uint8_t *frame, size_t len);
+
+//增量解析器
+typedef struct
+{
+    tcp_frame_type_t    type;                       //长度头格式
+    tcp_frame_cb_t      cb;                         //完整帧回调
+    void                *arg;                       //回调参数
+    uint32_t            frame_len;                  //当前帧长度
+    uint8_t             hdr_bytes;                  //当前帧已解析的长度头字节数
+    bool                in_body;                    //长度头已解析完，正在接收帧内容
+    size_t              have;                       //帧内容跨recv时已缓存的字节数
+    uint8_t             buf[TCP_FRAME_MAX_LEN];     //跨recv的帧内容缓存
+} tcp_frame_parser_t;
+
+//合并发送
+typedef struct
+{
+    int                 sock;                       //发送socket
+    tcp_frame_type_t    type;                       //长度头格式
+    size_t              used;                       //缓存已用字节数
+    uint32_t            frames;                     //缓存中的帧数
+    uint8_t             buf[TCP_FRAME_BATCH_LEN];   //合并发送缓存
+} tcp_frame_batch_t;
+
+
+//init parser
+void tcp_frame_parser_init(tcp_frame_parser_t *p, tcp_frame_type_t type, tcp_frame_cb_t cb, void *arg);
+
+//reset parser state, drop any partial frame
+void tcp_frame_parser_reset(tcp_frame_parser_t *p);
+
+//feed stream bytes. return: complete frames delivered, <0:bad length, parser reset
+int tcp_frame_parser_feed(tcp_frame_parser_t *p, const uint8_t *data, size_t len);
+
+//encode length header into hdr[TCP_FRAME_HDR_MAX]. return: header bytes, <0:length too long
+int tcp_frame_encode_hdr(tcp_frame_type_t type, size_t len, uint8_t *hdr);
+
+//init batch sender
+void tcp_frame_batch_init(tcp_frame_batch_t *b, int sock, tcp_frame_type_t type);
+
+//queue one frame, flush first when buffer is full. return: 0 ok, <0:error
+int tcp_frame_batch_add(tcp_frame_batch_t *b, const void *data, size_t len);
+
+//send all queued frames in one send. return: bytes sent, <0:error
+int tcp_frame_batch_flush(tcp_frame_batch_t *b);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /*#ifndef __TCP_FRAME_H__*/
@@ -0,0 +1,70 @@
+#ifndef __TCP_MUX_H__
+#define __TCP_MUX_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//单任务最多同时服务的client数
+//lwip默认CONFIG_LWIP_MAX_SOCKETS=10，要给监听socket留1个，其余按需在menuconfig里调大
+#define TCP_MUX_MAX_CONN        8
+#define TCP_MUX_RX_BUFF_LEN     1024                //所有连接共用的接收缓存
+#define TCP_MUX_TX_BUFF_LEN     2048                //每个连接的发送队列，对端收得慢时暂存，满了就断开这个连接
+#define TCP_MUX_LISTEN_BACKLOG  5                   //listen等待队列
+#define TCP_MUX_SELECT_MS       1000                //select超时，到时打印一次连接状态
+
+
+//连接表中每个连接的状态
+typedef enum
+{
+    TCP_CONN_FREE = 0,                              //空闲槽位
+    TCP_CONN_ACTIVE,                                //已建立连接
+} tcp_conn_state_t;
+
+//连接表项
+typedef struct
+{
+    int                 sock;                       //连接socket
+    tcp_conn_state_t    state;                      //连接状态
+    struct sockaddr_in  addr;                       //client地址
+    uint32_t            rx_bytes;                   //已接收字节数
+    uint32_t            tx_bytes;                   //已发送字节数
+    uint16_t            tx_len;                     //发送队列中待发的字节数
+    uint8_t             tx_buff[TCP_MUX_TX_BUFF_LEN]; //发送队列，可写时由server任务继续发送
+} tcp_conn_t;
+
+//收到数据的回调，data指向共用缓存，回调返回后即失效，回调中用tcp_mux_send发送
+typedef void (*tcp_mux_recv_cb_t)(tcp_conn_t *conn, const uint8_t *data, int len);
+
+
+//create the listen socket. return ESP_OK:success ESP_FAIL:error
+esp_err_t tcp_mux_server_init(uint16_t port);
+
+//set receive callback, NULL:echo back
+void tcp_mux_set_recv_cb(tcp_mux_recv_cb_t cb);
+
+//server task: one task services all connections via select
+void tcp_mux_server_task(void *pvParameters);
+
+//queue data for one connection without blocking. return: len, -1:connection closed
+int tcp_mux_send(tcp_conn_t *conn, const void *data, int len);
+
+//number of active connections
+int tcp_mux_conn_count(void);
+
+//close one connection and free its slot
+void tcp_mux_conn_close(tcp_conn_t *conn);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /*#ifndef __TCP_MUX_H__*/
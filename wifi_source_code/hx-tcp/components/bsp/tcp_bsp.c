@@ -8,6 +8,10 @@
 * @par History:          
 *               Ver0.0.1:
                      hx-zsj, 2018/08/08, 初始化版本\n 
+*               Ver0.0.2:
+                     hx-zsj, 2026/10/17, 收发按实际长度处理，增加聚合发送\n 
+*               Ver0.0.3:
+                     hx-zsj, 2026/10/17, client改为非阻塞连接+指数退避\n 
 */
 
 /* 
@@ -16,6 +20,7 @@
 =============
 */
 #include <string.h>
+#include <errno.h>
 #include <sys/socket.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -24,6 +29,8 @@
 #include "esp_event_loop.h"
 #include "esp_log.h"
 #include "tcp_bsp.h"
+#include "tcp_frame.h"
+#include "tcp_connector.h"
 
 /*
 ===========================
@@ -38,6 +45,12 @@ static struct sockaddr_in client_addr;                  //client地址
 static unsigned int socklen = sizeof(client_addr);      //地址长度
 static int connect_socket = 0;                          //连接socket
 bool g_rxtx_need_restart = false;                       //异常后，重新连接标记
+static tcp_connector_t tcp_connector;                   //client非阻塞连接状态机
+static bool tcp_connector_ready = false;                //状态机是否已初始化
+#if TCP_FRAME_OPTION
+static tcp_frame_parser_t frame_parser;                 //长度前缀分帧解析
+static tcp_frame_batch_t frame_batch;                   //回发帧合并发送
+#endif
 
 // int g_total_data = 0;
 
@@ -109,6 +122,27 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
 
 
 
+#if TCP_FRAME_OPTION
+/*
+* 收到完整帧：原样组帧回发，先放进合并缓存
+* @param[in]   arg  		       :无
+* @param[in]   frame  		       :帧内容
+* @param[in]   len  		       :帧长度
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void recv_frame_cb(void *arg, const uint8_t *frame, size_t len)
+{
+    ESP_LOGI(TAG, "recvFrame: %d bytes", len);
+    if (tcp_frame_batch_add(&frame_batch, frame, len) < 0)
+    {
+        show_socket_error_reason("send_frame", connect_socket);
+    }
+}
+#endif
+
 /*
 * 接收数据任务
 * @param[in]   void  		       :无
@@ -116,25 +150,59 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
 * @note        修改日志 
 *               Ver0.0.1:
                     hx-zsj, 2018/08/06, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 按recv返回长度回发，支持二进制数据\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 增加长度前缀分帧收发\n 
+*               Ver0.0.4:
+                    hx-zsj, 2026/10/17, 帧长度错误时复位解析器并断开连接\n 
 */
 void recv_data(void *pvParameters)
 {
     int len = 0;            //长度
-    char databuff[1024];    //缓存
+    char databuff[1024];    //缓存，按recv返回的长度使用，不需要每次清空
+#if TCP_FRAME_OPTION
+    int ret;                //切帧结果
+    tcp_frame_parser_init(&frame_parser, TCP_FRAME_TYPE, recv_frame_cb, NULL);
+    tcp_frame_batch_init(&frame_batch, connect_socket, TCP_FRAME_TYPE);
+#endif
     while (1)
     {
-        //清空缓存
-        memset(databuff, 0x00, sizeof(databuff));
         //读取接收数据
         len = recv(connect_socket, databuff, sizeof(databuff), 0);
         g_rxtx_need_restart = false;
         if (len > 0)
         {
             //g_total_data += len;
-            //打印接收到的数组
-            ESP_LOGI(TAG, "recvData: %s", databuff);
-            //接收数据回发
-            send(connect_socket, databuff, strlen(databuff), 0);
+#if TCP_FRAME_OPTION
+            //按长度头切帧，本次recv得到的所有回发帧合并成一次send
+            ret = tcp_frame_parser_feed(&frame_parser, (const uint8_t *)databuff, len);
+            //出错前已切出的帧照常回发
+            tcp_frame_batch_flush(&frame_batch);
+            if (ret < 0)
+            {
+                //长度头出错后无法再找到帧边界，复位解析器并断开连接，由tcp_connect重新建立
+                ESP_LOGW(TAG, "frame length error, close connection");
+                tcp_frame_parser_reset(&frame_parser);
+#if TCP_SERVER_CLIENT_OPTION
+                //server只关闭这个连接，监听socket留给重建时使用
+                close(connect_socket);
+                g_rxtx_need_restart = true;
+                vTaskDelete(NULL);
+#else
+                break;
+#endif
+            }
+#else
+            //打印接收到的数组，数据可能是二进制，按长度打印
+            ESP_LOGI(TAG, "recvData: %d bytes", len);
+            ESP_LOG_BUFFER_HEXDUMP(TAG, databuff, len, ESP_LOG_DEBUG);
+            //接收数据按实际长度回发
+            if (tcp_send_all(connect_socket, databuff, len) < 0)
+            {
+                show_socket_error_reason("send_data", connect_socket);
+            }
+#endif
             //sendto(connect_socket, databuff , sizeof(databuff), 0, (struct sockaddr *) &remote_addr,sizeof(remote_addr));
         }
         else
@@ -160,6 +228,89 @@ void recv_data(void *pvParameters)
     vTaskDelete(NULL);
 }
 
+/*
+* 发送全部数据，send只发出部分时继续发送剩余部分
+* @param[in]   socket  		       :socket编号
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :数据长度
+* @retval      int                 :已发送长度，<0失败
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+int tcp_send_all(int socket, const void *data, size_t len)
+{
+    const char *p = (const char *)data;
+    size_t sent = 0;
+    int ret;
+    while (sent < len)
+    {
+        ret = send(socket, p + sent, len - sent, 0);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        sent += ret;
+    }
+    return sent;
+}
+
+/*
+* 聚合发送：多段数据用一次sendmsg发出，不需要先拷贝到同一个缓存
+* @param[in]   socket  		       :socket编号
+* @param[in]   iov  		       :数据段数组，发送过程中会被修改
+* @param[in]   iovcnt  		       :数据段个数
+* @retval      int                 :已发送长度，<0失败
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+int tcp_sendv(int socket, struct iovec *iov, int iovcnt)
+{
+    struct msghdr msg;
+    int total = 0;
+    int ret;
+    //跳过空段
+    while (iovcnt > 0 && iov->iov_len == 0)
+    {
+        iov++;
+        iovcnt--;
+    }
+    while (iovcnt > 0)
+    {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        ret = sendmsg(socket, &msg, 0);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        total += ret;
+        //跳过已发完的段，剩余部分下次继续发
+        while (iovcnt > 0 && (size_t)ret >= iov->iov_len)
+        {
+            ret -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + ret;
+            iov->iov_len -= ret;
+        }
+    }
+    return total;
+}
+
 /*
 * 建立tcp server
 * @param[in]   isCreatServer  	    :首次true，下次false
@@ -227,39 +378,44 @@ esp_err_t create_tcp_server(bool isCreatServer)
                     hx-zsj, 2018/08/06, 初始化版本\n 
 *               Ver0.0.12:
                     hx-zsj, 2018/08/09, 增加close socket\n 
+*               Ver0.0.13:
+                    hx-zsj, 2026/10/17, 改为非阻塞connect，带超时和随机退避\n 
 */
 esp_err_t create_tcp_client()
 {
+    uint32_t attempts;
+    tcp_connector_state_t state;
 
-    ESP_LOGI(TAG, "will connect gateway ssid : %s port:%d",
-             TCP_SERVER_ADRESS, TCP_PORT);
-    //新建socket
-    connect_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (connect_socket < 0)
+    if (!tcp_connector_ready)
     {
-        //打印报错信息
-        show_socket_error_reason("create client", connect_socket);
-        //新建失败后，关闭新建的socket，等待下次新建
-        close(connect_socket);
-        return ESP_FAIL;
+        tcp_connector_init(&tcp_connector, TCP_SERVER_ADRESS, TCP_PORT,
+                           TCP_CONNECT_TIMEOUT_MS, TCP_BACKOFF_BASE_MS, TCP_BACKOFF_MAX_MS);
+        tcp_connector_ready = true;
     }
-    //配置连接服务器信息
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(TCP_PORT);
-    server_addr.sin_addr.s_addr = inet_addr(TCP_SERVER_ADRESS);
+    //上次的连接已断开（接收任务已关闭socket），先按退避时间等待
+    tcp_connector_lost(&tcp_connector);
+
+    ESP_LOGI(TAG, "will connect gateway ssid : %s port:%d",
+             TCP_SERVER_ADRESS, TCP_PORT);
     ESP_LOGI(TAG, "connectting server...");
-    //连接服务器
-    if (connect(connect_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    //运行状态机，直到连接成功或本次连接失败
+    attempts = tcp_connector.stats.attempts;
+    while (1)
     {
-        //打印报错信息
-        show_socket_error_reason("client connect", connect_socket);
-        ESP_LOGE(TAG, "connect failed!");
-        //连接失败后，关闭之前新建的socket，等待下次新建
-        close(connect_socket);
-        return ESP_FAIL;
+        state = tcp_connector_poll(&tcp_connector, 1000);
+        if (state == TCP_CONNECTOR_CONNECTED)
+        {
+            connect_socket = tcp_connector.sock;
+            tcp_connector_show_stats(&tcp_connector);
+            return ESP_OK;
+        }
+        if (state == TCP_CONNECTOR_BACKOFF && tcp_connector.stats.attempts != attempts)
+        {
+            ESP_LOGE(TAG, "connect failed!");
+            tcp_connector_show_stats(&tcp_connector);
+            return ESP_FAIL;
+        }
     }
-    ESP_LOGI(TAG, "connect success!");
-    return ESP_OK;
 }
 
 
@@ -0,0 +1,330 @@
+/*
+* @file         tcp_connector.c
+* @brief        非阻塞tcp client连接状态机
+* @details      connect改为非阻塞并自带超时，失败后按随机抖动的指数退避重连，
+*               避免服务器宕机时任务卡在lwip超时里，也避免大量设备同一时刻重连
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "tcp_bsp.h"
+#include "tcp_connector.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/*
+* 距离某时刻已经过去的毫秒数
+* @param[in]   t  		           :起始tick
+* @retval      uint32_t            :毫秒数
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static uint32_t tcp_connector_elapsed_ms(TickType_t t)
+{
+    return (uint32_t)(xTaskGetTickCount() - t) * portTICK_PERIOD_MS;
+}
+
+/*
+* 距离某时刻还剩的毫秒数，已到返回0
+* @param[in]   t  		           :截止tick
+* @retval      uint32_t            :毫秒数
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static uint32_t tcp_connector_remain_ms(TickType_t t)
+{
+    int32_t diff = (int32_t)(t - xTaskGetTickCount());
+    return diff > 0 ? (uint32_t)diff * portTICK_PERIOD_MS : 0;
+}
+
+/*
+* 初始化连接状态机
+* @param[in]   c  		           :状态机
+* @param[in]   ip  		           :服务器地址
+* @param[in]   port  		       :服务器端口
+* @param[in]   timeout_ms  		   :单次连接超时
+* @param[in]   backoff_base_ms     :退避上限初值
+* @param[in]   backoff_max_ms      :退避上限最大值
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_connector_init(tcp_connector_t *c, const char *ip, uint16_t port,
+                        uint32_t timeout_ms, uint32_t backoff_base_ms, uint32_t backoff_max_ms)
+{
+    memset(c, 0, sizeof(*c));
+    c->addr.sin_family = AF_INET;
+    c->addr.sin_port = htons(port);
+    c->addr.sin_addr.s_addr = inet_addr(ip);
+    c->timeout_ms = timeout_ms;
+    c->backoff_base_ms = backoff_base_ms;
+    c->backoff_max_ms = backoff_max_ms;
+    c->backoff_ms = backoff_base_ms;
+    c->state = TCP_CONNECTOR_IDLE;
+    c->sock = -1;
+}
+
+/*
+* 进入退避：在[0, backoff_ms]内取随机等待时间，然后把上限翻倍
+* @param[in]   c  		           :状态机
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_connector_backoff(tcp_connector_t *c)
+{
+    uint32_t delay_ms = esp_random() % (c->backoff_ms + 1);
+    c->stats.last_backoff_ms = delay_ms;
+    c->deadline = xTaskGetTickCount() + delay_ms / portTICK_PERIOD_MS;
+    c->state = TCP_CONNECTOR_BACKOFF;
+    c->backoff_ms = c->backoff_ms * 2 > c->backoff_max_ms ? c->backoff_max_ms : c->backoff_ms * 2;
+    ESP_LOGI(TAG, "reconnect after %u ms", delay_ms);
+}
+
+/*
+* 本次连接失败，关闭socket并进入退避
+* @param[in]   c  		           :状态机
+* @param[in]   err  		       :失败原因errno，0表示超时
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_connector_fail(tcp_connector_t *c, int err)
+{
+    if (err == 0)
+    {
+        c->stats.timeouts++;
+        ESP_LOGW(TAG, "connect timeout after %u ms", tcp_connector_elapsed_ms(c->start));
+    }
+    else
+    {
+        if (err == ECONNREFUSED || err == ECONNRESET)
+        {
+            c->stats.refused++;
+        }
+        else
+        {
+            c->stats.errors++;
+        }
+        ESP_LOGW(TAG, "connect failed %d %s", err, strerror(err));
+    }
+    if (c->sock >= 0)
+    {
+        close(c->sock);
+        c->sock = -1;
+    }
+    tcp_connector_backoff(c);
+}
+
+/*
+* 连接成功，socket恢复为阻塞模式给接收任务使用
+* @param[in]   c  		           :状态机
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_connector_success(tcp_connector_t *c)
+{
+    int flags = fcntl(c->sock, F_GETFL, 0);
+    fcntl(c->sock, F_SETFL, flags & ~O_NONBLOCK);
+    c->stats.successes++;
+    c->stats.last_connect_ms = tcp_connector_elapsed_ms(c->start);
+    //退避上限等连接稳定后再复位，连上就断的服务器不会被快速重连
+    c->connected = xTaskGetTickCount();
+    c->state = TCP_CONNECTOR_CONNECTED;
+    ESP_LOGI(TAG, "connect success in %u ms", c->stats.last_connect_ms);
+}
+
+/*
+* 发起一次非阻塞连接
+* @param[in]   c  		           :状态机
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_connector_start(tcp_connector_t *c)
+{
+    int flags;
+    c->stats.attempts++;
+    c->start = xTaskGetTickCount();
+    c->sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (c->sock < 0)
+    {
+        tcp_connector_fail(c, errno);
+        return;
+    }
+    flags = fcntl(c->sock, F_GETFL, 0);
+    fcntl(c->sock, F_SETFL, flags | O_NONBLOCK);
+    if (connect(c->sock, (struct sockaddr *)&c->addr, sizeof(c->addr)) == 0)
+    {
+        tcp_connector_success(c);
+        return;
+    }
+    if (errno != EINPROGRESS)
+    {
+        tcp_connector_fail(c, errno);
+        return;
+    }
+    c->deadline = c->start + c->timeout_ms / portTICK_PERIOD_MS;
+    c->state = TCP_CONNECTOR_CONNECTING;
+}
+
+/*
+* 等待非阻塞连接完成
+* @param[in]   c  		           :状态机
+* @param[in]   wait_ms  		   :最多等待时间
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_connector_wait(tcp_connector_t *c, uint32_t wait_ms)
+{
+    fd_set write_set;
+    struct timeval tv;
+    int err = 0;
+    socklen_t optlen = sizeof(err);
+    uint32_t remain = tcp_connector_remain_ms(c->deadline);
+
+    if (wait_ms > remain)
+    {
+        wait_ms = remain;
+    }
+    FD_ZERO(&write_set);
+    FD_SET(c->sock, &write_set);
+    tv.tv_sec = wait_ms / 1000;
+    tv.tv_usec = (wait_ms % 1000) * 1000;
+    if (select(c->sock + 1, NULL, &write_set, NULL, &tv) > 0)
+    {
+        //可写说明连接有结果，用SO_ERROR区分成功和失败
+        if (getsockopt(c->sock, SOL_SOCKET, SO_ERROR, &err, &optlen) < 0)
+        {
+            err = errno;
+        }
+        if (err == 0)
+        {
+            tcp_connector_success(c);
+        }
+        else
+        {
+            tcp_connector_fail(c, err);
+        }
+        return;
+    }
+    if (tcp_connector_remain_ms(c->deadline) == 0)
+    {
+        tcp_connector_fail(c, 0);
+    }
+}
+
+/*
+* 运行连接状态机
+* @param[in]   c  		           :状态机
+* @param[in]   wait_ms  		   :最多阻塞时间
+* @retval      tcp_connector_state_t :当前状态，TCP_CONNECTOR_CONNECTED时c->sock可用
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+tcp_connector_state_t tcp_connector_poll(tcp_connector_t *c, uint32_t wait_ms)
+{
+    uint32_t remain;
+    switch (c->state)
+    {
+    case TCP_CONNECTOR_IDLE:
+        tcp_connector_start(c);
+        if (c->state == TCP_CONNECTOR_CONNECTING)
+        {
+            tcp_connector_wait(c, wait_ms);
+        }
+        break;
+    case TCP_CONNECTOR_CONNECTING:
+        tcp_connector_wait(c, wait_ms);
+        break;
+    case TCP_CONNECTOR_BACKOFF:
+        remain = tcp_connector_remain_ms(c->deadline);
+        if (remain > wait_ms)
+        {
+            vTaskDelay(wait_ms / portTICK_PERIOD_MS);
+            break;
+        }
+        if (remain > 0)
+        {
+            vTaskDelay(remain / portTICK_PERIOD_MS);
+        }
+        c->state = TCP_CONNECTOR_IDLE;
+        break;
+    case TCP_CONNECTOR_CONNECTED:
+    default:
+        break;
+    }
+    return c->state;
+}
+
+/*
+* 连接已断开（socket已由使用方关闭），进入退避；
+* 连接保持了TCP_BACKOFF_STABLE_MS以上时退避上限回到初值，否则继续翻倍
+* @param[in]   c  		           :状态机
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_connector_lost(tcp_connector_t *c)
+{
+    if (c->state != TCP_CONNECTOR_CONNECTED)
+    {
+        return;
+    }
+    c->stats.drops++;
+    c->sock = -1;
+    if (tcp_connector_elapsed_ms(c->connected) >= TCP_BACKOFF_STABLE_MS)
+    {
+        c->backoff_ms = c->backoff_base_ms;
+    }
+    tcp_connector_backoff(c);
+}
+
+/*
+* 打印连接统计
+* @param[in]   c  		           :状态机
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_connector_show_stats(const tcp_connector_t *c)
+{
+    ESP_LOGI(TAG, "connect attempts %u success %u refused %u timeout %u error %u drop %u",
+             c->stats.attempts, c->stats.successes, c->stats.refused,
+             c->stats.timeouts, c->stats.errors, c->stats.drops);
+}
@@ -0,0 +1,295 @@
+/*
+* @file         tcp_frame.c
+* @brief        TCP数据流的长度前缀分帧
+* @details      TCP是字节流，一次recv可能包含多帧或半帧，这里按长度头重新切分，
+*               整帧在本次recv数据中时直接回调原数据，不做拷贝；
+*               发送方向把多个小帧合并成一次send
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#include <string.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "tcp_bsp.h"
+#include "tcp_frame.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/*
+* 初始化解析器
+* @param[in]   p  		           :解析器
+* @param[in]   type  		       :长度头格式
+* @param[in]   cb  		           :完整帧回调
+* @param[in]   arg  		       :回调参数
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_frame_parser_init(tcp_frame_parser_t *p, tcp_frame_type_t type, tcp_frame_cb_t cb, void *arg)
+{
+    p->type = type;
+    p->cb = cb;
+    p->arg = arg;
+    tcp_frame_parser_reset(p);
+}
+
+/*
+* 复位解析器，丢弃未收完的帧
+* @param[in]   p  		           :解析器
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_frame_parser_reset(tcp_frame_parser_t *p)
+{
+    p->frame_len = 0;
+    p->hdr_bytes = 0;
+    p->in_body = false;
+    p->have = 0;
+}
+
+/*
+* 解析一个长度头字节
+* @param[in]   p  		           :解析器
+* @param[in]   c  		           :长度头字节
+* @retval      int                 :1长度头完整，0还需要更多字节，<0长度头错误
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int tcp_frame_hdr_byte(tcp_frame_parser_t *p, uint8_t c)
+{
+    if (p->type == TCP_FRAME_U16)
+    {
+        p->frame_len = (p->frame_len << 8) | c;
+        p->hdr_bytes++;
+        return p->hdr_bytes == 2;
+    }
+    //varint：低7位为数据，最高位为1表示后面还有字节
+    p->frame_len |= (uint32_t)(c & 0x7f) << (7 * p->hdr_bytes);
+    p->hdr_bytes++;
+    if (c & 0x80)
+    {
+        return p->hdr_bytes < TCP_FRAME_HDR_MAX ? 0 : -1;
+    }
+    return 1;
+}
+
+/*
+* 输入一段数据流，每凑齐一帧回调一次
+* @param[in]   p  		           :解析器
+* @param[in]   data  		       :recv得到的数据
+* @param[in]   len  		       :数据长度
+* @retval      int                 :本次回调的帧数，<0帧长度错误，解析器已复位
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int tcp_frame_parser_feed(tcp_frame_parser_t *p, const uint8_t *data, size_t len)
+{
+    int frames = 0;
+    size_t need;
+    int ret;
+
+    while (len > 0)
+    {
+        if (!p->in_body)
+        {
+            //解析长度头，长度头本身也可能被拆开
+            ret = tcp_frame_hdr_byte(p, *data);
+            data++;
+            len--;
+            if (ret == 0)
+            {
+                continue;
+            }
+            if (ret < 0 || p->frame_len > TCP_FRAME_MAX_LEN)
+            {
+                tcp_frame_parser_reset(p);
+                return -1;
+            }
+            p->in_body = true;
+            p->have = 0;
+            //空帧
+            if (p->frame_len == 0)
+            {
+                p->cb(p->arg, p->buf, 0);
+                frames++;
+                tcp_frame_parser_reset(p);
+            }
+            continue;
+        }
+        if (p->have == 0 && len >= p->frame_len)
+        {
+            //整帧都在本次数据中，直接回调，不拷贝
+            p->cb(p->arg, data, p->frame_len);
+            data += p->frame_len;
+            len -= p->frame_len;
+            frames++;
+            tcp_frame_parser_reset(p);
+            continue;
+        }
+        //半帧，先缓存，凑齐后再回调
+        need = p->frame_len - p->have;
+        if (need > len)
+        {
+            need = len;
+        }
+        memcpy(p->buf + p->have, data, need);
+        p->have += need;
+        data += need;
+        len -= need;
+        if (p->have == p->frame_len)
+        {
+            p->cb(p->arg, p->buf, p->frame_len);
+            frames++;
+            tcp_frame_parser_reset(p);
+        }
+    }
+    return frames;
+}
+
+/*
+* 生成长度头
+* @param[in]   type  		       :长度头格式
+* @param[in]   len  		       :帧长度
+* @param[out]  hdr  		       :长度头，至少TCP_FRAME_HDR_MAX字节
+* @retval      int                 :长度头字节数，<0长度超出格式范围
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int tcp_frame_encode_hdr(tcp_frame_type_t type, size_t len, uint8_t *hdr)
+{
+    int n = 0;
+    if (type == TCP_FRAME_U16)
+    {
+        if (len > 0xffff)
+        {
+            return -1;
+        }
+        hdr[0] = (uint8_t)(len >> 8);
+        hdr[1] = (uint8_t)len;
+        return 2;
+    }
+    if (len >= (1u << (7 * TCP_FRAME_HDR_MAX)))
+    {
+        return -1;
+    }
+    do
+    {
+        hdr[n] = len & 0x7f;
+        len >>= 7;
+        if (len)
+        {
+            hdr[n] |= 0x80;
+        }
+        n++;
+    } while (len);
+    return n;
+}
+
+/*
+* 初始化合并发送
+* @param[in]   b  		           :合并发送缓存
+* @param[in]   sock  		       :发送socket
+* @param[in]   type  		       :长度头格式
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_frame_batch_init(tcp_frame_batch_t *b, int sock, tcp_frame_type_t type)
+{
+    b->sock = sock;
+    b->type = type;
+    b->used = 0;
+    b->frames = 0;
+}
+
+/*
+* 发出缓存中的所有帧
+* @param[in]   b  		           :合并发送缓存
+* @retval      int                 :发送字节数，<0失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int tcp_frame_batch_flush(tcp_frame_batch_t *b)
+{
+    int ret;
+    if (b->used == 0)
+    {
+        return 0;
+    }
+    ret = tcp_send_all(b->sock, b->buf, b->used);
+    b->used = 0;
+    b->frames = 0;
+    return ret;
+}
+
+/*
+* 加入一帧，小帧拷贝进合并缓存，放不下的大帧先发缓存再用聚合发送直接发出
+* @param[in]   b  		           :合并发送缓存
+* @param[in]   data  		       :帧内容
+* @param[in]   len  		       :帧长度
+* @retval      int                 :0成功，<0失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int tcp_frame_batch_add(tcp_frame_batch_t *b, const void *data, size_t len)
+{
+    uint8_t hdr[TCP_FRAME_HDR_MAX];
+    struct iovec iov[2];
+    int hdr_len = tcp_frame_encode_hdr(b->type, len, hdr);
+
+    if (hdr_len < 0)
+    {
+        return -1;
+    }
+    //大帧：不拷贝，长度头和内容一次sendmsg
+    if (hdr_len + len > sizeof(b->buf))
+    {
+        if (tcp_frame_batch_flush(b) < 0)
+        {
+            return -1;
+        }
+        iov[0].iov_base = hdr;
+        iov[0].iov_len = hdr_len;
+        iov[1].iov_base = (void *)data;
+        iov[1].iov_len = len;
+        return tcp_sendv(b->sock, iov, 2) < 0 ? -1 : 0;
+    }
+    //缓存放不下，先发出
+    if (b->used + hdr_len + len > sizeof(b->buf))
+    {
+        if (tcp_frame_batch_flush(b) < 0)
+        {
+            return -1;
+        }
+    }
+    memcpy(b->buf + b->used, hdr, hdr_len);
+    memcpy(b->buf + b->used + hdr_len, data, len);
+    b->used += hdr_len + len;
+    b->frames++;
+    return 0;
+}
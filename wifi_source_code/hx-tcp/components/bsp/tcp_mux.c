@@ -0,0 +1,461 @@
+/*
+* @file         tcp_mux.c
+* @brief        单任务多连接tcp server
+* @details      用select在一个任务里服务多个client，每个连接只占连接表中的一项，
+*               不再为每个client新建任务和栈
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "tcp_bsp.h"
+#include "tcp_mux.h"
+
+/*
+===========================
+全局变量定义
+===========================
+*/
+static int listen_socket = -1;                          //监听socket
+static uint16_t listen_port = 0;                        //监听端口，监听socket失效时按它重建
+static tcp_conn_t conn_table[TCP_MUX_MAX_CONN];         //连接表
+static int conn_count = 0;                              //当前连接数
+static tcp_mux_recv_cb_t recv_cb = NULL;                //接收回调
+static uint8_t rx_buff[TCP_MUX_RX_BUFF_LEN];            //所有连接共用的接收缓存
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/*
+* 默认接收回调：原样回发
+* @param[in]   conn  		       :连接表项
+* @param[in]   data  		       :接收到的数据
+* @param[in]   len  		       :数据长度
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_mux_echo(tcp_conn_t *conn, const uint8_t *data, int len)
+{
+    tcp_mux_send(conn, data, len);
+}
+
+/*
+* 不阻塞地发送发送队列中的数据，发不完的留到下次可写时
+* @param[in]   conn  		       :连接表项
+* @retval      int                 :0成功或暂时不可写，<0连接出错
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int tcp_mux_flush(tcp_conn_t *conn)
+{
+    int ret;
+    while (conn->tx_len > 0)
+    {
+        ret = send(conn->sock, conn->tx_buff, conn->tx_len, MSG_DONTWAIT);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return 0;
+            }
+            return -1;
+        }
+        conn->tx_bytes += ret;
+        conn->tx_len -= ret;
+        memmove(conn->tx_buff, conn->tx_buff + ret, conn->tx_len);
+    }
+    return 0;
+}
+
+/*
+* 发送数据，不阻塞：发送队列为空时先直接发，发不完的部分放进发送队列，
+* 由server任务在socket可写时继续发送；发送队列放不下时认为对端太慢，断开这个连接
+* @param[in]   conn  		       :连接表项
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :数据长度
+* @retval      int                 :len，-1连接已关闭
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int tcp_mux_send(tcp_conn_t *conn, const void *data, int len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    int left = len;
+    int ret;
+
+    if (conn->state != TCP_CONN_ACTIVE)
+    {
+        return -1;
+    }
+    //前面还有没发完的数据时必须排在后面，不能直接发
+    while (conn->tx_len == 0 && left > 0)
+    {
+        ret = send(conn->sock, p, left, MSG_DONTWAIT);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+            show_socket_error_reason("send_mux_server", conn->sock);
+            tcp_mux_conn_close(conn);
+            return -1;
+        }
+        conn->tx_bytes += ret;
+        p += ret;
+        left -= ret;
+    }
+    if (left > TCP_MUX_TX_BUFF_LEN - conn->tx_len)
+    {
+        ESP_LOGW(TAG, "client %s:%u too slow, %u bytes queued, drop it",
+                 inet_ntoa(conn->addr.sin_addr), ntohs(conn->addr.sin_port), conn->tx_len);
+        tcp_mux_conn_close(conn);
+        return -1;
+    }
+    memcpy(conn->tx_buff + conn->tx_len, p, left);
+    conn->tx_len += left;
+    return len;
+}
+
+/*
+* 新建监听socket，端口为listen_port
+* @param[in]   void  		       :无
+* @retval      esp_err_t           :ESP_OK成功，ESP_FAIL失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static esp_err_t tcp_mux_listen(void)
+{
+    struct sockaddr_in server_addr;
+    int opt = 1;
+
+    //新建socket
+    listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_socket < 0)
+    {
+        show_socket_error_reason("create_mux_server", listen_socket);
+        return ESP_FAIL;
+    }
+    //重启server时端口可以马上复用
+    setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    //bind:地址的绑定
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(listen_port);
+    server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listen_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    {
+        show_socket_error_reason("bind_mux_server", listen_socket);
+        close(listen_socket);
+        listen_socket = -1;
+        return ESP_FAIL;
+    }
+    //listen
+    if (listen(listen_socket, TCP_MUX_LISTEN_BACKLOG) < 0)
+    {
+        show_socket_error_reason("listen_mux_server", listen_socket);
+        close(listen_socket);
+        listen_socket = -1;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/*
+* 清空连接表并建立监听socket
+* @param[in]   port  		       :监听端口
+* @retval      esp_err_t           :ESP_OK成功，ESP_FAIL失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+esp_err_t tcp_mux_server_init(uint16_t port)
+{
+    ESP_LOGI(TAG, "mux server socket....,port=%d", port);
+    //清空连接表
+    memset(conn_table, 0, sizeof(conn_table));
+    for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+    {
+        conn_table[i].sock = -1;
+    }
+    conn_count = 0;
+    listen_port = port;
+    return tcp_mux_listen();
+}
+
+/*
+* 设置接收回调
+* @param[in]   cb  		           :接收回调，NULL表示原样回发
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_mux_set_recv_cb(tcp_mux_recv_cb_t cb)
+{
+    recv_cb = cb;
+}
+
+/*
+* 获取当前连接数
+* @param[in]   void  		       :无
+* @retval      int                 :连接数
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int tcp_mux_conn_count(void)
+{
+    return conn_count;
+}
+
+/*
+* 关闭一个连接并释放连接表项
+* @param[in]   conn  		       :连接表项
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_mux_conn_close(tcp_conn_t *conn)
+{
+    if (conn->state == TCP_CONN_FREE)
+    {
+        return;
+    }
+    ESP_LOGI(TAG, "client %s:%u leave, rx %u tx %u",
+             inet_ntoa(conn->addr.sin_addr), ntohs(conn->addr.sin_port),
+             conn->rx_bytes, conn->tx_bytes);
+    close(conn->sock);
+    conn->sock = -1;
+    conn->tx_len = 0;
+    conn->state = TCP_CONN_FREE;
+    conn_count--;
+}
+
+/*
+* 接受新连接，放入连接表空闲项，连接表满时直接关闭
+* @param[in]   void  		       :无
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_mux_accept(void)
+{
+    struct sockaddr_in addr;
+    unsigned int socklen = sizeof(addr);
+    int sock = accept(listen_socket, (struct sockaddr *)&addr, &socklen);
+    if (sock < 0)
+    {
+        show_socket_error_reason("accept_mux_server", listen_socket);
+        return;
+    }
+    for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+    {
+        if (conn_table[i].state == TCP_CONN_FREE)
+        {
+            conn_table[i].sock = sock;
+            conn_table[i].state = TCP_CONN_ACTIVE;
+            conn_table[i].addr = addr;
+            conn_table[i].rx_bytes = 0;
+            conn_table[i].tx_bytes = 0;
+            conn_table[i].tx_len = 0;
+            conn_count++;
+            ESP_LOGI(TAG, "client %s:%u join, slot %d, total %d",
+                     inet_ntoa(addr.sin_addr), ntohs(addr.sin_port), i, conn_count);
+            return;
+        }
+    }
+    //连接表满
+    ESP_LOGW(TAG, "conn table full, reject %s:%u", inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+    close(sock);
+}
+
+/*
+* select报EBADF时找出失效的socket：失效的连接直接释放，失效的监听socket关闭后等下一轮重建
+* @param[in]   void  		       :无
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void tcp_mux_drop_bad_fd(void)
+{
+    for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+    {
+        if (conn_table[i].state == TCP_CONN_ACTIVE && fcntl(conn_table[i].sock, F_GETFL, 0) < 0)
+        {
+            ESP_LOGW(TAG, "slot %d socket %d invalid", i, conn_table[i].sock);
+            tcp_mux_conn_close(&conn_table[i]);
+        }
+    }
+    if (listen_socket >= 0 && fcntl(listen_socket, F_GETFL, 0) < 0)
+    {
+        ESP_LOGW(TAG, "listen socket %d invalid", listen_socket);
+        close(listen_socket);
+        listen_socket = -1;
+    }
+}
+
+/*
+* 单任务多连接server：select监听socket、所有已建立连接的可读，以及发送队列不空的连接的可写
+* @param[in]   void  		       :无
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void tcp_mux_server_task(void *pvParameters)
+{
+    fd_set read_set;
+    fd_set write_set;
+    struct timeval tv;
+    int max_fd;
+    int ret;
+    tcp_mux_recv_cb_t cb;
+
+    while (1)
+    {
+        //监听socket失效后在这里重建，已建立的连接照常服务
+        if (listen_socket < 0)
+        {
+            tcp_mux_listen();
+        }
+        //组织select集合
+        FD_ZERO(&read_set);
+        FD_ZERO(&write_set);
+        max_fd = -1;
+        if (listen_socket >= 0)
+        {
+            FD_SET(listen_socket, &read_set);
+            max_fd = listen_socket;
+        }
+        for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+        {
+            tcp_conn_t *conn = &conn_table[i];
+            if (conn->state != TCP_CONN_ACTIVE)
+            {
+                continue;
+            }
+            //发送队列放不下一次接收的回发时先不读，等对端把数据收走
+            if (TCP_MUX_TX_BUFF_LEN - conn->tx_len >= TCP_MUX_RX_BUFF_LEN)
+            {
+                FD_SET(conn->sock, &read_set);
+            }
+            if (conn->tx_len > 0)
+            {
+                FD_SET(conn->sock, &write_set);
+            }
+            if (conn->sock > max_fd)
+            {
+                max_fd = conn->sock;
+            }
+        }
+        tv.tv_sec = TCP_MUX_SELECT_MS / 1000;
+        tv.tv_usec = (TCP_MUX_SELECT_MS % 1000) * 1000;
+        if (max_fd < 0)
+        {
+            //监听socket重建失败且没有连接，等一会再试
+            vTaskDelay(TCP_MUX_SELECT_MS / portTICK_RATE_MS);
+            continue;
+        }
+        ret = select(max_fd + 1, &read_set, &write_set, NULL, &tv);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ESP_LOGW(TAG, "select_mux_server error %d %s", errno, strerror(errno));
+            if (errno == EBADF)
+            {
+                tcp_mux_drop_bad_fd();
+            }
+            else
+            {
+                vTaskDelay(TCP_MUX_SELECT_MS / portTICK_RATE_MS);
+            }
+            continue;
+        }
+        if (ret == 0)
+        {
+            ESP_LOGD(TAG, "mux server idle, %d connections", conn_count);
+            continue;
+        }
+        //新连接
+        if (listen_socket >= 0 && FD_ISSET(listen_socket, &read_set))
+        {
+            tcp_mux_accept();
+        }
+        //已建立连接的收发
+        for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+        {
+            tcp_conn_t *conn = &conn_table[i];
+            if (conn->state != TCP_CONN_ACTIVE)
+            {
+                continue;
+            }
+            //先发，腾出发送队列
+            if (FD_ISSET(conn->sock, &write_set) && tcp_mux_flush(conn) < 0)
+            {
+                show_socket_error_reason("send_mux_server", conn->sock);
+                tcp_mux_conn_close(conn);
+                continue;
+            }
+            if (!FD_ISSET(conn->sock, &read_set))
+            {
+                continue;
+            }
+            //select已确认可读，recv不会阻塞
+            ret = recv(conn->sock, rx_buff, sizeof(rx_buff), 0);
+            if (ret > 0)
+            {
+                conn->rx_bytes += ret;
+                cb = recv_cb ? recv_cb : tcp_mux_echo;
+                cb(conn, rx_buff, ret);
+            }
+            else
+            {
+                //对端关闭或异常，只释放这一个连接
+                if (ret < 0)
+                {
+                    show_socket_error_reason("recv_mux_server", conn->sock);
+                }
+                tcp_mux_conn_close(conn);
+            }
+        }
+    }
+}
@@ -10,6 +10,8 @@
                     hx-zsj, 2018/08/08, 初始化版本\n 
 *               Ver0.0.2:
                     hx-zsj, 2018/08/09, 增加close socket，防止连接不上服务器多次后，就再也连不上\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, server增加单任务多连接模式\n 
 */
 
 /* 
@@ -25,6 +27,7 @@
 #include "esp_err.h"
 #include "nvs_flash.h"
 #include "tcp_bsp.h"
+#include "tcp_mux.h"
 	
 /*
 ===========================
@@ -39,9 +42,27 @@
 * @note        修改日志 
 *               Ver0.0.1:
                     hx-zsj, 2018/08/06, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 增加单任务多连接server\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, client重连去掉固定延时，改由退避控制\n 
 */
 static void tcp_connect(void *pvParameters)
 {
+#if TCP_SERVER_CLIENT_OPTION && TCP_SERVER_MUX_OPTION
+    //单任务多连接server：建立一次监听，之后所有client由tcp_mux_server_task服务
+    xEventGroupWaitBits(tcp_event_group, WIFI_CONNECTED_BIT, false, true, portMAX_DELAY);
+    ESP_LOGI(TAG, "create tcp mux server");
+    while (ESP_OK != tcp_mux_server_init(TCP_PORT))
+    {
+        vTaskDelay(3000 / portTICK_RATE_MS);
+    }
+    if (pdPASS != xTaskCreate(&tcp_mux_server_task, "tcp_mux_server", 4096, NULL, 4, NULL))
+    {
+        ESP_LOGE(TAG, "mux server task create fail!");
+    }
+    vTaskDelete(NULL);
+#endif
     while (1)
     {
         g_rxtx_need_restart = false;
@@ -57,8 +78,7 @@ static void tcp_connect(void *pvParameters)
         //建立server
         int socket_ret = create_tcp_server(true);
 #else
-        //延时3S准备建立clien
-        vTaskDelay(3000 / portTICK_RATE_MS);
+        //client不再固定延时，失败重连的等待由create_tcp_client内的随机退避决定
         ESP_LOGI(TAG, "create tcp Client");
         //建立client
         int socket_ret = create_tcp_client();
@@ -117,7 +137,6 @@ static void tcp_connect(void *pvParameters)
             //重新建立client，流程和上面一样
             if (g_rxtx_need_restart)
             {
-                vTaskDelay(3000 / portTICK_RATE_MS);
                 ESP_LOGI(TAG, "reStart create tcp client...");
                 //建立client
                 int socket_ret = create_tcp_client();
@@ -0,0 +1,236 @@
+/**
+* @file         user_cloud_conn.h
+* @brief        云平台长连接引擎的相关声明
+* @details      一个任务独占socket和TLS上下文,用select同时等待可读、可写和最近的定时器;
+*               其他任务要发送的数据先放进发送队列,再往回环UDP唤醒socket发一个字节叫醒select,
+*               只有连接任务调用mbedtls_ssl_write;心跳等周期动作作为定时器在连接任务里执行,不再单独创建任务
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 增加cloud_conn_idle_ms,心跳按连接实际空闲的时间发送\n
+*/
+#ifndef USER_CLOUD_CONN_H_
+#define USER_CLOUD_CONN_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mbedtls/net.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include <freertos/FreeRTOS.h>
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "user_tls_profile.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define CLOUD_CONN_TASK_STACK         (1024 * 8)            ///<连接任务的栈,握手和各个回调都在这个任务里执行
+#define CLOUD_CONN_TASK_PRIO          3                     ///<连接任务的优先级
+#define CLOUD_CONN_RX_LEN             1024                  ///<一次从TLS读出的最大字节数
+#define CLOUD_CONN_RX_BURST           4                     ///<每轮最多连续读几次,之后先处理发送和定时器
+#define CLOUD_CONN_FRAME_LEN          128                   ///<一帧发送数据的最大长度
+#define CLOUD_CONN_TX_DEPTH           4                     ///<发送队列能排几帧
+#define CLOUD_CONN_TIMERS             4                     ///<定时器个数
+#define CLOUD_CONN_POLL_MS            100                   ///<唤醒socket建立失败时select的最长等待,其他任务排进队列的帧最迟这么久发出
+#ifndef CLOUD_CONN_CONNECT_MS
+#define CLOUD_CONN_CONNECT_MS         10000                 ///<TCP连接超时
+#endif
+#ifndef CLOUD_CONN_HANDSHAKE_MS
+#define CLOUD_CONN_HANDSHAKE_MS       10000                 ///<TLS握手超时
+#endif
+#define CLOUD_CONN_BACKOFF_BASE_MS    1000                  ///<重连等待上限的初值
+#define CLOUD_CONN_BACKOFF_MAX_MS     60000                 ///<重连等待上限的最大值
+
+#define CLOUD_CONN_ERR_ARG            -0x0F51               ///<参数错误或者帧超过CLOUD_CONN_FRAME_LEN
+#define CLOUD_CONN_ERR_OFFLINE        -0x0F52               ///<连接还没有建立
+#define CLOUD_CONN_ERR_FULL           -0x0F53               ///<发送队列已满或者定时器已用完
+#define CLOUD_CONN_ERR_TASK           -0x0F54               ///<创建任务或者队列失败
+#define CLOUD_CONN_ERR_TIMEOUT        -0x0F55               ///<TCP连接或者握手超时
+
+/*
+===========================
+枚举变量
+===========================
+*/
+/* 连接状态 */
+enum
+{
+  CLOUD_CONN_IDLE,                                      ///<还没有启动
+  CLOUD_CONN_BACKOFF,                                   ///<等待重连
+  CLOUD_CONN_CONNECTING,                                ///<非阻塞TCP连接还没有完成
+  CLOUD_CONN_HANDSHAKE,                                 ///<TCP已连上,正在TLS握手
+  CLOUD_CONN_ONLINE,                                    ///<可以收发数据
+};
+
+/*
+===========================
+类型定义
+===========================
+*/
+typedef struct cloud_conn cloud_conn_t;
+
+/* 定时器回调,在连接任务中执行 */
+typedef void (*cloud_conn_timer_cb_t)(cloud_conn_t *conn, void *arg);
+
+/* 连接事件回调,都在连接任务中执行,可以直接调用cloud_conn_send和定时器函数 */
+typedef struct
+{
+  void (*on_online)(cloud_conn_t *conn);                ///<握手完成
+  void (*on_data)(cloud_conn_t *conn, char *data, size_t len); ///<收到数据,data[len]处补了'\0'
+  void (*on_closed)(cloud_conn_t *conn, int reason);    ///<在线的连接断开,reason为0表示服务器关闭
+} cloud_conn_cb_t;
+
+/* 一帧待发送的数据 */
+typedef struct
+{
+  uint16_t                  len;
+  uint8_t                   data[CLOUD_CONN_FRAME_LEN];
+} cloud_conn_frame_t;
+
+/* 连接任务里的定时器 */
+typedef struct
+{
+  cloud_conn_timer_cb_t     cb;                         ///<NULL表示空闲
+  void                      *arg;
+  TickType_t                deadline;                   ///<下次到期的tick
+  TickType_t                period;                     ///<周期,0表示只执行一次
+} cloud_conn_timer_t;
+
+/* 连接的统计 */
+typedef struct
+{
+  uint32_t                  connects;                   ///<握手成功次数
+  uint32_t                  failures;                   ///<DNS、TCP连接或者握手失败次数
+  uint32_t                  drops;                      ///<在线后断开次数
+  uint32_t                  rx_bytes;                   ///<收到的明文字节数
+  uint32_t                  tx_frames;                  ///<发出的帧数
+  uint32_t                  tx_dropped;                 ///<断开时丢弃的未发送帧数
+  uint32_t                  wakeups;                    ///<select返回的次数
+} cloud_conn_stats_t;
+
+struct cloud_conn
+{
+  mbedtls_net_context       net;
+  mbedtls_ssl_context       ssl;
+  mbedtls_ssl_config        conf;
+  mbedtls_entropy_context   entropy;
+  mbedtls_ctr_drbg_context  ctr_drbg;
+  tls_heap_stats_t          heap;                       ///<mbedtls为这个连接申请的堆
+  const char                *host;
+  const char                *port;
+  uint8_t                   profile;                    ///<TLS_PROFILE_xxx
+  volatile uint8_t          state;                      ///<CLOUD_CONN_xxx
+  const cloud_conn_cb_t     *cb;
+  void                      *arg;                       ///<留给使用者的参数
+  TaskHandle_t              task;
+  QueueHandle_t             tx_queue;                   ///<cloud_conn_frame_t
+  cloud_conn_frame_t        tx;                         ///<正在发送的帧
+  uint16_t                  tx_off;                     ///<tx中已经发出的字节数
+  uint8_t                   tx_busy;                    ///<tx中还有没发完的数据
+  uint8_t                   tx_want_write;              ///<上次写返回WANT_WRITE,需要等socket可写
+  TickType_t                tx_last;                    ///<最后一帧写完的tick,握手完成时也记一次
+  int                       wake_fd;                    ///<绑定在127.0.0.1上的UDP唤醒socket,只有连接任务读,-1表示没有
+  int                       wake_tx_fd;                 ///<其他任务往wake_fd发唤醒字节用的socket
+  uint16_t                  wake_port;                  ///<wake_fd绑定的端口,网络字节序
+  SemaphoreHandle_t         wake_lock;                  ///<多个任务共用wake_tx_fd时互斥
+  TickType_t                deadline;                   ///<重连、TCP连接或者握手的截止tick
+  uint32_t                  backoff_ms;                 ///<当前的重连等待上限
+  cloud_conn_timer_t        timer[CLOUD_CONN_TIMERS];
+  cloud_conn_stats_t        stats;
+  char                      rx[CLOUD_CONN_RX_LEN + 1];
+};
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 启动连接任务,之后的连接、握手、断线重连都在连接任务中进行,本函数立即返回
+ * 已经启动过时直接返回0
+ * @param[in]   conn    :连接,必须一直有效,一般为全局变量
+ * @param[in]   host    :服务器地址,必须一直有效
+ * @param[in]   port    :服务器端口,必须一直有效
+ * @param[in]   profile :TLS_PROFILE_xxx
+ * @param[in]   cb      :事件回调,必须一直有效
+ * @param[in]   arg     :留给使用者的参数,存放在conn->arg
+ * @retval
+ *              0:成功
+ *              CLOUD_CONN_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_conn_start(cloud_conn_t *conn, const char *host, const char *port, uint8_t profile,
+                     const cloud_conn_cb_t *cb, void *arg);
+
+/**
+ * 发送一帧数据,拷贝进发送队列后立即返回,由连接任务写入TLS,可以在任何任务中调用
+ * 在其他任务中调用时会叫醒连接任务;在连接任务的回调中调用时,回调返回后马上发出
+ * @param[in]   conn    :连接
+ * @param[in]   data    :数据
+ * @param[in]   len     :长度,不超过CLOUD_CONN_FRAME_LEN
+ * @retval
+ *              0:成功
+ *              CLOUD_CONN_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_conn_send(cloud_conn_t *conn, const void *data, size_t len);
+
+/**
+ * 启动一个定时器,只能在连接任务的回调中调用;连接断开时所有定时器自动停止
+ * @param[in]   conn      :连接
+ * @param[in]   ms        :多少毫秒后到期
+ * @param[in]   periodic  :1:到期后按ms重新开始 0:只执行一次
+ * @param[in]   cb        :到期回调
+ * @param[in]   arg       :回调参数
+ * @retval
+ *              >=0:定时器编号
+ *              CLOUD_CONN_ERR_FULL:定时器已用完
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_conn_timer_start(cloud_conn_t *conn, uint32_t ms, uint8_t periodic,
+                           cloud_conn_timer_cb_t cb, void *arg);
+
+/**
+ * 停止一个定时器,只能在连接任务的回调中调用
+ * @param[in]   conn    :连接
+ * @param[in]   id      :cloud_conn_timer_start返回的编号,负数时不做任何事
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void cloud_conn_timer_stop(cloud_conn_t *conn, int id);
+
+/**
+ * 连接空闲了多久:距离最后一帧写完(还没发过帧时为握手完成)的毫秒数,只能在连接任务的回调中调用
+ * 连接断开后在on_closed中调用,得到的是断开时已经空闲的时长
+ * @param[in]   conn    :连接
+ * @retval      毫秒数
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+uint32_t cloud_conn_idle_ms(const cloud_conn_t *conn);
+
+#endif/* USER_CLOUD_CONN_H_ */
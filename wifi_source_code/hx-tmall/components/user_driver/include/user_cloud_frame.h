@@ -0,0 +1,115 @@
+/**
+* @file         user_cloud_frame.h
+* @brief        云平台签到、加密签到以及心跳帧的预先拼装
+* @details      各帧在cloud_frame_init时一次拼好放在arena中,之后只取地址和长度;
+*               加密签到帧中md5的位置固定,收到token后直接把十六进制结果写进帧里,不申请内存也不再拼装json;
+*               md5的输入是token+用户API KEY,用户API KEY预先放在arena中,token拷到它前面即可
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef USER_CLOUD_FRAME_H_
+#define USER_CLOUD_FRAME_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define CLOUD_FRAME_ARENA_LEN         256                   ///<存放各帧以及md5输入的arena大小
+#define CLOUD_FRAME_TOKEN_MAX         32                    ///<token的最大长度
+#define CLOUD_FRAME_DIGEST_LEN        32                    ///<md5的十六进制字符数
+
+#define CLOUD_FRAME_ERR_ARG           -0x0F71               ///<参数为空,或者ID、KEY太长放不进arena
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* arena中的一段,后面紧跟一个'\0' */
+typedef struct
+{
+  uint16_t                  off;
+  uint16_t                  len;
+} cloud_frame_slot_t;
+
+typedef struct
+{
+  cloud_frame_slot_t        checkin;                    ///<用设备API KEY签到
+  cloud_frame_slot_t        sign_in;                    ///<用md5(token+用户API KEY)签到
+  cloud_frame_slot_t        heart_beat;                 ///<心跳
+  cloud_frame_slot_t        user_key;                   ///<用户API KEY,前面留有CLOUD_FRAME_TOKEN_MAX字节放token
+  uint16_t                  digest;                     ///<sign_in中md5十六进制字符的位置
+  uint16_t                  used;                       ///<arena已用的字节数
+  char                      buf[CLOUD_FRAME_ARENA_LEN];
+} cloud_frame_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 拼装各帧,只需要调用一次;ID和KEY中不能有需要转义的字符
+ * @param[out]  f           :帧的arena
+ * @param[in]   id          :设备ID
+ * @param[in]   device_key  :设备API KEY
+ * @param[in]   user_key    :用户API KEY
+ * @retval
+ *              0:成功
+ *              CLOUD_FRAME_ERR_ARG:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_frame_init(cloud_frame_t *f, const char *id, const char *device_key, const char *user_key);
+
+/**
+ * 取用设备API KEY签到的帧
+ * @param[in]   f     :帧的arena
+ * @param[out]  len   :帧的长度,含行尾的'\n'
+ * @retval      以'\0'结尾的帧
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+const char *cloud_frame_checkin(const cloud_frame_t *f, size_t *len);
+
+/**
+ * 计算md5(token+用户API KEY)并填进加密签到帧
+ * @param[in]   f         :帧的arena
+ * @param[in]   token     :云平台下发的token,不以'\0'结尾
+ * @param[in]   token_len :token的长度
+ * @param[out]  len       :帧的长度,含行尾的'\n'
+ * @retval      以'\0'结尾的帧,token为空或者太长时为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+const char *cloud_frame_sign_in(cloud_frame_t *f, const char *token, size_t token_len, size_t *len);
+
+/**
+ * 取心跳帧
+ * @param[in]   f     :帧的arena
+ * @param[out]  len   :帧的长度,含行尾的'\n'
+ * @retval      以'\0'结尾的帧
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+const char *cloud_frame_heart_beat(const cloud_frame_t *f, size_t *len);
+
+#endif/* USER_CLOUD_FRAME_H_ */
@@ -0,0 +1,128 @@
+/**
+* @file         user_cloud_msg.h
+* @brief        云平台消息的解析以及按方法名分发的相关声明
+* @details      贝壳物联下发的都是一层的json对象,值基本都是字符串;
+*               解析时只扫描一遍,各字段都是指向原数据的视图,不申请内存也不拷贝;
+*               分发表按方法名的长度、首字符和尾字符散列到固定下标,初始化时填表并检查冲突,查表后再比较一次全名
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef USER_CLOUD_MSG_H_
+#define USER_CLOUD_MSG_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define CLOUD_MSG_ERR_FORMAT          -0x0F61               ///<不是json对象,或者对象没有结束
+#define CLOUD_MSG_ERR_UNKNOWN         -0x0F62               ///<分发表中没有这个名字
+#define CLOUD_MSG_ERR_DUPLICATE       -0x0F63               ///<两个名字散列到同一个下标,换一个表大小或者调整散列
+
+/* 方法名的散列,len为名字长度,first、last为首尾字符 */
+#define CLOUD_MSG_HASH(len, first, last)  ((uint32_t)(len) * 2 + (uint8_t)(first) + (uint8_t)(last))
+
+/* 路由列表的一项,name必须是字符串常量,长度在编译时算出,交给cloud_msg_table_init填进分发表 */
+#define CLOUD_MSG_ROUTE(name, fn)     { "" name "", sizeof(name) - 1, fn }
+
+/* 视图是否等于字符串常量 */
+#define CLOUD_VIEW_IS(v, lit)         ((v).len == sizeof(lit) - 1 && memcmp((v).p, lit, sizeof(lit) - 1) == 0)
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 原数据中的一段,不以'\0'结尾,p为NULL表示没有这个字段;字符串中的转义不展开 */
+typedef struct
+{
+  const char                *p;
+  uint16_t                  len;
+} cloud_view_t;
+
+/* 一条云平台消息中用到的字段,字符串值不含引号 */
+typedef struct
+{
+  cloud_view_t              method;                     ///<"M"
+  cloud_view_t              id;                         ///<"ID"
+  cloud_view_t              name;                       ///<"NAME"
+  cloud_view_t              content;                    ///<"C"
+  cloud_view_t              key;                        ///<"K"
+  cloud_view_t              time;                       ///<"T"
+} cloud_msg_t;
+
+/* 消息处理函数,msg中的视图只在处理函数返回前有效 */
+typedef void (*cloud_msg_handler_t)(const cloud_msg_t *msg);
+
+/* 分发表中的一项,handler为NULL表示空槽 */
+typedef struct
+{
+  const char                *name;
+  uint8_t                   len;
+  cloud_msg_handler_t       handler;
+} cloud_msg_route_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 解析一个一层的json对象,取出cloud_msg_t中的字段,其他字段跳过
+ * @param[in]   data  :数据,不需要以'\0'结尾
+ * @param[in]   len   :数据长度
+ * @param[out]  msg   :解析结果,视图指向data
+ * @retval
+ *              >0:对象(到'}'为止)占用的字节数
+ *              CLOUD_MSG_ERR_FORMAT:格式错误
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_msg_parse(const char *data, size_t len, cloud_msg_t *msg);
+
+/**
+ * 把路由列表按名字的散列填进分发表,表中原有的内容清空
+ * @param[out]  table :分发表
+ * @param[in]   slots :表的大小,2的幂
+ * @param[in]   routes:用CLOUD_MSG_ROUTE写的路由列表
+ * @param[in]   count :列表项数
+ * @retval
+ *              0:成功
+ *              CLOUD_MSG_ERR_DUPLICATE:有两个名字散列到同一个下标,或者名字为空
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_msg_table_init(cloud_msg_route_t *table, uint32_t slots, const cloud_msg_route_t *routes, size_t count);
+
+/**
+ * 按名字查分发表并调用对应的处理函数
+ * @param[in]   table :用cloud_msg_table_init填好的分发表
+ * @param[in]   slots :表的大小,2的幂
+ * @param[in]   name  :要查的名字
+ * @param[in]   msg   :传给处理函数的消息
+ * @retval
+ *              0:已处理
+ *              CLOUD_MSG_ERR_UNKNOWN:表中没有这个名字
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_msg_dispatch(const cloud_msg_route_t *table, uint32_t slots, cloud_view_t name, const cloud_msg_t *msg);
+
+#endif/* USER_CLOUD_MSG_H_ */
@@ -0,0 +1,105 @@
+/**
+* @file         user_keepalive.h
+* @brief        自适应心跳间隔的相关声明
+* @details      只在连接空闲满一个间隔时才需要心跳,任何发出去的帧都把下次心跳推后;
+*               心跳间隔不超过服务器文档给出的空闲超时的3/4,加长间隔的试探默认关闭;
+*               连接在空闲时被断开,就把断开时的空闲时长当作服务器的实际超时,间隔只会因此缩短,
+*               之后再也不会超过它的3/4;
+*               本模块不涉及时间和socket,由连接任务的定时器给出空闲时长
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef USER_KEEPALIVE_H_
+#define USER_KEEPALIVE_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define KEEPALIVE_MIN_MS              5000                  ///<心跳间隔的下限
+#ifndef KEEPALIVE_PROBE
+#define KEEPALIVE_PROBE               0                     ///<1:间隔撑过几次后加长试探,上限仍是超时的3/4;0:间隔只会缩短
+#endif
+#define KEEPALIVE_STEP_MS             5000                  ///<每次试探加长的间隔
+#define KEEPALIVE_PROBE_STREAK        4                     ///<当前间隔连续撑过几次后再试探更长的间隔
+#define KEEPALIVE_SUSPECT             2                     ///<空闲时连续断开几次,即使没超过撑过的最长空闲也重新测超时
+#define KEEPALIVE_SLACK_MS            500                   ///<离到期不到这么久时直接发心跳,不再为几个tick多醒一次
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 心跳的统计 */
+typedef struct
+{
+  uint32_t                  sent;                       ///<需要发送的心跳次数
+  uint32_t                  deferred;                   ///<到期检查时因为有其他帧发出而推后的次数
+  uint32_t                  timeouts;                   ///<测出服务器空闲超时的次数
+} keepalive_stats_t;
+
+typedef struct
+{
+  uint32_t                  interval_ms;                ///<当前的心跳间隔
+  uint32_t                  timeout_ms;                 ///<服务器文档给出的空闲超时
+  uint32_t                  learned_ms;                 ///<空闲断开时测出的服务器超时,0表示没有发生过
+  uint32_t                  survived_ms;                ///<连接撑过的最长空闲
+  uint8_t                   streak;                     ///<当前间隔连续撑过的次数
+  uint8_t                   suspect;                    ///<空闲时连续断开的次数
+  keepalive_stats_t         stats;
+} keepalive_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 初始化
+ * @param[out]  k           :心跳状态
+ * @param[in]   interval_ms :初始的心跳间隔,超过timeout_ms的3/4时取3/4
+ * @param[in]   timeout_ms  :服务器文档给出的空闲超时
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void keepalive_init(keepalive_t *k, uint32_t interval_ms, uint32_t timeout_ms);
+
+/**
+ * 心跳定时器到期时调用,判断现在是否要发心跳
+ * 返回0时调用者发出心跳,再过interval_ms检查;否则过返回的毫秒数再检查
+ * @param[in]   k       :心跳状态
+ * @param[in]   idle_ms :距离最后一帧发出的毫秒数
+ * @retval      0:现在发心跳 其他:下次检查前还要等的毫秒数
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+uint32_t keepalive_next(keepalive_t *k, uint32_t idle_ms);
+
+/**
+ * 连接断开时调用,空闲时被断开的话按断开时的空闲时长调整心跳间隔
+ * @param[in]   k       :心跳状态
+ * @param[in]   idle_ms :断开时距离最后一帧发出的毫秒数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void keepalive_closed(keepalive_t *k, uint32_t idle_ms);
+
+#endif/* USER_KEEPALIVE_H_ */
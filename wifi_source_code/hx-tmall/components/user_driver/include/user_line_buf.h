@@ -0,0 +1,87 @@
+/**
+* @file         user_line_buf.h
+* @brief        按换行符切分数据流的相关声明
+* @details      贝壳物联的每条消息以'\n'结尾,但一次TLS读出的数据可能包含多条消息,也可能只有半条;
+*               收到的数据在原地按行切分,完整的行直接交给回调,不拷贝;
+*               只有跨越两次读取的半行才拷贝进缓存,等后面的数据补齐后再交给回调
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef USER_LINE_BUF_H_
+#define USER_LINE_BUF_H_
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define LINE_BUF_LEN                  512                   ///<一行的最大长度(不含'\n'),超过的行整行丢弃
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 收到一个完整的行,line[len]处为'\0',行尾的'\n'和'\r'已去掉;line只在回调返回前有效 */
+typedef void (*line_buf_cb_t)(char *line, size_t len, void *arg);
+
+/* 行的统计 */
+typedef struct
+{
+  uint32_t                  lines;                      ///<交给回调的行数
+  uint32_t                  spliced;                    ///<其中跨越多次读取、从缓存中拼出的行数
+  uint32_t                  overflows;                  ///<超过LINE_BUF_LEN被丢弃的行数
+} line_buf_stats_t;
+
+typedef struct
+{
+  uint16_t                  len;                        ///<buf中还没有遇到'\n'的字节数
+  uint8_t                   discard;                    ///<当前行太长,丢弃到下一个'\n'为止
+  line_buf_stats_t          stats;
+  char                      buf[LINE_BUF_LEN + 1];      ///<跨越多次读取的半行
+} line_buf_t;
+
+/*
+===========================
+函数声明
+===========================
+*/
+
+/**
+ * 丢弃缓存中的半行,连接断开或重新建立时调用,避免上一个连接的残留拼到新连接的第一行前面
+ * @param[in]   lb    :行缓存
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void line_buf_reset(line_buf_t *lb);
+
+/**
+ * 送入一段收到的数据,每遇到一个'\n'就把这一行交给cb
+ * data中完整的行原地交给cb,会把行尾的'\n'改为'\0';末尾不完整的部分拷贝进缓存
+ * @param[in]   lb    :行缓存
+ * @param[in]   data  :数据,可写
+ * @param[in]   len   :数据长度
+ * @param[in]   cb    :行回调
+ * @param[in]   arg   :回调参数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void line_buf_feed(line_buf_t *lb, char *data, size_t len, line_buf_cb_t cb, void *arg);
+
+#endif/* USER_LINE_BUF_H_ */
@@ -8,6 +8,16 @@
 * @par History:          
 *               Ver0.0.1:
                     Helon_Chan, 2018/08/12, 初始化版本\n 
+*               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 增加连接所用的TLS配置档BIG_IOT_TLS_PROFILE\n 
+*               Ver0.0.3:
+                    Helon_Chan, 2026/10/17, 增加心跳周期HEART_BEAT_INTERVAL_MS,连接改为启动后立即返回\n 
+*               Ver0.0.4:
+                    Helon_Chan, 2026/10/17, 方法和命令改为分发表,去掉对应的枚举,增加分发表大小\n 
+*               Ver0.0.5:
+                    Helon_Chan, 2026/10/17, 心跳帧移到user_cloud_frame中预先拼装,去掉HEART_BEAT\n 
+*               Ver0.0.6:
+                    Helon_Chan, 2026/10/17, HEART_BEAT_INTERVAL_MS改为心跳的初始间隔,增加云平台文档给出的空闲超时BIG_IOT_IDLE_TIMEOUT_MS\n 
 */
 #ifndef USER_TMALL_GENIE_H_
 #define USER_TMALL_GENIE_H_
@@ -21,6 +31,8 @@
 #define BIG_IOT_URL                 "www.bigiot.net"
 #define BIG_IOT_PORT                "8585"
 #define TAG                         "big_iot_cloud_connect"
+/* 连接所用的TLS配置档,见user_tls_profile.h */
+#define BIG_IOT_TLS_PROFILE         TLS_PROFILE_LOW_MEM
 
 /* 设备ID,当使用时请更改为您自己的设备ID */
 #define DEVICE_ID                   "7130"
@@ -28,25 +40,14 @@
 #define DEVICE_API_KEY              "eb195935a"
 /* 用户API KEY,当使用时请更改为您自己的用户API KEY*/
 #define USER_API_KEY                "6dc19ba6a5"
-/* 心跳包 */
-#define HEART_BEAT                  "{\"M\":\"heart beat\"}\n"
+/* 云平台文档给出的空闲超时,超过一分钟收不到数据会断开连接 */
+#define BIG_IOT_IDLE_TIMEOUT_MS     (60 * 1000)
+/* 心跳的初始间隔,不超过BIG_IOT_IDLE_TIMEOUT_MS的3/4;空闲时被断开过就按实际的超时缩短 */
+#define HEART_BEAT_INTERVAL_MS      (45 * 1000)
+/* 方法分发表和命令分发表的大小,2的幂,见user_cloud_msg.h中的cloud_msg_table_init */
+#define BIG_IOT_METHOD_SLOTS        8
+#define BIG_IOT_CMD_SLOTS           4
   
-/*
-===========================
-枚举变量定义
-=========================== 
-*/
-enum
-{
-  INVALID_METHOD,                     ///< 无效的方法
-  TCP_CONNECT_SUCCESS,                ///< tcp连接成功
-  GET_TOKEN,                          ///< 获取token成功
-  SIGN_IN_OK,                         ///< 设备登陆成功
-  RECEVICE,                           ///< 接收云平台的命令
-  ON,                                 ///< 打开
-  OFF,                                ///< 关闭            
-};
-
 /*
 ===========================
 函数声明
@@ -60,6 +61,8 @@ enum
 * @note        修改日志 
 *               Ver0.0.1: 
                   Helon_Chan, 2018/08/12, 初始化版本\n 
+*               Ver0.0.3: 
+                  Helon_Chan, 2026/10/17, 只启动连接任务并立即返回,断线后由连接任务自动重连,重复调用无影响\n 
 */
 void big_iot_cloud_connect(const char *url, const char *port);
 
@@ -8,6 +8,10 @@
 * @par History:          
 *               Ver0.0.1:
                      Helon_Chan, 2018/06/19, 初始化版本\n 
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 上电时挂上mbedtls的堆统计\n 
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 获取IP后直接启动云平台连接任务,去掉tcp_connect_task\n 
 */
 
 /*
@@ -81,20 +85,6 @@ static void user_app_rgb_init(void)
   // ESP_LOGI("user_app_rgb_init", "r_fade_start is %d\n", r_fade_start());
 }
 
-/** 
- * tcp连接任务处理函数
- * @param[in]   pvParameters: 表示任务所携带的参数 
- * @retval      null 
- *              其他:          失败 
- * @par         修改日志 
- *               Ver0.0.1:
-                    Helon_Chan, 2018/08/12, 初始化版本\n 
- */
-static void tcp_connect_task(void *pvParameters)
-{  
-  big_iot_cloud_connect(BIG_IOT_URL,BIG_IOT_PORT);  
-  vTaskDelete(NULL);
-}
 /** 
  * wifi事件处理函数
  * @param[in]   ctx     :表示传入的事件类型对应所携带的参数
@@ -105,6 +95,8 @@ static void tcp_connect_task(void *pvParameters)
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/06/04, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 获取IP后直接启动云平台连接任务\n 
  */
 static esp_err_t event_handler(void *ctx, system_event_t *event)
 {
@@ -112,16 +104,8 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
   {
   case SYSTEM_EVENT_STA_GOT_IP:
     ESP_LOGI("event_handler","\nSYSTEM_EVENT_STA_GOT_IP\n");
-    int err_code = xTaskCreate(tcp_connect_task,
-                               "tcp_connect_task",
-                               1024 * 8,
-                               NULL,
-                               3,
-                               NULL);
-    if(err_code != pdPASS)                            
-    {
-      ESP_LOGI("event_handler", "tcp_connect_task create failure,reason is %d\n", err_code);
-    }
+    /* 只启动连接任务,重新获取IP时连接任务已经在重连,再调用无影响 */
+    big_iot_cloud_connect(BIG_IOT_URL,BIG_IOT_PORT);
     break;
   case SYSTEM_EVENT_STA_CONNECTED:
     ESP_LOGI("event_handler","\nSYSTEM_EVENT_STA_CONNECTED\n");
@@ -180,6 +164,10 @@ static void user_wifi_init(void)
  * @par         修改日志 
  *               Ver0.0.1:
                      Helon_Chan, 2018/06/26, 初始化版本\n 
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 在wifi和tls连接之前挂上mbedtls的堆统计\n 
+ *               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 堆统计改在app_main中挂上\n 
  */
 void startup_initialization_task(void *pvParameters)
 {
@@ -0,0 +1,809 @@
+/**
+* @file         user_cloud_conn.c
+* @brief        云平台长连接引擎的相关函数定义
+* @details      连接任务按状态循环:等待重连 -> 非阻塞TCP连接 -> 非阻塞握手 -> 在线收发,只有DNS解析是阻塞的;
+*               在线时每轮先把发送队列写进TLS,再用select等socket可读或可写、唤醒socket可读,
+*               最长等到最近的定时器到期,醒来后读数据、执行到期的定时器;
+*               唤醒socket走lwip的回环网卡,需要在menuconfig中打开CONFIG_LWIP_NETIF_LOOPBACK,
+*               建立失败时退回为最多等CLOUD_CONN_POLL_MS就醒来检查发送队列
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 记录最后一帧发出的时间,供心跳判断连接空闲了多久;定时器回调发的帧立即写出\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "lwip/netdb.h"
+#include "user_cloud_conn.h"
+#include "esp_system.h"
+#include "esp_log.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define CLOUD_CONN_TAG                "cloud_conn"          ///<日志标签
+#define CLOUD_CONN_WAIT_FOREVER       0xFFFFFFFF            ///<select一直等到socket就绪
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 距离截止tick还剩的毫秒数,已到返回0
+ * @param[in]   t     :截止tick
+ * @retval      毫秒数
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint32_t cloud_conn_remain_ms(TickType_t t)
+{
+  int32_t diff = (int32_t)(t - xTaskGetTickCount());
+  return diff > 0 ? (uint32_t)diff * portTICK_PERIOD_MS : 0;
+}
+
+/**
+ * 进入等待重连:在[0, backoff_ms]内取随机等待时间,然后把上限翻倍,避免大量设备同时重连
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_backoff(cloud_conn_t *conn)
+{
+  uint32_t delay_ms = esp_random() % (conn->backoff_ms + 1);
+  conn->deadline = xTaskGetTickCount() + delay_ms / portTICK_PERIOD_MS;
+  conn->backoff_ms = conn->backoff_ms * 2 > CLOUD_CONN_BACKOFF_MAX_MS ? CLOUD_CONN_BACKOFF_MAX_MS : conn->backoff_ms * 2;
+  conn->state = CLOUD_CONN_BACKOFF;
+  ESP_LOGI(CLOUD_CONN_TAG, "reconnect after %u ms\n", delay_ms);
+}
+
+/**
+ * 建立唤醒socket:wake_fd绑定在127.0.0.1的随机端口上,由连接任务在select中等待;
+ * 其他任务通过wake_tx_fd往这个端口发一个字节,select就会立即返回
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_wake_init(cloud_conn_t *conn)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  conn->wake_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  conn->wake_tx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (conn->wake_fd < 0 || conn->wake_tx_fd < 0 ||
+      bind(conn->wake_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      getsockname(conn->wake_fd, (struct sockaddr *)&addr, &len) != 0)
+  {
+    ESP_LOGI(CLOUD_CONN_TAG, "wake socket not available, poll every %u ms\n", CLOUD_CONN_POLL_MS);
+    if (conn->wake_fd >= 0)
+    {
+      close(conn->wake_fd);
+    }
+    if (conn->wake_tx_fd >= 0)
+    {
+      close(conn->wake_tx_fd);
+    }
+    conn->wake_fd = -1;
+    conn->wake_tx_fd = -1;
+    return;
+  }
+  conn->wake_port = addr.sin_port;
+}
+
+/**
+ * 叫醒连接任务的select,在连接任务自己里调用时不需要叫醒
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_wake(cloud_conn_t *conn)
+{
+  struct sockaddr_in addr;
+  if (conn->wake_tx_fd < 0 || xTaskGetCurrentTaskHandle() == conn->task)
+  {
+    return;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = conn->wake_port;
+  xSemaphoreTake(conn->wake_lock, portMAX_DELAY);
+  sendto(conn->wake_tx_fd, "", 1, 0, (struct sockaddr *)&addr, sizeof(addr));
+  xSemaphoreGive(conn->wake_lock);
+}
+
+/**
+ * 关闭socket并复位TLS会话,丢弃还没发出的帧,停止所有定时器,然后进入等待重连
+ * @param[in]   conn    :连接
+ * @param[in]   reason  :断开原因,0表示服务器关闭,其他为mbedtls或者CLOUD_CONN_ERR_xxx错误码
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_close(cloud_conn_t *conn, int reason)
+{
+  uint8_t online = conn->state == CLOUD_CONN_ONLINE;
+  /* 先改状态,其他任务不再往队列里放 */
+  conn->state = CLOUD_CONN_BACKOFF;
+  if (online && reason != 0)
+  {
+    /* 非阻塞socket上只尽力发一次 */
+    mbedtls_ssl_close_notify(&conn->ssl);
+  }
+  mbedtls_net_free(&conn->net);
+  mbedtls_ssl_session_reset(&conn->ssl);
+  conn->stats.tx_dropped += uxQueueMessagesWaiting(conn->tx_queue) + conn->tx_busy;
+  xQueueReset(conn->tx_queue);
+  conn->tx_busy = 0;
+  conn->tx_want_write = 0;
+  memset(conn->timer, 0, sizeof(conn->timer));
+  if (online)
+  {
+    conn->stats.drops++;
+    ESP_LOGI(CLOUD_CONN_TAG, "closed -0x%x, tls steady heap peak %u\n", -reason, conn->heap.steady_peak);
+    if (conn->cb->on_closed != NULL)
+    {
+      conn->cb->on_closed(conn, reason);
+    }
+  }
+  else
+  {
+    conn->stats.failures++;
+    ESP_LOGI(CLOUD_CONN_TAG, "connect failed -0x%x\n", -reason);
+  }
+  cloud_conn_backoff(conn);
+}
+
+/**
+ * 初始化随机数和TLS配置,整个连接任务只做一次,重连时复用
+ * @param[in]   conn  :连接
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int cloud_conn_tls_init(cloud_conn_t *conn)
+{
+  int ret;
+  mbedtls_net_init(&conn->net);
+  mbedtls_ssl_init(&conn->ssl);
+  mbedtls_ssl_config_init(&conn->conf);
+  mbedtls_ctr_drbg_init(&conn->ctr_drbg);
+  mbedtls_entropy_init(&conn->entropy);
+  if ((ret = mbedtls_ctr_drbg_seed(&conn->ctr_drbg, mbedtls_entropy_func, &conn->entropy, NULL, 0)) != 0)
+  {
+    return ret;
+  }
+  if ((ret = mbedtls_ssl_config_defaults(&conn->conf,
+                                         MBEDTLS_SSL_IS_CLIENT,
+                                         MBEDTLS_SSL_TRANSPORT_STREAM,
+                                         MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+  {
+    return ret;
+  }
+  /* 由于证书会过期,所以这些不进行证书认证 */
+  mbedtls_ssl_conf_authmode(&conn->conf, MBEDTLS_SSL_VERIFY_NONE);
+  mbedtls_ssl_conf_rng(&conn->conf, mbedtls_ctr_drbg_random, &conn->ctr_drbg);
+  if ((ret = tls_profile_apply(&conn->conf, conn->profile)) != 0)
+  {
+    return ret;
+  }
+  if ((ret = mbedtls_ssl_setup(&conn->ssl, &conn->conf)) != 0)
+  {
+    return ret;
+  }
+  return mbedtls_ssl_set_hostname(&conn->ssl, conn->host);
+}
+
+/**
+ * 解析服务器地址并发起非阻塞TCP连接,连接结果在主循环里等socket可写时检查
+ * lwip的getaddrinfo会阻塞到DNS应答或者超时,这段时间连接任务不做别的事;
+ * 此时还没有连上,发送队列和定时器都是空的,只是推迟了这次重连
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_open(cloud_conn_t *conn)
+{
+  int ret = MBEDTLS_ERR_NET_CONNECT_FAILED;
+  struct addrinfo hints, *list, *cur;
+  /* 握手峰值从复用的收发缓存算起 */
+  tls_heap_begin(&conn->heap);
+  ESP_LOGI(CLOUD_CONN_TAG, "connecting to tcp/%s/%s\n", conn->host, conn->port);
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  if (getaddrinfo(conn->host, conn->port, &hints, &list) != 0 || list == NULL)
+  {
+    cloud_conn_close(conn, MBEDTLS_ERR_NET_UNKNOWN_HOST);
+    return;
+  }
+  /* 用第一个能发起连接的地址,这个地址连不上时等下次重连再从头试 */
+  for (cur = list; cur != NULL; cur = cur->ai_next)
+  {
+    conn->net.fd = socket(cur->ai_family, cur->ai_socktype, cur->ai_protocol);
+    if (conn->net.fd < 0)
+    {
+      ret = MBEDTLS_ERR_NET_SOCKET_FAILED;
+      continue;
+    }
+    if (mbedtls_net_set_nonblock(&conn->net) == 0 &&
+        (connect(conn->net.fd, cur->ai_addr, cur->ai_addrlen) == 0 || errno == EINPROGRESS))
+    {
+      ret = 0;
+      break;
+    }
+    ret = MBEDTLS_ERR_NET_CONNECT_FAILED;
+    mbedtls_net_free(&conn->net);
+  }
+  freeaddrinfo(list);
+  if (ret != 0)
+  {
+    cloud_conn_close(conn, ret);
+    return;
+  }
+  conn->deadline = xTaskGetTickCount() + CLOUD_CONN_CONNECT_MS / portTICK_PERIOD_MS;
+  conn->state = CLOUD_CONN_CONNECTING;
+}
+
+/**
+ * 等待socket可读或者可写,唤醒socket可读时也返回,并读空唤醒字节
+ * @param[in]   conn        :连接
+ * @param[in]   want_read   :是否等可读
+ * @param[in]   want_write  :是否等可写
+ * @param[in]   ms          :最长等待时间,CLOUD_CONN_WAIT_FOREVER表示不超时
+ * @retval
+ *              >0:socket就绪或者被唤醒
+ *              0:超时
+ *              <0:select出错
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int cloud_conn_wait(cloud_conn_t *conn, uint8_t want_read, uint8_t want_write, uint32_t ms)
+{
+  int ret;
+  char drain[8];
+  fd_set read_set, write_set;
+  struct timeval tv;
+  int max_fd = conn->net.fd > conn->wake_fd ? conn->net.fd : conn->wake_fd;
+  FD_ZERO(&read_set);
+  FD_ZERO(&write_set);
+  if (want_read)
+  {
+    FD_SET(conn->net.fd, &read_set);
+  }
+  if (want_write)
+  {
+    FD_SET(conn->net.fd, &write_set);
+  }
+  if (conn->wake_fd >= 0)
+  {
+    FD_SET(conn->wake_fd, &read_set);
+  }
+  tv.tv_sec = ms / 1000;
+  tv.tv_usec = (ms % 1000) * 1000;
+  ret = select(max_fd + 1, &read_set, &write_set, NULL, ms == CLOUD_CONN_WAIT_FOREVER ? NULL : &tv);
+  if (ret > 0)
+  {
+    conn->stats.wakeups++;
+    if (conn->wake_fd >= 0 && FD_ISSET(conn->wake_fd, &read_set))
+    {
+      while (recv(conn->wake_fd, drain, sizeof(drain), MSG_DONTWAIT) > 0)
+      {
+      }
+    }
+  }
+  return ret;
+}
+
+/**
+ * 等非阻塞TCP连接完成,连上后开始非阻塞握手
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_connecting(cloud_conn_t *conn)
+{
+  int err = 0;
+  socklen_t len = sizeof(err);
+  struct sockaddr_storage peer;
+  socklen_t peer_len = sizeof(peer);
+  if (cloud_conn_remain_ms(conn->deadline) == 0)
+  {
+    cloud_conn_close(conn, CLOUD_CONN_ERR_TIMEOUT);
+    return;
+  }
+  cloud_conn_wait(conn, 0, 1, cloud_conn_remain_ms(conn->deadline));
+  if (getsockopt(conn->net.fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0)
+  {
+    cloud_conn_close(conn, MBEDTLS_ERR_NET_CONNECT_FAILED);
+    return;
+  }
+  /* 超时或者被唤醒socket叫醒时连接可能还没完成,下一轮接着等 */
+  if (getpeername(conn->net.fd, (struct sockaddr *)&peer, &peer_len) != 0)
+  {
+    return;
+  }
+  mbedtls_ssl_set_bio(&conn->ssl, &conn->net, mbedtls_net_send, mbedtls_net_recv, NULL);
+  conn->deadline = xTaskGetTickCount() + CLOUD_CONN_HANDSHAKE_MS / portTICK_PERIOD_MS;
+  conn->state = CLOUD_CONN_HANDSHAKE;
+}
+
+/**
+ * 推进一步握手
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 握手完成时开始计算空闲\n
+ */
+static void cloud_conn_handshake(cloud_conn_t *conn)
+{
+  int ret = mbedtls_ssl_handshake(&conn->ssl);
+  if (ret == 0)
+  {
+    tls_heap_steady(&conn->heap);
+    conn->backoff_ms = CLOUD_CONN_BACKOFF_BASE_MS;
+    conn->stats.connects++;
+    conn->tx_last = xTaskGetTickCount();
+    /* 上次断开时其他任务可能还在往队列里放,不能发到新连接上 */
+    xQueueReset(conn->tx_queue);
+    conn->state = CLOUD_CONN_ONLINE;
+    ESP_LOGI(CLOUD_CONN_TAG, "online, tls heap peak %u, now %u\n", conn->heap.handshake_peak, conn->heap.current);
+    if (conn->cb->on_online != NULL)
+    {
+      conn->cb->on_online(conn);
+    }
+    return;
+  }
+  if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+  {
+    cloud_conn_close(conn, ret);
+    return;
+  }
+  if (cloud_conn_remain_ms(conn->deadline) == 0)
+  {
+    cloud_conn_close(conn, CLOUD_CONN_ERR_TIMEOUT);
+    return;
+  }
+  cloud_conn_wait(conn, ret == MBEDTLS_ERR_SSL_WANT_READ, ret == MBEDTLS_ERR_SSL_WANT_WRITE,
+                  cloud_conn_remain_ms(conn->deadline));
+}
+
+/**
+ * 把发送队列里的帧依次写进TLS,直到队列为空或者socket写不下
+ * @param[in]   conn  :连接
+ * @retval
+ *              0:成功
+ *              其他:mbedtls的错误码,连接需要关闭
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 每写完一帧记下时间\n
+ */
+static int cloud_conn_flush(cloud_conn_t *conn)
+{
+  int ret;
+  conn->tx_want_write = 0;
+  while (1)
+  {
+    if (!conn->tx_busy)
+    {
+      if (xQueueReceive(conn->tx_queue, &conn->tx, 0) != pdTRUE)
+      {
+        return 0;
+      }
+      conn->tx_off = 0;
+      conn->tx_busy = 1;
+    }
+    /* 返回WANT_xxx时下次必须用同样的参数重新调用 */
+    ret = mbedtls_ssl_write(&conn->ssl, conn->tx.data + conn->tx_off, conn->tx.len - conn->tx_off);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      conn->tx_want_write = ret == MBEDTLS_ERR_SSL_WANT_WRITE;
+      return 0;
+    }
+    if (ret < 0)
+    {
+      return ret;
+    }
+    conn->tx_off += ret;
+    if (conn->tx_off == conn->tx.len)
+    {
+      conn->tx_busy = 0;
+      conn->tx_last = xTaskGetTickCount();
+      conn->stats.tx_frames++;
+    }
+  }
+}
+
+/**
+ * 读出TLS中已经到达的数据并交给on_data
+ * @param[in]   conn  :连接
+ * @retval
+ *              0:成功
+ *              1:服务器关闭了连接
+ *              <0:mbedtls的错误码,连接需要关闭
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int cloud_conn_read(cloud_conn_t *conn)
+{
+  int ret;
+  uint8_t i;
+  for (i = 0; i < CLOUD_CONN_RX_BURST; i++)
+  {
+    ret = mbedtls_ssl_read(&conn->ssl, (unsigned char *)conn->rx, CLOUD_CONN_RX_LEN);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      return 0;
+    }
+    if (ret == 0 || ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY)
+    {
+      return 1;
+    }
+    if (ret < 0)
+    {
+      return ret;
+    }
+    conn->stats.rx_bytes += ret;
+    conn->rx[ret] = '\0';
+    conn->cb->on_data(conn, conn->rx, ret);
+    /* 回调里可能已经关闭了连接 */
+    if (conn->state != CLOUD_CONN_ONLINE)
+    {
+      return 0;
+    }
+  }
+  return 0;
+}
+
+/**
+ * 执行到期的定时器,返回距离最近一个定时器到期的毫秒数
+ * @param[in]   conn  :连接
+ * @param[in]   max   :没有定时器时返回的值,可以为CLOUD_CONN_WAIT_FOREVER
+ * @retval      毫秒数,不超过max
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint32_t cloud_conn_timers(cloud_conn_t *conn, uint32_t max)
+{
+  uint8_t i;
+  uint32_t ms;
+  cloud_conn_timer_t *t;
+  cloud_conn_timer_cb_t cb;
+  for (i = 0; i < CLOUD_CONN_TIMERS; i++)
+  {
+    t = &conn->timer[i];
+    if (t->cb == NULL || cloud_conn_remain_ms(t->deadline) != 0)
+    {
+      continue;
+    }
+    cb = t->cb;
+    if (t->period)
+    {
+      t->deadline += t->period;
+      /* 落后一个周期以上时不补发 */
+      if (cloud_conn_remain_ms(t->deadline) == 0)
+      {
+        t->deadline = xTaskGetTickCount() + t->period;
+      }
+    }
+    else
+    {
+      t->cb = NULL;
+    }
+    cb(conn, t->arg);
+    if (conn->state != CLOUD_CONN_ONLINE)
+    {
+      return 0;
+    }
+  }
+  for (i = 0; i < CLOUD_CONN_TIMERS; i++)
+  {
+    if (conn->timer[i].cb != NULL)
+    {
+      ms = cloud_conn_remain_ms(conn->timer[i].deadline);
+      max = ms < max ? ms : max;
+    }
+  }
+  return max;
+}
+
+/**
+ * 在线时的一轮:发送、等待、接收、定时器
+ * @param[in]   conn  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 定时器回调放进队列的帧立即发出,不再等到下次醒来\n
+ */
+static void cloud_conn_poll(cloud_conn_t *conn)
+{
+  int ret;
+  uint32_t wait_ms;
+  if ((ret = cloud_conn_flush(conn)) != 0)
+  {
+    cloud_conn_close(conn, ret);
+    return;
+  }
+  /* 没有唤醒socket时,要定时醒来看其他任务有没有往队列里放 */
+  wait_ms = cloud_conn_timers(conn, conn->wake_fd >= 0 ? CLOUD_CONN_WAIT_FOREVER : CLOUD_CONN_POLL_MS);
+  if (conn->state != CLOUD_CONN_ONLINE)
+  {
+    return;
+  }
+  /* 解密后还有没读完的数据,或者定时器回调刚往队列里放了帧时,不等socket */
+  if (mbedtls_ssl_get_bytes_avail(&conn->ssl) != 0 || uxQueueMessagesWaiting(conn->tx_queue) != 0)
+  {
+    wait_ms = 0;
+  }
+  /* 可写时下一轮的flush会继续发送;可读、出错或者对方关闭都由ssl_read报告 */
+  if (cloud_conn_wait(conn, 1, conn->tx_want_write, wait_ms) != 0 || wait_ms == 0)
+  {
+    ret = cloud_conn_read(conn);
+    if (ret != 0)
+    {
+      cloud_conn_close(conn, ret == 1 ? 0 : ret);
+    }
+  }
+}
+
+/**
+ * 连接任务,整个连接只有这一个任务
+ * @param[in]   pvParameters  :连接
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_conn_task(void *pvParameters)
+{
+  int ret;
+  cloud_conn_t *conn = (cloud_conn_t *)pvParameters;
+  /* TLS上下文由本任务申请,全部记到这个连接上 */
+  tls_heap_begin(&conn->heap);
+  if ((ret = cloud_conn_tls_init(conn)) != 0)
+  {
+    ESP_LOGI(CLOUD_CONN_TAG, "tls init failed -0x%x\n", -ret);
+    tls_heap_end();
+    conn->state = CLOUD_CONN_IDLE;
+    vTaskDelete(NULL);
+    return;
+  }
+  cloud_conn_wake_init(conn);
+  /* 第一次立即连接 */
+  conn->deadline = xTaskGetTickCount();
+  conn->state = CLOUD_CONN_BACKOFF;
+  while (1)
+  {
+    switch (conn->state)
+    {
+    case CLOUD_CONN_BACKOFF:
+      if (cloud_conn_remain_ms(conn->deadline) != 0)
+      {
+        vTaskDelay(cloud_conn_remain_ms(conn->deadline) / portTICK_PERIOD_MS);
+        break;
+      }
+      cloud_conn_open(conn);
+      break;
+    case CLOUD_CONN_CONNECTING:
+      cloud_conn_connecting(conn);
+      break;
+    case CLOUD_CONN_HANDSHAKE:
+      cloud_conn_handshake(conn);
+      break;
+    case CLOUD_CONN_ONLINE:
+      cloud_conn_poll(conn);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/**
+ * 启动连接任务,之后的连接、握手、断线重连都在连接任务中进行,本函数立即返回
+ * 已经启动过时直接返回0
+ * @param[in]   conn    :连接,必须一直有效,一般为全局变量
+ * @param[in]   host    :服务器地址,必须一直有效
+ * @param[in]   port    :服务器端口,必须一直有效
+ * @param[in]   profile :TLS_PROFILE_xxx
+ * @param[in]   cb      :事件回调,必须一直有效
+ * @param[in]   arg     :留给使用者的参数,存放在conn->arg
+ * @retval
+ *              0:成功
+ *              CLOUD_CONN_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_conn_start(cloud_conn_t *conn, const char *host, const char *port, uint8_t profile,
+                     const cloud_conn_cb_t *cb, void *arg)
+{
+  if (conn == NULL || host == NULL || port == NULL || cb == NULL || cb->on_data == NULL)
+  {
+    return CLOUD_CONN_ERR_ARG;
+  }
+  if (conn->task != NULL)
+  {
+    return 0;
+  }
+  memset(conn, 0, sizeof(*conn));
+  conn->host = host;
+  conn->port = port;
+  conn->profile = profile;
+  conn->cb = cb;
+  conn->arg = arg;
+  conn->backoff_ms = CLOUD_CONN_BACKOFF_BASE_MS;
+  conn->wake_fd = -1;
+  conn->wake_tx_fd = -1;
+  conn->wake_lock = xSemaphoreCreateMutex();
+  conn->tx_queue = xQueueCreate(CLOUD_CONN_TX_DEPTH, sizeof(cloud_conn_frame_t));
+  if (conn->wake_lock == NULL || conn->tx_queue == NULL)
+  {
+    if (conn->wake_lock != NULL)
+    {
+      vSemaphoreDelete(conn->wake_lock);
+    }
+    if (conn->tx_queue != NULL)
+    {
+      vQueueDelete(conn->tx_queue);
+    }
+    conn->wake_lock = NULL;
+    conn->tx_queue = NULL;
+    return CLOUD_CONN_ERR_TASK;
+  }
+  conn->state = CLOUD_CONN_BACKOFF;
+  if (xTaskCreate(cloud_conn_task, "cloud_conn_task", CLOUD_CONN_TASK_STACK, conn,
+                  CLOUD_CONN_TASK_PRIO, &conn->task) != pdPASS)
+  {
+    vQueueDelete(conn->tx_queue);
+    vSemaphoreDelete(conn->wake_lock);
+    conn->tx_queue = NULL;
+    conn->wake_lock = NULL;
+    conn->task = NULL;
+    conn->state = CLOUD_CONN_IDLE;
+    return CLOUD_CONN_ERR_TASK;
+  }
+  return 0;
+}
+
+/**
+ * 发送一帧数据,拷贝进发送队列后立即返回,由连接任务写入TLS,可以在任何任务中调用
+ * 在其他任务中调用时会叫醒连接任务;在连接任务的回调中调用时,回调返回后马上发出
+ * @param[in]   conn    :连接
+ * @param[in]   data    :数据
+ * @param[in]   len     :长度,不超过CLOUD_CONN_FRAME_LEN
+ * @retval
+ *              0:成功
+ *              CLOUD_CONN_ERR_xxx:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_conn_send(cloud_conn_t *conn, const void *data, size_t len)
+{
+  cloud_conn_frame_t frame;
+  if (conn == NULL || data == NULL || len == 0 || len > CLOUD_CONN_FRAME_LEN)
+  {
+    return CLOUD_CONN_ERR_ARG;
+  }
+  if (conn->state != CLOUD_CONN_ONLINE)
+  {
+    return CLOUD_CONN_ERR_OFFLINE;
+  }
+  frame.len = len;
+  memcpy(frame.data, data, len);
+  if (xQueueSend(conn->tx_queue, &frame, 0) != pdTRUE)
+  {
+    return CLOUD_CONN_ERR_FULL;
+  }
+  cloud_conn_wake(conn);
+  return 0;
+}
+
+/**
+ * 启动一个定时器,只能在连接任务的回调中调用;连接断开时所有定时器自动停止
+ * @param[in]   conn      :连接
+ * @param[in]   ms        :多少毫秒后到期
+ * @param[in]   periodic  :1:到期后按ms重新开始 0:只执行一次
+ * @param[in]   cb        :到期回调
+ * @param[in]   arg       :回调参数
+ * @retval
+ *              >=0:定时器编号
+ *              CLOUD_CONN_ERR_FULL:定时器已用完
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_conn_timer_start(cloud_conn_t *conn, uint32_t ms, uint8_t periodic,
+                           cloud_conn_timer_cb_t cb, void *arg)
+{
+  int i;
+  for (i = 0; i < CLOUD_CONN_TIMERS; i++)
+  {
+    if (conn->timer[i].cb == NULL)
+    {
+      conn->timer[i].cb = cb;
+      conn->timer[i].arg = arg;
+      conn->timer[i].period = periodic ? ms / portTICK_PERIOD_MS : 0;
+      conn->timer[i].deadline = xTaskGetTickCount() + ms / portTICK_PERIOD_MS;
+      return i;
+    }
+  }
+  return CLOUD_CONN_ERR_FULL;
+}
+
+/**
+ * 停止一个定时器,只能在连接任务的回调中调用
+ * @param[in]   conn    :连接
+ * @param[in]   id      :cloud_conn_timer_start返回的编号,负数时不做任何事
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void cloud_conn_timer_stop(cloud_conn_t *conn, int id)
+{
+  if (id >= 0 && id < CLOUD_CONN_TIMERS)
+  {
+    conn->timer[id].cb = NULL;
+  }
+}
+
+/**
+ * 连接空闲了多久:距离最后一帧写完(还没发过帧时为握手完成)的毫秒数,只能在连接任务的回调中调用
+ * 连接断开后在on_closed中调用,得到的是断开时已经空闲的时长
+ * @param[in]   conn    :连接
+ * @retval      毫秒数
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+uint32_t cloud_conn_idle_ms(const cloud_conn_t *conn)
+{
+  return (uint32_t)(xTaskGetTickCount() - conn->tx_last) * portTICK_PERIOD_MS;
+}
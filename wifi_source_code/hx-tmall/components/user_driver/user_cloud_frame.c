@@ -0,0 +1,245 @@
+/**
+* @file         user_cloud_frame.c
+* @brief        云平台签到、加密签到以及心跳帧的预先拼装
+* @details      arena从前往后依次放:签到帧、加密签到帧、心跳帧、token的暂存区、用户API KEY
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include "mbedtls/md5.h"
+#include "user_cloud_frame.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define CLOUD_FRAME_CHECKIN_HEAD      "{\"M\":\"checkin\",\"ID\":\""    ///<签到帧ID之前的部分
+#define CLOUD_FRAME_CHECKIN_KEY       "\",\"K\":\""                     ///<签到帧ID和KEY之间的部分
+#define CLOUD_FRAME_TAIL              "\"}\n"                           ///<签到帧KEY之后的部分,云平台按'\n'分帧
+#define CLOUD_FRAME_HEART_BEAT        "{\"M\":\"heart beat\"}\n"       ///<心跳帧
+
+/*
+===========================
+全局变量定义
+===========================
+*/
+/* 半字节对应的十六进制字符 */
+static const char cloud_frame_hex_digits[16] =
+{
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+};
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 字节转为小写十六进制,每个字节查两次表,结果不以'\0'结尾
+ * @param[out]  out   :结果,长度为2*len
+ * @param[in]   in    :数据
+ * @param[in]   len   :数据长度
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void cloud_frame_hex(char *out, const uint8_t *in, size_t len)
+{
+  size_t i;
+  for (i = 0; i < len; i++)
+  {
+    out[2 * i] = cloud_frame_hex_digits[in[i] >> 4];
+    out[2 * i + 1] = cloud_frame_hex_digits[in[i] & 0x0F];
+  }
+}
+
+/**
+ * 往arena的末尾追加n个字节
+ * @param[in]   f     :帧的arena
+ * @param[in]   s     :数据,为NULL时只占位
+ * @param[in]   n     :长度
+ * @retval      0:成功 -1:arena已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int cloud_frame_put(cloud_frame_t *f, const char *s, size_t n)
+{
+  if (n > (size_t)(CLOUD_FRAME_ARENA_LEN - f->used))
+  {
+    return -1;
+  }
+  if (s != NULL)
+  {
+    memcpy(f->buf + f->used, s, n);
+  }
+  f->used += n;
+  return 0;
+}
+
+/**
+ * 结束一段,记下长度并在后面补'\0'
+ * @param[in]   f     :帧的arena
+ * @param[out]  slot  :这一段,off在开始时已经记下
+ * @retval      0:成功 -1:arena已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int cloud_frame_end(cloud_frame_t *f, cloud_frame_slot_t *slot)
+{
+  slot->len = f->used - slot->off;
+  return cloud_frame_put(f, "", 1);
+}
+
+/**
+ * 拼装签到帧:{"M":"checkin","ID":"<id>","K":"<key>"}\n,key为NULL时K的值先用'0'占位
+ * @param[in]   f     :帧的arena
+ * @param[out]  slot  :拼好的帧
+ * @param[in]   id    :设备ID
+ * @param[in]   key   :KEY
+ * @param[in]   n     :KEY的长度
+ * @retval      0:成功 -1:arena已满
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static int cloud_frame_checkin_put(cloud_frame_t *f, cloud_frame_slot_t *slot, const char *id, const char *key, size_t n)
+{
+  slot->off = f->used;
+  if (cloud_frame_put(f, CLOUD_FRAME_CHECKIN_HEAD, sizeof(CLOUD_FRAME_CHECKIN_HEAD) - 1) != 0
+      || cloud_frame_put(f, id, strlen(id)) != 0
+      || cloud_frame_put(f, CLOUD_FRAME_CHECKIN_KEY, sizeof(CLOUD_FRAME_CHECKIN_KEY) - 1) != 0)
+  {
+    return -1;
+  }
+  if (key == NULL)
+  {
+    f->digest = f->used;
+    if (cloud_frame_put(f, NULL, n) != 0)
+    {
+      return -1;
+    }
+    memset(f->buf + f->digest, '0', n);
+  }
+  else if (cloud_frame_put(f, key, n) != 0)
+  {
+    return -1;
+  }
+  if (cloud_frame_put(f, CLOUD_FRAME_TAIL, sizeof(CLOUD_FRAME_TAIL) - 1) != 0)
+  {
+    return -1;
+  }
+  return cloud_frame_end(f, slot);
+}
+
+/**
+ * 拼装各帧,只需要调用一次;ID和KEY中不能有需要转义的字符
+ * @param[out]  f           :帧的arena
+ * @param[in]   id          :设备ID
+ * @param[in]   device_key  :设备API KEY
+ * @param[in]   user_key    :用户API KEY
+ * @retval
+ *              0:成功
+ *              CLOUD_FRAME_ERR_ARG:失败
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_frame_init(cloud_frame_t *f, const char *id, const char *device_key, const char *user_key)
+{
+  if (f == NULL || id == NULL || device_key == NULL || user_key == NULL)
+  {
+    return CLOUD_FRAME_ERR_ARG;
+  }
+  memset(f, 0, sizeof(*f));
+  if (cloud_frame_checkin_put(f, &f->checkin, id, device_key, strlen(device_key)) != 0
+      || cloud_frame_checkin_put(f, &f->sign_in, id, NULL, CLOUD_FRAME_DIGEST_LEN) != 0)
+  {
+    return CLOUD_FRAME_ERR_ARG;
+  }
+  f->heart_beat.off = f->used;
+  if (cloud_frame_put(f, CLOUD_FRAME_HEART_BEAT, sizeof(CLOUD_FRAME_HEART_BEAT) - 1) != 0
+      || cloud_frame_end(f, &f->heart_beat) != 0
+      || cloud_frame_put(f, NULL, CLOUD_FRAME_TOKEN_MAX) != 0)
+  {
+    return CLOUD_FRAME_ERR_ARG;
+  }
+  f->user_key.off = f->used;
+  if (cloud_frame_put(f, user_key, strlen(user_key)) != 0 || cloud_frame_end(f, &f->user_key) != 0)
+  {
+    return CLOUD_FRAME_ERR_ARG;
+  }
+  return 0;
+}
+
+/**
+ * 取用设备API KEY签到的帧
+ * @param[in]   f     :帧的arena
+ * @param[out]  len   :帧的长度,含行尾的'\n'
+ * @retval      以'\0'结尾的帧
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+const char *cloud_frame_checkin(const cloud_frame_t *f, size_t *len)
+{
+  *len = f->checkin.len;
+  return f->buf + f->checkin.off;
+}
+
+/**
+ * 计算md5(token+用户API KEY)并填进加密签到帧
+ * @param[in]   f         :帧的arena
+ * @param[in]   token     :云平台下发的token,不以'\0'结尾
+ * @param[in]   token_len :token的长度
+ * @param[out]  len       :帧的长度,含行尾的'\n'
+ * @retval      以'\0'结尾的帧,token为空或者太长时为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+const char *cloud_frame_sign_in(cloud_frame_t *f, const char *token, size_t token_len, size_t *len)
+{
+  unsigned char md5_output[16];
+  char *input;
+  if (token == NULL || token_len == 0 || token_len > CLOUD_FRAME_TOKEN_MAX)
+  {
+    return NULL;
+  }
+  /* token紧贴在用户API KEY前面,拼成md5的输入 */
+  input = f->buf + f->user_key.off - token_len;
+  memcpy(input, token, token_len);
+  mbedtls_md5_ret((unsigned char *)input, token_len + f->user_key.len, md5_output);
+  cloud_frame_hex(f->buf + f->digest, md5_output, sizeof(md5_output));
+  *len = f->sign_in.len;
+  return f->buf + f->sign_in.off;
+}
+
+/**
+ * 取心跳帧
+ * @param[in]   f     :帧的arena
+ * @param[out]  len   :帧的长度,含行尾的'\n'
+ * @retval      以'\0'结尾的帧
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+const char *cloud_frame_heart_beat(const cloud_frame_t *f, size_t *len)
+{
+  *len = f->heart_beat.len;
+  return f->buf + f->heart_beat.off;
+}
@@ -0,0 +1,308 @@
+/**
+* @file         user_cloud_msg.c
+* @brief        云平台消息的解析以及按方法名分发的相关函数定义
+* @details      字段名只认cloud_msg_t中的几个,按长度和首字符区分;嵌套的对象和数组按深度整体跳过
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include "user_cloud_msg.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 跳过空白
+ * @param[in]   p     :当前位置
+ * @param[in]   end   :数据结尾
+ * @retval      第一个非空白字符的位置,没有时为end
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static const char *cloud_msg_ws(const char *p, const char *end)
+{
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+  {
+    p++;
+  }
+  return p;
+}
+
+/**
+ * 找到字符串的结束引号,转义的引号不算
+ * @param[in]   p     :开始引号后面的第一个字符
+ * @param[in]   end   :数据结尾
+ * @retval      结束引号的位置,没有结束时为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static const char *cloud_msg_str_end(const char *p, const char *end)
+{
+  while (p < end)
+  {
+    if (*p == '"')
+    {
+      return p;
+    }
+    /* 转义字符连同后面一个字符一起跳过 */
+    p += *p == '\\' ? 2 : 1;
+  }
+  return NULL;
+}
+
+/**
+ * 跳过一个非字符串的值:数字、true/false/null,或者整个嵌套的对象、数组
+ * @param[in]   p     :值的第一个字符
+ * @param[in]   end   :数据结尾
+ * @retval      值后面的位置,格式错误时为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static const char *cloud_msg_skip(const char *p, const char *end)
+{
+  uint32_t depth = 0;
+  while (p < end)
+  {
+    switch (*p)
+    {
+    case '"':
+      if ((p = cloud_msg_str_end(p + 1, end)) == NULL)
+      {
+        return NULL;
+      }
+      break;
+    case '{':
+    case '[':
+      depth++;
+      break;
+    case '}':
+    case ']':
+      if (depth == 0)
+      {
+        return p;
+      }
+      if (--depth == 0)
+      {
+        return p + 1;
+      }
+      break;
+    case ',':
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+      if (depth == 0)
+      {
+        return p;
+      }
+      break;
+    default:
+      break;
+    }
+    p++;
+  }
+  return depth == 0 ? p : NULL;
+}
+
+/**
+ * 字段名对应cloud_msg_t中的哪个视图
+ * @param[in]   msg   :消息
+ * @param[in]   key   :字段名
+ * @param[in]   len   :字段名长度
+ * @retval      对应的视图,不需要的字段为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static cloud_view_t *cloud_msg_field(cloud_msg_t *msg, const char *key, size_t len)
+{
+  if (len == 1)
+  {
+    switch (key[0])
+    {
+    case 'M':
+      return &msg->method;
+    case 'C':
+      return &msg->content;
+    case 'K':
+      return &msg->key;
+    case 'T':
+      return &msg->time;
+    default:
+      return NULL;
+    }
+  }
+  if (len == 2 && key[0] == 'I' && key[1] == 'D')
+  {
+    return &msg->id;
+  }
+  if (len == 4 && memcmp(key, "NAME", 4) == 0)
+  {
+    return &msg->name;
+  }
+  return NULL;
+}
+
+/**
+ * 解析一个一层的json对象,取出cloud_msg_t中的字段,其他字段跳过
+ * @param[in]   data  :数据,不需要以'\0'结尾
+ * @param[in]   len   :数据长度
+ * @param[out]  msg   :解析结果,视图指向data
+ * @retval
+ *              >0:对象(到'}'为止)占用的字节数
+ *              CLOUD_MSG_ERR_FORMAT:格式错误
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_msg_parse(const char *data, size_t len, cloud_msg_t *msg)
+{
+  const char *p = data, *end = data + len;
+  const char *key, *key_end, *val, *val_end;
+  cloud_view_t *field;
+  memset(msg, 0, sizeof(*msg));
+  p = cloud_msg_ws(p, end);
+  if (p == end || *p != '{')
+  {
+    return CLOUD_MSG_ERR_FORMAT;
+  }
+  p = cloud_msg_ws(p + 1, end);
+  if (p < end && *p == '}')
+  {
+    return p + 1 - data;
+  }
+  while (p < end)
+  {
+    /* "key" : value */
+    if (*p != '"' || (key_end = cloud_msg_str_end(key = p + 1, end)) == NULL)
+    {
+      return CLOUD_MSG_ERR_FORMAT;
+    }
+    p = cloud_msg_ws(key_end + 1, end);
+    if (p == end || *p != ':')
+    {
+      return CLOUD_MSG_ERR_FORMAT;
+    }
+    p = cloud_msg_ws(p + 1, end);
+    if (p == end)
+    {
+      return CLOUD_MSG_ERR_FORMAT;
+    }
+    if (*p == '"')
+    {
+      if ((val_end = cloud_msg_str_end(val = p + 1, end)) == NULL)
+      {
+        return CLOUD_MSG_ERR_FORMAT;
+      }
+      p = val_end + 1;
+    }
+    else
+    {
+      if ((val_end = cloud_msg_skip(val = p, end)) == NULL || val_end == val)
+      {
+        return CLOUD_MSG_ERR_FORMAT;
+      }
+      p = val_end;
+    }
+    field = cloud_msg_field(msg, key, key_end - key);
+    if (field != NULL && val_end - val <= UINT16_MAX)
+    {
+      field->p = val;
+      field->len = val_end - val;
+    }
+    p = cloud_msg_ws(p, end);
+    if (p == end)
+    {
+      break;
+    }
+    if (*p == '}')
+    {
+      return p + 1 - data;
+    }
+    if (*p != ',')
+    {
+      break;
+    }
+    p = cloud_msg_ws(p + 1, end);
+  }
+  return CLOUD_MSG_ERR_FORMAT;
+}
+
+/**
+ * 把路由列表按名字的散列填进分发表,表中原有的内容清空
+ * @param[out]  table :分发表
+ * @param[in]   slots :表的大小,2的幂
+ * @param[in]   routes:用CLOUD_MSG_ROUTE写的路由列表
+ * @param[in]   count :列表项数
+ * @retval
+ *              0:成功
+ *              CLOUD_MSG_ERR_DUPLICATE:有两个名字散列到同一个下标,或者名字为空
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_msg_table_init(cloud_msg_route_t *table, uint32_t slots, const cloud_msg_route_t *routes, size_t count)
+{
+  cloud_msg_route_t *slot;
+  size_t i;
+  memset(table, 0, slots * sizeof(*table));
+  for (i = 0; i < count; i++)
+  {
+    if (routes[i].len == 0)
+    {
+      return CLOUD_MSG_ERR_DUPLICATE;
+    }
+    /* 首尾字符直接从名字取,和cloud_msg_dispatch查表时一致 */
+    slot = &table[CLOUD_MSG_HASH(routes[i].len, routes[i].name[0], routes[i].name[routes[i].len - 1]) & (slots - 1)];
+    if (slot->handler != NULL)
+    {
+      return CLOUD_MSG_ERR_DUPLICATE;
+    }
+    *slot = routes[i];
+  }
+  return 0;
+}
+
+/**
+ * 按名字查分发表并调用对应的处理函数
+ * @param[in]   table :用cloud_msg_table_init填好的分发表
+ * @param[in]   slots :表的大小,2的幂
+ * @param[in]   name  :要查的名字
+ * @param[in]   msg   :传给处理函数的消息
+ * @retval
+ *              0:已处理
+ *              CLOUD_MSG_ERR_UNKNOWN:表中没有这个名字
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+int cloud_msg_dispatch(const cloud_msg_route_t *table, uint32_t slots, cloud_view_t name, const cloud_msg_t *msg)
+{
+  const cloud_msg_route_t *route;
+  if (name.len == 0)
+  {
+    return CLOUD_MSG_ERR_UNKNOWN;
+  }
+  route = &table[CLOUD_MSG_HASH(name.len, name.p[0], name.p[name.len - 1]) & (slots - 1)];
+  if (route->handler == NULL || route->len != name.len || memcmp(route->name, name.p, name.len) != 0)
+  {
+    return CLOUD_MSG_ERR_UNKNOWN;
+  }
+  route->handler(msg);
+  return 0;
+}
@@ -0,0 +1,148 @@
+/**
+* @file         user_keepalive.c
+* @brief        自适应心跳间隔的相关函数定义
+* @details      空闲时被断开,而且空闲时长超过了连接撑过的最长空闲,才认为是服务器超时;
+*               发数据后不久的断开和偶尔的网络中断不改变间隔;
+*               测出的超时只会因为空闲断开而变小,服务器的超时变短时连续几次空闲断开后重新测;
+*               间隔的上限取文档超时和测出超时中较小的那个的3/4,任何时候都不会超过
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include "user_keepalive.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 当前允许的最长心跳间隔:文档超时和测出超时中较小的那个的3/4
+ * @param[in]   k     :心跳状态
+ * @retval      毫秒数
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint32_t keepalive_cap(const keepalive_t *k)
+{
+  uint32_t timeout = k->timeout_ms;
+  uint32_t cap;
+  if (k->learned_ms != 0 && k->learned_ms < timeout)
+  {
+    timeout = k->learned_ms;
+  }
+  cap = timeout / 4 * 3;
+  return cap < KEEPALIVE_MIN_MS ? KEEPALIVE_MIN_MS : cap;
+}
+
+/**
+ * 初始化
+ * @param[out]  k           :心跳状态
+ * @param[in]   interval_ms :初始的心跳间隔,超过timeout_ms的3/4时取3/4
+ * @param[in]   timeout_ms  :服务器文档给出的空闲超时
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void keepalive_init(keepalive_t *k, uint32_t interval_ms, uint32_t timeout_ms)
+{
+  uint32_t cap;
+  memset(k, 0, sizeof(*k));
+  k->timeout_ms = timeout_ms;
+  cap = keepalive_cap(k);
+  k->interval_ms = interval_ms < KEEPALIVE_MIN_MS ? KEEPALIVE_MIN_MS : interval_ms;
+  if (k->interval_ms > cap)
+  {
+    k->interval_ms = cap;
+  }
+}
+
+/**
+ * 心跳定时器到期时调用,判断现在是否要发心跳
+ * 返回0时调用者发出心跳,再过interval_ms检查;否则过返回的毫秒数再检查
+ * @param[in]   k       :心跳状态
+ * @param[in]   idle_ms :距离最后一帧发出的毫秒数
+ * @retval      0:现在发心跳 其他:下次检查前还要等的毫秒数
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+uint32_t keepalive_next(keepalive_t *k, uint32_t idle_ms)
+{
+  uint32_t cap;
+  /* 这段时间里发过其他帧,服务器已经知道连接还在 */
+  if (idle_ms + KEEPALIVE_SLACK_MS < k->interval_ms)
+  {
+    k->stats.deferred++;
+    return k->interval_ms - idle_ms;
+  }
+  /* 空闲了一整个间隔连接还在,说明服务器能容忍这么久 */
+  if (idle_ms > k->survived_ms)
+  {
+    k->survived_ms = idle_ms;
+  }
+  k->suspect = 0;
+  cap = keepalive_cap(k);
+  if (KEEPALIVE_PROBE && ++k->streak >= KEEPALIVE_PROBE_STREAK && k->interval_ms < cap)
+  {
+    k->interval_ms = k->interval_ms + KEEPALIVE_STEP_MS < cap ? k->interval_ms + KEEPALIVE_STEP_MS : cap;
+    k->streak = 0;
+  }
+  k->stats.sent++;
+  return 0;
+}
+
+/**
+ * 连接断开时调用,空闲时被断开的话按断开时的空闲时长调整心跳间隔
+ * @param[in]   k       :心跳状态
+ * @param[in]   idle_ms :断开时距离最后一帧发出的毫秒数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void keepalive_closed(keepalive_t *k, uint32_t idle_ms)
+{
+  uint32_t cap;
+  k->streak = 0;
+  /* 断开前不久还发过数据,和空闲超时无关 */
+  if (idle_ms < k->interval_ms / 2)
+  {
+    k->suspect = 0;
+    return;
+  }
+  /* 以前撑过更久的空闲,可能只是偶尔的网络中断 */
+  if (idle_ms <= k->survived_ms && ++k->suspect < KEEPALIVE_SUSPECT)
+  {
+    return;
+  }
+  /* 已经见过的断开不能被更长的空闲覆盖 */
+  if (k->learned_ms == 0 || idle_ms < k->learned_ms)
+  {
+    k->learned_ms = idle_ms;
+  }
+  if (k->survived_ms > idle_ms)
+  {
+    k->survived_ms = idle_ms;
+  }
+  k->suspect = 0;
+  cap = keepalive_cap(k);
+  if (k->interval_ms > cap)
+  {
+    k->interval_ms = cap;
+  }
+  k->stats.timeouts++;
+}
@@ -0,0 +1,212 @@
+/**
+* @file         user_line_buf.c
+* @brief        按换行符切分数据流的相关函数定义
+* @details      找'\n'时先对齐到4字节,再一次比较一个字;行的长度限制对原地的行和拼出的行一样,
+*               同样的数据不论被分成几次读取,交给回调的行都相同
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+
+/*
+===========================
+头文件包含
+===========================
+*/
+#include <string.h>
+#include "user_line_buf.h"
+
+/*
+===========================
+宏定义
+===========================
+*/
+#define LINE_BUF_ONES                 0x01010101UL          ///<每个字节都是0x01
+#define LINE_BUF_HIGHS                0x80808080UL          ///<每个字节的最高位
+#define LINE_BUF_NLS                  0x0A0A0A0AUL          ///<每个字节都是'\n'
+
+/*
+===========================
+类型定义
+===========================
+*/
+/* 按字读取字符缓存,告诉编译器可能和char别名 */
+typedef uint32_t __attribute__((__may_alias__)) line_buf_word_t;
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/**
+ * 找第一个'\n'
+ * 和'\n'异或之后为0的字节就是换行,(w - 0x01010101) & ~w & 0x80808080不为0说明这个字中有为0的字节
+ * @param[in]   p     :开始位置
+ * @param[in]   end   :数据结尾
+ * @retval      '\n'的位置,没有时为NULL
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static char *line_buf_find_nl(char *p, char *end)
+{
+  uint32_t w;
+  while (p < end && ((uintptr_t)p & 3) != 0)
+  {
+    if (*p == '\n')
+    {
+      return p;
+    }
+    p++;
+  }
+  while (end - p >= 4)
+  {
+    w = *(const line_buf_word_t *)p ^ LINE_BUF_NLS;
+    if (((w - LINE_BUF_ONES) & ~w & LINE_BUF_HIGHS) != 0)
+    {
+      break;
+    }
+    p += 4;
+  }
+  while (p < end)
+  {
+    if (*p == '\n')
+    {
+      return p;
+    }
+    p++;
+  }
+  return NULL;
+}
+
+/**
+ * 把一行交给回调,去掉行尾的'\r',空行不交
+ * @param[in]   lb    :行缓存
+ * @param[in]   line  :行的开始,line[len]可写
+ * @param[in]   len   :行的长度,不含'\n'
+ * @param[in]   cb    :行回调
+ * @param[in]   arg   :回调参数
+ * @retval      1:交给了回调 0:空行
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static uint8_t line_buf_emit(line_buf_t *lb, char *line, size_t len, line_buf_cb_t cb, void *arg)
+{
+  if (len > 0 && line[len - 1] == '\r')
+  {
+    len--;
+  }
+  line[len] = '\0';
+  if (len == 0)
+  {
+    return 0;
+  }
+  lb->stats.lines++;
+  cb(line, len, arg);
+  return 1;
+}
+
+/**
+ * 把没有遇到'\n'的部分追加进缓存,超过LINE_BUF_LEN时丢弃到下一个'\n'
+ * @param[in]   lb    :行缓存
+ * @param[in]   p     :数据
+ * @param[in]   n     :长度
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+static void line_buf_keep(line_buf_t *lb, const char *p, size_t n)
+{
+  if (lb->discard)
+  {
+    return;
+  }
+  if (n > (size_t)(LINE_BUF_LEN - lb->len))
+  {
+    lb->discard = 1;
+    lb->len = 0;
+    lb->stats.overflows++;
+    return;
+  }
+  memcpy(lb->buf + lb->len, p, n);
+  lb->len += n;
+}
+
+/**
+ * 丢弃缓存中的半行,连接断开或重新建立时调用,避免上一个连接的残留拼到新连接的第一行前面
+ * @param[in]   lb    :行缓存
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void line_buf_reset(line_buf_t *lb)
+{
+  lb->len = 0;
+  lb->discard = 0;
+}
+
+/**
+ * 送入一段收到的数据,每遇到一个'\n'就把这一行交给cb
+ * data中完整的行原地交给cb,会把行尾的'\n'改为'\0';末尾不完整的部分拷贝进缓存
+ * @param[in]   lb    :行缓存
+ * @param[in]   data  :数据,可写
+ * @param[in]   len   :数据长度
+ * @param[in]   cb    :行回调
+ * @param[in]   arg   :回调参数
+ * @retval      null
+ * @par         修改日志
+ *               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+ */
+void line_buf_feed(line_buf_t *lb, char *data, size_t len, line_buf_cb_t cb, void *arg)
+{
+  char *p = data, *end = data + len, *nl;
+  size_t n;
+  while (p < end)
+  {
+    if ((nl = line_buf_find_nl(p, end)) == NULL)
+    {
+      line_buf_keep(lb, p, end - p);
+      return;
+    }
+    n = nl - p;
+    if (lb->discard)
+    {
+      /* 太长的行到这里结束,已经计过数 */
+      lb->discard = 0;
+    }
+    else if (lb->len == 0)
+    {
+      /* 整行都在这次的数据里,原地交给回调 */
+      if (n > LINE_BUF_LEN)
+      {
+        lb->stats.overflows++;
+      }
+      else
+      {
+        line_buf_emit(lb, p, n, cb, arg);
+      }
+    }
+    else if (n > (size_t)(LINE_BUF_LEN - lb->len))
+    {
+      lb->len = 0;
+      lb->stats.overflows++;
+    }
+    else
+    {
+      /* 前半行在缓存里,补上后半行再交给回调 */
+      memcpy(lb->buf + lb->len, p, n);
+      n += lb->len;
+      lb->len = 0;
+      lb->stats.spliced += line_buf_emit(lb, lb->buf, n, cb, arg);
+    }
+    p = nl + 1;
+  }
+}
@@ -8,6 +8,18 @@
 * @par History:          
 *               Ver0.0.1:
                      Helon_Chan, 2018/08/12, 初始化版本\n 
+*               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, TLS连接按配置档建立,统计握手和收发期间的堆峰值\n 
+*               Ver0.0.3:
+                     Helon_Chan, 2026/10/17, 连接、收发和心跳交给user_cloud_conn的单个连接任务,去掉接收任务和心跳任务\n 
+*               Ver0.0.4:
+                     Helon_Chan, 2026/10/17, 收到的消息原地解析,按方法名和命令查分发表,不再cJSON_Print后逐个strcmp\n 
+*               Ver0.0.5:
+                     Helon_Chan, 2026/10/17, 收到的数据先按'\n'切成完整的消息再解析,一次读到多条或半条消息时不再解析出错\n 
+*               Ver0.0.6:
+                     Helon_Chan, 2026/10/17, 签到、加密签到和心跳帧改用user_cloud_frame预先拼好的帧,不再用cJSON拼装,不再申请内存\n 
+*               Ver0.0.7:
+                     Helon_Chan, 2026/10/17, 心跳只在连接空闲满一个间隔时发送,间隔按测出的服务器空闲超时自动调整\n 
 */
 
 /*
@@ -15,17 +27,12 @@
 头文件包含
 =========================== 
 */
-#include "mbedtls/platform.h"
-#include "mbedtls/net.h"
-#include "mbedtls/md5.h"
-#include "mbedtls/debug.h"
-#include "mbedtls/ssl.h"
-#include "mbedtls/entropy.h"
-#include "mbedtls/ctr_drbg.h"
-#include "mbedtls/error.h"
-#include "mbedtls/certs.h"
-#include "cJSON.h"
 #include "user_tmall_genie.h"
+#include "user_cloud_conn.h"
+#include "user_cloud_msg.h"
+#include "user_line_buf.h"
+#include "user_cloud_frame.h"
+#include "user_keepalive.h"
 #include "esp_log.h"
 #include "os.h"
 #include "esp_wifi.h"
@@ -39,80 +46,48 @@
 全局变量定义
 =========================== 
 */
-typedef struct
-{
-  mbedtls_net_context *net_ctx;
-  mbedtls_entropy_context *entropy;
-  mbedtls_ctr_drbg_context *ctr_drbg;
-  mbedtls_ssl_context *ssl_ctx;
-  mbedtls_ssl_config *ssl_conf;
-}tcp_ssl_connect_t;
+/* 到贝壳物联的长连接,收发、心跳都在它的连接任务里进行 */
+static cloud_conn_t gs_cloud_conn;
 
-tcp_ssl_connect_t tcp_ssl_connect =
-{
-  .net_ctx  = NULL,
-  .entropy  = NULL,
-  .ctr_drbg = NULL,
-  .ssl_ctx  = NULL,
-  .ssl_conf = NULL,
-};
-/* 存放接收到GET请求的数据 */
-static uint8_t  gs_recv_buff[1024*2];
+/* 心跳定时器的编号,-1表示没有启动 */
+static int gs_heart_beat_timer = -1;
 
-/* 存放token+user_api_key md5加密之后的数据 */
-static char *md5_encrypted_token_user_api_key = NULL;
+/* 把收到的数据流切成以'\n'结尾的消息,只在连接任务中使用 */
+static line_buf_t gs_line_buf;
+
+/* 预先拼好的签到、加密签到和心跳帧 */
+static cloud_frame_t gs_cloud_frame;
+
+/* 心跳间隔以及测出的服务器空闲超时,断线重连后继续沿用 */
+static keepalive_t gs_keepalive;
 /*
 ===========================
 函数定义
 =========================== 
 */
 
-/** 
-* tcp+ssl连接的相关参数清空
-* @param[in]   null
-* @retval      null
-* @note        修改日志 
-*               Ver0.0.1: 
-                  Helon_Chan, 2018/08/12, 初始化版本\n 
-*/
-static void tcp_ssl_parameters_clean(void)
-{  
-  mbedtls_ssl_close_notify(tcp_ssl_connect.ssl_ctx);
-  mbedtls_net_free(tcp_ssl_connect.net_ctx);
-  
-  mbedtls_ssl_free(tcp_ssl_connect.ssl_ctx);
-  mbedtls_ssl_config_free(tcp_ssl_connect.ssl_conf);
-  mbedtls_ctr_drbg_free(tcp_ssl_connect.ctr_drbg);
-  mbedtls_entropy_free(tcp_ssl_connect.entropy);
-
-  os_free(tcp_ssl_connect.ssl_ctx);
-  os_free(tcp_ssl_connect.net_ctx);
-  os_free(tcp_ssl_connect.ctr_drbg);
-  
-  os_free(tcp_ssl_connect.entropy);
-  os_free(tcp_ssl_connect.ssl_conf);
-}
 /** 
 * 向云平台服务器发送数据,填充想要符合云平台通讯协议的json数据即可
-* @param[in]   p_json_data:需要发送给云平台的数据,json的数据格式
+* @param[in]   p_json_data:需要发送给云平台的数据,json的数据格式,以'\0'结尾
+* @param[in]   len        :数据长度
 * @retval      null
 * @note        修改日志 
 *               Ver0.0.1: 
                   Helon_Chan, 2018/08/12, 初始化版本\n 
+*               Ver0.0.2: 
+                  Helon_Chan, 2026/10/17, 放进连接的发送队列,由连接任务统一写入TLS\n 
+*               Ver0.0.3: 
+                  Helon_Chan, 2026/10/17, 长度由调用者给出,不再strlen\n 
 */
-static void tcp_ssl_write(const char *p_json_data)
+static void tcp_ssl_write(const char *p_json_data, size_t len)
 {
-  int ret, len;    
-  while ((ret = mbedtls_ssl_write(tcp_ssl_connect.ssl_ctx, (unsigned char*)p_json_data, strlen(p_json_data))) <= 0)
+  int ret = cloud_conn_send(&gs_cloud_conn, p_json_data, len);
+  if (ret != 0)
   {
-    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
-    {
-      ESP_LOGI(TAG, " failed\n  ! mbedtls_ssl_write returned %d\n\n", ret);
-      return;
-    }
+    ESP_LOGI(TAG, " failed\n  ! cloud_conn_send returned -0x%x\n\n", -ret);
+    return;
   }
-  len = ret;
-  ESP_LOGI("tcp_ssl_write", " %d bytes written\n\n%s", len, (char *)p_json_data);  
+  ESP_LOGI("tcp_ssl_write", " %d bytes queued\n\n%s", len, (char *)p_json_data);  
 }
 
 
@@ -123,273 +98,318 @@ static void tcp_ssl_write(const char *p_json_data)
 * @note        修改日志 
 *               Ver0.0.1: 
                   Helon_Chan, 2018/08/14, 初始化版本\n 
+*               Ver0.0.2: 
+                  Helon_Chan, 2026/10/17, 直接发送预先拼好的签到帧\n 
 */
 static void send_device_api_key(void)
 {
-  char *p_json_device_api_key_info = NULL;
-  char json_device_api_key_info[48] = {0};
-  cJSON *device_api_key_info = cJSON_CreateObject();
-  /* 拼装发送设备api_key的json数据 */
-  cJSON_AddItemToObject(device_api_key_info,"M",cJSON_CreateString("checkin"));
-  cJSON_AddItemToObject(device_api_key_info,"ID",cJSON_CreateString(DEVICE_ID));
-  cJSON_AddItemToObject(device_api_key_info,"K",cJSON_CreateString(DEVICE_API_KEY));
-  p_json_device_api_key_info = cJSON_PrintUnformatted(device_api_key_info);  
-  /* 记得加换行符号,否则云平台无法识别 */
-  memcpy(json_device_api_key_info,p_json_device_api_key_info,strlen(p_json_device_api_key_info));  
-  json_device_api_key_info[strlen(json_device_api_key_info)] = '\n';
-  // ESP_LOGI("send_device_api_key", " %d bytes written\n\n%s", strlen(json_device_api_key_info), (char *)json_device_api_key_info);
-  tcp_ssl_write(json_device_api_key_info);
-}
-
-/** 
-* 获取token之后,进行token+用户api key加密登陆
-* @param[in]   token:表示从云平台上获取得到的token数据
-* @retval      返回md5加密之后的token+用户api_key数据
-* @note        修改日志 
-*               Ver0.0.1: 
-                  Helon_Chan, 2018/08/14, 初始化版本\n 
-*/
-static void token_user_api_key_md5_encrypted(const char *token)
-{
-  char token_user_api_key[48] = {0};  
-  md5_encrypted_token_user_api_key = (char *)os_malloc(sizeof(char) * 48);  
-  memset(md5_encrypted_token_user_api_key,0,48);
-  unsigned char md5_output[16] = {0};
-
-  /* 进行token+user api key拼装 */  
-  memcpy(token_user_api_key, token + 1, strlen(token) - 2);
-
-  memcpy(token_user_api_key + (strlen(token_user_api_key)), USER_API_KEY, strlen(USER_API_KEY));
-  ESP_LOGI("token_user_api_key_md5_encrypted", "token_user_api_key is [%s] [%d]\n", token_user_api_key, strlen(token_user_api_key));
-  /* md5加密 */
-  mbedtls_md5_ret((unsigned char *)token_user_api_key, strlen(token_user_api_key), md5_output);
-  
-  /* 数组转为字符串 */
-  for (unsigned char i = 0; i < 16; i++)
-  {    
-    sprintf(md5_encrypted_token_user_api_key+2*i, "%02x", md5_output[i]);
-  }      
-  ESP_LOGI("token_user_api_key_md5_encrypted", "md5_encrypted_token_user_api_key is [%s] [%d]\n", md5_encrypted_token_user_api_key, strlen(md5_encrypted_token_user_api_key));      
+  size_t len;
+  const char *frame = cloud_frame_checkin(&gs_cloud_frame, &len);
+  tcp_ssl_write(frame, len);
 }
 
 
 /** 
-* 使用md5加密之后的token+用户api_key数据进行设备登陆
-* @param[in]   token_user_api_key_md5_encrypted:表示md5加密之后的token+用户api_key数据
+* 获取token之后,用md5(token+用户api_key)进行设备加密登陆
+* @param[in]   token:表示从云平台上获取得到的token数据,不含引号,不以'\0'结尾
+* @param[in]   len  :token的长度
 * @retval      null
 * @note        修改日志 
 *               Ver0.0.1: 
                   Helon_Chan, 2018/08/14, 初始化版本\n 
 *               Ver0.0.2: 
                   Helon_Chan, 2018/08/15, 解决md5加密之后无不登陆的问题\n                   
+*               Ver0.0.3: 
+                  Helon_Chan, 2026/10/17, 合并token_user_api_key_md5_encrypted,md5结果直接填进预先拼好的帧\n 
 */
-static void device_encrypted_sign_in(const char *token_user_api_key_md5_encrypted)
+static void device_encrypted_sign_in(const char *token, size_t len)
 {
-  char *p_json_token_user_api_key_md5 = NULL;
-  cJSON *token_user_api_key = cJSON_CreateObject();
-  /* 存放拼装的md5加密数据 */
-  char json_device_api_key_info[8*9] = {0};
-  /* 拼装发送设备api_key的json数据 */
-  cJSON_AddItemToObject(token_user_api_key,"M",cJSON_CreateString("checkin"));
-  cJSON_AddItemToObject(token_user_api_key,"ID",cJSON_CreateString(DEVICE_ID));
-  cJSON_AddItemToObject(token_user_api_key,"K",cJSON_CreateString(token_user_api_key_md5_encrypted));
-  p_json_token_user_api_key_md5 = cJSON_PrintUnformatted(token_user_api_key);  
-
-  // ESP_LOGI("device_encrypted_sign_in", "p_json_token_user_api_key_md5 is [%s] [%d]\n", p_json_token_user_api_key_md5, strlen(p_json_token_user_api_key_md5));
-
-  /* 记得加换行符号,否则云平台无法识别 */
-  memcpy(json_device_api_key_info,p_json_token_user_api_key_md5,strlen(p_json_token_user_api_key_md5));
-  json_device_api_key_info[strlen(json_device_api_key_info)] = '\n';  
-  
-  ESP_LOGI("device_encrypted_sign_in", "json_token_user_api_key_md5 is [%s] [%d]\n", json_device_api_key_info, strlen(json_device_api_key_info));
+  size_t frame_len;
+  const char *frame = cloud_frame_sign_in(&gs_cloud_frame, token, len, &frame_len);
+  if (frame == NULL)
+  {
+    ESP_LOGI("device_encrypted_sign_in", "invalid token [%.*s]\n", (int)len, token);
+    return;
+  }
+  ESP_LOGI("device_encrypted_sign_in", "json_token_user_api_key_md5 is [%s] [%d]\n", frame, frame_len);
   /* 发送设备加密登陆信息 */
-  tcp_ssl_write(json_device_api_key_info);
-  /* 释放存放md5加密之后token+user_api_key数据的内存 */
-  os_free(md5_encrypted_token_user_api_key);
+  tcp_ssl_write(frame, frame_len);
 } 
 
 
 /** 
- * 心跳包任务处理函数
- * @param[in]   pvParameters: 表示任务所携带的参数 
+ * 心跳定时器到期,发送心跳包
+ * @param[in]   conn: 连接
+ * @param[in]   arg : 定时器参数,未使用
  * @retval      null 
- *              其他:          失败 
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/08/15, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 由心跳任务改为连接任务中的定时器回调\n 
+ *               Ver0.0.3:
+                    Helon_Chan, 2026/10/17, 发送预先拼好的心跳帧\n 
+ *               Ver0.0.4:
+                    Helon_Chan, 2026/10/17, 这段时间发过其他帧时推后,不发心跳;改为每次重新启动单次定时器\n 
  */
-static void heart_beat_task(void *pvParameters)
+static void heart_beat_timeout(cloud_conn_t *conn, void *arg)
 {
-  while (1)
+  size_t len;
+  const char *frame;
+  uint32_t wait_ms = keepalive_next(&gs_keepalive, cloud_conn_idle_ms(conn));
+  if (wait_ms == 0)
   {
-    /* 每隔30秒发送心跳包 */
-    tcp_ssl_write(HEART_BEAT);
-    vTaskDelay(30 * 1000 / portTICK_RATE_MS);
+    frame = cloud_frame_heart_beat(&gs_cloud_frame, &len);
+    tcp_ssl_write(frame, len);
+    wait_ms = gs_keepalive.interval_ms;
   }
-  vTaskDelete(NULL);
+  /* 单次定时器到期时已经释放,这里重新启动一个,编号可能变化 */
+  gs_heart_beat_timer = cloud_conn_timer_start(conn, wait_ms, 0, heart_beat_timeout, NULL);
 }
 
 /** 
- * 发送心跳包给云平台,每隔30秒发送一次心跳包，否则被云平台踢下线
+ * 发送心跳包给云平台,连接空闲满一个心跳间隔就发送一次心跳包，否则被云平台踢下线
  * @param[in]   null
  * @retval      null 
  *              其他:          失败 
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/08/15, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 改用连接任务中的周期定时器,不再创建心跳任务\n 
+ *               Ver0.0.3:
+                    Helon_Chan, 2026/10/17, 改为按gs_keepalive的间隔启动单次定时器\n 
  */
 static void heart_beat_start(void)
 {
-  int err_code = xTaskCreate(heart_beat_task,
-                             "heart_beat_task",
-                             1024 * 4,
-                             NULL,
-                             3,
-                             NULL);
-  if (err_code != pdPASS)
+  /* 重复登陆成功时不再多开一个定时器 */
+  if (gs_heart_beat_timer >= 0)
+  {
+    return;
+  }
+  gs_heart_beat_timer = cloud_conn_timer_start(&gs_cloud_conn, gs_keepalive.interval_ms, 0, heart_beat_timeout, NULL);
+  if (gs_heart_beat_timer < 0)
   {
-    ESP_LOGI("heart_beat_start", "heart_beat_task create failure,reason is %d\n", err_code);
+    ESP_LOGI("heart_beat_start", "heart beat timer start failure,reason is -0x%x\n", -gs_heart_beat_timer);
   }    
 }
 
 
+/** 
+ * 天猫精灵命令:打开
+ * @param[in]   msg: 云平台下发的消息
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 从cloud_cmd_data_hander的分支拆成命令分发表的处理函数\n 
+ */
+static void cloud_cmd_play(const cloud_msg_t *msg)
+{
+  r_fade_start();
+  ESP_LOGI("cloud_cmd_data_hander", "Switch ON\n");
+}
+
+/** 
+ * 天猫精灵命令:关闭
+ * @param[in]   msg: 云平台下发的消息
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 从cloud_cmd_data_hander的分支拆成命令分发表的处理函数\n 
+ */
+static void cloud_cmd_stop(const cloud_msg_t *msg)
+{
+  r_fade_stop();
+  ESP_LOGI("cloud_cmd_data_hander", "Switch OFF\n");
+}
+
+/* "say"消息中"C"字段的命令,连接前由cloud_msg_table_init填进gs_cloud_cmd_routes */
+static const cloud_msg_route_t gs_cloud_cmd_list[] =
+{
+  CLOUD_MSG_ROUTE("play", cloud_cmd_play),
+  CLOUD_MSG_ROUTE("stop", cloud_cmd_stop),
+};
+static cloud_msg_route_t gs_cloud_cmd_routes[BIG_IOT_CMD_SLOTS];
+
 /** 
  * 处理云平台的控制命令以及数据
- * @param[in]   json_parse_data: 存放解析之后的云平台json数据
+ * @param[in]   msg: 云平台下发的"say"消息
  * @retval      null 
- *              其他:          失败 
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 按"C"字段查命令分发表,不再cJSON_Print\n 
  */
-static void cloud_cmd_data_hander(const cJSON *json_parse_data)
+static void cloud_cmd_data_hander(const cloud_msg_t *msg)
 {
-  char *cmd = NULL;
-  /* 获取云平台返回的json数据中当前的控制命令是什么 */
-  cmd = cJSON_Print(cJSON_GetObjectItem(json_parse_data, "C"));
-  /* 根据云平台返回的method执行不同的动作 */
-    switch (strcmp(cmd, "\"play\"") == 0 ? ON : 
-            strcmp(cmd, "\"stop\"") == 0 ? OFF : INVALID_METHOD)
-    {
-      case ON:
-        r_fade_start();
-        ESP_LOGI("cloud_cmd_data_hander", "Switch ON\n");
-        break;
-      case OFF:
-        r_fade_stop();
-        ESP_LOGI("cloud_cmd_data_hander", "Switch OFF\n");
-        break;
-      default:
-        break;
-    }            
+  if (cloud_msg_dispatch(gs_cloud_cmd_routes, BIG_IOT_CMD_SLOTS, msg->content, msg) != 0)
+  {
+    ESP_LOGI("cloud_cmd_data_hander", "unknown command [%.*s]\n", msg->content.len, msg->content.p ? msg->content.p : "");
+  }
+}
+
+/** 
+ * 云平台消息:TCP连接成功后服务器发来的欢迎消息
+ * @param[in]   msg: 云平台下发的消息
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 从json_parse的分支拆成方法分发表的处理函数\n 
+ */
+static void big_iot_on_welcome(const cloud_msg_t *msg)
+{
+  ESP_LOGI("json_parse", "big_iot_connect success\n"); 
+  send_device_api_key();
+}
+
+/** 
+ * 云平台消息:发送设备API KEY之后,获取得到TOKEN
+ * @param[in]   msg: 云平台下发的消息
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 从json_parse的分支拆成方法分发表的处理函数\n 
+ *               Ver0.0.3:
+                    Helon_Chan, 2026/10/17, md5和登陆帧都在device_encrypted_sign_in中完成\n 
+ */
+static void big_iot_on_token(const cloud_msg_t *msg)
+{
+  ESP_LOGI("json_parse", "token is %.*s\n", msg->key.len, msg->key.p ? msg->key.p : "");         
+  device_encrypted_sign_in(msg->key.p, msg->key.len);
+}
+
+/** 
+ * 云平台消息:设备加密登陆成功
+ * @param[in]   msg: 云平台下发的消息
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 从json_parse的分支拆成方法分发表的处理函数\n 
+ */
+static void big_iot_on_checkinok(const cloud_msg_t *msg)
+{
+  ESP_LOGI("json_parse", "sign success\n"); 
+  heart_beat_start();
 }
 
+/* 云平台消息的方法,连接前由cloud_msg_table_init填进gs_big_iot_routes */
+static const cloud_msg_route_t gs_big_iot_list[] =
+{
+  CLOUD_MSG_ROUTE("WELCOME TO BIGIOT", big_iot_on_welcome),
+  CLOUD_MSG_ROUTE("token", big_iot_on_token),
+  CLOUD_MSG_ROUTE("checkinok", big_iot_on_checkinok),
+  CLOUD_MSG_ROUTE("say", cloud_cmd_data_hander),
+};
+static cloud_msg_route_t gs_big_iot_routes[BIG_IOT_METHOD_SLOTS];
+/* 两张分发表已经填好 */
+static uint8_t gs_big_iot_routes_ready = 0;
+
 /** 
- * 解析json数据
- * @param[in]   json_data: 需要解析的json数据
+ * 解析json数据,按"M"字段查方法分发表
+ * @param[in]   json_data: 需要解析的json数据,不需要以'\0'结尾
+ * @param[in]   len      : 数据长度
  * @retval      null 
  *              其他:          失败 
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/08/14, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 原地解析,处理函数拿到的是指向接收缓存的视图,不申请内存\n 
  */
-static void json_parse(const char *json_data)
+static void json_parse(const char *json_data, size_t len)
 {
-  cJSON *json_string = cJSON_Parse(json_data);
-  char* token  = NULL;
-  char* method = NULL;
+  cloud_msg_t msg;
   /* 如果解析失败,则打印解析失败的原因 */
-  if(!json_string)
+  if (cloud_msg_parse(json_data, len, &msg) < 0)
   {
-    ESP_LOGI("json_parse","cJSON Parse failure,reason is [%s]\n", cJSON_GetErrorPtr());  
+    ESP_LOGI("json_parse","json parse failure [%.*s]\n", (int)len, json_data);  
     return;
   }
-  else
-  {
-    /* 获取云平台返回的json数据中当前的方法是什么 */
-    method =  cJSON_Print(cJSON_GetObjectItem(json_string, "M"));
+  /* 根据云平台返回的method执行不同的动作,其他方法忽略 */
+  cloud_msg_dispatch(gs_big_iot_routes, BIG_IOT_METHOD_SLOTS, msg.method, &msg);
+}
 
-    /* 根据云平台返回的method执行不同的动作 */
-    switch (strcmp(method, "\"checkinok\"") == 0 ? SIGN_IN_OK : 
-            strcmp(method, "\"token\"") == 0 ? GET_TOKEN : 
-            strcmp(method, "\"say\"") == 0 ? RECEVICE : 
-            strcmp(method, "\"WELCOME TO BIGIOT\"") == 0 ? TCP_CONNECT_SUCCESS:INVALID_METHOD)
-    {
-      /* ESP32成功连接上云平台 */
-      case TCP_CONNECT_SUCCESS:
-        ESP_LOGI("json_parse", "big_iot_connect success\n"); 
-        send_device_api_key();
-        break;
-      /* 发送设备API KEY之后，获取得到TOKEN */
-      case GET_TOKEN:
-        token = cJSON_Print(cJSON_GetObjectItem(json_string, "K"));
-        ESP_LOGI("json_parse", "token is %s\n",token);         
-        token_user_api_key_md5_encrypted(token);
-        device_encrypted_sign_in(md5_encrypted_token_user_api_key);
-        break;
-      /* 设备加密登陆成功 */
-      case SIGN_IN_OK:
-        ESP_LOGI("json_parse", "sign success\n"); 
-        heart_beat_start();
-        break;
-      /* 接收云平台的命令或者数据 */
-      case RECEVICE:
-        cloud_cmd_data_hander(json_string);
-        break;
-      default:
-        break;
-    }
-  }
+/** 
+ * 切出了一条完整的消息
+ * @param[in]   line: 消息,不含行尾的'\n'
+ * @param[in]   len : 消息长度
+ * @param[in]   arg : 未使用
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2026/10/17, 初始化版本\n 
+ */
+static void big_iot_cloud_line(char *line, size_t len, void *arg)
+{
+  json_parse(line, len);
 }
 
 /** 
- * tcp连接任务处理函数
- * @param[in]   pvParameters: 表示任务所携带的参数 
+ * 连接任务收到云平台的数据
+ * @param[in]   conn: 连接
+ * @param[in]   data: 收到的数据,以'\0'结尾
+ * @param[in]   len : 数据长度
  * @retval      null 
- *              其他:          失败 
  * @par         修改日志 
  *               Ver0.0.1:
                     Helon_Chan, 2018/08/12, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 由接收任务改为连接任务的回调\n 
+ *               Ver0.0.3:
+                    Helon_Chan, 2026/10/17, 把长度一起交给json_parse\n 
+ *               Ver0.0.4:
+                    Helon_Chan, 2026/10/17, 按行切分后逐条解析,半条消息留到下次数据到来时补齐\n 
+ */
+static void big_iot_cloud_data(cloud_conn_t *conn, char *data, size_t len)
+{
+  ESP_LOGI(TAG, " %d bytes read\n\n%s", len, data);
+  line_buf_feed(&gs_line_buf, data, len, big_iot_cloud_line, NULL);
+}
+
+/** 
+ * 连接断开,连接任务会自动重连,定时器已经全部停止
+ * @param[in]   conn  : 连接
+ * @param[in]   reason: 断开原因,0表示服务器关闭
+ * @retval      null 
+ * @par         修改日志 
+ *               Ver0.0.1:
+                    Helon_Chan, 2026/10/17, 初始化版本\n 
+ *               Ver0.0.2:
+                    Helon_Chan, 2026/10/17, 丢弃没收完的半条消息\n 
+ *               Ver0.0.3:
+                    Helon_Chan, 2026/10/17, 登陆后的断开交给gs_keepalive判断是不是服务器空闲超时\n 
  */
-static void tcp_receive_task(void *pvParameters)
+static void big_iot_cloud_closed(cloud_conn_t *conn, int reason)
 {
-  int ret, len;
-  do
+  uint32_t idle_ms = cloud_conn_idle_ms(conn);
+  if (gs_heart_beat_timer >= 0)
   {
-    len = sizeof(gs_recv_buff) - 1;
-    memset(gs_recv_buff, 0, sizeof(gs_recv_buff));
-    ret = mbedtls_ssl_read(tcp_ssl_connect.ssl_ctx, gs_recv_buff, len);
-    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
-    {
-      continue;
-    }
+    keepalive_closed(&gs_keepalive, idle_ms);
+    ESP_LOGI(TAG, "closed after %u ms idle, heart beat interval %u ms\n", idle_ms, gs_keepalive.interval_ms);
+  }
+  gs_heart_beat_timer = -1;
+  line_buf_reset(&gs_line_buf);
+}
 
-    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY)
-    {
-      ESP_LOGI(TAG, "MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY\n");
-      ret = 0;
-      tcp_ssl_parameters_clean();
-      break;
-    }
+/* 连接事件回调,服务器在连接后主动发送WELCOME,不需要on_online */
+static const cloud_conn_cb_t gs_big_iot_cloud_cb =
+{
+  .on_online = NULL,
+  .on_data   = big_iot_cloud_data,
+  .on_closed = big_iot_cloud_closed,
+};
 
-    if (ret < 0)
-    {
-      ESP_LOGI(TAG, "failed\n  ! mbedtls_ssl_read returned %d\n\n", ret);
-      
-    }
-    if (ret == 0)
-    {
-      ESP_LOGI(TAG, "\n\nEOF\n\n");      
-    }
-    else
-    {
-      len = ret;
-      ESP_LOGI(TAG, " %d bytes read\n\n%s", len, gs_recv_buff);
-      json_parse((char*)gs_recv_buff);     
-    }
-  } while (1);
-  vTaskDelete(NULL);
-}
 /** 
 * 通过TCP的方式连接贝壳物联的云平台接口
 * @param[in]   url：表示贝壳物联的云平台接口地址
@@ -398,130 +418,51 @@ static void tcp_receive_task(void *pvParameters)
 * @note        修改日志 
 *               Ver0.0.1: 
                   Helon_Chan, 2018/08/12, 初始化版本\n 
+*               Ver0.0.2: 
+                  Helon_Chan, 2026/10/17, 按BIG_IOT_TLS_PROFILE调整TLS配置,统计握手期间的堆峰值\n 
+*               Ver0.0.3: 
+                  Helon_Chan, 2026/10/17, 只启动连接任务并立即返回,断线后由连接任务自动重连\n 
+*               Ver0.0.4: 
+                  Helon_Chan, 2026/10/17, 启动前填好方法和命令分发表,下标冲突时不连接\n 
+*               Ver0.0.5: 
+                  Helon_Chan, 2026/10/17, 启动前拼好签到、加密签到和心跳帧\n 
+*               Ver0.0.6: 
+                  Helon_Chan, 2026/10/17, 同时初始化心跳间隔,以云平台文档给出的空闲超时为上限\n 
 */
 void big_iot_cloud_connect(const char *url, const char *port)
 {
   int ret;
-  tcp_ssl_connect.net_ctx = (mbedtls_net_context *)os_malloc(sizeof(mbedtls_net_context));  
-  tcp_ssl_connect.entropy = (mbedtls_entropy_context *)os_malloc(sizeof(mbedtls_entropy_context));
-  tcp_ssl_connect.ctr_drbg = (mbedtls_ctr_drbg_context *)os_malloc(sizeof(mbedtls_ctr_drbg_context));
-  tcp_ssl_connect.ssl_ctx = (mbedtls_ssl_context *)os_malloc(sizeof(mbedtls_ssl_context));
-  tcp_ssl_connect.ssl_conf = (mbedtls_ssl_config *)os_malloc(sizeof(mbedtls_ssl_config));
-/*
-  * 0. Initialize the RNG and the session data
-*/
-  mbedtls_net_init(tcp_ssl_connect.net_ctx);
-  mbedtls_ssl_init(tcp_ssl_connect.ssl_ctx);
-  mbedtls_ssl_config_init(tcp_ssl_connect.ssl_conf);  
-  mbedtls_ctr_drbg_init(tcp_ssl_connect.ctr_drbg);
-
-/*
-  * 1. Initialize the RNG and the session data
-*/
-  ESP_LOGI(TAG, "\n  . Seeding the random number generator...");
-
-  mbedtls_entropy_init(tcp_ssl_connect.entropy);
-  if ((ret = mbedtls_ctr_drbg_seed(tcp_ssl_connect.ctr_drbg, mbedtls_entropy_func, tcp_ssl_connect.entropy,
-                                   (const unsigned char *)NULL,
-                                   0)) != 0)
+  /* 重新获取IP时还会调用,连接任务可能正在查表,分发表只填一次 */
+  if (!gs_big_iot_routes_ready)
   {
-    ESP_LOGI(TAG, "failed\n  ! mbedtls_ctr_drbg_seed returned %d\n", ret);
-    tcp_ssl_parameters_clean();
-    return;
-  }
-
-  ESP_LOGI(TAG, " ok\n");
-  
-
-/*
-  * 2. Start the connection
-  * 进行TCP连接
-*/
-  ESP_LOGI(TAG, "  . Connecting to tcp/%s/%s...", url, port);
-  //fflush( stdout );
-
-  if ((ret = mbedtls_net_connect(tcp_ssl_connect.net_ctx, url,
-                                 port, MBEDTLS_NET_PROTO_TCP)) != 0)
-  {
-    ESP_LOGI(TAG, " failed\n  ! mbedtls_net_connect returned %d\n\n", ret);
-    tcp_ssl_parameters_clean();
-    return;
-  }
-
-  ESP_LOGI(TAG, " ok\n");
-
-/*
-  * 3. Setup SSL/TLS相关参数
-*/
-  ESP_LOGI(TAG, "  . Setting up the SSL/TLS structure...");
-
-  if ((ret = mbedtls_ssl_config_defaults(tcp_ssl_connect.ssl_conf,
-                                         MBEDTLS_SSL_IS_CLIENT,
-                                         MBEDTLS_SSL_TRANSPORT_STREAM,
-                                         MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
-  {
-    ESP_LOGI(TAG, " failed\n  ! mbedtls_ssl_config_defaults returned %d\n\n", ret);
-    tcp_ssl_parameters_clean();
-    return;
-  }
-
-  ESP_LOGI(TAG, " ok %d\n", esp_get_free_heap_size());
-
-  /* 由于证书会过期,所以这些不进行证书认证 */
-  mbedtls_ssl_conf_authmode(tcp_ssl_connect.ssl_conf, MBEDTLS_SSL_VERIFY_NONE);
-  /* 设置随机数生成的函数及方法 */
-  mbedtls_ssl_conf_rng(tcp_ssl_connect.ssl_conf, mbedtls_ctr_drbg_random, tcp_ssl_connect.ctr_drbg);
-  /* 这里不需要设置调试函数 */
-  mbedtls_ssl_conf_dbg(tcp_ssl_connect.ssl_conf, NULL, NULL);
-
-  /* 将ssl_conf的相关信息填充于ssl_ctx中去,用于进行SSL握手时使用 */
-  if ((ret = mbedtls_ssl_setup(tcp_ssl_connect.ssl_ctx, tcp_ssl_connect.ssl_conf)) != 0)
-  {
-    ESP_LOGI(TAG, " failed\n  ! mbedtls_ssl_setup returned %d\n\n", ret);
-    tcp_ssl_parameters_clean();
-    return;
-  }
-
-  if ((ret = mbedtls_ssl_set_hostname(tcp_ssl_connect.ssl_ctx, "mbed TLS Server")) != 0)
-  {
-    ESP_LOGI(TAG, " failed\n  ! mbedtls_ssl_set_hostname returned %d\n\n", ret);
-    tcp_ssl_parameters_clean();
-    return;
+    ret = cloud_msg_table_init(gs_big_iot_routes, BIG_IOT_METHOD_SLOTS, gs_big_iot_list,
+                               sizeof(gs_big_iot_list) / sizeof(gs_big_iot_list[0]));
+    if (ret == 0)
+    {
+      ret = cloud_msg_table_init(gs_cloud_cmd_routes, BIG_IOT_CMD_SLOTS, gs_cloud_cmd_list,
+                                 sizeof(gs_cloud_cmd_list) / sizeof(gs_cloud_cmd_list[0]));
+    }
+    if (ret != 0)
+    {
+      ESP_LOGI(TAG, "cloud_msg_table_init failure,reason is -0x%x\n", -ret);
+      return;
+    }
+    gs_big_iot_routes_ready = 1;
   }
-  /* 设置发送以及接收的时候,调用的内部函数 */
-  mbedtls_ssl_set_bio(tcp_ssl_connect.ssl_ctx, tcp_ssl_connect.net_ctx, mbedtls_net_send, mbedtls_net_recv, NULL);
-
-/*
-  * 4. Handshake
-*/
-  ESP_LOGI(TAG, "  . Performing the SSL/TLS handshake...");
-
-  while ((ret = mbedtls_ssl_handshake(tcp_ssl_connect.ssl_ctx)) != 0)
+  /* 连接任务启动后就会用到这些帧和心跳间隔,只初始化一次 */
+  if (gs_cloud_frame.used == 0)
   {
-    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    ret = cloud_frame_init(&gs_cloud_frame, DEVICE_ID, DEVICE_API_KEY, USER_API_KEY);
+    if (ret != 0)
     {
-      ESP_LOGI(TAG, " failed\n  ! mbedtls_ssl_handshake returned -0x%x\n\n", -ret);
-      tcp_ssl_parameters_clean();
-    return;
+      ESP_LOGI(TAG, "cloud_frame_init failure,reason is -0x%x\n", -ret);
+      return;
     }
+    keepalive_init(&gs_keepalive, HEART_BEAT_INTERVAL_MS, BIG_IOT_IDLE_TIMEOUT_MS);
   }
-
-  ESP_LOGI(TAG, " ok\n");
-  
-
-  /*
-    * 5. Read the HTTP response
-  */
-  int err_code = xTaskCreate(tcp_receive_task,
-                             "tcp_receive_task",
-                             1024 * 8,
-                             NULL,
-                             3,
-                             NULL);
-  if (err_code != pdPASS)
+  ret = cloud_conn_start(&gs_cloud_conn, url, port, BIG_IOT_TLS_PROFILE, &gs_big_iot_cloud_cb, NULL);
+  if (ret != 0)
   {
-    ESP_LOGI("event_handler", "tcp_receive_task create failure,reason is %d\n", err_code);
-  }    
+    ESP_LOGI(TAG, "cloud_conn_start failure,reason is -0x%x\n", -ret);
+  }
 }
-
-
@@ -19,6 +19,7 @@
 #include "user_app.h"
 #include <freertos/FreeRTOS.h>
 #include "freertos/task.h"
+#include "user_tls_profile.h"
 /** 
  * 应用程序的函数入口
  * @param[in]   NULL
@@ -26,12 +27,19 @@
  * @par         修改日志 
  *               Ver0.0.1:
                      Helon_Chan, 2018/06/04, 初始化版本\n 
+ *               Ver0.0.2:
+                     Helon_Chan, 2026/10/17, 创建任何任务之前挂上mbedtls的堆统计\n 
  */
 void app_main()
 {
   BaseType_t task_err_code;
   /* 建议保留此输出打印SDK版本,用于以后出问题了可以有溯源 */
   ESP_LOGI("app_main","the esp32 sdk version :%s\n", esp_get_idf_version());
+  /* 之后mbedtls申请的每块内存都带计数头,必须早于任何mbedtls上下文 */
+  if (tls_heap_hook_install() != 0)
+  {
+    ESP_LOGI("app_main", "mbedtls heap hook not available\n");
+  }
   task_err_code = xTaskCreate(startup_initialization_task,"startup_initialization_task",1024*4,NULL,3,NULL);
   if(task_err_code != pdPASS)
   {
@@ -0,0 +1,77 @@
+#ifndef __UDP_BATCH_H__
+#define __UDP_BATCH_H__
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define UDP_BATCH_PKT_NUM       8                   //环形缓存包数，也是一次最多收发的包数
+#define UDP_BATCH_PKT_LEN       1472                //单包最大长度：1500 MTU - IP头 - UDP头
+
+//平台有recvmmsg/sendmmsg时一次系统调用收发多包，lwip没有，退化为循环收发；
+//编译时可以用-DUDP_BATCH_HAVE_MMSG=0指定走循环收发
+#ifndef UDP_BATCH_HAVE_MMSG
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define UDP_BATCH_HAVE_MMSG     1
+#else
+#define UDP_BATCH_HAVE_MMSG     0
+#endif
+#endif
+
+
+//数据包
+typedef struct
+{
+    uint16_t            len;                        //数据长度
+    struct sockaddr_in  addr;                       //对端地址，接收时为来源，发送时为目的
+    uint8_t             data[UDP_BATCH_PKT_LEN];    //数据
+} udp_pkt_t;
+
+//收发统计
+typedef struct
+{
+    uint32_t    rx_pkts;                            //接收包数
+    uint32_t    rx_calls;                           //接收批次
+    uint32_t    tx_pkts;                            //发送包数
+    uint32_t    tx_calls;                           //发送批次
+    uint32_t    tx_errors;                          //发送失败包数
+} udp_batch_stats_t;
+
+//批量收发引擎
+typedef struct
+{
+    int                 sock;                       //udp socket
+    uint32_t            head;                       //最早一个未处理包的位置
+    uint32_t            count;                      //未处理包数
+    udp_batch_stats_t   stats;                      //统计
+    udp_pkt_t           pkt[UDP_BATCH_PKT_NUM];     //预分配的包环形缓存
+} udp_batch_t;
+
+
+//init engine on a udp socket
+void udp_batch_init(udp_batch_t *b, int sock);
+
+//wait for at least one datagram, then drain what is queued into free ring slots. return: packets received, <0:error
+int udp_batch_recv(udp_batch_t *b);
+
+//oldest unprocessed packet, NULL:ring empty
+udp_pkt_t *udp_batch_peek(udp_batch_t *b);
+
+//release n oldest packets
+void udp_batch_release(udp_batch_t *b, uint32_t n);
+
+//send n packets, each to its own addr. return: packets sent, <0:error
+int udp_batch_send(udp_batch_t *b, udp_pkt_t **pkts, int n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /*#ifndef __UDP_BATCH_H__*/
@@ -18,6 +18,9 @@ extern "C" {
 #endif
 
 #define UDP_SERVER_CLIENT_OPTION FALSE              //esp32作为client
+#define UDP_RELIABLE_OPTION     FALSE               //TRUE:收发走可靠udp(序号+确认+重传)，对端也需要使用udp_reliable
+#define UDP_COALESCE_OPTION     FALSE               //TRUE:udp_send_data的小消息合并成一个数据报发送，对端用udp_coalesce_split拆包，不能和可靠udp同时打开
+#define UDP_COALESCE_BUDGET_MS  20                  //合并时第一条消息最多等待的时间
 #define TAG                     "HX-UDP"            //打印的tag
 
 //client
@@ -46,6 +49,9 @@ esp_err_t create_udp_client();
 //收发数据
 void recv_data(void *pvParameters);
 
+//send len bytes to server, coalesced or reliable per option. return: 0 ok, <0:error
+int udp_send_data(const void *data, size_t len);
+
 //close all socket
 void close_socket();
 
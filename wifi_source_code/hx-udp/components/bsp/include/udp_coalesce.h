@@ -0,0 +1,69 @@
+#ifndef __UDP_COALESCE_H__
+#define __UDP_COALESCE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define UDP_COALESCE_MTU        1472                //合并后数据报最大长度：1500 MTU - IP头 - UDP头
+#define UDP_COALESCE_HDR_LEN    2                   //每条消息前的长度头，大端
+#define UDP_COALESCE_MAX_MSG    (UDP_COALESCE_MTU - UDP_COALESCE_HDR_LEN)   //单条消息最大长度
+#define UDP_COALESCE_IDLE       0x7fffffff          //udp_coalesce_poll：没有待发消息
+
+
+//拆包回调，每条消息调用一次
+typedef void (*udp_coalesce_msg_cb_t)(void *arg, const uint8_t *data, size_t len);
+
+//统计，字节效率 = payload_bytes / wire_bytes，datagrams / payload_bytes 越小越省空口
+typedef struct
+{
+    uint32_t    msgs;                               //提交的消息数
+    uint32_t    payload_bytes;                      //消息数据字节
+    uint32_t    datagrams;                          //实际发出的数据报
+    uint32_t    wire_bytes;                         //实际发出的udp负载字节(含长度头)
+    uint32_t    flush_full;                         //因装不下而发出
+    uint32_t    flush_timeout;                      //因等待超过时延预算而发出
+    uint32_t    tx_errors;                          //发送失败
+} udp_coalesce_stats_t;
+
+//小消息合并器，发往一个固定对端
+typedef struct
+{
+    int                     sock;                   //udp socket
+    struct sockaddr_in      peer;                   //对端地址
+    uint32_t                budget_ms;              //第一条消息最多等待多久，0表示不合并
+    uint32_t                first_ms;               //缓存中第一条消息的提交时刻
+    uint16_t                len;                    //缓存已用长度
+    udp_coalesce_stats_t    stats;                  //统计
+    uint8_t                 buf[UDP_COALESCE_MTU];  //合并缓存
+} udp_coalesce_t;
+
+
+//init coalescer for one peer, budget_ms 0: send every message at once
+void udp_coalesce_init(udp_coalesce_t *c, int sock, const struct sockaddr_in *peer, uint32_t budget_ms);
+
+//queue one message, flush first if it does not fit. return: 0 ok, -1:send error, -2:too long
+int udp_coalesce_put(udp_coalesce_t *c, const void *data, size_t len, uint32_t now_ms);
+
+//flush when the latency budget is spent. return: ms until next flush, UDP_COALESCE_IDLE:nothing queued
+int32_t udp_coalesce_poll(udp_coalesce_t *c, uint32_t now_ms);
+
+//send what is queued now. return: 0 ok or nothing queued, -1:send error
+int udp_coalesce_flush(udp_coalesce_t *c);
+
+//split a received coalesced datagram. return: messages found, -1:malformed
+int udp_coalesce_split(const uint8_t *data, size_t len, udp_coalesce_msg_cb_t cb, void *arg);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /*#ifndef __UDP_COALESCE_H__*/
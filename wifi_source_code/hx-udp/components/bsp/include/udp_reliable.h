@@ -0,0 +1,111 @@
+#ifndef __UDP_RELIABLE_H__
+#define __UDP_RELIABLE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define RUDP_WINDOW             16                  //发送窗口包数，不能超过32(SACK位图宽度)
+#define RUDP_MAX_PAYLOAD        512                 //单包最大数据长度
+#define RUDP_DATA_HDR_LEN       16                  //数据包头：类型1 标志1 长度2 序号4 会话4 发送端最早未确认序号4
+#define RUDP_ACK_LEN            16                  //确认包：类型1 标志1 保留2 累计确认4 会话4 SACK位图4
+#define RUDP_RTO_INIT_MS        1000                //首个RTT样本前的重传超时
+#define RUDP_RTO_MIN_MS         200                 //重传超时下限
+#define RUDP_RTO_MAX_MS         8000                //重传超时上限
+#define RUDP_MAX_RETRIES        8                   //单包最多重传次数，超过认为对端失联
+#define RUDP_FAST_RETRANSMIT    3                   //后面有3个包已被SACK确认时立即重传空洞
+
+#define RUDP_TYPE_DATA          0xd1                //数据包
+#define RUDP_TYPE_ACK           0xa1                //确认包
+#define RUDP_POLL_IDLE          0x7fffffff          //rudp_poll：没有待确认的包
+
+
+//收到新数据包的回调，不等前面丢失的包，到达即交付
+typedef void (*rudp_recv_cb_t)(void *arg, uint32_t seq, const uint8_t *data, size_t len);
+
+//发送一个数据报，默认用sendto发往对端，可替换成丢包/乱序模拟
+typedef int (*rudp_output_t)(void *arg, const uint8_t *data, size_t len);
+
+//发送窗口中的一个包
+typedef struct
+{
+    uint32_t    seq;                                //序号
+    uint32_t    sent_ms;                            //最近一次发送时刻
+    uint16_t    len;                                //数据长度(含包头)
+    uint8_t     in_use;                             //未确认
+    uint8_t     retries;                            //已重传次数
+    uint8_t     fast_sent;                          //已做过快速重传
+    uint8_t     buf[RUDP_DATA_HDR_LEN + RUDP_MAX_PAYLOAD];
+} rudp_slot_t;
+
+//统计
+typedef struct
+{
+    uint32_t    tx_data;                            //首次发送的数据包
+    uint32_t    tx_retrans;                         //超时重传
+    uint32_t    tx_fast_retrans;                    //快速重传
+    uint32_t    tx_acks;                            //发送确认包
+    uint32_t    rx_data;                            //收到的新数据包
+    uint32_t    rx_dup;                             //收到的重复数据包
+    uint32_t    rx_acks;                            //收到的确认包
+    uint32_t    acked;                              //已被确认的数据包
+    uint32_t    give_up;                            //超过重传次数放弃的包
+} rudp_stats_t;
+
+//可靠udp端点，一端同时负责发送和接收
+typedef struct
+{
+    int                 sock;                       //udp socket
+    struct sockaddr_in  peer;                       //对端地址
+    rudp_output_t       output;                     //发送函数
+    void                *output_arg;                //发送函数参数
+    rudp_recv_cb_t      recv_cb;                    //接收回调
+    void                *recv_arg;                  //接收回调参数
+    uint32_t            session;                    //本端会话号，对端重启后可区分新旧序号
+    //发送
+    uint32_t            snd_una;                    //最早未确认序号
+    uint32_t            snd_nxt;                    //下一个发送序号
+    uint32_t            srtt_ms;                    //平滑RTT，0表示还没有样本
+    uint32_t            rttvar_ms;                  //RTT偏差
+    uint32_t            rto_ms;                     //重传超时
+    rudp_slot_t         slot[RUDP_WINDOW];          //发送窗口
+    //接收
+    uint32_t            peer_session;               //对端会话号
+    uint32_t            rcv_nxt;                    //期待的下一个序号，之前的都已收到
+    uint32_t            rcv_mask;                   //bit i表示rcv_nxt+i已收到
+    rudp_stats_t        stats;                      //统计
+} rudp_t;
+
+
+//init endpoint, output NULL: sendto peer on sock
+void rudp_init(rudp_t *r, int sock, const struct sockaddr_in *peer, uint32_t session,
+               rudp_recv_cb_t recv_cb, void *recv_arg);
+
+//replace datagram output, e.g. with a loss/reorder shim
+void rudp_set_output(rudp_t *r, rudp_output_t output, void *arg);
+
+//queue and send one message. return: seq >= 0, -1:window full, -2:too long
+int32_t rudp_send(rudp_t *r, const void *data, size_t len, uint32_t now_ms);
+
+//feed one received datagram. return: 0 ok, <0 not a rudp packet
+int rudp_input(rudp_t *r, const uint8_t *data, size_t len, uint32_t now_ms);
+
+//run retransmit timers. return: ms until next timer, RUDP_POLL_IDLE:nothing in flight, <0:peer lost
+int32_t rudp_poll(rudp_t *r, uint32_t now_ms);
+
+//packets in flight
+uint32_t rudp_in_flight(const rudp_t *r);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /*#ifndef __UDP_RELIABLE_H__*/
@@ -0,0 +1,251 @@
+/*
+* @file         udp_batch.c
+* @brief        udp批量收发
+* @details      预分配一圈包缓存，一次等待后把socket里排队的数据报全部收进来，
+*               回发时一批发出，减少每包一次recvfrom/sendto和清空缓存的开销
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                 //recvmmsg/sendmmsg
+#endif
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include "udp_batch.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/*
+* 初始化批量收发
+* @param[in]   b  		           :收发引擎
+* @param[in]   sock  		       :udp socket
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void udp_batch_init(udp_batch_t *b, int sock)
+{
+    memset(&b->stats, 0, sizeof(b->stats));
+    b->sock = sock;
+    b->head = 0;
+    b->count = 0;
+}
+
+#if UDP_BATCH_HAVE_MMSG
+/*
+* 用recvmmsg一次收多包
+* @param[in]   b  		           :收发引擎
+* @param[in]   slot  		       :第一个空闲包位置
+* @param[in]   n  		           :最多接收包数，不跨越环尾
+* @retval      int                 :接收包数，<0失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int udp_batch_recv_slots(udp_batch_t *b, uint32_t slot, uint32_t n)
+{
+    struct mmsghdr msgs[UDP_BATCH_PKT_NUM];
+    struct iovec iov[UDP_BATCH_PKT_NUM];
+    int ret;
+
+    memset(msgs, 0, sizeof(struct mmsghdr) * n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        iov[i].iov_base = b->pkt[slot + i].data;
+        iov[i].iov_len = UDP_BATCH_PKT_LEN;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &b->pkt[slot + i].addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+    //阻塞到第一包，之后有多少收多少
+    ret = recvmmsg(b->sock, msgs, n, MSG_WAITFORONE, NULL);
+    for (int i = 0; i < ret; i++)
+    {
+        b->pkt[slot + i].len = msgs[i].msg_len;
+    }
+    return ret;
+}
+#else
+/*
+* 循环recvfrom收多包：第一包阻塞等待，后续不阻塞
+* @param[in]   b  		           :收发引擎
+* @param[in]   slot  		       :第一个空闲包位置
+* @param[in]   n  		           :最多接收包数，不跨越环尾
+* @retval      int                 :接收包数，<0失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int udp_batch_recv_slots(udp_batch_t *b, uint32_t slot, uint32_t n)
+{
+    socklen_t socklen;
+    int len;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        udp_pkt_t *pkt = &b->pkt[slot + i];
+        socklen = sizeof(pkt->addr);
+        len = recvfrom(b->sock, pkt->data, UDP_BATCH_PKT_LEN, i == 0 ? 0 : MSG_DONTWAIT,
+                       (struct sockaddr *)&pkt->addr, &socklen);
+        if (len < 0)
+        {
+            //队列已收空
+            if (i > 0 && (errno == EWOULDBLOCK || errno == EAGAIN))
+            {
+                break;
+            }
+            return i > 0 ? (int)i : -1;
+        }
+        pkt->len = len;
+    }
+    return i;
+}
+#endif
+
+/*
+* 等待数据报并把已排队的数据报收进环形缓存
+* @param[in]   b  		           :收发引擎
+* @retval      int                 :本次接收包数，<0失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int udp_batch_recv(udp_batch_t *b)
+{
+    uint32_t slot, n;
+    int ret;
+
+    if (b->count == UDP_BATCH_PKT_NUM)
+    {
+        return 0;
+    }
+    //从第一个空闲位置收到环尾或收满
+    slot = (b->head + b->count) % UDP_BATCH_PKT_NUM;
+    n = UDP_BATCH_PKT_NUM - b->count;
+    if (slot + n > UDP_BATCH_PKT_NUM)
+    {
+        n = UDP_BATCH_PKT_NUM - slot;
+    }
+    ret = udp_batch_recv_slots(b, slot, n);
+    if (ret > 0)
+    {
+        b->count += ret;
+        b->stats.rx_pkts += ret;
+        b->stats.rx_calls++;
+    }
+    return ret;
+}
+
+/*
+* 取最早一个未处理的包
+* @param[in]   b  		           :收发引擎
+* @retval      udp_pkt_t*          :数据包，NULL表示没有
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+udp_pkt_t *udp_batch_peek(udp_batch_t *b)
+{
+    return b->count ? &b->pkt[b->head] : NULL;
+}
+
+/*
+* 释放最早的n个包
+* @param[in]   b  		           :收发引擎
+* @param[in]   n  		           :包数
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void udp_batch_release(udp_batch_t *b, uint32_t n)
+{
+    if (n > b->count)
+    {
+        n = b->count;
+    }
+    b->head = (b->head + n) % UDP_BATCH_PKT_NUM;
+    b->count -= n;
+}
+
+/*
+* 批量发送，每个包发往自己的addr，包缓存可以直接用接收到的包
+* @param[in]   b  		           :收发引擎
+* @param[in]   pkts  		       :数据包数组
+* @param[in]   n  		           :包数
+* @retval      int                 :发送成功包数，<0失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int udp_batch_send(udp_batch_t *b, udp_pkt_t **pkts, int n)
+{
+    int done = 0;
+    int ok = 0;
+    int ret;
+#if UDP_BATCH_HAVE_MMSG
+    struct mmsghdr msgs[UDP_BATCH_PKT_NUM];
+    struct iovec iov[UDP_BATCH_PKT_NUM];
+
+    while (done < n)
+    {
+        int cnt = n - done > UDP_BATCH_PKT_NUM ? UDP_BATCH_PKT_NUM : n - done;
+        memset(msgs, 0, sizeof(struct mmsghdr) * cnt);
+        for (int i = 0; i < cnt; i++)
+        {
+            udp_pkt_t *pkt = pkts[done + i];
+            iov[i].iov_base = pkt->data;
+            iov[i].iov_len = pkt->len;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &pkt->addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(pkt->addr);
+        }
+        ret = sendmmsg(b->sock, msgs, cnt, 0);
+        b->stats.tx_calls++;
+        if (ret <= 0)
+        {
+            //这一批的第一包发送失败，跳过它继续发后面的
+            b->stats.tx_errors++;
+            done++;
+            continue;
+        }
+        done += ret;
+        ok += ret;
+    }
+#else
+    for (done = 0; done < n; done++)
+    {
+        udp_pkt_t *pkt = pkts[done];
+        ret = sendto(b->sock, pkt->data, pkt->len, 0,
+                     (struct sockaddr *)&pkt->addr, sizeof(pkt->addr));
+        if (ret < 0)
+        {
+            b->stats.tx_errors++;
+            continue;
+        }
+        ok++;
+    }
+    b->stats.tx_calls++;
+#endif
+    b->stats.tx_pkts += ok;
+    return (ok == 0 && n > 0) ? -1 : ok;
+}
@@ -8,6 +8,14 @@
 * @par History:          
 *               Ver0.0.1:
                      hx-zsj, 2018/08/10, 初始化版本\n 
+*               Ver0.0.2:
+                     hx-zsj, 2026/10/17, 接收改为批量收发\n 
+*               Ver0.0.3:
+                     hx-zsj, 2026/10/17, 增加可靠udp收发选项\n 
+*               Ver0.0.4:
+                     hx-zsj, 2026/10/17, 按实际长度发送，增加小消息合并选项\n 
+*               Ver0.0.5:
+                     hx-zsj, 2026/10/17, 合并选项打开时接收端拆包，回发也经过合并器\n 
 */
 
 /* 
@@ -20,10 +28,18 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event_loop.h"
 #include "esp_log.h"
 #include "udp_bsp.h"
+#include "udp_batch.h"
+#include "udp_reliable.h"
+#include "udp_coalesce.h"
+
+#if UDP_RELIABLE_OPTION && UDP_COALESCE_OPTION
+#error "UDP_RELIABLE_OPTION和UDP_COALESCE_OPTION不能同时为TRUE：可靠udp的包不经过合并器"
+#endif
 
 /*
 ===========================
@@ -33,8 +49,14 @@
 EventGroupHandle_t udp_event_group;                     //wifi建立成功信号量
 
 struct sockaddr_in client_addr;                  //client地址
-static unsigned int socklen = sizeof(client_addr);      //地址长度
 int connect_socket=0;                          //连接socket
+static udp_batch_t udp_batch;                   //批量收发的包缓存
+#if UDP_RELIABLE_OPTION
+static rudp_t udp_rudp;                         //可靠udp端点
+#endif
+#if UDP_COALESCE_OPTION
+static udp_coalesce_t udp_coalesce;             //小消息合并器
+#endif
 /*
 ===========================
 函数声明
@@ -76,6 +98,119 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
 
 
 
+#if UDP_RELIABLE_OPTION || UDP_COALESCE_OPTION
+/*
+* 当前毫秒时刻，给可靠udp和消息合并计时
+* @param[in]   void  		       :无
+* @retval      uint32_t            :毫秒
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static uint32_t udp_now_ms()
+{
+    return (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+#endif
+
+#if UDP_RELIABLE_OPTION
+/*
+* 可靠udp收到新数据：打印并原样回发
+* @param[in]   arg  		       :无
+* @param[in]   seq  		       :序号
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :长度
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void udp_rudp_recv_cb(void *arg, uint32_t seq, const uint8_t *data, size_t len)
+{
+    ESP_LOGI(TAG, "UDP Client recvData seq %u: %.*s", seq, (int)len, (const char *)data);
+    if (rudp_send(&udp_rudp, data, len, udp_now_ms()) < 0)
+    {
+        ESP_LOGW(TAG, "rudp window full, drop echo seq %u", seq);
+    }
+}
+
+/*
+* 接收数据任务，可靠udp版本：select等到收包或重传定时到期
+* @param[in]   void  		       :无
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+void recv_data(void *pvParameters)
+{
+    int n = 0;                          //本次收到的包数
+    int32_t wait_ms;                    //距离下一次重传的时间
+    fd_set read_set;
+    struct timeval tv;
+    udp_pkt_t *pkt;
+    udp_batch_init(&udp_batch, connect_socket);
+    while (1)
+    {
+        wait_ms = rudp_poll(&udp_rudp, udp_now_ms());
+        if (wait_ms < 0)
+        {
+            ESP_LOGW(TAG, "rudp peer lost, give up %u packets", udp_rudp.stats.give_up);
+            continue;
+        }
+        FD_ZERO(&read_set);
+        FD_SET(connect_socket, &read_set);
+        tv.tv_sec = wait_ms / 1000;
+        tv.tv_usec = (wait_ms % 1000) * 1000;
+        n = select(connect_socket + 1, &read_set, NULL, NULL, wait_ms == RUDP_POLL_IDLE ? NULL : &tv);
+        if (n == 0)
+        {
+            //重传定时到期
+            continue;
+        }
+        //socket已可读，第一包不会阻塞
+        n = n > 0 ? udp_batch_recv(&udp_batch) : -1;
+        if (n < 0)
+        {
+            //打印错误信息
+            show_socket_error_reason("UDP Client recv_data", connect_socket);
+            break;
+        }
+        while ((pkt = udp_batch_peek(&udp_batch)) != NULL)
+        {
+            if (rudp_input(&udp_rudp, pkt->data, pkt->len, udp_now_ms()) < 0)
+            {
+                ESP_LOGW(TAG, "drop non rudp packet len %u", pkt->len);
+            }
+            udp_batch_release(&udp_batch, 1);
+        }
+    }
+    close_socket();
+
+    vTaskDelete(NULL);
+}
+#else
+#if UDP_COALESCE_OPTION
+/*
+* 合并数据报拆出的一条消息：打印并经合并器回发
+* @param[in]   arg  		       :无
+* @param[in]   data  		       :消息
+* @param[in]   len  		       :长度
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void udp_coalesce_recv_cb(void *arg, const uint8_t *data, size_t len)
+{
+    ESP_LOGI(TAG, "UDP Client recvMsg: %.*s", (int)len, (const char *)data);
+    if (udp_coalesce_put(&udp_coalesce, data, len, udp_now_ms()) < 0)
+    {
+        ESP_LOGW(TAG, "coalesce echo failed, len %u", len);
+    }
+}
+#endif
+
 /*
 * 接收数据任务
 * @param[in]   void  		       :无
@@ -83,27 +218,73 @@ static esp_err_t event_handler(void *ctx, system_event_t *event)
 * @note        修改日志 
 *               Ver0.0.1:
                     hx-zsj, 2018/08/06, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 改为批量收发，不再每包清空缓存\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 合并发送时按时延预算定时发出\n 
+*               Ver0.0.4:
+                    hx-zsj, 2026/10/17, 合并选项打开时用udp_coalesce_split拆包，逐条经合并器回发\n 
 */
 void recv_data(void *pvParameters)
 {
-    int len = 0;            //长度
-    char databuff[1024];    //缓存
+    int n = 0;                          //本次收到的包数
+#if !UDP_COALESCE_OPTION
+    udp_pkt_t *echo[UDP_BATCH_PKT_NUM]; //回发的包，直接用接收缓存
+#endif
+    udp_pkt_t *pkt;
+#if UDP_COALESCE_OPTION
+    int32_t wait_ms;                    //距离合并缓存到期的时间
+    fd_set read_set;
+    struct timeval tv;
+#endif
+    udp_batch_init(&udp_batch, connect_socket);
     while (1)
     {
-        //清空缓存
-        memset(databuff, 0x00, sizeof(databuff));
-
-        //读取接收数据
-		len = recvfrom(connect_socket, databuff, sizeof(databuff), 0,
-				(struct sockaddr *) &client_addr, &socklen);
-        if (len > 0)
+#if UDP_COALESCE_OPTION
+        //合并缓存里有消息时，最多等到时延预算用完
+        wait_ms = udp_coalesce_poll(&udp_coalesce, udp_now_ms());
+        if (wait_ms != UDP_COALESCE_IDLE)
         {
-            //打印接收到的数组
-            ESP_LOGI(TAG, "UDP Client recvData: %s", databuff);
-            //接收数据回发
-            sendto(connect_socket, databuff, strlen(databuff), 0,
-			            (struct sockaddr *) &client_addr, sizeof(client_addr));
+            FD_ZERO(&read_set);
+            FD_SET(connect_socket, &read_set);
+            tv.tv_sec = wait_ms / 1000;
+            tv.tv_usec = (wait_ms % 1000) * 1000;
+            if (select(connect_socket + 1, &read_set, NULL, NULL, &tv) == 0)
+            {
+                continue;
+            }
         }
+#endif
+        //等待数据报，并把socket里排队的数据报一次收完
+        n = udp_batch_recv(&udp_batch);
+#if UDP_COALESCE_OPTION
+        if (n > 0)
+        {
+            //对端同样按合并格式发送，拆出每条消息后回发也走合并器，多条回发合成一个数据报
+            while ((pkt = udp_batch_peek(&udp_batch)) != NULL)
+            {
+                if (udp_coalesce_split(pkt->data, pkt->len, udp_coalesce_recv_cb, NULL) < 0)
+                {
+                    ESP_LOGW(TAG, "drop malformed coalesced packet len %u", pkt->len);
+                }
+                udp_batch_release(&udp_batch, 1);
+            }
+        }
+#else
+        if (n > 0)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                pkt = &udp_batch.pkt[(udp_batch.head + i) % UDP_BATCH_PKT_NUM];
+                //打印接收到的数组，按实际长度打印
+                ESP_LOGI(TAG, "UDP Client recvData: %.*s", pkt->len, (char *)pkt->data);
+                //接收数据回发给各自的来源地址
+                echo[i] = pkt;
+            }
+            udp_batch_send(&udp_batch, echo, n);
+            udp_batch_release(&udp_batch, n);
+        }
+#endif
         else
         {
             //打印错误信息
@@ -115,6 +296,29 @@ void recv_data(void *pvParameters)
 
     vTaskDelete(NULL);
 }
+#endif
+/*
+* 向服务器发送数据，按实际长度发送；合并器和可靠udp端点不加锁，
+* 建立连接后应在recv_data任务中调用
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :长度
+* @retval      int                 :0成功，<0失败
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+int udp_send_data(const void *data, size_t len)
+{
+#if UDP_RELIABLE_OPTION
+    return rudp_send(&udp_rudp, data, len, udp_now_ms()) < 0 ? -1 : 0;
+#elif UDP_COALESCE_OPTION
+    return udp_coalesce_put(&udp_coalesce, data, len, udp_now_ms());
+#else
+    return sendto(connect_socket, data, len, 0, (struct sockaddr *)&client_addr,
+                  sizeof(client_addr)) == (int)len ? 0 : -1;
+#endif
+}
+
 /*
 * 建立udp client
 * @param[in]   void  		       :无
@@ -124,6 +328,10 @@ void recv_data(void *pvParameters)
                     hx-zsj, 2018/08/06, 初始化版本\n 
 *               Ver0.0.12:
                     hx-zsj, 2018/08/09, 增加close socket\n 
+*               Ver0.0.13:
+                    hx-zsj, 2026/10/17, 增加可靠udp发送\n 
+*               Ver0.0.14:
+                    hx-zsj, 2026/10/17, 按实际长度发送，不再固定发1024字节\n 
 */
 esp_err_t create_udp_client()
 {
@@ -146,19 +354,26 @@ esp_err_t create_udp_client()
     client_addr.sin_addr.s_addr = inet_addr(UDP_ADRESS);
     
 
-    int len = 0;            //长度
-    char databuff[1024] = "Hello Server,Please ack!!";    //缓存
-    //测试udp server,返回发送成功的长度
-	len = sendto(connect_socket, databuff, 1024, 0, (struct sockaddr *) &client_addr,
-			sizeof(client_addr));
-	if (len > 0) {
-		ESP_LOGI(TAG, "Transfer data to %s:%u,ssucceed\n",
-				inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
-	} else {
+#if UDP_RELIABLE_OPTION
+    //会话号取随机数，对端据此区分重启前后的序号
+    rudp_init(&udp_rudp, connect_socket, &client_addr, esp_random(), udp_rudp_recv_cb, NULL);
+#elif UDP_COALESCE_OPTION
+    udp_coalesce_init(&udp_coalesce, connect_socket, &client_addr, UDP_COALESCE_BUDGET_MS);
+#endif
+
+    const char *hello = "Hello Server,Please ack!!";
+    //测试udp server，只发送实际长度
+    if (udp_send_data(hello, strlen(hello)) == 0)
+    {
+        ESP_LOGI(TAG, "Transfer data to %s:%u,ssucceed\n",
+                 inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
+    }
+    else
+    {
         show_socket_error_reason("recv_data", connect_socket);
-		close(connect_socket);
-		return ESP_FAIL;
-	}
+        close(connect_socket);
+        return ESP_FAIL;
+    }
     return ESP_OK;
 }
 
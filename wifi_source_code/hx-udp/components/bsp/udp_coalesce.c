@@ -0,0 +1,182 @@
+/*
+* @file         udp_coalesce.c
+* @brief        udp小消息合并发送
+* @details      每条消息加2字节长度头后拼进一个MTU大小的缓存，装满或第一条消息
+*               等待超过时延预算才发出，减少2.4G信道上小包的空口开销；
+*               接收端用udp_coalesce_split拆回原消息
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#include <string.h>
+#include <sys/socket.h>
+#include "udp_coalesce.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+/*
+* 初始化合并器
+* @param[in]   c  		           :合并器
+* @param[in]   sock  		       :udp socket
+* @param[in]   peer  		       :对端地址
+* @param[in]   budget_ms  		   :时延预算，0表示每条消息立即发送
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void udp_coalesce_init(udp_coalesce_t *c, int sock, const struct sockaddr_in *peer, uint32_t budget_ms)
+{
+    memset(c, 0, sizeof(*c));
+    c->sock = sock;
+    c->peer = *peer;
+    c->budget_ms = budget_ms;
+}
+
+/*
+* 发出缓存中的消息
+* @param[in]   c  		           :合并器
+* @retval      int                 :0成功或缓存为空，-1发送失败
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int udp_coalesce_flush(udp_coalesce_t *c)
+{
+    int ret;
+    if (c->len == 0)
+    {
+        return 0;
+    }
+    //按实际长度发送
+    ret = sendto(c->sock, c->buf, c->len, 0, (struct sockaddr *)&c->peer, sizeof(c->peer));
+    if (ret < 0)
+    {
+        c->stats.tx_errors++;
+    }
+    else
+    {
+        c->stats.datagrams++;
+        c->stats.wire_bytes += c->len;
+    }
+    c->len = 0;
+    return ret < 0 ? -1 : 0;
+}
+
+/*
+* 提交一条消息，装不下时先把缓存发出
+* @param[in]   c  		           :合并器
+* @param[in]   data  		       :消息
+* @param[in]   len  		       :长度
+* @param[in]   now_ms  		       :当前时刻
+* @retval      int                 :0成功，-1发送失败，-2消息过长
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int udp_coalesce_put(udp_coalesce_t *c, const void *data, size_t len, uint32_t now_ms)
+{
+    int ret = 0;
+    if (len > UDP_COALESCE_MAX_MSG)
+    {
+        return -2;
+    }
+    if (c->len + UDP_COALESCE_HDR_LEN + len > UDP_COALESCE_MTU)
+    {
+        c->stats.flush_full++;
+        ret = udp_coalesce_flush(c);
+    }
+    if (c->len == 0)
+    {
+        c->first_ms = now_ms;
+    }
+    c->buf[c->len] = len >> 8;
+    c->buf[c->len + 1] = len;
+    memcpy(c->buf + c->len + UDP_COALESCE_HDR_LEN, data, len);
+    c->len += UDP_COALESCE_HDR_LEN + len;
+    c->stats.msgs++;
+    c->stats.payload_bytes += len;
+    //不合并或者已经放不下任何一条消息，立即发出
+    if (c->budget_ms == 0 || c->len + UDP_COALESCE_HDR_LEN >= UDP_COALESCE_MTU)
+    {
+        if (udp_coalesce_flush(c) < 0)
+        {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/*
+* 检查时延预算，到期则发出缓存
+* @param[in]   c  		           :合并器
+* @param[in]   now_ms  		       :当前时刻
+* @retval      int32_t             :距离下次需要发送的毫秒数，UDP_COALESCE_IDLE缓存为空
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int32_t udp_coalesce_poll(udp_coalesce_t *c, uint32_t now_ms)
+{
+    int32_t remain;
+    if (c->len == 0)
+    {
+        return UDP_COALESCE_IDLE;
+    }
+    remain = (int32_t)c->budget_ms - (int32_t)(now_ms - c->first_ms);
+    if (remain > 0)
+    {
+        return remain;
+    }
+    c->stats.flush_timeout++;
+    udp_coalesce_flush(c);
+    return UDP_COALESCE_IDLE;
+}
+
+/*
+* 拆分一个合并后的数据报
+* @param[in]   data  		       :数据报
+* @param[in]   len  		       :长度
+* @param[in]   cb  		           :每条消息的回调
+* @param[in]   arg  		       :回调参数
+* @retval      int                 :消息条数，-1格式错误(已拆出的消息仍会回调)
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int udp_coalesce_split(const uint8_t *data, size_t len, udp_coalesce_msg_cb_t cb, void *arg)
+{
+    size_t pos = 0;
+    size_t msg_len;
+    int n = 0;
+    while (pos < len)
+    {
+        if (len - pos < UDP_COALESCE_HDR_LEN)
+        {
+            return -1;
+        }
+        msg_len = ((size_t)data[pos] << 8) | data[pos + 1];
+        pos += UDP_COALESCE_HDR_LEN;
+        if (msg_len > len - pos)
+        {
+            return -1;
+        }
+        cb(arg, data + pos, msg_len);
+        pos += msg_len;
+        n++;
+    }
+    return n;
+}
@@ -0,0 +1,458 @@
+/*
+* @file         udp_reliable.c
+* @brief        可靠udp：序号、选择确认窗口、RTT估计和超时重传
+* @details      发送端维护一个固定大小的发送窗口，接收端用累计确认+32位SACK位图回复，
+*               丢失的包按RTO超时重传或被SACK发现后快速重传；
+*               接收端到达即交付，不像TCP那样被前面丢失的包阻塞。
+*               时间由调用者传入，收包由调用者喂入，方便和批量收发配合
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#include <string.h>
+#include <sys/socket.h>
+#include "udp_reliable.h"
+
+/*
+===========================
+函数定义
+===========================
+*/
+
+//序号和时间都是32位回绕计数，用差值比较先后
+#define SEQ_BEFORE(a, b)        ((int32_t)((a) - (b)) < 0)
+#define TIME_DIFF(a, b)         ((int32_t)((a) - (b)))
+
+/*
+* 大端写入/读取32位
+*/
+static void rudp_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static uint32_t rudp_get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/*
+* 默认发送函数：sendto发往对端
+* @param[in]   arg  		       :rudp端点
+* @param[in]   data  		       :数据报
+* @param[in]   len  		       :长度
+* @retval      int                 :sendto返回值
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int rudp_sendto(void *arg, const uint8_t *data, size_t len)
+{
+    rudp_t *r = (rudp_t *)arg;
+    return sendto(r->sock, data, len, 0, (struct sockaddr *)&r->peer, sizeof(r->peer));
+}
+
+/*
+* 初始化可靠udp端点
+* @param[in]   r  		           :端点
+* @param[in]   sock  		       :udp socket
+* @param[in]   peer  		       :对端地址
+* @param[in]   session  		   :本端会话号，建议每次启动取随机数
+* @param[in]   recv_cb  		   :接收回调
+* @param[in]   recv_arg  		   :接收回调参数
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void rudp_init(rudp_t *r, int sock, const struct sockaddr_in *peer, uint32_t session,
+               rudp_recv_cb_t recv_cb, void *recv_arg)
+{
+    memset(r, 0, sizeof(*r));
+    r->sock = sock;
+    if (peer)
+    {
+        r->peer = *peer;
+    }
+    r->output = rudp_sendto;
+    r->output_arg = r;
+    r->recv_cb = recv_cb;
+    r->recv_arg = recv_arg;
+    r->session = session;
+    r->rto_ms = RUDP_RTO_INIT_MS;
+}
+
+/*
+* 替换发送函数
+* @param[in]   r  		           :端点
+* @param[in]   output  		       :发送函数
+* @param[in]   arg  		       :发送函数参数
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void rudp_set_output(rudp_t *r, rudp_output_t output, void *arg)
+{
+    r->output = output;
+    r->output_arg = arg;
+}
+
+/*
+* 未确认的包数
+* @param[in]   r  		           :端点
+* @retval      uint32_t            :包数
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+uint32_t rudp_in_flight(const rudp_t *r)
+{
+    return r->snd_nxt - r->snd_una;
+}
+
+/*
+* 发送一个消息，放进发送窗口等待确认
+* @param[in]   r  		           :端点
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :长度
+* @param[in]   now_ms  		       :当前时刻
+* @retval      int32_t             :序号，-1窗口已满，-2数据过长
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int32_t rudp_send(rudp_t *r, const void *data, size_t len, uint32_t now_ms)
+{
+    rudp_slot_t *s;
+    if (len > RUDP_MAX_PAYLOAD)
+    {
+        return -2;
+    }
+    if (rudp_in_flight(r) >= RUDP_WINDOW)
+    {
+        return -1;
+    }
+    s = &r->slot[r->snd_nxt % RUDP_WINDOW];
+    s->seq = r->snd_nxt;
+    s->len = RUDP_DATA_HDR_LEN + len;
+    s->in_use = 1;
+    s->retries = 0;
+    s->fast_sent = 0;
+    s->sent_ms = now_ms;
+    s->buf[0] = RUDP_TYPE_DATA;
+    s->buf[1] = 0;
+    s->buf[2] = len >> 8;
+    s->buf[3] = len;
+    rudp_put32(s->buf + 4, s->seq);
+    rudp_put32(s->buf + 8, r->session);
+    rudp_put32(s->buf + 12, r->snd_una);
+    memcpy(s->buf + RUDP_DATA_HDR_LEN, data, len);
+    r->snd_nxt++;
+    r->stats.tx_data++;
+    r->output(r->output_arg, s->buf, s->len);
+    return s->seq;
+}
+
+/*
+* 用一个RTT样本更新SRTT/RTTVAR/RTO，算法同RFC6298
+* @param[in]   r  		           :端点
+* @param[in]   rtt  		       :RTT样本
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void rudp_rtt_sample(rudp_t *r, uint32_t rtt)
+{
+    uint32_t delta;
+    if (rtt == 0)
+    {
+        rtt = 1;
+    }
+    if (r->srtt_ms == 0)
+    {
+        r->srtt_ms = rtt;
+        r->rttvar_ms = rtt / 2;
+    }
+    else
+    {
+        delta = r->srtt_ms > rtt ? r->srtt_ms - rtt : rtt - r->srtt_ms;
+        r->rttvar_ms = (3 * r->rttvar_ms + delta) / 4;
+        r->srtt_ms = (7 * r->srtt_ms + rtt) / 8;
+    }
+    r->rto_ms = r->srtt_ms + 4 * r->rttvar_ms;
+    if (r->rto_ms < RUDP_RTO_MIN_MS)
+    {
+        r->rto_ms = RUDP_RTO_MIN_MS;
+    }
+    if (r->rto_ms > RUDP_RTO_MAX_MS)
+    {
+        r->rto_ms = RUDP_RTO_MAX_MS;
+    }
+}
+
+/*
+* 标记一个包已确认，只用没重传过的包采样RTT(Karn算法)
+* @param[in]   r  		           :端点
+* @param[in]   seq  		       :序号
+* @param[in]   now_ms  		       :当前时刻
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void rudp_mark_acked(rudp_t *r, uint32_t seq, uint32_t now_ms)
+{
+    rudp_slot_t *s = &r->slot[seq % RUDP_WINDOW];
+    if (!s->in_use || s->seq != seq)
+    {
+        return;
+    }
+    if (s->retries == 0 && !s->fast_sent)
+    {
+        rudp_rtt_sample(r, now_ms - s->sent_ms);
+    }
+    s->in_use = 0;
+    r->stats.acked++;
+}
+
+/*
+* 处理确认包
+* @param[in]   r  		           :端点
+* @param[in]   data  		       :确认包
+* @param[in]   now_ms  		       :当前时刻
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void rudp_input_ack(rudp_t *r, const uint8_t *data, uint32_t now_ms)
+{
+    uint32_t ack = rudp_get32(data + 4);
+    uint32_t sack = rudp_get32(data + 12);
+    uint32_t seq, highest;
+
+    //旧会话的确认或确认了还没发的包，忽略
+    if (rudp_get32(data + 8) != r->session || SEQ_BEFORE(r->snd_nxt, ack))
+    {
+        return;
+    }
+    r->stats.rx_acks++;
+    //累计确认
+    for (seq = r->snd_una; SEQ_BEFORE(seq, ack); seq++)
+    {
+        rudp_mark_acked(r, seq, now_ms);
+    }
+    //选择确认：bit i表示ack+1+i已收到
+    highest = ack;
+    for (int i = 0; i < 32 && sack; i++, sack >>= 1)
+    {
+        seq = ack + 1 + i;
+        if ((sack & 1) && SEQ_BEFORE(seq, r->snd_nxt))
+        {
+            rudp_mark_acked(r, seq, now_ms);
+            highest = seq;
+        }
+    }
+    //窗口前移
+    while (SEQ_BEFORE(r->snd_una, r->snd_nxt) && !r->slot[r->snd_una % RUDP_WINDOW].in_use)
+    {
+        r->snd_una++;
+    }
+    //后面已有足够多的包被确认，空洞基本可以判定丢失，不等超时直接重传
+    for (seq = r->snd_una; SEQ_BEFORE(seq, highest); seq++)
+    {
+        rudp_slot_t *s = &r->slot[seq % RUDP_WINDOW];
+        if (s->in_use && !s->fast_sent && (highest - seq) >= RUDP_FAST_RETRANSMIT)
+        {
+            s->fast_sent = 1;
+            s->sent_ms = now_ms;
+            rudp_put32(s->buf + 12, r->snd_una);
+            r->stats.tx_fast_retrans++;
+            r->output(r->output_arg, s->buf, s->len);
+        }
+    }
+}
+
+/*
+* 回复确认包：累计确认+SACK位图
+* @param[in]   r  		           :端点
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void rudp_send_ack(rudp_t *r)
+{
+    uint8_t ack[RUDP_ACK_LEN];
+    ack[0] = RUDP_TYPE_ACK;
+    ack[1] = 0;
+    ack[2] = 0;
+    ack[3] = 0;
+    rudp_put32(ack + 4, r->rcv_nxt);
+    rudp_put32(ack + 8, r->peer_session);
+    rudp_put32(ack + 12, r->rcv_mask >> 1);
+    r->stats.tx_acks++;
+    r->output(r->output_arg, ack, sizeof(ack));
+}
+
+/*
+* 处理数据包：新包立即交付，重复包只回确认
+* @param[in]   r  		           :端点
+* @param[in]   data  		       :数据包
+* @param[in]   len  		       :长度
+* @retval      int                 :0成功，<0格式错误
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int rudp_input_data(rudp_t *r, const uint8_t *data, size_t len)
+{
+    uint32_t payload_len = ((uint32_t)data[2] << 8) | data[3];
+    uint32_t seq = rudp_get32(data + 4);
+    uint32_t session = rudp_get32(data + 8);
+    uint32_t una = rudp_get32(data + 12);
+    uint32_t off;
+
+    if (payload_len + RUDP_DATA_HDR_LEN != len || SEQ_BEFORE(seq, una))
+    {
+        return -1;
+    }
+    //对端重启，从对端的最早未确认序号开始接收
+    if (session != r->peer_session)
+    {
+        r->peer_session = session;
+        r->rcv_nxt = una;
+        r->rcv_mask = 0;
+    }
+    //una之前的包对端已放弃重传，不再等待
+    if (SEQ_BEFORE(r->rcv_nxt, una))
+    {
+        off = una - r->rcv_nxt;
+        r->rcv_mask = off < 32 ? r->rcv_mask >> off : 0;
+        r->rcv_nxt = una;
+    }
+    off = seq - r->rcv_nxt;
+    if (SEQ_BEFORE(seq, r->rcv_nxt) || ((off < 32) && (r->rcv_mask & (1u << off))))
+    {
+        r->stats.rx_dup++;
+        rudp_send_ack(r);
+        return 0;
+    }
+    //超出接收范围，对端窗口不可能这么大，丢弃
+    if (off >= 32)
+    {
+        return 0;
+    }
+    r->rcv_mask |= 1u << off;
+    r->stats.rx_data++;
+    if (r->recv_cb)
+    {
+        r->recv_cb(r->recv_arg, seq, data + RUDP_DATA_HDR_LEN, payload_len);
+    }
+    //连续收到的部分向前推进
+    while (r->rcv_mask & 1)
+    {
+        r->rcv_mask >>= 1;
+        r->rcv_nxt++;
+    }
+    rudp_send_ack(r);
+    return 0;
+}
+
+/*
+* 喂入一个收到的数据报
+* @param[in]   r  		           :端点
+* @param[in]   data  		       :数据报
+* @param[in]   len  		       :长度
+* @param[in]   now_ms  		       :当前时刻
+* @retval      int                 :0成功，<0不是可靠udp的包
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int rudp_input(rudp_t *r, const uint8_t *data, size_t len, uint32_t now_ms)
+{
+    if (len >= RUDP_ACK_LEN && data[0] == RUDP_TYPE_ACK)
+    {
+        rudp_input_ack(r, data, now_ms);
+        return 0;
+    }
+    if (len >= RUDP_DATA_HDR_LEN && data[0] == RUDP_TYPE_DATA)
+    {
+        return rudp_input_data(r, data, len);
+    }
+    return -1;
+}
+
+/*
+* 重传定时：超时的包按指数退避重传，超过次数放弃
+* @param[in]   r  		           :端点
+* @param[in]   now_ms  		       :当前时刻
+* @retval      int32_t             :距离下一次超时的毫秒数，RUDP_POLL_IDLE无待确认包，<0有包被放弃
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int32_t rudp_poll(rudp_t *r, uint32_t now_ms)
+{
+    int32_t next = RUDP_POLL_IDLE;
+    int32_t remain;
+    uint32_t rto;
+    int lost = 0;
+
+    for (uint32_t seq = r->snd_una; SEQ_BEFORE(seq, r->snd_nxt); seq++)
+    {
+        rudp_slot_t *s = &r->slot[seq % RUDP_WINDOW];
+        if (!s->in_use)
+        {
+            continue;
+        }
+        //每重传一次超时翻倍
+        rto = r->rto_ms << s->retries;
+        if (rto > RUDP_RTO_MAX_MS)
+        {
+            rto = RUDP_RTO_MAX_MS;
+        }
+        remain = (int32_t)rto - TIME_DIFF(now_ms, s->sent_ms);
+        if (remain <= 0)
+        {
+            if (s->retries >= RUDP_MAX_RETRIES)
+            {
+                //对端长时间无响应，放弃这个包
+                s->in_use = 0;
+                r->stats.give_up++;
+                lost = 1;
+                continue;
+            }
+            s->retries++;
+            s->sent_ms = now_ms;
+            rudp_put32(s->buf + 12, r->snd_una);
+            r->stats.tx_retrans++;
+            r->output(r->output_arg, s->buf, s->len);
+            remain = rto * 2 > RUDP_RTO_MAX_MS ? RUDP_RTO_MAX_MS : rto * 2;
+        }
+        if (remain < next)
+        {
+            next = remain;
+        }
+    }
+    while (SEQ_BEFORE(r->snd_una, r->snd_nxt) && !r->slot[r->snd_una % RUDP_WINDOW].in_use)
+    {
+        r->snd_una++;
+    }
+    return lost ? -1 : next;
+}
@@ -0,0 +1,914 @@
+/*
+* @file         WebSocket_Deflate.c
+* @brief        websocket permessage-deflate扩展(RFC 7692)
+* @details      握手协商、压缩和解压。压缩只用固定Huffman码，短消息省掉动态码表的开销；
+*               解压按canonical Huffman逐位解码，码表只有1K多字节；
+*               工作缓存都是静态的，不占websocket任务的栈
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+
+/*
+=============
+头文件包含
+=============
+*/
+#include "WebSocket_Deflate.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#define WS_DFL_HASH_BITS	10		/*压缩hash表位数*/
+#define WS_DFL_HASH_SIZE	(1 << WS_DFL_HASH_BITS)
+#define WS_DFL_WIN_MAX		(1 << WS_DEFLATE_SERVER_WBITS)	/*压缩窗口上限*/
+#define WS_DFL_MIN_MATCH	3		/*最短匹配*/
+#define WS_DFL_MAX_MATCH	258		/*最长匹配*/
+#define WS_DFL_MAX_BITS		15		/*huffman码最大长度*/
+#define WS_DFL_MAX_LCODES	286		/*动态块字面/长度码个数上限*/
+#define WS_DFL_MAX_DCODES	30		/*距离码个数上限*/
+#define WS_DFL_FIX_LCODES	288		/*固定块字面/长度码个数*/
+#define WS_DFL_TAIL_L		4		/*同步刷新的空存储块，发送时去掉，解压时补上*/
+
+//扩展名和请求头
+static const char WS_dfl_name[] = "permessage-deflate";
+static const char WS_dfl_hdr[] = "Sec-WebSocket-Extensions:";
+static const uint8_t WS_dfl_tail[WS_DFL_TAIL_L] = { 0x00, 0x00, 0xff, 0xff };
+
+//长度码和距离码的基值、附加位数
+static const uint16_t WS_dfl_lbase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t WS_dfl_lext[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t WS_dfl_dbase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t WS_dfl_dext[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+//动态块码长表的传输顺序
+static const uint8_t WS_dfl_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+//压缩：历史和消息拼在一起找匹配，只在持有发送锁时使用
+static uint8_t WS_dfl_buf[WS_DFL_WIN_MAX + WS_DEFLATE_MAX_IN];
+static uint16_t WS_dfl_head[WS_DFL_HASH_SIZE];	/*每个hash最近的位置+1，0表示没有*/
+static uint16_t WS_dfl_prev[WS_DFL_WIN_MAX];	/*同hash的上一个位置+1，按位置对窗口取模*/
+//固定huffman码，已按位反转成lsb先发
+static uint16_t WS_dfl_fix_code[WS_DFL_FIX_LCODES];
+static uint8_t WS_dfl_fix_bits[WS_DFL_FIX_LCODES];
+static uint8_t WS_dfl_dist_code[WS_DFL_MAX_DCODES];
+static uint8_t WS_dfl_fix_ready = 0;
+
+//huffman解码表：count[len]为长度为len的码个数，symbol按码值排列
+typedef struct {
+	uint16_t*	count;
+	uint16_t*	symbol;
+} WS_inf_huff_t;
+
+//解压状态
+typedef struct {
+	const uint8_t*	in;					/*压缩数据*/
+	size_t			in_len;				/*压缩数据长度，后面还有WS_DFL_TAIL_L字节补尾*/
+	size_t			in_pos;				/*已读字节*/
+	uint32_t		bitbuf;				/*未用完的位*/
+	uint8_t			bitcnt;				/*bitbuf中的位数，不超过7*/
+	uint8_t			err;				/*输入不够*/
+	uint8_t*		out;				/*输出*/
+	size_t			out_len;			/*输出缓存长度*/
+	size_t			out_pos;			/*已输出长度*/
+	size_t			hist;				/*上文可引用的历史长度*/
+	WS_deflate_t*	d;					/*历史所在的连接*/
+} WS_inf_t;
+
+//解压码表，只在server任务中使用
+static uint16_t WS_inf_lcount[WS_DFL_MAX_BITS + 1], WS_inf_lsymbol[WS_DFL_MAX_LCODES];
+static uint16_t WS_inf_dcount[WS_DFL_MAX_BITS + 1], WS_inf_dsymbol[WS_DFL_MAX_DCODES];
+static uint16_t WS_inf_fix_lcount[WS_DFL_MAX_BITS + 1], WS_inf_fix_lsymbol[WS_DFL_FIX_LCODES];
+static uint16_t WS_inf_fix_dcount[WS_DFL_MAX_BITS + 1], WS_inf_fix_dsymbol[WS_DFL_MAX_DCODES];
+static uint16_t WS_inf_lengths[WS_DFL_MAX_LCODES + WS_DFL_MAX_DCODES];
+static uint8_t WS_inf_fix_ready = 0;
+
+/*
+* 跳过空格和tab
+* @param[in]   p  		           :字符串
+* @param[in]   end  		       :结尾
+* @retval      const char*         :第一个非空白字符
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static const char* ws_dfl_skip(const char* p, const char* end) {
+
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+/*
+* 解析窗口位数参数值，可以带引号，范围8~15
+* @param[in]   p  		           :参数值
+* @param[in]   n  		           :长度
+* @retval      int                 :位数，-1格式错误
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_dfl_wbits(const char* p, size_t n) {
+
+	if (n >= 2 && p[0] == '"' && p[n - 1] == '"') {
+		p++;
+		n -= 2;
+	}
+	if (n == 1 && p[0] >= '8' && p[0] <= '9')
+		return p[0] - '0';
+	if (n == 2 && p[0] == '1' && p[1] >= '0' && p[1] <= '5')
+		return 10 + p[1] - '0';
+	return -1;
+}
+
+/*
+* 检查一个permessage-deflate提议，可以接受时填好协商结果
+* @param[in]   d  		           :连接的压缩状态
+* @param[in]   p  		           :提议开头
+* @param[in]   end  		       :提议结尾(逗号或行尾)
+* @retval      int                 :客户端是否带了client_max_window_bits，-1不能接受
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*               参数不认识或者重复时整个提议不接受，换下一个提议
+*/
+static int ws_dfl_offer(WS_deflate_t* d, const char* p, const char* end) {
+
+	const char* tok_end;
+	const char* eq;
+	const char* val;
+	size_t n;
+	int server_nct = 0, client_nct = 0, server_wb = 0, client_wb = -1;
+	int first = 1;
+
+	while (p < end) {
+		p = ws_dfl_skip(p, end);
+		tok_end = memchr(p, ';', end - p);
+		if (tok_end == NULL)
+			tok_end = end;
+		n = tok_end - p;
+		while (n > 0 && (p[n - 1] == ' ' || p[n - 1] == '\t'))
+			n--;
+		if (first) {
+			//扩展名
+			if (n != sizeof(WS_dfl_name) - 1 || strncasecmp(p, WS_dfl_name, n) != 0)
+				return -1;
+			first = 0;
+		} else {
+			//参数，值可有可无
+			eq = memchr(p, '=', n);
+			val = eq ? ws_dfl_skip(eq + 1, p + n) : NULL;
+			if (eq != NULL) {
+				while (eq > p && (eq[-1] == ' ' || eq[-1] == '\t'))
+					eq--;
+			} else {
+				eq = p + n;
+			}
+			if (eq - p == 26 && strncasecmp(p, "server_no_context_takeover", 26) == 0 && val == NULL && !server_nct) {
+				server_nct = 1;
+			} else if (eq - p == 26 && strncasecmp(p, "client_no_context_takeover", 26) == 0 && val == NULL && !client_nct) {
+				client_nct = 1;
+			} else if (eq - p == 22 && strncasecmp(p, "server_max_window_bits", 22) == 0 && val != NULL && server_wb == 0) {
+				server_wb = ws_dfl_wbits(val, p + n - val);
+				if (server_wb < 0)
+					return -1;
+			} else if (eq - p == 22 && strncasecmp(p, "client_max_window_bits", 22) == 0 && client_wb < 0) {
+				//不带值表示客户端支持限制窗口，由服务器决定
+				client_wb = val ? ws_dfl_wbits(val, p + n - val) : 15;
+				if (client_wb < 0)
+					return -1;
+			} else {
+				return -1;
+			}
+		}
+		p = tok_end + 1;
+	}
+	if (first)
+		return -1;
+	memset(d, 0, sizeof(WS_deflate_t));
+	d->enabled = 1;
+	d->server_takeover = WS_DEFLATE_SERVER_TAKEOVER && !server_nct;
+	d->server_wbits = (server_wb && server_wb < WS_DEFLATE_SERVER_WBITS) ? server_wb : WS_DEFLATE_SERVER_WBITS;
+	//客户端没带client_max_window_bits时它可能用32K窗口，只能要求它不保留上文
+	d->client_takeover = WS_DEFLATE_CLIENT_TAKEOVER && client_wb >= 0 && !client_nct;
+	d->client_wbits = (client_wb >= 0 && client_wb < WS_DEFLATE_CLIENT_WBITS) ? client_wb : WS_DEFLATE_CLIENT_WBITS;
+	return client_wb >= 0;
+}
+
+/*
+* 按名字找请求头，不区分大小写，只匹配行首
+* @param[in]   req  		       :请求，以0结尾，可以从行尾的\r\n开始
+* @param[in]   name  		       :请求头名，带冒号
+* @retval      const char*         :冒号之后的值，NULL没有这个请求头
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+const char* WS_header_find(const char* req, const char* name) {
+
+	size_t n = strlen(name);
+	const char* p = req;
+
+	while (p != NULL && *p) {
+		if (strncasecmp(p, name, n) == 0)
+			return p + n;
+		p = strstr(p, "\r\n");
+		if (p != NULL)
+			p += 2;
+	}
+	return NULL;
+}
+
+/*
+* 在握手请求中找到第一个可以接受的permessage-deflate提议，生成回复头
+* @param[in]   d  		           :连接的压缩状态
+* @param[in]   req  		       :握手请求，以0结尾
+* @param[out]  resp  		       :回复的Sec-WebSocket-Extensions行，没有协商时为空串
+* @param[in]   resp_len  		   :回复缓存长度，WS_DEFLATE_RESP_L
+* @retval      int                 :1协商成功，0不压缩
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int WS_deflate_negotiate(WS_deflate_t* d, const char* req, char* resp, size_t resp_len) {
+
+	const char* p = req;
+	const char* line_end;
+	const char* offer_end;
+	int client_wb;
+	int n;
+
+	d->enabled = 0;
+	resp[0] = 0;
+	//可能有多行，每行可能有多个用逗号分开的提议，按顺序取第一个能接受的
+	while ((p = WS_header_find(p, WS_dfl_hdr)) != NULL) {
+		line_end = strstr(p, "\r\n");
+		if (line_end == NULL)
+			line_end = p + strlen(p);
+		while (p < line_end) {
+			offer_end = memchr(p, ',', line_end - p);
+			if (offer_end == NULL)
+				offer_end = line_end;
+			client_wb = ws_dfl_offer(d, p, offer_end);
+			if (client_wb >= 0) {
+				n = snprintf(resp, resp_len, "%s %s%s%s; server_max_window_bits=%d", WS_dfl_hdr, WS_dfl_name,
+						d->server_takeover ? "" : "; server_no_context_takeover",
+						d->client_takeover ? "" : "; client_no_context_takeover", d->server_wbits);
+				//客户端没提client_max_window_bits时回复里不能带
+				if (client_wb)
+					n += snprintf(resp + n, resp_len - n, "; client_max_window_bits=%d", d->client_wbits);
+				snprintf(resp + n, resp_len - n, "\r\n");
+				return 1;
+			}
+			p = offer_end + 1;
+		}
+		//最后一行没有\r\n时line_end就是结束符，不能越过
+		p = line_end;
+	}
+	return 0;
+}
+
+/*
+* 生成固定huffman码表(lsb先发)
+* @param[in]   void  		       :无
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void ws_dfl_fix_init(void) {
+
+	uint16_t sym, code, r;
+	uint8_t bits, i;
+
+	if (WS_dfl_fix_ready)
+		return;
+	for (sym = 0; sym < WS_DFL_FIX_LCODES; sym++) {
+		if (sym < 144) {
+			code = 0x30 + sym;
+			bits = 8;
+		} else if (sym < 256) {
+			code = 0x190 + sym - 144;
+			bits = 9;
+		} else if (sym < 280) {
+			code = sym - 256;
+			bits = 7;
+		} else {
+			code = 0xc0 + sym - 280;
+			bits = 8;
+		}
+		for (r = 0, i = 0; i < bits; i++)
+			r = (r << 1) | ((code >> i) & 1);
+		WS_dfl_fix_code[sym] = r;
+		WS_dfl_fix_bits[sym] = bits;
+	}
+	for (sym = 0; sym < WS_DFL_MAX_DCODES; sym++) {
+		for (r = 0, i = 0; i < 5; i++)
+			r = (r << 1) | ((sym >> i) & 1);
+		WS_dfl_dist_code[sym] = r;
+	}
+	WS_dfl_fix_ready = 1;
+}
+
+//压缩输出
+typedef struct {
+	uint8_t*	out;
+	size_t		len;					/*输出缓存长度*/
+	size_t		pos;					/*已输出字节*/
+	uint32_t	bits;					/*未凑满一字节的位*/
+	uint8_t		n;						/*bits中的位数*/
+	uint8_t		full;					/*输出缓存不够*/
+} WS_dfl_out_t;
+
+/*
+* 输出n位，lsb先发
+* @param[in]   w  		           :输出
+* @param[in]   value  		       :值
+* @param[in]   n  		           :位数，不超过16
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static inline void ws_dfl_put(WS_dfl_out_t* w, uint32_t value, uint8_t n) {
+
+	w->bits |= value << w->n;
+	w->n += n;
+	while (w->n >= 8) {
+		if (w->pos < w->len)
+			w->out[w->pos++] = w->bits;
+		else
+			w->full = 1;
+		w->bits >>= 8;
+		w->n -= 8;
+	}
+}
+
+/*
+* 输出一个匹配：长度码+附加位，距离码+附加位
+* @param[in]   w  		           :输出
+* @param[in]   len  		       :匹配长度3~258
+* @param[in]   dist  		       :距离
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static void ws_dfl_match(WS_dfl_out_t* w, uint32_t len, uint32_t dist) {
+
+	uint32_t l = len - WS_DFL_MIN_MATCH;
+	uint32_t d = dist - 1;
+	uint8_t n, code;
+
+	//长度码：3~10各占一个，之后每个2的幂区间分4个码
+	if (len == WS_DFL_MAX_MATCH) {
+		code = 28;
+	} else if (l < 8) {
+		code = l;
+	} else {
+		n = 31 - __builtin_clz(l);
+		code = 4 * (n - 1) + ((l >> (n - 2)) & 3);
+	}
+	ws_dfl_put(w, WS_dfl_fix_code[257 + code], WS_dfl_fix_bits[257 + code]);
+	if (WS_dfl_lext[code])
+		ws_dfl_put(w, len - WS_dfl_lbase[code], WS_dfl_lext[code]);
+	//距离码：1~4各占一个，之后每个2的幂区间分2个码
+	if (d < 4) {
+		code = d;
+	} else {
+		n = 31 - __builtin_clz(d);
+		code = 2 * n + ((d >> (n - 1)) & 1);
+	}
+	ws_dfl_put(w, WS_dfl_dist_code[code], 5);
+	if (WS_dfl_dext[code])
+		ws_dfl_put(w, dist - WS_dfl_dbase[code], WS_dfl_dext[code]);
+}
+
+/*
+* 3字节hash
+* @param[in]   p  		           :数据
+* @retval      uint32_t            :hash
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static inline uint32_t ws_dfl_hash(const uint8_t* p) {
+
+	return ((((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | p[2]) * 2654435761u) >> (32 - WS_DFL_HASH_BITS);
+}
+
+/*
+* 把一个位置加入hash链
+* @param[in]   pos  		       :WS_dfl_buf中的位置，后面至少还有3字节
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static inline void ws_dfl_insert(size_t pos) {
+
+	uint32_t h = ws_dfl_hash(WS_dfl_buf + pos);
+	WS_dfl_prev[pos & (WS_DFL_WIN_MAX - 1)] = WS_dfl_head[h];
+	WS_dfl_head[h] = pos + 1;
+}
+
+/*
+* 压缩一条消息：一个固定huffman块加同步刷新，去掉结尾的00 00 ff ff
+* @param[in]   d  		           :连接的压缩状态
+* @param[in]   in  		           :消息
+* @param[in]   len  		       :消息长度
+* @param[out]  out  		       :压缩结果
+* @param[in]   out_len  		   :输出缓存长度
+* @retval      int                 :压缩后长度，-1不值得压缩或放不下，按原文发送
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*               历史不在这里更新，帧写出去之后再调用WS_deflate_commit，跳过的消息不会进历史
+*/
+int WS_deflate_compress(WS_deflate_t* d, const uint8_t* in, size_t len, uint8_t* out, size_t out_len) {
+
+	WS_dfl_out_t w;
+	size_t hist = d->server_takeover ? d->tx_len : 0;
+	size_t end = hist + len;
+	size_t wsize = (size_t) 1 << d->server_wbits;
+	size_t pos, cand, best_len, best_dist, max_len, n, i;
+	uint8_t chain;
+
+	if (!d->enabled || len < WS_DEFLATE_MIN_LEN || len > WS_DEFLATE_MAX_IN)
+		return -1;
+	ws_dfl_fix_init();
+	memcpy(WS_dfl_buf, d->tx_hist, hist);
+	memcpy(WS_dfl_buf + hist, in, len);
+	memset(WS_dfl_head, 0, sizeof(WS_dfl_head));
+	//历史只建索引，不输出
+	for (pos = 0; pos < hist; pos++)
+		if (pos + WS_DFL_MIN_MATCH <= end)
+			ws_dfl_insert(pos);
+	memset(&w, 0, sizeof(w));
+	w.out = out;
+	//比原文还长就没必要压缩
+	w.len = out_len < len ? out_len : len;
+	//BFINAL=0，BTYPE=01固定huffman
+	ws_dfl_put(&w, 0x2, 3);
+	pos = hist;
+	while (pos < end && !w.full) {
+		best_len = 0;
+		best_dist = 0;
+		if (pos + WS_DFL_MIN_MATCH <= end) {
+			max_len = end - pos < WS_DFL_MAX_MATCH ? end - pos : WS_DFL_MAX_MATCH;
+			cand = WS_dfl_head[ws_dfl_hash(WS_dfl_buf + pos)];
+			chain = WS_DEFLATE_CHAIN;
+			while (cand != 0 && chain-- != 0) {
+				cand--;
+				//超出窗口的位置在prev里可能已被覆盖，到这里为止
+				if (pos - cand >= wsize)
+					break;
+				if (WS_dfl_buf[cand + best_len] == WS_dfl_buf[pos + best_len] && WS_dfl_buf[cand] == WS_dfl_buf[pos]) {
+					for (n = 1; n < max_len && WS_dfl_buf[cand + n] == WS_dfl_buf[pos + n]; n++)
+						;
+					if (n > best_len) {
+						best_len = n;
+						best_dist = pos - cand;
+						if (n == max_len)
+							break;
+					}
+				}
+				cand = WS_dfl_prev[cand & (WS_DFL_WIN_MAX - 1)];
+			}
+			ws_dfl_insert(pos);
+		}
+		if (best_len >= WS_DFL_MIN_MATCH) {
+			ws_dfl_match(&w, best_len, best_dist);
+			//匹配中间的位置也要进hash链
+			for (i = 1; i < best_len; i++)
+				if (pos + i + WS_DFL_MIN_MATCH <= end)
+					ws_dfl_insert(pos + i);
+			pos += best_len;
+		} else {
+			ws_dfl_put(&w, WS_dfl_fix_code[WS_dfl_buf[pos]], WS_dfl_fix_bits[WS_dfl_buf[pos]]);
+			pos++;
+		}
+	}
+	//块结束码256，再加空存储块头(BFINAL=0，BTYPE=00)补齐到字节，LEN/NLEN按RFC 7692不发
+	ws_dfl_put(&w, WS_dfl_fix_code[256], WS_dfl_fix_bits[256]);
+	ws_dfl_put(&w, 0, 3);
+	if (w.n)
+		ws_dfl_put(&w, 0, 8 - w.n);
+	if (w.full || w.pos >= len)
+		return -1;
+	return w.pos;
+}
+
+/*
+* 一条压缩消息已发出：计入统计，开启上文保留时放进历史
+* @param[in]   d  		           :连接的压缩状态
+* @param[in]   in  		           :原文
+* @param[in]   len  		       :原文长度
+* @param[in]   wire_len  		   :压缩后长度
+* @retval      void                :无
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+void WS_deflate_commit(WS_deflate_t* d, const uint8_t* in, size_t len, size_t wire_len) {
+
+	size_t wsize = (size_t) 1 << d->server_wbits;
+	size_t keep;
+
+	d->tx_raw += len;
+	d->tx_wire += wire_len;
+	if (!d->server_takeover)
+		return;
+	if (len >= wsize) {
+		memcpy(d->tx_hist, in + len - wsize, wsize);
+		d->tx_len = wsize;
+		return;
+	}
+	//只保留最近wsize字节
+	keep = d->tx_len + len > wsize ? wsize - len : d->tx_len;
+	memmove(d->tx_hist, d->tx_hist + d->tx_len - keep, keep);
+	memcpy(d->tx_hist + keep, in, len);
+	d->tx_len = keep + len;
+}
+
+/*
+* 读一个字节，压缩数据读完后接着读补上的00 00 ff ff
+* @param[in]   s  		           :解压状态
+* @retval      int                 :字节，-1输入不够
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static inline int ws_inf_byte(WS_inf_t* s) {
+
+	size_t pos = s->in_pos;
+	if (pos < s->in_len) {
+		s->in_pos++;
+		return s->in[pos];
+	}
+	if (pos < s->in_len + WS_DFL_TAIL_L) {
+		s->in_pos++;
+		return WS_dfl_tail[pos - s->in_len];
+	}
+	s->err = 1;
+	return -1;
+}
+
+/*
+* 读need位，lsb先收
+* @param[in]   s  		           :解压状态
+* @param[in]   need  		       :位数，不超过16
+* @retval      uint32_t            :值，输入不够时置s->err
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static uint32_t ws_inf_bits(WS_inf_t* s, uint8_t need) {
+
+	uint32_t val = s->bitbuf;
+	int b;
+	while (s->bitcnt < need) {
+		b = ws_inf_byte(s);
+		if (b < 0)
+			return 0;
+		val |= (uint32_t) b << s->bitcnt;
+		s->bitcnt += 8;
+	}
+	s->bitbuf = val >> need;
+	s->bitcnt -= need;
+	return val & ((1UL << need) - 1);
+}
+
+/*
+* 按canonical huffman码表解一个符号，码是msb先收的
+* @param[in]   s  		           :解压状态
+* @param[in]   h  		           :码表
+* @retval      int                 :符号，<0数据错误
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_inf_decode(WS_inf_t* s, const WS_inf_huff_t* h) {
+
+	int code = 0, first = 0, index = 0, count, len = 1, left, b;
+	uint32_t bitbuf = s->bitbuf;
+	const uint16_t* next = h->count + 1;
+
+	left = s->bitcnt;
+	while (1) {
+		//先用bitbuf里剩下的位
+		while (left--) {
+			code |= bitbuf & 1;
+			bitbuf >>= 1;
+			count = *next++;
+			if (code - count < first) {
+				s->bitbuf = bitbuf;
+				s->bitcnt = (s->bitcnt - len) & 7;
+				return h->symbol[index + (code - first)];
+			}
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+			len++;
+		}
+		left = (WS_DFL_MAX_BITS + 1) - len;
+		if (left == 0)
+			return -1;
+		b = ws_inf_byte(s);
+		if (b < 0)
+			return -1;
+		bitbuf = b;
+		if (left > 8)
+			left = 8;
+	}
+}
+
+/*
+* 由码长生成canonical huffman码表
+* @param[out]  h  		           :码表
+* @param[in]   length  		       :每个符号的码长
+* @param[in]   n  		           :符号数
+* @retval      int                 :0完整码表，>0不完整，<0码长超额
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_inf_construct(WS_inf_huff_t* h, const uint16_t* length, int n) {
+
+	int symbol, len, left;
+	uint16_t offs[WS_DFL_MAX_BITS + 1];
+
+	for (len = 0; len <= WS_DFL_MAX_BITS; len++)
+		h->count[len] = 0;
+	for (symbol = 0; symbol < n; symbol++)
+		h->count[length[symbol]]++;
+	if (h->count[0] == n)
+		return 0;
+	left = 1;
+	for (len = 1; len <= WS_DFL_MAX_BITS; len++) {
+		left <<= 1;
+		left -= h->count[len];
+		if (left < 0)
+			return left;
+	}
+	offs[1] = 0;
+	for (len = 1; len < WS_DFL_MAX_BITS; len++)
+		offs[len + 1] = offs[len] + h->count[len];
+	for (symbol = 0; symbol < n; symbol++)
+		if (length[symbol] != 0)
+			h->symbol[offs[length[symbol]]++] = symbol;
+	return left;
+}
+
+/*
+* 解一个huffman块的数据，到块结束码256为止
+* @param[in]   s  		           :解压状态
+* @param[in]   lcode  		       :字面/长度码表
+* @param[in]   dcode  		       :距离码表
+* @retval      int                 :0成功，-1数据错误，-2输出放不下
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_inf_codes(WS_inf_t* s, const WS_inf_huff_t* lcode, const WS_inf_huff_t* dcode) {
+
+	WS_deflate_t* d = s->d;
+	uint16_t mask = sizeof(d->rx_hist) - 1;
+	int symbol;
+	uint32_t len, dist;
+
+	do {
+		symbol = ws_inf_decode(s, lcode);
+		if (symbol < 0)
+			return -1;
+		if (symbol < 256) {
+			if (s->out_pos == s->out_len)
+				return -2;
+			s->out[s->out_pos++] = symbol;
+		} else if (symbol > 256) {
+			symbol -= 257;
+			if (symbol >= 29)
+				return -1;
+			len = WS_dfl_lbase[symbol] + ws_inf_bits(s, WS_dfl_lext[symbol]);
+			symbol = ws_inf_decode(s, dcode);
+			if (symbol < 0 || symbol >= WS_DFL_MAX_DCODES)
+				return -1;
+			dist = WS_dfl_dbase[symbol] + ws_inf_bits(s, WS_dfl_dext[symbol]);
+			if (s->err || dist > s->out_pos + s->hist)
+				return -1;
+			if (s->out_len - s->out_pos < len)
+				return -2;
+			//距离超过本条消息已输出的部分时从上文历史取
+			while (len--) {
+				if (dist > s->out_pos)
+					s->out[s->out_pos] = d->rx_hist[(d->rx_pos - (dist - s->out_pos)) & mask];
+				else
+					s->out[s->out_pos] = s->out[s->out_pos - dist];
+				s->out_pos++;
+			}
+		}
+	} while (symbol != 256);
+	return 0;
+}
+
+/*
+* 存储块：对齐到字节后直接拷贝
+* @param[in]   s  		           :解压状态
+* @retval      int                 :0成功，-1数据错误，-2输出放不下
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_inf_stored(WS_inf_t* s) {
+
+	int b0, b1, b2, b3;
+	uint32_t len;
+
+	s->bitbuf = 0;
+	s->bitcnt = 0;
+	b0 = ws_inf_byte(s);
+	b1 = ws_inf_byte(s);
+	b2 = ws_inf_byte(s);
+	b3 = ws_inf_byte(s);
+	if (s->err)
+		return -1;
+	len = b0 | (b1 << 8);
+	if (b2 != (~b0 & 0xff) || b3 != (~b1 & 0xff))
+		return -1;
+	if (s->out_len - s->out_pos < len)
+		return -2;
+	while (len--) {
+		b0 = ws_inf_byte(s);
+		if (b0 < 0)
+			return -1;
+		s->out[s->out_pos++] = b0;
+	}
+	return 0;
+}
+
+/*
+* 固定huffman块
+* @param[in]   s  		           :解压状态
+* @retval      int                 :0成功，-1数据错误，-2输出放不下
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_inf_fixed(WS_inf_t* s) {
+
+	WS_inf_huff_t lcode = { WS_inf_fix_lcount, WS_inf_fix_lsymbol };
+	WS_inf_huff_t dcode = { WS_inf_fix_dcount, WS_inf_fix_dsymbol };
+	int symbol;
+
+	if (!WS_inf_fix_ready) {
+		for (symbol = 0; symbol < 144; symbol++)
+			WS_inf_lengths[symbol] = 8;
+		for (; symbol < 256; symbol++)
+			WS_inf_lengths[symbol] = 9;
+		for (; symbol < 280; symbol++)
+			WS_inf_lengths[symbol] = 7;
+		for (; symbol < WS_DFL_FIX_LCODES; symbol++)
+			WS_inf_lengths[symbol] = 8;
+		ws_inf_construct(&lcode, WS_inf_lengths, WS_DFL_FIX_LCODES);
+		for (symbol = 0; symbol < WS_DFL_MAX_DCODES; symbol++)
+			WS_inf_lengths[symbol] = 5;
+		ws_inf_construct(&dcode, WS_inf_lengths, WS_DFL_MAX_DCODES);
+		WS_inf_fix_ready = 1;
+	}
+	return ws_inf_codes(s, &lcode, &dcode);
+}
+
+/*
+* 动态huffman块：先解码长表，再解数据
+* @param[in]   s  		           :解压状态
+* @retval      int                 :0成功，-1数据错误，-2输出放不下
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+static int ws_inf_dynamic(WS_inf_t* s) {
+
+	WS_inf_huff_t lcode = { WS_inf_lcount, WS_inf_lsymbol };
+	WS_inf_huff_t dcode = { WS_inf_dcount, WS_inf_dsymbol };
+	int nlen, ndist, ncode, index, symbol, len, err;
+
+	nlen = ws_inf_bits(s, 5) + 257;
+	ndist = ws_inf_bits(s, 5) + 1;
+	ncode = ws_inf_bits(s, 4) + 4;
+	if (s->err || nlen > WS_DFL_MAX_LCODES || ndist > WS_DFL_MAX_DCODES)
+		return -1;
+	//码长的码长
+	for (index = 0; index < ncode; index++)
+		WS_inf_lengths[WS_dfl_order[index]] = ws_inf_bits(s, 3);
+	for (; index < 19; index++)
+		WS_inf_lengths[WS_dfl_order[index]] = 0;
+	if (s->err || ws_inf_construct(&lcode, WS_inf_lengths, 19) != 0)
+		return -1;
+	//字面/长度和距离的码长，16~18为重复
+	index = 0;
+	while (index < nlen + ndist) {
+		symbol = ws_inf_decode(s, &lcode);
+		if (symbol < 0)
+			return -1;
+		if (symbol < 16) {
+			WS_inf_lengths[index++] = symbol;
+			continue;
+		}
+		len = 0;
+		if (symbol == 16) {
+			if (index == 0)
+				return -1;
+			len = WS_inf_lengths[index - 1];
+			symbol = 3 + ws_inf_bits(s, 2);
+		} else if (symbol == 17) {
+			symbol = 3 + ws_inf_bits(s, 3);
+		} else {
+			symbol = 11 + ws_inf_bits(s, 7);
+		}
+		if (s->err || index + symbol > nlen + ndist)
+			return -1;
+		while (symbol--)
+			WS_inf_lengths[index++] = len;
+	}
+	//必须有块结束码
+	if (WS_inf_lengths[256] == 0)
+		return -1;
+	err = ws_inf_construct(&lcode, WS_inf_lengths, nlen);
+	if (err < 0 || (err > 0 && nlen - lcode.count[0] != 1))
+		return -1;
+	err = ws_inf_construct(&dcode, WS_inf_lengths + nlen, ndist);
+	if (err < 0 || (err > 0 && ndist - dcode.count[0] != 1))
+		return -1;
+	return ws_inf_codes(s, &lcode, &dcode);
+}
+
+/*
+* 解压一条消息，开启上文保留时可以引用之前的消息
+* @param[in]   d  		           :连接的压缩状态
+* @param[in]   in  		           :压缩数据，不含结尾的00 00 ff ff
+* @param[in]   len  		       :压缩数据长度
+* @param[out]  out  		       :原文
+* @param[in]   out_len  		   :输出缓存长度
+* @retval      int                 :原文长度，-1数据错误，-2输出放不下
+* @note        修改日志
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n
+*/
+int WS_deflate_inflate(WS_deflate_t* d, const uint8_t* in, size_t len, uint8_t* out, size_t out_len) {
+
+	WS_inf_t s;
+	uint32_t last, type;
+	size_t n, size = sizeof(d->rx_hist);
+	int err;
+
+	memset(&s, 0, sizeof(s));
+	s.in = in;
+	s.in_len = len;
+	s.out = out;
+	s.out_len = out_len;
+	s.d = d;
+	s.hist = d->client_takeover ? d->rx_fill : 0;
+	do {
+		//补上的空存储块也解完了，消息结束
+		if (s.in_pos == s.in_len + WS_DFL_TAIL_L && s.bitcnt == 0)
+			break;
+		last = ws_inf_bits(&s, 1);
+		type = ws_inf_bits(&s, 2);
+		if (s.err)
+			return -1;
+		if (type == 0)
+			err = ws_inf_stored(&s);
+		else if (type == 1)
+			err = ws_inf_fixed(&s);
+		else if (type == 2)
+			err = ws_inf_dynamic(&s);
+		else
+			err = -1;
+		if (err != 0)
+			return err;
+	} while (!last);
+	d->rx_wire += len;
+	d->rx_raw += s.out_pos;
+	if (!d->client_takeover)
+		return s.out_pos;
+	//本条消息放进历史环，只留最近size字节
+	n = s.out_pos < size ? s.out_pos : size;
+	out += s.out_pos - n;
+	if (d->rx_pos + n > size) {
+		memcpy(d->rx_hist + d->rx_pos, out, size - d->rx_pos);
+		memcpy(d->rx_hist, out + size - d->rx_pos, n - (size - d->rx_pos));
+	} else {
+		memcpy(d->rx_hist + d->rx_pos, out, n);
+	}
+	d->rx_pos = (d->rx_pos + n) & (size - 1);
+	d->rx_fill = d->rx_fill + n > size ? size : d->rx_fill + n;
+	return s.out_pos;
+}
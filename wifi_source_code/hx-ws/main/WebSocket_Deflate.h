@@ -0,0 +1,81 @@
+#ifndef	_WEBSOCKET_DEFLATE_H_
+#define _WEBSOCKET_DEFLATE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define WS_DEFLATE_OPTION			1		/**< \brief Accept permessage-deflate (RFC 7692) in the handshake, 0 sends and accepts plain messages only*/
+#define WS_DEFLATE_SERVER_WBITS		10		/**< \brief Send window, 2^n bytes of history per client, 9..15*/
+#define WS_DEFLATE_CLIENT_WBITS		10		/**< \brief Receive window the client is limited to, 2^n bytes of history per client, 9..15*/
+#define WS_DEFLATE_SERVER_TAKEOVER	1		/**< \brief Keep send history between messages, 0 answers server_no_context_takeover*/
+#define WS_DEFLATE_CLIENT_TAKEOVER	1		/**< \brief Let the client keep history between messages, 0 answers client_no_context_takeover*/
+#define WS_DEFLATE_MIN_LEN			32		/**< \brief Shorter messages are sent uncompressed*/
+#define WS_DEFLATE_MAX_IN			2048	/**< \brief Longer messages are sent uncompressed, bounds the encoder buffers*/
+#define WS_DEFLATE_CHAIN			16		/**< \brief Hash chain steps per match search, more is slower with a better ratio*/
+#define WS_DEFLATE_RESP_L			160		/**< \brief Buffer size for the Sec-WebSocket-Extensions response line*/
+
+
+/** \brief permessage-deflate state of one client*/
+typedef struct{
+	uint8_t		enabled;							/**< \brief Negotiated in the handshake*/
+	uint8_t		server_wbits;						/**< \brief Negotiated send window bits*/
+	uint8_t		client_wbits;						/**< \brief Negotiated receive window bits*/
+	uint8_t		server_takeover;					/**< \brief Send history kept between messages*/
+	uint8_t		client_takeover;					/**< \brief Receive history kept between messages*/
+	uint16_t	tx_len;								/**< \brief Bytes in tx_hist*/
+	uint16_t	rx_fill;							/**< \brief Bytes in rx_hist*/
+	uint16_t	rx_pos;								/**< \brief Next write position in rx_hist*/
+	uint32_t	tx_raw;								/**< \brief Message bytes sent compressed*/
+	uint32_t	tx_wire;							/**< \brief Compressed bytes for them*/
+	uint32_t	rx_raw;								/**< \brief Message bytes received compressed, after inflate*/
+	uint32_t	rx_wire;							/**< \brief Compressed bytes for them*/
+	uint8_t		tx_hist[1 << WS_DEFLATE_SERVER_WBITS];	/**< \brief Last sent bytes, oldest first*/
+	uint8_t		rx_hist[1 << WS_DEFLATE_CLIENT_WBITS];	/**< \brief Last received bytes, ring*/
+}WS_deflate_t;
+
+
+/**
+ * \brief Find a request header by name, ignoring case, only at the start of a line
+ *
+ * \param	req:		null terminated request, may start at a line break
+ * \param	name:		header name including the colon, e.g. "Sec-WebSocket-Key:"
+ *
+ * \return 	The header value right after the colon, NULL when there is no such header
+ */
+const char* WS_header_find(const char* req, const char* name);
+
+/**
+ * \brief Pick the first acceptable permessage-deflate offer of a handshake request
+ *
+ * \param	req:		null terminated request headers
+ * \param	resp:		receives "Sec-WebSocket-Extensions: ...\r\n", or "" when no offer was accepted
+ *
+ * \return 	1:	negotiated, d is reset and enabled
+ * 			0:	no acceptable offer, d is disabled
+ */
+int WS_deflate_negotiate(WS_deflate_t* d, const char* req, char* resp, size_t resp_len);
+
+/**
+ * \brief Compress one message, RFC 7692 framing: sync flushed, trailing 00 00 ff ff removed.
+ * 		  History is not updated, call #WS_deflate_commit once the frame is written.
+ *
+ * \return 	Compressed length, -1 when the message is not worth compressing or does not fit out_len
+ */
+int WS_deflate_compress(WS_deflate_t* d, const uint8_t* in, size_t len, uint8_t* out, size_t out_len);
+
+/**
+ * \brief Account a sent compressed message, keeps it as history when server context takeover is on
+ */
+void WS_deflate_commit(WS_deflate_t* d, const uint8_t* in, size_t len, size_t wire_len);
+
+/**
+ * \brief Inflate one received message, in and out must not overlap
+ *
+ * \return 	Message length
+ * 			-1: corrupt data, the connection must be failed
+ * 			-2: message longer than out_len
+ */
+int WS_deflate_inflate(WS_deflate_t* d, const uint8_t* in, size_t len, uint8_t* out, size_t out_len);
+
+
+#endif /* _WEBSOCKET_DEFLATE_H_ */
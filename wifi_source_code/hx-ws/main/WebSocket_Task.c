@@ -8,6 +8,18 @@
 * @par History:          
 *               Ver0.0.1:
                      hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                     hx-zsj, 2026/10/17, 支持16/64位扩展长度和分片消息重组\n 
+*               Ver0.0.3:
+                     hx-zsj, 2026/10/17, 支持多客户端和广播\n 
+*               Ver0.0.4:
+                     hx-zsj, 2026/10/17, 接收消息改用固定大小内存池，引用计数交接\n 
+*               Ver0.0.5:
+                     hx-zsj, 2026/10/17, 掩码改为按32位字处理\n 
+*               Ver0.0.6:
+                     hx-zsj, 2026/10/17, 定时ping测RTT，长时间无数据的客户端断开，持有WS_tx_lock时不阻塞写\n 
+*               Ver0.0.7:
+                     hx-zsj, 2026/10/17, 支持permessage-deflate压缩\n 
 */
 
 /* 
@@ -16,12 +28,18 @@
 =============
 */
 #include "WebSocket_Task.h"
+#include "WebSocket_Deflate.h"
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_heap_alloc_caps.h"
 #include "hwcrypto/sha.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "wpa2/utils/base64.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -29,208 +47,1454 @@
 #define WS_CLIENT_KEY_L		24		/*client key 长度*/
 #define SHA1_RES_L			20		/*SHA1 result*/
 
-#define WS_STD_LEN			125		/*数据帧长度*/
+#define WS_STD_LEN			125		/*7位长度能表示的最大长度，也是控制帧最大长度*/
+#define WS_EXT16_LEN		0xffff	/*16位扩展长度能表示的最大长度*/
+#define WS_HDR_MAX_L		14		/*帧头最大长度：2+8位扩展长度+4位掩码*/
 #define WS_SPRINTF_ARG_L	4		/*sprintf长度*/
+#define WS_HS_MAX_L			1024	/*握手请求最大长度，浏览器带上扩展头后会超过512*/
+#define WS_RECV_TIMEOUT_MS	1		/*netconn接收超时，小于一个tick，收不到数据立即返回*/
+#define WS_POLL_MS			1000	/*server任务没有事件时的最长等待时间*/
+#define WS_PING_L			4		/*ping数据：4字节序号，pong原样带回*/
+#define WS_RSV1				0x40	/*帧头RSV1位：permessage-deflate压缩的消息*/
+#define WS_WRITE_RETRY_MS	10		/*WS_write_conn发送缓存满时多久重试一次*/
 
-//帧类型
-typedef enum {
-	WS_OP_CON = 0x0, 				/*!< Continuation Frame*/
-	WS_OP_TXT = 0x1, 				/*!< Text Frame*/
-	WS_OP_BIN = 0x2, 				/*!< Binary Frame*/
-	WS_OP_CLS = 0x8, 				/*!< Connection Close Frame*/
-	WS_OP_PIN = 0x9, 				/*!< Ping Frame*/
-	WS_OP_PON = 0xa 				/*!< Pong Frame*/
-} WS_OPCODES;
+//关闭状态码
+#define WS_CLOSE_NORMAL		1000	/*正常关闭*/
+#define WS_CLOSE_GOING_AWAY	1001	/*空闲超时断开*/
+#define WS_CLOSE_PROTOCOL	1002	/*协议错误*/
+#define WS_CLOSE_BAD_DATA	1007	/*压缩数据错误*/
+#define WS_CLOSE_TOO_BIG	1009	/*消息过长*/
+#define WS_CLOSE_INTERNAL	1011	/*内存池用完丢了一条压缩消息，上文对不上了*/
+#define WS_CLOSE_ABORT		1		/*内部使用：不发关闭帧直接断开*/
+
+//控制帧由server自己回复，不对外开放
+#define WS_DATA_OPCODE(op)	((op) == WS_OP_TXT || (op) == WS_OP_BIN)
+
+//最长的消息加结束符必须放得进内存池
+#if WS_POOL_NUM * WS_POOL_BLOCK_L < WS_MAX_MSG_LEN + 1
+#error "WS_POOL_NUM * WS_POOL_BLOCK_L must hold WS_MAX_MSG_LEN + 1 bytes"
+#endif
+
+//按字访问字节缓存，告诉编译器可能和uint8_t别名
+typedef uint32_t __attribute__((__may_alias__)) WS_word_t;
 
 //接收数据队列
 extern QueueHandle_t WebSocket_rx_queue;
 
-//websocket connect 句柄
-static struct netconn* WS_conn = NULL;
+//帧解析状态，数据可能跨越多个netbuf，按字节流增量解析
+typedef struct {
+	uint8_t		hdr[WS_HDR_MAX_L];		/*帧头缓存*/
+	uint8_t		hdr_len;				/*已收到的帧头长度*/
+	uint8_t		hdr_need;				/*帧头总长度，收齐前两字节后才能确定*/
+	uint8_t		opcode;					/*当前帧类型*/
+	uint8_t		fin;					/*当前帧是否为消息最后一帧*/
+	uint8_t		rsv1;					/*当前帧RSV1位*/
+	uint8_t		key[WS_MASK_L];			/*当前帧掩码*/
+	uint64_t	frame_len;				/*当前帧数据长度*/
+	uint64_t	frame_pos;				/*当前帧已收数据长度*/
+	uint8_t		msg_opcode;				/*正在重组的消息类型，WS_OP_CON表示没有*/
+	char*		msg;					/*消息缓存，内存池块，NULL表示内存池用完，这条消息丢弃*/
+	size_t		msg_len;				/*消息已收长度*/
+	uint8_t		ctrl[WS_STD_LEN];		/*控制帧数据，可以插在分片消息之间*/
+	uint8_t		msg_deflate;			/*正在重组的消息是压缩的*/
+	WS_deflate_t*	pmd;				/*握手协商了压缩时指向连接的压缩状态，否则NULL*/
+} WS_parser_t;
+
+//客户端连接
+typedef struct {
+	struct netconn*		conn;				/*NULL表示空闲*/
+	volatile uint8_t	rx_pending;			/*netconn回调置位：有数据或连接关闭待处理*/
+	volatile uint8_t	closing;			/*发送出错，等待server任务关闭*/
+	uint8_t				tx_busy;			/*WS_write_conn正在分段写一帧，写完前其他帧不能插进来，连接也不能删*/
+	uint8_t				open;				/*握手完成*/
+	uint16_t			hs_len;				/*握手请求已收长度*/
+	char				hs[WS_HS_MAX_L];	/*握手请求缓存，请求可能分多个tcp段到达*/
+	WS_parser_t			parser;				/*帧解析状态*/
+	TickType_t			last_rx;			/*最近一次收到数据的时刻，pong也算*/
+	TickType_t			ping_tick;			/*最近一次发ping的时刻*/
+	int64_t				ping_us;			/*等待回复的ping发出时刻，0表示没有*/
+	uint32_t			ping_seq;			/*等待回复的ping序号*/
+	WS_client_stats_t	stats;				/*保活统计*/
+#if WS_DEFLATE_OPTION
+	WS_deflate_t		pmd;				/*permessage-deflate状态*/
+#endif
+} WS_client_t;
+
+//压缩结果缓存：没有上文保留的客户端，压缩结果只和窗口大小有关，广播时共用
+typedef struct {
+	uint8_t		wbits;					/*结果对应的窗口位数，0表示没有结果*/
+	int			len;					/*压缩后长度，<0不压缩*/
+} WS_deflate_cache_t;
+
+//客户端连接表
+static WS_client_t WS_clients[WS_MAX_CLIENTS];
+
+//监听连接
+static struct netconn* WS_listen = NULL;
+
+//server任务，netconn回调通知它处理
+static TaskHandle_t WS_server_task = NULL;
+
+//有新连接待accept
+static volatile uint8_t WS_accept_pending = 0;
+
+//保活参数，单位tick，0表示关闭
+static TickType_t WS_ping_ticks = WS_PING_INTERVAL_MS / portTICK_PERIOD_MS;
+static TickType_t WS_idle_ticks = WS_IDLE_TIMEOUT_MS / portTICK_PERIOD_MS;
+
+#if WS_DEFLATE_OPTION
+//压缩输出，持有WS_tx_lock时使用
+static uint8_t WS_deflate_tx[WS_DEFLATE_MAX_IN];
+//解压输出，server任务使用
+static uint8_t WS_inflate_buf[WS_MAX_MSG_LEN];
+#endif
+
+//发送互斥，保证帧头和数据连续写入，不和其他任务的帧交错；修改连接表也要持有
+//持有时只做NETCONN_DONTBLOCK写，需要等发送缓存的一方先置tx_busy再放开它
+static SemaphoreHandle_t WS_tx_lock = NULL;
+
+//消息内存池：固定大小的块，一条消息占用连续的若干块，server任务重组时取，接收任务用完后按引用计数归还
+static char WS_pool[WS_POOL_NUM][WS_POOL_BLOCK_L];
+static uint8_t WS_pool_ref[WS_POOL_NUM];		/*引用计数，只在首块有效，0表示空闲*/
+static uint8_t WS_pool_run[WS_POOL_NUM];		/*连续块数，只在首块有效*/
+static uint8_t WS_pool_used[WS_POOL_NUM];		/*块被某条消息占用*/
+static WS_pool_stats_t WS_pool_stats;			/*统计*/
+static portMUX_TYPE WS_pool_mux = portMUX_INITIALIZER_UNLOCKED;	/*两个任务可能在不同核上*/
+static char* ws_pool_get(size_t size);
 
 //websocket关键参数
 const char WS_sec_WS_keys[] = "Sec-WebSocket-Key:";
 const char WS_sec_conKey[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-const char WS_srv_hs[] ="HTTP/1.1 101 Switching Protocols \r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %.*s\r\n\r\n";
+const char WS_srv_hs[] ="HTTP/1.1 101 Switching Protocols \r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %.*s\r\n%s\r\n";
 
 /*
-* websocket发送数据
+* 编码服务器帧头，按长度选择7位、16位或64位长度编码
+* @param[out]  hdr  		       :帧头缓存，至少WS_HDR_MAX_L字节
+* @param[in]   opcode  		       :帧类型
+* @param[in]   length  		       :数据长度
+* @retval      size_t              :帧头长度
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static size_t ws_frame_header(uint8_t* hdr, uint8_t opcode, size_t length) {
+
+	size_t i;
+	//服务器发出的帧不加掩码，单帧发完
+	hdr[0] = 0x80 | opcode;
+	if (length <= WS_STD_LEN) {
+		hdr[1] = length;
+		return 2;
+	}
+	if (length <= WS_EXT16_LEN) {
+		hdr[1] = 126;
+		hdr[2] = length >> 8;
+		hdr[3] = length;
+		return 4;
+	}
+	hdr[1] = 127;
+	for (i = 0; i < 8; i++)
+		hdr[2 + i] = (uint64_t) length >> (56 - 8 * i);
+	return 10;
+}
+
+/*
+* 向一个连接写入已编码好帧头的一帧，调用者持有WS_tx_lock
+* @param[in]   conn  		       :websocket connect句柄
+* @param[in]   hdr  		       :帧头
+* @param[in]   hdr_len  		   :帧头长度
 * @param[in]   p_data  		       :数据指针
 * @param[in]   length  		       :数据长度
-* @retval      void                :无
+* @param[in]   flags  		       :NETCONN_DONTBLOCK时发送缓存不够不等待
+* @retval      err_t               :ERR_OK成功，ERR_WOULDBLOCK一个字节都没写(可以跳过这一帧)，
+*                                   其他值帧已写了一部分或连接出错，连接不能再用
 * @note        修改日志 
 *               Ver0.0.1:
-                    hx-zsj, 2018/11/22, 初始化版本\n 
+                    hx-zsj, 2026/10/17, 初始化版本\n 
 */
-err_t WS_write_data(char* p_data, size_t length) {
+static err_t ws_conn_write(struct netconn* conn, const uint8_t* hdr, size_t hdr_len,
+		const void* p_data, size_t length, uint8_t flags) {
 
-	//websocket未连接，直接退出
-	if (WS_conn == NULL)
-		return ERR_CONN;
-	//数据帧长度溢出，直接退出
-	if (length > WS_STD_LEN)
-		return ERR_VAL;
+	size_t written = 0;
 	err_t result;
-	//报头
-	WS_frame_header_t hdr;
-	hdr.FIN = 0x1;
-	hdr.payload_length = length;
-	hdr.mask = 0;
-	hdr.reserved = 0;
-	hdr.opcode = WS_OP_TXT;
-	//发送报头
-	result = netconn_write(WS_conn, &hdr, sizeof(WS_frame_header_t), NETCONN_COPY);
+	//帧头带MORE标志，和数据合在同一个tcp段里发出
+	result = netconn_write_partly(conn, hdr, hdr_len,
+			NETCONN_COPY | flags | (length ? NETCONN_MORE : 0), &written);
 	if (result != ERR_OK)
 		return result;
-	//发送数据
-	return netconn_write(WS_conn, p_data, length, NETCONN_COPY);
+	if (written != hdr_len)
+		return ERR_MEM;
+	if (length == 0)
+		return ERR_OK;
+	written = 0;
+	result = netconn_write_partly(conn, p_data, length, NETCONN_COPY | flags, &written);
+	if (result == ERR_OK && written != length)
+		result = ERR_MEM;
+	//帧头已经发出，数据失败时这一帧已经残缺
+	return result == ERR_WOULDBLOCK ? ERR_MEM : result;
+}
+
+/*
+* 按连接句柄查客户端，调用者持有WS_tx_lock或者在server任务中
+* @param[in]   conn  		       :websocket connect句柄
+* @retval      WS_client_t*        :客户端，NULL连接已关闭
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static WS_client_t* ws_client_find(struct netconn* conn) {
+
+	uint8_t i;
+	for (i = 0; i < WS_MAX_CLIENTS; i++)
+		if (WS_clients[i].conn == conn)
+			return &WS_clients[i];
+	return NULL;
+}
+
+/*
+* websocket发送一帧，server任务使用，不阻塞
+* @param[in]   conn  		       :websocket connect句柄
+* @param[in]   opcode  		       :帧类型
+* @param[in]   p_data  		       :数据指针
+* @param[in]   length  		       :数据长度
+* @retval      err_t               :同ws_conn_write，连接正被WS_write_conn写时返回ERR_WOULDBLOCK
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 帧头编码和写入拆分出去给广播复用\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 改为不阻塞写，帧写了一半时标记关闭\n 
+*/
+static err_t ws_send_frame(struct netconn* conn, uint8_t opcode, const void* p_data, size_t length) {
+
+	uint8_t hdr[WS_HDR_MAX_L];
+	size_t hdr_len = ws_frame_header(hdr, opcode, length);
+	WS_client_t* c;
+	err_t result = ERR_WOULDBLOCK;
+	xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+	c = ws_client_find(conn);
+	if (c != NULL && !c->tx_busy) {
+		result = ws_conn_write(conn, hdr, hdr_len, p_data, length, NETCONN_DONTBLOCK);
+		if (result != ERR_OK && result != ERR_WOULDBLOCK)
+			c->closing = 1;
+	}
+	xSemaphoreGive(WS_tx_lock);
+	return result;
 }
+
 /*
-* websocket server 连接、握手、数据读取
+* websocket发送关闭帧
 * @param[in]   conn  		       :websocket connect句柄
+* @param[in]   code  		       :关闭状态码
 * @retval      void                :无
 * @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_send_close(struct netconn* conn, uint16_t code) {
+
+	uint8_t data[2];
+	data[0] = code >> 8;
+	data[1] = code;
+	ws_send_frame(conn, WS_OP_CLS, data, sizeof(data));
+}
+
+/*
+* 向一个客户端写一条消息，协商了压缩并且压缩后更短时发压缩帧，调用者持有WS_tx_lock
+* @param[in]   c  		           :客户端
+* @param[in]   opcode  		       :帧类型，WS_OP_TXT或WS_OP_BIN
+* @param[in]   hdr  		       :不压缩时的帧头
+* @param[in]   hdr_len  		   :帧头长度
+* @param[in]   p_data  		       :数据指针
+* @param[in]   length  		       :数据长度
+* @param[in]   flags  		       :NETCONN_DONTBLOCK时发送缓存不够不等待
+* @param[in]   cache  		       :压缩结果缓存，一条消息发给多个客户端时共用
+* @retval      err_t               :同ws_conn_write
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               压缩帧写成功后才把消息放进发送历史，跳过的消息客户端没收到，不能进历史
+*/
+static err_t ws_client_write(WS_client_t* c, uint8_t opcode, const uint8_t* hdr, size_t hdr_len,
+		const char* p_data, size_t length, uint8_t flags, WS_deflate_cache_t* cache) {
+
+#if WS_DEFLATE_OPTION
+	uint8_t zhdr[WS_HDR_MAX_L];
+	size_t zhdr_len;
+	err_t result;
+
+	if (c->pmd.enabled) {
+		if (c->pmd.server_takeover || cache->wbits != c->pmd.server_wbits) {
+			cache->len = WS_deflate_compress(&c->pmd, (const uint8_t*) p_data, length,
+					WS_deflate_tx, sizeof(WS_deflate_tx));
+			//保留上文的结果只属于这个客户端
+			cache->wbits = c->pmd.server_takeover ? 0 : c->pmd.server_wbits;
+		}
+		if (cache->len > 0) {
+			zhdr_len = ws_frame_header(zhdr, opcode | WS_RSV1, cache->len);
+			result = ws_conn_write(c->conn, zhdr, zhdr_len, WS_deflate_tx, cache->len, flags);
+			if (result == ERR_OK)
+				WS_deflate_commit(&c->pmd, (const uint8_t*) p_data, length, cache->len);
+			return result;
+		}
+	}
+#endif
+	return ws_conn_write(c->conn, hdr, hdr_len, p_data, length, flags);
+}
+
+/*
+* 广播：帧头只编码一次，数据依次写给所有已握手的客户端
+* @param[in]   opcode  		       :帧类型，WS_OP_TXT或WS_OP_BIN
+* @param[in]   p_data  		       :数据指针
+* @param[in]   length  		       :数据长度
+* @retval      int                 :发送成功的客户端数，帧类型不对返回-1
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 协商了压缩的客户端发压缩帧\n 
+*               发送缓存满的客户端跳过这条消息，不阻塞其他客户端；帧写了一半的客户端会被断开
+*/
+int WS_broadcast_data(WS_OPCODES opcode, char* p_data, size_t length) {
+
+	uint8_t hdr[WS_HDR_MAX_L];
+	size_t hdr_len;
+	WS_deflate_cache_t cache = { 0, -1 };
+	WS_client_t* c;
+	int sent = 0;
+	uint8_t i;
+	err_t result;
+
+	if (!WS_DATA_OPCODE(opcode))
+		return -1;
+	hdr_len = ws_frame_header(hdr, opcode, length);
+	xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+	for (i = 0; i < WS_MAX_CLIENTS; i++) {
+		c = &WS_clients[i];
+		//正被WS_write_conn写的客户端跳过这条消息
+		if (c->conn == NULL || !c->open || c->closing || c->tx_busy)
+			continue;
+		result = ws_client_write(c, opcode, hdr, hdr_len, p_data, length, NETCONN_DONTBLOCK, &cache);
+		if (result == ERR_OK) {
+			sent++;
+		} else if (result != ERR_WOULDBLOCK) {
+			//交给server任务关闭
+			c->closing = 1;
+			xTaskNotifyGive(WS_server_task);
+		}
+	}
+	xSemaphoreGive(WS_tx_lock);
+	return sent;
+}
+
+/*
+* WS_write_conn结束写一帧：清tx_busy，连接在等待期间被要求关闭时通知server任务，调用者持有WS_tx_lock
+* @param[in]   c  		           :客户端
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_write_done(WS_client_t* c) {
+
+	c->tx_busy = 0;
+	if (c->closing)
+		xTaskNotifyGive(WS_server_task);
+}
+
+/*
+* websocket向指定客户端发送数据
+* @param[in]   conn  		       :websocket connect句柄，接收到的WebSocket_frame_t.conenction
+* @param[in]   opcode  		       :帧类型，WS_OP_TXT或WS_OP_BIN
+* @param[in]   p_data  		       :数据指针
+* @param[in]   length  		       :数据长度
+* @retval      err_t               :ERR_CONN连接已断开，ERR_ARG帧类型不对，ERR_TIMEOUT超时一个字节都没发，
+*                                   其他值帧只发了一部分，连接交给server任务关闭
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 发送缓存满时放开WS_tx_lock等待，不再卡住其他发送者和关闭\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 协商了压缩时发压缩帧，压缩结果放在内存池块里\n 
+*               等待期间tx_busy占住这个连接：别的帧跳过它，server任务推迟删除它
+*/
+err_t WS_write_conn(struct netconn* conn, WS_OPCODES opcode, char* p_data, size_t length) {
+
+	uint8_t hdr[WS_HDR_MAX_L];
+	size_t hdr_len;
+	const uint8_t* part[2];
+	size_t left[2];
+	size_t written;
+	uint8_t k = 0;
+	uint8_t* zbuf = NULL;
+	int zlen = -1;
+	TickType_t start = xTaskGetTickCount();
+	TickType_t limit = WS_WRITE_TIMEOUT_MS / portTICK_PERIOD_MS;
+	WS_client_t* c;
+	err_t result;
+
+	if (!WS_DATA_OPCODE(opcode))
+		return ERR_ARG;
+	//占住连接，同一个连接上另一个任务的帧没写完时先等它
+	for (;;) {
+		xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+		c = ws_client_find(conn);
+		if (c == NULL || !c->open || c->closing) {
+			xSemaphoreGive(WS_tx_lock);
+			return ERR_CONN;
+		}
+		if (!c->tx_busy)
+			break;
+		xSemaphoreGive(WS_tx_lock);
+		if (xTaskGetTickCount() - start >= limit)
+			return ERR_TIMEOUT;
+		vTaskDelay(WS_WRITE_RETRY_MS / portTICK_PERIOD_MS + 1);
+	}
+	c->tx_busy = 1;
+	hdr_len = ws_frame_header(hdr, opcode, length);
+	part[0] = hdr;
+	part[1] = (const uint8_t*) p_data;
+	left[1] = length;
+#if WS_DEFLATE_OPTION
+	//直接压缩到内存池块里，等待时放开锁后WS_deflate_tx会被别人用；内存池用完时发不压缩的帧
+	if (c->pmd.enabled && length >= WS_DEFLATE_MIN_LEN && length <= WS_DEFLATE_MAX_IN)
+		zbuf = (uint8_t*) ws_pool_get(WS_DEFLATE_MAX_IN);
+	if (zbuf != NULL) {
+		zlen = WS_deflate_compress(&c->pmd, (const uint8_t*) p_data, length, zbuf, WS_DEFLATE_MAX_IN);
+		if (zlen > 0) {
+			hdr_len = ws_frame_header(hdr, opcode | WS_RSV1, zlen);
+			part[1] = zbuf;
+			left[1] = zlen;
+		} else {
+			WS_payload_release((char*) zbuf);
+			zbuf = NULL;
+		}
+	}
+#endif
+	left[0] = hdr_len;
+	for (;;) {
+		//持有WS_tx_lock，只做不阻塞写；帧头带MORE标志和数据合在同一个tcp段
+		while (k < 2 && left[k] == 0)
+			k++;
+		while (k < 2) {
+			written = 0;
+			result = netconn_write_partly(conn, part[k], left[k],
+					NETCONN_COPY | NETCONN_DONTBLOCK | (k == 0 && left[1] ? NETCONN_MORE : 0), &written);
+			if (result != ERR_OK && result != ERR_WOULDBLOCK) {
+				c->closing = 1;
+				break;
+			}
+			part[k] += written;
+			left[k] -= written;
+			if (left[k] != 0)
+				break;
+			k++;
+		}
+		if (k == 2) {
+#if WS_DEFLATE_OPTION
+			if (zbuf != NULL)
+				WS_deflate_commit(&c->pmd, (const uint8_t*) p_data, length, zlen);
+#endif
+			result = ERR_OK;
+			break;
+		}
+		if (c->closing) {
+			result = result == ERR_OK || result == ERR_WOULDBLOCK ? ERR_CONN : result;
+			break;
+		}
+		if (xTaskGetTickCount() - start >= limit) {
+			//一个字节都没写时连接还能用，否则帧已残缺
+			if (k == 0 && left[0] == hdr_len) {
+				result = ERR_TIMEOUT;
+			} else {
+				c->closing = 1;
+				result = ERR_MEM;
+			}
+			break;
+		}
+		//发送缓存满，放开锁等一会，其他客户端照常收发
+		xSemaphoreGive(WS_tx_lock);
+		vTaskDelay(WS_WRITE_RETRY_MS / portTICK_PERIOD_MS + 1);
+		xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+	}
+	ws_write_done(c);
+	xSemaphoreGive(WS_tx_lock);
+	WS_payload_release((char*) zbuf);
+	return result;
+}
+
+/*
+* websocket发送数据
+* @param[in]   opcode  		       :帧类型，WS_OP_TXT或WS_OP_BIN
+* @param[in]   p_data  		       :数据指针
+* @param[in]   length  		       :数据长度
+* @retval      err_t               :ERR_OK至少发给了一个客户端，ERR_CONN没有连接，ERR_ARG帧类型不对
+* @note        修改日志 
 *               Ver0.0.1:
                     hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 不再限制125字节，超长时用扩展长度，帧类型由调用者指定\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 发给所有客户端\n 
 */
-static void ws_server_netconn_serve(struct netconn *conn) {
+err_t WS_write_data(WS_OPCODES opcode, char* p_data, size_t length) {
+
+	int sent = WS_broadcast_data(opcode, p_data, length);
+	if (sent < 0)
+		return ERR_ARG;
+	//websocket未连接，直接退出
+	return sent > 0 ? ERR_OK : ERR_CONN;
+}
+
+/*
+* 已连接的客户端数
+* @param[in]   void  		       :无
+* @retval      uint8_t             :客户端数
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+uint8_t WS_client_count(void) {
+
+	uint8_t i, n = 0;
+	for (i = 0; i < WS_MAX_CLIENTS; i++)
+		if (WS_clients[i].conn != NULL && WS_clients[i].open)
+			n++;
+	return n;
+}
+
+/*
+* 设置保活参数，立即对所有客户端生效
+* @param[in]   ping_interval_ms    :ping间隔，0不发ping
+* @param[in]   idle_timeout_ms     :多久没收到任何数据就断开，0不断开
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+void WS_set_keepalive(uint32_t ping_interval_ms, uint32_t idle_timeout_ms) {
+
+	//向上取整，不足一个tick的间隔不会变成0
+	WS_ping_ticks = (ping_interval_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+	WS_idle_ticks = (idle_timeout_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+	//server任务可能正按旧参数等待
+	if (WS_server_task != NULL)
+		xTaskNotifyGive(WS_server_task);
+}
+
+/*
+* 读取一个客户端的RTT、保活和压缩统计
+* @param[in]   conn  		       :websocket connect句柄，接收到的WebSocket_frame_t.conenction
+* @param[out]  stats  		       :统计
+* @retval      err_t               :ERR_OK成功，ERR_CONN连接已断开
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+err_t WS_client_get_stats(struct netconn* conn, WS_client_stats_t* stats) {
+
+	err_t result = ERR_CONN;
+	uint8_t i;
+
+	xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+	for (i = 0; i < WS_MAX_CLIENTS; i++) {
+		if (WS_clients[i].conn == conn && WS_clients[i].open) {
+			*stats = WS_clients[i].stats;
+			stats->idle_ms = (xTaskGetTickCount() - WS_clients[i].last_rx) * portTICK_PERIOD_MS;
+#if WS_DEFLATE_OPTION
+			if (WS_clients[i].pmd.enabled) {
+				stats->deflate = 1;
+				stats->deflate_tx_raw = WS_clients[i].pmd.tx_raw;
+				stats->deflate_tx_wire = WS_clients[i].pmd.tx_wire;
+				stats->deflate_rx_raw = WS_clients[i].pmd.rx_raw;
+				stats->deflate_rx_wire = WS_clients[i].pmd.rx_wire;
+			}
+#endif
+			result = ERR_OK;
+			break;
+		}
+	}
+	xSemaphoreGive(WS_tx_lock);
+	return result;
+}
+
+/*
+* 掩码/解掩码：按32位字异或，首尾不对齐的部分按字节处理，dst可以等于src原地处理
+* @param[out]  dst  		       :输出
+* @param[in]   src  		       :输入
+* @param[in]   len  		       :长度
+* @param[in]   key  		       :4字节掩码
+* @param[in]   offset  		       :src第一个字节在帧数据中的位置，分段处理时掩码从这里接着转
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+void WS_mask(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t* key, size_t offset) {
+
+	uint32_t kw, w;
+	uint8_t rk[WS_MASK_L];
+	size_t i;
+
+	//短数据准备字掩码不划算，直接逐字节
+	if (len < 16) {
+		for (i = 0; i < len; i++)
+			dst[i] = src[i] ^ key[(offset + i) & (WS_MASK_L - 1)];
+		return;
+	}
+	//头部逐字节处理到dst按4字节对齐
+	while (len && ((uintptr_t) dst & 3)) {
+		*dst++ = *src++ ^ key[offset++ & (WS_MASK_L - 1)];
+		len--;
+	}
+	//按当前位置转好掩码，字内字节顺序和内存顺序一致，与大小端无关
+	for (i = 0; i < WS_MASK_L; i++)
+		rk[i] = key[(offset + i) & (WS_MASK_L - 1)];
+	memcpy(&kw, rk, WS_MASK_L);
+	if (((uintptr_t) src & 3) == 0) {
+		//src也对齐，直接按字读写，一次处理16字节
+		for (; len >= 16; len -= 16, src += 16, dst += 16) {
+			((WS_word_t*) dst)[0] = ((const WS_word_t*) src)[0] ^ kw;
+			((WS_word_t*) dst)[1] = ((const WS_word_t*) src)[1] ^ kw;
+			((WS_word_t*) dst)[2] = ((const WS_word_t*) src)[2] ^ kw;
+			((WS_word_t*) dst)[3] = ((const WS_word_t*) src)[3] ^ kw;
+		}
+		for (; len >= 4; len -= 4, src += 4, dst += 4)
+			*(WS_word_t*) dst = *(const WS_word_t*) src ^ kw;
+	} else {
+		//src不对齐，memcpy读入，编译器按平台生成不对齐读取
+		for (; len >= 4; len -= 4, src += 4, dst += 4) {
+			memcpy(&w, src, 4);
+			*(WS_word_t*) dst = w ^ kw;
+		}
+	}
+	//尾部
+	for (i = 0; i < len; i++)
+		dst[i] = src[i] ^ rk[i];
+}
+
+/*
+* 初始化消息内存池
+* @param[in]   void  		       :无
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_pool_init(void) {
+
+	portENTER_CRITICAL(&WS_pool_mux);
+	memset(WS_pool_ref, 0, sizeof(WS_pool_ref));
+	memset(WS_pool_run, 0, sizeof(WS_pool_run));
+	memset(WS_pool_used, 0, sizeof(WS_pool_used));
+	memset(&WS_pool_stats, 0, sizeof(WS_pool_stats));
+	portEXIT_CRITICAL(&WS_pool_mux);
+}
+
+/*
+* 占用从first开始的n块，调用者持有WS_pool_mux
+* @param[in]   first  		       :首块下标
+* @param[in]   n  		           :块数
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_pool_take(uint8_t first, uint8_t n) {
+
+	memset(&WS_pool_used[first], 1, n);
+	WS_pool_stats.in_use += n;
+	if (WS_pool_stats.in_use > WS_pool_stats.high_water)
+		WS_pool_stats.high_water = WS_pool_stats.in_use;
+}
+
+/*
+* 从内存池取能放下size字节的连续块，引用计数为1，不计入统计
+* @param[in]   size  		       :需要的字节数
+* @retval      char*               :首块地址，NULL没有足够长的连续空闲块
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static char* ws_pool_get(size_t size) {
+
+	uint8_t need = (size + WS_POOL_BLOCK_L - 1) / WS_POOL_BLOCK_L;
+	uint8_t i, n = 0;
+
+	if (need == 0)
+		need = 1;
+	portENTER_CRITICAL(&WS_pool_mux);
+	//首次适配：找第一段够长的空闲块
+	for (i = 0; i < WS_POOL_NUM; i++) {
+		n = WS_pool_used[i] ? 0 : n + 1;
+		if (n == need)
+			break;
+	}
+	if (i == WS_POOL_NUM) {
+		portEXIT_CRITICAL(&WS_pool_mux);
+		return NULL;
+	}
+	i -= need - 1;
+	ws_pool_take(i, need);
+	WS_pool_ref[i] = 1;
+	WS_pool_run[i] = need;
+	portEXIT_CRITICAL(&WS_pool_mux);
+	return WS_pool[i];
+}
+
+/*
+* 为接收的消息从内存池取能放下size字节的连续块，取不到时计入丢弃统计
+* @param[in]   size  		       :需要的字节数，包括结束符
+* @retval      char*               :首块地址，NULL没有足够长的连续空闲块
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static char* ws_pool_alloc(size_t size) {
+
+	char* p = ws_pool_get(size);
+	if (p == NULL) {
+		portENTER_CRITICAL(&WS_pool_mux);
+		WS_pool_stats.exhausted++;
+		portEXIT_CRITICAL(&WS_pool_mux);
+	}
+	return p;
+}
+
+/*
+* 消息地址换算成内存池块下标
+* @param[in]   payload  		   :消息地址
+* @retval      int                 :块下标，-1不是内存池块
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static int ws_pool_index(const char* payload) {
+
+	size_t off = payload - &WS_pool[0][0];
+	if (payload < &WS_pool[0][0] || off >= sizeof(WS_pool) || off % WS_POOL_BLOCK_L)
+		return -1;
+	return off / WS_POOL_BLOCK_L;
+}
+
+/*
+* 正在重组的消息变长：后面的块空闲时原地扩展，否则换一段连续块并拷贝已收数据
+* @param[in]   payload  		   :消息地址，只有server任务持有
+* @param[in]   used  		       :已收数据长度，换块时拷贝这么多
+* @param[in]   size  		       :需要的字节数，包括结束符
+* @retval      char*               :新地址，NULL没有足够长的连续空闲块，原来的块已归还
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static char* ws_pool_grow(char* payload, size_t used, size_t size) {
+
+	int i = ws_pool_index(payload);
+	uint8_t need = (size + WS_POOL_BLOCK_L - 1) / WS_POOL_BLOCK_L;
+	uint8_t j;
+	char* p;
+
+	if (i < 0)
+		return NULL;
+	portENTER_CRITICAL(&WS_pool_mux);
+	if (need <= WS_pool_run[i]) {
+		portEXIT_CRITICAL(&WS_pool_mux);
+		return payload;
+	}
+	for (j = i + WS_pool_run[i]; j < i + need && j < WS_POOL_NUM && !WS_pool_used[j]; j++)
+		;
+	if (j == i + need) {
+		ws_pool_take(i + WS_pool_run[i], need - WS_pool_run[i]);
+		WS_pool_run[i] = need;
+		portEXIT_CRITICAL(&WS_pool_mux);
+		return payload;
+	}
+	portEXIT_CRITICAL(&WS_pool_mux);
+	//临界区外拷贝，最多WS_MAX_MSG_LEN字节
+	p = ws_pool_alloc(size);
+	if (p != NULL)
+		memcpy(p, payload, used);
+	WS_payload_release(payload);
+	return p;
+}
+
+/*
+* 消息多一个使用者，例如转交给另一个任务
+* @param[in]   payload  		   :WebSocket_frame_t.payload
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+void WS_payload_retain(char* payload) {
+
+	int i = ws_pool_index(payload);
+	if (i < 0)
+		return;
+	portENTER_CRITICAL(&WS_pool_mux);
+	if (WS_pool_ref[i] != 0)
+		WS_pool_ref[i]++;
+	portEXIT_CRITICAL(&WS_pool_mux);
+}
+
+/*
+* 使用者用完消息，引用计数为0时归还内存池
+* @param[in]   payload  		   :WebSocket_frame_t.payload
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+void WS_payload_release(char* payload) {
+
+	int i = payload != NULL ? ws_pool_index(payload) : -1;
+	if (i < 0)
+		return;
+	portENTER_CRITICAL(&WS_pool_mux);
+	//重复释放不处理
+	if (WS_pool_ref[i] != 0 && --WS_pool_ref[i] == 0) {
+		memset(&WS_pool_used[i], 0, WS_pool_run[i]);
+		WS_pool_stats.in_use -= WS_pool_run[i];
+		WS_pool_run[i] = 0;
+	}
+	portEXIT_CRITICAL(&WS_pool_mux);
+}
+
+/*
+* 读取内存池统计
+* @param[out]  stats  		       :统计
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+void WS_pool_get_stats(WS_pool_stats_t* stats) {
+
+	portENTER_CRITICAL(&WS_pool_mux);
+	*stats = WS_pool_stats;
+	portEXIT_CRITICAL(&WS_pool_mux);
+}
+
+/*
+* 复位帧解析状态，释放未完成的消息
+* @param[in]   p  		           :解析状态
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 消息缓存归还内存池\n 
+*/
+static void ws_parser_reset(WS_parser_t* p) {
+
+	WS_payload_release(p->msg);
+	memset(p, 0, sizeof(WS_parser_t));
+	p->hdr_need = 2;
+}
+
+/*
+* 帧头收齐，检查帧头并准备接收数据
+* @param[in]   p  		           :解析状态
+* @retval      uint16_t            :0成功，其他为要回复的关闭状态码
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 消息缓存改用内存池块，不再realloc\n 
+*/
+static uint16_t ws_parser_header(WS_parser_t* p) {
+
+	uint8_t len7 = p->hdr[1] & 0x7f;
+	uint8_t i;
+
+	if (len7 == 126) {
+		p->frame_len = ((uint16_t) p->hdr[2] << 8) | p->hdr[3];
+	} else if (len7 == 127) {
+		p->frame_len = 0;
+		for (i = 0; i < 8; i++)
+			p->frame_len = (p->frame_len << 8) | p->hdr[2 + i];
+		//最高位必须为0
+		if (p->frame_len >> 63)
+			return WS_CLOSE_PROTOCOL;
+	} else {
+		p->frame_len = len7;
+	}
+	memcpy(p->key, &p->hdr[p->hdr_need - WS_MASK_L], WS_MASK_L);
+	p->frame_pos = 0;
+	//控制帧只用ctrl缓存
+	if (p->opcode & 0x8)
+		return 0;
+	//续帧必须跟在未结束的消息后面，新消息不能插在未结束的消息中间
+	if ((p->opcode == WS_OP_CON) != (p->msg_opcode != WS_OP_CON))
+		return WS_CLOSE_PROTOCOL;
+	if (p->frame_len > WS_MAX_MSG_LEN - (p->opcode == WS_OP_CON ? p->msg_len : 0))
+		return WS_CLOSE_TOO_BIG;
+	//消息第一帧按帧长度从内存池取连续块，后续分片接在后面，放不下时扩展；取不到时这条消息丢弃，连接保持
+	if (p->opcode != WS_OP_CON) {
+		p->msg_opcode = p->opcode;
+		p->msg_deflate = p->rsv1;
+		p->msg_len = 0;
+		p->msg = ws_pool_alloc(p->frame_len + 1);
+	} else if (p->msg != NULL) {
+		p->msg = ws_pool_grow(p->msg, p->msg_len, p->msg_len + p->frame_len + 1);
+	}
+	return 0;
+}
+
+/*
+* 收到pong，序号和最近一次ping相同时计算RTT；不带序号的主动pong只当作心跳
+* @param[in]   conn  		       :websocket connect句柄
+* @param[in]   data  		       :pong数据
+* @param[in]   len  		       :长度
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_client_pong(struct netconn* conn, const uint8_t* data, size_t len) {
+
+	WS_client_t* c = NULL;
+	uint32_t seq;
+	uint32_t rtt;
+	uint8_t i;
+	//在server任务中执行，连接表不会变
+	for (i = 0; i < WS_MAX_CLIENTS; i++) {
+		if (WS_clients[i].conn == conn) {
+			c = &WS_clients[i];
+			break;
+		}
+	}
+	if (c == NULL || c->ping_us == 0 || len != WS_PING_L)
+		return;
+	seq = ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+	if (seq != c->ping_seq)
+		return;
+	rtt = (uint32_t) (esp_timer_get_time() - c->ping_us);
+	c->ping_us = 0;
+	c->stats.pongs++;
+	c->stats.rtt_us = rtt;
+	if (c->stats.rtt_min_us == 0 || rtt < c->stats.rtt_min_us)
+		c->stats.rtt_min_us = rtt;
+	//平滑RTT：7/8旧值 + 1/8新样本
+	if (c->stats.srtt_us == 0)
+		c->stats.srtt_us = rtt;
+	else
+		c->stats.srtt_us = c->stats.srtt_us - (c->stats.srtt_us >> 3) + (rtt >> 3);
+}
+
+/*
+* 一帧数据收齐，处理控制帧或提交完整消息
+* @param[in]   conn  		       :websocket connect句柄
+* @param[in]   p  		           :解析状态
+* @retval      uint16_t            :0继续，其他为要回复的关闭状态码
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 队列满时归还内存池块，不再泄漏\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, pong交给ws_client_pong计算RTT，回pong不阻塞\n 
+*               Ver0.0.4:
+                    hx-zsj, 2026/10/17, 压缩消息收齐后解压\n 
+*/
+static uint16_t ws_parser_frame(struct netconn* conn, WS_parser_t* p) {
+
+	WebSocket_frame_t __ws_frame;
+	err_t result;
+#if WS_DEFLATE_OPTION
+	int n;
+#endif
+
+	switch (p->opcode) {
+	case WS_OP_CLS:
+		//对方关闭，回关闭帧后断开
+		return WS_CLOSE_NORMAL;
+	case WS_OP_PIN:
+		//ping回pong，数据原样带回；发送缓存满时不回，pong写了一半时断开
+		result = ws_send_frame(conn, WS_OP_PON, p->ctrl, p->frame_len);
+		return (result == ERR_OK || result == ERR_WOULDBLOCK) ? 0 : WS_CLOSE_ABORT;
+	case WS_OP_PON:
+		ws_client_pong(conn, p->ctrl, p->frame_len);
+		return 0;
+	default:
+		break;
+	}
+	p->msg_len += p->frame_len;
+	if (!p->fin)
+		return 0;
+	//内存池用完时这条消息已丢弃
+	if (p->msg == NULL) {
+		p->msg_len = 0;
+		p->msg_opcode = WS_OP_CON;
+		//客户端保留上文时，丢掉一条压缩消息后面的消息就解不开了
+		return (p->msg_deflate && p->pmd->client_takeover) ? WS_CLOSE_INTERNAL : 0;
+	}
+#if WS_DEFLATE_OPTION
+	//压缩消息解到静态缓存再拷回内存池块
+	if (p->msg_deflate) {
+		n = WS_deflate_inflate(p->pmd, (uint8_t*) p->msg, p->msg_len, WS_inflate_buf, WS_MAX_MSG_LEN);
+		if (n == -2)
+			return WS_CLOSE_TOO_BIG;
+		if (n < 0)
+			return WS_CLOSE_BAD_DATA;
+		//解压后变长，块不够时扩展；扩展失败和内存池用完一样丢弃，解压上文已经更新
+		p->msg = ws_pool_grow(p->msg, 0, n + 1);
+		if (p->msg == NULL) {
+			p->msg_len = 0;
+			p->msg_opcode = WS_OP_CON;
+			return 0;
+		}
+		memcpy(p->msg, WS_inflate_buf, n);
+		p->msg_len = n;
+	}
+#endif
+	//消息完整，加个尾巴交给接收任务
+	p->msg[p->msg_len] = 0;
+	__ws_frame.conenction = conn;
+	memset(&__ws_frame.frame_header, 0, sizeof(WS_frame_header_t));
+	__ws_frame.frame_header.FIN = 1;
+	__ws_frame.frame_header.opcode = p->msg_opcode;
+	__ws_frame.frame_header.payload_length = p->msg_len <= WS_STD_LEN ? p->msg_len :
+			(p->msg_len <= WS_EXT16_LEN ? 126 : 127);
+	__ws_frame.payload_length = p->msg_len;
+	__ws_frame.payload = p->msg;
+	//发送给另一个任务解析，引用交给接收任务；队列满时由这里归还
+	if (xQueueSend(WebSocket_rx_queue, &__ws_frame, 0) != pdTRUE) {
+		WS_payload_release(p->msg);
+		portENTER_CRITICAL(&WS_pool_mux);
+		WS_pool_stats.queue_full++;
+		portEXIT_CRITICAL(&WS_pool_mux);
+	}
+	p->msg = NULL;
+	p->msg_len = 0;
+	p->msg_opcode = WS_OP_CON;
+	return 0;
+}
+
+/*
+* 增量解析收到的字节流，一次可以包含多帧或半帧
+* @param[in]   conn  		       :websocket connect句柄
+* @param[in]   p  		           :解析状态
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :长度
+* @retval      uint16_t            :0继续，其他为要回复的关闭状态码
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 解掩码改用WS_mask\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 协商了压缩时接受RSV1\n 
+*/
+static uint16_t ws_parser_feed(struct netconn* conn, WS_parser_t* p,
+		const uint8_t* data, size_t len) {
+
+	size_t pos = 0;
+	size_t n;
+	uint8_t* dst;
+	uint16_t code;
+	uint8_t len7;
+
+	while (pos < len) {
+		//帧头
+		if (p->hdr_len < p->hdr_need) {
+			p->hdr[p->hdr_len++] = data[pos++];
+			if (p->hdr_len == 2) {
+				p->fin = p->hdr[0] >> 7;
+				p->opcode = p->hdr[0] & 0x0f;
+				len7 = p->hdr[1] & 0x7f;
+				//保留位必须为0，协商了压缩时RSV1可以出现在消息第一帧；client发来的帧必须带掩码
+				p->rsv1 = (p->hdr[0] & WS_RSV1) && p->pmd != NULL;
+				if ((p->hdr[0] & (p->rsv1 ? 0x30 : 0x70)) || !(p->hdr[1] & 0x80))
+					return WS_CLOSE_PROTOCOL;
+				if (p->rsv1 && (p->opcode == WS_OP_CON || (p->opcode & 0x8)))
+					return WS_CLOSE_PROTOCOL;
+				if (p->opcode > WS_OP_BIN && p->opcode < WS_OP_CLS)
+					return WS_CLOSE_PROTOCOL;
+				if (p->opcode > WS_OP_PON)
+					return WS_CLOSE_PROTOCOL;
+				//控制帧不能分片，长度不超过125
+				if ((p->opcode & 0x8) && (!p->fin || len7 > WS_STD_LEN))
+					return WS_CLOSE_PROTOCOL;
+				p->hdr_need = 2 + WS_MASK_L + (len7 == 126 ? 2 : (len7 == 127 ? 8 : 0));
+			}
+			if (p->hdr_len < p->hdr_need)
+				continue;
+			code = ws_parser_header(p);
+			if (code != 0)
+				return code;
+		}
+		//数据，边拷贝边解码
+		n = len - pos;
+		if (n > p->frame_len - p->frame_pos)
+			n = p->frame_len - p->frame_pos;
+		dst = (p->opcode & 0x8) ? p->ctrl : (uint8_t*) p->msg;
+		//丢弃的消息只跳过数据
+		if (dst != NULL) {
+			dst += ((p->opcode & 0x8) ? 0 : p->msg_len) + p->frame_pos;
+			WS_mask(dst, data + pos, n, p->key, p->frame_pos);
+		}
+		pos += n;
+		p->frame_pos += n;
+		if (p->frame_pos < p->frame_len)
+			continue;
+		//一帧结束，准备下一帧
+		code = ws_parser_frame(conn, p);
+		if (code != 0)
+			return code;
+		p->hdr_len = 0;
+		p->hdr_need = 2;
+	}
+	return 0;
+}
+
+/*
+* 处理握手请求，请求收齐后回复握手
+* @param[in]   c  		           :客户端
+* @param[in]   data  		       :收到的数据
+* @param[in]   len  		       :长度
+* @retval      int                 :请求之后的数据在data中的偏移，0请求未收齐，<0请求错误
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 改为增量接收请求，支持请求分段到达和后面紧跟数据帧\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 握手回复不阻塞\n 
+*               Ver0.0.4:
+                    hx-zsj, 2026/10/17, 协商permessage-deflate，请求头名称不区分大小写\n 
+*/
+static int ws_client_handshake(WS_client_t* c, const char* data, size_t len) {
 
-	//Netbuf
-	struct netbuf *inbuf;
-	//数据包
-	char *buf;
 	//pointer to buffer (multi purpose)
 	char* p_buf;
-	//Pointer to SHA1 input
-	char* p_SHA1_Inp;
-	//Pointer to SHA1 result
-	char* p_SHA1_result;
-	//multi purpose number buffer
-	uint16_t i;
-	//will point to payload (send and receive
+	char* p_end;
+	//SHA1 input: client key + server key
+	char p_SHA1_Inp[WS_CLIENT_KEY_L + sizeof(WS_sec_conKey)];
+	//SHA1 result
+	unsigned char p_SHA1_result[SHA1_RES_L];
+	//base64结果长度，_base64_encode按size_t写入
+	size_t b64_len;
+	//will point to payload
 	char* p_payload;
-	//Frame header pointer
-	WS_frame_header_t* p_frame_hdr;
-	//申请SHA1
-	p_SHA1_Inp = pvPortMallocCaps(WS_CLIENT_KEY_L + sizeof(WS_sec_conKey),
+	//Sec-WebSocket-Extensions回复行
+	char p_ext[WS_DEFLATE_RESP_L];
+	size_t n = len;
+	size_t written = 0;
+	int used;
+
+	//保留一个字节放结束符
+	if (n > (size_t) (WS_HS_MAX_L - 1 - c->hs_len))
+		n = WS_HS_MAX_L - 1 - c->hs_len;
+	memcpy(c->hs + c->hs_len, data, n);
+	c->hs[c->hs_len + n] = 0;
+	p_end = strstr(c->hs, "\r\n\r\n");
+	if (p_end == NULL) {
+		c->hs_len += n;
+		//缓存满了还没收齐，请求过长
+		return c->hs_len >= WS_HS_MAX_L - 1 ? -1 : 0;
+	}
+	//本次数据中请求结束的位置，后面是数据帧
+	used = p_end + 4 - c->hs - c->hs_len;
+	*p_end = 0;
+	//搜索client的key，请求头名不区分大小写
+	p_buf = (char*) WS_header_find(c->hs, WS_sec_WS_keys);
+	if (p_buf == NULL)
+		return -1;
+	while (*p_buf == ' ')
+		p_buf++;
+	if (strlen(p_buf) < WS_CLIENT_KEY_L)
+		return -1;
+	//client key在前，server key在后
+	memcpy(p_SHA1_Inp, p_buf, WS_CLIENT_KEY_L);
+	memcpy(p_SHA1_Inp + WS_CLIENT_KEY_L, WS_sec_conKey, sizeof(WS_sec_conKey));
+	// 计算 hash
+	esp_sha(SHA1, (unsigned char*) p_SHA1_Inp, strlen(p_SHA1_Inp), p_SHA1_result);
+	//转base64
+	p_buf = (char*) _base64_encode(p_SHA1_result, SHA1_RES_L, &b64_len);
+	if (p_buf == NULL)
+		return -1;
+	p_ext[0] = 0;
+#if WS_DEFLATE_OPTION
+	//协商permessage-deflate
+	WS_deflate_negotiate(&c->pmd, c->hs, p_ext, sizeof(p_ext));
+#endif
+	//申请“握手”内存
+	p_payload = pvPortMallocCaps(sizeof(WS_srv_hs) + b64_len - WS_SPRINTF_ARG_L + strlen(p_ext),
 			MALLOC_CAP_8BIT);
-	//申请SHA1 result
-	p_SHA1_result = pvPortMallocCaps(SHA1_RES_L, MALLOC_CAP_8BIT);
-	//Check if malloc suceeded
-	if ((p_SHA1_Inp != NULL) && (p_SHA1_result != NULL)) {
-
-		//接收“连接”过程的数据
-		if (netconn_recv(conn, &inbuf) == ERR_OK) {
-			//读取“连接”过程的数据到buf
-			netbuf_data(inbuf, (void**) &buf, &i);
-			//把server的key传给SHA1
-			for (i = 0; i < sizeof(WS_sec_conKey); i++)
-			{
-				//放在后24字节
-				p_SHA1_Inp[i + WS_CLIENT_KEY_L] = WS_sec_conKey[i];
-			}
-			//搜索client的key
-			p_buf = strstr(buf, WS_sec_WS_keys);
-			//找到key
-			if (p_buf != NULL) {
-				//get Client Key
-				for (i = 0; i < WS_CLIENT_KEY_L; i++)
-				{
-					//放在前24字节
-					p_SHA1_Inp[i] = *(p_buf + sizeof(WS_sec_WS_keys) + i);
-				}
-				// 计算 hash
-				esp_sha(SHA1, (unsigned char*) p_SHA1_Inp, strlen(p_SHA1_Inp),
-						(unsigned char*) p_SHA1_result);
-				//转base64
-				p_buf = (char*) _base64_encode((unsigned char*) p_SHA1_result,
-						SHA1_RES_L, (size_t*) &i);
-				//free SHA1 input
-				free(p_SHA1_Inp);
-				//free SHA1 result
-				free(p_SHA1_result);
-				//申请“握手”内存
-				p_payload = pvPortMallocCaps(
-						sizeof(WS_srv_hs) + i - WS_SPRINTF_ARG_L,
-						MALLOC_CAP_8BIT);
-				if (p_payload != NULL) {
-					//准备“握手”帧
-					sprintf(p_payload, WS_srv_hs, i - 1, p_buf);
-					//发送“握手”帧
-					netconn_write(conn, p_payload, strlen(p_payload),NETCONN_COPY);
-					//free base64
-					free(p_buf);
-					//free “握手”内存
-					free(p_payload);
-					//websocket连接成功
-					WS_conn = conn;
-					//“接收数据”
-					while (netconn_recv(conn, &inbuf) == ERR_OK) {
-						//读取数据到buf
-						netbuf_data(inbuf, (void**) &buf, &i);
-						//扔到p_frame_hdr
-						p_frame_hdr = (WS_frame_header_t*) buf;
-						//此帧是“连接关闭”帧，直接退出
-						if (p_frame_hdr->opcode == WS_OP_CLS)
-							break;
-						//有效数据帧长度判断
-						if (p_frame_hdr->payload_length <= WS_STD_LEN) {
-							//数据扔到p_buf
-							p_buf = (char*) &buf[sizeof(WS_frame_header_t)];
-							//check if content is masked
-							if (p_frame_hdr->mask) {
-								//申请内存
-								p_payload = pvPortMallocCaps(
-										p_frame_hdr->payload_length + 1,
-										MALLOC_CAP_8BIT);
-								//申请内存成功
-								if (p_payload != NULL) {
-									//解码
-									for (i = 0; i < p_frame_hdr->payload_length;
-											i++)
-										p_payload[i] = (p_buf + WS_MASK_L)[i]
-												^ p_buf[i % WS_MASK_L];
-											
-									//加个尾巴
-									p_payload[p_frame_hdr->payload_length] = 0;
-								}
-							} else{
-								//content is not masked
-								p_payload = p_buf;
-							}
-
-							//有效数据
-							if ((p_payload != NULL)	&& (p_frame_hdr->opcode == WS_OP_TXT)) {
-								//组包
-								WebSocket_frame_t __ws_frame;
-								__ws_frame.conenction=conn;
-								__ws_frame.frame_header=*p_frame_hdr;
-								__ws_frame.payload_length=p_frame_hdr->payload_length;
-								__ws_frame.payload=p_payload;
-
-								//发送给另一个任务解析
-								xQueueSendFromISR(WebSocket_rx_queue,&__ws_frame,0);
-							}
-							//free payload buffer (in this demo done by the receive task)
-//							if (p_frame_hdr->mask && p_payload != NULL)
-//								free(p_payload);
-						} //数据中超长
-						//清空buf
-						netbuf_delete(inbuf);
-					} //有效数据读取失败
-				} //握手内存申请失败
-			} //连接过程无key
-		} //连接数据读取失败
-	} //p_SHA1_Inp!=NULL&p_SHA1_result!=NULL
-
-	//清空连接
-	WS_conn = NULL;
-	//清空buf
-	netbuf_delete(inbuf);
+	if (p_payload == NULL) {
+		free(p_buf);
+		return -1;
+	}
+	//准备“握手”帧
+	sprintf(p_payload, WS_srv_hs, (int) b64_len - 1, p_buf, p_ext);
+	//发送“握手”帧：open置位前没有其他任务写这个连接，不用持锁；新连接发送缓存是空的，写不完整就断开
+	if (netconn_write_partly(c->conn, p_payload, strlen(p_payload), NETCONN_COPY | NETCONN_DONTBLOCK, &written) != ERR_OK
+			|| written != strlen(p_payload)) {
+		free(p_buf);
+		free(p_payload);
+		return -1;
+	}
+	xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+	c->open = 1;
+	xSemaphoreGive(WS_tx_lock);
+	//free base64
+	free(p_buf);
+	//free “握手”内存
+	free(p_payload);
+	ws_parser_reset(&c->parser);
+#if WS_DEFLATE_OPTION
+	c->parser.pmd = c->pmd.enabled ? &c->pmd : NULL;
+#endif
+	return used;
+}
+
+/*
+* 处理一个客户端收到的一段数据
+* @param[in]   c  		           :客户端
+* @param[in]   data  		       :数据
+* @param[in]   len  		       :长度
+* @retval      uint16_t            :0继续，其他为关闭状态码
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static uint16_t ws_client_input(WS_client_t* c, const uint8_t* data, size_t len) {
+
+	int used;
+	if (!c->open) {
+		used = ws_client_handshake(c, (const char*) data, len);
+		if (used < 0)
+			return WS_CLOSE_ABORT;
+		if (!c->open)
+			return 0;
+		data += used;
+		len -= used;
+	}
+	return len ? ws_parser_feed(c->conn, &c->parser, data, len) : 0;
+}
+
+/*
+* 关闭客户端连接，释放连接表位置
+* @param[in]   c  		           :客户端
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 其他任务正在写这个连接时推迟关闭\n 
+*/
+static void ws_client_close(WS_client_t* c) {
+
+	struct netconn* conn = c->conn;
+	//先从表中摘掉，其他任务就不会再往这个连接写
+	xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+	//WS_write_conn正在等发送缓存，它看到closing会放弃并通知server任务再来关
+	if (c->tx_busy) {
+		c->closing = 1;
+		xSemaphoreGive(WS_tx_lock);
+		return;
+	}
+	c->conn = NULL;
+	c->open = 0;
+	c->closing = 0;
+	c->rx_pending = 0;
+	c->hs_len = 0;
+	xSemaphoreGive(WS_tx_lock);
+	ws_parser_reset(&c->parser);
 	//关闭websocket server connect
 	netconn_close(conn);
 	netconn_delete(conn);
+}
 
+/*
+* 读取客户端所有已到达的数据，直到没有数据
+* @param[in]   c  		           :客户端
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 改为增量帧解析，支持扩展长度、分片重组和ping/close\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 改为非阻塞读取，一个任务服务多个客户端\n 
+*               Ver0.0.4:
+                    hx-zsj, 2026/10/17, 记录最近收到数据的时刻，空闲超时用\n 
+*/
+static void ws_client_poll(WS_client_t* c) {
+
+	//Netbuf
+	struct netbuf *inbuf;
+	//数据包
+	char *buf;
+	uint16_t len;
+	//要回复的关闭状态码，0表示连接正常
+	uint16_t close_code = 0;
+	err_t err;
+
+	if (c->closing) {
+		ws_client_close(c);
+		return;
+	}
+	//先清标志再读，读的过程中新到的数据会重新置位
+	c->rx_pending = 0;
+	while (close_code == 0) {
+		err = netconn_recv(c->conn, &inbuf);
+		//数据读完了
+		if (err == ERR_TIMEOUT || err == ERR_WOULDBLOCK)
+			return;
+		//对方断开或出错
+		if (err != ERR_OK) {
+			close_code = WS_CLOSE_ABORT;
+			break;
+		}
+		c->last_rx = xTaskGetTickCount();
+		//一个netbuf可能有多个pbuf，逐段喂给解析器
+		do {
+			netbuf_data(inbuf, (void**) &buf, &len);
+			close_code = ws_client_input(c, (uint8_t*) buf, len);
+		} while (close_code == 0 && netbuf_next(inbuf) >= 0);
+		//清空buf
+		netbuf_delete(inbuf);
+	}
+	//对方关闭或者协议错误，回关闭帧
+	if (close_code != WS_CLOSE_ABORT)
+		ws_send_close(c->conn, close_code);
+	ws_client_close(c);
+}
+
+/*
+* 客户端保活：到时间发ping，超过空闲时间没收到任何数据就断开
+* @param[in]   c  		           :客户端
+* @param[in]   now  		       :当前tick
+* @retval      TickType_t          :距离这个客户端下次需要处理的tick数
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*               ping和关闭帧都不阻塞，对方不读数据时不能卡住server任务
+*/
+static TickType_t ws_client_timer(WS_client_t* c, TickType_t now) {
+
+	uint8_t hdr[WS_HDR_MAX_L];
+	uint8_t data[WS_PING_L];
+	size_t hdr_len;
+	TickType_t idle = now - c->last_rx;
+	TickType_t since;
+	TickType_t wait = portMAX_DELAY;
+	err_t result;
+
+	if (WS_idle_ticks != 0) {
+		if (idle >= WS_idle_ticks) {
+			//对方失联，尽量发个关闭帧，不等回复
+			if (c->open)
+				ws_send_close(c->conn, WS_CLOSE_GOING_AWAY);
+			ws_client_close(c);
+			return portMAX_DELAY;
+		}
+		wait = WS_idle_ticks - idle;
+	}
+	//握手完成后才能发ping；关闭推迟中的连接不再发
+	if (!c->open || c->closing || WS_ping_ticks == 0)
+		return wait;
+	since = now - c->ping_tick;
+	if (since >= WS_ping_ticks) {
+		//上一个ping没回也照发，迟到的旧pong序号对不上会被忽略
+		c->ping_seq++;
+		data[0] = c->ping_seq >> 24;
+		data[1] = c->ping_seq >> 16;
+		data[2] = c->ping_seq >> 8;
+		data[3] = c->ping_seq;
+		hdr_len = ws_frame_header(hdr, WS_OP_PIN, WS_PING_L);
+		xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+		//WS_write_conn正在写一帧时当作发送缓存满
+		result = c->tx_busy ? ERR_WOULDBLOCK :
+				ws_conn_write(c->conn, hdr, hdr_len, data, WS_PING_L, NETCONN_DONTBLOCK);
+		xSemaphoreGive(WS_tx_lock);
+		if (result == ERR_OK) {
+			c->ping_us = esp_timer_get_time();
+			c->stats.pings++;
+		} else if (result != ERR_WOULDBLOCK) {
+			//ping写了一半，马上回来关闭
+			c->closing = 1;
+			return 0;
+		}
+		//发送缓存满时这一轮不发，下个间隔再试
+		c->ping_tick = now;
+		since = 0;
+	}
+	if (WS_ping_ticks - since < wait)
+		wait = WS_ping_ticks - since;
+	return wait;
+}
+
+/*
+* 新连接放进连接表，表满直接关闭
+* @param[in]   conn  		       :新连接
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_client_open(struct netconn* conn) {
+
+	uint8_t i;
+	for (i = 0; i < WS_MAX_CLIENTS; i++) {
+		if (WS_clients[i].conn == NULL) {
+			//接收不阻塞，server任务靠netconn回调知道哪个连接有数据
+			netconn_set_recvtimeout(conn, WS_RECV_TIMEOUT_MS);
+			WS_clients[i].hs_len = 0;
+			WS_clients[i].open = 0;
+			WS_clients[i].closing = 0;
+			WS_clients[i].tx_busy = 0;
+			WS_clients[i].last_rx = xTaskGetTickCount();
+			WS_clients[i].ping_tick = WS_clients[i].last_rx;
+			WS_clients[i].ping_us = 0;
+			memset(&WS_clients[i].stats, 0, sizeof(WS_client_stats_t));
+#if WS_DEFLATE_OPTION
+			WS_clients[i].pmd.enabled = 0;
+#endif
+			//accept之前到达的数据没有触发置位，先读一次
+			WS_clients[i].rx_pending = 1;
+			xSemaphoreTake(WS_tx_lock, portMAX_DELAY);
+			WS_clients[i].conn = conn;
+			xSemaphoreGive(WS_tx_lock);
+			return;
+		}
+	}
+	netconn_close(conn);
+	netconn_delete(conn);
+}
+
+/*
+* netconn事件回调，在tcpip任务中执行，只做标记和通知
+* @param[in]   conn  		       :产生事件的连接
+* @param[in]   evt  		       :事件
+* @param[in]   len  		       :长度
+* @retval      void                :无
+* @note        修改日志 
+*               Ver0.0.1:
+                    hx-zsj, 2026/10/17, 初始化版本\n 
+*/
+static void ws_netconn_cb(struct netconn* conn, enum netconn_evt evt, u16_t len) {
+
+	uint8_t i;
+	//只关心收到数据、新连接和连接关闭，它们都是RCVPLUS
+	if (evt != NETCONN_EVT_RCVPLUS)
+		return;
+	if (conn == WS_listen) {
+		WS_accept_pending = 1;
+	} else {
+		for (i = 0; i < WS_MAX_CLIENTS; i++) {
+			if (WS_clients[i].conn == conn) {
+				WS_clients[i].rx_pending = 1;
+				break;
+			}
+		}
+	}
+	if (WS_server_task != NULL)
+		xTaskNotifyGive(WS_server_task);
 }
 
 /*
@@ -240,23 +1504,53 @@ static void ws_server_netconn_serve(struct netconn *conn) {
 * @note        修改日志 
 *               Ver0.0.1:
                     hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 一个任务同时服务WS_MAX_CLIENTS个客户端\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 按最近的保活定时计算等待时间\n 
 */
 void ws_server(void *pvParameters) 
 {
-	struct netconn *conn, *newconn;
-	//获取tcp socket connect
-	conn = netconn_new(NETCONN_TCP);
+	struct netconn *newconn;
+	uint8_t i;
+	TickType_t now, wait, t;
+	//发送互斥
+	WS_tx_lock = xSemaphoreCreateMutex();
+	WS_server_task = xTaskGetCurrentTaskHandle();
+	ws_pool_init();
+	//获取tcp socket connect，带事件回调，accept出来的连接继承同一个回调
+	WS_listen = netconn_new_with_callback(NETCONN_TCP, ws_netconn_cb);
+	//accept不阻塞
+	netconn_set_recvtimeout(WS_listen, WS_RECV_TIMEOUT_MS);
 	//绑定port
-	netconn_bind(conn, NULL, WS_PORT);
+	netconn_bind(WS_listen, NULL, WS_PORT);
 	//监听
-	netconn_listen(conn);
-	//等待client连接
-	while (netconn_accept(conn, &newconn) == ERR_OK)
+	netconn_listen(WS_listen);
+	wait = WS_POLL_MS / portTICK_PERIOD_MS;
+	while (1)
 	{
-		//新连接：等待连接、连接过程、数据读取
-		ws_server_netconn_serve(newconn);
+		//等待netconn回调、其他任务通知或最近的保活定时
+		ulTaskNotifyTake(pdTRUE, wait);
+		//新连接
+		if (WS_accept_pending) {
+			WS_accept_pending = 0;
+			while (netconn_accept(WS_listen, &newconn) == ERR_OK)
+				ws_client_open(newconn);
+		}
+		//有数据、已断开或需要关闭的客户端
+		for (i = 0; i < WS_MAX_CLIENTS; i++) {
+			if (WS_clients[i].conn != NULL && (WS_clients[i].rx_pending || WS_clients[i].closing))
+				ws_client_poll(&WS_clients[i]);
+		}
+		//保活：发ping、断开空闲客户端
+		now = xTaskGetTickCount();
+		wait = WS_POLL_MS / portTICK_PERIOD_MS;
+		for (i = 0; i < WS_MAX_CLIENTS; i++) {
+			if (WS_clients[i].conn == NULL)
+				continue;
+			t = ws_client_timer(&WS_clients[i], now);
+			if (t < wait)
+				wait = t;
+		}
 	}
-	//关闭websocket server connect
-	netconn_close(conn);
-	netconn_delete(conn);
 }
@@ -33,8 +33,25 @@
 #include "lwip/api.h"
 
 #define WS_MASK_L		0x4		/**< \brief Length of MASK field in WebSocket Header*/
+#define WS_MAX_CLIENTS	8		/**< \brief Number of clients served at the same time*/
+#define WS_POOL_BLOCK_L	2048	/**< \brief Payload pool block size, a longer message takes several consecutive blocks*/
+#define WS_POOL_NUM		12		/**< \brief Number of payload pool blocks, covers the rx queue plus one message being reassembled per client*/
+#define WS_MAX_MSG_LEN	8192	/**< \brief Largest reassembled message, longer ones are closed with 1009*/
+#define WS_PING_INTERVAL_MS	10000	/**< \brief Default ping period per client, see #WS_set_keepalive*/
+#define WS_IDLE_TIMEOUT_MS	30000	/**< \brief Default idle timeout, a client that sends nothing (not even a pong) this long is closed*/
+#define WS_WRITE_TIMEOUT_MS	5000	/**< \brief Longest #WS_write_conn waits for a client that does not read*/
 
 
+/** \brief Opcode according to RFC 6455*/
+typedef enum {
+	WS_OP_CON = 0x0, 				/*!< Continuation Frame*/
+	WS_OP_TXT = 0x1, 				/*!< Text Frame*/
+	WS_OP_BIN = 0x2, 				/*!< Binary Frame*/
+	WS_OP_CLS = 0x8, 				/*!< Connection Close Frame*/
+	WS_OP_PIN = 0x9, 				/*!< Ping Frame*/
+	WS_OP_PON = 0xa 				/*!< Pong Frame*/
+} WS_OPCODES;
+
 /** \brief Websocket frame header type*/
 typedef struct {
 	uint8_t opcode :WS_MASK_L;
@@ -48,20 +65,113 @@ typedef struct {
 typedef struct{
 	struct netconn* 	conenction;
 	WS_frame_header_t	frame_header;
-	size_t				payload_length;
-	char*				payload;
+	size_t				payload_length;	/**< \brief Length of the reassembled message*/
+	char*				payload;		/**< \brief Reassembled message, null terminated, pool block released with #WS_payload_release*/
 }WebSocket_frame_t;
 
+/** \brief Payload pool statistics*/
+typedef struct{
+	uint16_t			in_use;			/**< \brief Blocks currently held, including compressed frames #WS_write_conn is sending*/
+	uint16_t			high_water;		/**< \brief Most blocks ever held at once*/
+	uint32_t			exhausted;		/**< \brief Messages dropped because no run of free blocks was long enough*/
+	uint32_t			queue_full;		/**< \brief Messages dropped because the rx queue was full*/
+}WS_pool_stats_t;
+
+/** \brief Per client keepalive and compression statistics*/
+typedef struct{
+	uint32_t			rtt_us;			/**< \brief Round trip time of the last answered ping, 0 until the first pong*/
+	uint32_t			srtt_us;		/**< \brief Smoothed round trip time, 7/8 old + 1/8 new sample*/
+	uint32_t			rtt_min_us;		/**< \brief Lowest round trip time seen*/
+	uint32_t			idle_ms;		/**< \brief Time since the client last sent anything*/
+	uint32_t			pings;			/**< \brief Pings sent*/
+	uint32_t			pongs;			/**< \brief Pongs that matched the last ping*/
+	uint8_t				deflate;		/**< \brief permessage-deflate negotiated*/
+	uint32_t			deflate_tx_raw;	/**< \brief Message bytes sent compressed*/
+	uint32_t			deflate_tx_wire;/**< \brief Compressed bytes for them*/
+	uint32_t			deflate_rx_raw;	/**< \brief Message bytes received compressed*/
+	uint32_t			deflate_rx_wire;/**< \brief Compressed bytes for them*/
+}WS_client_stats_t;
+
 
 /**
- * \brief Send data to the websocket client
+ * \brief Send data to all websocket clients, 16/64 bit extended length is used above 125 bytes
+ *
+ * \param	opcode:		#WS_OP_TXT or #WS_OP_BIN
+ *
+ * \return 	#ERR_CONN:	There is no open connection
+ * 			#ERR_ARG:	opcode is not a data opcode
+ * 			#ERR_OK:	Sent to at least one client
+ */
+err_t WS_write_data(WS_OPCODES opcode, char* p_data, size_t length);
+
+/**
+ * \brief Send data to one websocket client
+ *
+ * Waits for send buffer space without holding the global send lock, so a client
+ * that stops reading only delays its own writers.
  *
- * \return 	#ERR_VAL: 	Payload length exceeded 2^7 bytes.
- * 			#ERR_CONN:	There is no open connection
+ * \param	conn:		#WebSocket_frame_t.conenction of a received frame
+ * \param	opcode:		#WS_OP_TXT or #WS_OP_BIN, e.g. the opcode of a received message to echo it back unchanged
+ *
+ * \return 	#ERR_CONN:	The client is gone
+ * 			#ERR_ARG:	opcode is not a data opcode
  * 			#ERR_OK:	Header and payload send
- * 			all other values: derived from #netconn_write (sending frame header or payload)
+ * 			#ERR_TIMEOUT:	Nothing was sent within #WS_WRITE_TIMEOUT_MS, the client stays open
+ * 			all other values: the frame was cut short and the client is being closed
+ */
+err_t WS_write_conn(struct netconn* conn, WS_OPCODES opcode, char* p_data, size_t length);
+
+/**
+ * \brief Broadcast to all websocket clients, the frame header is encoded once.
+ * 		  Clients whose send buffer is full skip this message instead of blocking the others.
+ *
+ * \param	opcode:		#WS_OP_TXT or #WS_OP_BIN
+ *
+ * \return 	Number of clients the message was sent to, -1 if opcode is not a data opcode
+ */
+int WS_broadcast_data(WS_OPCODES opcode, char* p_data, size_t length);
+
+/**
+ * \brief Number of clients that finished the handshake
+ */
+uint8_t WS_client_count(void);
+
+/**
+ * \brief Set ping period and idle timeout for all clients, 0 disables either
+ */
+void WS_set_keepalive(uint32_t ping_interval_ms, uint32_t idle_timeout_ms);
+
+/**
+ * \brief Read RTT, keepalive and compression statistics of one client
+ *
+ * \param	conn:		#WebSocket_frame_t.conenction of a received frame
+ *
+ * \return 	#ERR_CONN:	The client is gone
+ * 			#ERR_OK:	stats filled in
+ */
+err_t WS_client_get_stats(struct netconn* conn, WS_client_stats_t* stats);
+
+/**
+ * \brief Mask or unmask len bytes with a 4 byte key, word at a time, dst may equal src.
+ *
+ * \param	offset:		position of src[0] in the frame payload, keeps the key rotation across segments
+ */
+void WS_mask(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t* key, size_t offset);
+
+/**
+ * \brief Take one more reference on a received payload, e.g. before handing it to another task
+ */
+void WS_payload_retain(char* payload);
+
+/**
+ * \brief Drop one reference on a received payload, the block returns to the pool at zero
+ */
+void WS_payload_release(char* payload);
+
+/**
+ * \brief Read payload pool statistics
  */
-err_t WS_write_data(char* p_data, size_t length);
+void WS_pool_get_stats(WS_pool_stats_t* stats);
 
 /**
  * \brief WebSocket Server task
@@ -8,6 +8,14 @@
 * @par History:          
 *               Ver0.0.1:
                      hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                     hx-zsj, 2026/10/17, 按收到的帧类型回发\n 
+*               Ver0.0.3:
+                     hx-zsj, 2026/10/17, 多客户端时回发给发送者\n 
+*               Ver0.0.4:
+                     hx-zsj, 2026/10/17, 消息用完归还内存池\n 
+*               Ver0.0.5:
+                     hx-zsj, 2026/10/17, 解压调用链加深，ws_server栈改为3072\n 
 */
 
 #include "freertos/FreeRTOS.h"
@@ -40,6 +48,12 @@ QueueHandle_t WebSocket_rx_queue;
 * @note        修改日志 
 *               Ver0.0.1:
                     hx-zsj, 2018/11/22, 初始化版本\n 
+*               Ver0.0.2:
+                    hx-zsj, 2026/10/17, 二进制消息按二进制帧回发\n 
+*               Ver0.0.3:
+                    hx-zsj, 2026/10/17, 回发给发送数据的客户端\n 
+*               Ver0.0.4:
+                    hx-zsj, 2026/10/17, 消息归还内存池，不再free\n 
 */
 void task_process_WebSocket( void *pvParameters )
 {
@@ -62,12 +76,12 @@ void task_process_WebSocket( void *pvParameters )
             {
                 LED_OFF();
             }else {
-                //把接收到的数据回发
-                WS_write_data(__RX_frame.payload, __RX_frame.payload_length);
+                //把接收到的数据按原来的帧类型回发给发送者
+                WS_write_conn(__RX_frame.conenction, __RX_frame.frame_header.opcode,
+                        __RX_frame.payload, __RX_frame.payload_length);
             }
-        	//free memory
-			if (__RX_frame.payload != NULL)
-				free(__RX_frame.payload);
+        	//归还内存池
+			WS_payload_release(__RX_frame.payload);
         }
     }
 }
@@ -112,6 +126,6 @@ void app_main(void)
     xTaskCreate(&task_process_WebSocket, "ws_process_rx", 2048, NULL, 5, NULL);
 
     //websocket server任务：建立server、等待连接、连接、数据接收打包
-    xTaskCreate(&ws_server, "ws_server", 2048, NULL, 5, NULL);
+    xTaskCreate(&ws_server, "ws_server", 3072, NULL, 5, NULL);
 
 }
@@ -0,0 +1,280 @@
+/*
+* @file         bench_cloud_msg.c
+* @brief        云平台消息每秒处理条数和堆分配的比较
+* @details      按贝壳物联会话的样子生成一批消息:欢迎、token、登录成功,之后大部分是say命令,
+*               夹杂别的设备上下线、查询在线之类不处理的方法,比较:
+*               1.改之前:cJSON_Parse建树,cJSON_Print出"M",和各方法名的带引号字符串逐个strcmp,
+*                 say再cJSON_Print出"C"逐个strcmp;和原来一样树和打印结果都不释放
+*               2.cloud_msg_parse一遍扫描取视图,按方法名和命令查分发表
+*               两种做法的处理函数只计数,最后比较各处理函数被调用的次数;
+*               树用cjson_tree.h中和cJSON一样的实现,堆用量由heap_wrap.h统计
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "user_cloud_msg.h"
+#include "user_tmall_genie.h"
+#include "heap_wrap.h"
+#include "cjson_tree.h"
+
+#define SESSIONS        20                          //会话个数
+#define SESSION_MSGS    500                         //每个会话登录之后的消息条数
+#define ROUNDS          5                           //整批消息处理的遍数
+#define LINE_CAP        160
+
+//各处理函数被调用的次数
+enum
+{
+    HIT_WELCOME,
+    HIT_TOKEN,
+    HIT_CHECKINOK,
+    HIT_PLAY,
+    HIT_STOP,
+    HIT_OTHER_CMD,
+    HITS,
+};
+
+static char (*lines)[LINE_CAP];
+static int line_count;
+static long hits[HITS];
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void add_line(const char *fmt, int n)
+{
+    snprintf(lines[line_count++], LINE_CAP, fmt, n, n % 97);
+}
+
+//每个会话:欢迎、token、登录成功,然后是say和不处理的方法
+static void make_lines(void)
+{
+    static const char *const traffic[] =
+    {
+        "{\"M\":\"say\",\"ID\":\"P%d\",\"NAME\":\"guest\",\"C\":\"play\",\"T\":\"15394%05d\"}",
+        "{\"M\":\"say\",\"ID\":\"P%d\",\"NAME\":\"guest\",\"C\":\"stop\",\"T\":\"15394%05d\"}",
+        "{\"M\":\"say\",\"ID\":\"U%d\",\"NAME\":\"tmall\",\"C\":\"offOn\",\"T\":\"15394%05d\"}",
+        "{\"M\":\"login\",\"ID\":\"D%d\",\"NAME\":\"lamp\",\"T\":\"15394%05d\"}",
+        "{\"M\":\"logout\",\"ID\":\"D%d\",\"NAME\":\"lamp\",\"T\":\"15394%05d\"}",
+        "{\"M\":\"isOL\",\"R\":{\"D%d\":\"1\"},\"T\":\"15394%05d\"}",
+    };
+
+    lines = malloc(sizeof(*lines) * SESSIONS * (SESSION_MSGS + 3));
+    srand(21);
+    for (int s = 0; s < SESSIONS; s++)
+    {
+        add_line("{\"M\":\"WELCOME TO BIGIOT\",\"ID\":\"%d\",\"T\":\"15394%05d\"}", s);
+        add_line("{\"M\":\"token\",\"ID\":\"%d\",\"K\":\"9d2c6f0a51b4e7a3c8d1f2e4b5a6c7d8\",\"T\":\"15394%05d\"}", s);
+        add_line("{\"M\":\"checkinok\",\"ID\":\"D%d\",\"NAME\":\"lamp\",\"T\":\"15394%05d\"}", s);
+        for (int i = 0; i < SESSION_MSGS; i++)
+        {
+            add_line(traffic[rand() % (sizeof(traffic) / sizeof(traffic[0]))], rand() % 10000);
+        }
+    }
+}
+
+/*
+===========================
+改之前:建树后打印再比较
+===========================
+*/
+static void tree_cmd(node_t *root, int free_all)
+{
+    char *cmd = tree_print(get_item(root, "C"));
+
+    if (cmd == NULL)
+    {
+        hits[HIT_OTHER_CMD]++;
+        return;
+    }
+    hits[strcmp(cmd, "\"play\"") == 0 ? HIT_PLAY : strcmp(cmd, "\"stop\"") == 0 ? HIT_STOP : HIT_OTHER_CMD]++;
+    if (free_all)
+    {
+        free(cmd);
+    }
+}
+
+//free_all为0时和原来一样什么都不释放
+static void tree_line(const char *line, int free_all)
+{
+    node_t *root = tree_parse(line);
+    char *method;
+
+    if (root == NULL)
+    {
+        return;
+    }
+    method = tree_print(get_item(root, "M"));
+    if (method != NULL)
+    {
+        if (strcmp(method, "\"checkinok\"") == 0)
+        {
+            hits[HIT_CHECKINOK]++;
+        }
+        else if (strcmp(method, "\"token\"") == 0)
+        {
+            hits[HIT_TOKEN]++;
+        }
+        else if (strcmp(method, "\"say\"") == 0)
+        {
+            tree_cmd(root, free_all);
+        }
+        else if (strcmp(method, "\"WELCOME TO BIGIOT\"") == 0)
+        {
+            hits[HIT_WELCOME]++;
+        }
+    }
+    if (free_all)
+    {
+        free(method);
+        node_delete(root);
+    }
+}
+
+/*
+===========================
+分发表
+===========================
+*/
+static cloud_msg_route_t method_routes[BIG_IOT_METHOD_SLOTS];
+static cloud_msg_route_t cmd_routes[BIG_IOT_CMD_SLOTS];
+
+static void on_welcome(const cloud_msg_t *msg)
+{
+    hits[HIT_WELCOME]++;
+}
+
+static void on_token(const cloud_msg_t *msg)
+{
+    hits[HIT_TOKEN]++;
+}
+
+static void on_checkinok(const cloud_msg_t *msg)
+{
+    hits[HIT_CHECKINOK]++;
+}
+
+static void on_play(const cloud_msg_t *msg)
+{
+    hits[HIT_PLAY]++;
+}
+
+static void on_stop(const cloud_msg_t *msg)
+{
+    hits[HIT_STOP]++;
+}
+
+static void on_say(const cloud_msg_t *msg)
+{
+    if (cloud_msg_dispatch(cmd_routes, BIG_IOT_CMD_SLOTS, msg->content, msg) != 0)
+    {
+        hits[HIT_OTHER_CMD]++;
+    }
+}
+
+//和user_tmall_genie.c中的gs_big_iot_list、gs_cloud_cmd_list相同
+static const cloud_msg_route_t method_list[] =
+{
+    CLOUD_MSG_ROUTE("WELCOME TO BIGIOT", on_welcome),
+    CLOUD_MSG_ROUTE("token", on_token),
+    CLOUD_MSG_ROUTE("checkinok", on_checkinok),
+    CLOUD_MSG_ROUTE("say", on_say),
+};
+static const cloud_msg_route_t cmd_list[] =
+{
+    CLOUD_MSG_ROUTE("play", on_play),
+    CLOUD_MSG_ROUTE("stop", on_stop),
+};
+
+static void table_line(const char *line)
+{
+    cloud_msg_t msg;
+
+    if (cloud_msg_parse(line, strlen(line), &msg) > 0)
+    {
+        cloud_msg_dispatch(method_routes, BIG_IOT_METHOD_SLOTS, msg.method, &msg);
+    }
+}
+
+static void print_hits(const char *name)
+{
+    printf("  %-10s calls: welcome %ld, token %ld, checkinok %ld, play %ld, stop %ld, other say %ld\n", name,
+           hits[HIT_WELCOME], hits[HIT_TOKEN], hits[HIT_CHECKINOK], hits[HIT_PLAY], hits[HIT_STOP],
+           hits[HIT_OTHER_CMD]);
+}
+
+int main(void)
+{
+    long tree_hits[HITS];
+    long long start;
+    double mps;
+    long leaked;
+
+    make_lines();
+    if (cloud_msg_table_init(method_routes, BIG_IOT_METHOD_SLOTS, method_list,
+                             sizeof(method_list) / sizeof(method_list[0])) != 0 ||
+        cloud_msg_table_init(cmd_routes, BIG_IOT_CMD_SLOTS, cmd_list, sizeof(cmd_list) / sizeof(cmd_list[0])) != 0)
+    {
+        printf("cloud_msg_table_init failed\n");
+        return 1;
+    }
+    printf("%d BigIoT messages from %d sessions, x%d:\n", line_count, SESSIONS, ROUNDS);
+
+    //第一遍统计堆,和原来一样不释放
+    heap_reset();
+    heap_counting = 1;
+    for (int i = 0; i < line_count; i++)
+    {
+        tree_line(lines[i], 0);
+    }
+    heap_counting = 0;
+    leaked = heap_now;
+    memset(hits, 0, sizeof(hits));
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (int i = 0; i < line_count; i++)
+        {
+            tree_line(lines[i], 1);
+        }
+    }
+    mps = (double)line_count * ROUNDS * 1000 / (now_ns() - start);
+    printf("  %-10s %6.2f M msg/s  %5.1f heap allocs and %5.0f B per message, all left allocated\n", "tree",
+           mps, (double)heap_allocs / line_count, (double)leaked / line_count);
+    print_hits("tree");
+    memcpy(tree_hits, hits, sizeof(hits));
+
+    heap_reset();
+    heap_counting = 1;
+    for (int i = 0; i < line_count; i++)
+    {
+        table_line(lines[i]);
+    }
+    heap_counting = 0;
+    memset(hits, 0, sizeof(hits));
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (int i = 0; i < line_count; i++)
+        {
+            table_line(lines[i]);
+        }
+    }
+    mps = (double)line_count * ROUNDS * 1000 / (now_ns() - start);
+    printf("  %-10s %6.2f M msg/s  %5.1f heap allocs per message\n", "table", mps, (double)heap_allocs / line_count);
+    print_hits("table");
+    printf("  calls %s\n", memcmp(tree_hits, hits, sizeof(hits)) == 0 ? "identical" : "DIFFER");
+    return memcmp(tree_hits, hits, sizeof(hits)) != 0;
+}
@@ -0,0 +1,92 @@
+/*
+* @file         bench_https_client.c
+* @brief        hx-https可复用HTTPS客户端的请求耗时
+* @details      同样的GET请求,经mbedtls桩连本地TLS服务器,比较三种情况下每个请求的平均耗时和握手耗时:
+*               1.keep-alive复用同一个连接
+*               2.每次重连,带session ticket恢复会话
+*               3.每次重连,丢掉会话做完整握手(改之前每次请求都是这样)
+*               回环上没有网络往返,真机上省掉的往返次数还要乘上RTT
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "user_https_client.h"
+#include "tls_server.h"
+
+#define REQUESTS        500                         //每种情况的请求数
+#define BODY_LEN        "512"
+
+enum
+{
+    MODE_KEEPALIVE,
+    MODE_RESUME,
+    MODE_FULL,
+};
+
+static https_client_t client;
+static char body[1024];
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void bench(tls_server_t *s, const char *name, int mode)
+{
+    long long start, end;
+    long long handshake_us = 0;
+    int errors = 0;
+
+    https_client_init(&client, TLS_PROFILE_DEFAULT);
+    //第一次完整握手不算
+    https_client_request(&client, GET_REQ, "127.0.0.1", s->port_str, "len/" BODY_LEN, body, sizeof(body));
+    start = now_us();
+    for (int i = 0; i < REQUESTS; i++)
+    {
+        if (mode != MODE_KEEPALIVE)
+        {
+            https_client_close(&client);
+        }
+        if (mode == MODE_FULL)
+        {
+            client.session_valid = 0;
+        }
+        errors += https_client_request(&client, GET_REQ, "127.0.0.1", s->port_str, "len/" BODY_LEN, body,
+                                       sizeof(body)) != atoi(BODY_LEN);
+        handshake_us += mode != MODE_KEEPALIVE ? client.stats.last_handshake_us : 0;
+    }
+    end = now_us();
+    printf("  %-22s %8.1f us/request  handshake %8.1f us  full %u resumed %u reused %u errors %d\n", name,
+           (end - start) / (double)REQUESTS, handshake_us / (double)REQUESTS, (unsigned)client.stats.full_handshakes,
+           (unsigned)client.stats.resumed_handshakes, (unsigned)client.stats.keepalive_reuses, errors);
+    https_client_deinit(&client);
+}
+
+int main(void)
+{
+    tls_server_t s;
+
+    //lwip没有SIGPIPE,主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    if (tls_server_start(&s, 1, 1, tls_server_http, NULL) != 0)
+    {
+        printf("tls server failed\n");
+        return 1;
+    }
+    printf("https client over loopback, %d GET requests of " BODY_LEN " B bodies:\n", REQUESTS);
+    bench(&s, "keep-alive", MODE_KEEPALIVE);
+    bench(&s, "reconnect, resumed", MODE_RESUME);
+    bench(&s, "reconnect, full", MODE_FULL);
+    tls_server_stop(&s);
+    return 0;
+}
@@ -0,0 +1,329 @@
+/*
+* @file         bench_https_sched.c
+* @brief        hx-https多请求并发调度取N个URL的总耗时
+* @details      本地TLS服务器前面加一个单向延时的TCP代理模拟网络往返,服务器每个请求再加一段处理时间,
+*               比较取完N个URL的墙钟时间:
+*               1.每个请求新建客户端做完整握手,一个接一个(改之前的做法)
+*               2.一个客户端keep-alive,一个接一个
+*               3.调度器,连接池并发加流水线
+*               冷启动从没有连接开始,热启动复用上一轮留下的连接
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include "user_https_sched.h"
+#include "tls_server.h"
+
+#define ONE_WAY_MS      20                          //代理单向延时
+#define WORK_US         5000                        //服务器处理每个请求的时间
+#define PATH            "len/1024"
+
+//代理一个方向上读到、还没到发送时刻的数据
+typedef struct chunk
+{
+    struct chunk       *next;
+    long long           due_us;
+    size_t              len;
+    char                data[];
+} chunk_t;
+
+//代理的一个方向,读线程收下数据打上时间,写线程到点再发
+typedef struct
+{
+    int                 from;
+    int                 to;
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    chunk_t            *head;
+    chunk_t            *tail;
+    int                 eof;
+} pipe_dir_t;
+
+typedef struct
+{
+    int                 sock;
+    uint16_t            server_port;
+    char                port_str[8];
+} proxy_t;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int done_count;
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *pipe_reader(void *arg)
+{
+    pipe_dir_t *d = (pipe_dir_t *)arg;
+    char buf[16384];
+    chunk_t *c;
+    ssize_t n;
+
+    while ((n = read(d->from, buf, sizeof(buf))) > 0)
+    {
+        c = malloc(sizeof(*c) + n);
+        c->next = NULL;
+        c->due_us = now_us() + ONE_WAY_MS * 1000;
+        c->len = n;
+        memcpy(c->data, buf, n);
+        pthread_mutex_lock(&d->lock);
+        if (d->tail != NULL)
+        {
+            d->tail->next = c;
+        }
+        else
+        {
+            d->head = c;
+        }
+        d->tail = c;
+        pthread_cond_signal(&d->cond);
+        pthread_mutex_unlock(&d->lock);
+    }
+    pthread_mutex_lock(&d->lock);
+    d->eof = 1;
+    pthread_cond_signal(&d->cond);
+    pthread_mutex_unlock(&d->lock);
+    return NULL;
+}
+
+//按到达顺序发出,先到的先到点,排在后面的只会更晚
+static void *pipe_writer(void *arg)
+{
+    pipe_dir_t *d = (pipe_dir_t *)arg;
+    long long wait;
+    chunk_t *c;
+
+    while (1)
+    {
+        pthread_mutex_lock(&d->lock);
+        while (d->head == NULL && !d->eof)
+        {
+            pthread_cond_wait(&d->cond, &d->lock);
+        }
+        c = d->head;
+        if (c != NULL)
+        {
+            d->head = c->next;
+            d->tail = d->head != NULL ? d->tail : NULL;
+        }
+        pthread_mutex_unlock(&d->lock);
+        if (c == NULL)
+        {
+            shutdown(d->to, SHUT_WR);
+            return NULL;
+        }
+        if ((wait = c->due_us - now_us()) > 0)
+        {
+            usleep(wait);
+        }
+        for (size_t sent = 0; sent < c->len;)
+        {
+            ssize_t n = write(d->to, c->data + sent, c->len - sent);
+            if (n <= 0)
+            {
+                break;
+            }
+            sent += n;
+        }
+        free(c);
+    }
+}
+
+static void pipe_start(int from, int to)
+{
+    pipe_dir_t *d = calloc(1, sizeof(*d));
+    pthread_t tid;
+
+    d->from = from;
+    d->to = to;
+    pthread_mutex_init(&d->lock, NULL);
+    pthread_cond_init(&d->cond, NULL);
+    pthread_create(&tid, NULL, pipe_reader, d);
+    pthread_detach(tid);
+    pthread_create(&tid, NULL, pipe_writer, d);
+    pthread_detach(tid);
+}
+
+//每个接进来的连接转发到服务器,两个方向各自延时;进程退出时一起结束
+static void *proxy_thread(void *arg)
+{
+    proxy_t *p = (proxy_t *)arg;
+    struct sockaddr_in addr;
+    int client, server;
+    int on = 1;
+
+    while ((client = accept(p->sock, NULL, NULL)) >= 0)
+    {
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(p->server_port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        server = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(server, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            close(server);
+            close(client);
+            continue;
+        }
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        pipe_start(client, server);
+        pipe_start(server, client);
+    }
+    return NULL;
+}
+
+static int proxy_start(proxy_t *p, uint16_t server_port)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    pthread_t tid;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    p->server_port = server_port;
+    p->sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (p->sock < 0 || bind(p->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(p->sock, 64) != 0 ||
+        getsockname(p->sock, (struct sockaddr *)&addr, &len) != 0)
+    {
+        return -1;
+    }
+    snprintf(p->port_str, sizeof(p->port_str), "%u", ntohs(addr.sin_port));
+    pthread_create(&tid, NULL, proxy_thread, p);
+    pthread_detach(tid);
+    return 0;
+}
+
+static int on_body(void *arg, const uint8_t *data, size_t len)
+{
+    return 0;
+}
+
+static const http_parser_cb_t cb = { NULL, on_body };
+
+static void on_done(void *arg, int ret, int status)
+{
+    pthread_mutex_lock(&lock);
+    *(int *)arg += ret != 0 || status != 200;
+    done_count++;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+}
+
+//每个请求新建客户端,完整握手后关闭
+static int run_fresh(proxy_t *p, int n)
+{
+    static https_client_t client;
+    char body[2048];
+    int errors = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        https_client_init(&client, HTTPS_SCHED_TLS_PROFILE);
+        errors += https_client_request(&client, GET_REQ, "127.0.0.1", p->port_str, PATH, body, sizeof(body)) != 1024;
+        https_client_deinit(&client);
+    }
+    return errors;
+}
+
+//同一个客户端一个接一个
+static int run_serial(https_client_t *client, proxy_t *p, int n)
+{
+    char body[2048];
+    int errors = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        errors += https_client_request(client, GET_REQ, "127.0.0.1", p->port_str, PATH, body, sizeof(body)) != 1024;
+    }
+    return errors;
+}
+
+//全部交给调度器,请求表满了就等一个完成再交
+static int run_sched(https_sched_t *sched, proxy_t *p, int n)
+{
+    int errors = 0;
+    int submitted = 0;
+
+    pthread_mutex_lock(&lock);
+    done_count = 0;
+    while (done_count < n)
+    {
+        pthread_mutex_unlock(&lock);
+        while (submitted < n && https_sched_get(sched, "127.0.0.1", p->port_str, PATH, &cb, &errors, on_done) == 0)
+        {
+            submitted++;
+        }
+        pthread_mutex_lock(&lock);
+        if (done_count < n && (submitted == n || done_count < submitted))
+        {
+            pthread_cond_wait(&cond, &lock);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return errors;
+}
+
+int main(void)
+{
+    static const int counts[] = { 4, 8, 16 };
+    static https_client_t client;
+    static https_sched_t sched[3];
+    long long t0, t1, t2;
+    tls_server_t s;
+    proxy_t p;
+    int errors = 0;
+
+    //lwip没有SIGPIPE,主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    if (tls_server_start(&s, 1, 1, tls_server_http, NULL) != 0 || proxy_start(&p, s.port) != 0)
+    {
+        printf("tls server failed\n");
+        return 1;
+    }
+    s.work_us = WORK_US;
+    printf("fetching N URLs, %d ms one-way latency, %d ms server time per request, wall time cold/warm:\n",
+           ONE_WAY_MS, WORK_US / 1000);
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        int n = counts[i];
+
+        t0 = now_us();
+        errors += run_fresh(&p, n);
+        t1 = now_us();
+        printf("  N=%-3d fresh TLS per request %7.1f ms\n", n, (t1 - t0) / 1000.0);
+
+        https_client_init(&client, HTTPS_SCHED_TLS_PROFILE);
+        t0 = now_us();
+        errors += run_serial(&client, &p, n);
+        t1 = now_us();
+        errors += run_serial(&client, &p, n);
+        t2 = now_us();
+        https_client_deinit(&client);
+        printf("        serial keep-alive     %7.1f / %7.1f ms\n", (t1 - t0) / 1000.0, (t2 - t1) / 1000.0);
+
+        //调度器的工作任务不能停,每个N用一个新的调度器从冷启动开始
+        https_sched_init(&sched[i]);
+        t0 = now_us();
+        errors += run_sched(&sched[i], &p, n);
+        t1 = now_us();
+        errors += run_sched(&sched[i], &p, n);
+        t2 = now_us();
+        printf("        scheduler             %7.1f / %7.1f ms\n", (t1 - t0) / 1000.0, (t2 - t1) / 1000.0);
+    }
+    printf("  errors %d\n", errors);
+    return 0;
+}
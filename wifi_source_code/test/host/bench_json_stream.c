@@ -0,0 +1,171 @@
+/*
+* @file         bench_json_stream.c
+* @brief        user_json_stream和整棵树解析的内存、时间比较
+* @details      心知天气5天预报的响应,按TLS每次读出的大小分段交给解析:
+*               1.流式:和user_http_s.c一样提取城市名和每天的预报,统计堆分配和每条的时间
+*               2.整棵树:改之前先收完整个响应体,cJSON_Parse建树,再cJSON_Print城市名和前3天,
+*                 树用cjson_tree.h中和cJSON一样的实现
+*               堆用量由heap_wrap.h统计
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "user_json_stream.h"
+#include "heap_wrap.h"
+#include "cjson_tree.h"
+
+#define DOCS            20000                       //每种解析的次数
+#define READ_L          256                         //每次交给解析的字节数,和TLS读出的大小相当
+#define BODY_CAP        4096
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+===========================
+测试数据和两种解析
+===========================
+*/
+static char body[BODY_CAP];
+static size_t body_len;
+static volatile size_t sink;
+
+//心知天气daily接口的响应格式,5天
+static void make_body(void)
+{
+    static const char *text[] = { "晴", "多云", "阴", "小雨", "中雨" };
+    body_len = snprintf(body, sizeof(body),
+                        "{\"results\":[{\"location\":{\"id\":\"WX4FBXXFKE4F\",\"name\":\"北京\",\"country\":\"CN\","
+                        "\"path\":\"北京,北京,中国\",\"timezone\":\"Asia/Shanghai\",\"timezone_offset\":\"+08:00\"},"
+                        "\"daily\":[");
+    for (int i = 0; i < 5; i++)
+    {
+        body_len += snprintf(body + body_len, sizeof(body) - body_len,
+                             "%s{\"date\":\"2026-10-%02d\",\"text_day\":\"%s\",\"code_day\":\"%d\",\"text_night\":\"%s\","
+                             "\"code_night\":\"%d\",\"high\":\"%d\",\"low\":\"%d\",\"rainfall\":\"0.0\",\"precip\":\"\","
+                             "\"wind_direction\":\"北\",\"wind_direction_degree\":\"0\",\"wind_speed\":\"15.3\","
+                             "\"wind_scale\":\"3\",\"humidity\":\"%d\"}",
+                             i ? "," : "", 17 + i, text[i], i, text[4 - i], 4 - i, 21 - i, 9 + i, 45 + i * 5);
+    }
+    body_len += snprintf(body + body_len, sizeof(body) - body_len, "],\"last_update\":\"2026-10-17T08:00:00+08:00\"}]}");
+}
+
+static int on_value(void *arg, uint8_t path, const char *value, size_t len, uint8_t truncated)
+{
+    sink += len;
+    return 0;
+}
+
+//和user_http_s.c一样按路径提取,响应体分段喂入
+static int parse_stream(void)
+{
+    json_stream_t js;
+    int ret = 0;
+
+    json_stream_init(&js, on_value, NULL);
+    json_stream_add_path(&js, "results[0].location.name");
+    json_stream_add_path(&js, "results[0].daily[*]");
+    for (size_t pos = 0; pos < body_len && ret == 0; pos += READ_L)
+    {
+        ret = json_stream_feed(&js, (const uint8_t *)body + pos, body_len - pos < READ_L ? body_len - pos : READ_L);
+    }
+    return ret ? ret : json_stream_finish(&js);
+}
+
+//改之前:响应体先收进缓存,建树,打印4个值;free_all为0时和原来一样什么都不释放
+static int parse_tree(int free_all)
+{
+    static char copy[BODY_CAP];
+    node_t *root, *result, *daily;
+    char *prints[4];
+
+    for (size_t pos = 0; pos < body_len; pos += READ_L)
+    {
+        memcpy(copy + pos, body + pos, body_len - pos < READ_L ? body_len - pos : READ_L);
+    }
+    copy[body_len] = 0;
+    if ((root = tree_parse(copy)) == NULL)
+    {
+        return -1;
+    }
+    result = get_index(get_item(root, "results"), 0);
+    daily = get_item(result, "daily");
+    prints[0] = tree_print(get_item(get_item(result, "location"), "name"));
+    for (int i = 0; i < 3; i++)
+    {
+        prints[i + 1] = tree_print(get_index(daily, i));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        sink += prints[i] ? strlen(prints[i]) : 0;
+        if (free_all)
+        {
+            free(prints[i]);
+        }
+    }
+    if (free_all)
+    {
+        node_delete(root);
+    }
+    return 0;
+}
+
+int main(void)
+{
+    long long start;
+    double us;
+    long leaked;
+
+    make_body();
+    printf("weather response %zu B, fed in %d B reads, %d documents:\n", body_len, READ_L, DOCS);
+
+    heap_reset();
+    heap_counting = 1;
+    if (parse_stream() != 0)
+    {
+        printf("  stream: parse failed\n");
+        return 1;
+    }
+    heap_counting = 0;
+    start = now_us();
+    for (int i = 0; i < DOCS; i++)
+    {
+        parse_stream();
+    }
+    us = (now_us() - start) / (double)DOCS;
+    printf("  %-10s %8.2f us/doc  state %zu B on the stack, %ld heap allocs, peak heap %ld B\n", "stream", us,
+           sizeof(json_stream_t), heap_allocs, heap_peak);
+
+    heap_reset();
+    heap_counting = 1;
+    if (parse_tree(0) != 0)
+    {
+        printf("  tree: parse failed\n");
+        return 1;
+    }
+    leaked = heap_now;
+    heap_reset();
+    parse_tree(1);
+    heap_counting = 0;
+    start = now_us();
+    for (int i = 0; i < DOCS; i++)
+    {
+        parse_tree(1);
+    }
+    us = (now_us() - start) / (double)DOCS;
+    printf("  %-10s %8.2f us/doc  body copy %zu B, node %zu B, %ld heap allocs, peak heap %ld B, %ld B left per request"
+           " when nothing is freed\n", "tree", us, body_len + 1, sizeof(node_t), heap_allocs, heap_peak, leaked);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+* @file         bench_keepalive.c
+* @brief        固定周期心跳和自适应心跳在模拟流量下的比较
+* @details      用虚拟时间模拟一天的连接:设备按给定的周期发业务帧,服务器空闲超过实际超时就断开,
+*               可以再加上随机的网络中断;比较:
+*               1.改之前:每HEART_BEAT_INTERVAL_OLD_MS发一次心跳,不管有没有其他帧
+*               2.user_keepalive:按连接空闲的时间发心跳,空闲断开后按测出的超时缩短间隔
+*               统计心跳帧数、断线重连次数和射频打开的时间;
+*               射频时间按模型估算:每次发送TX_RADIO_MS,每次重连RECONNECT_RADIO_MS,不是实测的功耗
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "user_keepalive.h"
+#include "user_tmall_genie.h"
+
+#define SIM_MS                      (24LL * 3600 * 1000)    //模拟的时长
+#define TICK_MS                     10                      //虚拟时间的步长
+#define HEART_BEAT_INTERVAL_OLD_MS  (30 * 1000)             //改之前的固定心跳周期
+#define TX_RADIO_MS                 40                      //每次发送射频打开的时间
+#define RECONNECT_RADIO_MS          1500                    //每次断线重连(TCP、TLS握手和签到)射频打开的时间
+
+typedef struct
+{
+    const char  *name;
+    uint32_t    app_ms;                                     //业务帧的周期,0表示没有业务帧
+    uint32_t    server_ms;                                  //服务器实际的空闲超时
+    uint32_t    drop_ms;                                    //平均多久一次随机的网络中断,0表示没有
+} scenario_t;
+
+typedef struct
+{
+    long        heart_beats;
+    long        reconnects;
+    long long   radio_ms;
+} sim_result_t;
+
+/**
+ * 模拟一天的连接
+ * @param[in]   s        :场景
+ * @param[in]   adaptive :0:固定周期心跳 1:user_keepalive
+ * @param[out]  r        :结果
+ */
+static void simulate(const scenario_t *s, int adaptive, sim_result_t *r)
+{
+    keepalive_t k;
+    long long now, tx_last = 0, next_app, next_check;
+    uint32_t wait;
+
+    keepalive_init(&k, HEART_BEAT_INTERVAL_MS, BIG_IOT_IDLE_TIMEOUT_MS);
+    r->heart_beats = 0;
+    r->reconnects = 0;
+    r->radio_ms = 0;
+    next_app = s->app_ms ? s->app_ms : SIM_MS;
+    next_check = adaptive ? k.interval_ms : HEART_BEAT_INTERVAL_OLD_MS;
+    srand(24);
+    for (now = 0; now < SIM_MS; now += TICK_MS)
+    {
+        if (now >= next_app)
+        {
+            tx_last = now;
+            r->radio_ms += TX_RADIO_MS;
+            next_app += s->app_ms;
+        }
+        if (now >= next_check)
+        {
+            wait = adaptive ? keepalive_next(&k, now - tx_last) : 0;
+            if (wait == 0)
+            {
+                tx_last = now;
+                r->heart_beats++;
+                r->radio_ms += TX_RADIO_MS;
+                wait = adaptive ? k.interval_ms : HEART_BEAT_INTERVAL_OLD_MS;
+            }
+            next_check = now + wait;
+        }
+        //服务器空闲超时或者网络中断,重连后握手完成时开始重新计算空闲,心跳定时器重新启动
+        if (now - tx_last >= s->server_ms ||
+            (s->drop_ms != 0 && rand() % (s->drop_ms / TICK_MS) == 0))
+        {
+            if (adaptive)
+            {
+                keepalive_closed(&k, now - tx_last);
+            }
+            r->reconnects++;
+            r->radio_ms += RECONNECT_RADIO_MS;
+            tx_last = now;
+            next_check = now + (adaptive ? k.interval_ms : HEART_BEAT_INTERVAL_OLD_MS);
+        }
+    }
+}
+
+int main(void)
+{
+    static const scenario_t scenarios[] =
+    {
+        {"idle",            0,          60000,  0},
+        {"1 frame / 5 min", 300000,     60000,  0},
+        {"1 frame / 45 s",  45000,      60000,  0},
+        {"1 frame / 10 s",  10000,      60000,  0},
+        {"idle, 40 s server timeout",   0,  40000,  0},
+        {"idle, drop / 30 min",         0,  60000,  1800000},
+        {"1 frame / 45 s, drop / 30 min", 45000, 60000, 1800000},
+    };
+    sim_result_t fixed, adaptive;
+    int failed = 0;
+
+    printf("one simulated day, fixed %d s heart beat vs adaptive (start %d s, documented timeout %d s),\n"
+           "radio model %d ms per tx, %d ms per reconnect:\n", HEART_BEAT_INTERVAL_OLD_MS / 1000,
+           HEART_BEAT_INTERVAL_MS / 1000, BIG_IOT_IDLE_TIMEOUT_MS / 1000, TX_RADIO_MS, RECONNECT_RADIO_MS);
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        simulate(&scenarios[i], 0, &fixed);
+        simulate(&scenarios[i], 1, &adaptive);
+        printf("  %-32s heart beats %5ld -> %5ld (%+4.0f%%)  reconnects %3ld -> %3ld  radio-on %6.1f -> %6.1f s (%+4.0f%%)\n",
+               scenarios[i].name, fixed.heart_beats, adaptive.heart_beats,
+               100.0 * (adaptive.heart_beats - fixed.heart_beats) / fixed.heart_beats, fixed.reconnects,
+               adaptive.reconnects, fixed.radio_ms / 1000.0, adaptive.radio_ms / 1000.0,
+               100.0 * (adaptive.radio_ms - fixed.radio_ms) / fixed.radio_ms);
+        //没有网络中断时,服务器超时和文档相同的场景不能断开,超时更短的场景只能断开一次
+        if (scenarios[i].drop_ms == 0 &&
+            adaptive.reconnects > (scenarios[i].server_ms < BIG_IOT_IDLE_TIMEOUT_MS ? 1 : 0))
+        {
+            printf("  %s: unexpected reconnects\n", scenarios[i].name);
+            failed = 1;
+        }
+    }
+    return failed;
+}
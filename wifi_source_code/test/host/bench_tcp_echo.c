@@ -0,0 +1,309 @@
+/*
+* @file         bench_tcp_echo.c
+* @brief        tcp_bsp回发路径的回环性能测试
+* @details      1.recv_data跑在一个线程里作server，和原来每次清空缓存、按strlen回发的循环比较回发吞吐，
+*                 以及带0字节的数据能收回多少
+*               2.头部加数据的消息分别用两次tcp_send_all、拷贝后一次tcp_send_all、tcp_sendv发送，比较每秒消息数
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "tcp_bsp.h"
+
+#define ECHO_TOTAL      (64 * 1024 * 1024)          //回发测试每轮发送的字节数
+#define ECHO_CHUNK      1024                        //回发测试每次发送的字节数
+#define GATHER_MS       500                         //聚合发送测试每种方式跑的时间
+
+static int old_listen = -1;
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int client_connect(uint16_t port)
+{
+    struct sockaddr_in addr;
+    int s;
+
+    //server线程可能还没listen，重试一会
+    for (int i = 0; i < 200; i++)
+    {
+        s = socket(AF_INET, SOCK_STREAM, 0);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+        {
+            return s;
+        }
+        close(s);
+        usleep(5000);
+    }
+    printf("connect to port %u failed\n", port);
+    exit(1);
+}
+
+//新的回发循环：tcp_bsp.c中的recv_data
+static void *new_server(void *arg)
+{
+    if (create_tcp_server(true) == ESP_OK)
+    {
+        recv_data(NULL);
+    }
+    return NULL;
+}
+
+//原来的回发循环，和基线版本recv_data的循环体相同，
+//只是接收长度少1个字节，保证strlen不越界
+static void *old_server(void *arg)
+{
+    int sock = accept(old_listen, NULL, NULL);
+    int len = 0;
+    char databuff[1024];
+    while (1)
+    {
+        memset(databuff, 0x00, sizeof(databuff));
+        len = recv(sock, databuff, sizeof(databuff) - 1, 0);
+        if (len <= 0)
+        {
+            break;
+        }
+        send(sock, databuff, strlen(databuff), 0);
+    }
+    close(sock);
+    return NULL;
+}
+
+static uint16_t old_start(void)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    pthread_t tid;
+
+    old_listen = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(old_listen, (struct sockaddr *)&addr, sizeof(addr));
+    listen(old_listen, 1);
+    getsockname(old_listen, (struct sockaddr *)&addr, &len);
+    pthread_create(&tid, NULL, old_server, NULL);
+    pthread_detach(tid);
+    return ntohs(addr.sin_port);
+}
+
+struct sender
+{
+    int sock;
+    const uint8_t *data;
+};
+
+static void *send_thread(void *arg)
+{
+    struct sender *s = (struct sender *)arg;
+    for (int sent = 0; sent < ECHO_TOTAL; sent += ECHO_CHUNK)
+    {
+        if (tcp_send_all(s->sock, s->data + sent % (1024 * 1024), ECHO_CHUNK) < 0)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+//发送ECHO_TOTAL字节，收回发的数据直到收齐或200ms没有数据，返回收回的字节数和用时
+static long long echo_run(int sock, const uint8_t *data, long long *us)
+{
+    static uint8_t in[64 * 1024];
+    struct pollfd pfd = { .fd = sock, .events = POLLIN };
+    struct sender s = { sock, data };
+    long long got = 0;
+    long long start = now_us();
+    long long last = start;
+    pthread_t tid;
+    int ret;
+
+    pthread_create(&tid, NULL, send_thread, &s);
+    while (got < ECHO_TOTAL && poll(&pfd, 1, 200) > 0)
+    {
+        ret = recv(sock, in, sizeof(in), 0);
+        if (ret <= 0)
+        {
+            break;
+        }
+        got += ret;
+        last = now_us();
+    }
+    shutdown(sock, SHUT_WR);
+    pthread_join(tid, NULL);
+    close(sock);
+    *us = last - start;
+    return got;
+}
+
+static void echo_report(const char *name, long long got, long long us)
+{
+    printf("  %-28s %6.1f%% echoed, %7.1f MB/s\n", name,
+           got * 100.0 / ECHO_TOTAL, us > 0 ? got / (double)us : 0.0);
+}
+
+static void bench_echo(void)
+{
+    static uint8_t text[1024 * 1024];
+    static uint8_t binary[1024 * 1024];
+    const uint8_t *data[2] = { text, binary };
+    const char *kind[2] = { "text", "binary" };
+    pthread_t tid;
+    long long got;
+    long long us;
+
+    for (int i = 0; i < (int)sizeof(text); i++)
+    {
+        text[i] = 'a' + i % 26;
+        binary[i] = (uint8_t)(i * 131 + (i >> 9));
+    }
+    printf("echo loop, %d MiB in %d byte sends:\n", ECHO_TOTAL >> 20, ECHO_CHUNK);
+    for (int k = 0; k < 2; k++)
+    {
+        char name[32];
+        got = echo_run(client_connect(old_start()), data[k], &us);
+        close(old_listen);
+        snprintf(name, sizeof(name), "old memset+strlen, %s", kind[k]);
+        echo_report(name, got, us);
+
+        pthread_create(&tid, NULL, new_server, NULL);
+        got = echo_run(client_connect(TCP_PORT), data[k], &us);
+        pthread_join(tid, NULL);
+        snprintf(name, sizeof(name), "new recv_data, %s", kind[k]);
+        echo_report(name, got, us);
+    }
+}
+
+//接收端：读到对端关闭为止
+static void *drain_thread(void *arg)
+{
+    static uint8_t in[256 * 1024];
+    int sock = accept(*(int *)arg, NULL, NULL);
+    while (recv(sock, in, sizeof(in), 0) > 0)
+    {
+    }
+    close(sock);
+    return NULL;
+}
+
+enum
+{
+    SEND_TWICE = 0,
+    SEND_COPY,
+    SEND_GATHER,
+};
+
+//4字节头部加payload字节数据的消息，用GATHER_MS时间能发多少条
+static double gather_run(int how, int payload)
+{
+    static uint8_t body[16 * 1024];
+    static uint8_t staging[4 + sizeof(body)];
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    uint8_t head[4];
+    struct iovec iov[2];
+    int lsock = socket(AF_INET, SOCK_STREAM, 0);
+    int sock;
+    int one = 1;
+    long long count = 0;
+    long long start;
+    long long end;
+    pthread_t tid;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(lsock, (struct sockaddr *)&addr, sizeof(addr));
+    listen(lsock, 1);
+    getsockname(lsock, (struct sockaddr *)&addr, &len);
+    pthread_create(&tid, NULL, drain_thread, &lsock);
+    sock = client_connect(ntohs(addr.sin_port));
+    //和lwip默认一样小包立即发出，两次发送的代价才看得出来
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    start = now_us();
+    end = start + GATHER_MS * 1000;
+    while (now_us() < end)
+    {
+        for (int i = 0; i < 64; i++, count++)
+        {
+            head[0] = 0xA5;
+            head[1] = 0;
+            head[2] = payload >> 8;
+            head[3] = payload & 0xff;
+            if (how == SEND_TWICE)
+            {
+                tcp_send_all(sock, head, sizeof(head));
+                tcp_send_all(sock, body, payload);
+            }
+            else if (how == SEND_COPY)
+            {
+                memcpy(staging, head, sizeof(head));
+                memcpy(staging + sizeof(head), body, payload);
+                tcp_send_all(sock, staging, sizeof(head) + payload);
+            }
+            else
+            {
+                iov[0].iov_base = head;
+                iov[0].iov_len = sizeof(head);
+                iov[1].iov_base = body;
+                iov[1].iov_len = payload;
+                tcp_sendv(sock, iov, 2);
+            }
+        }
+    }
+    end = now_us();
+    close(sock);
+    pthread_join(tid, NULL);
+    close(lsock);
+    return count * 1e6 / (end - start);
+}
+
+static void bench_gather(void)
+{
+    static const int payloads[] = { 16, 256, 1024, 8192 };
+
+    printf("header + payload sends, messages/s:\n");
+    printf("  %8s %14s %14s %14s\n", "payload", "2x send_all", "copy+send_all", "tcp_sendv");
+    for (int i = 0; i < (int)(sizeof(payloads) / sizeof(payloads[0])); i++)
+    {
+        double twice = gather_run(SEND_TWICE, payloads[i]);
+        double copy = gather_run(SEND_COPY, payloads[i]);
+        double gather = gather_run(SEND_GATHER, payloads[i]);
+        printf("  %8d %14.0f %14.0f %14.0f\n", payloads[i], twice, copy, gather);
+    }
+}
+
+int main(void)
+{
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    bench_echo();
+    bench_gather();
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+* @file         bench_tcp_frame.c
+* @brief        tcp_frame的性能测试
+* @details      1.解析：不同帧长、按MSS和小块切开的数据流，每秒解析的帧数
+*               2.发送：回环TCP上每帧一次tcp_sendv和合并发送，每秒发出的帧数
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "tcp_bsp.h"
+#include "tcp_frame.h"
+
+#define PARSE_STREAM    (4 * 1024 * 1024)           //解析测试的数据流长度
+#define PARSE_REPEAT    8                           //解析测试重复次数
+#define SEND_MS         500                         //发送测试每种方式跑的时间
+
+static volatile uint32_t frames_seen;
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void count_cb(void *arg, const uint8_t *frame, size_t len)
+{
+    frames_seen++;
+}
+
+//帧长为frame_len的数据流按chunk切开解析，返回每秒帧数
+static double parse_run(tcp_frame_type_t type, size_t frame_len, size_t chunk)
+{
+    static uint8_t stream[PARSE_STREAM + TCP_FRAME_MAX_LEN + TCP_FRAME_HDR_MAX];
+    tcp_frame_parser_t parser;
+    size_t stream_len = 0;
+    uint32_t frames = 0;
+    long long start;
+
+    while (stream_len < PARSE_STREAM)
+    {
+        stream_len += tcp_frame_encode_hdr(type, frame_len, stream + stream_len);
+        memset(stream + stream_len, (uint8_t)frames, frame_len);
+        stream_len += frame_len;
+        frames++;
+    }
+    tcp_frame_parser_init(&parser, type, count_cb, NULL);
+    frames_seen = 0;
+    start = now_us();
+    for (int r = 0; r < PARSE_REPEAT; r++)
+    {
+        for (size_t off = 0; off < stream_len; off += chunk)
+        {
+            tcp_frame_parser_feed(&parser, stream + off, off + chunk <= stream_len ? chunk : stream_len - off);
+        }
+    }
+    if (frames_seen != frames * PARSE_REPEAT)
+    {
+        printf("parse lost frames: %u of %u\n", frames_seen, frames * PARSE_REPEAT);
+        exit(1);
+    }
+    return frames_seen * 1e6 / (now_us() - start);
+}
+
+static void bench_parse(void)
+{
+    static const size_t lens[] = { 16, 64, 256, 1024 };
+
+    printf("parse, frames/s (varint header):\n");
+    printf("  %6s %14s %14s %14s\n", "frame", "1460B chunks", "64B chunks", "1B chunks");
+    for (int i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        double mss = parse_run(TCP_FRAME_VARINT, lens[i], 1460);
+        double small = parse_run(TCP_FRAME_VARINT, lens[i], 64);
+        double byte = parse_run(TCP_FRAME_VARINT, lens[i], 1);
+        printf("  %6zu %14.0f %14.0f %14.0f\n", lens[i], mss, small, byte);
+    }
+}
+
+//接收端：读到对端关闭为止
+static void *drain_thread(void *arg)
+{
+    static uint8_t in[256 * 1024];
+    int sock = accept(*(int *)arg, NULL, NULL);
+    while (recv(sock, in, sizeof(in), 0) > 0)
+    {
+    }
+    close(sock);
+    return NULL;
+}
+
+//回环TCP上发送frame_len长的帧，batch为真时合并发送，每16帧flush一次，返回每秒帧数
+static double send_run(bool batch, size_t frame_len)
+{
+    static uint8_t body[TCP_FRAME_MAX_LEN];
+    static tcp_frame_batch_t b;
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    uint8_t hdr[TCP_FRAME_HDR_MAX];
+    struct iovec iov[2];
+    int lsock = socket(AF_INET, SOCK_STREAM, 0);
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    long long count = 0;
+    long long start;
+    long long end;
+    pthread_t tid;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(lsock, (struct sockaddr *)&addr, sizeof(addr));
+    listen(lsock, 1);
+    getsockname(lsock, (struct sockaddr *)&addr, &alen);
+    pthread_create(&tid, NULL, drain_thread, &lsock);
+    connect(sock, (struct sockaddr *)&addr, sizeof(addr));
+    //和lwip默认一样小包立即发出
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    tcp_frame_batch_init(&b, sock, TCP_FRAME_VARINT);
+
+    start = now_us();
+    end = start + SEND_MS * 1000;
+    while (now_us() < end)
+    {
+        for (int i = 0; i < 16; i++, count++)
+        {
+            if (batch)
+            {
+                tcp_frame_batch_add(&b, body, frame_len);
+            }
+            else
+            {
+                iov[0].iov_base = hdr;
+                iov[0].iov_len = tcp_frame_encode_hdr(TCP_FRAME_VARINT, frame_len, hdr);
+                iov[1].iov_base = body;
+                iov[1].iov_len = frame_len;
+                tcp_sendv(sock, iov, 2);
+            }
+        }
+        tcp_frame_batch_flush(&b);
+    }
+    end = now_us();
+    close(sock);
+    pthread_join(tid, NULL);
+    close(lsock);
+    return count * 1e6 / (end - start);
+}
+
+static void bench_send(void)
+{
+    static const size_t lens[] = { 16, 64, 256, 1024 };
+
+    printf("send over loopback TCP, frames/s (16 frames per flush):\n");
+    printf("  %6s %16s %16s\n", "frame", "tcp_sendv each", "batch");
+    for (int i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        double each = send_run(false, lens[i]);
+        double batch = send_run(true, lens[i]);
+        printf("  %6zu %16.0f %16.0f\n", lens[i], each, batch);
+    }
+}
+
+int main(void)
+{
+    bench_parse();
+    bench_send();
+    return 0;
+}
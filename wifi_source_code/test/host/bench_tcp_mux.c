@@ -0,0 +1,190 @@
+/*
+* @file         bench_tcp_mux.c
+* @brief        tcp_mux的回环性能测试
+* @details      server任务跑在一个线程里，一个client线程用poll驱动多个连接：
+*               打印能同时保持的连接数，以及不同client数下的总回发吞吐
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "tcp_bsp.h"
+#include "tcp_mux.h"
+
+#define BENCH_MS        1000                        //每种client数跑的时间
+#define BENCH_CHUNK     TCP_MUX_RX_BUFF_LEN         //每次发送的字节数
+#define BENCH_WINDOW    (16 * 1024)                 //每个client最多在途的字节数
+
+static uint16_t mux_port;
+
+//tcp_bsp.c中的函数，性能测试不编译tcp_bsp.c
+int show_socket_error_reason(const char *str, int socket)
+{
+    return 0;
+}
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *server_thread(void *arg)
+{
+    tcp_mux_server_task(NULL);
+    return NULL;
+}
+
+static void mux_start(void)
+{
+    pthread_t tid;
+    uint16_t port = 30000 + getpid() % 20000;
+
+    for (int i = 0; i < 100; i++, port++)
+    {
+        if (tcp_mux_server_init(port) == ESP_OK)
+        {
+            mux_port = port;
+            pthread_create(&tid, NULL, server_thread, NULL);
+            pthread_detach(tid);
+            return;
+        }
+    }
+    printf("no free port\n");
+    exit(1);
+}
+
+static int client_connect(void)
+{
+    struct sockaddr_in addr;
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(mux_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static void wait_count(int n)
+{
+    long long end = now_us() + 2000000;
+    while (tcp_mux_conn_count() != n && now_us() < end)
+    {
+        usleep(1000);
+    }
+}
+
+//连接数比连接表多2个，看能同时保持多少个
+static void bench_held(void)
+{
+    int cli[TCP_MUX_MAX_CONN + 2];
+
+    for (int i = 0; i < TCP_MUX_MAX_CONN + 2; i++)
+    {
+        cli[i] = client_connect();
+    }
+    usleep(200000);
+    printf("connections held: %d of %d attempted, 1 task, %u bytes of state per connection\n",
+           tcp_mux_conn_count(), TCP_MUX_MAX_CONN + 2, (unsigned)sizeof(tcp_conn_t));
+    for (int i = 0; i < TCP_MUX_MAX_CONN + 2; i++)
+    {
+        close(cli[i]);
+    }
+    wait_count(0);
+}
+
+//n个client同时发，每个最多BENCH_WINDOW字节在途，返回BENCH_MS内收回的总字节数
+static long long bench_echo(int n)
+{
+    static uint8_t out[BENCH_CHUNK];
+    static uint8_t in[64 * 1024];
+    struct pollfd pfd[TCP_MUX_MAX_CONN];
+    long long inflight[TCP_MUX_MAX_CONN];
+    long long echoed = 0;
+    long long end;
+    int ret;
+
+    for (int i = 0; i < n; i++)
+    {
+        pfd[i].fd = client_connect();
+        inflight[i] = 0;
+    }
+    wait_count(n);
+    end = now_us() + BENCH_MS * 1000;
+    while (now_us() < end)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            pfd[i].events = POLLIN | (inflight[i] + BENCH_CHUNK <= BENCH_WINDOW ? POLLOUT : 0);
+        }
+        if (poll(pfd, n, 10) <= 0)
+        {
+            continue;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            if (pfd[i].revents & POLLIN)
+            {
+                ret = recv(pfd[i].fd, in, sizeof(in), MSG_DONTWAIT);
+                if (ret > 0)
+                {
+                    inflight[i] -= ret;
+                    echoed += ret;
+                }
+            }
+            if ((pfd[i].revents & POLLOUT) && inflight[i] + BENCH_CHUNK <= BENCH_WINDOW)
+            {
+                ret = send(pfd[i].fd, out, sizeof(out), MSG_DONTWAIT);
+                if (ret > 0)
+                {
+                    inflight[i] += ret;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        close(pfd[i].fd);
+    }
+    wait_count(0);
+    return echoed;
+}
+
+int main(void)
+{
+    long long bytes;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    mux_start();
+    bench_held();
+    printf("echo throughput, %d byte sends, %d KiB window per client, %d ms each:\n",
+           BENCH_CHUNK, BENCH_WINDOW / 1024, BENCH_MS);
+    for (int n = 1; n <= TCP_MUX_MAX_CONN; n *= 2)
+    {
+        bytes = bench_echo(n);
+        printf("  %d client(s): %8.1f MB/s total, %7.1f MB/s per client\n", n,
+               bytes / (BENCH_MS * 1000.0), bytes / (BENCH_MS * 1000.0) / n);
+    }
+    return 0;
+}
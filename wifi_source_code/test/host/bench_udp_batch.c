@@ -0,0 +1,182 @@
+/*
+* @file         bench_udp_batch.c
+* @brief        udp_batch的回环性能测试
+* @details      一个线程在回环上连续发64字节数据报，回发端分别用原来的逐包循环和udp_batch收发，
+*               比较每秒处理的包数和平均每次收发调用处理的包数（udp_batch按stats中的批次计，
+*               循环收发时一批内部仍是逐包的系统调用）。
+*               同一份源码编译两次：bench_udp_batch走recvmmsg/sendmmsg，
+*               bench_udp_batch_lwip用-DUDP_BATCH_HAVE_MMSG=0走ESP32上的循环收发
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#define _GNU_SOURCE                                 //sendmmsg
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "udp_batch.h"
+
+#define BENCH_MS        1000                        //发送端每轮发送的时间
+#define BENCH_LEN       64                          //数据报长度
+
+static long long sender_pkts;
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int udp_bind(struct sockaddr_in *addr)
+{
+    socklen_t len = sizeof(*addr);
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    int rcvbuf = 1 << 20;
+
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(s, (struct sockaddr *)addr, sizeof(*addr));
+    getsockname(s, (struct sockaddr *)addr, &len);
+    return s;
+}
+
+//发送端：BENCH_MS内每次sendmmsg发16包，回发的数据不读
+static void *sender_thread(void *arg)
+{
+    struct sockaddr_in *dst = (struct sockaddr_in *)arg;
+    struct sockaddr_in self;
+    struct mmsghdr msgs[16];
+    struct iovec iov;
+    char payload[BENCH_LEN];
+    int s = udp_bind(&self);
+    long long end = now_us() + BENCH_MS * 1000;
+    int ret;
+
+    memset(payload, 'u', sizeof(payload));
+    iov.iov_base = payload;
+    iov.iov_len = sizeof(payload);
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < 16; i++)
+    {
+        msgs[i].msg_hdr.msg_iov = &iov;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = dst;
+        msgs[i].msg_hdr.msg_namelen = sizeof(*dst);
+    }
+    sender_pkts = 0;
+    while (now_us() < end)
+    {
+        ret = sendmmsg(s, msgs, 16, 0);
+        if (ret > 0)
+        {
+            sender_pkts += ret;
+        }
+    }
+    close(s);
+    return NULL;
+}
+
+typedef struct
+{
+    long long pkts;                                 //处理的包数
+    long long calls;                                //收发调用次数
+    long long us;                                   //第一包到最后一包的时间
+} result_t;
+
+//原来的回发循环，和基线版本recv_data的循环体相同
+static void old_loop(int s, result_t *r)
+{
+    struct sockaddr_in client_addr;
+    unsigned int socklen = sizeof(client_addr);
+    long long first = 0;
+    long long last = 0;
+    int len;
+    char databuff[1024];
+
+    while (1)
+    {
+        memset(databuff, 0x00, sizeof(databuff));
+        len = recvfrom(s, databuff, sizeof(databuff), 0, (struct sockaddr *)&client_addr, &socklen);
+        if (len <= 0)
+        {
+            break;
+        }
+        sendto(s, databuff, strlen(databuff), 0, (struct sockaddr *)&client_addr, sizeof(client_addr));
+        last = now_us();
+        if (r->pkts++ == 0)
+        {
+            first = last;
+        }
+        r->calls += 2;
+    }
+    r->us = last - first;
+}
+
+//udp_batch的回发循环，和udp_bsp.c中recv_data的用法相同
+static void batch_loop(int s, result_t *r)
+{
+    static udp_batch_t b;
+    udp_pkt_t *echo[UDP_BATCH_PKT_NUM];
+    long long first = 0;
+    long long last = 0;
+    int n;
+
+    udp_batch_init(&b, s);
+    while ((n = udp_batch_recv(&b)) > 0)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            echo[i] = &b.pkt[(b.head + i) % UDP_BATCH_PKT_NUM];
+        }
+        udp_batch_send(&b, echo, n);
+        udp_batch_release(&b, n);
+        last = now_us();
+        if (r->pkts == 0)
+        {
+            first = last;
+        }
+        r->pkts += n;
+    }
+    r->calls = b.stats.rx_calls + b.stats.tx_calls;
+    r->us = last - first;
+}
+
+static void run(const char *name, void (*loop)(int, result_t *))
+{
+    struct sockaddr_in addr;
+    struct timeval tv = { 0, 200 * 1000 };
+    result_t r = { 0, 0, 0 };
+    pthread_t tid;
+    int s = udp_bind(&addr);
+
+    //发送端停止200ms后接收超时，回发循环结束
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    pthread_create(&tid, NULL, sender_thread, &addr);
+    loop(s, &r);
+    pthread_join(tid, NULL);
+    close(s);
+    printf("  %-22s %9.0f pkts/s, %5.2f pkts per call, %5.1f%% of sent\n", name,
+           r.us > 0 ? r.pkts * 1e6 / r.us : 0.0, r.calls ? r.pkts * 2.0 / r.calls : 0.0,
+           sender_pkts ? r.pkts * 100.0 / sender_pkts : 0.0);
+}
+
+int main(void)
+{
+    printf("udp echo, %d byte datagrams, %s:\n", BENCH_LEN,
+           UDP_BATCH_HAVE_MMSG ? "recvmmsg/sendmmsg" : "lwip fallback (recvfrom/sendto loop)");
+    run("old memset+strlen loop", old_loop);
+    run("udp_batch", batch_loop);
+    return 0;
+}
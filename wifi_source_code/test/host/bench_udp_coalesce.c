@@ -0,0 +1,158 @@
+/*
+* @file         bench_udp_coalesce.c
+* @brief        udp_coalesce的字节效率测试
+* @details      回环上每毫秒(虚拟时间)产生一条小消息，比较三种发法实际发出的数据报数和字节数：
+*               原来固定发1024字节、按实际长度逐条发(时延预算0)、按时延预算合并。
+*               字节数另算上每个数据报28字节的IP/UDP头，接收端拆包确认消息条数和内容都对
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include "udp_coalesce.h"
+
+#define MSG_NUM         1000                        //每轮发送的消息数
+#define MSG_GAP_MS      1                           //消息间隔(虚拟时间)
+#define BUDGET_MS       20                          //合并的时延预算
+#define OLD_SEND_LEN    1024                        //原来每次固定发送的长度
+#define IP_UDP_HDR      28                          //每个数据报的IP头+UDP头
+
+static int rx_msgs;
+static int rx_bad;
+static size_t rx_expect_len;
+
+static int udp_bind(struct sockaddr_in *addr)
+{
+    socklen_t len = sizeof(*addr);
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    int rcvbuf = 4 << 20;
+
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(s, (struct sockaddr *)addr, sizeof(*addr));
+    getsockname(s, (struct sockaddr *)addr, &len);
+    return s;
+}
+
+static void split_cb(void *arg, const uint8_t *data, size_t len)
+{
+    if (len != rx_expect_len || data[0] != (uint8_t)rx_msgs)
+    {
+        rx_bad++;
+    }
+    rx_msgs++;
+}
+
+//收完接收端排队的数据报，coalesced为真时拆包，返回收到的数据报数
+static int drain(int s, int coalesced)
+{
+    static uint8_t buf[2048];
+    int n = 0;
+    int len;
+    while ((len = recv(s, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+    {
+        n++;
+        if (!coalesced)
+        {
+            split_cb(NULL, buf, rx_expect_len);
+        }
+        else if (udp_coalesce_split(buf, len, split_cb, NULL) < 0)
+        {
+            rx_bad++;
+        }
+    }
+    return n;
+}
+
+static void report(const char *name, size_t msg_len, long long datagrams, long long udp_bytes)
+{
+    long long payload = (long long)MSG_NUM * msg_len;
+    long long ip_bytes = udp_bytes + datagrams * IP_UDP_HDR;
+    printf("  %-20s %6lld datagrams %8lld UDP bytes %8lld IP bytes %6.1f%% payload\n",
+           name, datagrams, udp_bytes, ip_bytes, payload * 100.0 / ip_bytes);
+    if (rx_msgs != MSG_NUM || rx_bad != 0)
+    {
+        printf("receiver got %d messages, %d bad\n", rx_msgs, rx_bad);
+        exit(1);
+    }
+}
+
+//原来的发法：不管消息多长都发OLD_SEND_LEN字节
+static void run_old(int tx, int rx, const struct sockaddr_in *dst, size_t msg_len)
+{
+    static uint8_t databuff[OLD_SEND_LEN];
+    long long datagrams = 0;
+
+    rx_msgs = 0;
+    rx_bad = 0;
+    rx_expect_len = msg_len;
+    for (int i = 0; i < MSG_NUM; i++)
+    {
+        memset(databuff, 0, sizeof(databuff));
+        memset(databuff, 'm', msg_len);
+        databuff[0] = (uint8_t)i;
+        sendto(tx, databuff, sizeof(databuff), 0, (const struct sockaddr *)dst, sizeof(*dst));
+        datagrams++;
+        drain(rx, 0);
+    }
+    report("fixed 1024 bytes", msg_len, datagrams, datagrams * OLD_SEND_LEN);
+}
+
+//经合并器发送，budget_ms为0时每条立即按实际长度发出
+static void run_coalesce(const char *name, int tx, int rx, const struct sockaddr_in *dst,
+                         size_t msg_len, uint32_t budget_ms)
+{
+    static udp_coalesce_t c;
+    uint8_t msg[UDP_COALESCE_MAX_MSG];
+    uint32_t now = 0;
+
+    rx_msgs = 0;
+    rx_bad = 0;
+    rx_expect_len = msg_len;
+    memset(msg, 'm', sizeof(msg));
+    udp_coalesce_init(&c, tx, dst, budget_ms);
+    for (int i = 0; i < MSG_NUM; i++, now += MSG_GAP_MS)
+    {
+        udp_coalesce_poll(&c, now);
+        msg[0] = (uint8_t)i;
+        udp_coalesce_put(&c, msg, msg_len, now);
+        drain(rx, 1);
+    }
+    udp_coalesce_flush(&c);
+    drain(rx, 1);
+    report(name, msg_len, c.stats.datagrams, c.stats.wire_bytes);
+}
+
+int main(void)
+{
+    static const size_t lens[] = { 25, 64, 200 };
+    struct sockaddr_in rx_addr;
+    struct sockaddr_in tx_addr;
+    int rx = udp_bind(&rx_addr);
+    int tx = udp_bind(&tx_addr);
+    char name[32];
+
+    printf("udp_coalesce, %d messages, one every %d ms:\n", MSG_NUM, MSG_GAP_MS);
+    for (int i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        printf(" %zu byte messages:\n", lens[i]);
+        run_old(tx, rx, &rx_addr, lens[i]);
+        run_coalesce("exact length", tx, rx, &rx_addr, lens[i], 0);
+        snprintf(name, sizeof(name), "coalesced, %d ms", BUDGET_MS);
+        run_coalesce(name, tx, rx, &rx_addr, lens[i], BUDGET_MS);
+    }
+    close(tx);
+    close(rx);
+    return 0;
+}
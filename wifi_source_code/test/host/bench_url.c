@@ -0,0 +1,156 @@
+/*
+* @file         bench_url.c
+* @brief        user_url解析URL的耗时
+* @details      四个城市的天气URL反复解析,比较每个URL的平均耗时:
+*               1.url_parse一遍扫描,各段只记偏移和长度
+*               2.改之前http_url_parse的做法:strncmp比scheme,strchr找'/',strlen算长度后把主机和路径拷进缓存
+*                 (这里补上了长度检查,去掉了原来越界读的一个字节)
+*               第2种分别用主机libc的字符串函数(向量化的)和逐字节的实现(接近真机newlib)各测一次
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "user_url.h"
+#include "user_http_s.h"
+
+#define ROUNDS          2000000
+
+static const char *const urls[] = { HTTPS_URL_BJ, HTTPS_URL_SH, HTTPS_URL_GZ, HTTPS_URL_SZ };
+
+//旧做法用到的字符串函数
+typedef struct
+{
+    size_t (*len)(const char *s);
+    char *(*chr)(const char *s, int c);
+    int (*ncmp)(const char *a, const char *b, size_t n);
+} str_ops_t;
+
+static char host[32];
+static char filename[1024];
+
+static size_t byte_strlen(const char *s)
+{
+    size_t n = 0;
+    while (s[n] != 0)
+    {
+        n++;
+    }
+    return n;
+}
+
+static char *byte_strchr(const char *s, int c)
+{
+    for (; *s != (char)c; s++)
+    {
+        if (*s == 0)
+        {
+            return NULL;
+        }
+    }
+    return (char *)s;
+}
+
+static int byte_strncmp(const char *a, const char *b, size_t n)
+{
+    for (; n > 0; n--, a++, b++)
+    {
+        if (*a != *b || *a == 0)
+        {
+            return (uint8_t)*a - (uint8_t)*b;
+        }
+    }
+    return 0;
+}
+
+static const str_ops_t libc_ops = { strlen, strchr, strncmp };
+static const str_ops_t byte_ops = { byte_strlen, byte_strchr, byte_strncmp };
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//改之前的拆分方式,拷贝进host和filename
+static int old_parse(const str_ops_t *ops, const char *url)
+{
+    const char *pa, *pb;
+    size_t host_len, file_len;
+
+    if (ops->ncmp(url, "http://", 7) == 0)
+    {
+        pa = url + 7;
+    }
+    else if (ops->ncmp(url, "https://", 8) == 0)
+    {
+        pa = url + 8;
+    }
+    else
+    {
+        return -4;
+    }
+    pb = ops->chr(pa, '/');
+    if (pb == NULL)
+    {
+        pb = pa + ops->len(pa);
+    }
+    host_len = ops->len(pa) - ops->len(pb);
+    file_len = *pb != 0 ? ops->len(pb + 1) : 0;
+    if (host_len >= sizeof(host) || file_len >= sizeof(filename))
+    {
+        return -2;
+    }
+    memcpy(host, pa, host_len);
+    host[host_len] = 0;
+    memcpy(filename, pb + 1 - (*pb == 0), file_len);
+    filename[file_len] = 0;
+    return 0;
+}
+
+static void bench_old(const str_ops_t *ops, const char *name, volatile uint32_t *sink)
+{
+    long long start, end;
+
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (size_t i = 0; i < sizeof(urls) / sizeof(urls[0]); i++)
+        {
+            *sink += old_parse(ops, urls[i]) + filename[0];
+        }
+    }
+    end = now_ns();
+    printf("  %-32s %6.1f ns/URL\n", name, (end - start) / (double)ROUNDS / 4);
+}
+
+int main(void)
+{
+    volatile uint32_t sink = 0;
+    long long start, end;
+    url_t u;
+
+    printf("parsing the %d weather URLs, %d rounds:\n", (int)(sizeof(urls) / sizeof(urls[0])), ROUNDS);
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (size_t i = 0; i < sizeof(urls) / sizeof(urls[0]); i++)
+        {
+            sink += url_parse(urls[i], &u) + u.target.len;
+        }
+    }
+    end = now_ns();
+    printf("  %-32s %6.1f ns/URL\n", "url_parse", (end - start) / (double)ROUNDS / 4);
+
+    bench_old(&libc_ops, "strchr/strlen + copy, host libc", &sink);
+    bench_old(&byte_ops, "strchr/strlen + copy, byte-wise", &sink);
+    return sink == 0xFFFFFFFF;
+}
@@ -0,0 +1,245 @@
+/*
+* @file         bench_ws_deflate.c
+* @brief        hx-ws的permessage-deflate压缩率和速度
+* @details      1.编解码：一串遥测JSON消息，WS_deflate_compress保留/不保留上文和zlib的1、6级(同样1K窗口、同步刷新)比较
+*                 压缩后/原文和每条消息的压缩时间；WS_deflate_inflate和zlib inflate比较每条消息的解压时间
+*               2.经过server：WS_write_conn给协商了压缩和没协商的client连续发同样的消息，比较每秒消息数和线上字节
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <zlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "WebSocket_Deflate.h"
+#include "ws_client.h"
+
+#define WS_PORT         9998                        //和WebSocket_Task.c中的端口一致
+#define MSGS            20000                       //每轮消息数
+#define MSG_CAP         512
+
+//main.c中定义的接收队列
+QueueHandle_t WebSocket_rx_queue;
+
+static const uint8_t tail[4] = { 0x00, 0x00, 0xff, 0xff };
+
+static char corpus[MSGS][MSG_CAP];
+static size_t corpus_len[MSGS];
+static uint8_t wire[MSGS][MSG_CAP];
+static long wire_len[MSGS];
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *server_thread(void *arg)
+{
+    ws_server(NULL);
+    return NULL;
+}
+
+//设备定时上报的遥测，字段名和大部分值每条都一样
+static void make_corpus(void)
+{
+    static const char *states[] = { "idle", "heating", "cooling", "standby" };
+    unsigned seed = 3;
+    for (int i = 0; i < MSGS; i++)
+    {
+        corpus_len[i] = snprintf(corpus[i], MSG_CAP,
+                                 "{\"device\":\"hx-sensor-%02u\",\"seq\":%d,\"temperature\":%u.%u,\"humidity\":%u,"
+                                 "\"rssi\":-%u,\"state\":\"%s\",\"uptime\":%d,\"fw\":\"1.4.2\"}",
+                                 rand_r(&seed) % 8, i, 18 + rand_r(&seed) % 10, rand_r(&seed) % 10,
+                                 30 + rand_r(&seed) % 40, 40 + rand_r(&seed) % 50, states[rand_r(&seed) % 4], 1000 + i * 5);
+    }
+}
+
+static size_t corpus_total(void)
+{
+    size_t total = 0;
+    for (int i = 0; i < MSGS; i++)
+    {
+        total += corpus_len[i];
+    }
+    return total;
+}
+
+//WS_deflate_compress压完整个语料，然后解压回来
+static void bench_ws(const char *name, const char *ext)
+{
+    static WS_deflate_t tx, rx;
+    char req[256];
+    char resp[WS_DEFLATE_RESP_L];
+    static uint8_t out[WS_MAX_MSG_LEN];
+    long long t0, t1, t2;
+    long total = 0;
+
+    snprintf(req, sizeof(req), "GET / HTTP/1.1\r\n%s\r\n", ext);
+    WS_deflate_negotiate(&tx, req, resp, sizeof(resp));
+    WS_deflate_negotiate(&rx, req, resp, sizeof(resp));
+    //解压端按发送端的窗口保留上文
+    rx.client_takeover = tx.server_takeover;
+    t0 = now_us();
+    for (int i = 0; i < MSGS; i++)
+    {
+        wire_len[i] = WS_deflate_compress(&tx, (uint8_t *)corpus[i], corpus_len[i], wire[i], MSG_CAP);
+        if (wire_len[i] > 0)
+        {
+            WS_deflate_commit(&tx, (uint8_t *)corpus[i], corpus_len[i], wire_len[i]);
+            total += wire_len[i];
+        }
+        else
+        {
+            total += corpus_len[i];
+        }
+    }
+    t1 = now_us();
+    for (int i = 0; i < MSGS; i++)
+    {
+        if (wire_len[i] > 0 && WS_deflate_inflate(&rx, wire[i], wire_len[i], out, sizeof(out)) != (int)corpus_len[i])
+        {
+            printf("  %s: message %d does not round trip\n", name, i);
+            return;
+        }
+    }
+    t2 = now_us();
+    printf("  %-28s ratio %.3f  compress %6.2f us/msg  inflate %6.2f us/msg\n", name,
+           total / (double)corpus_total(), (t1 - t0) / (double)MSGS, (t2 - t1) / (double)MSGS);
+}
+
+//zlib同样的窗口和同步刷新
+static void bench_zlib(const char *name, int level)
+{
+    static uint8_t out[WS_MAX_MSG_LEN];
+    uint8_t buf[MSG_CAP + 4];
+    z_stream d, inf;
+    long long t0, t1, t2;
+    long total = 0;
+
+    memset(&d, 0, sizeof(d));
+    memset(&inf, 0, sizeof(inf));
+    deflateInit2(&d, level, Z_DEFLATED, -10, 8, Z_DEFAULT_STRATEGY);
+    inflateInit2(&inf, -10);
+    t0 = now_us();
+    for (int i = 0; i < MSGS; i++)
+    {
+        d.next_in = (uint8_t *)corpus[i];
+        d.avail_in = corpus_len[i];
+        d.next_out = wire[i];
+        d.avail_out = MSG_CAP;
+        deflate(&d, Z_SYNC_FLUSH);
+        wire_len[i] = MSG_CAP - d.avail_out - 4;
+        total += wire_len[i];
+    }
+    t1 = now_us();
+    for (int i = 0; i < MSGS; i++)
+    {
+        memcpy(buf, wire[i], wire_len[i]);
+        memcpy(buf + wire_len[i], tail, 4);
+        inf.next_in = buf;
+        inf.avail_in = wire_len[i] + 4;
+        inf.next_out = out;
+        inf.avail_out = sizeof(out);
+        inflate(&inf, Z_SYNC_FLUSH);
+        if (sizeof(out) - inf.avail_out != corpus_len[i])
+        {
+            printf("  %s: message %d does not round trip\n", name, i);
+            break;
+        }
+    }
+    t2 = now_us();
+    deflateEnd(&d);
+    inflateEnd(&inf);
+    printf("  %-28s ratio %.3f  compress %6.2f us/msg  inflate %6.2f us/msg\n", name,
+           total / (double)corpus_total(), (t1 - t0) / (double)MSGS, (t2 - t1) / (double)MSGS);
+}
+
+struct drainer
+{
+    int         sock;
+    long        frames;                             //收到的数据帧数
+    long long   bytes;                              //收到的数据帧线上字节数
+};
+
+static void *drain_thread(void *arg)
+{
+    static uint8_t buf[WS_MAX_MSG_LEN];
+    struct drainer *d = (struct drainer *)arg;
+    uint8_t op;
+    long n;
+    while ((n = ws_client_recv(d->sock, &op, buf, sizeof(buf), 500)) >= 0)
+    {
+        //保活ping不算
+        if (op != 0x89)
+        {
+            d->frames++;
+            d->bytes += n;
+        }
+    }
+    return NULL;
+}
+
+//经过server：WS_write_conn连续发语料，client只收不解压
+static void bench_server(const char *name, const char *ext)
+{
+    struct drainer d = { ws_client_connect_ext(WS_PORT, ext, NULL, 0), 0, 0 };
+    WebSocket_frame_t f;
+    long long start, end;
+    long frames = 0;
+    pthread_t tid;
+
+    ws_client_send(d.sock, 0x82, "go", 2);
+    xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS);
+    WS_payload_release(f.payload);
+    pthread_create(&tid, NULL, drain_thread, &d);
+    start = now_us();
+    for (int i = 0; i < MSGS; i++, frames++)
+    {
+        if (WS_write_conn(f.conenction, WS_OP_TXT, corpus[i], corpus_len[i]) != ERR_OK)
+        {
+            break;
+        }
+    }
+    end = now_us();
+    shutdown(d.sock, SHUT_WR);
+    pthread_join(tid, NULL);
+    close(d.sock);
+    printf("  %-28s %10.0f msgs/s  wire/raw %.3f  %ld of %ld frames received\n", name,
+           frames * 1e6 / (end - start), d.bytes / (double)corpus_total(), d.frames, frames);
+}
+
+int main(void)
+{
+    pthread_t tid;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    WebSocket_rx_queue = xQueueCreate(10, sizeof(WebSocket_frame_t));
+    pthread_create(&tid, NULL, server_thread, NULL);
+    pthread_detach(tid);
+    make_corpus();
+
+    printf("permessage-deflate, %d telemetry messages of %zu B average:\n", MSGS, corpus_total() / MSGS);
+    bench_ws("ws takeover", "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits");
+    bench_ws("ws no takeover", "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover");
+    bench_zlib("zlib -1 takeover", 1);
+    bench_zlib("zlib -6 takeover", 6);
+    printf("WS_write_conn over loopback:\n");
+    bench_server("plain", "");
+    bench_server("deflate takeover", "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n");
+    bench_server("deflate no takeover",
+                 "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_max_window_bits\r\n");
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+* @file         bench_ws_mask.c
+* @brief        hx-ws的WS_mask和逐字节掩码的性能对比
+* @details      按websocket常见的长度(8/16/125/1460/64K字节)，src对齐和不对齐两种情况，
+*               分别测WS_mask和原来key[i % 4]逐字节循环每秒处理的字节数
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+
+#define BYTES_PER_RUN   (256 * 1024 * 1024)         //每种情况处理的总字节数
+#define BUF_LEN         (64 * 1024 + 8)
+
+//WebSocket_Task.c引用的接收队列，这个测试不启动server
+QueueHandle_t WebSocket_rx_queue;
+
+static const uint8_t key[WS_MASK_L] = { 0x37, 0xfa, 0x21, 0x3d };
+
+//原来接收解析中的逐字节循环，noinline避免编译器按常量长度展开
+static __attribute__((noinline)) void byte_mask(uint8_t *dst, const uint8_t *src, size_t len, size_t offset)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        dst[i] = src[i] ^ key[(offset + i) % 4];
+    }
+}
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//返回MB/s
+static double run(int word, uint8_t *dst, const uint8_t *src, size_t len)
+{
+    long loops = BYTES_PER_RUN / len;
+    long long start = now_ns();
+
+    for (long i = 0; i < loops; i++)
+    {
+        if (word)
+        {
+            WS_mask(dst, src, len, key, i);
+        }
+        else
+        {
+            byte_mask(dst, src, len, i);
+        }
+        //不让编译器把循环当成没用的去掉
+        __asm__ volatile("" : : "r"(dst) : "memory");
+    }
+    return (double)loops * len * 1000.0 / (now_ns() - start);
+}
+
+int main(void)
+{
+    static const size_t lens[] = { 8, 16, 125, 1460, 64 * 1024 };
+    static uint8_t src[BUF_LEN];
+    static uint8_t dst[BUF_LEN];
+    double b, w;
+
+    for (size_t i = 0; i < sizeof(src); i++)
+    {
+        src[i] = (uint8_t)i;
+    }
+    printf("WS_mask vs byte loop, MB/s:\n");
+    for (int i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        for (int mis = 0; mis < 2; mis++)
+        {
+            //dst总是对齐，src错开1字节模拟帧头后面紧跟的数据
+            b = run(0, dst, src + mis, lens[i]);
+            w = run(1, dst, src + mis, lens[i]);
+            printf("  %6zu B src %-10s byte %8.0f  WS_mask %8.0f  %5.1fx\n", lens[i],
+                   mis ? "misaligned" : "aligned", b, w, w / b);
+        }
+    }
+    return 0;
+}
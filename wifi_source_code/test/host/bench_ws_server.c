@@ -0,0 +1,243 @@
+/*
+* @file         bench_ws_server.c
+* @brief        hx-ws的websocket server回环性能测试
+* @details      1.接收：client连续发带掩码的二进制帧，测试线程作接收任务从队列取消息并归还内存池，
+*                 统计每秒交付的消息数和MB/s，以及因接收队列满或内存池不够而丢掉的消息
+*               2.发送：WS_write_conn连续发二进制帧，client收帧，统计每秒发出的帧数和MB/s
+*               3.广播：1/4/8个client各有一个线程收帧，WS_broadcast_data连续广播，统计每秒广播的消息数、
+*                 发出的帧数，以及因client发送缓存满而跳过的帧
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "ws_client.h"
+
+#define WS_PORT         9998                        //和WebSocket_Task.c中的端口一致
+#define RX_TOTAL        (16 * 1024 * 1024)          //接收测试每轮client发送的字节数
+#define TX_TOTAL        (16 * 1024 * 1024)          //发送测试每轮发送的字节数
+#define BC_MSGS         200000                      //广播测试每轮的消息数
+
+//main.c中定义的接收队列
+QueueHandle_t WebSocket_rx_queue;
+
+struct sender
+{
+    int         sock;
+    size_t      msg_len;
+    long        msgs;                               //发出的消息数
+};
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *server_thread(void *arg)
+{
+    ws_server(NULL);
+    return NULL;
+}
+
+//client：把一批帧组好，反复发送到RX_TOTAL字节
+static void *send_thread(void *arg)
+{
+    struct sender *s = (struct sender *)arg;
+    size_t frame_len = s->msg_len + 14;
+    size_t per_batch = 64 * 1024 / frame_len + 1;
+    uint8_t *batch = malloc(per_batch * frame_len);
+    uint8_t *payload = malloc(s->msg_len);
+    size_t batch_len = 0;
+    long long sent = 0;
+
+    memset(payload, 'w', s->msg_len);
+    for (size_t i = 0; i < per_batch; i++)
+    {
+        batch_len += ws_client_frame(batch + batch_len, 0x82, payload, s->msg_len, WS_LEN_AUTO, 1);
+    }
+    s->msgs = 0;
+    while (sent < RX_TOTAL && ws_client_send_raw(s->sock, batch, batch_len, 0) == 0)
+    {
+        sent += per_batch * s->msg_len;
+        s->msgs += per_batch;
+    }
+    free(payload);
+    free(batch);
+    return NULL;
+}
+
+//接收：消息长度为msg_len，一直取到队列200ms没有新消息
+static void bench_rx(size_t msg_len)
+{
+    struct sender s = { ws_client_connect(WS_PORT), msg_len, 0 };
+    WebSocket_frame_t f;
+    long long first = 0;
+    long long last = 0;
+    long long bytes = 0;
+    long got = 0;
+    pthread_t tid;
+
+    pthread_create(&tid, NULL, send_thread, &s);
+    while (xQueueReceive(WebSocket_rx_queue, &f, 200) == pdTRUE)
+    {
+        last = now_us();
+        if (got++ == 0)
+        {
+            first = last;
+        }
+        bytes += f.payload_length;
+        WS_payload_release(f.payload);
+    }
+    pthread_join(tid, NULL);
+    close(s.sock);
+    printf("  rx %6zu B msgs %10.0f msgs/s %8.1f MB/s %6.2f%% dropped (rx queue full or pool exhausted)\n", msg_len,
+           last > first ? got * 1e6 / (last - first) : 0.0, last > first ? bytes / (double)(last - first) : 0.0,
+           s.msgs ? (s.msgs - got) * 100.0 / s.msgs : 0.0);
+}
+
+struct drainer
+{
+    int         sock;
+    long        frames;                             //收到的帧数
+};
+
+static void *drain_thread(void *arg)
+{
+    static uint8_t buf[70000];
+    struct drainer *d = (struct drainer *)arg;
+    uint8_t op;
+    d->frames = 0;
+    while (ws_client_recv(d->sock, &op, buf, sizeof(buf), 500) >= 0)
+    {
+        //保活ping不算
+        d->frames += op != 0x89;
+    }
+    return NULL;
+}
+
+//发送：WS_write_conn发送msg_len字节的帧直到TX_TOTAL字节
+static void bench_tx(size_t msg_len)
+{
+    struct drainer d = { ws_client_connect(WS_PORT), 0 };
+    WebSocket_frame_t f;
+    char *payload = malloc(msg_len);
+    long long start;
+    long long end;
+    long frames = 0;
+    pthread_t tid;
+
+    memset(payload, 't', msg_len);
+    //先收到一条消息，server已经进入数据接收
+    ws_client_send(d.sock, 0x82, "go", 2);
+    xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS);
+    WS_payload_release(f.payload);
+    pthread_create(&tid, NULL, drain_thread, &d);
+    start = now_us();
+    for (long long sent = 0; sent < TX_TOTAL; sent += msg_len, frames++)
+    {
+        if (WS_write_conn(f.conenction, WS_OP_BIN, payload, msg_len) != ERR_OK)
+        {
+            break;
+        }
+    }
+    end = now_us();
+    shutdown(d.sock, SHUT_WR);
+    pthread_join(tid, NULL);
+    close(d.sock);
+    free(payload);
+    printf("  tx %6zu B msgs %10.0f msgs/s %8.1f MB/s %ld of %ld frames received\n", msg_len,
+           frames * 1e6 / (end - start), frames * (double)msg_len / (end - start), d.frames, frames);
+}
+
+//等到已握手的客户端数为n
+static void wait_clients(uint8_t n)
+{
+    for (int i = 0; i < 400 && WS_client_count() != n; i++)
+    {
+        usleep(5000);
+    }
+}
+
+//广播：clients个client各自收帧，广播BC_MSGS条msg_len字节的消息
+static void bench_broadcast(int clients, size_t msg_len)
+{
+    struct drainer d[WS_MAX_CLIENTS];
+    pthread_t tid[WS_MAX_CLIENTS];
+    char *payload = malloc(msg_len);
+    long long start;
+    long long end;
+    long frames = 0;
+    long received = 0;
+    int i;
+
+    memset(payload, 'b', msg_len);
+    for (i = 0; i < clients; i++)
+    {
+        d[i].sock = ws_client_connect(WS_PORT);
+    }
+    wait_clients(clients);
+    for (i = 0; i < clients; i++)
+    {
+        pthread_create(&tid[i], NULL, drain_thread, &d[i]);
+    }
+    start = now_us();
+    for (i = 0; i < BC_MSGS; i++)
+    {
+        frames += WS_broadcast_data(WS_OP_BIN, payload, msg_len);
+    }
+    end = now_us();
+    for (i = 0; i < clients; i++)
+    {
+        shutdown(d[i].sock, SHUT_WR);
+        pthread_join(tid[i], NULL);
+        close(d[i].sock);
+        received += d[i].frames;
+    }
+    wait_clients(0);
+    free(payload);
+    printf("  broadcast %d clients %5zu B msgs %10.0f msgs/s %10.0f frames/s %6.2f%% skipped, %ld of %ld frames received\n",
+           clients, msg_len, BC_MSGS * 1e6 / (end - start), frames * 1e6 / (end - start),
+           (clients * (double)BC_MSGS - frames) * 100.0 / (clients * (double)BC_MSGS), received, frames);
+}
+
+int main(void)
+{
+    static const size_t lens[] = { 16, 125, 1000, 8000 };
+    static const int clients[] = { 1, 4, WS_MAX_CLIENTS };
+    pthread_t tid;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    WebSocket_rx_queue = xQueueCreate(10, sizeof(WebSocket_frame_t));
+    pthread_create(&tid, NULL, server_thread, NULL);
+    pthread_detach(tid);
+
+    printf("websocket server over loopback, %d MiB per run:\n", RX_TOTAL >> 20);
+    for (int i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        bench_rx(lens[i]);
+    }
+    for (int i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        bench_tx(lens[i]);
+    }
+    for (int i = 0; i < (int)(sizeof(clients) / sizeof(clients[0])); i++)
+    {
+        bench_broadcast(clients[i], 64);
+        bench_broadcast(clients[i], 1000);
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+* @file         cjson_tree.h
+* @brief        性能测试用的和cJSON一样的树
+* @details      主机上没有cJSON,仓库也不带它的源码,这里的树和cJSON的节点结构、分配方式一样:
+*               每个值calloc一个节点,键名和字符串各malloc一份,打印缓存从256字节开始翻倍,最后缩到实际长度;
+*               用来和改之前先建树再cJSON_Print的做法比较时间和堆分配
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef __HOST_CJSON_TREE_H__
+#define __HOST_CJSON_TREE_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+    NODE_FALSE,
+    NODE_TRUE,
+    NODE_NULL,
+    NODE_NUMBER,
+    NODE_STRING,
+    NODE_ARRAY,
+    NODE_OBJECT,
+};
+
+//字段和cJSON结构体一样
+typedef struct node
+{
+    struct node    *next;
+    struct node    *prev;
+    struct node    *child;
+    int             type;
+    char           *valuestring;
+    int             valueint;
+    double          valuedouble;
+    char           *string;
+} node_t;
+
+typedef struct
+{
+    char           *buf;
+    size_t          len;
+    size_t          cap;
+} print_t;
+
+static inline const char *skip_space(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    {
+        p++;
+    }
+    return p;
+}
+
+//cJSON先数出长度再malloc,转义原样保留,这里只比较分配
+static inline const char *parse_string(const char *p, char **out)
+{
+    const char *end = ++p;
+    while (*end && *end != '"')
+    {
+        end += *end == '\\' ? 2 : 1;
+    }
+    *out = (char *)malloc(end - p + 1);
+    memcpy(*out, p, end - p);
+    (*out)[end - p] = 0;
+    return *end ? end + 1 : NULL;
+}
+
+static inline void node_delete(node_t *n)
+{
+    node_t *next;
+    while (n != NULL)
+    {
+        next = n->next;
+        node_delete(n->child);
+        free(n->valuestring);
+        free(n->string);
+        free(n);
+        n = next;
+    }
+}
+
+static inline const char *parse_value(const char *p, node_t *n)
+{
+    node_t *child, *last = NULL;
+    char close;
+
+    p = skip_space(p);
+    if (*p == '"')
+    {
+        n->type = NODE_STRING;
+        return parse_string(p, &n->valuestring);
+    }
+    if (*p == '{' || *p == '[')
+    {
+        n->type = *p == '{' ? NODE_OBJECT : NODE_ARRAY;
+        close = *p == '{' ? '}' : ']';
+        p = skip_space(p + 1);
+        while (p != NULL && *p != close)
+        {
+            child = (node_t *)calloc(1, sizeof(node_t));
+            if (last == NULL)
+            {
+                n->child = child;
+            }
+            else
+            {
+                last->next = child;
+                child->prev = last;
+            }
+            last = child;
+            if (n->type == NODE_OBJECT)
+            {
+                p = parse_string(skip_space(p), &child->string);
+                p = p ? skip_space(p) + 1 : NULL;
+            }
+            p = p ? parse_value(p, child) : NULL;
+            p = p ? skip_space(p) : NULL;
+            if (p != NULL && *p == ',')
+            {
+                p = skip_space(p + 1);
+            }
+        }
+        return p ? p + 1 : NULL;
+    }
+    if (strncmp(p, "true", 4) == 0 || strncmp(p, "null", 4) == 0)
+    {
+        n->type = *p == 't' ? NODE_TRUE : NODE_NULL;
+        return p + 4;
+    }
+    if (strncmp(p, "false", 5) == 0)
+    {
+        n->type = NODE_FALSE;
+        return p + 5;
+    }
+    n->type = NODE_NUMBER;
+    n->valuedouble = strtod(p, (char **)&p);
+    n->valueint = (int)n->valuedouble;
+    return p;
+}
+
+static inline node_t *tree_parse(const char *text)
+{
+    node_t *root = (node_t *)calloc(1, sizeof(node_t));
+    if (parse_value(text, root) == NULL)
+    {
+        node_delete(root);
+        return NULL;
+    }
+    return root;
+}
+
+static inline node_t *get_item(node_t *n, const char *key)
+{
+    for (n = n ? n->child : NULL; n != NULL && (n->string == NULL || strcmp(n->string, key)); n = n->next)
+    {
+    }
+    return n;
+}
+
+static inline node_t *get_index(node_t *n, int i)
+{
+    for (n = n ? n->child : NULL; n != NULL && i > 0; n = n->next, i--)
+    {
+    }
+    return n;
+}
+
+//和cJSON的ensure一样,不够时扩到需要的两倍
+static inline void print_put(print_t *pb, const char *s, size_t len)
+{
+    if (pb->len + len + 1 > pb->cap)
+    {
+        pb->cap = (pb->len + len + 1) * 2;
+        pb->buf = (char *)realloc(pb->buf, pb->cap);
+    }
+    memcpy(pb->buf + pb->len, s, len);
+    pb->len += len;
+}
+
+//和cJSON_Print一样带缩进
+static inline void print_value(print_t *pb, const node_t *n, int depth)
+{
+    char num[32];
+    const node_t *c;
+
+    switch (n->type)
+    {
+    case NODE_FALSE:
+        print_put(pb, "false", 5);
+        break;
+    case NODE_TRUE:
+        print_put(pb, "true", 4);
+        break;
+    case NODE_NULL:
+        print_put(pb, "null", 4);
+        break;
+    case NODE_NUMBER:
+        print_put(pb, num, snprintf(num, sizeof(num), "%g", n->valuedouble));
+        break;
+    case NODE_STRING:
+        print_put(pb, "\"", 1);
+        print_put(pb, n->valuestring, strlen(n->valuestring));
+        print_put(pb, "\"", 1);
+        break;
+    default:
+        print_put(pb, n->type == NODE_OBJECT ? "{\n" : "[", n->type == NODE_OBJECT ? 2 : 1);
+        for (c = n->child; c != NULL; c = c->next)
+        {
+            if (n->type == NODE_OBJECT)
+            {
+                for (int i = 0; i <= depth; i++)
+                {
+                    print_put(pb, "\t", 1);
+                }
+                print_put(pb, "\"", 1);
+                print_put(pb, c->string, strlen(c->string));
+                print_put(pb, "\":\t", 3);
+            }
+            print_value(pb, c, depth + 1);
+            if (c->next != NULL)
+            {
+                print_put(pb, n->type == NODE_OBJECT ? ",\n" : ", ", 2);
+            }
+        }
+        if (n->type == NODE_OBJECT)
+        {
+            print_put(pb, "\n", 1);
+            for (int i = 0; i < depth; i++)
+            {
+                print_put(pb, "\t", 1);
+            }
+        }
+        print_put(pb, n->type == NODE_OBJECT ? "}" : "]", 1);
+        break;
+    }
+}
+
+static inline char *tree_print(const node_t *n)
+{
+    print_t pb = { (char *)malloc(256), 0, 256 };
+    if (n == NULL)
+    {
+        free(pb.buf);
+        return NULL;
+    }
+    print_value(&pb, n, 0);
+    pb.buf[pb.len] = 0;
+    return (char *)realloc(pb.buf, pb.len + 1);
+}
+
+#endif /* __HOST_CJSON_TREE_H__ */
@@ -0,0 +1,84 @@
+/*
+* @file         heap_wrap.h
+* @brief        性能测试用的堆统计
+* @details      链接时用-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free换掉分配函数,
+*               heap_counting不为0时统计分配次数、当前占用和最高占用,占用按malloc_usable_size算;
+*               一个程序只能有一个源文件包含
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef __HOST_HEAP_WRAP_H__
+#define __HOST_HEAP_WRAP_H__
+
+#include <stdlib.h>
+#include <malloc.h>
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+void __real_free(void *p);
+
+static int heap_counting;
+static long heap_allocs;                            //分配次数
+static long heap_now;                               //当前占用
+static long heap_peak;                              //最高占用
+
+static inline void heap_add(void *p)
+{
+    if (heap_counting && p != NULL)
+    {
+        heap_allocs++;
+        heap_now += malloc_usable_size(p);
+        heap_peak = heap_now > heap_peak ? heap_now : heap_peak;
+    }
+}
+
+static inline void heap_sub(void *p)
+{
+    if (heap_counting && p != NULL)
+    {
+        heap_now -= malloc_usable_size(p);
+    }
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *p = __real_malloc(size);
+    heap_add(p);
+    return p;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    void *p = __real_calloc(n, size);
+    heap_add(p);
+    return p;
+}
+
+void *__wrap_realloc(void *old, size_t size)
+{
+    void *p;
+    heap_sub(old);
+    p = __real_realloc(old, size);
+    heap_add(p ? p : old);
+    return p;
+}
+
+void __wrap_free(void *p)
+{
+    heap_sub(p);
+    __real_free(p);
+}
+
+static inline void heap_reset(void)
+{
+    heap_allocs = 0;
+    heap_now = 0;
+    heap_peak = 0;
+}
+
+#endif /* __HOST_HEAP_WRAP_H__ */
@@ -0,0 +1,67 @@
+/*
+* @file         base64.c
+* @brief        wpa2/utils/base64.h桩的实现
+*/
+#include <stdlib.h>
+#include "wpa2/utils/base64.h"
+
+static const unsigned char base64_table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+unsigned char *_base64_encode(const unsigned char *src, size_t len, size_t *out_len)
+{
+    size_t olen = len * 4 / 3 + 4;
+    unsigned char *out;
+    unsigned char *pos;
+    const unsigned char *in = src;
+    const unsigned char *end = src + len;
+    int line_len = 0;
+
+    olen += olen / 72 + 1;
+    out = malloc(olen);
+    if (out == NULL)
+    {
+        return NULL;
+    }
+    pos = out;
+    while (end - in >= 3)
+    {
+        *pos++ = base64_table[in[0] >> 2];
+        *pos++ = base64_table[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+        *pos++ = base64_table[((in[1] & 0x0f) << 2) | (in[2] >> 6)];
+        *pos++ = base64_table[in[2] & 0x3f];
+        in += 3;
+        line_len += 4;
+        if (line_len >= 72)
+        {
+            *pos++ = '\n';
+            line_len = 0;
+        }
+    }
+    if (end - in)
+    {
+        *pos++ = base64_table[in[0] >> 2];
+        if (end - in == 1)
+        {
+            *pos++ = base64_table[(in[0] & 0x03) << 4];
+            *pos++ = '=';
+        }
+        else
+        {
+            *pos++ = base64_table[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+            *pos++ = base64_table[(in[1] & 0x0f) << 2];
+        }
+        *pos++ = '=';
+        line_len += 4;
+    }
+    if (line_len)
+    {
+        *pos++ = '\n';
+    }
+    *pos = '\0';
+    if (out_len)
+    {
+        *out_len = pos - out;
+    }
+    return out;
+}
@@ -0,0 +1,15 @@
+/*
+* @file         esp_event_loop.h
+* @brief        主机测试用的esp_event_loop.h桩,事件回调只登记不调用
+*/
+#ifndef _HOST_STUB_ESP_EVENT_LOOP_H_
+#define _HOST_STUB_ESP_EVENT_LOOP_H_
+
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+typedef esp_err_t (*system_event_cb_t)(void *ctx, system_event_t *event);
+
+static inline esp_err_t esp_event_loop_init(system_event_cb_t cb, void *ctx) { return ESP_OK; }
+
+#endif /* _HOST_STUB_ESP_EVENT_LOOP_H_ */
@@ -0,0 +1,14 @@
+/*
+* @file         esp_heap_alloc_caps.h
+* @brief        主机测试用的esp_heap_alloc_caps.h桩,按能力申请内存就是malloc
+*/
+#ifndef _HOST_STUB_ESP_HEAP_ALLOC_CAPS_H_
+#define _HOST_STUB_ESP_HEAP_ALLOC_CAPS_H_
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT             (1 << 2)
+
+#define pvPortMallocCaps(size, caps)    malloc(size)
+
+#endif /* _HOST_STUB_ESP_HEAP_ALLOC_CAPS_H_ */
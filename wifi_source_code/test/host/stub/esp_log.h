@@ -0,0 +1,23 @@
+/*
+* @file         esp_log.h
+* @brief        主机测试用的esp_log.h桩,日志打到stderr,HOST_TEST_QUIET时不打印
+*/
+#ifndef _HOST_STUB_ESP_LOG_H_
+#define _HOST_STUB_ESP_LOG_H_
+
+#include <stdio.h>
+
+#ifdef HOST_TEST_QUIET
+#define HOST_LOG(level, tag, fmt, ...)  do { if (0) fprintf(stderr, "%s" fmt, tag, ##__VA_ARGS__); } while (0)
+#else
+#define HOST_LOG(level, tag, fmt, ...)  fprintf(stderr, level " (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#endif
+
+#define ESP_LOGE(tag, fmt, ...)         HOST_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)         HOST_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)         HOST_LOG("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)         do { } while (0)
+#define ESP_LOGV(tag, fmt, ...)         do { } while (0)
+#define ESP_LOG_BUFFER_HEXDUMP(tag, buff, len, level)   do { } while (0)
+
+#endif /* _HOST_STUB_ESP_LOG_H_ */
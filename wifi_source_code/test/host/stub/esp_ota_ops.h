@@ -0,0 +1,19 @@
+/*
+* @file         esp_ota_ops.h
+* @brief        主机测试用的OTA桩,esp_ota_write从分区开头顺序写入,经过扇区开头时先擦除
+*/
+#ifndef _HOST_STUB_ESP_OTA_OPS_H_
+#define _HOST_STUB_ESP_OTA_OPS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+typedef uint32_t esp_ota_handle_t;
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle);
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size);
+esp_err_t esp_ota_end(esp_ota_handle_t handle);
+
+#endif /* _HOST_STUB_ESP_OTA_OPS_H_ */
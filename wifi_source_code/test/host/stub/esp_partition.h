@@ -0,0 +1,35 @@
+/*
+* @file         esp_partition.h
+* @brief        主机测试用的分区桩,分区内容保存在一个文件中
+* @details      写入按NOR flash的规则只能把1改成0,没有擦除就重写会得到两次数据的与;
+*               可以指定某个偏移在接下来几次写入时写错,用来测试读回校验
+*/
+#ifndef _HOST_STUB_ESP_PARTITION_H_
+#define _HOST_STUB_ESP_PARTITION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define SPI_FLASH_SEC_SIZE          4096
+
+typedef struct
+{
+    uint32_t    address;
+    uint32_t    size;
+    char        label[17];
+    bool        encrypted;
+} esp_partition_t;
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, uint32_t start_addr, uint32_t size);
+
+//打开path作为分区内容,文件按size截断并整个擦除
+const esp_partition_t *host_partition_open(const char *path, uint32_t size);
+void host_partition_close(void);
+//之后times次覆盖offset的写入把这个字节写错,重新打开分区不会清除
+void host_partition_fault(uint32_t offset, int times);
+
+#endif /* _HOST_STUB_ESP_PARTITION_H_ */
@@ -0,0 +1,16 @@
+/*
+* @file         esp_system.h
+* @brief        主机测试用的esp_system.h桩,esp_random用libc的伪随机数,测试可以用srand固定序列
+*/
+#ifndef _HOST_STUB_ESP_SYSTEM_H_
+#define _HOST_STUB_ESP_SYSTEM_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline uint32_t esp_random(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+#endif /* _HOST_STUB_ESP_SYSTEM_H_ */
@@ -0,0 +1,18 @@
+/*
+* @file         esp_timer.h
+* @brief        主机测试用的esp_timer.h桩,微秒时间取主机单调时钟
+*/
+#ifndef _HOST_STUB_ESP_TIMER_H_
+#define _HOST_STUB_ESP_TIMER_H_
+
+#include <stdint.h>
+#include <time.h>
+
+static inline int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#endif /* _HOST_STUB_ESP_TIMER_H_ */
@@ -0,0 +1,99 @@
+/*
+* @file         esp_wifi.h
+* @brief        主机测试用的esp_wifi.h桩,只让带wifi初始化的bsp源码能编译,函数都不做事
+*/
+#ifndef _HOST_STUB_ESP_WIFI_H_
+#define _HOST_STUB_ESP_WIFI_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define MACSTR                      "%02x:%02x:%02x:%02x:%02x:%02x"
+#define MAC2STR(a)                  (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+
+typedef enum
+{
+    SYSTEM_EVENT_STA_START = 0,
+    SYSTEM_EVENT_STA_DISCONNECTED,
+    SYSTEM_EVENT_STA_CONNECTED,
+    SYSTEM_EVENT_STA_GOT_IP,
+    SYSTEM_EVENT_AP_STACONNECTED,
+    SYSTEM_EVENT_AP_STADISCONNECTED,
+} system_event_id_t;
+
+typedef struct
+{
+    uint32_t addr;
+} ip4_addr_t;
+
+typedef struct
+{
+    system_event_id_t event_id;
+    union
+    {
+        struct
+        {
+            struct
+            {
+                ip4_addr_t ip;
+            } ip_info;
+        } got_ip;
+        struct
+        {
+            uint8_t mac[6];
+            uint8_t aid;
+        } sta_connected, sta_disconnected;
+    } event_info;
+} system_event_t;
+
+typedef enum
+{
+    WIFI_MODE_STA = 1,
+    WIFI_MODE_AP,
+} wifi_mode_t;
+
+typedef enum
+{
+    ESP_IF_WIFI_STA = 0,
+    ESP_IF_WIFI_AP,
+} wifi_interface_t;
+
+typedef enum
+{
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WPA_WPA2_PSK = 4,
+} wifi_auth_mode_t;
+
+typedef union
+{
+    struct
+    {
+        uint8_t ssid[32];
+        uint8_t password[64];
+    } sta;
+    struct
+    {
+        uint8_t ssid[32];
+        uint8_t password[64];
+        uint8_t ssid_len;
+        uint8_t max_connection;
+        wifi_auth_mode_t authmode;
+    } ap;
+} wifi_config_t;
+
+typedef struct
+{
+    int dummy;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_DEFAULT()  { 0 }
+
+static inline const char *ip4addr_ntoa(const ip4_addr_t *addr) { return "0.0.0.0"; }
+static inline void tcpip_adapter_init(void) { }
+static inline esp_err_t esp_wifi_init(const wifi_init_config_t *cfg) { return ESP_OK; }
+static inline esp_err_t esp_wifi_set_mode(wifi_mode_t mode) { return ESP_OK; }
+static inline esp_err_t esp_wifi_set_config(wifi_interface_t ifx, wifi_config_t *conf) { return ESP_OK; }
+static inline esp_err_t esp_wifi_start(void) { return ESP_OK; }
+static inline esp_err_t esp_wifi_connect(void) { return ESP_OK; }
+
+#endif /* _HOST_STUB_ESP_WIFI_H_ */
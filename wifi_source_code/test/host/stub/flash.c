@@ -0,0 +1,172 @@
+/*
+* @file         flash.c
+* @brief        文件做后端的分区和OTA桩
+* @details      只支持一个分区;写入按NOR flash的规则和原内容相与,擦除把内容置为0xFF
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+
+static esp_partition_t host_partition = { .address = 0x110000, .label = "ota_0" };
+static FILE *host_partition_file;
+static uint32_t host_ota_offset;
+static uint32_t host_fault_offset;
+static int host_fault_times;
+
+static bool host_partition_range_ok(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    return host_partition_file != NULL && partition == &host_partition && offset <= host_partition.size &&
+           size <= host_partition.size - offset;
+}
+
+const esp_partition_t *host_partition_open(const char *path, uint32_t size)
+{
+    host_partition_close();
+    host_partition_file = fopen(path, "w+b");
+    if (host_partition_file == NULL)
+    {
+        return NULL;
+    }
+    host_partition.size = size;
+    host_partition.encrypted = false;
+    if (esp_partition_erase_range(&host_partition, 0, size) != ESP_OK)
+    {
+        host_partition_close();
+        return NULL;
+    }
+    return &host_partition;
+}
+
+void host_partition_close(void)
+{
+    if (host_partition_file != NULL)
+    {
+        fclose(host_partition_file);
+        host_partition_file = NULL;
+    }
+}
+
+void host_partition_fault(uint32_t offset, int times)
+{
+    host_fault_offset = offset;
+    host_fault_times = times;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (!host_partition_range_ok(partition, src_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (fseek(host_partition_file, src_offset, SEEK_SET) != 0 || fread(dst, 1, size, host_partition_file) != size)
+    {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    uint8_t old[SPI_FLASH_SEC_SIZE];
+    const uint8_t *p = src;
+    size_t n, i;
+    esp_err_t err;
+
+    if (!host_partition_range_ok(partition, dst_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    while (size > 0)
+    {
+        n = size < sizeof(old) ? size : sizeof(old);
+        err = esp_partition_read(partition, dst_offset, old, n);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        for (i = 0; i < n; i++)
+        {
+            old[i] &= p[i];
+        }
+        if (host_fault_times > 0 && host_fault_offset >= dst_offset && host_fault_offset < dst_offset + n)
+        {
+            host_fault_times--;
+            old[host_fault_offset - dst_offset] ^= 0x01;
+        }
+        if (fseek(host_partition_file, dst_offset, SEEK_SET) != 0 || fwrite(old, 1, n, host_partition_file) != n)
+        {
+            return ESP_FAIL;
+        }
+        p += n;
+        dst_offset += n;
+        size -= n;
+    }
+    return fflush(host_partition_file) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, uint32_t start_addr, uint32_t size)
+{
+    uint8_t ff[SPI_FLASH_SEC_SIZE];
+    uint32_t off;
+
+    if (!host_partition_range_ok(partition, start_addr, size) || start_addr % SPI_FLASH_SEC_SIZE != 0 ||
+        size % SPI_FLASH_SEC_SIZE != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(ff, 0xFF, sizeof(ff));
+    for (off = start_addr; off < start_addr + size; off += SPI_FLASH_SEC_SIZE)
+    {
+        if (fseek(host_partition_file, off, SEEK_SET) != 0 || fwrite(ff, 1, sizeof(ff), host_partition_file) != sizeof(ff))
+        {
+            return ESP_FAIL;
+        }
+    }
+    return fflush(host_partition_file) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+{
+    if (partition != &host_partition || host_partition_file == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_ota_offset = 0;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
+{
+    uint32_t sec, end;
+    esp_err_t err;
+
+    if (handle != 1 || !host_partition_range_ok(&host_partition, host_ota_offset, size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    //和ESP-IDF一样,写到新的扇区之前先擦除这个扇区
+    end = host_ota_offset + size;
+    for (sec = (host_ota_offset + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE; sec < end;
+         sec += SPI_FLASH_SEC_SIZE)
+    {
+        err = esp_partition_erase_range(&host_partition, sec, SPI_FLASH_SEC_SIZE);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+    err = esp_partition_write(&host_partition, host_ota_offset, data, size);
+    if (err == ESP_OK)
+    {
+        host_ota_offset = end;
+    }
+    return err;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+    return handle == 1 ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
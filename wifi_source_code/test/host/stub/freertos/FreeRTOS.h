@@ -0,0 +1,32 @@
+/*
+* @file         FreeRTOS.h
+* @brief        主机测试用的FreeRTOS.h桩,只有被测代码用到的类型和宏
+*/
+#ifndef _HOST_STUB_FREERTOS_H_
+#define _HOST_STUB_FREERTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "esp_err.h"                            //ESP-IDF的FreeRTOS.h间接包含了stdbool.h和esp_err.h
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE                     0
+#define pdTRUE                      1
+#define pdPASS                      pdTRUE
+#define pdFAIL                      pdFALSE
+#define portMAX_DELAY               ((TickType_t)0xffffffff)
+#define portTICK_PERIOD_MS          1
+#define portTICK_RATE_MS            portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms) / portTICK_PERIOD_MS)
+
+//临界区用互斥锁代替，保护的数据和真机一样只在锁内访问
+typedef pthread_mutex_t portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    PTHREAD_MUTEX_INITIALIZER
+#define portENTER_CRITICAL(mux)         pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux)          pthread_mutex_unlock(mux)
+
+#endif /* _HOST_STUB_FREERTOS_H_ */
@@ -0,0 +1,21 @@
+/*
+* @file         event_groups.h
+* @brief        主机测试用的event_groups.h桩,事件组不做事,只让用到事件组的源码能编译
+*/
+#ifndef _HOST_STUB_EVENT_GROUPS_H_
+#define _HOST_STUB_EVENT_GROUPS_H_
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+typedef void *EventGroupHandle_t;
+
+typedef uint32_t EventBits_t;
+
+#define BIT0                        0x00000001
+
+static inline EventGroupHandle_t xEventGroupCreate(void) { return NULL; }
+static inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) { return bits; }
+static inline EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) { return 0; }
+
+#endif /* _HOST_STUB_EVENT_GROUPS_H_ */
@@ -0,0 +1,21 @@
+/*
+* @file         queue.h
+* @brief        主机测试用的queue.h桩,队列用pthread互斥锁和条件变量实现,等待的tick按毫秒算真实时间
+*/
+#ifndef _HOST_STUB_QUEUE_H_
+#define _HOST_STUB_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(uint32_t length, uint32_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+uint32_t uxQueueMessagesWaiting(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+
+#define xQueueSendFromISR(queue, item, woken)       xQueueSend(queue, item, 0)
+
+#endif /* _HOST_STUB_QUEUE_H_ */
@@ -0,0 +1,37 @@
+/*
+* @file         semphr.h
+* @brief        主机测试用的semphr.h桩,互斥量就是pthread互斥锁,等待时间不限
+*/
+#ifndef _HOST_STUB_SEMPHR_H_
+#define _HOST_STUB_SEMPHR_H_
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+
+typedef pthread_mutex_t *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t m = malloc(sizeof(*m));
+    pthread_mutex_init(m, NULL);
+    return m;
+}
+
+static inline void vSemaphoreDelete(SemaphoreHandle_t m)
+{
+    pthread_mutex_destroy(m);
+    free(m);
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks)
+{
+    return pthread_mutex_lock(m) == 0 ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t m)
+{
+    return pthread_mutex_unlock(m) == 0 ? pdTRUE : pdFALSE;
+}
+
+#endif /* _HOST_STUB_SEMPHR_H_ */
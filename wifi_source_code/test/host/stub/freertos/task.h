@@ -0,0 +1,58 @@
+/*
+* @file         task.h
+* @brief        主机测试用的task.h桩,tick是虚拟时钟,延时不真正等待,只把时钟往前推
+*               定义HOST_TASK_REAL_TIME时tick取主机单调时钟的毫秒数,延时真正等待,给多线程跑的被测代码用
+*               任务通知用pthread条件变量实现,每个线程一个,ulTaskNotifyTake按毫秒等真实时间
+*               xTaskCreate起一个分离的线程,栈大小和优先级不管;vTaskDelete什么都不做,任务随进程退出
+*/
+#ifndef _HOST_STUB_TASK_H_
+#define _HOST_STUB_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+extern uint32_t host_task_delayed;              //vTaskDelay累计的tick数,测试用来检查退避
+extern TickType_t host_tick_count;              //xTaskGetTickCount的返回值,测试可以直接推进
+
+#ifdef HOST_TASK_REAL_TIME
+#include <time.h>
+#include <unistd.h>
+
+static inline TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000) / portTICK_PERIOD_MS;
+}
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+    host_task_delayed += ticks;
+    usleep(ticks * portTICK_PERIOD_MS * 1000);
+}
+#else
+static inline TickType_t xTaskGetTickCount(void)
+{
+    return host_tick_count;
+}
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+    host_task_delayed += ticks;
+    host_tick_count += ticks;
+}
+#endif
+
+static inline void vTaskDelete(void *task)
+{
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio,
+                       TaskHandle_t *handle);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+#endif /* _HOST_STUB_TASK_H_ */
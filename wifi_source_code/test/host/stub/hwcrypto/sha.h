@@ -0,0 +1,18 @@
+/*
+* @file         sha.h
+* @brief        主机测试用的hwcrypto/sha.h桩,用主机的OpenSSL代替SHA硬件加速,实现在sha.c
+*/
+#ifndef _HOST_STUB_HWCRYPTO_SHA_H_
+#define _HOST_STUB_HWCRYPTO_SHA_H_
+
+#include <stddef.h>
+
+typedef enum
+{
+    SHA1 = 0,
+    SHA2_256,
+} esp_sha_type;
+
+void esp_sha(esp_sha_type type, const unsigned char *input, size_t ilen, unsigned char *output);
+
+#endif /* _HOST_STUB_HWCRYPTO_SHA_H_ */
@@ -0,0 +1,103 @@
+/*
+* @file         api.h
+* @brief        主机测试用的lwip/api.h桩,netconn直接包一个主机socket,测试用普通socket作client
+*               netconn_recv收到的数据按host_pbuf_len切成多段,测试帧头和数据跨pbuf的情况
+*               带回调的netconn由一个线程代替tcpip任务,socket可读(新数据、新连接、对端关闭)时
+*               回调一次NETCONN_EVT_RCVPLUS,之后netconn_recv/netconn_accept再次调用时才重新检测
+*/
+#ifndef _HOST_STUB_LWIP_API_H_
+#define _HOST_STUB_LWIP_API_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t  u8_t;
+typedef int8_t   s8_t;
+typedef uint16_t u16_t;
+typedef int16_t  s16_t;
+typedef uint32_t u32_t;
+typedef int8_t   err_t;
+
+#define ERR_OK                      0
+#define ERR_MEM                     -1
+#define ERR_BUF                     -2
+#define ERR_TIMEOUT                 -3
+#define ERR_RTE                     -4
+#define ERR_INPROGRESS              -5
+#define ERR_VAL                     -6
+#define ERR_WOULDBLOCK              -7
+#define ERR_USE                     -8
+#define ERR_ALREADY                 -9
+#define ERR_ISCONN                  -10
+#define ERR_CONN                    -11
+#define ERR_IF                      -12
+#define ERR_ABRT                    -13
+#define ERR_RST                     -14
+#define ERR_CLSD                    -15
+#define ERR_ARG                     -16
+
+#define NETCONN_NOFLAG              0x00
+#define NETCONN_NOCOPY              0x00
+#define NETCONN_COPY                0x01
+#define NETCONN_MORE                0x02
+#define NETCONN_DONTBLOCK           0x04
+
+enum netconn_type
+{
+    NETCONN_TCP = 0x10,
+};
+
+enum netconn_evt
+{
+    NETCONN_EVT_RCVPLUS,
+    NETCONN_EVT_RCVMINUS,
+    NETCONN_EVT_SENDPLUS,
+    NETCONN_EVT_SENDMINUS,
+    NETCONN_EVT_ERROR,
+};
+
+typedef struct
+{
+    u32_t addr;
+} ip_addr_t;
+
+struct netconn;
+typedef void (*netconn_callback)(struct netconn *conn, enum netconn_evt evt, u16_t len);
+
+struct netconn
+{
+    int                 fd;                     //主机socket
+    int                 recv_timeout;           //netconn_set_recvtimeout设置的毫秒数,0一直等
+    netconn_callback    callback;               //事件回调
+    volatile int        armed;                  //回调之后还没有再recv/accept时为0,不重复回调
+    struct netconn      *next;                  //带回调的netconn链表
+};
+
+struct netbuf
+{
+    u8_t                *data;                  //一次recv收到的全部数据
+    u16_t               len;
+    u16_t               pos;                    //当前段的起点
+    u16_t               seg;                    //收到时的host_pbuf_len,测试中途修改不影响已收到的netbuf
+};
+
+extern u16_t host_pbuf_len;                     //netbuf每段的长度,0表示不切分
+
+struct netconn *netconn_new(enum netconn_type type);
+struct netconn *netconn_new_with_callback(enum netconn_type type, netconn_callback callback);
+err_t netconn_bind(struct netconn *conn, const ip_addr_t *addr, u16_t port);
+err_t netconn_listen(struct netconn *conn);
+err_t netconn_accept(struct netconn *conn, struct netconn **new_conn);
+err_t netconn_recv(struct netconn *conn, struct netbuf **new_buf);
+err_t netconn_write_partly(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags, size_t *bytes_written);
+err_t netconn_close(struct netconn *conn);
+err_t netconn_delete(struct netconn *conn);
+
+#define netconn_write(conn, dataptr, size, apiflags)    netconn_write_partly(conn, dataptr, size, apiflags, NULL)
+#define netconn_set_recvtimeout(conn, timeout)          ((conn)->recv_timeout = (timeout))
+
+err_t netbuf_data(struct netbuf *buf, void **dataptr, u16_t *len);
+s8_t netbuf_next(struct netbuf *buf);
+void netbuf_delete(struct netbuf *buf);
+
+#endif /* _HOST_STUB_LWIP_API_H_ */
@@ -0,0 +1,10 @@
+/*
+* @file         netdb.h
+* @brief        主机测试用的lwip/netdb.h桩,getaddrinfo直接用主机的
+*/
+#ifndef _HOST_STUB_LWIP_NETDB_H_
+#define _HOST_STUB_LWIP_NETDB_H_
+
+#include <netdb.h>
+
+#endif /* _HOST_STUB_LWIP_NETDB_H_ */
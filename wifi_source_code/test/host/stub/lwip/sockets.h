@@ -0,0 +1,14 @@
+/*
+* @file         sockets.h
+* @brief        主机测试用的lwip/sockets.h桩,socket接口直接用主机的
+*/
+#ifndef _HOST_STUB_LWIP_SOCKETS_API_H_
+#define _HOST_STUB_LWIP_SOCKETS_API_H_
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#endif /* _HOST_STUB_LWIP_SOCKETS_API_H_ */
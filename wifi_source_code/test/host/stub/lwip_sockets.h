@@ -0,0 +1,15 @@
+/*
+* @file         lwip_sockets.h
+* @brief        lwip的sys/socket.h顺带声明了inet_addr、close和u32_t等,主机上用-include补上这些
+*/
+#ifndef _HOST_STUB_LWIP_SOCKETS_H_
+#define _HOST_STUB_LWIP_SOCKETS_H_
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdint.h>
+
+typedef uint32_t u32_t;
+
+#endif /* _HOST_STUB_LWIP_SOCKETS_H_ */
@@ -0,0 +1,562 @@
+/*
+* @file         mbedtls.c
+* @brief        mbedtls桩的实现:socket用主机的BSD socket,TLS用主机的OpenSSL
+* @details      OpenSSL的记录层收发挂在自定义BIO上,BIO再调mbedtls_ssl_set_bio设置的回调,
+*               被测代码的mbedtls_net_recv_timeout、非阻塞socket的WANT_READ都按mbedtls的方式生效
+*/
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/error.h"
+#include "mbedtls/net.h"
+#include "mbedtls/ssl.h"
+
+void mbedtls_strerror(int errnum, char *buffer, size_t buflen)
+{
+    snprintf(buffer, buflen, "mbedtls error -0x%04x", (unsigned)(errnum < 0 ? -errnum : errnum));
+}
+
+/*
+===========================
+entropy/ctr_drbg
+===========================
+*/
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx)
+{
+    ctx->initialized = 1;
+}
+
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx)
+{
+    ctx->initialized = 0;
+}
+
+int mbedtls_entropy_func(void *data, unsigned char *output, size_t len)
+{
+    return RAND_bytes(output, (int)len) == 1 ? 0 : MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+}
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *ctx)
+{
+    ctx->seeded = 0;
+}
+
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *ctx)
+{
+    ctx->seeded = 0;
+}
+
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *ctx, int (*f_entropy)(void *, unsigned char *, size_t),
+                          void *p_entropy, const unsigned char *custom, size_t len)
+{
+    unsigned char seed[32];
+    if (f_entropy(p_entropy, seed, sizeof(seed)) != 0)
+    {
+        return MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+    ctx->seeded = 1;
+    return 0;
+}
+
+int mbedtls_ctr_drbg_random(void *p_rng, unsigned char *output, size_t output_len)
+{
+    return RAND_bytes(output, (int)output_len) == 1 ? 0 : MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+}
+
+/*
+===========================
+net
+===========================
+*/
+void mbedtls_net_init(mbedtls_net_context *ctx)
+{
+    ctx->fd = -1;
+}
+
+void mbedtls_net_free(mbedtls_net_context *ctx)
+{
+    if (ctx->fd >= 0)
+    {
+        shutdown(ctx->fd, SHUT_RDWR);
+        close(ctx->fd);
+    }
+    ctx->fd = -1;
+}
+
+int mbedtls_net_connect(mbedtls_net_context *ctx, const char *host, const char *port, int proto)
+{
+    struct addrinfo hints, *list, *cur;
+    int ret = MBEDTLS_ERR_NET_UNKNOWN_HOST;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = proto == MBEDTLS_NET_PROTO_UDP ? SOCK_DGRAM : SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &list) != 0)
+    {
+        return MBEDTLS_ERR_NET_UNKNOWN_HOST;
+    }
+    for (cur = list; cur != NULL; cur = cur->ai_next)
+    {
+        ctx->fd = socket(cur->ai_family, cur->ai_socktype, cur->ai_protocol);
+        if (ctx->fd < 0)
+        {
+            ret = MBEDTLS_ERR_NET_SOCKET_FAILED;
+            continue;
+        }
+        if (connect(ctx->fd, cur->ai_addr, cur->ai_addrlen) == 0)
+        {
+            ret = 0;
+            break;
+        }
+        close(ctx->fd);
+        ctx->fd = -1;
+        ret = MBEDTLS_ERR_NET_CONNECT_FAILED;
+    }
+    freeaddrinfo(list);
+    return ret;
+}
+
+int mbedtls_net_set_block(mbedtls_net_context *ctx)
+{
+    int flags = fcntl(ctx->fd, F_GETFL);
+
+    return flags < 0 || fcntl(ctx->fd, F_SETFL, flags & ~O_NONBLOCK) < 0 ? MBEDTLS_ERR_NET_INVALID_CONTEXT : 0;
+}
+
+int mbedtls_net_set_nonblock(mbedtls_net_context *ctx)
+{
+    int flags = fcntl(ctx->fd, F_GETFL);
+
+    return flags < 0 || fcntl(ctx->fd, F_SETFL, flags | O_NONBLOCK) < 0 ? MBEDTLS_ERR_NET_INVALID_CONTEXT : 0;
+}
+
+int mbedtls_net_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    int fd = ((mbedtls_net_context *)ctx)->fd;
+    ssize_t ret;
+
+    if (fd < 0)
+    {
+        return MBEDTLS_ERR_NET_INVALID_CONTEXT;
+    }
+    //lwip没有SIGPIPE,对端关闭时只返回错误
+    ret = send(fd, buf, len, MSG_NOSIGNAL);
+    if (ret >= 0)
+    {
+        return (int)ret;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    if (errno == EPIPE || errno == ECONNRESET)
+    {
+        return MBEDTLS_ERR_NET_CONN_RESET;
+    }
+    return MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+int mbedtls_net_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    int fd = ((mbedtls_net_context *)ctx)->fd;
+    ssize_t ret;
+
+    if (fd < 0)
+    {
+        return MBEDTLS_ERR_NET_INVALID_CONTEXT;
+    }
+    ret = recv(fd, buf, len, 0);
+    if (ret >= 0)
+    {
+        return (int)ret;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (errno == EPIPE || errno == ECONNRESET)
+    {
+        return MBEDTLS_ERR_NET_CONN_RESET;
+    }
+    return MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+int mbedtls_net_recv_timeout(void *ctx, unsigned char *buf, size_t len, uint32_t timeout)
+{
+    struct pollfd pfd = { .fd = ((mbedtls_net_context *)ctx)->fd, .events = POLLIN };
+    int ret;
+
+    if (pfd.fd < 0)
+    {
+        return MBEDTLS_ERR_NET_INVALID_CONTEXT;
+    }
+    ret = poll(&pfd, 1, timeout == 0 ? -1 : (int)timeout);
+    if (ret == 0)
+    {
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    if (ret < 0)
+    {
+        return errno == EINTR ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return mbedtls_net_recv(ctx, buf, len);
+}
+
+/*
+===========================
+ssl
+===========================
+*/
+static BIO_METHOD *host_bio_method;
+static pthread_once_t host_bio_once = PTHREAD_ONCE_INIT;
+
+//记录层要发的数据交给f_send
+static int host_bio_write(BIO *bio, const char *buf, int len)
+{
+    mbedtls_ssl_context *ssl = BIO_get_data(bio);
+    int ret;
+
+    BIO_clear_retry_flags(bio);
+    ret = ssl->f_send(ssl->p_bio, (const unsigned char *)buf, len);
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        BIO_set_retry_write(bio);
+        return -1;
+    }
+    if (ret < 0)
+    {
+        ssl->bio_error = ret;
+        return -1;
+    }
+    return ret;
+}
+
+//记录层要收的数据从f_recv_timeout或f_recv取,和mbedtls一样有f_recv_timeout时优先用
+static int host_bio_read(BIO *bio, char *buf, int len)
+{
+    mbedtls_ssl_context *ssl = BIO_get_data(bio);
+    int ret;
+
+    BIO_clear_retry_flags(bio);
+    if (ssl->f_recv_timeout != NULL)
+    {
+        ret = ssl->f_recv_timeout(ssl->p_bio, (unsigned char *)buf, len, ssl->conf->read_timeout);
+    }
+    else
+    {
+        ret = ssl->f_recv(ssl->p_bio, (unsigned char *)buf, len);
+    }
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ)
+    {
+        BIO_set_retry_read(bio);
+        return -1;
+    }
+    if (ret <= 0)
+    {
+        ssl->bio_error = ret ? ret : MBEDTLS_ERR_SSL_CONN_EOF;
+        return ret ? -1 : 0;
+    }
+    return ret;
+}
+
+static long host_bio_ctrl(BIO *bio, int cmd, long num, void *ptr)
+{
+    return cmd == BIO_CTRL_FLUSH;
+}
+
+static void host_bio_init(void)
+{
+    host_bio_method = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "mbedtls bio");
+    BIO_meth_set_write(host_bio_method, host_bio_write);
+    BIO_meth_set_read(host_bio_method, host_bio_read);
+    BIO_meth_set_ctrl(host_bio_method, host_bio_ctrl);
+}
+
+//按当前配置新建OpenSSL的SSL,收发都经过host_bio_method
+static int host_ssl_new(mbedtls_ssl_context *ssl)
+{
+    SSL *s;
+    BIO *bio;
+
+    pthread_once(&host_bio_once, host_bio_init);
+    s = SSL_new(ssl->conf->host_ctx);
+    bio = BIO_new(host_bio_method);
+    if (s == NULL || bio == NULL)
+    {
+        SSL_free(s);
+        BIO_free(bio);
+        return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    }
+    BIO_set_data(bio, ssl);
+    BIO_set_init(bio, 1);
+    SSL_set_bio(s, bio, bio);
+    SSL_set_connect_state(s);
+    if (ssl->hostname != NULL)
+    {
+        SSL_set_tlsext_host_name(s, ssl->hostname);
+    }
+    ssl->host_ssl = s;
+    ssl->session = NULL;
+    return 0;
+}
+
+//OpenSSL调用失败时换成mbedtls的返回值,收发回调的错误优先
+static int host_ssl_error(mbedtls_ssl_context *ssl, int ret, int fallback)
+{
+    int err = SSL_get_error(ssl->host_ssl, ret);
+
+    ERR_clear_error();
+    if (err == SSL_ERROR_WANT_READ)
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (err == SSL_ERROR_WANT_WRITE)
+    {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    if (err == SSL_ERROR_ZERO_RETURN)
+    {
+        return MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY;
+    }
+    return ssl->bio_error ? ssl->bio_error : fallback;
+}
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl)
+{
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl)
+{
+    SSL_free(ssl->host_ssl);
+    free(ssl->hostname);
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf)
+{
+    if (conf->host_ctx == NULL)
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+    ssl->conf = conf;
+    return host_ssl_new(ssl);
+}
+
+int mbedtls_ssl_session_reset(mbedtls_ssl_context *ssl)
+{
+    SSL_free(ssl->host_ssl);
+    ssl->host_ssl = NULL;
+    return host_ssl_new(ssl);
+}
+
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname)
+{
+    free(ssl->hostname);
+    ssl->hostname = hostname ? strdup(hostname) : NULL;
+    if (ssl->host_ssl != NULL && hostname != NULL)
+    {
+        SSL_set_tlsext_host_name(ssl->host_ssl, hostname);
+    }
+    return 0;
+}
+
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *ssl, void *p_bio, mbedtls_ssl_send_t *f_send,
+                         mbedtls_ssl_recv_t *f_recv, mbedtls_ssl_recv_timeout_t *f_recv_timeout)
+{
+    ssl->p_bio = p_bio;
+    ssl->f_send = f_send;
+    ssl->f_recv = f_recv;
+    ssl->f_recv_timeout = f_recv_timeout;
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session)
+{
+    if (session->host_session == NULL || SSL_set_session(ssl->host_ssl, session->host_session) != 1)
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+    return 0;
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *dst)
+{
+    SSL_SESSION *sess;
+
+    if (ssl->session == NULL || (sess = SSL_get1_session(ssl->host_ssl)) == NULL)
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+    memcpy(dst->master, ssl->session->master, sizeof(dst->master));
+    dst->host_session = sess;
+    return 0;
+}
+
+int mbedtls_ssl_handshake(mbedtls_ssl_context *ssl)
+{
+    int ret;
+
+    ssl->bio_error = 0;
+    ret = SSL_do_handshake(ssl->host_ssl);
+    if (ret != 1)
+    {
+        return host_ssl_error(ssl, ret, MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE);
+    }
+    memset(&ssl->session_now, 0, sizeof(ssl->session_now));
+    SSL_SESSION_get_master_key(SSL_get_session(ssl->host_ssl), ssl->session_now.master, sizeof(ssl->session_now.master));
+    ssl->session = &ssl->session_now;
+    return 0;
+}
+
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len)
+{
+    int ret;
+
+    ssl->bio_error = 0;
+    ret = SSL_read(ssl->host_ssl, buf, len > INT_MAX ? INT_MAX : (int)len);
+    return ret > 0 ? ret : host_ssl_error(ssl, ret, MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE);
+}
+
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *ssl)
+{
+    return ssl->host_ssl != NULL ? (size_t)SSL_pending(ssl->host_ssl) : 0;
+}
+
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len)
+{
+    int ret;
+
+    ssl->bio_error = 0;
+    ret = SSL_write(ssl->host_ssl, buf, len > INT_MAX ? INT_MAX : (int)len);
+    return ret > 0 ? ret : host_ssl_error(ssl, ret, MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE);
+}
+
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *ssl)
+{
+    int ret;
+
+    if (ssl->session == NULL)
+    {
+        return 0;
+    }
+    ssl->bio_error = 0;
+    ret = SSL_shutdown(ssl->host_ssl);
+    return ret >= 0 ? 0 : host_ssl_error(ssl, ret, 0);
+}
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf)
+{
+    memset(conf, 0, sizeof(*conf));
+}
+
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf)
+{
+    SSL_CTX_free(conf->host_ctx);
+    memset(conf, 0, sizeof(*conf));
+}
+
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *conf, int endpoint, int transport, int preset)
+{
+    if (endpoint != MBEDTLS_SSL_IS_CLIENT || transport != MBEDTLS_SSL_TRANSPORT_STREAM)
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+    conf->host_ctx = SSL_CTX_new(TLS_client_method());
+    if (conf->host_ctx == NULL)
+    {
+        return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    }
+    SSL_CTX_set_max_proto_version(conf->host_ctx, TLS1_2_VERSION);
+    //和mbedtls_ssl_write一样可以只写出一部分,WANT_WRITE后重试时可以换缓存地址
+    SSL_CTX_set_mode(conf->host_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    SSL_CTX_set_verify(conf->host_ctx, SSL_VERIFY_NONE, NULL);
+    conf->endpoint = endpoint;
+    conf->authmode = MBEDTLS_SSL_VERIFY_REQUIRED;
+    conf->session_tickets = MBEDTLS_SSL_SESSION_TICKETS_ENABLED;
+    return 0;
+}
+
+//桩里没有CA证书链,只支持不验证证书
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode)
+{
+    conf->authmode = authmode;
+}
+
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *conf, int (*f_rng)(void *, unsigned char *, size_t), void *p_rng)
+{
+    conf->f_rng = f_rng;
+    conf->p_rng = p_rng;
+}
+
+void mbedtls_ssl_conf_dbg(mbedtls_ssl_config *conf, void (*f_dbg)(void *, int, const char *, int, const char *),
+                          void *p_dbg)
+{
+}
+
+void mbedtls_ssl_conf_read_timeout(mbedtls_ssl_config *conf, uint32_t timeout)
+{
+    conf->read_timeout = timeout;
+}
+
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *conf, int use_tickets)
+{
+    conf->session_tickets = use_tickets;
+    if (use_tickets == MBEDTLS_SSL_SESSION_TICKETS_ENABLED)
+    {
+        SSL_CTX_clear_options(conf->host_ctx, SSL_OP_NO_TICKET);
+    }
+    else
+    {
+        SSL_CTX_set_options(conf->host_ctx, SSL_OP_NO_TICKET);
+    }
+}
+
+//按IANA编号找到OpenSSL的套件名,OpenSSL没有的套件跳过,和mbedtls跳过没编译进来的套件一样
+void mbedtls_ssl_conf_ciphersuites(mbedtls_ssl_config *conf, const int *ciphersuites)
+{
+    SSL *ssl = SSL_new(conf->host_ctx);
+    const SSL_CIPHER *cipher;
+    unsigned char id[2];
+    char list[1024] = "";
+
+    for (; *ciphersuites != 0; ciphersuites++)
+    {
+        id[0] = *ciphersuites >> 8;
+        id[1] = *ciphersuites & 0xff;
+        if ((cipher = SSL_CIPHER_find(ssl, id)) != NULL &&
+            strlen(list) + strlen(SSL_CIPHER_get_name(cipher)) + 2 < sizeof(list))
+        {
+            strcat(list, list[0] != 0 ? ":" : "");
+            strcat(list, SSL_CIPHER_get_name(cipher));
+        }
+    }
+    SSL_free(ssl);
+    SSL_CTX_set_cipher_list(conf->host_ctx, list);
+}
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session)
+{
+    memset(session, 0, sizeof(*session));
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session)
+{
+    SSL_SESSION_free(session->host_session);
+    memset(session, 0, sizeof(*session));
+}
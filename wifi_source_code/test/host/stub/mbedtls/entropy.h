@@ -0,0 +1,21 @@
+/*
+* @file         entropy.h
+* @brief        主机测试用的mbedtls/entropy.h桩,熵取自主机OpenSSL的随机数
+*/
+#ifndef _HOST_STUB_MBEDTLS_ENTROPY_H_
+#define _HOST_STUB_MBEDTLS_ENTROPY_H_
+
+#include <stddef.h>
+
+#define MBEDTLS_ERR_ENTROPY_SOURCE_FAILED       -0x003C
+
+typedef struct
+{
+    int                 initialized;
+} mbedtls_entropy_context;
+
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx);
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx);
+int mbedtls_entropy_func(void *data, unsigned char *output, size_t len);
+
+#endif /* _HOST_STUB_MBEDTLS_ENTROPY_H_ */
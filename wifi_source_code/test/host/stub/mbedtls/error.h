@@ -0,0 +1,12 @@
+/*
+* @file         error.h
+* @brief        主机测试用的mbedtls/error.h桩
+*/
+#ifndef _HOST_STUB_MBEDTLS_ERROR_H_
+#define _HOST_STUB_MBEDTLS_ERROR_H_
+
+#include <stddef.h>
+
+void mbedtls_strerror(int errnum, char *buffer, size_t buflen);
+
+#endif /* _HOST_STUB_MBEDTLS_ERROR_H_ */
@@ -0,0 +1,12 @@
+/*
+* @file         md5.h
+* @brief        主机测试用的mbedtls/md5.h桩,只有被测代码用到的一次性计算接口
+*/
+#ifndef _HOST_STUB_MBEDTLS_MD5_H_
+#define _HOST_STUB_MBEDTLS_MD5_H_
+
+#include <stddef.h>
+
+int mbedtls_md5_ret(const unsigned char *input, size_t ilen, unsigned char output[16]);
+
+#endif /* _HOST_STUB_MBEDTLS_MD5_H_ */
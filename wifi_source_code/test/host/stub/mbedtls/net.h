@@ -0,0 +1,36 @@
+/*
+* @file         net.h
+* @brief        主机测试用的mbedtls/net.h桩,用主机的BSD socket实现,错误码和mbedtls 2.x一致
+*/
+#ifndef _HOST_STUB_MBEDTLS_NET_H_
+#define _HOST_STUB_MBEDTLS_NET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_NET_SOCKET_FAILED           -0x0042
+#define MBEDTLS_ERR_NET_CONNECT_FAILED          -0x0044
+#define MBEDTLS_ERR_NET_INVALID_CONTEXT         -0x0045
+#define MBEDTLS_ERR_NET_RECV_FAILED             -0x004C
+#define MBEDTLS_ERR_NET_SEND_FAILED             -0x004E
+#define MBEDTLS_ERR_NET_CONN_RESET              -0x0050
+#define MBEDTLS_ERR_NET_UNKNOWN_HOST            -0x0052
+
+#define MBEDTLS_NET_PROTO_TCP                   0
+#define MBEDTLS_NET_PROTO_UDP                   1
+
+typedef struct
+{
+    int                 fd;
+} mbedtls_net_context;
+
+void mbedtls_net_init(mbedtls_net_context *ctx);
+void mbedtls_net_free(mbedtls_net_context *ctx);
+int mbedtls_net_connect(mbedtls_net_context *ctx, const char *host, const char *port, int proto);
+int mbedtls_net_set_block(mbedtls_net_context *ctx);
+int mbedtls_net_set_nonblock(mbedtls_net_context *ctx);
+int mbedtls_net_send(void *ctx, const unsigned char *buf, size_t len);
+int mbedtls_net_recv(void *ctx, unsigned char *buf, size_t len);
+int mbedtls_net_recv_timeout(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
+
+#endif /* _HOST_STUB_MBEDTLS_NET_H_ */
@@ -0,0 +1,15 @@
+/*
+* @file         platform.h
+* @brief        主机测试用的mbedtls/platform.h桩,内存直接用libc
+*/
+#ifndef _HOST_STUB_MBEDTLS_PLATFORM_H_
+#define _HOST_STUB_MBEDTLS_PLATFORM_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define mbedtls_calloc      calloc
+#define mbedtls_free        free
+#define mbedtls_printf      printf
+
+#endif /* _HOST_STUB_MBEDTLS_PLATFORM_H_ */
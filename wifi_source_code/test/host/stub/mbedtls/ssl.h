@@ -0,0 +1,102 @@
+/*
+* @file         ssl.h
+* @brief        主机测试用的mbedtls/ssl.h桩,只有客户端,TLS由主机的OpenSSL完成
+* @details      记录层的收发经过mbedtls_ssl_set_bio设置的回调,WANT_READ/WANT_WRITE、超时、连接断开的
+*               返回值和mbedtls 2.x一致;最高TLS1.2,和ESP-IDF的mbedtls一样,恢复的会话沿用原来的主密钥;
+*               没有MBEDTLS_ECP_C和MBEDTLS_SSL_MAX_FRAGMENT_LENGTH,配置档里曲线和分片长度的设置编译时跳过
+*/
+#ifndef _HOST_STUB_MBEDTLS_SSL_H_
+#define _HOST_STUB_MBEDTLS_SSL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/net.h"
+#include "mbedtls/ssl_ciphersuites.h"
+
+#define MBEDTLS_SSL_SESSION_TICKETS                 //ESP-IDF默认的mbedtls配置打开了session ticket
+
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA              -0x7100
+#define MBEDTLS_ERR_SSL_CONN_EOF                    -0x7280
+#define MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE         -0x7780
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY           -0x7880
+#define MBEDTLS_ERR_SSL_ALLOC_FAILED                -0x7F00
+#define MBEDTLS_ERR_SSL_TIMEOUT                     -0x6800
+#define MBEDTLS_ERR_SSL_WANT_WRITE                  -0x6880
+#define MBEDTLS_ERR_SSL_WANT_READ                   -0x6900
+
+#define MBEDTLS_SSL_IS_CLIENT                       0
+#define MBEDTLS_SSL_IS_SERVER                       1
+#define MBEDTLS_SSL_TRANSPORT_STREAM                0
+#define MBEDTLS_SSL_PRESET_DEFAULT                  0
+#define MBEDTLS_SSL_VERIFY_NONE                     0
+#define MBEDTLS_SSL_VERIFY_OPTIONAL                 1
+#define MBEDTLS_SSL_VERIFY_REQUIRED                 2
+#define MBEDTLS_SSL_SESSION_TICKETS_DISABLED        0
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED         1
+#define MBEDTLS_SSL_MAX_FRAG_LEN_4096               4   //桩没有MBEDTLS_SSL_MAX_FRAGMENT_LENGTH,只给配置档的宏用
+
+typedef int mbedtls_ssl_send_t(void *ctx, const unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_t(void *ctx, unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_timeout_t(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
+
+typedef struct
+{
+    unsigned char       master[48];
+    void               *host_session;           //OpenSSL的SSL_SESSION,mbedtls_ssl_get_session取出的会话才有
+} mbedtls_ssl_session;
+
+typedef struct
+{
+    int                 endpoint;
+    int                 authmode;
+    uint32_t            read_timeout;           //毫秒,0为一直等
+    int                 session_tickets;
+    int               (*f_rng)(void *, unsigned char *, size_t);
+    void               *p_rng;
+    void               *host_ctx;               //OpenSSL的SSL_CTX
+} mbedtls_ssl_config;
+
+typedef struct
+{
+    const mbedtls_ssl_config   *conf;
+    mbedtls_ssl_session        *session;        //当前连接的会话,握手完成前为NULL
+    mbedtls_ssl_session         session_now;
+    void                       *p_bio;
+    mbedtls_ssl_send_t         *f_send;
+    mbedtls_ssl_recv_t         *f_recv;
+    mbedtls_ssl_recv_timeout_t *f_recv_timeout;
+    char                       *hostname;
+    int                         bio_error;      //收发回调最近返回的mbedtls错误码
+    void                       *host_ssl;       //OpenSSL的SSL
+} mbedtls_ssl_context;
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl);
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl);
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf);
+int mbedtls_ssl_session_reset(mbedtls_ssl_context *ssl);
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname);
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *ssl, void *p_bio, mbedtls_ssl_send_t *f_send,
+                         mbedtls_ssl_recv_t *f_recv, mbedtls_ssl_recv_timeout_t *f_recv_timeout);
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session);
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *dst);
+int mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len);
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *ssl);
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf);
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf);
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *conf, int endpoint, int transport, int preset);
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode);
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *conf, int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+void mbedtls_ssl_conf_dbg(mbedtls_ssl_config *conf, void (*f_dbg)(void *, int, const char *, int, const char *),
+                          void *p_dbg);
+void mbedtls_ssl_conf_read_timeout(mbedtls_ssl_config *conf, uint32_t timeout);
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *conf, int use_tickets);
+void mbedtls_ssl_conf_ciphersuites(mbedtls_ssl_config *conf, const int *ciphersuites);
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session);
+
+#endif /* _HOST_STUB_MBEDTLS_SSL_H_ */
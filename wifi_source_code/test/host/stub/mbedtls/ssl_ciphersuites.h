@@ -0,0 +1,19 @@
+/*
+* @file         ssl_ciphersuites.h
+* @brief        主机测试用的mbedtls/ssl_ciphersuites.h桩,只有被测代码用到的套件,值为IANA编号,和mbedtls一致
+*/
+#ifndef _HOST_STUB_MBEDTLS_SSL_CIPHERSUITES_H_
+#define _HOST_STUB_MBEDTLS_SSL_CIPHERSUITES_H_
+
+#define MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA                0x2F
+#define MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA256             0x3C
+#define MBEDTLS_TLS_RSA_WITH_AES_128_GCM_SHA256             0x9C
+#define MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256     0xC023
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA          0xC013
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256       0xC027
+#define MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256     0xC02B
+#define MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384     0xC02C
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256       0xC02F
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384       0xC030
+
+#endif /* _HOST_STUB_MBEDTLS_SSL_CIPHERSUITES_H_ */
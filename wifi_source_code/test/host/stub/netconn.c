@@ -0,0 +1,301 @@
+/*
+* @file         netconn.c
+* @brief        lwip/api.h桩的实现,netconn直接包一个主机socket
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "lwip/api.h"
+
+#define HOST_RECV_MAX               4096        //一次netconn_recv最多收的字节数,和lwip的TCP_WND同量级
+#define HOST_CB_POLL_MAX            64          //回调线程一次检测的netconn数
+#define HOST_CB_POLL_MS             1           //回调线程检测间隔,netconn_delete最多等这么久
+
+u16_t host_pbuf_len;
+
+//带回调的netconn,回调线程持有host_cb_lock时检测和回调,netconn_delete持锁摘掉后才关闭socket
+static pthread_mutex_t host_cb_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct netconn *host_cb_list;
+static int host_cb_started;
+
+static err_t host_errno_err(void)
+{
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+        return ERR_WOULDBLOCK;
+    }
+    return errno == ECONNRESET || errno == EPIPE ? ERR_RST : ERR_CONN;
+}
+
+//代替tcpip任务：socket可读时回调RCVPLUS
+static void *host_cb_thread(void *arg)
+{
+    struct pollfd pfd[HOST_CB_POLL_MAX];
+    struct netconn *conns[HOST_CB_POLL_MAX];
+    struct netconn *c;
+    int n;
+
+    while (1)
+    {
+        pthread_mutex_lock(&host_cb_lock);
+        n = 0;
+        for (c = host_cb_list; c != NULL && n < HOST_CB_POLL_MAX; c = c->next)
+        {
+            if (c->armed)
+            {
+                pfd[n].fd = c->fd;
+                pfd[n].events = POLLIN;
+                conns[n++] = c;
+            }
+        }
+        poll(pfd, n, HOST_CB_POLL_MS);
+        for (int i = 0; i < n; i++)
+        {
+            //还没listen的socket也会报POLLHUP，只看可读
+            if (pfd[i].revents & POLLIN)
+            {
+                conns[i]->armed = 0;
+                conns[i]->callback(conns[i], NETCONN_EVT_RCVPLUS, 0);
+            }
+        }
+        pthread_mutex_unlock(&host_cb_lock);
+        //让netconn_delete有机会拿到锁
+        sched_yield();
+    }
+    return NULL;
+}
+
+//加入回调链表，第一次用时启动回调线程
+static void host_cb_add(struct netconn *conn)
+{
+    pthread_t tid;
+
+    conn->armed = 1;
+    pthread_mutex_lock(&host_cb_lock);
+    conn->next = host_cb_list;
+    host_cb_list = conn;
+    if (!host_cb_started)
+    {
+        host_cb_started = 1;
+        pthread_create(&tid, NULL, host_cb_thread, NULL);
+        pthread_detach(tid);
+    }
+    pthread_mutex_unlock(&host_cb_lock);
+}
+
+static void host_cb_remove(struct netconn *conn)
+{
+    struct netconn **pp;
+
+    pthread_mutex_lock(&host_cb_lock);
+    for (pp = &host_cb_list; *pp != NULL; pp = &(*pp)->next)
+    {
+        if (*pp == conn)
+        {
+            *pp = conn->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&host_cb_lock);
+}
+
+struct netconn *netconn_new_with_callback(enum netconn_type type, netconn_callback callback)
+{
+    struct netconn *conn = calloc(1, sizeof(*conn));
+    int one = 1;
+
+    conn->fd = socket(AF_INET, SOCK_STREAM, 0);
+    conn->callback = callback;
+    setsockopt(conn->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (callback)
+    {
+        host_cb_add(conn);
+    }
+    return conn;
+}
+
+struct netconn *netconn_new(enum netconn_type type)
+{
+    return netconn_new_with_callback(type, NULL);
+}
+
+//只监听本机回环地址
+err_t netconn_bind(struct netconn *conn, const ip_addr_t *addr, u16_t port)
+{
+    struct sockaddr_in sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return bind(conn->fd, (struct sockaddr *)&sa, sizeof(sa)) == 0 ? ERR_OK : ERR_USE;
+}
+
+err_t netconn_listen(struct netconn *conn)
+{
+    return listen(conn->fd, 16) == 0 ? ERR_OK : ERR_USE;
+}
+
+//等到可读或超时,recv_timeout为0时一直等
+static err_t host_wait_readable(struct netconn *conn)
+{
+    struct pollfd pfd = { .fd = conn->fd, .events = POLLIN };
+    int ret = poll(&pfd, 1, conn->recv_timeout ? conn->recv_timeout : -1);
+
+    if (ret == 0)
+    {
+        return ERR_TIMEOUT;
+    }
+    return ret < 0 ? ERR_ABRT : ERR_OK;
+}
+
+err_t netconn_accept(struct netconn *conn, struct netconn **new_conn)
+{
+    struct netconn *c;
+    err_t err;
+    int fd;
+
+    //先重新检测再accept，之后到达的连接会再回调
+    conn->armed = 1;
+    err = host_wait_readable(conn);
+    if (err != ERR_OK)
+    {
+        return err;
+    }
+    fd = accept(conn->fd, NULL, NULL);
+    if (fd < 0)
+    {
+        return ERR_ABRT;
+    }
+    c = calloc(1, sizeof(*c));
+    c->fd = fd;
+    c->callback = conn->callback;
+    if (c->callback)
+    {
+        host_cb_add(c);
+    }
+    *new_conn = c;
+    return ERR_OK;
+}
+
+err_t netconn_recv(struct netconn *conn, struct netbuf **new_buf)
+{
+    struct netbuf *buf;
+    err_t err;
+    ssize_t ret;
+
+    conn->armed = 1;
+    err = host_wait_readable(conn);
+    *new_buf = NULL;
+    if (err != ERR_OK)
+    {
+        return err;
+    }
+    buf = calloc(1, sizeof(*buf));
+    buf->data = malloc(HOST_RECV_MAX);
+    ret = recv(conn->fd, buf->data, HOST_RECV_MAX, 0);
+    if (ret <= 0)
+    {
+        netbuf_delete(buf);
+        return ret == 0 ? ERR_CLSD : host_errno_err();
+    }
+    buf->len = ret;
+    buf->seg = host_pbuf_len;
+    *new_buf = buf;
+    return ERR_OK;
+}
+
+//NETCONN_DONTBLOCK时能写多少写多少,一个字节都写不进去返回ERR_WOULDBLOCK
+err_t netconn_write_partly(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags, size_t *bytes_written)
+{
+    int flags = MSG_NOSIGNAL | ((apiflags & NETCONN_MORE) ? MSG_MORE : 0);
+    size_t done = 0;
+    ssize_t ret;
+
+    if ((apiflags & NETCONN_DONTBLOCK) && bytes_written == NULL)
+    {
+        return ERR_VAL;
+    }
+    if (apiflags & NETCONN_DONTBLOCK)
+    {
+        flags |= MSG_DONTWAIT;
+    }
+    while (done < size)
+    {
+        ret = send(conn->fd, (const uint8_t *)dataptr + done, size - done, flags);
+        if (ret < 0)
+        {
+            if (done > 0 && (apiflags & NETCONN_DONTBLOCK) && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            return host_errno_err();
+        }
+        done += ret;
+        if (apiflags & NETCONN_DONTBLOCK)
+        {
+            break;
+        }
+    }
+    if (bytes_written)
+    {
+        *bytes_written = done;
+    }
+    return ERR_OK;
+}
+
+err_t netconn_close(struct netconn *conn)
+{
+    shutdown(conn->fd, SHUT_RDWR);
+    return ERR_OK;
+}
+
+err_t netconn_delete(struct netconn *conn)
+{
+    if (conn)
+    {
+        if (conn->callback)
+        {
+            host_cb_remove(conn);
+        }
+        close(conn->fd);
+        free(conn);
+    }
+    return ERR_OK;
+}
+
+//当前段,按收到时的host_pbuf_len切分
+err_t netbuf_data(struct netbuf *buf, void **dataptr, u16_t *len)
+{
+    u16_t left = buf->len - buf->pos;
+
+    *dataptr = buf->data + buf->pos;
+    *len = buf->seg && left > buf->seg ? buf->seg : left;
+    return ERR_OK;
+}
+
+//移到下一段,返回-1没有下一段,1移到了最后一段,0后面还有
+s8_t netbuf_next(struct netbuf *buf)
+{
+    if (buf->seg == 0 || buf->len - buf->pos <= buf->seg)
+    {
+        return -1;
+    }
+    buf->pos += buf->seg;
+    return buf->len - buf->pos <= buf->seg ? 1 : 0;
+}
+
+void netbuf_delete(struct netbuf *buf)
+{
+    if (buf)
+    {
+        free(buf->data);
+        free(buf);
+    }
+}
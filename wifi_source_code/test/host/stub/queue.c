@@ -0,0 +1,133 @@
+/*
+* @file         queue.c
+* @brief        queue.h桩的实现
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/queue.h"
+
+struct host_queue
+{
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    uint32_t            length;
+    uint32_t            item_size;
+    uint32_t            head;
+    uint32_t            count;
+    uint8_t             items[];
+};
+
+QueueHandle_t xQueueCreate(uint32_t length, uint32_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q) + length * item_size);
+
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+//等到cond成立或超时,ticks为portMAX_DELAY时一直等
+static int host_queue_wait(QueueHandle_t q, int (*cond)(QueueHandle_t), TickType_t ticks)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks * portTICK_PERIOD_MS / 1000;
+    ts.tv_nsec += (long)(ticks * portTICK_PERIOD_MS % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    while (!cond(q))
+    {
+        if (ticks == 0)
+        {
+            return 0;
+        }
+        if (ticks == portMAX_DELAY)
+        {
+            pthread_cond_wait(&q->cond, &q->lock);
+        }
+        else if (pthread_cond_timedwait(&q->cond, &q->lock, &ts) == ETIMEDOUT)
+        {
+            return cond(q);
+        }
+    }
+    return 1;
+}
+
+static int host_queue_not_full(QueueHandle_t q)
+{
+    return q->count < q->length;
+}
+
+static int host_queue_not_empty(QueueHandle_t q)
+{
+    return q->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&queue->lock);
+    if (host_queue_wait(queue, host_queue_not_full, ticks))
+    {
+        memcpy(queue->items + (queue->head + queue->count) % queue->length * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&queue->lock);
+    if (host_queue_wait(queue, host_queue_not_empty, ticks))
+    {
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ret;
+}
+
+uint32_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    uint32_t n;
+
+    pthread_mutex_lock(&queue->lock);
+    n = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return n;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->cond);
+    free(queue);
+}
@@ -0,0 +1,18 @@
+/*
+* @file         sha.c
+* @brief        hwcrypto/sha.h桩的实现,OpenSSL的SHA1函数和esp_sha_type的SHA1同名,所以不包含桩的头文件
+*/
+#include <stddef.h>
+#include <openssl/sha.h>
+
+void esp_sha(int type, const unsigned char *input, size_t ilen, unsigned char *output)
+{
+    if (type == 0)
+    {
+        SHA1(input, ilen, output);
+    }
+    else
+    {
+        SHA256(input, ilen, output);
+    }
+}
@@ -0,0 +1,111 @@
+/*
+* @file         task.c
+* @brief        task.h桩的全局变量、任务创建和任务通知
+*/
+#include <errno.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/task.h"
+
+struct host_task
+{
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    uint32_t            notify;                 //通知计数
+};
+
+uint32_t host_task_delayed;
+TickType_t host_tick_count;
+
+static __thread struct host_task host_current_task = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+static __thread struct host_task *host_created_task;    //xTaskCreate建的线程用堆上的句柄,创建者返回前就能通知
+
+struct host_task_start
+{
+    TaskFunction_t      fn;
+    void               *arg;
+    struct host_task   *task;
+};
+
+static void *host_task_thread(void *arg)
+{
+    struct host_task_start start = *(struct host_task_start *)arg;
+
+    free(arg);
+    host_created_task = start.task;
+    start.fn(start.arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio,
+                       TaskHandle_t *handle)
+{
+    struct host_task_start *start = malloc(sizeof(*start));
+    struct host_task *task = calloc(1, sizeof(*task));
+    pthread_t tid;
+
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    start->fn = fn;
+    start->arg = arg;
+    start->task = task;
+    if (handle != NULL)
+    {
+        *handle = task;
+    }
+    if (pthread_create(&tid, NULL, host_task_thread, start) != 0)
+    {
+        free(start);
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(tid);
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return host_created_task != NULL ? host_created_task : &host_current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    struct timespec ts;
+    uint32_t n;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks * portTICK_PERIOD_MS / 1000;
+    ts.tv_nsec += (long)(ticks * portTICK_PERIOD_MS % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            pthread_cond_wait(&task->cond, &task->lock);
+        }
+        else if (pthread_cond_timedwait(&task->cond, &task->lock, &ts) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    n = task->notify;
+    task->notify = clear ? 0 : (n ? n - 1 : 0);
+    pthread_mutex_unlock(&task->lock);
+    return n;
+}
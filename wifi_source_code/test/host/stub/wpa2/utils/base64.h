@@ -0,0 +1,12 @@
+/*
+* @file         base64.h
+* @brief        主机测试用的wpa2/utils/base64.h桩,和wpa_supplicant一样每72个字符换行,结尾带换行,结果由调用者free
+*/
+#ifndef _HOST_STUB_BASE64_H_
+#define _HOST_STUB_BASE64_H_
+
+#include <stddef.h>
+
+unsigned char *_base64_encode(const unsigned char *src, size_t len, size_t *out_len);
+
+#endif /* _HOST_STUB_BASE64_H_ */
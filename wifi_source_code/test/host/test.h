@@ -0,0 +1,69 @@
+/*
+* @file         test.h
+* @brief        主机单元测试用的断言
+* @details      断言失败只记录并打印，不中断，main最后用TEST_END返回失败个数
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+#include <string.h>
+
+static int test_fails;
+static int test_checks;
+
+//条件不成立时记一次失败
+#define TEST_CHECK(cond)                                                        \
+    do                                                                          \
+    {                                                                           \
+        test_checks++;                                                          \
+        if (!(cond))                                                            \
+        {                                                                       \
+            test_fails++;                                                       \
+            printf("%s:%d: TEST_CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        }                                                                       \
+    } while (0)
+
+//比较两个整数，失败时打印两边的值
+#define TEST_EQ_INT(a, b)                                                       \
+    do                                                                          \
+    {                                                                           \
+        long long test_a_ = (long long)(a), test_b_ = (long long)(b);           \
+        test_checks++;                                                          \
+        if (test_a_ != test_b_)                                                 \
+        {                                                                       \
+            test_fails++;                                                       \
+            printf("%s:%d: %s == %s failed: %lld != %lld\n", __FILE__, __LINE__, \
+                   #a, #b, test_a_, test_b_);                                   \
+        }                                                                       \
+    } while (0)
+
+//比较一段内存和字符串常量，失败时打印实际内容
+#define TEST_EQ_MEM(p, len, lit)                                                \
+    do                                                                          \
+    {                                                                           \
+        size_t test_len_ = (size_t)(len);                                       \
+        test_checks++;                                                          \
+        if (test_len_ != sizeof(lit) - 1 || memcmp((p), (lit), test_len_) != 0) \
+        {                                                                       \
+            test_fails++;                                                       \
+            printf("%s:%d: %s == \"%s\" failed: \"%.*s\"\n", __FILE__, __LINE__, \
+                   #p, lit, (int)test_len_, (const char *)(p));                 \
+        }                                                                       \
+    } while (0)
+
+//main的结尾，打印结果并返回
+#define TEST_END()                                                              \
+    do                                                                          \
+    {                                                                           \
+        printf("%s: %d checks, %d failed\n", __FILE__, test_checks, test_fails); \
+        return test_fails ? 1 : 0;                                              \
+    } while (0)
+
+#endif /*#ifndef __HOST_TEST_H__*/
@@ -0,0 +1,329 @@
+/*
+* @file         test_cloud_conn.c
+* @brief        hx-tmall云平台长连接引擎的测试
+* @details      连接任务用pthread跑,经mbedtls桩连本地TLS服务器,服务器按行回显,收到"bye"时关闭连接:
+*               上线回调里发送、定时器、两个外部线程并发发送的帧完整且各自有序;
+*               服务器关闭后重连;端口没有监听时连接失败并退避;
+*               TCP连上但服务器一直不握手时握手超时
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include "user_cloud_conn.h"
+#include "tls_server.h"
+#include "test.h"
+
+#define THREADS         2
+#define FRAMES          1000                            //每个外部线程发送的帧数
+#define FRAME_FMT       "T%d:%06d\n"
+#define TIMER_MS        50
+
+//一个连接的测试上下文,放在conn->arg
+typedef struct
+{
+    char                line[64];                       //还没收完的一行
+    size_t              line_len;
+    int                 next_seq[THREADS];              //每个外部线程下一个应该收到的序号
+    int                 frames;                         //收到的外部线程的帧数
+    int                 disorder;                       //乱序或者内容不对的帧数
+    int                 pongs;                          //收到的上线问候的回显
+    int                 ticks;                          //定时器执行的次数
+    int                 closed;                         //on_closed调用的次数
+    int                 reason;                         //最后一次on_closed的原因
+} ctx_t;
+
+static cloud_conn_t conn_echo;
+static cloud_conn_t conn_refused;
+static cloud_conn_t conn_silent;
+static tls_server_t server;
+static ctx_t ctx_echo;
+static ctx_t ctx_refused;
+static ctx_t ctx_silent;
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//等到*p >= n,超时返回-1
+static int wait_int(const int *p, int n, int ms)
+{
+    long long end = now_ms() + ms;
+    while (__atomic_load_n(p, __ATOMIC_SEQ_CST) < n)
+    {
+        if (now_ms() > end)
+        {
+            return -1;
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+static int wait_u32(const uint32_t *p, uint32_t n, int ms)
+{
+    long long end = now_ms() + ms;
+    while (__atomic_load_n(p, __ATOMIC_SEQ_CST) < n)
+    {
+        if (now_ms() > end)
+        {
+            return -1;
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+//按行回显,收到"bye"时返回,由服务器发close_notify关闭连接
+static void echo_handler(tls_server_t *s, SSL *ssl)
+{
+    char buf[4096];
+    size_t fill = 0;
+    char *nl;
+    int ret;
+
+    while ((ret = SSL_read(ssl, buf + fill, sizeof(buf) - fill)) > 0)
+    {
+        fill += ret;
+        while ((nl = memchr(buf, '\n', fill)) != NULL)
+        {
+            size_t n = nl + 1 - buf;
+            if (n == 4 && memcmp(buf, "bye\n", 4) == 0)
+            {
+                return;
+            }
+            if (tls_server_write_all(ssl, buf, n) != 0)
+            {
+                return;
+            }
+            memmove(buf, buf + n, fill - n);
+            fill -= n;
+        }
+    }
+}
+
+//回显的一行,在连接任务中执行
+static void on_line(ctx_t *c, const char *line)
+{
+    int id, seq;
+
+    if (strcmp(line, "hello") == 0)
+    {
+        __atomic_add_fetch(&c->pongs, 1, __ATOMIC_SEQ_CST);
+        return;
+    }
+    if (sscanf(line, "T%d:%d", &id, &seq) != 2 || id < 0 || id >= THREADS || seq != c->next_seq[id])
+    {
+        __atomic_add_fetch(&c->disorder, 1, __ATOMIC_SEQ_CST);
+        return;
+    }
+    c->next_seq[id]++;
+    __atomic_add_fetch(&c->frames, 1, __ATOMIC_SEQ_CST);
+}
+
+static void on_data(cloud_conn_t *conn, char *data, size_t len)
+{
+    ctx_t *c = (ctx_t *)conn->arg;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] == '\n')
+        {
+            c->line[c->line_len] = 0;
+            on_line(c, c->line);
+            c->line_len = 0;
+        }
+        else if (c->line_len < sizeof(c->line) - 1)
+        {
+            c->line[c->line_len++] = data[i];
+        }
+    }
+}
+
+static void on_timer(cloud_conn_t *conn, void *arg)
+{
+    __atomic_add_fetch(&((ctx_t *)arg)->ticks, 1, __ATOMIC_SEQ_CST);
+}
+
+//上线后在连接任务里直接发送和启动定时器
+static void on_online(cloud_conn_t *conn)
+{
+    ctx_t *c = (ctx_t *)conn->arg;
+
+    c->line_len = 0;
+    cloud_conn_send(conn, "hello\n", 6);
+    cloud_conn_timer_start(conn, TIMER_MS, 1, on_timer, c);
+}
+
+static void on_closed(cloud_conn_t *conn, int reason)
+{
+    ctx_t *c = (ctx_t *)conn->arg;
+
+    c->reason = reason;
+    __atomic_add_fetch(&c->closed, 1, __ATOMIC_SEQ_CST);
+}
+
+static const cloud_conn_cb_t cb = { on_online, on_data, on_closed };
+
+//外部线程连续发送,队列满时稍等再发
+static void *sender(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    char frame[32];
+    int len, ret;
+
+    for (int seq = 0; seq < FRAMES; seq++)
+    {
+        len = snprintf(frame, sizeof(frame), FRAME_FMT, id, seq);
+        while ((ret = cloud_conn_send(&conn_echo, frame, len)) == CLOUD_CONN_ERR_FULL)
+        {
+            usleep(100);
+        }
+        if (ret != 0)
+        {
+            __atomic_add_fetch(&ctx_echo.disorder, 1, __ATOMIC_SEQ_CST);
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+//参数错误和离线时发送
+static void test_args(void)
+{
+    static cloud_conn_t idle;
+    static const cloud_conn_cb_t no_data = { NULL, NULL, NULL };
+    char big[CLOUD_CONN_FRAME_LEN + 1] = { 0 };
+
+    TEST_EQ_INT(cloud_conn_start(NULL, "127.0.0.1", "1", TLS_PROFILE_DEFAULT, &cb, NULL), CLOUD_CONN_ERR_ARG);
+    TEST_EQ_INT(cloud_conn_start(&idle, "127.0.0.1", "1", TLS_PROFILE_DEFAULT, &no_data, NULL), CLOUD_CONN_ERR_ARG);
+    TEST_EQ_INT(cloud_conn_send(&idle, "x", 1), CLOUD_CONN_ERR_OFFLINE);
+    TEST_EQ_INT(cloud_conn_send(&idle, big, sizeof(big)), CLOUD_CONN_ERR_ARG);
+    TEST_EQ_INT(cloud_conn_send(&idle, big, 0), CLOUD_CONN_ERR_ARG);
+}
+
+//上线回调里的发送和定时器,两个外部线程并发发送
+static void test_online(void)
+{
+    pthread_t tid[THREADS];
+    int ticks;
+
+    TEST_EQ_INT(cloud_conn_start(&conn_echo, "localhost", server.port_str, TLS_PROFILE_DEFAULT, &cb, &ctx_echo), 0);
+    //已经启动过时直接返回
+    TEST_EQ_INT(cloud_conn_start(&conn_echo, "localhost", server.port_str, TLS_PROFILE_DEFAULT, &cb, &ctx_echo), 0);
+    TEST_EQ_INT(wait_int(&ctx_echo.pongs, 1, 5000), 0);
+    TEST_EQ_INT(conn_echo.state, CLOUD_CONN_ONLINE);
+    TEST_EQ_INT(conn_echo.stats.connects, 1);
+
+    ticks = __atomic_load_n(&ctx_echo.ticks, __ATOMIC_SEQ_CST);
+    usleep(10 * TIMER_MS * 1000);
+    ticks = __atomic_load_n(&ctx_echo.ticks, __ATOMIC_SEQ_CST) - ticks;
+    TEST_CHECK(ticks >= 5 && ticks <= 11);
+
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_create(&tid[i], NULL, sender, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_join(tid[i], NULL);
+    }
+    TEST_EQ_INT(wait_int(&ctx_echo.frames, THREADS * FRAMES, 10000), 0);
+    TEST_EQ_INT(ctx_echo.disorder, 0);
+    TEST_EQ_INT(conn_echo.stats.tx_frames, THREADS * FRAMES + 1);
+    TEST_EQ_INT(conn_echo.stats.tx_dropped, 0);
+}
+
+//服务器关闭连接后on_closed报告0,退避后重连,上线回调重新执行
+static void test_reconnect(void)
+{
+    int ticks;
+
+    TEST_EQ_INT(cloud_conn_send(&conn_echo, "bye\n", 4), 0);
+    TEST_EQ_INT(wait_int(&ctx_echo.closed, 1, 5000), 0);
+    TEST_EQ_INT(ctx_echo.reason, 0);
+    TEST_EQ_INT(conn_echo.stats.drops, 1);
+    TEST_EQ_INT(wait_int(&ctx_echo.pongs, 2, 5000), 0);
+    TEST_EQ_INT(conn_echo.stats.connects, 2);
+    TEST_EQ_INT(__atomic_load_n(&server.accepted, __ATOMIC_SEQ_CST), 2);
+
+    //断开时旧的定时器已经停止,只剩上线回调新启动的一个
+    ticks = __atomic_load_n(&ctx_echo.ticks, __ATOMIC_SEQ_CST);
+    usleep(10 * TIMER_MS * 1000);
+    ticks = __atomic_load_n(&ctx_echo.ticks, __ATOMIC_SEQ_CST) - ticks;
+    TEST_CHECK(ticks >= 5 && ticks <= 11);
+}
+
+//端口没有监听:连接失败计数,不会上线
+static void test_refused(void)
+{
+    static char port[8];
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+    getsockname(sock, (struct sockaddr *)&addr, &len);
+    snprintf(port, sizeof(port), "%u", ntohs(addr.sin_port));
+    close(sock);
+
+    TEST_EQ_INT(cloud_conn_start(&conn_refused, "127.0.0.1", port, TLS_PROFILE_DEFAULT, &cb, &ctx_refused), 0);
+    TEST_EQ_INT(wait_u32(&conn_refused.stats.failures, 1, 3000), 0);
+    TEST_EQ_INT(conn_refused.stats.connects, 0);
+    TEST_EQ_INT(ctx_refused.pongs, 0);
+    TEST_EQ_INT(cloud_conn_send(&conn_refused, "x", 1), CLOUD_CONN_ERR_OFFLINE);
+}
+
+//TCP能连上但服务器一直不握手:握手超时后失败计数
+static void test_handshake_timeout(void)
+{
+    static char port[8];
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    long long start;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    //只监听不accept,内核替它完成三次握手
+    TEST_EQ_INT(bind(sock, (struct sockaddr *)&addr, sizeof(addr)), 0);
+    TEST_EQ_INT(listen(sock, 4), 0);
+    getsockname(sock, (struct sockaddr *)&addr, &len);
+    snprintf(port, sizeof(port), "%u", ntohs(addr.sin_port));
+
+    start = now_ms();
+    TEST_EQ_INT(cloud_conn_start(&conn_silent, "127.0.0.1", port, TLS_PROFILE_DEFAULT, &cb, &ctx_silent), 0);
+    TEST_EQ_INT(wait_u32(&conn_silent.stats.failures, 1, 3000), 0);
+    TEST_CHECK(now_ms() - start >= CLOUD_CONN_HANDSHAKE_MS);
+    TEST_EQ_INT(conn_silent.stats.connects, 0);
+    TEST_EQ_INT(ctx_silent.pongs, 0);
+    close(sock);
+}
+
+int main(void)
+{
+    //lwip没有SIGPIPE,主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+
+    //连接任务不会退出,整个测试共用一个服务器,进程退出时一起结束
+    TEST_EQ_INT(tls_server_start(&server, 1, 1, echo_handler, NULL), 0);
+    test_args();
+    test_online();
+    test_reconnect();
+    test_refused();
+    test_handshake_timeout();
+    TEST_END();
+}
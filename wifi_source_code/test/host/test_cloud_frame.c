@@ -0,0 +1,151 @@
+/*
+* @file         test_cloud_frame.c
+* @brief        hx-tmall预先拼好的签到、加密签到和心跳帧的测试
+* @details      用user_tmall_genie.h中的设备ID和KEY拼帧,和改之前cJSON_PrintUnformatted的输出逐字节比较;
+*               加密签到帧中的K和标准md5的结果比较,md5由stub/md5.c用主机的OpenSSL计算,
+*               先用RFC 1321的例子确认;随机的token和另外拼出的期望帧比较
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include "mbedtls/md5.h"
+#include "user_cloud_frame.h"
+#include "user_tmall_genie.h"
+#include "test.h"
+
+#define TOKENS          2000                            //随机token的个数
+
+static cloud_frame_t s_frame;
+
+//md5的十六进制结果
+static const char *md5_hex(const char *s, size_t len)
+{
+    static char hex[33];
+    unsigned char out[16];
+
+    mbedtls_md5_ret((const unsigned char *)s, len, out);
+    for (int i = 0; i < 16; i++)
+    {
+        sprintf(hex + 2 * i, "%02x", out[i]);
+    }
+    return hex;
+}
+
+static void test_md5_stub(void)
+{
+    static char a64[65];
+
+    TEST_EQ_MEM(md5_hex("", 0), 32, "d41d8cd98f00b204e9800998ecf8427e");
+    TEST_EQ_MEM(md5_hex("abc", 3), 32, "900150983cd24fb0d6963f7d28e17f72");
+    TEST_EQ_MEM(md5_hex("message digest", 14), 32, "f96b697d7cb7938d525a2f31aaf161d0");
+    TEST_EQ_MEM(md5_hex("12345678901234567890123456789012345678901234567890123456789012345678901234567890", 80), 32,
+                "57edf4a22be3c955ac49da2e2107b67a");
+    //填充跨越块边界的几个长度
+    memset(a64, 'a', 64);
+    TEST_EQ_MEM(md5_hex(a64, 55), 32, "ef1772b6dff9a122358552954ad0df65");
+    TEST_EQ_MEM(md5_hex(a64, 56), 32, "3b0c8ac703f828b04c6c197006d17218");
+    TEST_EQ_MEM(md5_hex(a64, 64), 32, "014842d480b571495a4a0363793f7367");
+}
+
+static void test_fixed_frames(void)
+{
+    const char *frame;
+    size_t len;
+
+    TEST_EQ_INT(cloud_frame_init(&s_frame, DEVICE_ID, DEVICE_API_KEY, USER_API_KEY), 0);
+    frame = cloud_frame_checkin(&s_frame, &len);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"checkin\",\"ID\":\"" DEVICE_ID "\",\"K\":\"" DEVICE_API_KEY "\"}\n");
+    TEST_EQ_INT(frame[len], 0);
+    frame = cloud_frame_heart_beat(&s_frame, &len);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"heart beat\"}\n");
+    TEST_EQ_INT(frame[len], 0);
+}
+
+static void test_sign_in(void)
+{
+    char token[CLOUD_FRAME_TOKEN_MAX + 1];
+    const char *frame;
+    size_t len;
+
+    TEST_EQ_INT(cloud_frame_init(&s_frame, DEVICE_ID, DEVICE_API_KEY, "6dc19ba6a5"), 0);
+    frame = cloud_frame_sign_in(&s_frame, "abc123", 6, &len);
+    TEST_CHECK(frame != NULL);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"checkin\",\"ID\":\"" DEVICE_ID "\",\"K\":\"4fa3980c0ecce0afb09bc4b215320737\"}\n");
+    //换一个更短的token,前一次留下的字节不能进入md5的输入
+    frame = cloud_frame_sign_in(&s_frame, "x", 1, &len);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"checkin\",\"ID\":\"" DEVICE_ID "\",\"K\":\"061298be796561f89fdda6639636f6a2\"}\n");
+    memset(token, 'T', sizeof(token));
+    frame = cloud_frame_sign_in(&s_frame, token, CLOUD_FRAME_TOKEN_MAX, &len);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"checkin\",\"ID\":\"" DEVICE_ID "\",\"K\":\"731b9e8ea1effad90a064f456f865691\"}\n");
+    //签到和心跳帧不受影响
+    frame = cloud_frame_heart_beat(&s_frame, &len);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"heart beat\"}\n");
+    TEST_CHECK(cloud_frame_sign_in(&s_frame, token, CLOUD_FRAME_TOKEN_MAX + 1, &len) == NULL);
+    TEST_CHECK(cloud_frame_sign_in(&s_frame, token, 0, &len) == NULL);
+    TEST_CHECK(cloud_frame_sign_in(&s_frame, NULL, 1, &len) == NULL);
+}
+
+//随机长度和内容的token:帧和另外拼出来的一样,K为md5(token + 用户KEY),签到帧不变
+static void test_random_tokens(void)
+{
+    static const char chars[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char token[CLOUD_FRAME_TOKEN_MAX];
+    char input[CLOUD_FRAME_TOKEN_MAX + sizeof(USER_API_KEY)];
+    char expect[160];
+    const char *frame;
+    size_t len, token_len, expect_len;
+    int bad = 0;
+
+    TEST_EQ_INT(cloud_frame_init(&s_frame, DEVICE_ID, DEVICE_API_KEY, USER_API_KEY), 0);
+    srand(23);
+    for (int i = 0; i < TOKENS; i++)
+    {
+        token_len = 1 + rand() % CLOUD_FRAME_TOKEN_MAX;
+        for (size_t j = 0; j < token_len; j++)
+        {
+            token[j] = chars[rand() % (sizeof(chars) - 1)];
+        }
+        memcpy(input, token, token_len);
+        memcpy(input + token_len, USER_API_KEY, sizeof(USER_API_KEY) - 1);
+        expect_len = snprintf(expect, sizeof(expect), "{\"M\":\"checkin\",\"ID\":\"%s\",\"K\":\"%s\"}\n", DEVICE_ID,
+                              md5_hex(input, token_len + sizeof(USER_API_KEY) - 1));
+        frame = cloud_frame_sign_in(&s_frame, token, token_len, &len);
+        if (frame == NULL || len != expect_len || memcmp(frame, expect, len) != 0 || frame[len] != 0)
+        {
+            bad++;
+        }
+    }
+    TEST_EQ_INT(bad, 0);
+    frame = cloud_frame_checkin(&s_frame, &len);
+    TEST_EQ_MEM(frame, len, "{\"M\":\"checkin\",\"ID\":\"" DEVICE_ID "\",\"K\":\"" DEVICE_API_KEY "\"}\n");
+}
+
+static void test_init_errors(void)
+{
+    char id[CLOUD_FRAME_ARENA_LEN];
+
+    TEST_EQ_INT(cloud_frame_init(&s_frame, NULL, "k", "u"), CLOUD_FRAME_ERR_ARG);
+    TEST_EQ_INT(cloud_frame_init(&s_frame, "1", NULL, "u"), CLOUD_FRAME_ERR_ARG);
+    TEST_EQ_INT(cloud_frame_init(&s_frame, "1", "k", NULL), CLOUD_FRAME_ERR_ARG);
+    memset(id, '7', sizeof(id) - 1);
+    id[sizeof(id) - 1] = 0;
+    TEST_EQ_INT(cloud_frame_init(&s_frame, id, "k", "u"), CLOUD_FRAME_ERR_ARG);
+    id[80] = 0;
+    TEST_EQ_INT(cloud_frame_init(&s_frame, id, "k", "u"), CLOUD_FRAME_ERR_ARG);
+    TEST_CHECK(s_frame.used <= CLOUD_FRAME_ARENA_LEN);
+}
+
+int main(void)
+{
+    test_md5_stub();
+    test_fixed_frames();
+    test_sign_in();
+    test_random_tokens();
+    test_init_errors();
+    TEST_END();
+}
@@ -0,0 +1,411 @@
+/*
+* @file         test_cloud_msg.c
+* @brief        hx-tmall云平台消息解析和分发表的测试
+* @details      检查贝壳物联消息的字段提取、格式错误,以及分发表的填表、冲突检查和查表;
+*               路由名字和user_tmall_genie.c中的列表一致,表的大小直接用user_tmall_genie.h中的宏;
+*               按文法随机生成的对象逐个字段和生成时记下的位置比较,
+*               随机改坏的输入放进刚好大小的堆缓存,ASan检查不会读出数据之外
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "user_cloud_msg.h"
+#include "user_tmall_genie.h"
+#include "test.h"
+
+#define GEN_OBJECTS     20000                           //按文法生成的对象个数
+#define MUTATIONS       20000                           //改坏的输入个数
+#define GEN_CAP         2048
+
+static const cloud_msg_t *s_last_msg;
+static int s_calls[4];
+
+static void on_first(const cloud_msg_t *msg)
+{
+    s_last_msg = msg;
+    s_calls[0]++;
+}
+
+static void on_second(const cloud_msg_t *msg)
+{
+    s_calls[1]++;
+}
+
+static void on_third(const cloud_msg_t *msg)
+{
+    s_calls[2]++;
+}
+
+static void on_fourth(const cloud_msg_t *msg)
+{
+    s_calls[3]++;
+}
+
+//和user_tmall_genie.c中的gs_big_iot_list、gs_cloud_cmd_list相同
+static const cloud_msg_route_t s_method_list[] =
+{
+    CLOUD_MSG_ROUTE("WELCOME TO BIGIOT", on_first),
+    CLOUD_MSG_ROUTE("token", on_second),
+    CLOUD_MSG_ROUTE("checkinok", on_third),
+    CLOUD_MSG_ROUTE("say", on_fourth),
+};
+static const cloud_msg_route_t s_cmd_list[] =
+{
+    CLOUD_MSG_ROUTE("play", on_first),
+    CLOUD_MSG_ROUTE("stop", on_second),
+};
+
+static cloud_view_t view_of(const char *s)
+{
+    cloud_view_t v = { s, (uint16_t)strlen(s) };
+    return v;
+}
+
+static void test_parse(void)
+{
+    const char *data = " {\"M\":\"say\",\"ID\":\"P1\",\"NAME\":\"guest\",\"C\":\"pl\\\"ay\",\"extra\":{\"a\":[1,\"}\"]},"
+                       "\"T\":1539400000 ,\"K\" : \"k\"}\n{\"M\":\"next\"}";
+    size_t first = strchr(data, '\n') - data;
+    cloud_msg_t msg;
+
+    TEST_EQ_INT(cloud_msg_parse(data, strlen(data), &msg), first);
+    TEST_CHECK(CLOUD_VIEW_IS(msg.method, "say"));
+    TEST_CHECK(CLOUD_VIEW_IS(msg.id, "P1"));
+    TEST_CHECK(CLOUD_VIEW_IS(msg.name, "guest"));
+    TEST_CHECK(CLOUD_VIEW_IS(msg.content, "pl\\\"ay"));
+    TEST_CHECK(CLOUD_VIEW_IS(msg.time, "1539400000"));
+    TEST_CHECK(CLOUD_VIEW_IS(msg.key, "k"));
+    TEST_EQ_INT(cloud_msg_parse("{}", 2, &msg), 2);
+    TEST_CHECK(msg.method.p == NULL);
+    //视图直接指向原数据,不要求'\0'结尾
+    TEST_EQ_INT(cloud_msg_parse("{\"M\":\"token\"}xyz", 13, &msg), 13);
+    TEST_CHECK(CLOUD_VIEW_IS(msg.method, "token"));
+}
+
+static void test_parse_errors(void)
+{
+    static const char *bad[] =
+    {
+        "", "  ", "[]", "{", "{\"M\"", "{\"M\":", "{\"M\":\"say", "{\"M\":\"say\"", "{\"M\" \"say\"}",
+        "{M:\"say\"}", "{\"M\":\"say\";}", "{\"M\":\"say\",}", "{\"M\":{\"a\":1}", "{\"M\":}",
+    };
+    cloud_msg_t msg;
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        TEST_EQ_INT(cloud_msg_parse(bad[i], strlen(bad[i]), &msg), CLOUD_MSG_ERR_FORMAT);
+    }
+}
+
+static void test_dispatch(void)
+{
+    cloud_msg_route_t methods[BIG_IOT_METHOD_SLOTS];
+    cloud_msg_route_t cmds[BIG_IOT_CMD_SLOTS];
+    cloud_msg_t msg;
+
+    memset(s_calls, 0, sizeof(s_calls));
+    TEST_EQ_INT(cloud_msg_table_init(methods, BIG_IOT_METHOD_SLOTS, s_method_list,
+                                     sizeof(s_method_list) / sizeof(s_method_list[0])), 0);
+    TEST_EQ_INT(cloud_msg_table_init(cmds, BIG_IOT_CMD_SLOTS, s_cmd_list,
+                                     sizeof(s_cmd_list) / sizeof(s_cmd_list[0])), 0);
+    TEST_EQ_INT(cloud_msg_dispatch(methods, BIG_IOT_METHOD_SLOTS, view_of("WELCOME TO BIGIOT"), &msg), 0);
+    TEST_CHECK(s_last_msg == &msg);
+    TEST_EQ_INT(cloud_msg_dispatch(methods, BIG_IOT_METHOD_SLOTS, view_of("token"), &msg), 0);
+    TEST_EQ_INT(cloud_msg_dispatch(methods, BIG_IOT_METHOD_SLOTS, view_of("checkinok"), &msg), 0);
+    TEST_EQ_INT(cloud_msg_dispatch(methods, BIG_IOT_METHOD_SLOTS, view_of("say"), &msg), 0);
+    TEST_EQ_INT(cloud_msg_dispatch(cmds, BIG_IOT_CMD_SLOTS, view_of("stop"), &msg), 0);
+    TEST_EQ_INT(s_calls[0], 1);
+    TEST_EQ_INT(s_calls[1], 2);
+    TEST_EQ_INT(s_calls[2], 1);
+    TEST_EQ_INT(s_calls[3], 1);
+    //散列到有名字的槽但名字不同,以及空名字
+    TEST_EQ_INT(cloud_msg_dispatch(methods, BIG_IOT_METHOD_SLOTS, view_of("sby"), &msg), CLOUD_MSG_ERR_UNKNOWN);
+    TEST_EQ_INT(cloud_msg_dispatch(methods, BIG_IOT_METHOD_SLOTS, view_of("s"), &msg), CLOUD_MSG_ERR_UNKNOWN);
+    TEST_EQ_INT(cloud_msg_dispatch(cmds, BIG_IOT_CMD_SLOTS, view_of(""), &msg), CLOUD_MSG_ERR_UNKNOWN);
+    TEST_EQ_INT(s_calls[3], 1);
+}
+
+static void test_duplicate(void)
+{
+    //"play"和"yalp"长度、首尾字符都相同,必然冲突
+    static const cloud_msg_route_t clash[] =
+    {
+        CLOUD_MSG_ROUTE("play", on_first),
+        CLOUD_MSG_ROUTE("yalp", on_second),
+    };
+    static const cloud_msg_route_t empty[] =
+    {
+        CLOUD_MSG_ROUTE("", on_first),
+    };
+    cloud_msg_route_t table[BIG_IOT_METHOD_SLOTS];
+
+    TEST_EQ_INT(cloud_msg_table_init(table, BIG_IOT_METHOD_SLOTS, clash, 2), CLOUD_MSG_ERR_DUPLICATE);
+    TEST_EQ_INT(cloud_msg_table_init(table, BIG_IOT_METHOD_SLOTS, empty, 1), CLOUD_MSG_ERR_DUPLICATE);
+    //表只有一个槽时任意两个名字都冲突
+    TEST_EQ_INT(cloud_msg_table_init(table, 1, s_cmd_list, 2), CLOUD_MSG_ERR_DUPLICATE);
+}
+
+/*
+===========================
+按文法生成
+===========================
+*/
+//生成时记下的字段位置,off为-1表示没有这个字段
+typedef struct
+{
+    int     off;
+    int     len;
+} gen_view_t;
+
+//要提取的6个字段和几个名字相近、应该跳过的字段
+static const char *const gen_keys[] = { "M", "ID", "NAME", "C", "K", "T", "MM", "I", "NAM", "extra", "" };
+#define GEN_FIELDS      6
+
+typedef struct
+{
+    char        buf[GEN_CAP];
+    int         len;
+    gen_view_t  views[GEN_FIELDS];                      //和cloud_msg_t中的顺序不同,按gen_keys的顺序
+} gen_t;
+
+static void gen_put(gen_t *g, const char *s)
+{
+    size_t n = strlen(s);
+    memcpy(g->buf + g->len, s, n);
+    g->len += n;
+}
+
+static void gen_ws(gen_t *g)
+{
+    static const char *const ws[] = { "", "", "", " ", "\t", "\r\n", "  " };
+    gen_put(g, ws[rand() % (sizeof(ws) / sizeof(ws[0]))]);
+}
+
+//字符串内容,带转义、UTF-8以及会被误认为结构的字符
+static void gen_chars(gen_t *g)
+{
+    static const char *const pieces[] = { "a", "play", "\\\"", "\\\\", "晴", "}", "]", ",", ":", "{", " ", "\\n", "0" };
+    int n = rand() % 6;
+    for (int i = 0; i < n; i++)
+    {
+        gen_put(g, pieces[rand() % (sizeof(pieces) / sizeof(pieces[0]))]);
+    }
+}
+
+static void gen_value(gen_t *g, int depth);
+
+//嵌套的对象或者数组
+static void gen_nested(gen_t *g, int depth)
+{
+    int object = rand() & 1;
+    int n = rand() % 3;
+
+    gen_put(g, object ? "{" : "[");
+    for (int i = 0; i < n; i++)
+    {
+        gen_put(g, i ? "," : "");
+        gen_ws(g);
+        if (object)
+        {
+            gen_put(g, "\"");
+            gen_chars(g);
+            gen_put(g, "\"");
+            gen_ws(g);
+            gen_put(g, ":");
+            gen_ws(g);
+        }
+        gen_value(g, depth + 1);
+        gen_ws(g);
+    }
+    gen_put(g, object ? "}" : "]");
+}
+
+static void gen_value(gen_t *g, int depth)
+{
+    static const char *const scalars[] = { "0", "-12", "1539400000", "3.5e2", "true", "false", "null" };
+    int kind = rand() % (depth < 3 ? 4 : 3);
+
+    if (kind <= 1)
+    {
+        gen_put(g, "\"");
+        gen_chars(g);
+        gen_put(g, "\"");
+    }
+    else if (kind == 2)
+    {
+        gen_put(g, scalars[rand() % (sizeof(scalars) / sizeof(scalars[0]))]);
+    }
+    else
+    {
+        gen_nested(g, depth);
+    }
+}
+
+//生成一个对象,后面再跟一段别的数据,返回对象占用的字节数
+static int gen_object(gen_t *g)
+{
+    int order[sizeof(gen_keys) / sizeof(gen_keys[0])];
+    int count = sizeof(gen_keys) / sizeof(gen_keys[0]);
+    int fields = rand() % (count + 1);
+    int end, start, t;
+
+    memset(g, 0, sizeof(*g));
+    for (int i = 0; i < GEN_FIELDS; i++)
+    {
+        g->views[i].off = -1;
+    }
+    //每个字段最多出现一次,顺序随机
+    for (int i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    for (int i = count - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    gen_ws(g);
+    gen_put(g, "{");
+    gen_ws(g);
+    for (int i = 0; i < fields; i++)
+    {
+        gen_put(g, i ? "," : "");
+        gen_ws(g);
+        gen_put(g, "\"");
+        gen_put(g, gen_keys[order[i]]);
+        gen_put(g, "\"");
+        gen_ws(g);
+        gen_put(g, ":");
+        gen_ws(g);
+        start = g->len;
+        gen_value(g, 0);
+        if (order[i] < GEN_FIELDS)
+        {
+            //字符串值不含引号
+            int quoted = g->buf[start] == '"';
+            g->views[order[i]].off = start + quoted;
+            g->views[order[i]].len = g->len - start - 2 * quoted;
+        }
+        gen_ws(g);
+    }
+    gen_put(g, "}");
+    end = g->len;
+    if (rand() & 1)
+    {
+        gen_put(g, "\n{\"M\":\"next\"}");
+    }
+    return end;
+}
+
+static int view_matches(const gen_t *g, const char *data, cloud_view_t v, int field)
+{
+    const gen_view_t *e = &g->views[field];
+    if (e->off < 0)
+    {
+        return v.p == NULL;
+    }
+    return v.p == data + e->off && v.len == e->len;
+}
+
+//按文法生成的对象,各字段的视图和生成时记下的位置一样
+static void test_generated(void)
+{
+    static gen_t g;
+    cloud_msg_t msg;
+    int end, bad = 0;
+
+    srand(21);
+    for (int i = 0; i < GEN_OBJECTS; i++)
+    {
+        end = gen_object(&g);
+        if (cloud_msg_parse(g.buf, g.len, &msg) != end ||
+            !view_matches(&g, g.buf, msg.method, 0) || !view_matches(&g, g.buf, msg.id, 1) ||
+            !view_matches(&g, g.buf, msg.name, 2) || !view_matches(&g, g.buf, msg.content, 3) ||
+            !view_matches(&g, g.buf, msg.key, 4) || !view_matches(&g, g.buf, msg.time, 5))
+        {
+            if (bad++ < 3)
+            {
+                printf("generated object mismatch: %.*s\n", g.len, g.buf);
+            }
+        }
+    }
+    TEST_EQ_INT(bad, 0);
+}
+
+//视图为空,或者落在对象占用的字节之内
+static int view_inside(cloud_view_t v, const char *data, int ret)
+{
+    return v.p == NULL || (v.p >= data && v.p + v.len <= data + ret);
+}
+
+//改坏的输入:要么报格式错误,要么返回的长度和各视图都不超出数据
+static void test_mutated(void)
+{
+    static gen_t g;
+    static const char junk[] = "{}[]\",:\\ a0";
+    cloud_msg_t msg;
+    char *data;
+    int ret, pos, bad = 0;
+
+    srand(2021);
+    for (int i = 0; i < MUTATIONS; i++)
+    {
+        gen_object(&g);
+        for (int n = rand() % 4 + 1; n > 0 && g.len > 0; n--)
+        {
+            pos = rand() % g.len;
+            switch (rand() % 4)
+            {
+            case 0:
+                g.buf[pos] = junk[rand() % (sizeof(junk) - 1)];
+                break;
+            case 1:
+                memmove(g.buf + pos, g.buf + pos + 1, g.len - pos - 1);
+                g.len--;
+                break;
+            case 2:
+                if (g.len < GEN_CAP)
+                {
+                    memmove(g.buf + pos + 1, g.buf + pos, g.len - pos);
+                    g.buf[pos] = junk[rand() % (sizeof(junk) - 1)];
+                    g.len++;
+                }
+                break;
+            default:
+                g.len = pos;
+                break;
+            }
+        }
+        //刚好大小的缓存,后面没有'\0'
+        data = malloc(g.len ? g.len : 1);
+        memcpy(data, g.buf, g.len);
+        ret = cloud_msg_parse(data, g.len, &msg);
+        if (ret != CLOUD_MSG_ERR_FORMAT &&
+            (ret <= 0 || ret > g.len || !view_inside(msg.method, data, ret) || !view_inside(msg.id, data, ret) ||
+             !view_inside(msg.name, data, ret) || !view_inside(msg.content, data, ret) ||
+             !view_inside(msg.key, data, ret) || !view_inside(msg.time, data, ret)))
+        {
+            bad++;
+        }
+        free(data);
+    }
+    TEST_EQ_INT(bad, 0);
+}
+
+int main(void)
+{
+    test_parse();
+    test_parse_errors();
+    test_dispatch();
+    test_duplicate();
+    test_generated();
+    test_mutated();
+    TEST_END();
+}
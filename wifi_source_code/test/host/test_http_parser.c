@@ -0,0 +1,322 @@
+/*
+* @file         test_http_parser.c
+* @brief        user_http_parser的主机测试
+* @details      响应按每个位置切成两段喂入,结果必须和一次喂入相同;
+*               覆盖Content-Length、chunked、读到关闭为止、临时响应、HEAD以及各种错误;
+*               随机生成的响应随机切段喂入,响应体逐字节一致;随机改坏的响应不越界
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "user_http_parser.h"
+#include "test.h"
+
+//回调收到的响应头和响应体
+typedef struct
+{
+    char headers[512];
+    size_t headers_len;
+    char body[512];
+    size_t body_len;
+    int stop_at_body;
+} http_log_t;
+
+static int log_header(void *arg, const char *name, const char *value)
+{
+    http_log_t *log = arg;
+    log->headers_len += snprintf(log->headers + log->headers_len, sizeof(log->headers) - log->headers_len,
+                                                              "%s=%s;", name, value);
+    return 0;
+}
+
+static int log_body(void *arg, const uint8_t *data, size_t len)
+{
+    http_log_t *log = arg;
+    if (log->body_len + len <= sizeof(log->body))
+    {
+        memcpy(log->body + log->body_len, data, len);
+        log->body_len += len;
+    }
+    return log->stop_at_body;
+}
+
+static const http_parser_cb_t s_cb = { log_header, log_body };
+
+//分两段喂入,返回两次消费的总字节数或错误码
+static int feed_split(http_resp_parser_t *p, http_log_t *log, const char *resp, size_t split)
+{
+    size_t len = strlen(resp);
+    int n1, n2;
+    memset(log, 0, sizeof(*log));
+    http_resp_parser_init(p, &s_cb, log);
+    n1 = http_resp_parser_feed(p, (const uint8_t *)resp, split);
+    if (n1 < 0)
+    {
+        return n1;
+    }
+    if ((size_t)n1 < split)
+    {
+        return n1;
+    }
+    n2 = http_resp_parser_feed(p, (const uint8_t *)resp + split, len - split);
+    return n2 < 0 ? n2 : n1 + n2;
+}
+
+static void test_content_length(void)
+{
+    const char *resp = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 11\r\n\r\n{\"ok\":true}"
+                                          "HTTP/1.1 204 No Content\r\n\r\n";
+    size_t first = strlen(resp) - strlen("HTTP/1.1 204 No Content\r\n\r\n");
+    http_resp_parser_t p;
+    http_log_t log;
+    size_t split;
+    for (split = 0; split <= strlen(resp); split++)
+    {
+        //响应结束后不再消费,后面的数据留给下一个响应
+        TEST_EQ_INT(feed_split(&p, &log, resp, split), first);
+        TEST_CHECK(http_resp_parser_done(&p));
+        TEST_EQ_INT(p.status, 200);
+        TEST_EQ_INT(p.keep_alive, 1);
+        TEST_EQ_INT(p.content_length, 11);
+        TEST_EQ_MEM(log.headers, log.headers_len, "Content-Type=application/json;Content-Length=11;");
+        TEST_EQ_MEM(log.body, log.body_len, "{\"ok\":true}");
+    }
+    http_resp_parser_init(&p, &s_cb, &log);
+    TEST_EQ_INT(http_resp_parser_feed(&p, (const uint8_t *)resp + first, strlen(resp) - first), strlen(resp) - first);
+    TEST_CHECK(http_resp_parser_done(&p));
+    TEST_EQ_INT(p.status, 204);
+}
+
+static void test_chunked(void)
+{
+    const char *resp = "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, Chunked\r\nConnection: close\r\n\r\n"
+                                          "5;ext=1\r\nhello\r\n19\r\n, chunked world, 25 bytes\r\n0\r\nX-Trailer: 1\r\n\r\n";
+    http_resp_parser_t p;
+    http_log_t log;
+    size_t split;
+    for (split = 0; split <= strlen(resp); split++)
+    {
+        TEST_EQ_INT(feed_split(&p, &log, resp, split), strlen(resp));
+        TEST_CHECK(http_resp_parser_done(&p));
+        TEST_EQ_INT(p.chunked, 1);
+        TEST_EQ_INT(p.keep_alive, 0);
+        TEST_EQ_INT(p.body_len, 30);
+        TEST_EQ_MEM(log.body, log.body_len, "hello, chunked world, 25 bytes");
+    }
+}
+
+static void test_body_to_close(void)
+{
+    const char *resp = "HTTP/1.0 200 OK\r\n\r\nall of it";
+    http_resp_parser_t p;
+    http_log_t log;
+    TEST_EQ_INT(feed_split(&p, &log, resp, 10), strlen(resp));
+    TEST_CHECK(!http_resp_parser_done(&p));
+    TEST_EQ_INT(p.keep_alive, 0);
+    TEST_EQ_INT(http_resp_parser_finish(&p), 0);
+    TEST_EQ_MEM(log.body, log.body_len, "all of it");
+    //有Content-Length时提前关闭是不完整的响应
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nabc", 3), 41);
+    TEST_EQ_INT(http_resp_parser_finish(&p), HTTP_PARSER_ERR_EOF);
+}
+
+static void test_interim_and_head(void)
+{
+    const char *resp = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+    http_resp_parser_t p;
+    http_log_t log;
+    TEST_EQ_INT(feed_split(&p, &log, resp, 20), strlen(resp));
+    TEST_EQ_INT(p.status, 200);
+    TEST_EQ_MEM(log.body, log.body_len, "ok");
+    //HEAD请求的响应有Content-Length也没有响应体
+    memset(&log, 0, sizeof(log));
+    http_resp_parser_init(&p, &s_cb, &log);
+    p.no_body = 1;
+    resp = "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n";
+    TEST_EQ_INT(http_resp_parser_feed(&p, (const uint8_t *)resp, strlen(resp)), strlen(resp));
+    TEST_CHECK(http_resp_parser_done(&p));
+    TEST_EQ_INT(log.body_len, 0);
+}
+
+static void test_long_header(void)
+{
+    char resp[HTTP_PARSER_LINE_LEN * 3];
+    http_resp_parser_t p;
+    http_log_t log;
+    int n = snprintf(resp, sizeof(resp), "HTTP/1.1 200 OK\r\nX-Long: ");
+    memset(resp + n, 'v', HTTP_PARSER_LINE_LEN * 2);
+    strcpy(resp + n + HTTP_PARSER_LINE_LEN * 2, "\r\nContent-Length: 1\r\n\r\nz");
+    //超长的头被截断,不影响后面的解析
+    TEST_EQ_INT(feed_split(&p, &log, resp, 50), strlen(resp));
+    TEST_CHECK(http_resp_parser_done(&p));
+    TEST_EQ_MEM(log.body, log.body_len, "z");
+}
+
+static void test_errors(void)
+{
+    http_resp_parser_t p;
+    http_log_t log;
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/2 200 OK\r\n\r\n", 0), HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 600 No\r\n\r\n", 0), HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nno colon\r\n\r\n", 0), HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nContent-Length: 1x\r\n\r\n", 0), HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Length: 3\r\n\r\n", 0),
+                            HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 0),
+                            HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcX\r\n", 0),
+                            HTTP_PARSER_ERR_FORMAT);
+    TEST_EQ_INT(feed_split(&p, &log, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n100000000\r\n", 0),
+                            HTTP_PARSER_ERR_FORMAT);
+    memset(&log, 0, sizeof(log));
+    log.stop_at_body = 1;
+    http_resp_parser_init(&p, &s_cb, &log);
+    TEST_EQ_INT(http_resp_parser_feed(&p, (const uint8_t *)"HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\nz", 39),
+                            HTTP_PARSER_ERR_CALLBACK);
+}
+
+#define RANDOM_RESPS    3000                        //随机响应的个数
+#define MUTATED_RESPS   20000                       //随机改坏的响应个数
+#define RESP_CAP        4096
+
+//随机生成一个响应,返回长度;body_to_close为1时响应体读到关闭为止
+static size_t make_resp(unsigned *seed, char *resp, char *body, size_t *body_len, int *body_to_close)
+{
+    int mode = rand_r(seed) % 3;
+    size_t len = 0;
+    size_t pos, n;
+
+    *body_len = rand_r(seed) % 400;
+    for (size_t i = 0; i < *body_len; i++)
+    {
+        body[i] = ' ' + rand_r(seed) % 95;
+    }
+    *body_to_close = mode == 2;
+    if (rand_r(seed) % 4 == 0)
+    {
+        len += sprintf(resp + len, "HTTP/1.1 100 Continue\r\n\r\n");
+    }
+    len += sprintf(resp + len, "HTTP/1.%d 200 OK\r\nX-Seq: %u\r\n", mode == 2 ? 0 : 1, rand_r(seed));
+    if (mode == 0)
+    {
+        len += sprintf(resp + len, "Content-Length: %zu\r\n\r\n", *body_len);
+        memcpy(resp + len, body, *body_len);
+        return len + *body_len;
+    }
+    if (mode == 2)
+    {
+        len += sprintf(resp + len, "\r\n");
+        memcpy(resp + len, body, *body_len);
+        return len + *body_len;
+    }
+    len += sprintf(resp + len, "Transfer-Encoding: chunked\r\n\r\n");
+    for (pos = 0; pos < *body_len; pos += n)
+    {
+        n = 1 + rand_r(seed) % 50;
+        n = n < *body_len - pos ? n : *body_len - pos;
+        len += sprintf(resp + len, rand_r(seed) % 2 ? "%zx\r\n" : "%zX;e=1\r\n", n);
+        memcpy(resp + len, body + pos, n);
+        len += n;
+        len += sprintf(resp + len, "\r\n");
+    }
+    len += sprintf(resp + len, rand_r(seed) % 2 ? "0\r\n\r\n" : "0\r\nX-Trailer: 1\r\n\r\n");
+    return len;
+}
+
+//随机切成1到64字节的段喂入,返回出错时的错误码,否则返回消费的总字节数
+static long feed_random(unsigned *seed, http_resp_parser_t *p, const char *resp, size_t len)
+{
+    size_t pos = 0;
+    size_t n;
+    int ret;
+
+    while (pos < len)
+    {
+        n = 1 + rand_r(seed) % 64;
+        n = n < len - pos ? n : len - pos;
+        ret = http_resp_parser_feed(p, (const uint8_t *)resp + pos, n);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        TEST_CHECK((size_t)ret <= n);
+        pos += ret;
+        if ((size_t)ret < n)
+        {
+            break;
+        }
+    }
+    return pos;
+}
+
+static void test_random(void)
+{
+    static char resp[RESP_CAP];
+    char body[512];
+    size_t len, body_len;
+    int body_to_close;
+    unsigned seed = 15;
+    int bad = 0;
+    http_resp_parser_t p;
+    http_log_t log;
+
+    for (int i = 0; i < RANDOM_RESPS; i++)
+    {
+        len = make_resp(&seed, resp, body, &body_len, &body_to_close);
+        memset(&log, 0, sizeof(log));
+        http_resp_parser_init(&p, &s_cb, &log);
+        bad += feed_random(&seed, &p, resp, len) != (long)len;
+        if (body_to_close)
+        {
+            bad += http_resp_parser_done(&p) || http_resp_parser_finish(&p) != 0;
+        }
+        bad += !http_resp_parser_done(&p) || p.status != 200;
+        bad += log.body_len != body_len || memcmp(log.body, body, body_len) != 0;
+    }
+    TEST_EQ_INT(bad, 0);
+}
+
+//改坏1到4个字节:可以报错,但不能越界、不能消费超过喂入的字节
+static void test_mutated(void)
+{
+    static char resp[RESP_CAP];
+    char body[512];
+    size_t len, body_len;
+    int body_to_close;
+    unsigned seed = 150;
+    http_resp_parser_t p;
+    http_log_t log;
+
+    for (int i = 0; i < MUTATED_RESPS; i++)
+    {
+        len = make_resp(&seed, resp, body, &body_len, &body_to_close);
+        for (int m = 1 + rand_r(&seed) % 4; m > 0; m--)
+        {
+            resp[rand_r(&seed) % len] = rand_r(&seed);
+        }
+        memset(&log, 0, sizeof(log));
+        http_resp_parser_init(&p, &s_cb, &log);
+        if (feed_random(&seed, &p, resp, len) >= 0)
+        {
+            http_resp_parser_finish(&p);
+        }
+    }
+}
+
+int main(void)
+{
+    test_content_length();
+    test_chunked();
+    test_body_to_close();
+    test_interim_and_head();
+    test_long_header();
+    test_errors();
+    test_random();
+    test_mutated();
+    TEST_END();
+}
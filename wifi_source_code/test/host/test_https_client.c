@@ -0,0 +1,286 @@
+/*
+* @file         test_https_client.c
+* @brief        hx-https可复用HTTPS客户端的测试
+* @details      客户端经mbedtls桩连本地TLS服务器:keep-alive复用只握手一次,各种响应体结束方式,
+*               客户端空闲关闭和服务器关掉keep-alive连接后用session ticket或session id恢复会话,
+*               服务器不支持恢复时每次完整握手,换主机时不带旧会话,Host请求头带非默认端口和IPv6方括号,各TLS配置档都能握手;
+*               客户端统计的完整/恢复握手次数和服务器看到的一致
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "user_https_client.h"
+#include "tls_server.h"
+#include "test.h"
+
+#define BODY_SIZE       2048
+
+static https_client_t client;
+static char body[BODY_SIZE];
+
+//响应体和服务器生成的一样
+static int body_ok(size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (body[i] != tls_server_body_byte(i))
+        {
+            return 0;
+        }
+    }
+    return body[len] == 0;
+}
+
+//GET并检查响应体长度和内容
+static void get_ok(tls_server_t *s, const char *host, const char *path, int len)
+{
+    int ret = https_client_request(&client, GET_REQ, host, s->port_str, path, body, sizeof(body));
+    TEST_EQ_INT(ret, len);
+    TEST_EQ_INT(client.status, 200);
+    TEST_CHECK(ret < 0 || body_ok(ret));
+}
+
+//客户端统计的握手和服务器看到的一致
+static void check_handshakes(tls_server_t *s, int full, int resumed)
+{
+    TEST_EQ_INT(client.stats.full_handshakes, full);
+    TEST_EQ_INT(client.stats.resumed_handshakes, resumed);
+    TEST_EQ_INT(__atomic_load_n(&s->accepted, __ATOMIC_SEQ_CST), full + resumed);
+    TEST_EQ_INT(__atomic_load_n(&s->resumed, __ATOMIC_SEQ_CST), resumed);
+}
+
+//同一主机的请求复用一个连接,只有第一次握手
+static void test_keepalive(void)
+{
+    tls_server_t s;
+
+    TEST_EQ_INT(tls_server_start(&s, 1, 1, tls_server_http, NULL), 0);
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    for (int i = 0; i < 5; i++)
+    {
+        get_ok(&s, "127.0.0.1", "len/100", 100);
+    }
+    TEST_EQ_INT(client.stats.requests, 5);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 4);
+    TEST_EQ_INT(client.stats.retries, 0);
+    TEST_CHECK(client.stats.last_handshake_us > 0);
+    check_handshakes(&s, 1, 0);
+    TEST_EQ_INT(s.requests, 5);
+    https_client_deinit(&client);
+    tls_server_stop(&s);
+}
+
+//chunked、204、读到关闭为止,以及响应体放不下
+static void test_bodies(void)
+{
+    tls_server_t s;
+    int ret;
+
+    TEST_EQ_INT(tls_server_start(&s, 1, 1, tls_server_http, NULL), 0);
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    get_ok(&s, "127.0.0.1", "chunked/1000", 1000);
+    get_ok(&s, "127.0.0.1", "chunked/0", 0);
+    TEST_EQ_INT(https_client_request(&client, GET_REQ, "127.0.0.1", s.port_str, "204", body, sizeof(body)), 0);
+    TEST_EQ_INT(client.status, 204);
+    TEST_EQ_INT(https_client_request(&client, GET_REQ, "127.0.0.1", s.port_str, "nothing", body, sizeof(body)), 0);
+    TEST_EQ_INT(client.status, 404);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 3);
+
+    //放不下的部分丢弃,响应读完了,连接还能用
+    ret = https_client_request(&client, GET_REQ, "127.0.0.1", s.port_str, "len/3000", body, sizeof(body));
+    TEST_EQ_INT(ret, HTTPS_CLIENT_ERR_TOO_LONG);
+    TEST_CHECK(body_ok(BODY_SIZE - 1));
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 5);
+
+    //读到关闭为止的响应之后连接关掉,下一次恢复会话
+    get_ok(&s, "127.0.0.1", "close/500", 500);
+    TEST_EQ_INT(client.connected, 0);
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    check_handshakes(&s, 1, 1);
+
+    //新连接上服务器什么都不回就关闭
+    https_client_close(&client);
+    ret = https_client_request(&client, GET_REQ, "127.0.0.1", s.port_str, "hangup", body, sizeof(body));
+    TEST_EQ_INT(ret, HTTPS_CLIENT_ERR_CLOSED);
+    TEST_EQ_INT(client.stats.retries, 0);
+    https_client_deinit(&client);
+    tls_server_stop(&s);
+}
+
+//客户端空闲超过HTTPS_CLIENT_IDLE_MS:直接重连恢复会话,不先在旧连接上试
+static void test_idle(void)
+{
+    tls_server_t s;
+
+    TEST_EQ_INT(tls_server_start(&s, 1, 0, tls_server_http, NULL), 0);
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    host_tick_count += pdMS_TO_TICKS(HTTPS_CLIENT_IDLE_MS) - 1;
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 1);
+    host_tick_count += pdMS_TO_TICKS(HTTPS_CLIENT_IDLE_MS) + 1;
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 1);
+    TEST_EQ_INT(client.stats.retries, 0);
+    check_handshakes(&s, 1, 1);
+    https_client_deinit(&client);
+    tls_server_stop(&s);
+}
+
+//服务器关掉了keep-alive连接:GET恢复会话后重发一次,POST不重发
+static void test_server_drop(int silent)
+{
+    tls_server_t s;
+    int ret;
+
+    TEST_EQ_INT(tls_server_start(&s, 1, 0, tls_server_http, NULL), 0);
+    s.silent_close = silent;
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    get_ok(&s, "127.0.0.1", "drop/10", 10);
+    //等服务器那边关掉
+    usleep(50000);
+    get_ok(&s, "127.0.0.1", "drop/20", 20);
+    TEST_EQ_INT(client.stats.retries, 1);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 1);
+    check_handshakes(&s, 1, 1);
+    TEST_EQ_INT(s.requests, 2);
+
+    usleep(50000);
+    ret = https_client_request(&client, POST_REQ, "127.0.0.1", s.port_str, "len/10", body, sizeof(body));
+    TEST_CHECK(ret < 0);
+    TEST_EQ_INT(client.stats.retries, 1);
+    TEST_EQ_INT(client.connected, 0);
+    TEST_EQ_INT(https_client_request(&client, POST_REQ, "127.0.0.1", s.port_str, "len/10", body, sizeof(body)), 10);
+    check_handshakes(&s, 1, 2);
+    https_client_deinit(&client);
+    tls_server_stop(&s);
+}
+
+//服务器不发ticket时用session id恢复,两样都不支持时每次完整握手
+static void test_server_modes(void)
+{
+    static const int modes[][3] = {
+        //tickets, cache, 第二次是否恢复
+        { 1, 0, 1 },
+        { 0, 1, 1 },
+        { 0, 0, 0 },
+    };
+    tls_server_t s;
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        TEST_EQ_INT(tls_server_start(&s, modes[i][0], modes[i][1], tls_server_http, NULL), 0);
+        TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+        get_ok(&s, "127.0.0.1", "len/10", 10);
+        https_client_close(&client);
+        get_ok(&s, "127.0.0.1", "len/10", 10);
+        https_client_close(&client);
+        get_ok(&s, "127.0.0.1", "len/10", 10);
+        check_handshakes(&s, modes[i][2] ? 1 : 3, modes[i][2] ? 2 : 0);
+        https_client_deinit(&client);
+        tls_server_stop(&s);
+    }
+}
+
+//换主机时关掉连接,也不带上一个主机的会话
+static void test_host_change(void)
+{
+    tls_server_t s;
+
+    TEST_EQ_INT(tls_server_start(&s, 1, 1, tls_server_http, NULL), 0);
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    get_ok(&s, "localhost", "len/10", 10);
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    check_handshakes(&s, 3, 0);
+    TEST_EQ_INT(client.stats.keepalive_reuses, 0);
+    https_client_deinit(&client);
+    tls_server_stop(&s);
+}
+
+//Host请求头:端口不是443时带上端口,IPv6地址加方括号
+static void test_host_header(void)
+{
+    tls_server_t s;
+    char expect[64];
+
+    TEST_EQ_INT(tls_server_start(&s, 1, 1, tls_server_http, NULL), 0);
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    get_ok(&s, "127.0.0.1", "len/10", 10);
+    snprintf(expect, sizeof(expect), "127.0.0.1:%s", s.port_str);
+    TEST_CHECK(strcmp(s.host, expect) == 0);
+    get_ok(&s, "::1", "len/10", 10);
+    snprintf(expect, sizeof(expect), "[::1]:%s", s.port_str);
+    TEST_CHECK(strcmp(s.host, expect) == 0);
+    https_client_deinit(&client);
+    tls_server_stop(&s);
+}
+
+//每个配置档都能握手,套件不在OpenSSL里的部分被跳过
+static void test_profiles(void)
+{
+    static const uint8_t profiles[] = { TLS_PROFILE_LOW_MEM, TLS_PROFILE_THROUGHPUT };
+    tls_server_t s;
+
+    for (size_t i = 0; i < sizeof(profiles); i++)
+    {
+        TEST_EQ_INT(tls_server_start(&s, 1, 1, tls_server_http, NULL), 0);
+        TEST_EQ_INT(https_client_init(&client, profiles[i]), 0);
+        get_ok(&s, "127.0.0.1", "len/100", 100);
+        https_client_close(&client);
+        get_ok(&s, "127.0.0.1", "len/100", 100);
+        check_handshakes(&s, 1, 1);
+        https_client_deinit(&client);
+        tls_server_stop(&s);
+    }
+}
+
+//参数错误和连不上
+static void test_errors(void)
+{
+    char host[HTTPS_CLIENT_HOST_LEN + 1];
+    tls_server_t s;
+    char port[8];
+
+    TEST_EQ_INT(https_client_init(&client, TLS_PROFILE_DEFAULT), 0);
+    memset(host, 'h', sizeof(host) - 1);
+    host[sizeof(host) - 1] = 0;
+    TEST_EQ_INT(https_client_request(&client, GET_REQ, host, "443", "", body, sizeof(body)), HTTPS_CLIENT_ERR_ARG);
+    TEST_EQ_INT(https_client_request(&client, GET_REQ, "127.0.0.1", "443", "", body, 0), HTTPS_CLIENT_ERR_ARG);
+
+    //刚停掉的服务器的端口没人监听
+    TEST_EQ_INT(tls_server_start(&s, 1, 1, tls_server_http, NULL), 0);
+    strcpy(port, s.port_str);
+    tls_server_stop(&s);
+    TEST_EQ_INT(https_client_request(&client, GET_REQ, "127.0.0.1", port, "", body, sizeof(body)),
+                MBEDTLS_ERR_NET_CONNECT_FAILED);
+    TEST_EQ_INT(client.connected, 0);
+    https_client_deinit(&client);
+}
+
+int main(void)
+{
+    //lwip没有SIGPIPE,主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+
+    test_keepalive();
+    test_bodies();
+    test_idle();
+    test_server_drop(0);
+    test_server_drop(1);
+    test_server_modes();
+    test_host_change();
+    test_host_header();
+    test_profiles();
+    test_errors();
+    TEST_END();
+}
@@ -0,0 +1,197 @@
+/*
+* @file         test_https_sched.c
+* @brief        hx-https多请求并发调度的测试
+* @details      调度器的工作任务用pthread跑,经mbedtls桩连本地TLS服务器:
+*               一批请求全部完成且响应体完整,连接数不超过连接池,请求在连接上复用;
+*               服务器每个连接只服务几个请求就关闭(带或不带Connection: close)时请求全部重发完成;
+*               请求表满和参数错误
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include "user_https_sched.h"
+#include "tls_server.h"
+#include "test.h"
+
+#define JOBS            HTTPS_SCHED_MAX_JOBS
+#define BODY_LEN        1000
+
+typedef struct
+{
+    size_t  got;                                    //收到的响应体字节数
+    int     body_ok;                                //响应体内容和服务器生成的一样
+    int     ret;
+    int     status;
+    int     done;
+} job_t;
+
+static https_sched_t sched;
+static tls_server_t server;
+static job_t jobs[JOBS];
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int done_count;
+
+static int on_body(void *arg, const uint8_t *data, size_t len)
+{
+    job_t *job = (job_t *)arg;
+    for (size_t i = 0; i < len; i++)
+    {
+        job->body_ok &= data[i] == (uint8_t)tls_server_body_byte(job->got + i);
+    }
+    job->got += len;
+    return 0;
+}
+
+static const http_parser_cb_t cb = { NULL, on_body };
+
+static void on_done(void *arg, int ret, int status)
+{
+    job_t *job = (job_t *)arg;
+    pthread_mutex_lock(&lock);
+    job->ret = ret;
+    job->status = status;
+    job->done++;
+    done_count++;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+}
+
+//等到完成回调一共调用了n次,超时返回-1
+static int wait_done(int n)
+{
+    struct timespec ts;
+    int ret = 0;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += 10;
+    pthread_mutex_lock(&lock);
+    while (done_count < n && ret == 0)
+    {
+        ret = pthread_cond_timedwait(&cond, &lock, &ts);
+    }
+    n = done_count >= n ? 0 : -1;
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+//所有连接已处理的请求数
+static int sched_requests(void)
+{
+    int n = 0;
+    for (int i = 0; i < HTTPS_SCHED_CONNS; i++)
+    {
+        n += sched.conns[i].client.stats.requests;
+    }
+    return n;
+}
+
+//交给调度器一批请求,等全部完成后检查每个请求的结果
+static void run_jobs(const char *const *hosts, int nhosts)
+{
+    static const char *path = "len/1000";
+
+    memset(jobs, 0, sizeof(jobs));
+    done_count = 0;
+    for (int i = 0; i < JOBS; i++)
+    {
+        jobs[i].body_ok = 1;
+        TEST_EQ_INT(https_sched_get(&sched, hosts[i % nhosts], server.port_str, path, &cb, &jobs[i], on_done), 0);
+    }
+    TEST_EQ_INT(wait_done(JOBS), 0);
+    for (int i = 0; i < JOBS; i++)
+    {
+        TEST_EQ_INT(jobs[i].done, 1);
+        TEST_EQ_INT(jobs[i].ret, 0);
+        TEST_EQ_INT(jobs[i].status, 200);
+        TEST_EQ_INT(jobs[i].got, BODY_LEN);
+        TEST_CHECK(jobs[i].body_ok);
+    }
+}
+
+//同一主机的一批请求:最多建连接池大小个连接,第二批全部复用已有连接
+static void test_batch(void)
+{
+    static const char *const hosts[] = { "127.0.0.1" };
+    int accepted, requests = sched_requests();
+
+    run_jobs(hosts, 1);
+    accepted = __atomic_load_n(&server.accepted, __ATOMIC_SEQ_CST);
+    TEST_CHECK(accepted >= 1 && accepted <= HTTPS_SCHED_CONNS);
+    TEST_EQ_INT(sched_requests() - requests, JOBS);
+
+    run_jobs(hosts, 1);
+    TEST_EQ_INT(__atomic_load_n(&server.accepted, __ATOMIC_SEQ_CST), accepted);
+    TEST_EQ_INT(sched_requests() - requests, 2 * JOBS);
+}
+
+//两个主机交替提交,各自的请求都完成
+static void test_hosts(void)
+{
+    static const char *const hosts[] = { "127.0.0.1", "localhost" };
+
+    run_jobs(hosts, 2);
+}
+
+//服务器每个连接只回conn_requests个响应就关闭,没收到响应的请求重连后重发
+static void test_server_close(int conn_requests, int announce)
+{
+    static const char *const hosts[] = { "127.0.0.1" };
+    int resumed = __atomic_load_n(&server.resumed, __ATOMIC_SEQ_CST);
+
+    server.conn_requests = conn_requests;
+    server.announce_close = announce;
+    run_jobs(hosts, 1);
+    TEST_CHECK(__atomic_load_n(&server.resumed, __ATOMIC_SEQ_CST) > resumed);
+    server.conn_requests = 0;
+    server.announce_close = 0;
+}
+
+//排队和进行中的请求占满请求表时提交失败,主机名过长直接拒绝
+static void test_full(void)
+{
+    static job_t extra;
+    char host[HTTPS_CLIENT_HOST_LEN + 1];
+
+    //服务器处理得慢,请求在提交完之前都不会完成
+    server.work_us = 100000;
+    memset(jobs, 0, sizeof(jobs));
+    done_count = 0;
+    for (int i = 0; i < JOBS; i++)
+    {
+        jobs[i].body_ok = 1;
+        TEST_EQ_INT(https_sched_get(&sched, "127.0.0.1", server.port_str, "len/1000", &cb, &jobs[i], on_done), 0);
+    }
+    TEST_EQ_INT(https_sched_get(&sched, "127.0.0.1", server.port_str, "len/1000", &cb, &extra, on_done),
+                HTTPS_SCHED_ERR_FULL);
+    TEST_EQ_INT(wait_done(JOBS), 0);
+    TEST_EQ_INT(extra.done, 0);
+    server.work_us = 0;
+
+    memset(host, 'h', sizeof(host) - 1);
+    host[sizeof(host) - 1] = 0;
+    TEST_EQ_INT(https_sched_get(&sched, host, server.port_str, "", &cb, &extra, on_done), HTTPS_CLIENT_ERR_ARG);
+}
+
+int main(void)
+{
+    //lwip没有SIGPIPE,主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+
+    //工作任务一直在,连接也一直连着,整个测试共用一个服务器,进程退出时一起结束
+    TEST_EQ_INT(tls_server_start(&server, 1, 1, tls_server_http, NULL), 0);
+    TEST_EQ_INT(https_sched_init(&sched), 0);
+    test_batch();
+    test_hosts();
+    test_server_close(2, 0);
+    test_server_close(3, 1);
+    test_full();
+    TEST_END();
+}
@@ -0,0 +1,281 @@
+/*
+* @file         test_json_stream.c
+* @brief        user_json_stream的主机测试
+* @details      心知天气的响应按每个位置切成两段喂入,提取的值必须和一次喂入相同;
+*               另外检查通配路径、截断、数字和字面量的语法以及不完整的json;
+*               随机生成的json随机切段喂入,提取结果和一次喂入相同;随机改坏的json不越界
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "user_json_stream.h"
+#include "test.h"
+
+//回调收到的值,"路径号=值;"连在一起
+typedef struct
+{
+    char text[1024];
+    size_t len;
+    int truncated;
+} json_log_t;
+
+static json_stream_t s_js;
+
+static int log_value(void *arg, uint8_t path, const char *value, size_t len, uint8_t truncated)
+{
+    json_log_t *log = arg;
+    TEST_EQ_INT(strlen(value), len);
+    log->truncated += truncated;
+    if (len > 40)
+    {
+        len = 40;
+    }
+    log->len += snprintf(log->text + log->len, sizeof(log->text) - log->len, "%u=%.*s;", path, (int)len, value);
+    return 0;
+}
+
+//分两段喂入再结束,返回第一个错误
+static int feed_split(json_log_t *log, const char *json, size_t split)
+{
+    size_t len = strlen(json);
+    int ret;
+    ret = json_stream_feed(&s_js, (const uint8_t *)json, split);
+    if (ret == 0)
+    {
+        ret = json_stream_feed(&s_js, (const uint8_t *)json + split, len - split);
+    }
+    if (ret == 0)
+    {
+        ret = json_stream_finish(&s_js);
+    }
+    return ret;
+}
+
+//用一条路径解析整段json
+static int parse_one(json_log_t *log, const char *path, const char *json)
+{
+    memset(log, 0, sizeof(*log));
+    json_stream_init(&s_js, log_value, log);
+    if (json_stream_add_path(&s_js, path) < 0)
+    {
+        return JSON_STREAM_ERR_PATH;
+    }
+    return feed_split(log, json, strlen(json));
+}
+
+static void test_weather(void)
+{
+    const char *json = "{\"results\":[{\"location\":{\"id\":\"WX4FBXXFKE4F\",\"name\":\"\\u5317\\u4eac\"},"
+                                          "\"now\":{\"text\":\"Sunny\",\"code\":\"0\",\"temperature\":-3.5e0},"
+                                          "\"daily\":[{\"high\":\"5\"},{\"high\":\"7\"}],\"flags\":[true,false,null]}],"
+                                          "\"last_update\":\"2026-10-17T08:00:00+08:00\"}";
+    json_log_t log;
+    size_t split;
+    for (split = 0; split <= strlen(json); split++)
+    {
+        memset(&log, 0, sizeof(log));
+        json_stream_init(&s_js, log_value, &log);
+        TEST_EQ_INT(json_stream_add_path(&s_js, "results[0].location.name"), 0);
+        TEST_EQ_INT(json_stream_add_path(&s_js, "results[0].now.temperature"), 1);
+        TEST_EQ_INT(json_stream_add_path(&s_js, "results[0].daily[*].high"), 2);
+        TEST_EQ_INT(json_stream_add_path(&s_js, "results[0].flags[1]"), 3);
+        TEST_EQ_INT(feed_split(&log, json, split), 0);
+        TEST_EQ_MEM(log.text, log.len, "0=\"\\u5317\\u4eac\";1=-3.5e0;2=\"5\";2=\"7\";3=false;");
+    }
+}
+
+static void test_wildcards(void)
+{
+    json_log_t log;
+    TEST_EQ_INT(parse_one(&log, "*", "{\"a\":1,\"b\":{\"c\":[2]},\"d\":\"x\"}"), 0);
+    TEST_EQ_MEM(log.text, log.len, "0=1;0={\"c\":[2]};0=\"x\";");
+    TEST_EQ_INT(parse_one(&log, "[*]", " [ 1 , [ ] , { } ] "), 0);
+    TEST_EQ_MEM(log.text, log.len, "0=1;0=[ ];0={ };");
+    TEST_EQ_INT(parse_one(&log, "", "\"whole\""), 0);
+    TEST_EQ_MEM(log.text, log.len, "0=\"whole\";");
+    TEST_EQ_INT(parse_one(&log, "a.b", "{\"a\":{\"x\":\"b\",\"b\":\"}\\\"]\"}}"), 0);
+    TEST_EQ_MEM(log.text, log.len, "0=\"}\\\"]\";");
+}
+
+static void test_truncated(void)
+{
+    char json[JSON_STREAM_VALUE_LEN * 2];
+    json_log_t log;
+    size_t n;
+    n = snprintf(json, sizeof(json), "{\"v\":\"");
+    memset(json + n, 'x', JSON_STREAM_VALUE_LEN);
+    strcpy(json + n + JSON_STREAM_VALUE_LEN, "\",\"w\":2}");
+    TEST_EQ_INT(parse_one(&log, "v", json), 0);
+    TEST_EQ_INT(log.truncated, 1);
+}
+
+static void test_scalars(void)
+{
+    static const char *good[] =
+    {
+        "0", "-0", "12", "-1.5", "1e5", "1E+5", "2.5e-3", "true", "false", "null", "[1,-2.0e1,true]",
+    };
+    static const char *bad[] =
+    {
+        "01", "1.", "-", "1e", "+1", "1.5.3", ".5", "1e+", "tru", "nulll", "TRUE", "fals", "nul l", "[1 2]", "[1,]",
+    };
+    json_log_t log;
+    size_t i;
+    int ret;
+    for (i = 0; i < sizeof(good) / sizeof(good[0]); i++)
+    {
+        TEST_EQ_INT(parse_one(&log, "", good[i]), 0);
+        TEST_CHECK(log.len == strlen(good[i]) + 3 && memcmp(log.text + 2, good[i], strlen(good[i])) == 0);
+    }
+    for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        ret = parse_one(&log, "", bad[i]);
+        if (ret != JSON_STREAM_ERR_SYNTAX && ret != JSON_STREAM_ERR_EOF)
+        {
+            printf("bad scalar %s accepted: %d\n", bad[i], ret);
+        }
+        TEST_CHECK(ret == JSON_STREAM_ERR_SYNTAX || ret == JSON_STREAM_ERR_EOF);
+    }
+}
+
+static void test_errors(void)
+{
+    char deep[JSON_STREAM_MAX_NESTING * 2 + 4];
+    json_log_t log;
+    TEST_EQ_INT(parse_one(&log, "a..b", "{}"), JSON_STREAM_ERR_PATH);
+    TEST_EQ_INT(parse_one(&log, "a[x]", "{}"), JSON_STREAM_ERR_PATH);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\":1"), JSON_STREAM_ERR_EOF);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\" 1}"), JSON_STREAM_ERR_SYNTAX);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\":1]"), JSON_STREAM_ERR_SYNTAX);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\":1}}"), JSON_STREAM_ERR_SYNTAX);
+    //字符串和键名里不能有未转义的控制字符,转义只能是JSON规定的几种
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\":\"x\ny\"}"), JSON_STREAM_ERR_SYNTAX);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\tb\":1}"), JSON_STREAM_ERR_SYNTAX);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\":\"\\x\"}"), JSON_STREAM_ERR_SYNTAX);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"\\q\":1}"), JSON_STREAM_ERR_SYNTAX);
+    TEST_EQ_INT(parse_one(&log, "a", "{\"a\":\"\\/\\b\\f\\n\\r\\t\\u0041\"}"), 0);
+    memset(deep, '[', JSON_STREAM_MAX_NESTING + 1);
+    memset(deep + JSON_STREAM_MAX_NESTING + 1, ']', JSON_STREAM_MAX_NESTING + 1);
+    deep[JSON_STREAM_MAX_NESTING * 2 + 2] = 0;
+    TEST_EQ_INT(parse_one(&log, "a", deep), JSON_STREAM_ERR_DEPTH);
+    deep[JSON_STREAM_MAX_NESTING] = 0;
+    memset(deep, '[', JSON_STREAM_MAX_NESTING / 2);
+    memset(deep + JSON_STREAM_MAX_NESTING / 2, ']', JSON_STREAM_MAX_NESTING / 2);
+    TEST_EQ_INT(parse_one(&log, "a", deep), 0);
+}
+
+#define RANDOM_DOCS     3000                        //随机json的个数
+#define MUTATED_DOCS    20000                       //随机改坏的json个数
+#define DOC_CAP         8192
+
+//随机生成一个值,最多depth层嵌套
+static size_t gen_value(unsigned *seed, char *out, size_t cap, int depth)
+{
+    static const char *keys[] = { "results", "daily", "name", "high", "x", "long_key_name_over_24_bytes" };
+    static const char *scalars[] = { "0", "-12.5e3", "true", "false", "null", "\"a\\\"b\"", "\"\\u4eac\"", "\"\"" };
+    int kind = depth > 0 ? rand_r(seed) % 4 : 3;
+    int n = rand_r(seed) % 5;
+    size_t len = 0;
+
+    if (cap < 64)
+    {
+        return snprintf(out, cap, "1");
+    }
+    if (kind == 3)
+    {
+        return snprintf(out, cap, "%s", scalars[rand_r(seed) % 8]);
+    }
+    out[len++] = kind == 0 ? '[' : '{';
+    for (int i = 0; i < n && len < cap - 64; i++)
+    {
+        if (i > 0)
+        {
+            out[len++] = ',';
+        }
+        if (kind != 0)
+        {
+            len += snprintf(out + len, cap - len, "\"%s\":", keys[rand_r(seed) % 6]);
+        }
+        if (rand_r(seed) % 3 == 0)
+        {
+            out[len++] = ' ';
+        }
+        len += gen_value(seed, out + len, cap - len - 2, depth - 1);
+    }
+    out[len++] = kind == 0 ? ']' : '}';
+    out[len] = 0;
+    return len;
+}
+
+//一次喂入和随机切成1到32字节的段喂入,返回值和提取结果都相同
+static void test_random(void)
+{
+    static const char *paths[] = { "results[0].daily[*]", "*.name", "x[1].*", "*" };
+    static char doc[DOC_CAP];
+    json_log_t whole, pieces;
+    unsigned seed = 16;
+    size_t len, pos, n;
+    int ret_whole, ret;
+    int bad = 0;
+
+    for (int i = 0; i < RANDOM_DOCS; i++)
+    {
+        len = gen_value(&seed, doc, sizeof(doc), 1 + rand_r(&seed) % 6);
+        ret_whole = parse_one(&whole, paths[i % 4], doc);
+        memset(&pieces, 0, sizeof(pieces));
+        json_stream_init(&s_js, log_value, &pieces);
+        json_stream_add_path(&s_js, paths[i % 4]);
+        for (pos = 0, ret = 0; pos < len && ret == 0; pos += n)
+        {
+            n = 1 + rand_r(&seed) % 32;
+            n = n < len - pos ? n : len - pos;
+            ret = json_stream_feed(&s_js, (const uint8_t *)doc + pos, n);
+        }
+        ret = ret ? ret : json_stream_finish(&s_js);
+        bad += ret != 0 || ret_whole != 0;
+        bad += whole.len != pieces.len || memcmp(whole.text, pieces.text, whole.len) != 0;
+    }
+    TEST_EQ_INT(bad, 0);
+}
+
+//改坏1到4个字节:可以报错,但不能越界
+static void test_mutated(void)
+{
+    static char doc[DOC_CAP];
+    json_log_t log;
+    unsigned seed = 160;
+    size_t len;
+
+    for (int i = 0; i < MUTATED_DOCS; i++)
+    {
+        len = gen_value(&seed, doc, sizeof(doc), 1 + rand_r(&seed) % 6);
+        for (int m = 1 + rand_r(&seed) % 4; m > 0; m--)
+        {
+            doc[rand_r(&seed) % len] = rand_r(&seed);
+        }
+        memset(&log, 0, sizeof(log));
+        json_stream_init(&s_js, log_value, &log);
+        json_stream_add_path(&s_js, "*");
+        if (json_stream_feed(&s_js, (const uint8_t *)doc, len) == 0)
+        {
+            json_stream_finish(&s_js);
+        }
+    }
+}
+
+int main(void)
+{
+    test_weather();
+    test_wildcards();
+    test_truncated();
+    test_scalars();
+    test_errors();
+    test_random();
+    test_mutated();
+    TEST_END();
+}
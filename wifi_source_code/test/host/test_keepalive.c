@@ -0,0 +1,216 @@
+/*
+* @file         test_keepalive.c
+* @brief        hx-tmall自适应心跳间隔的测试
+* @details      检查初始间隔的上下限、有其他帧发出时推后、发数据后不久的断开和偶尔的网络中断不改变间隔、
+*               空闲断开后按测出的超时缩短间隔;随机的到期和断开序列中间隔始终不超过超时的3/4;
+*               -DKEEPALIVE_PROBE=1再编一次,检查加长试探也不超过上限
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "user_keepalive.h"
+#include "test.h"
+
+#define SEQUENCES       2000                            //随机序列的个数
+#define SEQUENCE_OPS    200                             //每个序列的到期和断开次数
+
+static keepalive_t s_k;
+
+//和keepalive_cap的算法无关,按定义算出的间隔上限
+static uint32_t cap_of(uint32_t timeout_ms, uint32_t learned_ms)
+{
+    uint32_t t = learned_ms != 0 && learned_ms < timeout_ms ? learned_ms : timeout_ms;
+    uint32_t cap = t / 4 * 3;
+    return cap < KEEPALIVE_MIN_MS ? KEEPALIVE_MIN_MS : cap;
+}
+
+static void test_init(void)
+{
+    keepalive_init(&s_k, 45000, 60000);
+    TEST_EQ_INT(s_k.interval_ms, 45000);
+    TEST_EQ_INT(s_k.learned_ms, 0);
+    //超过超时的3/4时取3/4,低于下限时取下限
+    keepalive_init(&s_k, 90000, 60000);
+    TEST_EQ_INT(s_k.interval_ms, 45000);
+    keepalive_init(&s_k, 1000, 60000);
+    TEST_EQ_INT(s_k.interval_ms, KEEPALIVE_MIN_MS);
+    keepalive_init(&s_k, 45000, 4000);
+    TEST_EQ_INT(s_k.interval_ms, KEEPALIVE_MIN_MS);
+}
+
+static void test_next(void)
+{
+    keepalive_init(&s_k, 45000, 60000);
+    //这段时间发过其他帧,推后到空闲满一个间隔
+    TEST_EQ_INT(keepalive_next(&s_k, 10000), 35000);
+    TEST_EQ_INT(keepalive_next(&s_k, 45000 - KEEPALIVE_SLACK_MS - 1), KEEPALIVE_SLACK_MS + 1);
+    TEST_EQ_INT(s_k.stats.deferred, 2);
+    TEST_EQ_INT(s_k.stats.sent, 0);
+    //离到期不到KEEPALIVE_SLACK_MS时直接发
+    TEST_EQ_INT(keepalive_next(&s_k, 45000 - KEEPALIVE_SLACK_MS), 0);
+    TEST_EQ_INT(s_k.survived_ms, 45000 - KEEPALIVE_SLACK_MS);
+    TEST_EQ_INT(keepalive_next(&s_k, 45003), 0);
+    TEST_EQ_INT(s_k.survived_ms, 45003);
+    TEST_EQ_INT(s_k.stats.sent, 2);
+    //已经在上限,撑过多少次都不加长
+    for (int i = 0; i < 100; i++)
+    {
+        keepalive_next(&s_k, s_k.interval_ms);
+    }
+    TEST_EQ_INT(s_k.interval_ms, 45000);
+    TEST_EQ_INT(s_k.stats.timeouts, 0);
+}
+
+static void test_idle_close(void)
+{
+    keepalive_init(&s_k, 45000, 60000);
+    //发数据后不久的断开和空闲超时无关
+    keepalive_closed(&s_k, 10000);
+    TEST_EQ_INT(s_k.learned_ms, 0);
+    TEST_EQ_INT(s_k.interval_ms, 45000);
+    TEST_EQ_INT(s_k.stats.timeouts, 0);
+    //空闲时被断开,间隔取断开时空闲时长的3/4
+    keepalive_closed(&s_k, 50000);
+    TEST_EQ_INT(s_k.learned_ms, 50000);
+    TEST_EQ_INT(s_k.interval_ms, 37500);
+    TEST_EQ_INT(s_k.stats.timeouts, 1);
+    //更长的空闲断开不能让间隔变长
+    keepalive_closed(&s_k, 55000);
+    TEST_EQ_INT(s_k.learned_ms, 50000);
+    TEST_EQ_INT(s_k.interval_ms, 37500);
+    keepalive_closed(&s_k, 40000);
+    TEST_EQ_INT(s_k.learned_ms, 40000);
+    TEST_EQ_INT(s_k.interval_ms, 30000);
+    //断线重连后继续按测出的超时
+    TEST_EQ_INT(keepalive_next(&s_k, 30000), 0);
+    TEST_EQ_INT(s_k.interval_ms, 30000);
+}
+
+static void test_sporadic_drop(void)
+{
+    keepalive_init(&s_k, 45000, 60000);
+    for (int i = 0; i < 3; i++)
+    {
+        keepalive_next(&s_k, 45000);
+    }
+    //撑过更久的空闲,一次断开当作网络中断
+    keepalive_closed(&s_k, 44000);
+    TEST_EQ_INT(s_k.learned_ms, 0);
+    TEST_EQ_INT(s_k.interval_ms, 45000);
+    //中间撑过一个间隔,重新计数
+    keepalive_next(&s_k, 45000);
+    keepalive_closed(&s_k, 44000);
+    TEST_EQ_INT(s_k.learned_ms, 0);
+    //发数据后不久的断开也重新计数
+    keepalive_closed(&s_k, 1000);
+    keepalive_closed(&s_k, 44000);
+    TEST_EQ_INT(s_k.learned_ms, 0);
+    //连续KEEPALIVE_SUSPECT次空闲断开,服务器的超时变短了
+    for (int i = 1; i < KEEPALIVE_SUSPECT; i++)
+    {
+        keepalive_closed(&s_k, 44000);
+    }
+    TEST_EQ_INT(s_k.learned_ms, 44000);
+    TEST_EQ_INT(s_k.survived_ms, 44000);
+    TEST_EQ_INT(s_k.interval_ms, 33000);
+    TEST_EQ_INT(s_k.stats.timeouts, 1);
+}
+
+#if KEEPALIVE_PROBE
+//撑过KEEPALIVE_PROBE_STREAK次后加长KEEPALIVE_STEP_MS,直到上限
+static void test_probe(void)
+{
+    uint32_t last;
+
+    keepalive_init(&s_k, 20000, 60000);
+    for (int i = 0; i < KEEPALIVE_PROBE_STREAK - 1; i++)
+    {
+        keepalive_next(&s_k, s_k.interval_ms);
+    }
+    TEST_EQ_INT(s_k.interval_ms, 20000);
+    keepalive_next(&s_k, s_k.interval_ms);
+    TEST_EQ_INT(s_k.interval_ms, 20000 + KEEPALIVE_STEP_MS);
+    for (int i = 0; i < 100; i++)
+    {
+        keepalive_next(&s_k, s_k.interval_ms);
+    }
+    TEST_EQ_INT(s_k.interval_ms, 45000);
+    //测出超时后上限变小,继续试探也不超过
+    keepalive_closed(&s_k, 50000);
+    TEST_EQ_INT(s_k.interval_ms, 37500);
+    last = s_k.interval_ms;
+    for (int i = 0; i < 100; i++)
+    {
+        keepalive_next(&s_k, s_k.interval_ms);
+    }
+    TEST_EQ_INT(s_k.interval_ms, last);
+}
+#endif
+
+//随机的到期和断开:间隔在下限和上限之间,测出的超时只会变小,推后的时间不超过一个间隔
+static void test_random_sequences(void)
+{
+    uint32_t timeout, learned, interval, idle, wait;
+    int bad = 0;
+
+    srand(24);
+    for (int i = 0; i < SEQUENCES; i++)
+    {
+        timeout = 4000 + rand() % 200000;
+        keepalive_init(&s_k, 1000 + rand() % 100000, timeout);
+        for (int j = 0; j < SEQUENCE_OPS; j++)
+        {
+            learned = s_k.learned_ms;
+            interval = s_k.interval_ms;
+            idle = rand() % (interval * 2);
+            if (rand() % 4)
+            {
+                wait = keepalive_next(&s_k, idle);
+                if (wait != 0 && (idle + KEEPALIVE_SLACK_MS >= interval || wait != interval - idle))
+                {
+                    bad++;
+                }
+                if (wait == 0 && idle + KEEPALIVE_SLACK_MS < interval)
+                {
+                    bad++;
+                }
+            }
+            else
+            {
+                keepalive_closed(&s_k, idle);
+            }
+            if (s_k.interval_ms < KEEPALIVE_MIN_MS || s_k.interval_ms > cap_of(timeout, s_k.learned_ms))
+            {
+                bad++;
+            }
+            if (learned != 0 && (s_k.learned_ms == 0 || s_k.learned_ms > learned))
+            {
+                bad++;
+            }
+            //不试探时间隔只会缩短
+            if (!KEEPALIVE_PROBE && s_k.interval_ms > interval)
+            {
+                bad++;
+            }
+        }
+    }
+    TEST_EQ_INT(bad, 0);
+}
+
+int main(void)
+{
+    test_init();
+    test_next();
+    test_idle_close();
+    test_sporadic_drop();
+#if KEEPALIVE_PROBE
+    test_probe();
+#endif
+    test_random_sequences();
+    TEST_END();
+}
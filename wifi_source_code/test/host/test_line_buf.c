@@ -0,0 +1,284 @@
+/*
+* @file         test_line_buf.c
+* @brief        hx-tmall按行重组云平台消息的测试
+* @details      同一段数据按每个位置切成两次送入,切出的行必须和一次送入时相同;
+*               检查'\r'、空行、超长行的丢弃以及reset;
+*               随机生成的数据流按随机大小切段,每段放进刚好大小、对齐随机的堆缓存送入,
+*               切出的行和直接按'\n'切分的结果比较
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "user_line_buf.h"
+#include "test.h"
+
+#define STREAMS         20000                           //随机数据流的个数
+#define STREAM_CAP      (LINE_BUF_LEN * 8)
+#define LOG_CAP         (STREAM_CAP * 2)
+
+//收到的行用'|'连起来
+typedef struct
+{
+    char    text[2048];
+    size_t  len;
+} line_log_t;
+
+static line_buf_t s_lb;
+
+static void line_log_cb(char *line, size_t len, void *arg)
+{
+    line_log_t *log = arg;
+    TEST_EQ_INT(strlen(line), len);
+    if (log->len + len + 1 < sizeof(log->text))
+    {
+        memcpy(log->text + log->len, line, len);
+        log->len += len;
+        log->text[log->len++] = '|';
+        log->text[log->len] = 0;
+    }
+}
+
+//按切点把src分两次送入
+static void feed_split(const char *src, size_t split, line_log_t *log)
+{
+    char data[1200];
+    size_t len = strlen(src);
+    memcpy(data, src, len);
+    memset(log, 0, sizeof(*log));
+    line_buf_feed(&s_lb, data, split, line_log_cb, log);
+    line_buf_feed(&s_lb, data + split, len - split, line_log_cb, log);
+}
+
+static void test_split_points(void)
+{
+    const char *src = "{\"M\":\"WELCOME TO BIGIOT\"}\r\n\n{\"M\":\"checkinok\",\"ID\":\"D1\"}\n\r\nx\n";
+    line_log_t log;
+
+    for (size_t split = 0; split <= strlen(src); split++)
+    {
+        memset(&s_lb, 0, sizeof(s_lb));
+        feed_split(src, split, &log);
+        TEST_EQ_MEM(log.text, log.len, "{\"M\":\"WELCOME TO BIGIOT\"}|{\"M\":\"checkinok\",\"ID\":\"D1\"}|x|");
+        TEST_EQ_INT(s_lb.stats.lines, 3);
+        TEST_EQ_INT(s_lb.len, 0);
+    }
+}
+
+static void test_partial_kept(void)
+{
+    char data[] = "abc\ndef";
+    char more[] = "gh\n";
+    line_log_t log;
+
+    memset(&s_lb, 0, sizeof(s_lb));
+    memset(&log, 0, sizeof(log));
+    line_buf_feed(&s_lb, data, strlen(data), line_log_cb, &log);
+    TEST_EQ_MEM(log.text, log.len, "abc|");
+    TEST_EQ_INT(s_lb.len, 3);
+    line_buf_feed(&s_lb, more, strlen(more), line_log_cb, &log);
+    TEST_EQ_MEM(log.text, log.len, "abc|defgh|");
+    TEST_EQ_INT(s_lb.stats.spliced, 1);
+}
+
+static void test_overflow(void)
+{
+    static char data[LINE_BUF_LEN * 3];
+    line_log_t log;
+
+    //正好LINE_BUF_LEN的行保留,多一个字节的行丢弃,后面的行不受影响
+    for (size_t split = 0; split < LINE_BUF_LEN * 2 + 8; split += 97)
+    {
+        char *p = data;
+        memset(p, 'a', LINE_BUF_LEN);
+        p += LINE_BUF_LEN;
+        *p++ = '\n';
+        memset(p, 'b', LINE_BUF_LEN + 1);
+        p += LINE_BUF_LEN + 1;
+        memcpy(p, "\nok\n", 4);
+        p += 4;
+        memset(&s_lb, 0, sizeof(s_lb));
+        memset(&log, 0, sizeof(log));
+        line_buf_feed(&s_lb, data, split, line_log_cb, &log);
+        line_buf_feed(&s_lb, data + split, p - data - split, line_log_cb, &log);
+        TEST_EQ_INT(s_lb.stats.lines, 2);
+        TEST_EQ_INT(s_lb.stats.overflows, 1);
+        TEST_EQ_INT(log.len, LINE_BUF_LEN + 1 + 3);
+        TEST_EQ_MEM(log.text + LINE_BUF_LEN + 1, 3, "ok|");
+    }
+}
+
+static void test_reset(void)
+{
+    char data[] = "stale";
+    char next[] = "fresh\n";
+    line_log_t log;
+
+    memset(&s_lb, 0, sizeof(s_lb));
+    memset(&log, 0, sizeof(log));
+    line_buf_feed(&s_lb, data, strlen(data), line_log_cb, &log);
+    line_buf_reset(&s_lb);
+    line_buf_feed(&s_lb, next, strlen(next), line_log_cb, &log);
+    TEST_EQ_MEM(log.text, log.len, "fresh|");
+}
+
+/*
+===========================
+随机数据流
+===========================
+*/
+//切出的行依次记成长度加内容,行里可能有'|'
+typedef struct
+{
+    char    data[LOG_CAP];
+    size_t  len;
+    int     lines;
+} stream_log_t;
+
+static void stream_log_put(stream_log_t *log, const char *line, size_t len)
+{
+    memcpy(log->data + log->len, &len, sizeof(len));
+    memcpy(log->data + log->len + sizeof(len), line, len);
+    log->len += sizeof(len) + len;
+    log->lines++;
+}
+
+static void stream_log_cb(char *line, size_t len, void *arg)
+{
+    stream_log_put((stream_log_t *)arg, line, len);
+}
+
+//行的长度集中在空行、短行和LINE_BUF_LEN附近
+static size_t gen_line_len(void)
+{
+    switch (rand() % 6)
+    {
+    case 0:
+        return rand() % 2;
+    case 1:
+    case 2:
+        return rand() % 80;
+    case 3:
+        return LINE_BUF_LEN - 2 + rand() % 5;
+    case 4:
+        return rand() % (LINE_BUF_LEN * 2);
+    default:
+        return rand() % 300;
+    }
+}
+
+//生成一段数据流,最后一行可能没有'\n'
+static size_t gen_stream(char *s)
+{
+    static const char chars[] = "{}\":,abcXYZ019 |\r";
+    size_t len = 0, n;
+    int lines = rand() % 12;
+
+    for (int i = 0; i < lines; i++)
+    {
+        n = gen_line_len();
+        if (len + n + 2 > STREAM_CAP)
+        {
+            break;
+        }
+        for (size_t j = 0; j < n; j++)
+        {
+            s[len++] = chars[rand() % (sizeof(chars) - 1)];
+        }
+        if (rand() % 3 == 0)
+        {
+            s[len++] = '\r';
+        }
+        if (i < lines - 1 || rand() % 4)
+        {
+            s[len++] = '\n';
+        }
+    }
+    return len;
+}
+
+//直接按'\n'切分:去掉一个'\r',跳过空行,去掉'\r'之前超过LINE_BUF_LEN的行丢弃,没有'\n'的尾巴不算
+static void split_reference(const char *s, size_t len, stream_log_t *log)
+{
+    const char *p = s, *end = s + len, *nl;
+    size_t n;
+
+    while ((nl = memchr(p, '\n', end - p)) != NULL)
+    {
+        n = nl - p;
+        if (n <= LINE_BUF_LEN)
+        {
+            if (n > 0 && p[n - 1] == '\r')
+            {
+                n--;
+            }
+            if (n > 0)
+            {
+                stream_log_put(log, p, n);
+            }
+        }
+        p = nl + 1;
+    }
+}
+
+//每段拷进刚好大小的堆缓存,起始地址随机对齐,按字扫描时读出段外ASan会报错
+static void feed_chunks(const char *s, size_t len, size_t max_chunk, stream_log_t *log)
+{
+    size_t pos = 0, n;
+    int shift;
+    char *mem;
+
+    while (pos < len)
+    {
+        n = 1 + rand() % max_chunk;
+        n = n < len - pos ? n : len - pos;
+        shift = rand() % 4;
+        mem = malloc(n + shift);
+        memcpy(mem + shift, s + pos, n);
+        line_buf_feed(&s_lb, mem + shift, n, stream_log_cb, log);
+        free(mem);
+        pos += n;
+    }
+}
+
+static void test_random_streams(void)
+{
+    static char stream[STREAM_CAP];
+    static stream_log_t want, got;
+    size_t len;
+    int bad = 0;
+
+    srand(22);
+    for (int i = 0; i < STREAMS; i++)
+    {
+        len = gen_stream(stream);
+        want.len = 0;
+        want.lines = 0;
+        split_reference(stream, len, &want);
+        got.len = 0;
+        got.lines = 0;
+        memset(&s_lb, 0, sizeof(s_lb));
+        //一半切成很小的段,一半和TLS记录的大小相当
+        feed_chunks(stream, len, i & 1 ? 8 : 1024, &got);
+        if (got.len != want.len || memcmp(got.data, want.data, want.len) != 0 ||
+            s_lb.stats.lines != (uint32_t)want.lines)
+        {
+            bad++;
+        }
+    }
+    TEST_EQ_INT(bad, 0);
+}
+
+int main(void)
+{
+    test_split_points();
+    test_partial_kept();
+    test_overflow();
+    test_reset();
+    test_random_streams();
+    TEST_END();
+}
@@ -0,0 +1,394 @@
+/*
+* @file         test_ota_resume.c
+* @brief        hx-ota断点续传下载的测试
+* @details      线程中跑一个本地http服务器,按设定在每次连接发出一部分响应头或响应体后断开、卡住不发、
+*               改ETag、返回503或者不支持Range;镜像写进文件做后端的分区桩,下载完后和原镜像逐字节比较;
+*               分区桩可以让某次写入写错一个位,检查读回校验后的重写;
+*               接收超时用-DOTA_RESUME_RECV_TIMEOUT_S=1缩短,卡住的连接1秒后断开重连
+* @author       红旭无线团队
+* @par History:
+*               Ver0.0.1:
+                     红旭无线团队, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "freertos/task.h"
+#include "ota_resume.h"
+#include "test.h"
+
+#define IMAGE_LEN           10000                       //两个整块加一个不满的块
+#define PARTITION_LEN       (16 * OTA_RESUME_CHUNK)
+#define SERVER_CONNS        16                          //每次测试最多按设定服务的连接数,之后的连接用最后一个设定
+#define RANDOM_RUNS         30                          //随机断开的下载次数
+
+//服务器每次连接的行为
+typedef struct
+{
+    int         cut;                                    //发出多少字节响应体后断开,0表示全部发完
+    int         hdr_cut;                                //只发出响应头的前这么多字节就断开,0表示不断
+    int         stall_ms;                               //发完后等这么久再关闭连接
+    int         status;                                 //强制返回的状态码,0表示正常响应
+    const char *etag;                                   //ETag,NULL表示不带
+} conn_plan_t;
+
+typedef struct
+{
+    int         listen_fd;
+    char        port[8];
+    int         range;                                  //是否支持Range
+    int         no_length;                              //200响应不带Content-Length
+    conn_plan_t plan[SERVER_CONNS];
+    int         conns;                                  //已经服务的连接数
+    int         offsets[SERVER_CONNS];                  //每次连接请求的Range起点,没有Range为0
+    pthread_t   thread;
+} ota_server_t;
+
+static uint8_t s_image[IMAGE_LEN];
+static ota_resume_t s_ota;
+static ota_server_t s_server;
+static char s_path[] = "/tmp/ota_resume_XXXXXX";
+static const esp_partition_t *s_partition;
+
+//服务一次连接
+static void server_conn(ota_server_t *srv, int fd)
+{
+    static char buf[1024 + IMAGE_LEN];
+    int slot = srv->conns < SERVER_CONNS ? srv->conns : SERVER_CONNS - 1;
+    conn_plan_t *plan = &srv->plan[slot];
+    const char *range;
+    int len = 0, n, offset = 0, body, hdr;
+    char etag[96] = "";
+
+    buf[0] = '\0';
+    while (strstr(buf, "\r\n\r\n") == NULL)
+    {
+        n = recv(fd, buf + len, 1023 - len, 0);
+        if (n <= 0)
+        {
+            return;
+        }
+        len += n;
+        buf[len] = '\0';
+    }
+    range = strstr(buf, "Range: bytes=");
+    if (range != NULL)
+    {
+        offset = atoi(range + 13);
+    }
+    srv->offsets[slot] = offset;
+    srv->conns++;
+
+    if (plan->status != 0)
+    {
+        hdr = snprintf(buf, sizeof(buf), "HTTP/1.1 %d Busy\r\nContent-Length: 0\r\n\r\n", plan->status);
+        send(fd, buf, hdr, MSG_NOSIGNAL);
+        return;
+    }
+    if (plan->etag != NULL)
+    {
+        snprintf(etag, sizeof(etag), "ETag: %s\r\n", plan->etag);
+    }
+    if (!srv->range || range == NULL)
+    {
+        offset = 0;
+        if (srv->no_length)
+        {
+            hdr = snprintf(buf, sizeof(buf), "HTTP/1.0 200 OK\r\n%s\r\n", etag);
+        }
+        else
+        {
+            hdr = snprintf(buf, sizeof(buf), "HTTP/1.0 200 OK\r\nContent-Length: %d\r\n%s\r\n", IMAGE_LEN, etag);
+        }
+    }
+    else
+    {
+        hdr = snprintf(buf, sizeof(buf), "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %d-%d/%d\r\n"
+                       "Content-Length: %d\r\n%s\r\n", offset, IMAGE_LEN - 1, IMAGE_LEN, IMAGE_LEN - offset, etag);
+    }
+    if (plan->hdr_cut > 0 && plan->hdr_cut < hdr)
+    {
+        send(fd, buf, plan->hdr_cut, MSG_NOSIGNAL);
+        return;
+    }
+    //响应头和响应体的开头放在一起发,客户端一次recv就会同时收到
+    body = IMAGE_LEN - offset;
+    if (plan->cut > 0 && plan->cut < body)
+    {
+        body = plan->cut;
+    }
+    memcpy(buf + hdr, s_image + offset, body);
+    send(fd, buf, hdr + body, MSG_NOSIGNAL);
+    if (plan->stall_ms > 0)
+    {
+        usleep(plan->stall_ms * 1000);
+    }
+}
+
+static void *server_task(void *arg)
+{
+    ota_server_t *srv = arg;
+    int fd;
+
+    while ((fd = accept(srv->listen_fd, NULL, NULL)) >= 0)
+    {
+        server_conn(srv, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+static void server_start(ota_server_t *srv)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
+
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(srv->listen_fd, 4) != 0)
+    {
+        perror("server");
+        exit(1);
+    }
+    getsockname(srv->listen_fd, (struct sockaddr *)&addr, &addr_len);
+    snprintf(srv->port, sizeof(srv->port), "%u", ntohs(addr.sin_port));
+    pthread_create(&srv->thread, NULL, server_task, srv);
+}
+
+static void server_stop(ota_server_t *srv)
+{
+    shutdown(srv->listen_fd, SHUT_RDWR);
+    close(srv->listen_fd);
+    pthread_join(srv->thread, NULL);
+}
+
+static void server_reset(int range)
+{
+    memset(&s_server, 0, sizeof(s_server));
+    s_server.range = range;
+}
+
+//按s_server中的设定下载一次,返回ota_resume_download的结果
+static esp_err_t run_download(void)
+{
+    ota_resume_server_t server = { "127.0.0.1", NULL, "/hello-world.bin" };
+    esp_ota_handle_t handle;
+    esp_err_t err;
+
+    s_partition = host_partition_open(s_path, PARTITION_LEN);
+    if (s_partition == NULL || esp_ota_begin(s_partition, 0, &handle) != ESP_OK)
+    {
+        perror("partition");
+        exit(1);
+    }
+    server_start(&s_server);
+    server.port = s_server.port;
+    host_task_delayed = 0;
+    err = ota_resume_download(&s_ota, &server, s_partition, handle);
+    server_stop(&s_server);
+    return err;
+}
+
+//分区中是完整的镜像,后面仍是擦除状态
+static int image_written(void)
+{
+    static uint8_t flash[PARTITION_LEN];
+
+    if (esp_partition_read(s_partition, 0, flash, sizeof(flash)) != ESP_OK || memcmp(flash, s_image, IMAGE_LEN) != 0)
+    {
+        return 0;
+    }
+    for (int i = IMAGE_LEN; i < PARTITION_LEN; i++)
+    {
+        if (flash[i] != 0xFF)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_plain(void)
+{
+    server_reset(1);
+    s_server.plan[0].etag = "\"v1\"";
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.connects, 1);
+    TEST_EQ_INT(s_ota.written, IMAGE_LEN);
+    TEST_EQ_INT(s_ota.total, IMAGE_LEN);
+    TEST_CHECK(image_written());
+}
+
+static void test_resume_range(void)
+{
+    server_reset(1);
+    s_server.plan[0] = (conn_plan_t){ .cut = 5000, .etag = "\"v1\"" };
+    s_server.plan[1] = (conn_plan_t){ .cut = 3000, .etag = "\"v1\"" };
+    s_server.plan[2] = (conn_plan_t){ .etag = "\"v1\"" };
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.connects, 3);
+    TEST_EQ_INT(s_server.offsets[0], 0);
+    TEST_EQ_INT(s_server.offsets[1], 5000);
+    TEST_EQ_INT(s_server.offsets[2], 8000);
+    //每次都有进展,退避保持最短
+    TEST_EQ_INT(host_task_delayed, 2 * OTA_RESUME_BACKOFF_MIN_MS);
+    TEST_CHECK(image_written());
+}
+
+static void test_resume_without_range(void)
+{
+    server_reset(0);
+    s_server.plan[0].cut = 5000;
+    s_server.plan[1].cut = 7000;
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.connects, 3);
+    TEST_EQ_INT(s_server.offsets[1], 5000);
+    TEST_CHECK(image_written());
+}
+
+//响应头没收完就断开,没有进展,退避加倍
+static void test_header_cut(void)
+{
+    server_reset(1);
+    s_server.plan[0].hdr_cut = 20;
+    s_server.plan[1].cut = 5000;
+    s_server.plan[2].hdr_cut = 40;
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.connects, 4);
+    TEST_EQ_INT(s_server.offsets[1], 0);
+    TEST_EQ_INT(s_server.offsets[2], 5000);
+    TEST_EQ_INT(s_server.offsets[3], 5000);
+    TEST_EQ_INT(host_task_delayed, 1000 + 1000 + 1000);
+    TEST_CHECK(image_written());
+}
+
+//发出一部分后卡住,接收超时后从块的中间续传
+static void test_stall(void)
+{
+    server_reset(1);
+    s_server.plan[0] = (conn_plan_t){ .cut = 5000, .stall_ms = OTA_RESUME_RECV_TIMEOUT_S * 1000 + 500 };
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.connects, 2);
+    TEST_EQ_INT(s_server.offsets[1], 5000);
+    TEST_CHECK(image_written());
+}
+
+static void test_unknown_length(void)
+{
+    server_reset(0);
+    s_server.no_length = 1;
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.total, -1);
+    TEST_EQ_INT(s_ota.written, IMAGE_LEN);
+    TEST_CHECK(image_written());
+}
+
+static void test_image_changed(void)
+{
+    server_reset(1);
+    s_server.plan[0] = (conn_plan_t){ .cut = 3000, .etag = "\"v1\"" };
+    s_server.plan[1] = (conn_plan_t){ .etag = "\"v2\"" };
+    TEST_EQ_INT(run_download(), ESP_ERR_INVALID_RESPONSE);
+    TEST_EQ_INT(s_ota.connects, 2);
+}
+
+static void test_server_busy(void)
+{
+    server_reset(1);
+    for (int i = 0; i < SERVER_CONNS; i++)
+    {
+        s_server.plan[i].status = 503;
+    }
+    TEST_EQ_INT(run_download(), ESP_ERR_TIMEOUT);
+    TEST_EQ_INT(s_ota.connects, OTA_RESUME_RETRY_MAX);
+    //没有进展时退避翻倍,到最长后不再增加
+    TEST_EQ_INT(host_task_delayed, 1000 + 2000 + 4000 + 8000 + 16000 * 3);
+}
+
+static void test_flash_repair(void)
+{
+    server_reset(1);
+    host_partition_fault(OTA_RESUME_CHUNK + 100, 1);
+    TEST_EQ_INT(run_download(), ESP_OK);
+    TEST_EQ_INT(s_ota.repairs, 1);
+    TEST_CHECK(image_written());
+    //每次重写都写错,重写OTA_RESUME_REWRITE_MAX次后放弃
+    server_reset(1);
+    host_partition_fault(IMAGE_LEN - 1, 100);
+    TEST_EQ_INT(run_download(), ESP_ERR_INVALID_CRC);
+    TEST_EQ_INT(s_ota.repairs, OTA_RESUME_REWRITE_MAX);
+    TEST_EQ_INT(s_ota.written, 2 * OTA_RESUME_CHUNK);
+    host_partition_fault(0, 0);
+}
+
+//每次连接在响应头或响应体的随机位置断开,偶尔返回503,有时某次写入写错一个位
+static void test_random_drops(void)
+{
+    int bad = 0;
+
+    srand(25);
+    for (int r = 0; r < RANDOM_RUNS; r++)
+    {
+        server_reset(1);
+        for (int i = 0; i < SERVER_CONNS - 1; i++)
+        {
+            s_server.plan[i].etag = "\"v1\"";
+            switch (rand() % 6)
+            {
+            case 0:
+                s_server.plan[i].hdr_cut = 1 + rand() % 60;
+                break;
+            case 1:
+                s_server.plan[i].status = 503;
+                break;
+            default:
+                s_server.plan[i].cut = 1 + rand() % 3000;
+                break;
+            }
+        }
+        s_server.plan[SERVER_CONNS - 1].etag = "\"v1\"";
+        host_partition_fault(rand() % 2 ? (uint32_t)(rand() % IMAGE_LEN) : 0, rand() % 2);
+        if (run_download() != ESP_OK || !image_written() || s_ota.written != IMAGE_LEN)
+        {
+            bad++;
+        }
+    }
+    host_partition_fault(0, 0);
+    TEST_EQ_INT(bad, 0);
+}
+
+int main(void)
+{
+    int fd = mkstemp(s_path);
+
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    for (int i = 0; i < IMAGE_LEN; i++)
+    {
+        s_image[i] = (uint8_t)(i * 131 + (i >> 8));
+    }
+    test_plain();
+    test_resume_range();
+    test_resume_without_range();
+    test_header_cut();
+    test_stall();
+    test_unknown_length();
+    test_image_changed();
+    test_server_busy();
+    test_flash_repair();
+    test_random_drops();
+    host_partition_close();
+    unlink(s_path);
+    TEST_END();
+}
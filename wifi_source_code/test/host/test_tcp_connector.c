@@ -0,0 +1,213 @@
+/*
+* @file         test_tcp_connector.c
+* @brief        tcp_connector的回环测试
+* @details      对着本机的三种server跑连接状态机：没有监听（拒绝）、accept队列满（丢SYN，超时）、
+*               accept后马上关闭（连上就断）。tick是task.h桩里的虚拟时钟，由测试推进
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "tcp_bsp.h"
+#include "tcp_connector.h"
+#include "test.h"
+
+#define BASE_MS         100                         //测试用的退避上限初值
+#define MAX_MS          800                         //测试用的退避上限最大值
+#define TIMEOUT_MS      300                         //测试用的连接超时
+
+//tcp_bsp.c中的函数，测试不编译tcp_bsp.c
+int show_socket_error_reason(const char *str, int socket)
+{
+    return 0;
+}
+
+//本机回环地址上监听，返回端口
+static int listen_on(int backlog, uint16_t *port)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(s, (struct sockaddr *)&addr, sizeof(addr));
+    listen(s, backlog);
+    getsockname(s, (struct sockaddr *)&addr, &len);
+    *port = ntohs(addr.sin_port);
+    return s;
+}
+
+//运行状态机直到离开CONNECTING，每轮把虚拟时钟推进step_ms
+static tcp_connector_state_t run_connect(tcp_connector_t *c, uint32_t step_ms)
+{
+    tcp_connector_state_t st = tcp_connector_poll(c, step_ms);
+    for (int i = 0; i < 200 && st == TCP_CONNECTOR_CONNECTING; i++)
+    {
+        host_tick_count += step_ms;
+        st = tcp_connector_poll(c, step_ms);
+    }
+    return st;
+}
+
+//退避结束回到IDLE
+static void finish_backoff(tcp_connector_t *c)
+{
+    while (tcp_connector_poll(c, 1000) == TCP_CONNECTOR_BACKOFF)
+    {
+    }
+}
+
+//没有监听的端口：每次被拒绝，退避上限翻倍到最大值，实际等待在[0, 上限]内随机
+static void test_refused(void)
+{
+    static const uint32_t caps[] = { 100, 200, 400, 800, 800, 800, 800, 800 };
+    tcp_connector_t c;
+    uint16_t port;
+    uint32_t delayed;
+    uint32_t first = 0;
+    int same = 1;
+
+    close(listen_on(1, &port));
+    tcp_connector_init(&c, "127.0.0.1", port, TIMEOUT_MS, BASE_MS, MAX_MS);
+    for (int i = 0; i < (int)(sizeof(caps) / sizeof(caps[0])); i++)
+    {
+        TEST_EQ_INT(run_connect(&c, 50), TCP_CONNECTOR_BACKOFF);
+        TEST_CHECK(c.stats.last_backoff_ms <= caps[i]);
+        TEST_EQ_INT(c.backoff_ms, caps[i] * 2 > MAX_MS ? MAX_MS : caps[i] * 2);
+        if (i == 0)
+        {
+            first = c.stats.last_backoff_ms;
+        }
+        same &= c.stats.last_backoff_ms == first;
+        //退避时间全部用vTaskDelay等完
+        delayed = host_task_delayed;
+        finish_backoff(&c);
+        TEST_EQ_INT(host_task_delayed - delayed, c.stats.last_backoff_ms);
+        TEST_EQ_INT(c.state, TCP_CONNECTOR_IDLE);
+    }
+    //随机抖动，不会每次都一样
+    TEST_CHECK(!same);
+    TEST_EQ_INT(c.stats.attempts, 8);
+    TEST_EQ_INT(c.stats.refused, 8);
+    TEST_EQ_INT(c.stats.successes, 0);
+}
+
+//accept队列满后server不回SYN，连接在超时后失败
+static void test_timeout(void)
+{
+    struct pollfd pfd;
+    tcp_connector_t c;
+    struct sockaddr_in addr;
+    int fill[8];
+    int nfill = 0;
+    uint16_t port;
+    int lsock = listen_on(0, &port);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    //用非阻塞连接把accept队列填满，直到有一个连接没有回应
+    while (nfill < 8)
+    {
+        fill[nfill] = socket(AF_INET, SOCK_STREAM, 0);
+        fcntl(fill[nfill], F_SETFL, O_NONBLOCK);
+        connect(fill[nfill], (struct sockaddr *)&addr, sizeof(addr));
+        pfd.fd = fill[nfill++];
+        pfd.events = POLLOUT;
+        if (poll(&pfd, 1, 100) == 0)
+        {
+            break;
+        }
+    }
+    TEST_CHECK(nfill < 8);
+
+    tcp_connector_init(&c, "127.0.0.1", port, TIMEOUT_MS, BASE_MS, MAX_MS);
+    TEST_EQ_INT(run_connect(&c, 20), TCP_CONNECTOR_BACKOFF);
+    TEST_EQ_INT(c.stats.timeouts, 1);
+    TEST_EQ_INT(c.stats.attempts, 1);
+    TEST_EQ_INT(c.sock, -1);
+    for (int i = 0; i < nfill; i++)
+    {
+        close(fill[i]);
+    }
+    close(lsock);
+}
+
+//accept后马上关闭的server
+static void *close_server(void *arg)
+{
+    int lsock = *(int *)arg;
+    int s;
+    while ((s = accept(lsock, NULL, NULL)) >= 0)
+    {
+        close(s);
+    }
+    return NULL;
+}
+
+//连上后等server关闭，再报告断开
+static void connect_and_drop(tcp_connector_t *c, uint32_t up_ms)
+{
+    struct pollfd pfd;
+    uint8_t b;
+
+    finish_backoff(c);
+    TEST_EQ_INT(run_connect(c, 50), TCP_CONNECTOR_CONNECTED);
+    pfd.fd = c->sock;
+    pfd.events = POLLIN;
+    TEST_EQ_INT(poll(&pfd, 1, 2000), 1);
+    TEST_EQ_INT(recv(c->sock, &b, 1, 0), 0);
+    close(c->sock);
+    host_tick_count += up_ms;
+    tcp_connector_lost(c);
+    TEST_EQ_INT(c->state, TCP_CONNECTOR_BACKOFF);
+}
+
+//连上就断时退避上限继续翻倍；连接保持了TCP_BACKOFF_STABLE_MS后断开，上限回到初值
+static void test_drop(void)
+{
+    tcp_connector_t c;
+    pthread_t tid;
+    uint16_t port;
+    int lsock = listen_on(8, &port);
+
+    pthread_create(&tid, NULL, close_server, &lsock);
+    tcp_connector_init(&c, "127.0.0.1", port, TIMEOUT_MS, BASE_MS, MAX_MS);
+    for (int i = 0; i < 4; i++)
+    {
+        connect_and_drop(&c, 10);
+    }
+    TEST_EQ_INT(c.stats.successes, 4);
+    TEST_EQ_INT(c.stats.drops, 4);
+    TEST_EQ_INT(c.backoff_ms, MAX_MS);
+    connect_and_drop(&c, TCP_BACKOFF_STABLE_MS);
+    TEST_CHECK(c.stats.last_backoff_ms <= BASE_MS);
+    TEST_EQ_INT(c.backoff_ms, BASE_MS * 2);
+    TEST_EQ_INT(c.stats.drops, 5);
+    shutdown(lsock, SHUT_RDWR);
+    pthread_join(tid, NULL);
+    close(lsock);
+}
+
+int main(void)
+{
+    srand(1);
+    test_refused();
+    test_timeout();
+    test_drop();
+    TEST_END();
+}
@@ -0,0 +1,288 @@
+/*
+* @file         test_tcp_frame.c
+* @brief        tcp_frame的单元测试
+* @details      随机帧编码成数据流后按随机边界切开喂给解析器，检查收到的帧和顺序；
+*               长度头编码、错误长度、合并发送
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "tcp_bsp.h"
+#include "tcp_frame.h"
+#include "test.h"
+
+#define FUZZ_ROUNDS     400                         //随机数据流的轮数
+#define FUZZ_FRAMES     64                          //每轮的帧数
+#define STREAM_MAX      (FUZZ_FRAMES * (TCP_FRAME_MAX_LEN + TCP_FRAME_HDR_MAX))
+
+static uint32_t rand_state = 0x12345678;
+
+//xorshift32，每次运行的数据相同，失败时可以复现
+static uint32_t rand_next(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+//回调收到的帧依次拼在一起，和发送的内容比较
+typedef struct
+{
+    uint8_t             data[STREAM_MAX];
+    size_t              used;
+    size_t              lens[FUZZ_FRAMES * 2];
+    int                 frames;
+    const uint8_t       *chunk;                     //当前喂入的数据，用来检查整帧是否没有拷贝
+    size_t              chunk_len;
+    int                 in_place;                   //直接指向喂入数据的帧数
+} sink_t;
+
+static void sink_cb(void *arg, const uint8_t *frame, size_t len)
+{
+    sink_t *s = (sink_t *)arg;
+    if (s->frames < FUZZ_FRAMES * 2)
+    {
+        s->lens[s->frames] = len;
+    }
+    s->frames++;
+    memcpy(s->data + s->used, frame, len);
+    s->used += len;
+    if (len > 0 && frame >= s->chunk && frame + len <= s->chunk + s->chunk_len)
+    {
+        s->in_place++;
+    }
+}
+
+static int sink_feed(tcp_frame_parser_t *p, sink_t *s, const uint8_t *data, size_t len)
+{
+    s->chunk = data;
+    s->chunk_len = len;
+    return tcp_frame_parser_feed(p, data, len);
+}
+
+//帧长度偏向边界值
+static size_t rand_len(void)
+{
+    static const size_t edges[] = { 0, 1, 127, 128, 255, 256, TCP_FRAME_MAX_LEN - 1, TCP_FRAME_MAX_LEN };
+    uint32_t r = rand_next();
+    if (r % 4 == 0)
+    {
+        return edges[(r >> 8) % (sizeof(edges) / sizeof(edges[0]))];
+    }
+    if (r % 4 == 1)
+    {
+        return (r >> 8) % 16;
+    }
+    return (r >> 8) % (TCP_FRAME_MAX_LEN + 1);
+}
+
+static void test_encode_hdr(void)
+{
+    uint8_t hdr[TCP_FRAME_HDR_MAX];
+
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_VARINT, 0, hdr), 1);
+    TEST_EQ_MEM(hdr, 1, "\x00");
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_VARINT, 127, hdr), 1);
+    TEST_EQ_MEM(hdr, 1, "\x7f");
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_VARINT, 128, hdr), 2);
+    TEST_EQ_MEM(hdr, 2, "\x80\x01");
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_VARINT, 300, hdr), 2);
+    TEST_EQ_MEM(hdr, 2, "\xac\x02");
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_VARINT, (1 << 21) - 1, hdr), 3);
+    TEST_EQ_MEM(hdr, 3, "\xff\xff\x7f");
+    TEST_CHECK(tcp_frame_encode_hdr(TCP_FRAME_VARINT, 1 << 21, hdr) < 0);
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_U16, 300, hdr), 2);
+    TEST_EQ_MEM(hdr, 2, "\x01\x2c");
+    TEST_EQ_INT(tcp_frame_encode_hdr(TCP_FRAME_U16, 0xffff, hdr), 2);
+    TEST_CHECK(tcp_frame_encode_hdr(TCP_FRAME_U16, 0x10000, hdr) < 0);
+}
+
+//随机帧按随机边界切开，帧内容、帧长度和顺序都要和发送的一致
+static void test_fuzz(tcp_frame_type_t type)
+{
+    static uint8_t stream[STREAM_MAX];
+    static uint8_t expect[STREAM_MAX];
+    static sink_t sink;
+    size_t lens[FUZZ_FRAMES];
+    tcp_frame_parser_t parser;
+    int bad = 0;
+    int in_place = 0;
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        size_t stream_len = 0;
+        size_t expect_len = 0;
+        size_t off = 0;
+        int frames = 0;
+        int ret;
+
+        for (int i = 0; i < FUZZ_FRAMES; i++)
+        {
+            lens[i] = rand_len();
+            stream_len += tcp_frame_encode_hdr(type, lens[i], stream + stream_len);
+            for (size_t j = 0; j < lens[i]; j++)
+            {
+                stream[stream_len++] = expect[expect_len++] = (uint8_t)rand_next();
+            }
+        }
+        memset(&sink, 0, sizeof(sink));
+        tcp_frame_parser_init(&parser, type, sink_cb, &sink);
+        //切分方式：逐字节、小块、接近一帧、大块
+        while (off < stream_len)
+        {
+            size_t max_cut[] = { 1, 7, TCP_FRAME_MAX_LEN + 5, 6000 };
+            size_t cut = 1 + rand_next() % max_cut[round % 4];
+            if (cut > stream_len - off)
+            {
+                cut = stream_len - off;
+            }
+            ret = sink_feed(&parser, &sink, stream + off, cut);
+            if (ret < 0)
+            {
+                break;
+            }
+            frames += ret;
+            off += cut;
+        }
+        if (frames != FUZZ_FRAMES || sink.frames != FUZZ_FRAMES || sink.used != expect_len ||
+            memcmp(sink.data, expect, expect_len) != 0 || memcmp(sink.lens, lens, sizeof(lens)) != 0 ||
+            parser.in_body || parser.hdr_bytes != 0)
+        {
+            bad++;
+        }
+        in_place += sink.in_place;
+    }
+    TEST_EQ_INT(bad, 0);
+    //大块切分时大部分帧整帧在一次数据中，不应拷贝
+    TEST_CHECK(in_place > FUZZ_ROUNDS * FUZZ_FRAMES / 4);
+}
+
+//超长的帧长度和超过3字节的varint报错并复位，之后的数据可以正常解析
+static void test_bad_len(void)
+{
+    static sink_t sink;
+    tcp_frame_parser_t parser;
+    uint8_t too_long_u16[] = { (TCP_FRAME_MAX_LEN + 1) >> 8, (TCP_FRAME_MAX_LEN + 1) & 0xff };
+    uint8_t too_long_varint[] = { 0x81, 0x80, 0x01 };
+    uint8_t four_byte_varint[] = { 0x80, 0x80, 0x80, 0x00 };
+    uint8_t good[] = { 3, 'a', 'b', 'c' };
+
+    memset(&sink, 0, sizeof(sink));
+    tcp_frame_parser_init(&parser, TCP_FRAME_U16, sink_cb, &sink);
+    TEST_CHECK(sink_feed(&parser, &sink, too_long_u16, 1) == 0);
+    TEST_CHECK(sink_feed(&parser, &sink, too_long_u16 + 1, 1) < 0);
+    TEST_EQ_INT(sink_feed(&parser, &sink, (const uint8_t *)"\x00\x02" "hi", 4), 1);
+    TEST_EQ_MEM(sink.data, sink.used, "hi");
+
+    memset(&sink, 0, sizeof(sink));
+    tcp_frame_parser_init(&parser, TCP_FRAME_VARINT, sink_cb, &sink);
+    TEST_CHECK(sink_feed(&parser, &sink, too_long_varint, sizeof(too_long_varint)) < 0);
+    TEST_CHECK(sink_feed(&parser, &sink, four_byte_varint, sizeof(four_byte_varint)) < 0);
+    TEST_EQ_INT(sink.frames, 0);
+    TEST_EQ_INT(sink_feed(&parser, &sink, good, sizeof(good)), 1);
+    TEST_EQ_MEM(sink.data, sink.used, "abc");
+}
+
+//小帧攒在缓存里，flush时一起发出；放不下的大帧先发缓存再直接发出，顺序不变
+static void test_batch(void)
+{
+    static uint8_t big[TCP_FRAME_MAX_LEN];
+    static uint8_t in[8192];
+    static sink_t sink;
+    tcp_frame_batch_t batch;
+    tcp_frame_parser_t parser;
+    int sv[2];
+    int got = 0;
+    int ret;
+
+    TEST_EQ_INT(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    tcp_frame_batch_init(&batch, sv[0], TCP_FRAME_VARINT);
+    for (int i = 0; i < 10; i++)
+    {
+        TEST_EQ_INT(tcp_frame_batch_add(&batch, "0123456789", i), 0);
+    }
+    TEST_EQ_INT(batch.frames, 10);
+    TEST_EQ_INT(batch.used, 10 + 45);
+    //还没有发出
+    TEST_EQ_INT(recv(sv[1], in, sizeof(in), MSG_DONTWAIT), -1);
+    TEST_EQ_INT(errno, EAGAIN);
+    TEST_EQ_INT(tcp_frame_batch_flush(&batch), 55);
+    TEST_EQ_INT(batch.used, 0);
+    //缓存满时先发出缓存中的帧
+    for (int i = 0; i < 3; i++)
+    {
+        memset(big, 'A' + i, 700);
+        TEST_EQ_INT(tcp_frame_batch_add(&batch, big, 700), 0);
+    }
+    TEST_EQ_INT(batch.frames, 1);
+    memset(big, 'Z', sizeof(big));
+    TEST_EQ_INT(tcp_frame_batch_add(&batch, big, TCP_FRAME_MAX_LEN), 0);
+    TEST_EQ_INT(batch.frames, 1);
+    TEST_EQ_INT(tcp_frame_batch_add(&batch, "end", 3), 0);
+    TEST_EQ_INT(tcp_frame_batch_flush(&batch), TCP_FRAME_MAX_LEN + 2 + 4);
+    close(sv[0]);
+
+    memset(&sink, 0, sizeof(sink));
+    tcp_frame_parser_init(&parser, TCP_FRAME_VARINT, sink_cb, &sink);
+    while ((ret = recv(sv[1], in, sizeof(in), 0)) > 0)
+    {
+        got += sink_feed(&parser, &sink, in, ret);
+    }
+    close(sv[1]);
+    TEST_EQ_INT(got, 15);
+    TEST_EQ_INT(sink.lens[9], 9);
+    TEST_EQ_INT(sink.lens[12], 700);
+    TEST_EQ_INT(sink.lens[13], TCP_FRAME_MAX_LEN);
+    TEST_EQ_INT(sink.data[45 + 1400], 'C');
+    TEST_EQ_INT(sink.data[45 + 2100], 'Z');
+    TEST_EQ_MEM(sink.data + sink.used - 3, 3, "end");
+}
+
+//大于合并缓存的帧不拷贝，长度头和内容直接发出
+static void test_batch_big(void)
+{
+    static uint8_t big[3000];
+    static uint8_t in[sizeof(big) + 8];
+    tcp_frame_batch_t batch;
+    int sv[2];
+    int got = 0;
+    int ret;
+
+    TEST_EQ_INT(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    tcp_frame_batch_init(&batch, sv[0], TCP_FRAME_U16);
+    TEST_EQ_INT(tcp_frame_batch_add(&batch, "ab", 2), 0);
+    memset(big, 'Z', sizeof(big));
+    TEST_EQ_INT(tcp_frame_batch_add(&batch, big, sizeof(big)), 0);
+    TEST_EQ_INT(batch.used, 0);
+    close(sv[0]);
+    while ((ret = recv(sv[1], in + got, sizeof(in) - got, 0)) > 0)
+    {
+        got += ret;
+    }
+    close(sv[1]);
+    TEST_EQ_INT(got, 4 + 2 + sizeof(big));
+    TEST_EQ_MEM(in, 6, "\x00\x02" "ab" "\x0b\xb8");
+    TEST_CHECK(in[6] == 'Z' && in[got - 1] == 'Z');
+}
+
+int main(void)
+{
+    test_encode_hdr();
+    test_fuzz(TCP_FRAME_VARINT);
+    test_fuzz(TCP_FRAME_U16);
+    test_bad_len();
+    test_batch();
+    test_batch_big();
+    TEST_END();
+}
@@ -0,0 +1,282 @@
+/*
+* @file         test_tcp_mux.c
+* @brief        tcp_mux的回环测试
+* @details      server任务跑在一个线程里，测试用普通socket作client：
+*               连接表满时拒绝、回发内容正确、慢的client不拖住其他client、发送队列溢出时断开
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "tcp_bsp.h"
+#include "tcp_mux.h"
+#include "test.h"
+
+#define SLOW_TOTAL      (2 * 1024 * 1024)           //慢client收发的总字节数
+#define FLOOD_MAX_SEND  4096                        //发送队列溢出测试中回调最多发送的次数
+
+static uint16_t mux_port;
+static volatile int flood_ret;                      //溢出测试中最后一次tcp_mux_send的返回值
+static uint8_t flood_buff[16 * 1024];
+
+//tcp_bsp.c中的函数，测试不编译tcp_bsp.c
+int show_socket_error_reason(const char *str, int socket)
+{
+    return 0;
+}
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void *server_thread(void *arg)
+{
+    tcp_mux_server_task(NULL);
+    return NULL;
+}
+
+//在一个空闲端口上启动server线程
+static void mux_start(void)
+{
+    pthread_t tid;
+    uint16_t port = 30000 + getpid() % 20000;
+
+    for (int i = 0; i < 100; i++, port++)
+    {
+        if (tcp_mux_server_init(port) == ESP_OK)
+        {
+            mux_port = port;
+            pthread_create(&tid, NULL, server_thread, NULL);
+            pthread_detach(tid);
+            return;
+        }
+    }
+    printf("no free port\n");
+    exit(1);
+}
+
+//连接server，sockbuf不为0时先设置收发缓存的大小
+static int client_connect(int sockbuf)
+{
+    struct sockaddr_in addr;
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (sockbuf > 0)
+    {
+        setsockopt(s, SOL_SOCKET, SO_RCVBUF, &sockbuf, sizeof(sockbuf));
+        setsockopt(s, SOL_SOCKET, SO_SNDBUF, &sockbuf, sizeof(sockbuf));
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(mux_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+//在timeout_ms内读满len字节，返回读到的字节数，对端关闭时提前返回
+static int read_full(int s, void *buff, int len, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = s, .events = POLLIN };
+    long long end = now_ms() + timeout_ms;
+    int got = 0;
+    int ret;
+
+    while (got < len)
+    {
+        int left = (int)(end - now_ms());
+        if (left <= 0 || poll(&pfd, 1, left) <= 0)
+        {
+            break;
+        }
+        ret = recv(s, (uint8_t *)buff + got, len - got, MSG_DONTWAIT);
+        if (ret <= 0)
+        {
+            break;
+        }
+        got += ret;
+    }
+    return got;
+}
+
+//等连接数变为n
+static int wait_count(int n, int timeout_ms)
+{
+    long long end = now_ms() + timeout_ms;
+    while (tcp_mux_conn_count() != n && now_ms() < end)
+    {
+        usleep(1000);
+    }
+    return tcp_mux_conn_count();
+}
+
+//发一条消息并确认原样收回
+static int echo_ok(int s, const void *msg, int len)
+{
+    uint8_t back[TCP_MUX_RX_BUFF_LEN];
+    if (send(s, msg, len, 0) != len)
+    {
+        return 0;
+    }
+    return read_full(s, back, len, 2000) == len && memcmp(back, msg, len) == 0;
+}
+
+//连接表填满后多出的连接被关闭，空出槽位后可以再连
+static void test_table_full(void)
+{
+    int cli[TCP_MUX_MAX_CONN];
+    uint8_t msg[64];
+    int extra;
+
+    for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+    {
+        cli[i] = client_connect(0);
+        TEST_CHECK(cli[i] >= 0);
+    }
+    TEST_EQ_INT(wait_count(TCP_MUX_MAX_CONN, 2000), TCP_MUX_MAX_CONN);
+    //每个client的回发只回给自己，内容里带0字节
+    for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+    {
+        for (int j = 0; j < (int)sizeof(msg); j++)
+        {
+            msg[j] = (uint8_t)(i * 31 + j);
+        }
+        msg[5] = 0;
+        TEST_CHECK(echo_ok(cli[i], msg, sizeof(msg)));
+    }
+    //连接表满，server接受后马上关闭
+    extra = client_connect(0);
+    TEST_CHECK(extra >= 0);
+    TEST_EQ_INT(read_full(extra, msg, 1, 2000), 0);
+    TEST_EQ_INT(tcp_mux_conn_count(), TCP_MUX_MAX_CONN);
+    close(extra);
+    //关闭一个后，新连接占用空出的槽位
+    close(cli[0]);
+    TEST_EQ_INT(wait_count(TCP_MUX_MAX_CONN - 1, 2000), TCP_MUX_MAX_CONN - 1);
+    cli[0] = client_connect(0);
+    TEST_EQ_INT(wait_count(TCP_MUX_MAX_CONN, 2000), TCP_MUX_MAX_CONN);
+    TEST_CHECK(echo_ok(cli[0], "again", 5));
+    for (int i = 0; i < TCP_MUX_MAX_CONN; i++)
+    {
+        close(cli[i]);
+    }
+    TEST_EQ_INT(wait_count(0, 2000), 0);
+}
+
+//慢的client只发不收时，server停止读它，其他client照常回发；慢client之后收回全部数据
+static void test_slow_client(void)
+{
+    static uint8_t out[SLOW_TOTAL];
+    static uint8_t in[SLOW_TOTAL];
+    int slow = client_connect(4096);
+    int fast = client_connect(0);
+    int sent = 0;
+    int got = 0;
+    int ret;
+    long long t;
+
+    for (int i = 0; i < SLOW_TOTAL; i++)
+    {
+        out[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    TEST_EQ_INT(wait_count(2, 2000), 2);
+    //只发不收，发到缓存满或超时为止
+    t = now_ms() + 1000;
+    while (sent < SLOW_TOTAL && now_ms() < t)
+    {
+        ret = send(slow, out + sent, SLOW_TOTAL - sent, MSG_DONTWAIT);
+        if (ret > 0)
+        {
+            sent += ret;
+        }
+        else
+        {
+            usleep(10000);
+        }
+    }
+    TEST_CHECK(sent > 0);
+    //另一个client不受影响
+    t = now_ms();
+    TEST_CHECK(echo_ok(fast, "not blocked", 11));
+    TEST_CHECK(now_ms() - t < 500);
+    TEST_EQ_INT(tcp_mux_conn_count(), 2);
+    //慢client边收边发，收回的内容和顺序不变
+    t = now_ms() + 10000;
+    while (got < SLOW_TOTAL && now_ms() < t)
+    {
+        if (sent < SLOW_TOTAL)
+        {
+            ret = send(slow, out + sent, SLOW_TOTAL - sent, MSG_DONTWAIT);
+            if (ret > 0)
+            {
+                sent += ret;
+            }
+        }
+        got += read_full(slow, in + got, SLOW_TOTAL - got, 10);
+    }
+    TEST_EQ_INT(got, SLOW_TOTAL);
+    TEST_CHECK(memcmp(in, out, SLOW_TOTAL) == 0);
+    close(slow);
+    close(fast);
+    TEST_EQ_INT(wait_count(0, 2000), 0);
+}
+
+//回调一直往不收数据的client发，发送队列放不下时tcp_mux_send断开这个连接
+static void flood_cb(tcp_conn_t *conn, const uint8_t *data, int len)
+{
+    int ret = 0;
+    for (int i = 0; i < FLOOD_MAX_SEND && ret >= 0; i++)
+    {
+        ret = tcp_mux_send(conn, flood_buff, sizeof(flood_buff));
+    }
+    flood_ret = ret;
+}
+
+static void test_send_overflow(void)
+{
+    int other = client_connect(0);
+    int sink = client_connect(4096);
+    uint8_t b = 1;
+
+    TEST_EQ_INT(wait_count(2, 2000), 2);
+    flood_ret = 0;
+    tcp_mux_set_recv_cb(flood_cb);
+    TEST_EQ_INT(send(sink, &b, 1, 0), 1);
+    TEST_EQ_INT(wait_count(1, 2000), 1);
+    TEST_EQ_INT(flood_ret, -1);
+    tcp_mux_set_recv_cb(NULL);
+    //被断开的只有这一个连接
+    TEST_CHECK(echo_ok(other, "still here", 10));
+    close(sink);
+    close(other);
+    TEST_EQ_INT(wait_count(0, 2000), 0);
+}
+
+int main(void)
+{
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    mux_start();
+    test_table_full();
+    test_slow_client();
+    test_send_overflow();
+    TEST_END();
+}
@@ -0,0 +1,271 @@
+/*
+* @file         test_udp_reliable.c
+* @brief        udp_reliable的丢包/乱序测试
+* @details      两个端点之间接一个模拟链路（rudp_set_output替换发送函数），链路按比例丢包、重复，
+*               每个包的时延在基础时延上随机抖动，抖动大于发包间隔时就会乱序。
+*               时间是虚拟毫秒，发送端窗口有空就发，检查每条消息恰好交付一次，
+*               并计算有效吞吐（交付的数据字节/用时）和无损链路比较
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "udp_reliable.h"
+#include "test.h"
+
+#define MSG_NUM         2000                        //每个场景发送的消息数
+#define MSG_LEN         RUDP_MAX_PAYLOAD            //每条消息的长度
+#define LINK_DELAY_MS   10                          //单向基础时延
+#define LINK_QUEUE      256                         //链路上最多同时在途的包
+#define RUN_LIMIT_MS    (600 * 1000)                //单个场景的虚拟时间上限
+
+//链路参数
+typedef struct
+{
+    int         loss_pct;                           //丢包率
+    int         dup_pct;                            //重复率
+    int         jitter_ms;                          //时延抖动，0到jitter_ms均匀分布
+} link_cfg_t;
+
+//在途的包
+typedef struct
+{
+    uint32_t    due_ms;                             //到达时刻
+    rudp_t      *dst;                               //收包端点
+    uint16_t    len;
+    uint8_t     buf[RUDP_DATA_HDR_LEN + RUDP_MAX_PAYLOAD];
+} link_pkt_t;
+
+//链路的一个方向
+typedef struct
+{
+    rudp_t      *dst;
+} link_dir_t;
+
+static link_cfg_t link;
+static link_pkt_t queue[LINK_QUEUE];
+static int queued;
+static uint32_t now;
+static uint32_t dropped;
+static uint8_t delivered[MSG_NUM];
+static uint32_t delivered_bytes;
+static int corrupt;
+
+static void link_put(rudp_t *dst, const uint8_t *data, size_t len)
+{
+    link_pkt_t *p;
+    if (queued >= LINK_QUEUE)
+    {
+        dropped++;
+        return;
+    }
+    p = &queue[queued++];
+    p->due_ms = now + LINK_DELAY_MS + (link.jitter_ms ? rand() % (link.jitter_ms + 1) : 0);
+    p->dst = dst;
+    p->len = len;
+    memcpy(p->buf, data, len);
+}
+
+//替换rudp的发送函数：按比例丢弃、重复，其余放进链路队列
+static int link_output(void *arg, const uint8_t *data, size_t len)
+{
+    link_dir_t *dir = (link_dir_t *)arg;
+    if (rand() % 100 < link.loss_pct)
+    {
+        dropped++;
+        return len;
+    }
+    link_put(dir->dst, data, len);
+    if (rand() % 100 < link.dup_pct)
+    {
+        link_put(dir->dst, data, len);
+    }
+    return len;
+}
+
+//把到期的包交给收包端点，同一时刻到期的按入队顺序
+static void link_deliver(void)
+{
+    int i = 0;
+    link_pkt_t p;
+    while (i < queued)
+    {
+        if ((int32_t)(now - queue[i].due_ms) < 0)
+        {
+            i++;
+            continue;
+        }
+        p = queue[i];
+        memmove(&queue[i], &queue[i + 1], (queued - i - 1) * sizeof(queue[0]));
+        queued--;
+        rudp_input(p.dst, p.buf, p.len, now);
+    }
+}
+
+//消息内容由序号决定，收到后逐字节校验
+static void fill_msg(uint8_t *buf, uint32_t seq)
+{
+    for (int i = 0; i < MSG_LEN; i++)
+    {
+        buf[i] = (uint8_t)(seq * 7 + i);
+    }
+}
+
+static void recv_cb(void *arg, uint32_t seq, const uint8_t *data, size_t len)
+{
+    uint8_t expect[MSG_LEN];
+    if (seq >= MSG_NUM || len != MSG_LEN)
+    {
+        corrupt++;
+        return;
+    }
+    fill_msg(expect, seq);
+    if (memcmp(expect, data, len) != 0)
+    {
+        corrupt++;
+    }
+    delivered[seq]++;
+    delivered_bytes += len;
+}
+
+//跑一个场景，返回有效吞吐(字节/秒)，tx_out返回发送端统计
+static double run(const char *name, link_cfg_t cfg, rudp_stats_t *tx_out)
+{
+    static rudp_t a;
+    static rudp_t b;
+    link_dir_t a_to_b = { &b };
+    link_dir_t b_to_a = { &a };
+    uint8_t msg[MSG_LEN];
+    uint32_t next = 0;
+    uint32_t start;
+    double goodput;
+    int once = 1;
+
+    link = cfg;
+    queued = 0;
+    dropped = 0;
+    delivered_bytes = 0;
+    corrupt = 0;
+    memset(delivered, 0, sizeof(delivered));
+    now = 0x7ffff000;                               //从回绕前开始，顺便检查时间差值比较
+    start = now;
+
+    rudp_init(&a, -1, NULL, 0x1111, NULL, NULL);
+    rudp_init(&b, -1, NULL, 0x2222, recv_cb, NULL);
+    rudp_set_output(&a, link_output, &a_to_b);
+    rudp_set_output(&b, link_output, &b_to_a);
+
+    while ((next < MSG_NUM || rudp_in_flight(&a) > 0) && now - start < RUN_LIMIT_MS)
+    {
+        while (next < MSG_NUM)
+        {
+            fill_msg(msg, next);
+            if (rudp_send(&a, msg, sizeof(msg), now) < 0)
+            {
+                break;
+            }
+            next++;
+        }
+        link_deliver();
+        if (rudp_poll(&a, now) < 0)
+        {
+            TEST_CHECK(!"peer given up");
+        }
+        now++;
+    }
+
+    TEST_EQ_INT(next, MSG_NUM);
+    TEST_EQ_INT(rudp_in_flight(&a), 0);
+    TEST_EQ_INT(corrupt, 0);
+    for (int i = 0; i < MSG_NUM; i++)
+    {
+        once &= delivered[i] == 1;
+    }
+    TEST_CHECK(once);
+    TEST_EQ_INT(a.stats.give_up, 0);
+    TEST_EQ_INT(a.stats.acked, MSG_NUM);
+    TEST_EQ_INT(b.stats.rx_data, MSG_NUM);
+    *tx_out = a.stats;
+    goodput = delivered_bytes * 1000.0 / (now - start);
+    printf("  %-24s %7.1f KB/s goodput, %4u retrans, %4u fast, %4u dup rx\n", name,
+           goodput / 1000, a.stats.tx_retrans, a.stats.tx_fast_retrans, b.stats.rx_dup);
+    return goodput;
+}
+
+//对端不响应：每个包重传RUDP_MAX_RETRIES次后放弃，rudp_poll报告失联
+static void test_give_up(void)
+{
+    static rudp_t a;
+    link_dir_t to_nowhere = { NULL };
+    uint8_t msg[16] = { 0 };
+    int32_t ret = 0;
+
+    link.loss_pct = 100;
+    link.dup_pct = 0;
+    link.jitter_ms = 0;
+    now = 0;
+    rudp_init(&a, -1, NULL, 0x3333, NULL, NULL);
+    rudp_set_output(&a, link_output, &to_nowhere);
+    TEST_CHECK(rudp_send(&a, msg, sizeof(msg), now) >= 0);
+    TEST_EQ_INT(rudp_poll(&a, now), RUDP_RTO_INIT_MS);
+    while (now < RUN_LIMIT_MS && (ret = rudp_poll(&a, now)) >= 0 && ret != RUDP_POLL_IDLE)
+    {
+        now++;
+    }
+    TEST_CHECK(ret < 0);
+    TEST_EQ_INT(a.stats.tx_retrans, RUDP_MAX_RETRIES);
+    TEST_EQ_INT(a.stats.give_up, 1);
+    TEST_EQ_INT(rudp_in_flight(&a), 0);
+    TEST_EQ_INT(rudp_poll(&a, now), RUDP_POLL_IDLE);
+}
+
+//窗口满和过长的消息
+static void test_send_limits(void)
+{
+    static rudp_t a;
+    link_dir_t to_nowhere = { NULL };
+    uint8_t msg[RUDP_MAX_PAYLOAD + 1] = { 0 };
+
+    link.loss_pct = 100;
+    rudp_init(&a, -1, NULL, 0x4444, NULL, NULL);
+    rudp_set_output(&a, link_output, &to_nowhere);
+    TEST_EQ_INT(rudp_send(&a, msg, sizeof(msg), 0), -2);
+    for (int i = 0; i < RUDP_WINDOW; i++)
+    {
+        TEST_EQ_INT(rudp_send(&a, msg, 1, 0), i);
+    }
+    TEST_EQ_INT(rudp_send(&a, msg, 1, 0), -1);
+    TEST_EQ_INT(rudp_in_flight(&a), RUDP_WINDOW);
+}
+
+int main(void)
+{
+    rudp_stats_t clean, lossy, reorder, dup, bad;
+    double g_clean, g_lossy, g_bad;
+
+    srand(1);
+    printf("udp_reliable, %d x %d byte messages, %d ms one-way delay:\n", MSG_NUM, MSG_LEN, LINK_DELAY_MS);
+    g_clean = run("lossless", (link_cfg_t){ 0, 0, 0 }, &clean);
+    g_lossy = run("5% loss", (link_cfg_t){ 5, 0, 0 }, &lossy);
+    run("reorder (jitter 8ms)", (link_cfg_t){ 0, 0, 8 }, &reorder);
+    run("10% duplicates", (link_cfg_t){ 0, 10, 0 }, &dup);
+    g_bad = run("10% loss+reorder+dup", (link_cfg_t){ 10, 5, 8 }, &bad);
+
+    //无损链路不应该有任何重传
+    TEST_EQ_INT(clean.tx_retrans + clean.tx_fast_retrans, 0);
+    TEST_EQ_INT(clean.tx_data, MSG_NUM);
+    //丢包后的空洞大多由SACK发现，快速重传，而不是等超时
+    TEST_CHECK(lossy.tx_fast_retrans > lossy.tx_retrans);
+    //5%丢包时有效吞吐至少保持无损时的一半，10%丢包加乱序、重复时至少保持十分之一
+    TEST_CHECK(g_lossy * 2 >= g_clean);
+    TEST_CHECK(g_bad * 10 >= g_clean);
+    TEST_CHECK(bad.tx_retrans + bad.tx_fast_retrans > 0);
+
+    test_give_up();
+    test_send_limits();
+    TEST_END();
+}
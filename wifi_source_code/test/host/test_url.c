@@ -0,0 +1,348 @@
+/*
+* @file         test_url.c
+* @brief        user_url的主机测试
+* @details      检查各段的切分、默认端口、IPv6主机以及每种错误码;
+*               按语法随机生成的URL解析出的各段和生成时的一致,
+*               随机改动后的URL解析成功时各段不越界、不重叠,各段之外只剩分隔符
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "user_url.h"
+#include "test.h"
+
+#define RANDOM_URLS     20000
+#define MUTATED_URLS    20000
+
+//检查url中的一段
+#define TEST_VIEW(url, v, lit)        TEST_EQ_MEM((url) + (v).off, (v).len, lit)
+
+//生成URL时记下的各段,没有的段为空串
+typedef struct
+{
+    char        url[1024];
+    char        scheme[16];
+    char        host[64];
+    char        port[8];
+    char        path[256];
+    char        query[256];
+    char        frag[256];
+    int         has_query;
+    int         port_num;
+} gen_url_t;
+
+static void test_full(void)
+{
+    const char *url = "https://api.seniverse.com:8443/v3/weather/now.json?key=k&location=ip#top";
+    url_t u;
+    TEST_EQ_INT(url_parse(url, &u), 0);
+    TEST_VIEW(url, u.scheme, "https");
+    TEST_VIEW(url, u.host, "api.seniverse.com");
+    TEST_VIEW(url, u.port, "8443");
+    TEST_VIEW(url, u.path, "/v3/weather/now.json");
+    TEST_VIEW(url, u.query, "key=k&location=ip");
+    TEST_VIEW(url, u.fragment, "top");
+    TEST_VIEW(url, u.target, "v3/weather/now.json?key=k&location=ip");
+    TEST_EQ_INT(u.port_num, 8443);
+}
+
+static void test_defaults(void)
+{
+    url_t u;
+    TEST_EQ_INT(url_parse("HTTPS://example.com", &u), 0);
+    TEST_EQ_INT(u.port_num, 443);
+    TEST_EQ_INT(u.path.len, 0);
+    TEST_EQ_INT(u.target.len, 0);
+    TEST_EQ_INT(url_parse("wss://example.com/ws", &u), 0);
+    TEST_EQ_INT(u.port_num, 443);
+    TEST_EQ_INT(url_parse("http://example.com:/", &u), 0);
+    TEST_EQ_INT(u.port_num, 80);
+    TEST_EQ_INT(u.port.len, 0);
+    TEST_EQ_INT(url_parse("ws://example.com?a=1", &u), 0);
+    TEST_EQ_INT(u.port_num, 80);
+    TEST_EQ_INT(u.query.len, 3);
+    TEST_EQ_INT(url_parse("mqtt://broker", &u), 0);
+    TEST_EQ_INT(u.port_num, 0);
+}
+
+static void test_ipv6(void)
+{
+    const char *url = "http://[fe80::1:2]:8080/x";
+    url_t u;
+    TEST_EQ_INT(url_parse(url, &u), 0);
+    TEST_VIEW(url, u.host, "fe80::1:2");
+    TEST_EQ_INT(u.port_num, 8080);
+    TEST_VIEW(url, u.target, "x");
+    TEST_EQ_INT(url_parse("http://[fe80::1/x", &u), URL_ERR_HOST);
+    TEST_EQ_INT(url_parse("http://[]/", &u), URL_ERR_HOST);
+}
+
+static void test_utf8_path(void)
+{
+    const char *url = "https://h/\xe5\x8c\x97\xe4\xba\xac";
+    url_t u;
+    TEST_EQ_INT(url_parse(url, &u), 0);
+    TEST_EQ_INT(u.path.len, 7);
+}
+
+static void test_errors(void)
+{
+    static char longer[URL_MAX_LEN + 16];
+    char host[URL_HOST_MAX_LEN + 16];
+    url_t u;
+    TEST_EQ_INT(url_parse(NULL, &u), URL_ERR_ARG);
+    TEST_EQ_INT(url_parse("https://h", NULL), URL_ERR_ARG);
+    TEST_EQ_INT(url_parse("", &u), URL_ERR_SCHEME);
+    TEST_EQ_INT(url_parse("1http://h", &u), URL_ERR_SCHEME);
+    TEST_EQ_INT(url_parse("https:/h", &u), URL_ERR_SCHEME);
+    TEST_EQ_INT(url_parse("https", &u), URL_ERR_SCHEME);
+    TEST_EQ_INT(url_parse("https://", &u), URL_ERR_HOST);
+    TEST_EQ_INT(url_parse("https://user@h/", &u), URL_ERR_HOST);
+    TEST_EQ_INT(url_parse("https://h:0/", &u), URL_ERR_PORT);
+    TEST_EQ_INT(url_parse("https://h:65536/", &u), URL_ERR_PORT);
+    TEST_EQ_INT(url_parse("https://h:80x/", &u), URL_ERR_PORT);
+    TEST_EQ_INT(url_parse("https://h:65535/", &u), 0);
+    TEST_EQ_INT(url_parse("https://h/a b", &u), URL_ERR_CHAR);
+    TEST_EQ_INT(url_parse("https://h/a\r\nHost: x", &u), URL_ERR_CHAR);
+    TEST_EQ_INT(url_parse("https://h/?q#a#b", &u), 0);
+    TEST_EQ_INT(url_parse("https://h/#\x7f", &u), URL_ERR_CHAR);
+    //主机名正好URL_HOST_MAX_LEN时可以,多一个字符不行
+    memcpy(host, "http://", 7);
+    memset(host + 7, 'a', URL_HOST_MAX_LEN);
+    host[7 + URL_HOST_MAX_LEN] = 0;
+    TEST_EQ_INT(url_parse(host, &u), 0);
+    host[7 + URL_HOST_MAX_LEN] = 'a';
+    host[8 + URL_HOST_MAX_LEN] = 0;
+    TEST_EQ_INT(url_parse(host, &u), URL_ERR_HOST);
+    memcpy(longer, "http://h/", 9);
+    memset(longer + 9, 'p', sizeof(longer) - 10);
+    longer[sizeof(longer) - 1] = 0;
+    TEST_EQ_INT(url_parse(longer, &u), URL_ERR_TOO_LONG);
+}
+
+//从set里随机取n个字符,set为NULL时取0x80~0xff
+static void gen_chars(unsigned *seed, char *out, int n, const char *set)
+{
+    size_t len = set != NULL ? strlen(set) : 0;
+    for (int i = 0; i < n; i++)
+    {
+        out[i] = set != NULL ? set[rand_r(seed) % len] : (char)(0x80 + rand_r(seed) % 0x80);
+    }
+    out[n] = 0;
+}
+
+//路径、查询串和片段里的字符:可见ASCII中去掉各自的结束符,偶尔夹UTF-8之类的高位字节
+static void gen_part(unsigned *seed, char *out, int max, const char *stops)
+{
+    char set[96];
+    int n = 0;
+    int len = rand_r(seed) % max;
+
+    for (int c = 0x21; c < 0x7f; c++)
+    {
+        if (strchr(stops, c) == NULL)
+        {
+            set[n++] = (char)c;
+        }
+    }
+    set[n] = 0;
+    for (int i = 0; i < len; i++)
+    {
+        gen_chars(seed, out + i, 1, rand_r(seed) % 8 ? set : NULL);
+    }
+    out[len] = 0;
+}
+
+//按语法生成一个合法的URL,各段同时记下来
+static void gen_url(unsigned *seed, gen_url_t *g)
+{
+    static const char *const schemes[] = { "http", "https", "ws", "wss", "HTTPS", "coap+tcp" };
+    static const int ports[] = { 80, 443, 80, 443, 443, 0 };
+    int s = rand_r(seed) % 6;
+    int ipv6 = 0;
+    int len;
+
+    memset(g, 0, sizeof(*g));
+    strcpy(g->scheme, schemes[s]);
+    g->port_num = ports[s];
+    switch (rand_r(seed) % 3)
+    {
+    case 0:
+        gen_chars(seed, g->host, 1 + rand_r(seed) % 40, "abcdefghijklmnopqrstuvwxyz0123456789-.");
+        break;
+    case 1:
+        sprintf(g->host, "%d.%d.%d.%d", rand_r(seed) % 256, rand_r(seed) % 256, rand_r(seed) % 256,
+                rand_r(seed) % 256);
+        break;
+    default:
+        gen_chars(seed, g->host, 1 + rand_r(seed) % 30, "0123456789abcdefABCDEF:.");
+        ipv6 = 1;
+        break;
+    }
+    switch (rand_r(seed) % 3)
+    {
+    case 0:
+        break;
+    case 1:
+        g->port_num = 1 + rand_r(seed) % 65535;
+        sprintf(g->port, "%d", g->port_num);
+        break;
+    default:
+        //只有冒号,端口按scheme取默认值
+        strcpy(g->port, ":");
+        break;
+    }
+    if (rand_r(seed) % 3)
+    {
+        g->path[0] = '/';
+        gen_part(seed, g->path + 1, 100, "?#");
+    }
+    if (rand_r(seed) % 2)
+    {
+        g->has_query = 1;
+        gen_part(seed, g->query, 100, "#");
+    }
+    if (rand_r(seed) % 3 == 0)
+    {
+        gen_part(seed, g->frag, 100, "");
+    }
+    len = sprintf(g->url, "%s://%s%s%s", g->scheme, ipv6 ? "[" : "", g->host, ipv6 ? "]" : "");
+    if (g->port[0] != 0)
+    {
+        len += sprintf(g->url + len, g->port[0] == ':' ? ":" : ":%s", g->port);
+    }
+    len += sprintf(g->url + len, "%s%s%s", g->path, g->has_query ? "?" : "", g->query);
+    if (g->frag[0] != 0)
+    {
+        sprintf(g->url + len, "#%s", g->frag);
+    }
+    if (g->port[0] == ':')
+    {
+        g->port[0] = 0;
+    }
+}
+
+//合法的URL解析出的各段和生成时一样,target是去掉开头'/'的路径加上查询串
+static void test_random(void)
+{
+    unsigned seed = 1;
+    char target[512];
+    gen_url_t g;
+    url_t u;
+
+    for (int i = 0; i < RANDOM_URLS; i++)
+    {
+        gen_url(&seed, &g);
+        TEST_EQ_INT(url_parse(g.url, &u), 0);
+        TEST_CHECK(u.scheme.len == strlen(g.scheme) && memcmp(g.url + u.scheme.off, g.scheme, u.scheme.len) == 0);
+        TEST_CHECK(u.host.len == strlen(g.host) && memcmp(g.url + u.host.off, g.host, u.host.len) == 0);
+        TEST_CHECK(u.port.len == strlen(g.port) && memcmp(g.url + u.port.off, g.port, u.port.len) == 0);
+        TEST_CHECK(u.path.len == strlen(g.path) && memcmp(g.url + u.path.off, g.path, u.path.len) == 0);
+        TEST_CHECK(u.query.len == strlen(g.query) && memcmp(g.url + u.query.off, g.query, u.query.len) == 0);
+        TEST_CHECK(u.fragment.len == strlen(g.frag) && memcmp(g.url + u.fragment.off, g.frag, u.fragment.len) == 0);
+        TEST_EQ_INT(u.port_num, g.port_num);
+        strcpy(target, g.path[0] != 0 ? g.path + 1 : "");
+        strcat(target, g.has_query ? "?" : "");
+        strcat(target, g.query);
+        TEST_CHECK(u.target.len == strlen(target) && memcmp(g.url + u.target.off, target, u.target.len) == 0);
+    }
+}
+
+//解析成功时:各段在URL之内且互不重叠,路径、查询串和片段里没有空格和控制字符,各段之外只有分隔符
+static int views_ok(const char *url, const url_t *u)
+{
+    const url_view_t *views[] = { &u->scheme, &u->host, &u->port, &u->path, &u->query, &u->fragment };
+    size_t len = strlen(url);
+    char covered[1024] = { 0 };
+    size_t gaps = 0;
+
+    for (size_t v = 0; v < sizeof(views) / sizeof(views[0]); v++)
+    {
+        if (views[v]->off + views[v]->len > len)
+        {
+            return 0;
+        }
+        for (size_t i = views[v]->off; i < (size_t)views[v]->off + views[v]->len; i++)
+        {
+            if (covered[i] || (v >= 3 && ((uint8_t)url[i] <= ' ' || url[i] == 0x7f)))
+            {
+                return 0;
+            }
+            covered[i] = 1;
+        }
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        //"://"、IPv6的方括号、端口前的':'、'?'和'#'
+        if (!covered[i] && (strchr(":/[]?#", url[i]) == NULL || ++gaps > 8))
+        {
+            return 0;
+        }
+    }
+    return u->target.off + u->target.len <= len;
+}
+
+//随机改动合法的URL:改字节、插入、删除、截断,解析不能越界,成功时结果自洽
+static void test_mutated(void)
+{
+    unsigned seed = 2;
+    gen_url_t g;
+    size_t len, pos;
+    url_t u;
+
+    for (int i = 0; i < MUTATED_URLS; i++)
+    {
+        gen_url(&seed, &g);
+        for (int m = 1 + rand_r(&seed) % 4; m > 0; m--)
+        {
+            len = strlen(g.url);
+            pos = rand_r(&seed) % (len + 1);
+            switch (rand_r(&seed) % 4)
+            {
+            case 0:
+                if (pos < len)
+                {
+                    g.url[pos] = (char)(1 + rand_r(&seed) % 255);
+                }
+                break;
+            case 1:
+                if (len + 1 < sizeof(g.url))
+                {
+                    memmove(g.url + pos + 1, g.url + pos, len - pos + 1);
+                    g.url[pos] = ":/[]?#@ %\r\n"[rand_r(&seed) % 11];
+                }
+                break;
+            case 2:
+                if (pos < len)
+                {
+                    memmove(g.url + pos, g.url + pos + 1, len - pos);
+                }
+                break;
+            default:
+                g.url[pos] = 0;
+                break;
+            }
+        }
+        if (url_parse(g.url, &u) == 0)
+        {
+            TEST_CHECK(views_ok(g.url, &u));
+        }
+    }
+}
+
+int main(void)
+{
+    test_full();
+    test_defaults();
+    test_ipv6();
+    test_utf8_path();
+    test_errors();
+    test_random();
+    test_mutated();
+    TEST_END();
+}
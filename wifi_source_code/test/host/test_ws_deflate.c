@@ -0,0 +1,491 @@
+/*
+* @file         test_ws_deflate.c
+* @brief        hx-ws的permessage-deflate测试
+* @details      1.握手协商：各种提议和参数组合的回复，不认识或重复的参数整个提议不接受
+*               2.和zlib互通：WS_deflate_compress的输出用zlib解压，zlib各级别和策略的输出用WS_deflate_inflate解压，
+*                 保留和不保留上文两种情况都是一串消息连续往返
+*               3.错误数据：放不下、坏块类型、随机数据不越界
+*               4.经过server：client用zlib压缩发送，WS_write_conn和WS_broadcast_data发回压缩帧，
+*                 短消息和超长消息不压缩，内存池用完时WS_write_conn改发不压缩的帧，压缩上文不乱
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include <zlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "WebSocket_Deflate.h"
+#include "ws_client.h"
+#include "test.h"
+
+#define WS_PORT         9998                        //和WebSocket_Task.c中的端口一致
+#define MSGS            200                         //往返测试的消息数
+#define FUZZ_RUNS       20000                       //随机数据解压次数
+#define BUF_L           (WS_MAX_MSG_LEN + 64)
+
+//main.c中定义的接收队列
+QueueHandle_t WebSocket_rx_queue;
+
+static const uint8_t tail[4] = { 0x00, 0x00, 0xff, 0xff };
+
+static void *server_thread(void *arg)
+{
+    ws_server(NULL);
+    return NULL;
+}
+
+//第seq条遥测消息，前后消息大部分字段相同，上文保留时压得更小
+static size_t telemetry(char *buf, size_t cap, int seq)
+{
+    static const char *states[] = { "idle", "heating", "cooling", "standby" };
+    return snprintf(buf, cap,
+                    "{\"device\":\"hx-sensor-%02d\",\"seq\":%d,\"temperature\":%d.%d,\"humidity\":%d,"
+                    "\"rssi\":-%d,\"state\":\"%s\",\"uptime\":%d}",
+                    seq % 4, seq, 20 + seq % 7, seq % 10, 40 + seq % 13, 50 + seq % 17, states[seq % 4], 1000 + seq * 5);
+}
+
+//zlib解压一条消息：补上00 00 ff ff，流在消息之间保留，不保留上文时调用者先reset
+static long zlib_inflate(z_stream *zs, const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    uint8_t *buf = malloc(len + 4);
+    int ret;
+
+    memcpy(buf, in, len);
+    memcpy(buf + len, tail, 4);
+    zs->next_in = buf;
+    zs->avail_in = len + 4;
+    zs->next_out = out;
+    zs->avail_out = cap;
+    ret = inflate(zs, Z_SYNC_FLUSH);
+    free(buf);
+    if ((ret != Z_OK && ret != Z_BUF_ERROR) || zs->avail_in != 0)
+    {
+        return -1;
+    }
+    return (long)(cap - zs->avail_out);
+}
+
+//zlib压缩一条消息：同步刷新后去掉结尾的00 00 ff ff
+static long zlib_deflate(z_stream *zs, const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    size_t n;
+
+    zs->next_in = (uint8_t *)in;
+    zs->avail_in = len;
+    zs->next_out = out;
+    zs->avail_out = cap;
+    if (deflate(zs, Z_SYNC_FLUSH) != Z_OK || zs->avail_in != 0)
+    {
+        return -1;
+    }
+    n = cap - zs->avail_out;
+    if (n < 4 || memcmp(out + n - 4, tail, 4) != 0)
+    {
+        return -1;
+    }
+    return (long)(n - 4);
+}
+
+//协商一个提议，返回WS_deflate_negotiate的结果，回复放在resp
+static int negotiate(WS_deflate_t *d, const char *ext, char *resp)
+{
+    char req[512];
+
+    snprintf(req, sizeof(req), "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n%s\r\n", ext);
+    return WS_deflate_negotiate(d, req, resp, WS_DEFLATE_RESP_L);
+}
+
+static void test_negotiate(void)
+{
+    static const struct
+    {
+        const char     *ext;                        //请求中的扩展头行，不带\r\n
+        const char     *resp;                       //期望的回复行，NULL表示不接受
+    } cases[] = {
+        { "Sec-WebSocket-Protocol: chat", NULL },
+        { "Sec-WebSocket-Extensions: permessage-deflate",
+          "Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover; server_max_window_bits=10\r\n" },
+        { "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits",
+          "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=10; client_max_window_bits=10\r\n" },
+        { "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=9; client_max_window_bits=12",
+          "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=9; client_max_window_bits=10\r\n" },
+        { "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_max_window_bits",
+          "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; server_max_window_bits=10; "
+          "client_max_window_bits=10\r\n" },
+        { "sec-websocket-extensions: PERMESSAGE-DEFLATE; Client_Max_Window_Bits=\"9\"",
+          "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=10; client_max_window_bits=9\r\n" },
+        //第一个提议不认识，第二个参数不认识，第三个可以
+        { "Sec-WebSocket-Extensions: x-webkit-deflate-frame, permessage-deflate; foo=1, "
+          "permessage-deflate; client_max_window_bits=15",
+          "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=10; client_max_window_bits=10\r\n" },
+        //分两行发
+        { "Sec-WebSocket-Extensions: permessage-deflate; foo\r\nSec-WebSocket-Extensions: permessage-deflate",
+          "Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover; server_max_window_bits=10\r\n" },
+        { "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; server_no_context_takeover", NULL },
+        { "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=16", NULL },
+        { "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits", NULL },
+        { "Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover=1", NULL },
+        { "Sec-WebSocket-Extensions: permessage-deflatex", NULL },
+    };
+    static WS_deflate_t d;
+    char resp[WS_DEFLATE_RESP_L];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        if (cases[i].resp == NULL)
+        {
+            TEST_EQ_INT(negotiate(&d, cases[i].ext, resp), 0);
+            TEST_EQ_INT(d.enabled, 0);
+            TEST_EQ_INT(resp[0], 0);
+            continue;
+        }
+        TEST_EQ_INT(negotiate(&d, cases[i].ext, resp), 1);
+        TEST_EQ_INT(d.enabled, 1);
+        if (strcmp(resp, cases[i].resp) != 0)
+        {
+            printf("  case %zu: %s", i, resp);
+            TEST_CHECK(!"unexpected response");
+        }
+    }
+}
+
+//WS_deflate_compress的一串消息用zlib解压，和原文一致
+static void compress_run(const char *ext, long *wire, long *raw)
+{
+    static WS_deflate_t d;
+    char resp[WS_DEFLATE_RESP_L];
+    char msg[512];
+    uint8_t z[WS_DEFLATE_MAX_IN];
+    uint8_t out[1024];
+    z_stream zs;
+    long n;
+    int zlen;
+    int takeover;
+
+    TEST_EQ_INT(negotiate(&d, ext, resp), 1);
+    takeover = d.server_takeover;
+    memset(&zs, 0, sizeof(zs));
+    inflateInit2(&zs, -15);
+    *wire = 0;
+    *raw = 0;
+    for (int seq = 0; seq < MSGS; seq++)
+    {
+        size_t len = telemetry(msg, sizeof(msg), seq);
+        zlen = WS_deflate_compress(&d, (uint8_t *)msg, len, z, sizeof(z));
+        TEST_CHECK(zlen > 0 && (size_t)zlen < len);
+        if (zlen <= 0)
+        {
+            break;
+        }
+        if (!takeover)
+        {
+            inflateReset(&zs);
+        }
+        n = zlib_inflate(&zs, z, zlen, out, sizeof(out));
+        TEST_EQ_INT(n, (long)len);
+        TEST_CHECK(n == (long)len && memcmp(out, msg, len) == 0);
+        WS_deflate_commit(&d, (uint8_t *)msg, len, zlen);
+        *wire += zlen;
+        *raw += len;
+    }
+    TEST_EQ_INT(d.tx_raw, *raw);
+    TEST_EQ_INT(d.tx_wire, *wire);
+    inflateEnd(&zs);
+}
+
+static void test_compress_zlib(void)
+{
+    static WS_deflate_t d;
+    char resp[WS_DEFLATE_RESP_L];
+    uint8_t in[WS_DEFLATE_MAX_IN + 1];
+    uint8_t z[WS_DEFLATE_MAX_IN];
+    long wire_keep, raw_keep, wire_reset, raw_reset;
+    unsigned seed = 7;
+
+    compress_run("Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits", &wire_keep, &raw_keep);
+    compress_run("Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover", &wire_reset, &raw_reset);
+    printf("  telemetry %ld B: %ld B with context takeover, %ld B without\n", raw_keep, wire_keep, wire_reset);
+    TEST_EQ_INT(raw_keep, raw_reset);
+    //保留上文时前一条消息可以当字典
+    TEST_CHECK(wire_keep < wire_reset);
+
+    //短消息、超长消息、压不小的随机数据都不压缩
+    negotiate(&d, "Sec-WebSocket-Extensions: permessage-deflate", resp);
+    for (size_t i = 0; i < sizeof(in); i++)
+    {
+        in[i] = rand_r(&seed);
+    }
+    TEST_EQ_INT(WS_deflate_compress(&d, in, WS_DEFLATE_MIN_LEN - 1, z, sizeof(z)), -1);
+    TEST_EQ_INT(WS_deflate_compress(&d, in, WS_DEFLATE_MAX_IN + 1, z, sizeof(z)), -1);
+    TEST_EQ_INT(WS_deflate_compress(&d, in, 1000, z, sizeof(z)), -1);
+    //输出缓存不够也不压缩
+    memset(in, 'a', 1000);
+    TEST_CHECK(WS_deflate_compress(&d, in, 1000, z, sizeof(z)) > 0);
+    TEST_EQ_INT(WS_deflate_compress(&d, in, 1000, z, 2), -1);
+}
+
+//zlib的一串消息用WS_deflate_inflate解压
+static void inflate_run(const char *ext, int level, int strategy)
+{
+    static WS_deflate_t d;
+    char resp[WS_DEFLATE_RESP_L];
+    char msg[WS_MAX_MSG_LEN];
+    uint8_t z[BUF_L];
+    uint8_t out[WS_MAX_MSG_LEN];
+    z_stream zs;
+    size_t len;
+    long zlen;
+    int n;
+    int takeover;
+
+    TEST_EQ_INT(negotiate(&d, ext, resp), 1);
+    takeover = d.client_takeover;
+    memset(&zs, 0, sizeof(zs));
+    //zlib的raw deflate不支持8位窗口，9和10都在server允许的范围内
+    deflateInit2(&zs, level, Z_DEFLATED, -d.client_wbits, 8, strategy);
+    for (int seq = 0; seq < MSGS / 4; seq++)
+    {
+        len = telemetry(msg, sizeof(msg), seq);
+        //每10条有一条长消息，跨过窗口，存储块超过64K以内的长度
+        if (seq % 10 == 9)
+        {
+            while (len < sizeof(msg) - 200)
+            {
+                len += telemetry(msg + len, sizeof(msg) - len, seq * 31 + len);
+            }
+        }
+        if (!takeover)
+        {
+            deflateReset(&zs);
+        }
+        zlen = zlib_deflate(&zs, (uint8_t *)msg, len, z, sizeof(z));
+        TEST_CHECK(zlen >= 0);
+        n = WS_deflate_inflate(&d, z, zlen, out, sizeof(out));
+        if (n != (int)len || memcmp(out, msg, len) != 0)
+        {
+            printf("  level %d strategy %d takeover %d seq %d: %d of %zu\n", level, strategy, takeover, seq, n, len);
+            TEST_CHECK(!"inflate mismatch");
+            break;
+        }
+    }
+    deflateEnd(&zs);
+}
+
+static void test_inflate_zlib(void)
+{
+    static const int strategies[] = { Z_DEFAULT_STRATEGY, Z_FIXED, Z_HUFFMAN_ONLY, Z_RLE, Z_FILTERED };
+    int failed = test_fails;
+
+    for (int level = 0; level <= 9 && failed == test_fails; level++)
+    {
+        for (size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++)
+        {
+            inflate_run("Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits", level, strategies[s]);
+            inflate_run("Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits=9", level, strategies[s]);
+            inflate_run("Sec-WebSocket-Extensions: permessage-deflate", level, strategies[s]);
+        }
+    }
+}
+
+static void test_inflate_errors(void)
+{
+    static WS_deflate_t d;
+    char resp[WS_DEFLATE_RESP_L];
+    uint8_t msg[4000];
+    uint8_t z[BUF_L];
+    uint8_t out[WS_MAX_MSG_LEN];
+    uint8_t junk[64];
+    z_stream zs;
+    long zlen;
+    unsigned seed = 11;
+    int n;
+    int bad = 0;
+    int rejected = 0;
+
+    negotiate(&d, "Sec-WebSocket-Extensions: permessage-deflate", resp);
+    memset(msg, 'x', sizeof(msg));
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, 6, Z_DEFLATED, -10, 8, Z_DEFAULT_STRATEGY);
+    zlen = zlib_deflate(&zs, msg, sizeof(msg), z, sizeof(z));
+    deflateEnd(&zs);
+    //放不下
+    TEST_EQ_INT(WS_deflate_inflate(&d, z, zlen, out, 1000), -2);
+    TEST_EQ_INT(WS_deflate_inflate(&d, z, zlen, out, sizeof(out)), (int)sizeof(msg));
+    //块类型11
+    junk[0] = 0x06;
+    TEST_EQ_INT(WS_deflate_inflate(&d, junk, 1, out, sizeof(out)), -1);
+    //截断的压缩数据
+    TEST_EQ_INT(WS_deflate_inflate(&d, z, zlen / 2, out, sizeof(out)), -1);
+
+    //随机数据：只能返回错误或者一段不超过输出缓存的原文，越界由ASan检查
+    for (int i = 0; i < FUZZ_RUNS; i++)
+    {
+        size_t len = rand_r(&seed) % sizeof(junk);
+        for (size_t j = 0; j < len; j++)
+        {
+            junk[j] = rand_r(&seed);
+        }
+        n = WS_deflate_inflate(&d, junk, len, out, 256);
+        bad += n < -2 || n > 256;
+        rejected += n < 0;
+    }
+    printf("  %d of %d random inputs rejected\n", rejected, FUZZ_RUNS);
+    TEST_EQ_INT(bad, 0);
+    TEST_CHECK(rejected > FUZZ_RUNS / 2);
+}
+
+//client收一帧压缩消息并用zlib解压，返回原文长度
+static long recv_deflated(int s, z_stream *zs, uint8_t *op, uint8_t *out, size_t cap)
+{
+    static uint8_t frame[BUF_L];
+    long len = ws_client_recv(s, op, frame, sizeof(frame), WS_CLIENT_WAIT_MS);
+
+    if (len < 0)
+    {
+        return -1;
+    }
+    if (!(*op & 0x40))
+    {
+        memcpy(out, frame, len);
+        return len;
+    }
+    return zlib_inflate(zs, frame, len, out, cap);
+}
+
+static void test_server(void)
+{
+    static uint8_t out[BUF_L];
+    WebSocket_frame_t f;
+    WebSocket_frame_t held[WS_POOL_NUM];
+    WS_client_stats_t st;
+    WS_pool_stats_t ps;
+    char msg[WS_DEFLATE_MAX_IN];
+    uint8_t z[BUF_L];
+    uint8_t frame[BUF_L];
+    char resp[512];
+    z_stream up, down;
+    struct netconn *conn = NULL;
+    uint8_t op;
+    size_t len;
+    long zlen;
+    long n;
+    int held_n = 0;
+    int s = ws_client_connect_ext(WS_PORT, "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n",
+                                  resp, sizeof(resp));
+
+    TEST_CHECK(s >= 0);
+    TEST_CHECK(strstr(resp, "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=10; "
+                            "client_max_window_bits=10\r\n") != NULL);
+    memset(&up, 0, sizeof(up));
+    memset(&down, 0, sizeof(down));
+    deflateInit2(&up, 6, Z_DEFLATED, -10, 8, Z_DEFAULT_STRATEGY);
+    inflateInit2(&down, -15);
+
+    //上行压缩，server解压交付；WS_write_conn按原帧类型发回压缩帧
+    for (int seq = 0; seq < MSGS / 4; seq++)
+    {
+        len = telemetry(msg, sizeof(msg), seq);
+        zlen = zlib_deflate(&up, (uint8_t *)msg, len, z, sizeof(z));
+        ws_client_send(s, seq % 5 == 4 ? 0xc2 : 0xc1, z, zlen);
+        TEST_CHECK(xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) == pdTRUE);
+        TEST_EQ_INT(f.frame_header.opcode, seq % 5 == 4 ? WS_OP_BIN : WS_OP_TXT);
+        TEST_EQ_INT(f.payload_length, len);
+        TEST_CHECK(memcmp(f.payload, msg, len) == 0);
+        conn = f.conenction;
+        TEST_EQ_INT(WS_write_conn(f.conenction, f.frame_header.opcode, f.payload, f.payload_length), ERR_OK);
+        WS_payload_release(f.payload);
+        n = recv_deflated(s, &down, &op, out, sizeof(out));
+        TEST_EQ_INT(op, seq % 5 == 4 ? 0xc2 : 0xc1);
+        TEST_CHECK(n == (long)len && memcmp(out, msg, len) == 0);
+    }
+
+    //广播也压缩；短消息和超长消息不压缩，不影响压缩上文
+    len = telemetry(msg, sizeof(msg), 1000);
+    TEST_EQ_INT(WS_broadcast_data(WS_OP_TXT, msg, len), 1);
+    n = recv_deflated(s, &down, &op, out, sizeof(out));
+    TEST_EQ_INT(op, 0xc1);
+    TEST_CHECK(n == (long)len && memcmp(out, msg, len) == 0);
+    TEST_EQ_INT(WS_write_conn(conn, WS_OP_TXT, "short", 5), ERR_OK);
+    TEST_EQ_INT(ws_client_recv(s, &op, frame, sizeof(frame), WS_CLIENT_WAIT_MS), 5);
+    TEST_EQ_INT(op, 0x81);
+    memset(z, 'L', WS_DEFLATE_MAX_IN + 1);
+    TEST_EQ_INT(WS_write_conn(conn, WS_OP_BIN, (char *)z, WS_DEFLATE_MAX_IN + 1), ERR_OK);
+    TEST_EQ_INT(ws_client_recv(s, &op, frame, sizeof(frame), WS_CLIENT_WAIT_MS), WS_DEFLATE_MAX_IN + 1);
+    TEST_EQ_INT(op, 0x82);
+
+    //收下的消息都不归还，占满内存池：WS_write_conn改发不压缩的帧
+    memset(msg, 'p', WS_POOL_BLOCK_L - 1);
+    while (held_n < WS_POOL_NUM)
+    {
+        ws_client_send(s, 0x82, msg, WS_POOL_BLOCK_L - 1);
+        if (xQueueReceive(WebSocket_rx_queue, &held[held_n], WS_CLIENT_WAIT_MS) != pdTRUE)
+        {
+            break;
+        }
+        held_n++;
+    }
+    WS_pool_get_stats(&ps);
+    TEST_EQ_INT(ps.in_use, WS_POOL_NUM);
+    len = telemetry(msg, sizeof(msg), 2000);
+    TEST_EQ_INT(WS_write_conn(conn, WS_OP_TXT, msg, len), ERR_OK);
+    n = recv_deflated(s, &down, &op, out, sizeof(out));
+    TEST_EQ_INT(op, 0x81);
+    TEST_CHECK(n == (long)len && memcmp(out, msg, len) == 0);
+    while (held_n > 0)
+    {
+        WS_payload_release(held[--held_n].payload);
+    }
+    len = telemetry(msg, sizeof(msg), 2001);
+    TEST_EQ_INT(WS_write_conn(conn, WS_OP_TXT, msg, len), ERR_OK);
+    n = recv_deflated(s, &down, &op, out, sizeof(out));
+    TEST_EQ_INT(op, 0xc1);
+    TEST_CHECK(n == (long)len && memcmp(out, msg, len) == 0);
+    WS_pool_get_stats(&ps);
+    TEST_EQ_INT(ps.in_use, 0);
+
+    TEST_EQ_INT(WS_client_get_stats(conn, &st), ERR_OK);
+    printf("  up %u -> %u B, down %u -> %u B\n", (unsigned)st.deflate_rx_raw, (unsigned)st.deflate_rx_wire,
+           (unsigned)st.deflate_tx_raw, (unsigned)st.deflate_tx_wire);
+    TEST_EQ_INT(st.deflate, 1);
+    TEST_CHECK(st.deflate_rx_wire > 0 && st.deflate_rx_wire < st.deflate_rx_raw);
+    TEST_CHECK(st.deflate_tx_wire > 0 && st.deflate_tx_wire < st.deflate_tx_raw);
+
+    //server只接受消息第一帧带RSV1，续帧带RSV1回1002
+    zlen = zlib_deflate(&up, (uint8_t *)msg, len, z, sizeof(z));
+    n = ws_client_frame(frame, 0x41, z, zlen / 2, WS_LEN_AUTO, 1);
+    n += ws_client_frame(frame + n, 0xc0, z + zlen / 2, zlen - zlen / 2, WS_LEN_AUTO, 1);
+    ws_client_send_raw(s, frame, n, 0);
+    TEST_EQ_INT(ws_client_recv(s, &op, frame, sizeof(frame), WS_CLIENT_WAIT_MS), 2);
+    TEST_EQ_INT(op, 0x88);
+    TEST_EQ_INT((frame[0] << 8) | frame[1], 1002);
+    deflateEnd(&up);
+    inflateEnd(&down);
+    close(s);
+}
+
+int main(void)
+{
+    pthread_t tid;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    WebSocket_rx_queue = xQueueCreate(WS_POOL_NUM, sizeof(WebSocket_frame_t));
+    pthread_create(&tid, NULL, server_thread, NULL);
+    pthread_detach(tid);
+
+    test_negotiate();
+    test_compress_zlib();
+    test_inflate_zlib();
+    test_inflate_errors();
+    test_server();
+    TEST_END();
+}
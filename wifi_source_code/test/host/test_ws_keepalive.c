@@ -0,0 +1,320 @@
+/*
+* @file         test_ws_keepalive.c
+* @brief        hx-ws保活和不响应客户端的测试
+* @details      ping间隔和空闲时间调小后：回pong的client有RTT统计，不说话的client收到几个ping后
+*               被1001关闭，没握手的连接到时被断开，只发数据不回pong的client不会被断开；
+*               client不再读数据时，另一个任务里卡在WS_write_conn上也不影响其他client的收发，
+*               空闲断开后卡住的WS_write_conn马上返回，关掉保活时WS_write_conn到WS_WRITE_TIMEOUT_MS超时返回
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "ws_client.h"
+#include "test.h"
+
+#define WS_PORT         9998                        //和WebSocket_Task.c中的端口一致
+#define PING_MS         100                         //测试用的ping间隔
+#define IDLE_MS         300                         //测试用的空闲断开时间
+#define PONG_DELAY_MS   2                           //client回pong前等待，RTT至少这么长
+#define SLACK_MS        500                         //定时判断的余量，ASan下线程调度会慢
+#define DEAD_MSG_L      8192                        //写给不读数据的client的消息长度
+
+//main.c中定义的接收队列
+QueueHandle_t WebSocket_rx_queue;
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void *server_thread(void *arg)
+{
+    ws_server(NULL);
+    return NULL;
+}
+
+//等到已握手的客户端数为n
+static void wait_clients(uint8_t n)
+{
+    for (int i = 0; i < 400 && WS_client_count() != n; i++)
+    {
+        usleep(5000);
+    }
+}
+
+//client发一条消息，从接收队列取回server这边的连接句柄
+static struct netconn *client_conn(int s)
+{
+    WebSocket_frame_t f;
+
+    ws_client_send(s, 0x82, "hi", 2);
+    if (xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) != pdTRUE)
+    {
+        return NULL;
+    }
+    WS_payload_release(f.payload);
+    return f.conenction;
+}
+
+//回pong的client：ping按原样回，RTT统计有值，连接一直在
+static void test_rtt(void)
+{
+    WS_client_stats_t st;
+    struct netconn *conn;
+    uint8_t buf[64];
+    uint8_t op;
+    long len;
+    long long end;
+    int s = ws_client_connect(WS_PORT);
+
+    conn = client_conn(s);
+    TEST_CHECK(conn != NULL);
+    end = now_ms() + 10 * PING_MS;
+    while (now_ms() < end)
+    {
+        len = ws_client_recv(s, &op, buf, sizeof(buf), 2 * PING_MS);
+        if (len < 0)
+        {
+            continue;
+        }
+        TEST_EQ_INT(op, 0x89);
+        TEST_EQ_INT(len, 4);
+        usleep(PONG_DELAY_MS * 1000);
+        ws_client_send(s, 0x8a, buf, len);
+    }
+    TEST_EQ_INT(WS_client_get_stats(conn, &st), ERR_OK);
+    printf("  %u pings, %u pongs, rtt %u us, srtt %u us, min %u us\n",
+           (unsigned)st.pings, (unsigned)st.pongs, (unsigned)st.rtt_us, (unsigned)st.srtt_us, (unsigned)st.rtt_min_us);
+    TEST_CHECK(st.pings >= 5);
+    //最后一个ping可能还没回
+    TEST_CHECK(st.pongs + 1 >= st.pings && st.pongs <= st.pings);
+    TEST_CHECK(st.rtt_min_us >= PONG_DELAY_MS * 1000);
+    TEST_CHECK(st.rtt_min_us <= st.rtt_us);
+    TEST_CHECK(st.srtt_us >= PONG_DELAY_MS * 1000);
+    TEST_CHECK(st.idle_ms < IDLE_MS);
+    TEST_EQ_INT(WS_client_count(), 1);
+
+    close(s);
+    wait_clients(0);
+    TEST_EQ_INT(WS_client_get_stats(conn, &st), ERR_CONN);
+}
+
+//握手后不说话的client：收到ping，IDLE_MS后收到1001关闭帧，连接断开
+static void test_silent(void)
+{
+    uint8_t buf[64];
+    uint8_t op = 0;
+    long len;
+    int pings = 0;
+    long long start = now_ms();
+    long long elapsed;
+    int s = ws_client_connect(WS_PORT);
+
+    while ((len = ws_client_recv(s, &op, buf, sizeof(buf), IDLE_MS + SLACK_MS)) >= 0 && op == 0x89)
+    {
+        TEST_EQ_INT(len, 4);
+        pings++;
+    }
+    elapsed = now_ms() - start;
+    TEST_EQ_INT(op, 0x88);
+    TEST_EQ_INT(len, 2);
+    TEST_EQ_INT((buf[0] << 8) | buf[1], 1001);
+    TEST_CHECK(ws_client_eof(s, WS_CLIENT_WAIT_MS));
+    TEST_CHECK(pings >= 2);
+    TEST_CHECK(elapsed >= IDLE_MS - 10 && elapsed < IDLE_MS + SLACK_MS);
+    close(s);
+    wait_clients(0);
+    TEST_EQ_INT(WS_client_count(), 0);
+}
+
+//连上不握手：不发ping，IDLE_MS后直接断开
+static void test_no_handshake(void)
+{
+    struct sockaddr_in addr;
+    long long start;
+    long long elapsed;
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(WS_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_EQ_INT(connect(s, (struct sockaddr *)&addr, sizeof(addr)), 0);
+    start = now_ms();
+    TEST_CHECK(ws_client_eof(s, IDLE_MS + SLACK_MS));
+    elapsed = now_ms() - start;
+    TEST_CHECK(elapsed >= IDLE_MS - 10 && elapsed < IDLE_MS + SLACK_MS);
+    close(s);
+}
+
+//不回pong但一直发数据的client：收到的都是ping，不会被断开
+static void test_data_keeps_alive(void)
+{
+    WebSocket_frame_t f;
+    uint8_t buf[64];
+    uint8_t op;
+    int pings = 0;
+    int other = 0;
+    int s = ws_client_connect(WS_PORT);
+
+    for (int i = 0; i < 4 * IDLE_MS / 50; i++)
+    {
+        ws_client_send(s, 0x81, "data", 4);
+        if (xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) == pdTRUE)
+        {
+            WS_payload_release(f.payload);
+        }
+        while (ws_client_recv(s, &op, buf, sizeof(buf), 50) >= 0)
+        {
+            pings += op == 0x89;
+            other += op != 0x89;
+        }
+    }
+    TEST_CHECK(pings >= 5);
+    TEST_EQ_INT(other, 0);
+    TEST_EQ_INT(WS_client_count(), 1);
+    close(s);
+    wait_clients(0);
+}
+
+struct writer
+{
+    struct netconn     *conn;
+    volatile long       frames;                     //写成功的帧数
+    volatile int        done;
+    err_t               result;                     //最后一次WS_write_conn的返回值
+    long long           ms;                         //最后一次WS_write_conn用的时间
+};
+
+//一直往不读数据的client写，直到WS_write_conn出错
+static void *writer_thread(void *arg)
+{
+    struct writer *w = (struct writer *)arg;
+    char *payload = malloc(DEAD_MSG_L);
+    long long start;
+
+    memset(payload, 'd', DEAD_MSG_L);
+    do
+    {
+        start = now_ms();
+        w->result = WS_write_conn(w->conn, WS_OP_BIN, payload, DEAD_MSG_L);
+        w->ms = now_ms() - start;
+    } while (w->result == ERR_OK && ++w->frames);
+    free(payload);
+    w->done = 1;
+    return NULL;
+}
+
+//等到写线程卡在发送缓存满上：帧数50ms不变
+static void wait_writer_stuck(struct writer *w)
+{
+    long last = -1;
+    while (!w->done && w->frames != last)
+    {
+        last = w->frames;
+        usleep(50000);
+    }
+}
+
+//不读数据的client：写线程卡住时其他client照常收发，空闲断开后写线程马上返回
+static void test_dead_reader(void)
+{
+    struct writer w = { 0 };
+    WebSocket_frame_t f;
+    uint8_t buf[64];
+    uint8_t op;
+    pthread_t tid;
+    long long start;
+    int dead = ws_client_connect(WS_PORT);
+    int live = ws_client_connect(WS_PORT);
+
+    //空闲时间放长，写线程先卡住一会
+    WS_set_keepalive(PING_MS, 4 * IDLE_MS);
+    w.conn = client_conn(dead);
+    pthread_create(&tid, NULL, writer_thread, &w);
+    wait_writer_stuck(&w);
+    TEST_CHECK(!w.done);
+    TEST_CHECK(w.frames > 0);
+
+    //server任务照常收消息，别的连接WS_write_conn不受影响，广播跳过被占住的连接
+    start = now_ms();
+    ws_client_send(live, 0x81, "still here", 10);
+    TEST_CHECK(xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) == pdTRUE);
+    TEST_EQ_INT(WS_write_conn(f.conenction, WS_OP_TXT, f.payload, f.payload_length), ERR_OK);
+    WS_payload_release(f.payload);
+    while (ws_client_recv(live, &op, buf, sizeof(buf), WS_CLIENT_WAIT_MS) >= 0 && op == 0x89)
+    {
+    }
+    TEST_EQ_INT(op, 0x81);
+    TEST_EQ_INT(WS_broadcast_data(WS_OP_TXT, "all", 3), 1);
+    TEST_CHECK(now_ms() - start < SLACK_MS);
+    TEST_CHECK(!w.done);
+
+    //dead空闲超时被断开，卡住的WS_write_conn看到关闭就返回，不用等到WS_WRITE_TIMEOUT_MS
+    pthread_join(tid, NULL);
+    TEST_EQ_INT(w.result, ERR_CONN);
+    TEST_CHECK(w.ms < WS_WRITE_TIMEOUT_MS);
+    close(live);
+    close(dead);
+    wait_clients(0);
+    WS_set_keepalive(PING_MS, IDLE_MS);
+}
+
+//关掉保活后不读数据的client：WS_write_conn到WS_WRITE_TIMEOUT_MS返回，帧写了一半的连接被关掉
+static void test_write_timeout(void)
+{
+    struct writer w = { 0 };
+    pthread_t tid;
+    int dead = ws_client_connect(WS_PORT);
+
+    WS_set_keepalive(0, 0);
+    w.conn = client_conn(dead);
+    pthread_create(&tid, NULL, writer_thread, &w);
+    pthread_join(tid, NULL);
+    TEST_CHECK(w.frames > 0);
+    TEST_CHECK(w.result == ERR_MEM || w.result == ERR_TIMEOUT);
+    TEST_CHECK(w.ms >= WS_WRITE_TIMEOUT_MS - 10 && w.ms < WS_WRITE_TIMEOUT_MS + SLACK_MS);
+    //帧写了一半时连接已不能用
+    if (w.result == ERR_MEM)
+    {
+        wait_clients(0);
+        TEST_EQ_INT(WS_client_count(), 0);
+    }
+    close(dead);
+    wait_clients(0);
+    WS_set_keepalive(PING_MS, IDLE_MS);
+}
+
+int main(void)
+{
+    pthread_t tid;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    WebSocket_rx_queue = xQueueCreate(10, sizeof(WebSocket_frame_t));
+    WS_set_keepalive(PING_MS, IDLE_MS);
+    pthread_create(&tid, NULL, server_thread, NULL);
+    pthread_detach(tid);
+
+    test_rtt();
+    test_silent();
+    test_no_handshake();
+    test_data_keeps_alive();
+    test_dead_reader();
+    test_write_timeout();
+    TEST_END();
+}
@@ -0,0 +1,122 @@
+/*
+* @file         test_ws_mask.c
+* @brief        hx-ws的WS_mask和逐字节参考实现对比
+* @details      长度0-99，src和dst各种对齐、各种掩码起始位置，原地和不原地；
+*               以及一段长数据随机切成多段、每段用上一段结束的位置接着解掩码
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "test.h"
+
+#define MAX_LEN         100                         //逐个长度对比的最大长度
+#define SPLIT_LEN       5000                        //随机切分测试的数据长度
+#define SPLIT_ROUNDS    200
+
+//WebSocket_Task.c引用的接收队列，这个测试不启动server
+QueueHandle_t WebSocket_rx_queue;
+
+static const uint8_t key[WS_MASK_L] = { 0x37, 0xfa, 0x21, 0x3d };
+
+//参考实现：RFC 6455 5.3节的定义
+static void ref_mask(uint8_t *dst, const uint8_t *src, size_t len, size_t offset)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        dst[i] = src[i] ^ key[(offset + i) % 4];
+    }
+}
+
+//所有长度、对齐和掩码起始位置，出错只报第一个
+static void test_alignments(void)
+{
+    static uint8_t src_buf[MAX_LEN + 8];
+    static uint8_t dst_buf[MAX_LEN + 8];
+    static uint8_t ref[MAX_LEN];
+    int fails = 0;
+
+    for (size_t len = 0; len < MAX_LEN && !fails; len++)
+    {
+        for (int sa = 0; sa < 4; sa++)
+        {
+            for (int da = 0; da < 4; da++)
+            {
+                for (size_t off = 0; off < 4; off++)
+                {
+                    uint8_t *src = src_buf + sa;
+                    uint8_t *dst = dst_buf + da;
+
+                    for (size_t i = 0; i < len; i++)
+                    {
+                        src[i] = (uint8_t)(i * 13 + len);
+                    }
+                    ref_mask(ref, src, len, off);
+                    //dst前后各放一个哨兵，不能写出界
+                    memset(dst_buf, 0xa5, sizeof(dst_buf));
+                    WS_mask(dst, src, len, key, off);
+                    if (memcmp(dst, ref, len) != 0 || (da > 0 && dst[-1] != 0xa5) || dst[len] != 0xa5)
+                    {
+                        printf("  out of place: len %zu src+%d dst+%d offset %zu\n", len, sa, da, off);
+                        fails++;
+                    }
+                    //原地
+                    WS_mask(src, src, len, key, off);
+                    if (memcmp(src, ref, len) != 0)
+                    {
+                        printf("  in place: len %zu src+%d offset %zu\n", len, sa, off);
+                        fails++;
+                    }
+                }
+            }
+        }
+    }
+    TEST_EQ_INT(fails, 0);
+}
+
+//一段数据随机切成多段，每段从上一段结束的位置接着解掩码，和整段一次的结果一样
+static void test_split(void)
+{
+    static uint8_t src[SPLIT_LEN];
+    static uint8_t dst[SPLIT_LEN];
+    static uint8_t ref[SPLIT_LEN];
+    unsigned seed = 7;
+    size_t pos, n;
+    int fails = 0;
+
+    for (size_t i = 0; i < SPLIT_LEN; i++)
+    {
+        src[i] = (uint8_t)rand_r(&seed);
+    }
+    ref_mask(ref, src, SPLIT_LEN, 0);
+    for (int r = 0; r < SPLIT_ROUNDS; r++)
+    {
+        memset(dst, 0, sizeof(dst));
+        for (pos = 0; pos < SPLIT_LEN; pos += n)
+        {
+            n = 1 + rand_r(&seed) % (r % 2 ? 64 : 1500);
+            if (n > SPLIT_LEN - pos)
+            {
+                n = SPLIT_LEN - pos;
+            }
+            WS_mask(dst + pos, src + pos, n, key, pos);
+        }
+        fails += memcmp(dst, ref, SPLIT_LEN) != 0;
+    }
+    TEST_EQ_INT(fails, 0);
+}
+
+int main(void)
+{
+    test_alignments();
+    test_split();
+    TEST_END();
+}
@@ -0,0 +1,275 @@
+/*
+* @file         test_ws_pool.c
+* @brief        hx-ws消息内存池压力测试
+* @details      WS_MAX_CLIENTS个client线程同时发随机长度、随机分片、中间插ping的消息，
+*               测试线程作接收任务随机地慢取队列，并额外持有一部分消息的引用：
+*               每条交付的消息内容正确，发送数=交付数+内存池不够丢弃数+队列满丢弃数，
+*               最后内存池全部归还；另外两个线程同时对一个正在使用的块反复retain/release
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "ws_client.h"
+#include "test.h"
+
+#define WS_PORT         9998                        //和WebSocket_Task.c中的端口一致
+#define MSGS            200                         //每个client发送的消息数
+#define MSG_HDR_L       3                           //消息开头：client编号和序号
+#define HELD_MAX        4                           //接收任务最多额外持有的消息数
+#define HAMMER_LOOPS    100000                      //每个线程retain/release的次数
+
+//main.c中定义的接收队列
+QueueHandle_t WebSocket_rx_queue;
+
+struct client
+{
+    int         id;
+    int         errors;                             //client线程里的错误，主线程检查
+};
+
+static volatile int clients_done;
+
+static void *server_thread(void *arg)
+{
+    ws_server(NULL);
+    return NULL;
+}
+
+//消息内容由client编号、序号和位置决定，接收方可以重新算出来比较
+static uint8_t msg_byte(int id, int seq, size_t i)
+{
+    return (uint8_t)(id * 31 + seq * 7 + i);
+}
+
+//多数消息放得进一个块，三成跨多个块
+static size_t msg_len(unsigned *seed)
+{
+    if (rand_r(seed) % 10 < 7)
+    {
+        return MSG_HDR_L + rand_r(seed) % (WS_POOL_BLOCK_L - MSG_HDR_L);
+    }
+    return MSG_HDR_L + rand_r(seed) % (WS_MAX_MSG_LEN - MSG_HDR_L + 1);
+}
+
+//client：随机分成1到4片发送，分片之间随机插ping，最后关闭并等server回关闭帧，
+//server按顺序处理，收到关闭帧时这个client的消息都已交付或丢弃
+static void *client_thread(void *arg)
+{
+    static const uint8_t closing[2] = { 0x03, 0xe8 };
+    struct client *c = (struct client *)arg;
+    unsigned seed = 1000 + c->id;
+    uint8_t *msg = malloc(WS_MAX_MSG_LEN);
+    uint8_t *frames = malloc(2 * WS_MAX_MSG_LEN);
+    uint8_t *rx = malloc(WS_MAX_MSG_LEN);
+    size_t len, pos, n, out;
+    int frags;
+    uint8_t op = 0;
+    int s = ws_client_connect(WS_PORT);
+
+    if (s < 0)
+    {
+        c->errors++;
+        goto done;
+    }
+    for (int seq = 0; seq < MSGS; seq++)
+    {
+        len = msg_len(&seed);
+        for (size_t i = 0; i < len; i++)
+        {
+            msg[i] = msg_byte(c->id, seq, i);
+        }
+        msg[0] = c->id;
+        msg[1] = seq >> 8;
+        msg[2] = seq;
+        frags = 1 + rand_r(&seed) % 4;
+        out = 0;
+        pos = 0;
+        for (int f = 0; f < frags; f++)
+        {
+            n = f == frags - 1 ? len - pos : (len - pos) * (rand_r(&seed) % 100) / 100;
+            //第一片带帧类型，后面是续帧，最后一片带FIN
+            out += ws_client_frame(frames + out, (f == frags - 1 ? 0x80 : 0) | (f == 0 ? 0x02 : 0x00),
+                                   msg + pos, n, WS_LEN_AUTO, 1);
+            pos += n;
+            if (f < frags - 1 && rand_r(&seed) % 3 == 0)
+            {
+                out += ws_client_frame(frames + out, 0x89, "pp", 2, WS_LEN_AUTO, 1);
+            }
+        }
+        if (ws_client_send_raw(s, frames, out, 1 + rand_r(&seed) % 3000) < 0)
+        {
+            c->errors++;
+            goto done;
+        }
+    }
+    ws_client_send(s, 0x88, closing, sizeof(closing));
+    //跳过pong，等关闭帧
+    while (ws_client_recv(s, &op, rx, WS_MAX_MSG_LEN, 5000) >= 0 && op != 0x88)
+    {
+    }
+    if (op != 0x88)
+    {
+        c->errors++;
+    }
+    close(s);
+done:
+    free(rx);
+    free(frames);
+    free(msg);
+    __atomic_add_fetch(&clients_done, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+//检查一条交付的消息：内容和client算出来的一样，带结束符
+static int msg_ok(const WebSocket_frame_t *f)
+{
+    int id, seq;
+
+    if (f->frame_header.opcode != WS_OP_BIN || f->payload_length < MSG_HDR_L || f->payload[f->payload_length] != 0)
+    {
+        return 0;
+    }
+    id = (uint8_t)f->payload[0];
+    seq = ((uint8_t)f->payload[1] << 8) | (uint8_t)f->payload[2];
+    for (size_t i = MSG_HDR_L; i < f->payload_length; i++)
+    {
+        if ((uint8_t)f->payload[i] != msg_byte(id, seq, i))
+        {
+            return 0;
+        }
+    }
+    return id < WS_MAX_CLIENTS && seq < MSGS;
+}
+
+//多client并发，接收任务随机慢取并持有引用
+static void test_stress(void)
+{
+    struct client clients[WS_MAX_CLIENTS];
+    pthread_t tids[WS_MAX_CLIENTS];
+    char *held[HELD_MAX];
+    int held_n = 0;
+    unsigned seed = 1;
+    long delivered = 0;
+    long bad = 0;
+    WS_pool_stats_t st;
+    WebSocket_frame_t f;
+    int i;
+
+    for (i = 0; i < WS_MAX_CLIENTS; i++)
+    {
+        clients[i].id = i;
+        clients[i].errors = 0;
+        pthread_create(&tids[i], NULL, client_thread, &clients[i]);
+    }
+    while (__atomic_load_n(&clients_done, __ATOMIC_SEQ_CST) < WS_MAX_CLIENTS || uxQueueMessagesWaiting(WebSocket_rx_queue) > 0)
+    {
+        if (xQueueReceive(WebSocket_rx_queue, &f, 10) != pdTRUE)
+        {
+            continue;
+        }
+        delivered++;
+        bad += !msg_ok(&f);
+        //三成消息多持有一会，像转交给另一个任务
+        if (rand_r(&seed) % 10 < 3)
+        {
+            if (held_n == HELD_MAX)
+            {
+                WS_payload_release(held[0]);
+                memmove(held, held + 1, sizeof(held[0]) * --held_n);
+            }
+            WS_payload_retain(f.payload);
+            held[held_n++] = f.payload;
+        }
+        WS_payload_release(f.payload);
+        //随机慢一点，让接收队列和内存池都有满的时候
+        if (rand_r(&seed) % 4 == 0)
+        {
+            usleep(rand_r(&seed) % 2000);
+        }
+    }
+    for (i = 0; i < WS_MAX_CLIENTS; i++)
+    {
+        pthread_join(tids[i], NULL);
+        TEST_EQ_INT(clients[i].errors, 0);
+    }
+    while (held_n > 0)
+    {
+        WS_payload_release(held[--held_n]);
+    }
+
+    WS_pool_get_stats(&st);
+    printf("  %ld delivered, %u exhausted, %u queue full, high water %u of %d blocks\n",
+           delivered, (unsigned)st.exhausted, (unsigned)st.queue_full, st.high_water, WS_POOL_NUM);
+    TEST_EQ_INT(bad, 0);
+    TEST_CHECK(delivered > 0);
+    TEST_EQ_INT(delivered + st.exhausted + st.queue_full, WS_MAX_CLIENTS * MSGS);
+    TEST_CHECK(st.high_water <= WS_POOL_NUM);
+    TEST_EQ_INT(st.in_use, 0);
+}
+
+static void *hammer_thread(void *arg)
+{
+    char *payload = (char *)arg;
+    for (int i = 0; i < HAMMER_LOOPS; i++)
+    {
+        WS_payload_retain(payload);
+        WS_payload_release(payload);
+    }
+    return NULL;
+}
+
+//两个线程同时对一个正在使用的块retain/release，结束后还是一个引用；重复释放不处理
+static void test_hammer(void)
+{
+    WS_pool_stats_t st;
+    WebSocket_frame_t f;
+    pthread_t t1, t2;
+    int s = ws_client_connect(WS_PORT);
+
+    ws_client_send(s, 0x82, "live", 4);
+    if (xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) != pdTRUE)
+    {
+        TEST_CHECK(!"message not received");
+        close(s);
+        return;
+    }
+    pthread_create(&t1, NULL, hammer_thread, f.payload);
+    pthread_create(&t2, NULL, hammer_thread, f.payload);
+    pthread_join(t1, NULL);
+    pthread_join(t2, NULL);
+    WS_pool_get_stats(&st);
+    TEST_EQ_INT(st.in_use, 1);
+    TEST_EQ_MEM(f.payload, f.payload_length, "live");
+
+    WS_payload_release(f.payload);
+    WS_payload_release(f.payload);
+    WS_pool_get_stats(&st);
+    TEST_EQ_INT(st.in_use, 0);
+    close(s);
+}
+
+int main(void)
+{
+    pthread_t tid;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    WebSocket_rx_queue = xQueueCreate(10, sizeof(WebSocket_frame_t));
+    pthread_create(&tid, NULL, server_thread, NULL);
+    pthread_detach(tid);
+
+    test_stress();
+    test_hammer();
+    TEST_END();
+}
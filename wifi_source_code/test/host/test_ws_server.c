@@ -0,0 +1,402 @@
+/*
+* @file         test_ws_server.c
+* @brief        hx-ws的websocket server回环测试
+* @details      ws_server跑在一个线程里，netconn由stub/netconn.c用主机socket实现，测试用ws_client.h作client：
+*               握手、7/16/64位长度、分片重组和插在中间的ping、各种协议错误的关闭码、
+*               按帧类型回发；服务端收到的数据按1字节、5字节和不切分的pbuf喂给解析器。
+*               多客户端：回发给发送者、广播、连接表满和位置复用、不读数据的慢客户端不阻塞其他客户端
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lwip/api.h"
+#include "WebSocket_Task.h"
+#include "ws_client.h"
+#include "test.h"
+
+#define WS_PORT         9998                        //和WebSocket_Task.c中的端口一致
+#define BIG_LEN         5000                        //用64位长度发送的消息长度
+#define SLOW_MSGS       4000                        //慢客户端测试广播的消息数，要超过主机socket缓存
+#define SLOW_MSG_LEN    8192
+
+//main.c中定义的接收队列
+QueueHandle_t WebSocket_rx_queue;
+
+static uint8_t frame_buf[3 * 70000];
+static uint8_t rx_buf[70000];
+
+struct drainer
+{
+    int         sock;
+    long        frames;                             //收到的完整帧数
+};
+
+static void *server_thread(void *arg)
+{
+    ws_server(NULL);
+    return NULL;
+}
+
+//一直收帧，500ms没有数据或连接断开时结束
+static void *drain_thread(void *arg)
+{
+    static uint8_t buf[SLOW_MSG_LEN];
+    struct drainer *d = (struct drainer *)arg;
+    uint8_t op;
+    d->frames = 0;
+    while (ws_client_recv(d->sock, &op, buf, sizeof(buf), 500) >= 0)
+    {
+        //保活ping不算
+        d->frames += op != 0x89;
+    }
+    return NULL;
+}
+
+//等到已握手的客户端数为n，server要收到对端关闭才会从连接表摘掉
+static int wait_clients(uint8_t n)
+{
+    for (int i = 0; i < 400 && WS_client_count() != n; i++)
+    {
+        usleep(5000);
+    }
+    return WS_client_count();
+}
+
+//从接收队列取一条消息，检查帧类型和内容，payload由测试归还内存池
+static void expect_msg(uint8_t opcode, const void *data, size_t len)
+{
+    WebSocket_frame_t f;
+    if (xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) != pdTRUE)
+    {
+        TEST_CHECK(!"message not received");
+        return;
+    }
+    TEST_EQ_INT(f.frame_header.opcode, opcode);
+    TEST_EQ_INT(f.frame_header.FIN, 1);
+    TEST_EQ_INT(f.payload_length, len);
+    TEST_CHECK(len == 0 || memcmp(f.payload, data, len) == 0);
+    //接收任务可以把payload当字符串用
+    TEST_EQ_INT(f.payload[len], 0);
+    WS_payload_release(f.payload);
+}
+
+//收server发来的一帧，检查帧类型和内容
+static void expect_frame(int sock, uint8_t hdr0, const void *data, size_t len)
+{
+    uint8_t op = 0;
+    long n = ws_client_recv(sock, &op, rx_buf, sizeof(rx_buf), WS_CLIENT_WAIT_MS);
+    TEST_EQ_INT(op, hdr0);
+    TEST_EQ_INT(n, len);
+    TEST_CHECK(n == (long)len && memcmp(rx_buf, data, len) == 0);
+}
+
+//收关闭帧，检查状态码，然后server断开连接
+static void expect_close(int sock, uint16_t code)
+{
+    uint8_t payload[2] = { code >> 8, code & 0xff };
+    expect_frame(sock, 0x88, payload, 2);
+    TEST_CHECK(ws_client_eof(sock, WS_CLIENT_WAIT_MS));
+}
+
+//握手：Sec-WebSocket-Accept按RFC 6455的例子计算
+static void test_handshake(void)
+{
+    int s = ws_client_connect(WS_PORT);
+    TEST_CHECK(s >= 0);
+    close(s);
+}
+
+//一段包含各种长度编码、分片和ping的字节流，按chunk切开发送，server按pbuf_len切开解析
+static void test_messages(u16_t pbuf_len, size_t chunk)
+{
+    static uint8_t bin[300];
+    static uint8_t big[BIG_LEN];
+    uint8_t closing[2] = { 0x03, 0xe8 };
+    size_t len = 0;
+    int s = ws_client_connect(WS_PORT);
+
+    host_pbuf_len = pbuf_len;
+    for (int i = 0; i < (int)sizeof(bin); i++)
+    {
+        bin[i] = (uint8_t)(i * 7);                  //带0字节
+    }
+    memset(big, 'b', sizeof(big));
+    len += ws_client_frame(frame_buf + len, 0x81, "hello", 5, WS_LEN_AUTO, 1);
+    len += ws_client_frame(frame_buf + len, 0x82, bin, sizeof(bin), WS_LEN_AUTO, 1);
+    len += ws_client_frame(frame_buf + len, 0x81, big, sizeof(big), WS_LEN_64, 1);
+    //分片消息中间插一个ping
+    len += ws_client_frame(frame_buf + len, 0x01, "frag-", 5, WS_LEN_AUTO, 1);
+    len += ws_client_frame(frame_buf + len, 0x89, "p1", 2, WS_LEN_AUTO, 1);
+    len += ws_client_frame(frame_buf + len, 0x00, "ment", 4, WS_LEN_16, 1);
+    len += ws_client_frame(frame_buf + len, 0x80, "ed", 2, WS_LEN_AUTO, 1);
+    len += ws_client_frame(frame_buf + len, 0x82, NULL, 0, WS_LEN_AUTO, 1);
+    TEST_EQ_INT(ws_client_send_raw(s, frame_buf, len, chunk), 0);
+
+    expect_msg(WS_OP_TXT, "hello", 5);
+    expect_msg(WS_OP_BIN, bin, sizeof(bin));
+    expect_msg(WS_OP_TXT, big, sizeof(big));
+    expect_frame(s, 0x8a, "p1", 2);
+    expect_msg(WS_OP_TXT, "frag-mented", 11);
+    expect_msg(WS_OP_BIN, NULL, 0);
+
+    //client关闭，server回1000后断开
+    ws_client_send(s, 0x88, closing, sizeof(closing));
+    expect_close(s, 1000);
+    close(s);
+    host_pbuf_len = 0;
+}
+
+//协议错误：server回对应的关闭码后断开，不向接收队列提交消息
+static void test_violations(void)
+{
+    static const struct
+    {
+        const char  *name;
+        uint8_t     hdr0;
+        uint8_t     hdr0_2;                         //非0时在前面先发一个不结束的文本分片
+        size_t      len;
+        int         len_mode;
+        int         masked;
+        uint16_t    code;
+    } cases[] = {
+        { "unmasked",                   0x81, 0,    2,     WS_LEN_AUTO, 0, 1002 },
+        { "rsv1",                       0xc1, 0,    2,     WS_LEN_AUTO, 1, 1002 },
+        { "reserved opcode",            0x83, 0,    2,     WS_LEN_AUTO, 1, 1002 },
+        { "continuation first",         0x80, 0,    2,     WS_LEN_AUTO, 1, 1002 },
+        { "text inside fragments",      0x81, 0x01, 2,     WS_LEN_AUTO, 1, 1002 },
+        { "fragmented ping",            0x09, 0,    2,     WS_LEN_AUTO, 1, 1002 },
+        { "long ping",                  0x89, 0,    126,   WS_LEN_AUTO, 1, 1002 },
+        { "too big",                    0x82, 0,    9000,  WS_LEN_AUTO, 1, 1009 },
+        { "too big in fragments",       0x80, 0x02, 5000,  WS_LEN_AUTO, 1, 1009 },
+    };
+    static uint8_t data[9000];
+    WebSocket_frame_t f;
+    size_t len;
+    int fails;
+    int s;
+
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        fails = test_fails;
+        s = ws_client_connect(WS_PORT);
+        len = 0;
+        if (cases[i].hdr0_2)
+        {
+            len += ws_client_frame(frame_buf, cases[i].hdr0_2, data, cases[i].len, WS_LEN_AUTO, 1);
+        }
+        len += ws_client_frame(frame_buf + len, cases[i].hdr0, data, cases[i].len, cases[i].len_mode, cases[i].masked);
+        ws_client_send_raw(s, frame_buf, len, 0);
+        expect_close(s, cases[i].code);
+        if (test_fails != fails)
+        {
+            printf("  case: %s\n", cases[i].name);
+        }
+        close(s);
+    }
+
+    //64位长度最高位为1：帧头收齐后就关闭
+    s = ws_client_connect(WS_PORT);
+    len = ws_client_frame(frame_buf, 0x82, data, 2, WS_LEN_64, 1);
+    frame_buf[2] |= 0x80;
+    ws_client_send_raw(s, frame_buf, 14, 0);
+    expect_close(s, 1002);
+    close(s);
+    TEST_EQ_INT(xQueueReceive(WebSocket_rx_queue, &f, 0), pdFALSE);
+}
+
+//发送：调用者指定帧类型，超过125和65535字节时用16/64位长度；收到的消息按原帧类型回发
+static void test_write(void)
+{
+    static uint8_t big[70000];
+    uint8_t bin[300];
+    WebSocket_frame_t f;
+    int s = ws_client_connect(WS_PORT);
+    int i;
+
+    for (i = 0; i < (int)sizeof(bin); i++)
+    {
+        bin[i] = (uint8_t)i;
+    }
+    memset(big, 'x', sizeof(big));
+    //先收到一条消息，server已经进入数据接收
+    ws_client_send(s, 0x82, bin, sizeof(bin));
+    TEST_EQ_INT(xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS), pdTRUE);
+    //和main.c一样按收到的帧类型回发给发送者
+    TEST_EQ_INT(WS_write_conn(f.conenction, f.frame_header.opcode, f.payload, f.payload_length), ERR_OK);
+    WS_payload_release(f.payload);
+    expect_frame(s, 0x82, bin, sizeof(bin));
+
+    TEST_EQ_INT(WS_write_data(WS_OP_TXT, "hi", 2), ERR_OK);
+    expect_frame(s, 0x81, "hi", 2);
+    TEST_EQ_INT(WS_write_data(WS_OP_TXT, (char *)big, sizeof(big)), ERR_OK);
+    expect_frame(s, 0x81, big, sizeof(big));
+    //控制帧不能由调用者发送
+    TEST_EQ_INT(WS_write_data(WS_OP_PIN, "x", 1), ERR_ARG);
+    TEST_EQ_INT(WS_write_data(WS_OP_CLS, "x", 1), ERR_ARG);
+    TEST_EQ_INT(WS_write_conn(f.conenction, WS_OP_PON, "x", 1), ERR_ARG);
+    TEST_EQ_INT(WS_broadcast_data(WS_OP_CON, "x", 1), -1);
+
+    //连接关闭后返回ERR_CONN
+    close(s);
+    for (i = 0; i < 200 && WS_write_data(WS_OP_TXT, "x", 1) != ERR_CONN; i++)
+    {
+        usleep(5000);
+    }
+    TEST_EQ_INT(WS_write_data(WS_OP_TXT, "x", 1), ERR_CONN);
+}
+
+//多客户端：回发只给发送者，广播发给所有客户端，断开的客户端不能再写
+static void test_multi(void)
+{
+    static const char *names[] = { "c0", "c1", "c2" };
+    struct netconn *conns[3];
+    WebSocket_frame_t f;
+    int s[3];
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        s[i] = ws_client_connect(WS_PORT);
+        TEST_CHECK(s[i] >= 0);
+    }
+    TEST_EQ_INT(wait_clients(3), 3);
+    for (i = 0; i < 3; i++)
+    {
+        ws_client_send(s[i], 0x81, names[i], 2);
+        if (xQueueReceive(WebSocket_rx_queue, &f, WS_CLIENT_WAIT_MS) != pdTRUE)
+        {
+            TEST_CHECK(!"message not received");
+            continue;
+        }
+        conns[i] = f.conenction;
+        TEST_CHECK(f.payload_length == 2 && memcmp(f.payload, names[i], 2) == 0);
+        TEST_EQ_INT(WS_write_conn(f.conenction, f.frame_header.opcode, f.payload, f.payload_length), ERR_OK);
+        WS_payload_release(f.payload);
+        expect_frame(s[i], 0x81, names[i], 2);
+    }
+    //其他客户端没有收到回发
+    for (i = 0; i < 3; i++)
+    {
+        TEST_CHECK(!ws_client_readable(s[i], 50));
+    }
+    TEST_EQ_INT(WS_broadcast_data(WS_OP_BIN, "all", 3), 3);
+    for (i = 0; i < 3; i++)
+    {
+        expect_frame(s[i], 0x82, "all", 3);
+    }
+
+    //断开一个客户端，它的连接不能再写，广播只发给剩下的
+    close(s[1]);
+    TEST_EQ_INT(wait_clients(2), 2);
+    TEST_EQ_INT(WS_write_conn(conns[1], WS_OP_TXT, "x", 1), ERR_CONN);
+    TEST_EQ_INT(WS_write_data(WS_OP_TXT, "two", 3), ERR_OK);
+    expect_frame(s[0], 0x81, "two", 3);
+    expect_frame(s[2], 0x81, "two", 3);
+    close(s[0]);
+    close(s[2]);
+    TEST_EQ_INT(wait_clients(0), 0);
+    TEST_EQ_INT(WS_write_data(WS_OP_TXT, "x", 1), ERR_CONN);
+}
+
+//连接表满时新连接被直接关闭，空出位置后可以再连
+static void test_table_full(void)
+{
+    int s[WS_MAX_CLIENTS];
+    int i;
+
+    for (i = 0; i < WS_MAX_CLIENTS; i++)
+    {
+        s[i] = ws_client_connect(WS_PORT);
+        TEST_CHECK(s[i] >= 0);
+    }
+    TEST_EQ_INT(wait_clients(WS_MAX_CLIENTS), WS_MAX_CLIENTS);
+    TEST_EQ_INT(ws_client_connect(WS_PORT), -1);
+
+    close(s[0]);
+    TEST_EQ_INT(wait_clients(WS_MAX_CLIENTS - 1), WS_MAX_CLIENTS - 1);
+    s[0] = ws_client_connect(WS_PORT);
+    TEST_CHECK(s[0] >= 0);
+    TEST_EQ_INT(wait_clients(WS_MAX_CLIENTS), WS_MAX_CLIENTS);
+    TEST_EQ_INT(WS_broadcast_data(WS_OP_TXT, "full", 4), WS_MAX_CLIENTS);
+    for (i = 0; i < WS_MAX_CLIENTS; i++)
+    {
+        expect_frame(s[i], 0x81, "full", 4);
+        close(s[i]);
+    }
+    TEST_EQ_INT(wait_clients(0), 0);
+}
+
+//慢客户端：不读数据的客户端发送缓存满后跳过这条消息或者被断开(帧写了一半)，
+//广播不阻塞，另一个客户端照常接收；两个客户端收到的完整帧数等于广播的返回值之和
+static void test_slow_client(void)
+{
+    static uint8_t msg[SLOW_MSG_LEN];
+    struct drainer d;
+    pthread_t tid;
+    long delivered = 0;
+    long skipped = 0;
+    long slow_frames = 0;
+    uint8_t op;
+    int slow = ws_client_connect(WS_PORT);
+    int ret;
+
+    d.sock = ws_client_connect(WS_PORT);
+    TEST_EQ_INT(wait_clients(2), 2);
+    memset(msg, 's', sizeof(msg));
+    pthread_create(&tid, NULL, drain_thread, &d);
+    for (int i = 0; i < SLOW_MSGS; i++)
+    {
+        ret = WS_broadcast_data(WS_OP_BIN, (char *)msg, sizeof(msg));
+        delivered += ret;
+        skipped += 2 - ret;
+    }
+    TEST_CHECK(skipped > 0);
+    pthread_join(tid, NULL);
+    while (ws_client_recv(slow, &op, rx_buf, sizeof(rx_buf), 200) >= 0)
+    {
+        TEST_EQ_INT(op, 0x82);
+        slow_frames++;
+    }
+    TEST_CHECK(d.frames > 0);
+    TEST_EQ_INT(d.frames + slow_frames, delivered);
+    close(slow);
+    close(d.sock);
+    TEST_EQ_INT(wait_clients(0), 0);
+}
+
+int main(void)
+{
+    static const struct
+    {
+        u16_t   pbuf_len;
+        size_t  chunk;
+    } splits[] = { { 0, 0 }, { 1, 0 }, { 5, 0 }, { 0, 1 }, { 0, 7 } };
+    pthread_t tid;
+
+    //lwip没有SIGPIPE，主机上往已关闭的连接发送时只要返回错误
+    signal(SIGPIPE, SIG_IGN);
+    WebSocket_rx_queue = xQueueCreate(10, sizeof(WebSocket_frame_t));
+    pthread_create(&tid, NULL, server_thread, NULL);
+    pthread_detach(tid);
+
+    test_handshake();
+    for (int i = 0; i < (int)(sizeof(splits) / sizeof(splits[0])); i++)
+    {
+        test_messages(splits[i].pbuf_len, splits[i].chunk);
+    }
+    test_violations();
+    test_write();
+    test_multi();
+    test_table_full();
+    test_slow_client();
+    TEST_END();
+}
@@ -0,0 +1,367 @@
+/*
+* @file         tls_server.h
+* @brief        主机测试用的本地TLS服务器,代替HTTPS服务器和云端
+* @details      OpenSSL实现,启动时生成自签名证书,监听127.0.0.1和::1的随机端口,每个连接一个线程,
+*               握手后交给调用者的处理函数;可以分别开关session ticket和session id缓存,
+*               统计握手成功的连接数和其中恢复会话的个数,和客户端自己的统计对照。
+*               tls_server_http是一个最小的HTTP/1.1处理函数,按路径决定响应的结束方式,
+*               可以模拟服务器处理耗时以及每个连接只服务几个请求就关闭
+* @author       Helon_Chan
+* @par Copyright (c):
+*               红旭无线开发团队
+* @par History:
+*               Ver0.0.1:
+                     Helon_Chan, 2026/10/17, 初始化版本\n
+*/
+#ifndef __HOST_TLS_SERVER_H__
+#define __HOST_TLS_SERVER_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/evp.h>
+
+#define TLS_SERVER_HEAD_L       2048                    //请求头最大长度
+
+typedef struct tls_server tls_server_t;
+
+//握手成功后在连接线程里调用,返回后服务器发close_notify并关闭连接
+typedef void (*tls_server_handler_t)(tls_server_t *s, SSL *ssl);
+
+struct tls_server
+{
+    int                     sock;                       //监听socket
+    uint16_t                port;
+    char                    port_str[8];                //给mbedtls_net_connect用的端口
+    SSL_CTX                *ctx;
+    tls_server_handler_t    handler;
+    void                   *arg;                        //给处理函数用
+    pthread_t               tid;
+    int                     active;                     //还没结束的连接线程数
+    int                     accepted;                   //握手成功的连接数
+    int                     resumed;                    //其中恢复会话的连接数
+    int                     requests;                   //tls_server_http处理的请求数
+    int                     silent_close;               //关闭时不发close_notify,像掉电或中间设备丢了连接
+    int                     conn_requests;              //tls_server_http每个连接最多处理的请求数,0不限
+    int                     announce_close;             //连接的最后一个响应带Connection: close
+    int                     work_us;                    //tls_server_http处理每个请求的耗时
+    char                    host[128];                  //tls_server_http收到的最后一个请求的Host请求头
+};
+
+struct tls_server_conn
+{
+    tls_server_t           *s;
+    int                     sock;
+};
+
+//生成一次自签名证书,所有服务器共用
+static inline void tls_server_cert(EVP_PKEY **key, X509 **cert)
+{
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static EVP_PKEY *k;
+    static X509 *c;
+    X509_NAME *name;
+
+    pthread_mutex_lock(&lock);
+    if (k == NULL)
+    {
+        k = EVP_EC_gen("P-256");
+        c = X509_new();
+        X509_set_version(c, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(c), 1);
+        X509_gmtime_adj(X509_getm_notBefore(c), 0);
+        X509_gmtime_adj(X509_getm_notAfter(c), 86400);
+        X509_set_pubkey(c, k);
+        name = X509_get_subject_name(c);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+        X509_set_issuer_name(c, name);
+        X509_sign(c, k, EVP_sha256());
+    }
+    pthread_mutex_unlock(&lock);
+    *key = k;
+    *cert = c;
+}
+
+static inline void *tls_server_conn_thread(void *arg)
+{
+    struct tls_server_conn *conn = (struct tls_server_conn *)arg;
+    tls_server_t *s = conn->s;
+    SSL *ssl = SSL_new(s->ctx);
+
+    SSL_set_fd(ssl, conn->sock);
+    if (SSL_accept(ssl) == 1)
+    {
+        __atomic_add_fetch(&s->accepted, 1, __ATOMIC_SEQ_CST);
+        if (SSL_session_reused(ssl))
+        {
+            __atomic_add_fetch(&s->resumed, 1, __ATOMIC_SEQ_CST);
+        }
+        s->handler(s, ssl);
+        if (!__atomic_load_n(&s->silent_close, __ATOMIC_SEQ_CST))
+        {
+            SSL_shutdown(ssl);
+        }
+    }
+    SSL_free(ssl);
+    close(conn->sock);
+    free(conn);
+    __atomic_sub_fetch(&s->active, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static inline void *tls_server_accept_thread(void *arg)
+{
+    tls_server_t *s = (tls_server_t *)arg;
+    struct tls_server_conn *conn;
+    pthread_t tid;
+    int sock;
+    int on = 1;
+
+    while ((sock = accept(s->sock, NULL, NULL)) >= 0)
+    {
+        //响应头和响应体分开写,不关Nagle时第二段要等客户端的延迟ACK
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        conn = (struct tls_server_conn *)malloc(sizeof(*conn));
+        conn->s = s;
+        conn->sock = sock;
+        __atomic_add_fetch(&s->active, 1, __ATOMIC_SEQ_CST);
+        pthread_create(&tid, NULL, tls_server_conn_thread, conn);
+        pthread_detach(tid);
+    }
+    return NULL;
+}
+
+//tickets:签发session ticket cache:保存session id缓存,返回0成功
+static inline int tls_server_start(tls_server_t *s, int tickets, int cache, tls_server_handler_t handler, void *arg)
+{
+    struct sockaddr_in6 addr;
+    socklen_t len = sizeof(addr);
+    EVP_PKEY *key;
+    X509 *cert;
+    int off = 0;
+    int on = 1;
+
+    memset(s, 0, sizeof(*s));
+    s->handler = handler;
+    s->arg = arg;
+    tls_server_cert(&key, &cert);
+    s->ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(s->ctx, cert);
+    SSL_CTX_use_PrivateKey(s->ctx, key);
+    SSL_CTX_set_session_id_context(s->ctx, (const unsigned char *)"hx", 2);
+    SSL_CTX_set_session_cache_mode(s->ctx, cache ? SSL_SESS_CACHE_SERVER : SSL_SESS_CACHE_OFF);
+    if (!tickets)
+    {
+        SSL_CTX_set_options(s->ctx, SSL_OP_NO_TICKET);
+    }
+
+    //双栈监听,127.0.0.1和::1都能连
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    s->sock = socket(AF_INET6, SOCK_STREAM, 0);
+    setsockopt(s->sock, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    setsockopt(s->sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (s->sock < 0 || bind(s->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(s->sock, 16) != 0 ||
+        getsockname(s->sock, (struct sockaddr *)&addr, &len) != 0)
+    {
+        if (s->sock >= 0)
+        {
+            close(s->sock);
+        }
+        SSL_CTX_free(s->ctx);
+        return -1;
+    }
+    s->port = ntohs(addr.sin6_port);
+    snprintf(s->port_str, sizeof(s->port_str), "%u", s->port);
+    pthread_create(&s->tid, NULL, tls_server_accept_thread, s);
+    return 0;
+}
+
+//停止监听,等所有连接线程结束
+static inline void tls_server_stop(tls_server_t *s)
+{
+    shutdown(s->sock, SHUT_RDWR);
+    pthread_join(s->tid, NULL);
+    close(s->sock);
+    for (int i = 0; i < 400 && __atomic_load_n(&s->active, __ATOMIC_SEQ_CST) > 0; i++)
+    {
+        usleep(5000);
+    }
+    SSL_CTX_free(s->ctx);
+}
+
+//响应体第i个字节,客户端可以重新算出来比较
+static inline char tls_server_body_byte(size_t i)
+{
+    return 'a' + i % 26;
+}
+
+static inline int tls_server_write_all(SSL *ssl, const void *buf, size_t len)
+{
+    size_t sent = 0;
+    int ret;
+    while (sent < len)
+    {
+        if ((ret = SSL_write(ssl, (const char *)buf + sent, len - sent)) <= 0)
+        {
+            return -1;
+        }
+        sent += ret;
+    }
+    return 0;
+}
+
+static inline int tls_server_write_body(SSL *ssl, size_t from, size_t len)
+{
+    char buf[1024];
+    size_t n;
+    while (len > 0)
+    {
+        n = len < sizeof(buf) ? len : sizeof(buf);
+        for (size_t i = 0; i < n; i++)
+        {
+            buf[i] = tls_server_body_byte(from + i);
+        }
+        if (tls_server_write_all(ssl, buf, n) != 0)
+        {
+            return -1;
+        }
+        from += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*
+ * 最小的HTTP/1.1服务器,请求行的路径决定响应,<n>为响应体长度:
+ *   /len/<n>      Content-Length,保持连接
+ *   /chunked/<n>  chunked编码,每块7字节,最后带一行trailer,保持连接
+ *   /close/<n>    不带长度,响应体读到连接关闭为止
+ *   /drop/<n>     Content-Length,但发完就关闭连接,像服务器空闲超时关掉了keep-alive连接
+ *   /hangup       不回任何数据直接关闭
+ *   /204          204 No Content
+ * 其他路径回404。请求带Content-Length时读完请求体
+ * 设置了conn_requests时/len/<n>在连接处理满conn_requests个请求时发完就关闭,announce_close时这个响应带Connection: close
+ * host在回响应之前写好,客户端收到响应后可以直接读
+ */
+static inline void tls_server_http(tls_server_t *s, SSL *ssl)
+{
+    char head[TLS_SERVER_HEAD_L + 1];
+    char reply[256];
+    char path[128];
+    char skip[512];
+    char *end, *cl, *host;
+    int served = 0;
+    size_t fill = 0;
+    size_t head_len, left, body_len, n;
+    int ret, last;
+
+    while (1)
+    {
+        //读到请求头结束
+        while ((end = (head[fill] = 0, strstr(head, "\r\n\r\n"))) == NULL)
+        {
+            if (fill == TLS_SERVER_HEAD_L || (ret = SSL_read(ssl, head + fill, TLS_SERVER_HEAD_L - fill)) <= 0)
+            {
+                return;
+            }
+            fill += ret;
+        }
+        head_len = end + 4 - head;
+        if (sscanf(head, "%*s %127s", path) != 1)
+        {
+            return;
+        }
+        host = strstr(head, "\r\nHost:");
+        if (host != NULL && host < end)
+        {
+            sscanf(host + 7, " %127[^\r]", s->host);
+        }
+        cl = strstr(head, "\r\nContent-Length:");
+        left = cl != NULL && cl < end ? strtoul(cl + 17, NULL, 10) : 0;
+        //缓存里请求头后面是请求体,可能还有下一个请求
+        n = fill - head_len < left ? fill - head_len : left;
+        head_len += n;
+        left -= n;
+        memmove(head, head + head_len, fill - head_len);
+        fill -= head_len;
+        //请求体不关心内容,读完丢弃
+        while (left > 0)
+        {
+            if ((ret = SSL_read(ssl, skip, left < sizeof(skip) ? left : sizeof(skip))) <= 0)
+            {
+                return;
+            }
+            left -= ret;
+        }
+        __atomic_add_fetch(&s->requests, 1, __ATOMIC_SEQ_CST);
+        if (s->work_us > 0)
+        {
+            usleep(s->work_us);
+        }
+        served++;
+        last = s->conn_requests > 0 && served >= s->conn_requests;
+
+        body_len = strtoul(strrchr(path, '/') + 1, NULL, 10);
+        if (strncmp(path, "/len/", 5) == 0 || strncmp(path, "/drop/", 6) == 0)
+        {
+            n = snprintf(reply, sizeof(reply), "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\n%s\r\n", body_len,
+                         last && s->announce_close ? "Connection: close\r\n" : "");
+            if (tls_server_write_all(ssl, reply, n) != 0 || tls_server_write_body(ssl, 0, body_len) != 0 ||
+                path[1] == 'd' || last)
+            {
+                return;
+            }
+        }
+        else if (strncmp(path, "/chunked/", 9) == 0)
+        {
+            n = snprintf(reply, sizeof(reply), "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+            tls_server_write_all(ssl, reply, n);
+            for (size_t pos = 0; pos < body_len; pos += 7)
+            {
+                n = body_len - pos < 7 ? body_len - pos : 7;
+                snprintf(reply, sizeof(reply), "%zx;ext=1\r\n", n);
+                tls_server_write_all(ssl, reply, strlen(reply));
+                tls_server_write_body(ssl, pos, n);
+                tls_server_write_all(ssl, "\r\n", 2);
+            }
+            if (tls_server_write_all(ssl, "0\r\nX-Trailer: 1\r\n\r\n", 19) != 0)
+            {
+                return;
+            }
+        }
+        else if (strncmp(path, "/close/", 7) == 0)
+        {
+            n = snprintf(reply, sizeof(reply), "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n");
+            tls_server_write_all(ssl, reply, n);
+            tls_server_write_body(ssl, 0, body_len);
+            return;
+        }
+        else if (strcmp(path, "/hangup") == 0)
+        {
+            return;
+        }
+        else if (strcmp(path, "/204") == 0)
+        {
+            n = snprintf(reply, sizeof(reply), "HTTP/1.1 204 No Content\r\n\r\n");
+            tls_server_write_all(ssl, reply, n);
+        }
+        else
+        {
+            n = snprintf(reply, sizeof(reply), "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+            tls_server_write_all(ssl, reply, n);
+        }
+    }
+}
+
+#endif /* __HOST_TLS_SERVER_H__ */
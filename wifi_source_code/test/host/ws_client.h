@@ -0,0 +1,255 @@
+/*
+* @file         ws_client.h
+* @brief        主机测试用的websocket client
+* @details      普通阻塞socket实现的最小client：握手、按指定长度编码组帧(带掩码)、收server发来的帧。
+*               组帧和发送分开，测试可以把多帧拼成一段字节流后按任意长度切开发送
+* @author       hx-zsj
+* @par Copyright (c):
+*               红旭无线开发团队，QQ群：671139854
+* @par History:
+*               Ver0.0.1:
+                     hx-zsj, 2026/10/17, 初始化版本\n
+*               Ver0.0.2:
+                     hx-zsj, 2026/10/17, 握手可以带扩展请求头，带回握手回复\n
+*/
+#ifndef __HOST_WS_CLIENT_H__
+#define __HOST_WS_CLIENT_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define WS_CLIENT_KEY       "dGhlIHNhbXBsZSBub25jZQ=="          //RFC 6455 1.3节的例子
+#define WS_CLIENT_ACCEPT    "s3pPLMBiTxaQ9kYGzzhZRbK+xOo="      //上面key对应的Sec-WebSocket-Accept
+#define WS_CLIENT_WAIT_MS   2000                                //收帧的默认超时
+
+//长度编码：自动选最短的，或者强制16/64位
+enum
+{
+    WS_LEN_AUTO = 0,
+    WS_LEN_16 = 16,
+    WS_LEN_64 = 64,
+};
+
+//等到可读，超时返回0
+static inline int ws_client_readable(int sock, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = sock, .events = POLLIN };
+    return poll(&pfd, 1, timeout_ms) > 0;
+}
+
+//收满len字节，超时或对端关闭返回-1
+static inline int ws_client_read_all(int sock, void *buf, size_t len, int timeout_ms)
+{
+    size_t got = 0;
+    ssize_t ret;
+    while (got < len)
+    {
+        if (!ws_client_readable(sock, timeout_ms))
+        {
+            return -1;
+        }
+        ret = recv(sock, (uint8_t *)buf + got, len - got, 0);
+        if (ret <= 0)
+        {
+            return -1;
+        }
+        got += ret;
+    }
+    return 0;
+}
+
+//发完len字节，chunk不为0时按chunk切开分次发送
+static inline int ws_client_send_raw(int sock, const void *data, size_t len, size_t chunk)
+{
+    size_t sent = 0;
+    size_t n;
+    ssize_t ret;
+    while (sent < len)
+    {
+        n = chunk && len - sent > chunk ? chunk : len - sent;
+        ret = send(sock, (const uint8_t *)data + sent, n, MSG_NOSIGNAL);
+        if (ret <= 0)
+        {
+            return -1;
+        }
+        sent += ret;
+    }
+    return 0;
+}
+
+//组一帧，hdr0是第一个字节(FIN/RSV/opcode)，masked为0时不加掩码，返回帧长度
+static inline size_t ws_client_frame(uint8_t *out, uint8_t hdr0, const void *data, size_t len, int len_mode, int masked)
+{
+    static const uint8_t key[4] = { 0x37, 0xfa, 0x21, 0x3d };
+    const uint8_t *src = (const uint8_t *)data;
+    size_t pos = 0;
+
+    out[pos++] = hdr0;
+    if (len_mode == WS_LEN_64 || (len_mode == WS_LEN_AUTO && len > 0xffff))
+    {
+        out[pos++] = (masked ? 0x80 : 0) | 127;
+        for (int i = 0; i < 8; i++)
+        {
+            out[pos++] = (uint64_t)len >> (56 - 8 * i);
+        }
+    }
+    else if (len_mode == WS_LEN_16 || len > 125)
+    {
+        out[pos++] = (masked ? 0x80 : 0) | 126;
+        out[pos++] = len >> 8;
+        out[pos++] = len;
+    }
+    else
+    {
+        out[pos++] = (masked ? 0x80 : 0) | len;
+    }
+    if (masked)
+    {
+        memcpy(out + pos, key, 4);
+        pos += 4;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        out[pos + i] = masked ? src[i] ^ key[i & 3] : src[i];
+    }
+    return pos + len;
+}
+
+//组一帧并发送
+static inline int ws_client_send(int sock, uint8_t hdr0, const void *data, size_t len)
+{
+    uint8_t *frame = malloc(len + 14);
+    int ret = ws_client_send_raw(sock, frame, ws_client_frame(frame, hdr0, data, len, WS_LEN_AUTO, 1), 0);
+    free(frame);
+    return ret;
+}
+
+//收server发来的一帧，返回数据长度，opcode由op带回，超时或连接关闭返回-1
+static inline long ws_client_recv(int sock, uint8_t *op, uint8_t *buf, size_t cap, int timeout_ms)
+{
+    uint8_t hdr[8];
+    uint64_t len;
+    int masked;
+    int ext;
+
+    if (ws_client_read_all(sock, hdr, 2, timeout_ms) < 0)
+    {
+        return -1;
+    }
+    *op = hdr[0];
+    masked = hdr[1] & 0x80;
+    len = hdr[1] & 0x7f;
+    ext = len == 126 ? 2 : (len == 127 ? 8 : 0);
+    if (ext)
+    {
+        if (ws_client_read_all(sock, hdr, ext, timeout_ms) < 0)
+        {
+            return -1;
+        }
+        len = 0;
+        for (int i = 0; i < ext; i++)
+        {
+            len = (len << 8) | hdr[i];
+        }
+    }
+    //server发出的帧不能带掩码
+    if (masked || len > cap || ws_client_read_all(sock, buf, len, timeout_ms) < 0)
+    {
+        return -1;
+    }
+    return (long)len;
+}
+
+//对端已关闭连接
+static inline int ws_client_eof(int sock, int timeout_ms)
+{
+    uint8_t b;
+    return ws_client_readable(sock, timeout_ms) && recv(sock, &b, 1, 0) == 0;
+}
+
+//连上server并完成握手，ext是附加的请求头行(可以为空串)，resp不为NULL时带回握手回复；
+//检查Sec-WebSocket-Accept，失败返回-1
+static inline int ws_client_connect_ext(uint16_t port, const char *ext, char *resp, size_t resp_len)
+{
+    struct sockaddr_in addr;
+    char req[512];
+    char buf[512];
+    size_t req_len;
+    size_t len = 0;
+    int one = 1;
+    int s = -1;
+
+    req_len = snprintf(req, sizeof(req),
+                       "GET /chat HTTP/1.1\r\n"
+                       "Host: 127.0.0.1\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Key: " WS_CLIENT_KEY "\r\n"
+                       "%s"
+                       "Sec-WebSocket-Version: 13\r\n\r\n", ext);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    //server线程可能还没listen，重试一会
+    for (int i = 0; i < 200; i++)
+    {
+        s = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+        {
+            break;
+        }
+        close(s);
+        s = -1;
+        usleep(5000);
+    }
+    if (s < 0)
+    {
+        return -1;
+    }
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (ws_client_send_raw(s, req, req_len, 0) < 0)
+    {
+        close(s);
+        return -1;
+    }
+    //逐字节读到空行，不多读后面的帧
+    while (len < sizeof(buf) - 1)
+    {
+        if (ws_client_read_all(s, buf + len, 1, WS_CLIENT_WAIT_MS) < 0)
+        {
+            break;
+        }
+        buf[++len] = 0;
+        if (len >= 4 && memcmp(buf + len - 4, "\r\n\r\n", 4) == 0)
+        {
+            if (strncmp(buf, "HTTP/1.1 101", 12) == 0 && strstr(buf, "Sec-WebSocket-Accept: " WS_CLIENT_ACCEPT "\r\n"))
+            {
+                if (resp)
+                {
+                    snprintf(resp, resp_len, "%s", buf);
+                }
+                return s;
+            }
+            break;
+        }
+    }
+    close(s);
+    return -1;
+}
+
+//不带扩展连上server
+static inline int ws_client_connect(uint16_t port)
+{
+    return ws_client_connect_ext(port, "", NULL, 0);
+}
+
+#endif /*#ifndef __HOST_WS_CLIENT_H__*/